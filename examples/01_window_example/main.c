@@ -1,4 +1,5 @@
 #include <math.h>
+#include <stdio.h>
 #include <stdlib.h>
 
 #include "gwr.h"
@@ -9,9 +10,12 @@
 
 #define BG_COLOR GWR_WHITE
 
+#define TARGET_FPS 60.0
+
 int main() {
     int exit_code = EXIT_SUCCESS;
     GWR_window_t *window = NULL;
+    GWR_frame_pacer_t *pacer = NULL;
 
     window = GWR_window_create(SCREEN_WIDTH, SCREEN_HEIGHT, SCREEN_TITLE);
     if (!window) {
@@ -21,18 +25,30 @@ int main() {
 
     GWR_info_print();
 
+    pacer = GWR_frame_pacer_create(TARGET_FPS, 1);
+    if (!pacer) {
+        exit_code = EXIT_FAILURE;
+        goto cleanup;
+    }
+
     GWR_window_set_clear_color(GWR_UNPACK_COLOR(BG_COLOR), 1.f);
 
     while (!GWR_window_should_close(window)) {
+        GWR_frame_pacer_begin_frame(pacer);
+        GWR_window_poll_events();
         GWR_window_process_input(window);
 
         GWR_window_clear();
 
-        GWR_window_swap_buffers(window);
-        GWR_window_poll_events();
+        GWR_frame_pacer_end_frame(pacer, window);
     }
 
+    GWR_frame_pacer_dump_histogram(pacer, stdout);
+
 cleanup:
+    if (pacer) {
+        GWR_frame_pacer_destroy(pacer);
+    }
     if (window) {
         GWR_window_destroy(window);
     }
@@ -24,9 +24,12 @@ int main() {
     int exit_code = EXIT_SUCCESS;
     GWR_window_t *window = NULL;
     GWR_shader_t *shader = NULL;
+    GWR_shader_watcher_t *watcher = NULL;
     GWR_vertex_buffer_t *vbo = NULL;
     GWR_vertex_array_t *vao = NULL;
     GWR_texture_t *texture = NULL;
+    GWR_sampler_t *sampler = NULL;
+    GWR_bind_cache_t *binds = NULL;
 
     window = GWR_window_create(SCREEN_WIDTH, SCREEN_HEIGHT, SCREEN_TITLE);
 
@@ -80,20 +83,47 @@ int main() {
     const int val = 0;
     GWR_shader_set_val_name(shader, "tex_sampler", &val, GWR_SHADER_UNIFORM_INT);
 
+    // edit shaders/*.vert|frag while running to see them reload
+    watcher = GWR_shader_watcher_create();
+    if (watcher) {
+        GWR_shader_watcher_add(watcher, shader);
+    }
+
     texture = GWR_texture_load(TEXTURE_PATH);
     if (!texture) {
         exit_code = EXIT_FAILURE;
         goto cleanup;
     }
 
+    // the texture has no sampling state of its own
+    GWR_sampler_desc_t sampler_desc = GWR_sampler_desc_default();
+    sampler_desc.max_anisotropy = 8.f;
+    sampler = GWR_sampler_create(&sampler_desc);
+    if (!sampler) {
+        exit_code = EXIT_FAILURE;
+        goto cleanup;
+    }
+
+    binds = GWR_bind_cache_create();
+    if (!binds) {
+        exit_code = EXIT_FAILURE;
+        goto cleanup;
+    }
+
     GWR_window_set_clear_color(GWR_UNPACK_COLOR(BG_COLOR), 1.f);
 
     while (!GWR_window_should_close(window)) {
         GWR_window_process_input(window);
         GWR_window_clear();
 
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, GWR_texture_get_id(texture));
+        // uniforms live in the program, so a swapped one needs them again
+        if (watcher && GWR_shader_watcher_update(watcher) > 0) {
+            GWR_shader_set_val_name(shader, "tex_sampler", &val, GWR_SHADER_UNIFORM_INT);
+        }
+
+        // no GL calls after the first frame: the units already hold these
+        GWR_bind_textures(binds, 0, 1, (const GWR_texture_t *[]) {texture});
+        GWR_bind_samplers(binds, 0, 1, (const GWR_sampler_t *[]) {sampler});
 
         GWR_shader_use(shader);
         GWR_vertex_array_bind(vao);
@@ -105,6 +135,14 @@ int main() {
     }
 
 cleanup:
+    if (binds) {
+        GWR_bind_cache_destroy(binds);
+    }
+
+    if (sampler) {
+        GWR_sampler_destroy(sampler);
+    }
+
     if (texture) {
         GWR_texture_destroy(texture);
     }
@@ -117,6 +155,13 @@ cleanup:
         GWR_vertex_buffer_destroy(vbo);
     }
 
+    if (watcher) {
+        if (shader) {
+            GWR_shader_watcher_remove(watcher, shader);
+        }
+        GWR_shader_watcher_destroy(watcher);
+    }
+
     if (shader) {
         GWR_shader_destroy(shader);
     }
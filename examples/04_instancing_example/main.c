@@ -0,0 +1,173 @@
+#include <stdlib.h>
+#include <stddef.h>
+#include <math.h>
+
+#include "gwr.h"
+
+#include "GLFW/glfw3.h"
+
+#define SCREEN_WIDTH 1920
+#define SCREEN_HEIGHT 1080
+#define SCREEN_TITLE "04_instancing_example"
+
+#define BG_COLOR GWR_WHITE
+
+#define GRID_SIDE 300
+#define INSTANCE_COUNT (GRID_SIDE * GRID_SIDE)
+
+const char *vertex_src =
+        "#version 460 core\n"
+
+        "layout (location = 0) in vec3 a_pos;\n"
+        "layout (location = 1) in vec2 a_offset;\n"
+        "layout (location = 2) in vec3 a_color;\n"
+
+        "out vec3 color;\n"
+
+        "void main() {\n"
+        "    gl_Position = vec4(a_pos.xy + a_offset, a_pos.z, 1.0);\n"
+        "    color = a_color;\n"
+        "}\n";
+
+const char *fragment_src =
+        "#version 460 core\n"
+
+        "out vec4 frag_color;\n"
+
+        "in vec3 color;\n"
+
+        "void main() {\n"
+        "    frag_color = vec4(color, 1.0);\n"
+        "}\n";
+
+typedef struct {
+    GLfloat pos[3];
+} vertex_t;
+
+typedef struct {
+    GLfloat offset[2];
+    GLfloat color[3];
+} instance_t;
+
+int main() {
+    int exit_code = EXIT_SUCCESS;
+    GWR_window_t *window = NULL;
+    GWR_shader_t *shader = NULL;
+    GWR_vertex_buffer_t *vbo = NULL;
+    GWR_stream_buffer_t *instances = NULL;
+    GWR_vertex_array_t *vao = NULL;
+
+    window = GWR_window_create(SCREEN_WIDTH, SCREEN_HEIGHT, SCREEN_TITLE);
+
+    if (!window) {
+        exit_code = EXIT_FAILURE;
+        goto cleanup;
+    }
+
+    GWR_info_print();
+
+    const float half = 1.f / GRID_SIDE;
+    const vertex_t vertices[] = {
+        {.pos = {-half, -half, 0.f}},
+        {.pos = {half, -half, 0.f}},
+        {.pos = {0.f, half, 0.f}},
+    };
+
+    vbo = GWR_vertex_buffer_create(vertices, sizeof(vertices), GL_STATIC_DRAW);
+    if (!vbo) {
+        exit_code = EXIT_FAILURE;
+        goto cleanup;
+    }
+
+    instances = GWR_stream_buffer_create(sizeof(instance_t), INSTANCE_COUNT, GWR_STREAM_BUFFER_DEFAULT_REGIONS);
+    if (!instances) {
+        exit_code = EXIT_FAILURE;
+        goto cleanup;
+    }
+
+    vao = GWR_vertex_array_create();
+    if (!vao) {
+        exit_code = EXIT_FAILURE;
+        goto cleanup;
+    }
+
+    GWR_vertex_array_attrib_pointerf(
+        vao, vbo,
+        0, 3, GL_FLOAT, GL_FALSE, sizeof(vertex_t),
+        (void *) offsetof(vertex_t, pos)
+    );
+    GWR_vertex_array_stream_attrib_pointerf(
+        vao, instances,
+        1, 2, GL_FLOAT, GL_FALSE,
+        (void *) offsetof(instance_t, offset)
+    );
+    GWR_vertex_array_stream_attrib_pointerf(
+        vao, instances,
+        2, 3, GL_FLOAT, GL_FALSE,
+        (void *) offsetof(instance_t, color)
+    );
+    GWR_vertex_array_set_attrib_divisor(vao, 1, 1);
+    GWR_vertex_array_set_attrib_divisor(vao, 2, 1);
+    GWR_vertex_array_unbind();
+
+    shader = GWR_shader_create_src(vertex_src, fragment_src);
+    if (!shader) {
+        exit_code = EXIT_FAILURE;
+        goto cleanup;
+    }
+
+    GWR_window_set_clear_color(GWR_UNPACK_COLOR(BG_COLOR), 1.f);
+
+    while (!GWR_window_should_close(window)) {
+        GWR_window_process_input(window);
+        GWR_window_clear();
+
+        const float t = (float) glfwGetTime();
+
+        // refill the per-instance stream and issue a single draw for the whole grid
+        instance_t *dst = GWR_stream_buffer_map(instances);
+        for (int y = 0; y < GRID_SIDE; ++y) {
+            for (int x = 0; x < GRID_SIDE; ++x) {
+                instance_t *inst = &dst[y * GRID_SIDE + x];
+                inst->offset[0] = -1.f + (2.f * x + 1.f) * half;
+                inst->offset[1] = -1.f + (2.f * y + 1.f) * half;
+                inst->color[0] = 0.5f + 0.5f * sinf(t + x * 0.05f);
+                inst->color[1] = 0.5f + 0.5f * sinf(t + y * 0.05f);
+                inst->color[2] = 0.5f;
+            }
+        }
+        GWR_stream_buffer_unmap(instances, INSTANCE_COUNT);
+
+        GWR_draw_arrays_instanced(
+            GL_TRIANGLES, vao, shader, 0, 3,
+            INSTANCE_COUNT, GWR_stream_buffer_get_base(instances)
+        );
+        GWR_stream_buffer_fence(instances);
+
+        GWR_window_swap_buffers(window);
+        GWR_window_poll_events();
+    }
+
+cleanup:
+    if (vao) {
+        GWR_vertex_array_destroy(vao);
+    }
+
+    if (instances) {
+        GWR_stream_buffer_destroy(instances);
+    }
+
+    if (vbo) {
+        GWR_vertex_buffer_destroy(vbo);
+    }
+
+    if (shader) {
+        GWR_shader_destroy(shader);
+    }
+
+    if (window) {
+        GWR_window_destroy(window);
+    }
+
+    return exit_code;
+}
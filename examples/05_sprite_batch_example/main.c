@@ -0,0 +1,159 @@
+// sprite batch benchmark: ./05_sprite_batch_example [sprite_count]
+
+#include <stdlib.h>
+#include <stddef.h>
+
+#include "gwr.h"
+
+#include "GLFW/glfw3.h"
+#include "cglm/cglm.h"
+
+#define SCREEN_WIDTH 1920
+#define SCREEN_HEIGHT 1080
+#define SCREEN_TITLE "05_sprite_batch_example"
+
+#define BG_COLOR GWR_BLACK
+
+#define DEFAULT_SPRITE_COUNT 1000000
+#define SPRITE_SIZE 4.f
+
+#define TEXTURE_PATH "textures/img1.png"
+
+typedef struct {
+    float vx;
+    float vy;
+} velocity_t;
+
+static float rand_range(float lo, float hi) {
+    return lo + (hi - lo) * ((float) rand() / (float) RAND_MAX);
+}
+
+int main(int argc, char **argv) {
+    int exit_code = EXIT_SUCCESS;
+    GWR_window_t *window = NULL;
+    GWR_texture_t *texture = NULL;
+    GWR_sprite_batch_t *batch = NULL;
+    GWR_sprite_t *sprites = NULL;
+    velocity_t *velocities = NULL;
+
+    const int sprite_count = argc > 1 ? atoi(argv[1]) : DEFAULT_SPRITE_COUNT;
+    if (sprite_count <= 0) {
+        return EXIT_FAILURE;
+    }
+
+    // keep per-frame logging off the render thread
+    GWR_log_init(0);
+
+    window = GWR_window_create(SCREEN_WIDTH, SCREEN_HEIGHT, SCREEN_TITLE);
+
+    if (!window) {
+        exit_code = EXIT_FAILURE;
+        goto cleanup;
+    }
+
+    GWR_info_print();
+    GWR_window_set_vsync(false);
+
+    const char *layers[] = {TEXTURE_PATH};
+    texture = GWR_texture_load_array(layers, GWR_ARR_LEN(layers));
+    if (!texture) {
+        exit_code = EXIT_FAILURE;
+        goto cleanup;
+    }
+
+    batch = GWR_sprite_batch_create(GWR_SPRITE_BATCH_DEFAULT_CAPACITY);
+    if (!batch) {
+        exit_code = EXIT_FAILURE;
+        goto cleanup;
+    }
+
+    sprites = malloc(sizeof(GWR_sprite_t) * sprite_count);
+    velocities = malloc(sizeof(velocity_t) * sprite_count);
+    if (!sprites || !velocities) {
+        exit_code = EXIT_FAILURE;
+        goto cleanup;
+    }
+
+    for (int i = 0; i < sprite_count; ++i) {
+        sprites[i] = (GWR_sprite_t) {
+            .x = rand_range(0.f, SCREEN_WIDTH),
+            .y = rand_range(0.f, SCREEN_HEIGHT),
+            .w = SPRITE_SIZE,
+            .h = SPRITE_SIZE,
+            .uv = {0.f, 0.f, 1.f, 1.f},
+            .color = {rand_range(0.2f, 1.f), rand_range(0.2f, 1.f), rand_range(0.2f, 1.f)},
+            .layer = 0.f,
+        };
+        velocities[i] = (velocity_t) {rand_range(-100.f, 100.f), rand_range(-100.f, 100.f)};
+    }
+
+    mat4 proj;
+    glm_ortho(0.f, SCREEN_WIDTH, 0.f, SCREEN_HEIGHT, -1.f, 1.f, proj);
+
+    GWR_window_set_clear_color(GWR_UNPACK_COLOR(BG_COLOR), 1.f);
+
+    double prev_time = glfwGetTime();
+    double report_time = prev_time;
+    int frames = 0;
+
+    while (!GWR_window_should_close(window)) {
+        GWR_window_process_input(window);
+        GWR_window_clear();
+
+        const double now = glfwGetTime();
+        const float dt = (float) (now - prev_time);
+        prev_time = now;
+
+        for (int i = 0; i < sprite_count; ++i) {
+            GWR_sprite_t *s = &sprites[i];
+            velocity_t *v = &velocities[i];
+            s->x += v->vx * dt;
+            s->y += v->vy * dt;
+            if (s->x < 0.f || s->x > SCREEN_WIDTH) {
+                v->vx = -v->vx;
+            }
+            if (s->y < 0.f || s->y > SCREEN_HEIGHT) {
+                v->vy = -v->vy;
+            }
+        }
+
+        GWR_sprite_batch_begin(batch, (const float *) proj);
+        GWR_sprite_batch_draw_n(batch, texture, sprites, sprite_count);
+        GWR_sprite_batch_end(batch);
+
+        GWR_window_swap_buffers(window);
+        GWR_window_poll_events();
+
+        ++frames;
+        if (now - report_time >= 1.0) {
+            const GWR_sprite_batch_stats_t stats = GWR_sprite_batch_get_stats(batch);
+            const double frame_ms = (now - report_time) * 1000.0 / frames;
+            GWR_log(
+                GWR_LOG_INFO, "sprites/frame: %d, draw calls: %d, frame: %.2f ms, %.1f M sprites/s",
+                stats.sprites, stats.draw_calls, frame_ms, stats.sprites / frame_ms / 1000.0
+            );
+            report_time = now;
+            frames = 0;
+        }
+    }
+
+cleanup:
+    free(velocities);
+    free(sprites);
+
+    if (batch) {
+        GWR_sprite_batch_destroy(batch);
+    }
+
+    if (texture) {
+        GWR_texture_destroy(texture);
+    }
+
+    if (window) {
+        GWR_window_destroy(window);
+    }
+
+    GWR_log_shutdown();
+
+    return exit_code;
+}
@@ -0,0 +1,60 @@
+#include <stdlib.h>
+
+#include "gwr.h"
+
+#define SCREEN_WIDTH 960
+#define SCREEN_HEIGHT 540
+
+#define WINDOWS_COUNT 2
+
+typedef struct {
+    GLfloat bg[3];
+} window_state_t;
+
+static void frame(GWR_window_t *window, void *user) {
+    GWR_UNUSED(user);
+
+    const window_state_t *state = GWR_window_get_user_data(window);
+
+    GWR_window_process_input(window);
+
+    GWR_window_set_clear_color(GWR_UNPACK_COLOR(state->bg), 1.f);
+    GWR_window_clear();
+}
+
+int main() {
+    int exit_code = EXIT_SUCCESS;
+    GWR_window_t *windows[WINDOWS_COUNT] = {NULL};
+    window_state_t states[WINDOWS_COUNT] = {
+        {{0.2f, 0.3f, 0.3f}},
+        {{0.3f, 0.2f, 0.3f}},
+    };
+
+    windows[0] = GWR_window_create(SCREEN_WIDTH, SCREEN_HEIGHT, "06_multi_window_example: main");
+    if (!windows[0]) {
+        exit_code = EXIT_FAILURE;
+        goto cleanup;
+    }
+
+    // shares textures, buffers and shaders with the main window
+    windows[1] = GWR_window_create_shared(SCREEN_WIDTH, SCREEN_HEIGHT, "06_multi_window_example: second", windows[0]);
+    if (!windows[1]) {
+        exit_code = EXIT_FAILURE;
+        goto cleanup;
+    }
+
+    for (int i = 0; i < WINDOWS_COUNT; ++i) {
+        GWR_window_set_user_data(windows[i], &states[i]);
+    }
+
+    GWR_window_run(windows, WINDOWS_COUNT, frame, NULL);
+
+cleanup:
+    for (int i = WINDOWS_COUNT - 1; i >= 0; --i) {
+        if (windows[i]) {
+            GWR_window_destroy(windows[i]);
+        }
+    }
+
+    return exit_code;
+}
@@ -4,6 +4,7 @@
 #include "internal/gwr_vertex_buffer.h"
 #include "internal/gwr_vertex_array.h"
 #include "internal/gwr_element_buffer.h"
+#include "internal/gwr_stream_buffer.h"
 #include "internal/gwr_shader.h"
 #include "internal/gwr_window.h"
 #include "internal/gwr_texture.h"
@@ -11,3 +12,27 @@
 #include "internal/gwr_log.h"
 #include "internal/gwr_util.h"
 #include "internal/gwr_draw.h"
+#include "internal/gwr_sprite_batch.h"
+#include "internal/gwr_simd.h"
+#include "internal/gwr_framebuffer.h"
+#include "internal/gwr_framebuffer_pool.h"
+#include "internal/gwr_frame_graph.h"
+#include "internal/gwr_frame_pacer.h"
+#include "internal/gwr_input.h"
+#include "internal/gwr_shader_watcher.h"
+#include "internal/gwr_shader_preproc.h"
+#include "internal/gwr_shader_variant.h"
+#include "internal/gwr_program_pipeline.h"
+#include "internal/gwr_mesh.h"
+#include "internal/gwr_mesh_opt.h"
+#include "internal/gwr_quant.h"
+#include "internal/gwr_pipeline_state.h"
+#include "internal/gwr_sampler.h"
+#include "internal/gwr_bind.h"
+#include "internal/gwr_readback.h"
+#include "internal/gwr_debug.h"
+#include "internal/gwr_memory.h"
+#include "internal/gwr_resource.h"
+#include "internal/gwr_lz.h"
+#include "internal/gwr_vfs.h"
+#include "internal/gwr_trace.h"
@@ -0,0 +1,82 @@
+#pragma once
+
+#include "internal/gwr_texture.h"
+#include "internal/gwr_sampler.h"
+#include "internal/gwr_vertex_array.h"
+
+#include <stdint.h>
+
+/*
+Batched binding of texture units, sampler units, indexed buffer ranges and
+vertex buffer bindings. The cache remembers what each unit holds, compares a
+request against it and re-binds only the dirty subrange, as one
+glBindTextures / glBindSamplers / glBindBuffersRange / glBindVertexBuffers
+call when multi-bind is available (per-unit calls otherwise).
+
+    const GWR_texture_t *textures[] = {albedo, normal, roughness, shadow_map};
+    const GWR_sampler_t *samplers[] = {aniso, aniso, aniso, shadow_cmp};
+    GWR_bind_textures(binds, 0, GWR_ARR_LEN(textures), textures);
+    GWR_bind_samplers(binds, 0, GWR_ARR_LEN(samplers), samplers);
+
+Switching to a material that shares the shadow map re-binds units 0..2 with
+one call each. Use one cache per GL context and call GWR_bind_cache_invalidate()
+after binding any of these with raw GL or the single-unit helpers.
+*/
+
+#define GWR_BIND_MAX_UNITS 32
+
+typedef struct {
+    uint64_t requests;
+    uint64_t units_requested;
+    uint64_t units_bound;           // inside the dirty subranges
+    uint64_t gl_calls;
+} GWR_bind_stats_t;
+
+typedef struct GWR_bind_cache_t GWR_bind_cache_t;
+
+GWR_bind_cache_t *GWR_bind_cache_create(void);
+void GWR_bind_cache_destroy(GWR_bind_cache_t *cache);
+
+// forgets every binding, the next request binds its whole range
+void GWR_bind_cache_invalidate(GWR_bind_cache_t *cache);
+
+GWR_bind_stats_t GWR_bind_cache_get_stats(const GWR_bind_cache_t *cache);
+
+// first + count <= GWR_BIND_MAX_UNITS; NULL entries (or a NULL array) unbind
+
+void GWR_bind_textures(
+    GWR_bind_cache_t *cache,
+    GLuint first,
+    GLsizei count,
+    const GWR_texture_t *const *textures
+);
+
+void GWR_bind_samplers(
+    GWR_bind_cache_t *cache,
+    GLuint first,
+    GLsizei count,
+    const GWR_sampler_t *const *samplers
+);
+
+// target is GL_UNIFORM_BUFFER or GL_SHADER_STORAGE_BUFFER; NULL offsets and sizes bind whole buffers
+void GWR_bind_buffers_range(
+    GWR_bind_cache_t *cache,
+    GLenum target,
+    GLuint first,
+    GLsizei count,
+    const GLuint *buffers,
+    const GLintptr *offsets,
+    const GLsizeiptr *sizes
+);
+
+// vertex buffer binding points of `vao` (attribs set up with vertex attrib binding);
+// the cache tracks the bindings of the last vao it was given
+void GWR_bind_vertex_buffers(
+    GWR_bind_cache_t *cache,
+    const GWR_vertex_array_t *vao,
+    GLuint first,
+    GLsizei count,
+    const GLuint *buffers,
+    const GLintptr *offsets,
+    const GLsizei *strides
+);
@@ -1,15 +1,89 @@
 #pragma once
 
 #include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+/*
+Everything below is queried once in GWR_cap_init() (the window does it after
+loading GL) and cached, so hot paths can branch on it freely.
+*/
 
 typedef enum {
 	GWR_FEATURE_DEBUG_OUTPUT = 0,
 	GWR_FEATURE_DIRECT_STATE_ACCESS,
 	GWR_FEATURE_BUFFER_STORAGE,
+	GWR_FEATURE_TEXTURE_STORAGE,
+	GWR_FEATURE_TEXTURE_VIEW,
+	GWR_FEATURE_SAMPLER_OBJECTS,
+	GWR_FEATURE_MULTI_BIND,
+	GWR_FEATURE_VERTEX_ATTRIB_BINDING,
+	GWR_FEATURE_BASE_INSTANCE,
+	GWR_FEATURE_MULTI_DRAW_INDIRECT,
+	GWR_FEATURE_INDIRECT_PARAMETERS,
+	GWR_FEATURE_SHADER_DRAW_PARAMETERS,
+	GWR_FEATURE_SEPARATE_SHADER_OBJECTS,
+	GWR_FEATURE_PROGRAM_BINARY,
+	GWR_FEATURE_PARALLEL_SHADER_COMPILE,
+	GWR_FEATURE_SPIRV,
+	GWR_FEATURE_COMPUTE_SHADER,
+	GWR_FEATURE_SHADER_STORAGE_BUFFER,
+	GWR_FEATURE_SHADER_IMAGE_LOAD_STORE,
+	GWR_FEATURE_BINDLESS_TEXTURE,
+	GWR_FEATURE_SPARSE_TEXTURE,
+	GWR_FEATURE_SPARSE_BUFFER,
+	GWR_FEATURE_INVALIDATE_SUBDATA,
+	GWR_FEATURE_CLIP_CONTROL,
+	GWR_FEATURE_TIMER_QUERY,
+	GWR_FEATURE_TEXTURE_FILTER_ANISOTROPIC,
+	GWR_FEATURE_TEXTURE_COMPRESSION_S3TC,
+	GWR_FEATURE_TEXTURE_COMPRESSION_RGTC,
+	GWR_FEATURE_TEXTURE_COMPRESSION_BPTC,
+	GWR_FEATURE_TEXTURE_COMPRESSION_ETC2,
+	GWR_FEATURE_TEXTURE_COMPRESSION_ASTC_LDR,
+	GWR_FEATURE_MEMORY_INFO_NVX,
+	GWR_FEATURE_MEMORY_INFO_ATI,
 
 	GWR_FEATURE__COUNT
 } GWR_feature_e;
 
+typedef enum {
+	GWR_LIMIT_MAX_TEXTURE_SIZE = 0,
+	GWR_LIMIT_MAX_3D_TEXTURE_SIZE,
+	GWR_LIMIT_MAX_CUBE_MAP_TEXTURE_SIZE,
+	GWR_LIMIT_MAX_ARRAY_TEXTURE_LAYERS,
+	GWR_LIMIT_MAX_RENDERBUFFER_SIZE,
+	GWR_LIMIT_MAX_SAMPLES,
+	GWR_LIMIT_MAX_COLOR_ATTACHMENTS,
+	GWR_LIMIT_MAX_DRAW_BUFFERS,
+	GWR_LIMIT_MAX_VIEWPORTS,
+	GWR_LIMIT_MAX_VERTEX_ATTRIBS,
+	GWR_LIMIT_MAX_VERTEX_ATTRIB_BINDINGS,
+	GWR_LIMIT_MAX_VERTEX_ATTRIB_STRIDE,
+	GWR_LIMIT_MAX_ELEMENTS_VERTICES,
+	GWR_LIMIT_MAX_ELEMENTS_INDICES,
+	GWR_LIMIT_MAX_TEXTURE_IMAGE_UNITS,
+	GWR_LIMIT_MAX_COMBINED_TEXTURE_IMAGE_UNITS,
+	GWR_LIMIT_MAX_IMAGE_UNITS,
+	GWR_LIMIT_MAX_UNIFORM_BLOCK_SIZE,
+	GWR_LIMIT_MAX_UNIFORM_BUFFER_BINDINGS,
+	GWR_LIMIT_UNIFORM_BUFFER_OFFSET_ALIGNMENT,
+	GWR_LIMIT_MAX_SHADER_STORAGE_BLOCK_SIZE,
+	GWR_LIMIT_MAX_SHADER_STORAGE_BUFFER_BINDINGS,
+	GWR_LIMIT_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT,
+	GWR_LIMIT_MIN_MAP_BUFFER_ALIGNMENT,
+	GWR_LIMIT_MAX_COMPUTE_WORK_GROUP_INVOCATIONS,
+	GWR_LIMIT_MAX_COMPUTE_SHARED_MEMORY_SIZE,
+	GWR_LIMIT_MAX_SERVER_WAIT_TIMEOUT,
+	GWR_LIMIT_MAX_LABEL_LENGTH,
+	GWR_LIMIT_MAX_DEBUG_MESSAGE_LENGTH,
+	GWR_LIMIT_NUM_PROGRAM_BINARY_FORMATS,
+	GWR_LIMIT_NUM_COMPRESSED_TEXTURE_FORMATS,
+	GWR_LIMIT_NUM_EXTENSIONS,
+
+	GWR_LIMIT__COUNT
+} GWR_limit_e;
+
 bool GWR_cap_init(void);
 
 bool GWR_cap_is_init(void);
@@ -18,3 +92,14 @@ void GWR_cap_get_version(int *major, int *minor);
 
 bool GWR_cap_has(GWR_feature_e feature);
 
+// 0 if the limit is not available on this context
+int64_t GWR_cap_get_limit(GWR_limit_e limit);
+
+// only meaningful if GWR_FEATURE_TEXTURE_FILTER_ANISOTROPIC is present
+float GWR_cap_get_max_anisotropy(void);
+
+const char *GWR_cap_get_feature_name(GWR_feature_e feature);
+
+const char *GWR_cap_get_limit_name(GWR_limit_e limit);
+
+void GWR_cap_dump_json(FILE *out);
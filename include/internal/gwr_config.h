@@ -2,3 +2,6 @@
 
 #define GWR_OPENGL_MAJOR_VERSION 4
 #define GWR_OPENGL_MINOR_VERSION 6
+
+// 1 = vsync, 0 = off, -1 = adaptive (tears only when a frame is late)
+#define GWR_WINDOW_DEFAULT_SWAP_INTERVAL 1
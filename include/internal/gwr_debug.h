@@ -0,0 +1,83 @@
+#pragma once
+
+#include "glad/glad.h"
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+/*
+Opt-in KHR_debug layer. GWR_debug_init() installs a glDebugMessageCallback
+that forwards driver messages to the log (GWR_LOG_SYS_GL_DEBUG) and counts
+GL_DEBUG_TYPE_PERFORMANCE messages per message id, so shader recompiles,
+buffer migrations and similar driver warnings show up even when their log
+lines are filtered or rate-limited.
+
+    GWR_window_hint_debug_context(true);
+    GWR_window_t *window = GWR_window_create(w, h, "app");
+    GWR_debug_init(&(GWR_debug_desc_t) {.min_severity = GL_DEBUG_SEVERITY_LOW});
+
+    GWR_debug_push_group("shadow pass");
+    ...
+    GWR_debug_pop_group();
+
+    GWR_debug_dump_perf(stdout);
+
+While the layer is on, frame graph passes run in debug groups and library
+objects are labelled with glObjectLabel, so captures in RenderDoc or Nsight
+read like the code:
+
+    loaded textures, meshes, path-built and reloaded programs   file paths
+    shader variant stages and programs                          path + define count
+    frame graph textures and framebuffers                       resource / pass names
+    framebuffers, samplers, program pipelines, plain buffers    kind and shape
+
+Textures from GWR_texture_create and bare vertex arrays have no name to
+borrow; label them with GWR_debug_label. When the layer is off every entry
+point is a cheap no-op.
+*/
+#define GWR_DEBUG_MAX_PERF_IDS    64
+#define GWR_DEBUG_PERF_TEXT_SIZE  160
+
+typedef struct {
+    GLenum min_severity;            // lowest severity logged; 0 means GL_DEBUG_SEVERITY_MEDIUM
+    bool synchronous;               // callback on the offending call, for breakpoints; slower
+    const GLuint *ignored_ids;      // muted in the driver
+    int ignored_count;
+} GWR_debug_desc_t;
+
+typedef struct {
+    GLuint id;
+    GLenum source;
+    uint64_t count;
+    char text[GWR_DEBUG_PERF_TEXT_SIZE];  // first message seen with this id
+} GWR_debug_perf_entry_t;
+
+typedef struct {
+    uint64_t messages;
+    uint64_t errors;                // GL_DEBUG_TYPE_ERROR
+    uint64_t performance;           // GL_DEBUG_TYPE_PERFORMANCE
+    uint64_t other;
+    uint64_t logged;                // passed the severity filter
+} GWR_debug_stats_t;
+
+// needs a current context with GWR_FEATURE_DEBUG_OUTPUT; false if unavailable
+bool GWR_debug_init(const GWR_debug_desc_t *desc);
+void GWR_debug_shutdown(void);
+bool GWR_debug_is_enabled(void);
+
+// mutes (or unmutes) one message id in the driver
+void GWR_debug_set_id_enabled(GLuint id, bool enabled);
+
+GWR_debug_stats_t GWR_debug_get_stats(void);
+// copies up to `max` perf entries, most frequent first; returns how many
+int GWR_debug_get_perf(GWR_debug_perf_entry_t *out, int max);
+void GWR_debug_reset_stats(void);
+void GWR_debug_dump_perf(FILE *out);
+
+// identifier is GL_BUFFER, GL_TEXTURE, GL_PROGRAM, GL_VERTEX_ARRAY, ...; printf-style,
+// truncated to GL_MAX_LABEL_LENGTH
+void GWR_debug_label(GLenum identifier, GLuint name, const char *fmt, ...);
+
+void GWR_debug_push_group(const char *name);
+void GWR_debug_pop_group(void);
@@ -3,6 +3,9 @@
 #include "gwr_shader.h"
 #include "gwr_vertex_array.h"
 #include "gwr_element_buffer.h"
+#include "gwr_pipeline_state.h"
+
+#include <stdint.h>
 
 void GWR_draw_arrays(
     GLenum mode,
@@ -19,4 +22,52 @@ void GWR_draw_elements(
     const GWR_element_buffer_t *ebo,
     GLsizei count,
     GLintptr offset
-);
\ No newline at end of file
+);
+
+// base_instance selects where per-instance attributes start, e.g. GWR_stream_buffer_get_base()
+
+void GWR_draw_arrays_instanced(
+    GLenum mode,
+    const GWR_vertex_array_t *vao,
+    const GWR_shader_t *shader,
+    GLint first,
+    GLsizei count,
+    GLsizei instance_count,
+    GLuint base_instance
+);
+
+void GWR_draw_elements_instanced(
+    GLenum mode,
+    const GWR_vertex_array_t *vao,
+    const GWR_shader_t *shader,
+    const GWR_element_buffer_t *ebo,
+    GLsizei count,
+    GLintptr offset,
+    GLsizei instance_count,
+    GLuint base_instance
+);
+
+// apply `state` (only the fields that differ from the last applied state) and draw
+
+void GWR_draw_arrays_state(
+    const GWR_pipeline_state_t *state,
+    GLenum mode,
+    const GWR_vertex_array_t *vao,
+    const GWR_shader_t *shader,
+    GLint first,
+    GLsizei count
+);
+
+void GWR_draw_elements_state(
+    const GWR_pipeline_state_t *state,
+    GLenum mode,
+    const GWR_vertex_array_t *vao,
+    const GWR_shader_t *shader,
+    const GWR_element_buffer_t *ebo,
+    GLsizei count,
+    GLintptr offset
+);
+
+// 16-bit state id | 32-bit program id | depth in [0, 1] as 16 bits, so sorting
+// the keys ascending groups draws by state, then program, then front to back
+uint64_t GWR_draw_sort_key(const GWR_pipeline_state_t *state, const GWR_shader_t *shader, float depth);
@@ -4,7 +4,12 @@
 
 typedef struct GWR_element_buffer_t GWR_element_buffer_t;
 
+// GL_UNSIGNED_INT indices
 GWR_element_buffer_t *GWR_element_buffer_create(const void *data, GLsizeiptr size, GLenum usage);
+// `type` is GL_UNSIGNED_BYTE, GL_UNSIGNED_SHORT or GL_UNSIGNED_INT; set_data keeps it
+GWR_element_buffer_t *GWR_element_buffer_create_typed(const void *data, GLsizeiptr size, GLenum type, GLenum usage);
+// immutable storage (glBufferStorage); set_data is refused, flags 0 = static contents
+GWR_element_buffer_t *GWR_element_buffer_create_storage(const void *data, GLsizeiptr size, GLenum type, GLbitfield flags);
 void GWR_element_buffer_destroy(GWR_element_buffer_t *ebo);
 
 void GWR_element_buffer_bind(const GWR_element_buffer_t *ebo);
@@ -12,6 +17,9 @@ void GWR_element_buffer_unbind(void);
 
 void GWR_element_buffer_set_data(GWR_element_buffer_t *ebo, const void *data, GLsizeiptr size);
 
+// bytes per index, 0 for unsupported types
+GLsizeiptr GWR_element_buffer_type_size(GLenum type);
+
 GLuint GWR_element_buffer_get_id(const GWR_element_buffer_t *ebo);
 GLsizeiptr GWR_element_buffer_get_size(const GWR_element_buffer_t *ebo);
 GLsizei GWR_element_buffer_get_count(const GWR_element_buffer_t *ebo);
@@ -0,0 +1,119 @@
+#pragma once
+
+#include "glad/glad.h"
+
+#include "internal/gwr_texture.h"
+#include "internal/gwr_framebuffer.h"
+
+#include <stdbool.h>
+#include <stdio.h>
+
+/*
+A frame described as passes with declared resource accesses. Rebuilt every
+frame:
+
+    GWR_frame_graph_reset(fg);
+    GWR_fg_resource_t hdr = GWR_frame_graph_create_texture(fg, "hdr", &desc);
+    GWR_fg_resource_t back = GWR_frame_graph_import_backbuffer(fg, "back");
+
+    int scene = GWR_frame_graph_add_pass(fg, "scene", draw_scene, ctx);
+    GWR_frame_graph_write(fg, scene, hdr, GWR_FG_ACCESS_COLOR_ATTACHMENT);
+
+    int tonemap = GWR_frame_graph_add_pass(fg, "tonemap", draw_tonemap, ctx);
+    GWR_frame_graph_read(fg, tonemap, hdr, GWR_FG_ACCESS_SAMPLED);
+    GWR_frame_graph_write(fg, tonemap, back, GWR_FG_ACCESS_COLOR_ATTACHMENT);
+
+    GWR_frame_graph_compile(fg);
+    GWR_frame_graph_execute(fg);
+
+Compile culls passes whose writes are never read (writes to imported
+resources and GWR_frame_graph_set_side_effect() keep a pass alive). A write
+replaces the contents, so a read only keeps the last writer before it; a
+pass that blends into or otherwise keeps earlier contents must read the
+resource as well as write it. Compile then orders the rest by their
+dependencies, puts glMemoryBarrier() only after incoherent (image/storage
+buffer) writes, and lets transient textures with identical descs and
+disjoint lifetimes share one physical texture. Physical textures
+and pass framebuffers are kept between frames, so a stable graph allocates
+nothing after the first frame.
+
+Attachment writes are bound as the pass framebuffer before the callback
+runs; transient attachments that die in the pass are invalidated after it.
+*/
+
+#define GWR_FRAME_GRAPH_MAX_PASSES       64
+#define GWR_FRAME_GRAPH_MAX_RESOURCES    128
+#define GWR_FRAME_GRAPH_MAX_ACCESSES     16
+
+#define GWR_FG_INVALID (-1)
+
+typedef int GWR_fg_resource_t;
+
+typedef enum {
+    GWR_FG_ACCESS_COLOR_ATTACHMENT = 0,
+    GWR_FG_ACCESS_DEPTH_ATTACHMENT,
+    GWR_FG_ACCESS_SAMPLED,
+    GWR_FG_ACCESS_STORAGE_IMAGE,
+    GWR_FG_ACCESS_STORAGE_BUFFER,
+    GWR_FG_ACCESS_UNIFORM_BUFFER,
+    GWR_FG_ACCESS_VERTEX_BUFFER,
+    GWR_FG_ACCESS_INDEX_BUFFER,
+    GWR_FG_ACCESS_INDIRECT_BUFFER,
+    GWR_FG_ACCESS_TRANSFER,
+
+    GWR_FG_ACCESS__COUNT
+} GWR_fg_access_e;
+
+typedef struct {
+    GLsizei width;
+    GLsizei height;
+    GLenum format;
+    GLsizei samples;
+} GWR_fg_texture_desc_t;
+
+typedef struct {
+    int passes;
+    int culled_passes;
+    int transient_textures;
+    int physical_textures;
+    int barriers;
+    GLsizeiptr memory_unaliased;
+    GLsizeiptr memory_aliased;
+} GWR_frame_graph_stats_t;
+
+typedef struct GWR_frame_graph_t GWR_frame_graph_t;
+
+typedef void (*GWR_fg_execute_fn)(GWR_frame_graph_t *fg, void *user);
+
+GWR_frame_graph_t *GWR_frame_graph_create(void);
+void GWR_frame_graph_destroy(GWR_frame_graph_t *fg);
+
+// drops passes and resource declarations; physical textures and framebuffers stay cached
+void GWR_frame_graph_reset(GWR_frame_graph_t *fg);
+
+GWR_fg_resource_t GWR_frame_graph_create_texture(GWR_frame_graph_t *fg, const char *name, const GWR_fg_texture_desc_t *desc);
+GWR_fg_resource_t GWR_frame_graph_import_texture(GWR_frame_graph_t *fg, const char *name, GWR_texture_t *texture);
+GWR_fg_resource_t GWR_frame_graph_import_buffer(GWR_frame_graph_t *fg, const char *name, GLuint buffer);
+GWR_fg_resource_t GWR_frame_graph_import_backbuffer(GWR_frame_graph_t *fg, const char *name);
+
+int GWR_frame_graph_add_pass(GWR_frame_graph_t *fg, const char *name, GWR_fg_execute_fn fn, void *user);
+void GWR_frame_graph_read(GWR_frame_graph_t *fg, int pass, GWR_fg_resource_t res, GWR_fg_access_e access);
+void GWR_frame_graph_write(GWR_frame_graph_t *fg, int pass, GWR_fg_resource_t res, GWR_fg_access_e access);
+void GWR_frame_graph_set_side_effect(GWR_frame_graph_t *fg, int pass);
+
+bool GWR_frame_graph_compile(GWR_frame_graph_t *fg);
+void GWR_frame_graph_execute(GWR_frame_graph_t *fg);
+
+// valid inside pass callbacks (and after compile for textures)
+GWR_texture_t *GWR_frame_graph_get_texture(const GWR_frame_graph_t *fg, GWR_fg_resource_t res);
+GLuint GWR_frame_graph_get_buffer(const GWR_frame_graph_t *fg, GWR_fg_resource_t res);
+// framebuffer of the running pass, NULL when it renders to the backbuffer or has no attachments
+GWR_framebuffer_t *GWR_frame_graph_get_framebuffer(const GWR_frame_graph_t *fg);
+
+// GL_TIME_ELAPSED per pass, read back a few frames late so it never stalls
+void GWR_frame_graph_set_timing(GWR_frame_graph_t *fg, bool enabled);
+bool GWR_frame_graph_get_pass_time(const GWR_frame_graph_t *fg, const char *name, double *last_ms, double *avg_ms);
+
+GWR_frame_graph_stats_t GWR_frame_graph_get_stats(const GWR_frame_graph_t *fg);
+void GWR_frame_graph_dump(const GWR_frame_graph_t *fg, FILE *out);
+void GWR_frame_graph_dump_dot(const GWR_frame_graph_t *fg, FILE *out);
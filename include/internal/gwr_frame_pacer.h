@@ -0,0 +1,69 @@
+#pragma once
+
+#include "internal/gwr_window.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+/*
+Paces the render loop and bounds how far the CPU may run ahead of the GPU:
+
+    while (!GWR_window_should_close(window)) {
+        GWR_frame_pacer_begin_frame(pacer);   // waits, then samples input
+        GWR_window_poll_events();
+        ... render ...
+        GWR_frame_pacer_end_frame(pacer, window);   // swaps and fences
+    }
+
+begin_frame first blocks on the fence of the frame max_frames_in_flight
+frames back, then waits for the target frame time: it sleeps while more than
+the spin threshold is left and busy-waits the rest, since sleeps overshoot
+by a scheduler tick. Polling input after begin_frame keeps the time between
+sampling input and the GPU starting on the frame short.
+
+With vsync on, max_frames_in_flight 1 gives the lowest latency at the cost
+of some GPU idle time; 2 is the usual compromise.
+*/
+
+#define GWR_FRAME_PACER_DEFAULT_FRAMES_IN_FLIGHT    2
+#define GWR_FRAME_PACER_MAX_FRAMES_IN_FLIGHT        4
+#define GWR_FRAME_PACER_DEFAULT_SPIN_US             1500
+
+// histogram covers [0, BUCKETS * BUCKET_MS), longer frames land in the last bucket
+#define GWR_FRAME_PACER_HISTOGRAM_BUCKETS           200
+#define GWR_FRAME_PACER_HISTOGRAM_BUCKET_MS         0.25
+
+typedef struct {
+    uint64_t frames;
+    double last_ms;          // begin_frame to begin_frame
+    double min_ms;
+    double max_ms;
+    double avg_ms;
+    double p50_ms;
+    double p95_ms;
+    double p99_ms;
+    double avg_fence_wait_ms;
+    double avg_sleep_ms;
+    double avg_swap_ms;
+} GWR_frame_pacer_stats_t;
+
+typedef struct GWR_frame_pacer_t GWR_frame_pacer_t;
+
+// target_fps <= 0 disables the frame rate cap; max_frames_in_flight 0 = default
+GWR_frame_pacer_t *GWR_frame_pacer_create(double target_fps, int max_frames_in_flight);
+void GWR_frame_pacer_destroy(GWR_frame_pacer_t *pacer);
+
+void GWR_frame_pacer_set_target_fps(GWR_frame_pacer_t *pacer, double target_fps);
+void GWR_frame_pacer_set_max_frames_in_flight(GWR_frame_pacer_t *pacer, int frames);
+void GWR_frame_pacer_set_spin_threshold(GWR_frame_pacer_t *pacer, int spin_us);
+
+void GWR_frame_pacer_begin_frame(GWR_frame_pacer_t *pacer);
+void GWR_frame_pacer_end_frame(GWR_frame_pacer_t *pacer, const GWR_window_t *window);
+
+GWR_frame_pacer_stats_t GWR_frame_pacer_get_stats(const GWR_frame_pacer_t *pacer);
+// frame time below which `percentile` (0..100) of the recorded frames fall
+double GWR_frame_pacer_get_percentile(const GWR_frame_pacer_t *pacer, double percentile);
+const uint32_t *GWR_frame_pacer_get_histogram(const GWR_frame_pacer_t *pacer);
+void GWR_frame_pacer_reset_stats(GWR_frame_pacer_t *pacer);
+void GWR_frame_pacer_dump_histogram(const GWR_frame_pacer_t *pacer, FILE *out);
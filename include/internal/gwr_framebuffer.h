@@ -0,0 +1,58 @@
+#pragma once
+
+#include "glad/glad.h"
+
+#include "internal/gwr_texture.h"
+
+#include <stdbool.h>
+
+#define GWR_FRAMEBUFFER_MAX_COLOR_ATTACHMENTS 8
+
+/*
+Render target description. Color formats are read up to the first 0 entry,
+depth_format 0 means no depth attachment (GL_DEPTH24_STENCIL8 and
+GL_DEPTH32F_STENCIL8 also get a stencil attachment). Renderbuffer
+attachments cannot be sampled; use them for MSAA targets that are only
+resolved and for depth that is only tested.
+*/
+typedef struct {
+    GLsizei width;
+    GLsizei height;
+    GLsizei samples;
+    GLenum color_formats[GWR_FRAMEBUFFER_MAX_COLOR_ATTACHMENTS];
+    GLenum depth_format;
+    bool color_renderbuffer;
+    bool depth_renderbuffer;
+} GWR_framebuffer_desc_t;
+
+typedef struct GWR_framebuffer_t GWR_framebuffer_t;
+
+// owns its attachments
+GWR_framebuffer_t *GWR_framebuffer_create(const GWR_framebuffer_desc_t *desc);
+// attaches existing textures (level 0); they are not destroyed with the framebuffer
+GWR_framebuffer_t *GWR_framebuffer_create_from(GWR_texture_t *const *colors, GLsizei color_count, GWR_texture_t *depth);
+void GWR_framebuffer_destroy(GWR_framebuffer_t *fb);
+
+// NULL binds the default framebuffer; the viewport is set to the framebuffer size
+void GWR_framebuffer_bind(const GWR_framebuffer_t *fb);
+// mask takes GL_*_BUFFER_BIT; attachments fb does not have are skipped, color may be NULL without GL_COLOR_BUFFER_BIT
+void GWR_framebuffer_clear(GWR_framebuffer_t *fb, GLbitfield mask, const float color[4], float depth, GLint stencil);
+
+// dst NULL = default framebuffer; rectangles cover each framebuffer fully
+void GWR_framebuffer_blit(const GWR_framebuffer_t *src, const GWR_framebuffer_t *dst, GLbitfield mask, GLenum filter);
+// MSAA -> single-sampled resolve of color (and depth if both have it)
+void GWR_framebuffer_resolve(const GWR_framebuffer_t *src, const GWR_framebuffer_t *dst);
+// tells the driver the contents are no longer needed (skips tile stores / copies)
+void GWR_framebuffer_invalidate(GWR_framebuffer_t *fb, GLbitfield mask);
+
+GLuint GWR_framebuffer_get_id(const GWR_framebuffer_t *fb);
+GLsizei GWR_framebuffer_get_width(const GWR_framebuffer_t *fb);
+GLsizei GWR_framebuffer_get_height(const GWR_framebuffer_t *fb);
+GLsizei GWR_framebuffer_get_samples(const GWR_framebuffer_t *fb);
+GLsizei GWR_framebuffer_get_color_count(const GWR_framebuffer_t *fb);
+// NULL for renderbuffer attachments
+GWR_texture_t *GWR_framebuffer_get_color(const GWR_framebuffer_t *fb, GLsizei index);
+GWR_texture_t *GWR_framebuffer_get_depth(const GWR_framebuffer_t *fb);
+const GWR_framebuffer_desc_t *GWR_framebuffer_get_desc(const GWR_framebuffer_t *fb);
+// bytes of attachment storage this framebuffer owns (estimate)
+GLsizeiptr GWR_framebuffer_get_memory_size(const GWR_framebuffer_t *fb);
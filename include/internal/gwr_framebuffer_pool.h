@@ -0,0 +1,45 @@
+#pragma once
+
+#include "internal/gwr_framebuffer.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+Transient render targets keyed by their full GWR_framebuffer_desc_t. Acquire
+returns an idle framebuffer with an identical desc or creates one; release
+hands it back for reuse. GWR_framebuffer_pool_end_frame() destroys targets
+that stayed idle for `max_idle_frames`, so sizes that stop being requested
+(e.g. after a window resize) are reclaimed instead of piling up.
+
+Typical post-processing pass:
+    GWR_framebuffer_t *tmp = GWR_framebuffer_pool_acquire(pool, &desc);
+    ... render into tmp, sample it in the next pass ...
+    GWR_framebuffer_pool_release(pool, tmp);
+*/
+
+#define GWR_FRAMEBUFFER_POOL_DEFAULT_MAX_IDLE_FRAMES 8
+
+typedef struct {
+    size_t live;
+    size_t in_use;
+    size_t hits;
+    size_t misses;
+    size_t evictions;
+    GLsizeiptr memory_size;
+} GWR_framebuffer_pool_stats_t;
+
+typedef struct GWR_framebuffer_pool_t GWR_framebuffer_pool_t;
+
+GWR_framebuffer_pool_t *GWR_framebuffer_pool_create(uint32_t max_idle_frames);
+// every framebuffer handed out by the pool is destroyed, released or not
+void GWR_framebuffer_pool_destroy(GWR_framebuffer_pool_t *pool);
+
+GWR_framebuffer_t *GWR_framebuffer_pool_acquire(GWR_framebuffer_pool_t *pool, const GWR_framebuffer_desc_t *desc);
+void GWR_framebuffer_pool_release(GWR_framebuffer_pool_t *pool, GWR_framebuffer_t *fb);
+
+void GWR_framebuffer_pool_end_frame(GWR_framebuffer_pool_t *pool);
+// destroys every idle framebuffer now
+void GWR_framebuffer_pool_trim(GWR_framebuffer_pool_t *pool);
+
+GWR_framebuffer_pool_stats_t GWR_framebuffer_pool_get_stats(const GWR_framebuffer_pool_t *pool);
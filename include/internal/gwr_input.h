@@ -0,0 +1,108 @@
+#pragma once
+
+#include "internal/gwr_window.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+GLFW callbacks of one window push timestamped events into a single-producer
+single-consumer lock-free ring. GLFW delivers callbacks on the thread that
+calls GWR_window_poll_events(), which is the only producer; any one other
+thread (or the same one) consumes, so simulation code never touches GLFW:
+
+    // render thread
+    GWR_window_poll_events();
+
+    // simulation thread
+    GWR_input_snapshot_init(input, &snap);    // once
+    ...
+    GWR_input_update(input, &snap);           // every tick
+    if (GWR_input_key_pressed(&snap, GLFW_KEY_SPACE)) { ... }
+
+Keys and buttons use the GLFW_KEY_* / GLFW_MOUSE_BUTTON_* values. Cursor
+motion is never coalesced, so nothing between two frames is lost unless the
+ring overflows (counted by GWR_input_get_dropped()). Callbacks already set on
+the window are chained, not replaced. Destroy restores them, so anything that
+sets GLFW callbacks on the window after GWR_input_create() has to restore its
+own before GWR_input_destroy() (LIFO); destroy asserts that it does.
+*/
+
+#define GWR_INPUT_DEFAULT_CAPACITY    1024
+#define GWR_INPUT_MAX_KEYS            512
+#define GWR_INPUT_MAX_BUTTONS         8
+
+typedef enum {
+    GWR_INPUT_EVENT_KEY = 0,
+    GWR_INPUT_EVENT_CHAR,
+    GWR_INPUT_EVENT_MOUSE_BUTTON,
+    GWR_INPUT_EVENT_CURSOR,
+    GWR_INPUT_EVENT_SCROLL,
+    GWR_INPUT_EVENT_RESIZE,
+    GWR_INPUT_EVENT_FOCUS,
+
+    GWR_INPUT_EVENT__COUNT
+} GWR_input_event_type_e;
+
+typedef struct {
+    GWR_input_event_type_e type;
+    uint64_t time_ns;       // CLOCK_MONOTONIC when the callback ran
+    union {
+        struct { int key; int scancode; int action; int mods; } key;
+        struct { uint32_t codepoint; } chr;
+        struct { int button; int action; int mods; } button;
+        struct { double x; double y; } cursor;
+        struct { double dx; double dy; } scroll;
+        struct { int width; int height; } resize;   // framebuffer pixels
+        struct { bool focused; } focus;
+    };
+} GWR_input_event_t;
+
+// state as of the last GWR_input_update(); plain data, safe to copy around
+typedef struct {
+    uint8_t keys[GWR_INPUT_MAX_KEYS];           // bit 0 down, bit 1 pressed, bit 2 released this update
+    uint8_t buttons[GWR_INPUT_MAX_BUTTONS];     // same bits
+    int mods;
+    double cursor_x;
+    double cursor_y;
+    double cursor_dx;
+    double cursor_dy;
+    double scroll_dx;
+    double scroll_dy;
+    int width;
+    int height;
+    bool resized;
+    bool focused;
+    uint32_t text[32];                          // codepoints typed this update
+    int text_len;
+    int text_dropped;                           // codepoints past text[] this update
+    uint64_t time_ns;                           // timestamp of the newest applied event
+} GWR_input_snapshot_t;
+
+typedef struct GWR_input_t GWR_input_t;
+
+// capacity is rounded up to a power of two (0 = default); NULL if that
+// power of two would not fit in memory
+GWR_input_t *GWR_input_create(GWR_window_t *window, size_t capacity);
+// restores the callbacks that were installed before create
+void GWR_input_destroy(GWR_input_t *input);
+
+// pops up to `max` events in arrival order, returns how many were written
+size_t GWR_input_poll(GWR_input_t *input, GWR_input_event_t *events, size_t max);
+// clears per-update edges and deltas, then applies the events queued when it
+// was called; later ones wait for the next update
+void GWR_input_update(GWR_input_t *input, GWR_input_snapshot_t *snap);
+// seeds a snapshot with the window state at GWR_input_create()
+void GWR_input_snapshot_init(const GWR_input_t *input, GWR_input_snapshot_t *snap);
+
+uint64_t GWR_input_get_dropped(const GWR_input_t *input);
+// unaccelerated mouse deltas while the cursor is disabled, if the platform has them
+bool GWR_input_set_raw_mouse(GWR_input_t *input, bool enabled);
+
+bool GWR_input_key_down(const GWR_input_snapshot_t *snap, int key);
+bool GWR_input_key_pressed(const GWR_input_snapshot_t *snap, int key);
+bool GWR_input_key_released(const GWR_input_snapshot_t *snap, int key);
+bool GWR_input_button_down(const GWR_input_snapshot_t *snap, int button);
+bool GWR_input_button_pressed(const GWR_input_snapshot_t *snap, int button);
+bool GWR_input_button_released(const GWR_input_snapshot_t *snap, int button);
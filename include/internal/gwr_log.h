@@ -1,5 +1,29 @@
 #pragma once
 
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+Call sites below GWR_LOG_MIN_LEVEL are compiled out by GWR_LOG_AT (FATAL is
+never removed). Define it project-wide, e.g. -DGWR_LOG_MIN_LEVEL=2 to keep
+only errors.
+
+Without GWR_log_init() every message is formatted and written on the calling
+thread. After GWR_log_init() callers only capture the format pointer and the
+raw arguments into a lock-free ring; formatting and I/O happen on a
+background thread. INFO and WARNING messages from the same call site (same
+format string) are rate-limited in both modes; ERROR and FATAL never are.
+*/
+
+#ifndef GWR_LOG_MIN_LEVEL
+#define GWR_LOG_MIN_LEVEL 0
+#endif
+
+#define GWR_LOG_DEFAULT_CAPACITY          4096
+#define GWR_LOG_DEFAULT_RATE_BURST        5
+#define GWR_LOG_DEFAULT_RATE_WINDOW_MS    1000
+
 typedef enum {
     GWR_LOG_INFO = 0,
     GWR_LOG_WARNING,
@@ -9,4 +33,75 @@ typedef enum {
     GWR_LOG__COUNT
 } GWR_log_level_e;
 
+typedef enum {
+    GWR_LOG_SYS_GENERAL = 0,
+    GWR_LOG_SYS_LOG,
+    GWR_LOG_SYS_WINDOW,
+    GWR_LOG_SYS_GLAD,
+    GWR_LOG_SYS_CAPS,
+    GWR_LOG_SYS_SHADER,
+    GWR_LOG_SYS_TEXTURE,
+    GWR_LOG_SYS_VERTEX_BUFFER,
+    GWR_LOG_SYS_ELEMENT_BUFFER,
+    GWR_LOG_SYS_VERTEX_ARRAY,
+    GWR_LOG_SYS_STREAM_BUFFER,
+    GWR_LOG_SYS_SPRITE_BATCH,
+    GWR_LOG_SYS_SIMD,
+    GWR_LOG_SYS_FRAMEBUFFER,
+    GWR_LOG_SYS_FRAMEBUFFER_POOL,
+    GWR_LOG_SYS_FRAME_GRAPH,
+    GWR_LOG_SYS_FRAME_PACER,
+    GWR_LOG_SYS_INPUT,
+    GWR_LOG_SYS_SHADER_WATCHER,
+    GWR_LOG_SYS_SHADER_PREPROC,
+    GWR_LOG_SYS_SHADER_VARIANT,
+    GWR_LOG_SYS_PROGRAM_PIPELINE,
+    GWR_LOG_SYS_MESH,
+    GWR_LOG_SYS_MESH_OPT,
+    GWR_LOG_SYS_QUANT,
+    GWR_LOG_SYS_PIPELINE_STATE,
+    GWR_LOG_SYS_SAMPLER,
+    GWR_LOG_SYS_BIND,
+    GWR_LOG_SYS_READBACK,
+    GWR_LOG_SYS_GL_DEBUG,
+    GWR_LOG_SYS_MEMORY,
+    GWR_LOG_SYS_RESOURCE,
+    GWR_LOG_SYS_VFS,
+    GWR_LOG_SYS_TRACE,
+
+    GWR_LOG_SYS__COUNT
+} GWR_log_sys_e;
+
+// `line` is the fully formatted message without a trailing newline
+typedef void (*GWR_log_sink_fn)(GWR_log_level_e level, GWR_log_sys_e sys, const char *line, void *user);
+
+#define GWR_LOG_AT(sys, level, msg, ...)                                                    \
+    do {                                                                                    \
+        if (((int) (level) >= GWR_LOG_MIN_LEVEL || (level) == GWR_LOG_FATAL) &&             \
+            GWR_log_is_enabled((sys), (level))) {                                           \
+            GWR_log_sys((sys), (level), msg, ##__VA_ARGS__);                                \
+        }                                                                                   \
+    } while (0)
+
+// starts the drain thread; capacity is rounded up to a power of two (0 = default)
+bool GWR_log_init(size_t capacity);
+// drains pending messages and stops the drain thread; no-op if not initialized
+void GWR_log_shutdown(void);
+// blocks until every message logged before the call has reached the sink
+void GWR_log_flush(void);
+
+void GWR_log_set_level(GWR_log_sys_e sys, GWR_log_level_e level);
+void GWR_log_set_level_all(GWR_log_level_e level);
+GWR_log_level_e GWR_log_get_level(GWR_log_sys_e sys);
+bool GWR_log_is_enabled(GWR_log_sys_e sys, GWR_log_level_e level);
+
+// NULL restores the default sink (INFO/WARNING to stdout, ERROR/FATAL to stderr);
+// the sink is called from the drain thread once GWR_log_init() has run
+void GWR_log_set_sink(GWR_log_sink_fn sink, void *user);
+// at most `burst` INFO/WARNING messages per call site per window; burst 0 disables limiting
+void GWR_log_set_rate_limit(uint32_t burst, uint32_t window_ms);
+// messages dropped because the ring was full
+uint64_t GWR_log_get_dropped(void);
+
 void GWR_log(GWR_log_level_e level, const char *msg, ...);
+void GWR_log_sys(GWR_log_sys_e sys, GWR_log_level_e level, const char *msg, ...);
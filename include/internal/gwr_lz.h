@@ -0,0 +1,28 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/*
+Byte-oriented LZ77 block codec in the LZ4 block layout: a token with 4-bit
+literal and match lengths, 255-continued length bytes, literals, then a
+16-bit little-endian match offset. There is no frame or checksum; callers
+store the compressed and decompressed sizes themselves (see gwr_pak_format.h).
+
+    const size_t cap = GWR_lz_bound(n);
+    size_t packed = GWR_lz_compress(src, n, dst, cap);     // 0 if it did not fit
+    GWR_lz_decompress(dst, packed, out, n);
+
+The compressor is a single-probe greedy matcher tuned for fast decode, not
+ratio. The decompressor checks every length and offset against both buffers
+and fails rather than reading or writing out of range.
+*/
+
+// worst-case output size for `n` input bytes
+size_t GWR_lz_bound(size_t n);
+
+// compressed size, or 0 if `cap` is too small
+size_t GWR_lz_compress(const void *src, size_t n, void *dst, size_t cap);
+
+// true only if `src` decodes to exactly `dst_size` bytes
+bool GWR_lz_decompress(const void *src, size_t n, void *dst, size_t dst_size);
@@ -3,8 +3,8 @@
 // constants
 
 #define GWR_PI 3.14159265358979323846f
-#define GWR_DEG2RAD (GLT_PI / 180.f)
-#define GWR_RAD2DEG (180.f / GLT_PI)
+#define GWR_DEG2RAD (GWR_PI / 180.f)
+#define GWR_RAD2DEG (180.f / GWR_PI)
 
 // types
 
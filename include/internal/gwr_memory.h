@@ -0,0 +1,105 @@
+#pragma once
+
+#include "glad/glad.h"
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+/*
+GPU memory accounting. Buffers, textures, stream buffers and readback rings
+record their allocations here by category and by the tag scope active on
+the creating thread, so the totals answer "what does the library hold, and
+for what":
+
+    GWR_mem_push_tag("level 3");
+    ... load meshes and textures ...
+    GWR_mem_pop_tag();
+
+    GWR_mem_set_budget(GWR_MEM_TEXTURE, 512ll << 20, evict_textures, cache);
+    GWR_mem_dump(stdout);
+
+Sizes are estimates of what the driver allocates: full mip chains, samples
+and layers, block sizes for compressed formats; driver padding is not known.
+GWR_mem_query_driver() reads GL_NVX_gpu_memory_info or GL_ATI_meminfo where
+present so the two can be compared.
+
+A budget callback runs on the allocating thread after the allocation that
+crossed the budget has been recorded, and may free resources to get back
+under it.
+*/
+
+#define GWR_MEM_MAX_TAGS      128
+#define GWR_MEM_TAG_NAME_SIZE 32
+#define GWR_MEM_TAG_DEPTH     8
+
+typedef enum {
+    GWR_MEM_VERTEX_BUFFER = 0,
+    GWR_MEM_ELEMENT_BUFFER,
+    GWR_MEM_STREAM_BUFFER,
+    GWR_MEM_TEXTURE,
+    GWR_MEM_RENDER_TARGET,
+    GWR_MEM_READBACK,
+    GWR_MEM_OTHER,
+
+    GWR_MEM__COUNT
+} GWR_mem_category_e;
+
+// index into the tag table; 0 is "untagged"
+typedef uint16_t GWR_mem_tag_t;
+
+typedef struct {
+    int64_t current;
+    int64_t peak;
+    int64_t live;                   // allocations not yet freed
+    int64_t allocs;                 // since start
+    int64_t budget;                 // 0 = none
+} GWR_mem_stats_t;
+
+typedef struct {
+    char name[GWR_MEM_TAG_NAME_SIZE];
+    int64_t current;
+    int64_t peak;
+} GWR_mem_tag_stats_t;
+
+// bytes, -1 where the extension does not report it
+typedef struct {
+    const char *source;             // "NVX", "ATI" or NULL if neither is present
+    int64_t dedicated;
+    int64_t total_available;
+    int64_t current_available;
+    int64_t evicted;
+    int64_t eviction_count;
+} GWR_mem_driver_info_t;
+
+typedef void (*GWR_mem_budget_fn)(GWR_mem_category_e category, int64_t over_by, void *user);
+
+// tags apply to allocations made on the calling thread until popped
+void GWR_mem_push_tag(const char *name);
+void GWR_mem_pop_tag(void);
+
+// resource modules call these; the returned tag is passed back on free
+GWR_mem_tag_t GWR_mem_record_alloc(GWR_mem_category_e category, int64_t bytes);
+void GWR_mem_record_resize(GWR_mem_category_e category, GWR_mem_tag_t tag, int64_t old_bytes, int64_t new_bytes);
+void GWR_mem_record_free(GWR_mem_category_e category, GWR_mem_tag_t tag, int64_t bytes);
+
+// budget 0 removes it; fn may be NULL to only count
+void GWR_mem_set_budget(GWR_mem_category_e category, int64_t budget, GWR_mem_budget_fn fn, void *user);
+
+GWR_mem_stats_t GWR_mem_get_stats(GWR_mem_category_e category);
+// every category summed; budget is 0
+GWR_mem_stats_t GWR_mem_get_total(void);
+// copies up to `max` tags that ever held memory; returns how many
+int GWR_mem_get_tags(GWR_mem_tag_stats_t *out, int max);
+// peaks restart from the current values
+void GWR_mem_reset_peaks(void);
+
+// false if neither memory info extension is present
+bool GWR_mem_query_driver(GWR_mem_driver_info_t *info);
+
+void GWR_mem_dump(FILE *out);
+
+const char *GWR_mem_category_name(GWR_mem_category_e category);
+
+// bytes of `levels` mips (0 = full chain) x layers x samples; block-compressed formats included
+int64_t GWR_mem_texture_size(GLenum internal_format, GLsizei width, GLsizei height, GLsizei layers, GLsizei levels, GLsizei samples);
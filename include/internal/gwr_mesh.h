@@ -0,0 +1,50 @@
+#pragma once
+
+#include "internal/gwr_mesh_format.h"
+#include "internal/gwr_shader.h"
+#include "internal/gwr_vertex_array.h"
+
+#include <stddef.h>
+
+/*
+Meshes loaded from .gmesh files (see gwr_mesh_format.h, tools/obj2mesh).
+The file is read through the VFS: loose files are mmap'ed, stored archive
+entries are used in place. The vertex and index blobs go straight from the
+mapping into immutable buffer storage, there is no parse step and no copy on
+our side. The view is dropped once the upload is submitted; only the small
+lod and meshlet tables are kept in memory.
+
+    GWR_mesh_t *mesh = GWR_mesh_load("models/bunny.gmesh");
+    GWR_mesh_draw(mesh, shader, 0);
+*/
+
+typedef struct GWR_mesh_t GWR_mesh_t;
+
+GWR_mesh_t *GWR_mesh_load(const char *path);
+void GWR_mesh_destroy(GWR_mesh_t *mesh);
+
+// points the vertex array at interleaved `vbo` data described by `attribs`,
+// the same descriptors .gmesh files and GWR_quant_attrib use
+void GWR_mesh_apply_layout(
+    const GWR_vertex_array_t *vao,
+    const GWR_vertex_buffer_t *vbo,
+    const GWR_mesh_attrib_t *attribs,
+    size_t attrib_count,
+    uint32_t stride
+);
+
+// draws every triangle of `lod` (clamped to the coarsest one)
+void GWR_mesh_draw(const GWR_mesh_t *mesh, const GWR_shader_t *shader, size_t lod);
+
+const GWR_vertex_array_t *GWR_mesh_get_vertex_array(const GWR_mesh_t *mesh);
+const GWR_vertex_buffer_t *GWR_mesh_get_vertex_buffer(const GWR_mesh_t *mesh);
+const GWR_element_buffer_t *GWR_mesh_get_element_buffer(const GWR_mesh_t *mesh);
+GLenum GWR_mesh_get_index_type(const GWR_mesh_t *mesh);
+size_t GWR_mesh_get_vertex_count(const GWR_mesh_t *mesh);
+size_t GWR_mesh_get_index_count(const GWR_mesh_t *mesh);
+void GWR_mesh_get_bounds(const GWR_mesh_t *mesh, float out_min[3], float out_max[3]);
+
+size_t GWR_mesh_get_lod_count(const GWR_mesh_t *mesh);
+const GWR_mesh_lod_t *GWR_mesh_get_lod(const GWR_mesh_t *mesh, size_t idx);
+size_t GWR_mesh_get_meshlet_count(const GWR_mesh_t *mesh);
+const GWR_mesh_meshlet_t *GWR_mesh_get_meshlets(const GWR_mesh_t *mesh);
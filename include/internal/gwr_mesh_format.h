@@ -0,0 +1,106 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "internal/gwr_util.h"
+
+/*
+On-disk layout of .gmesh files, shared by the loader and tools/obj2mesh.
+Everything is little-endian and laid out so the loader can hand pointers
+into the mapped file straight to the driver:
+
+    GWR_mesh_header_t
+    vertex blob     (vertex_count * vertex_stride, GWR_MESH_BLOB_ALIGNMENT aligned)
+    index blob      (index_count * index_size, aligned)
+    lod table       (lod_count * GWR_mesh_lod_t, aligned)
+    meshlet table   (meshlet_count * GWR_mesh_meshlet_t, aligned)
+
+Attributes mirror the GWR_vertex_array_attrib_pointer{f,i,l} arguments:
+`location`, `size` components of `component` type at `offset` into the
+interleaved vertex, routed through the float, integer or double path.
+*/
+
+#define GWR_MESH_MAGIC              0x4853454Du     // "MESH"
+#define GWR_MESH_VERSION            1u
+#define GWR_MESH_MAX_ATTRIBS        16
+#define GWR_MESH_BLOB_ALIGNMENT     64u
+
+typedef enum {
+    GWR_MESH_COMPONENT_F32 = 0,
+    GWR_MESH_COMPONENT_F16,
+    GWR_MESH_COMPONENT_F64,
+    GWR_MESH_COMPONENT_I8,
+    GWR_MESH_COMPONENT_U8,
+    GWR_MESH_COMPONENT_I16,
+    GWR_MESH_COMPONENT_U16,
+    GWR_MESH_COMPONENT_I32,
+    GWR_MESH_COMPONENT_U32,
+    GWR_MESH_COMPONENT_I2_10_10_10,   // packed, size must be 4
+    GWR_MESH_COMPONENT_U2_10_10_10,
+
+    GWR_MESH_COMPONENT__COUNT
+} GWR_mesh_component_e;
+
+typedef enum {
+    GWR_MESH_ATTRIB_FLOAT = 0,      // attrib_pointerf, `normalized` applies
+    GWR_MESH_ATTRIB_INT,            // attrib_pointeri
+    GWR_MESH_ATTRIB_DOUBLE,         // attrib_pointerl
+
+    GWR_MESH_ATTRIB__COUNT
+} GWR_mesh_attrib_mode_e;
+
+typedef struct {
+    uint8_t location;
+    uint8_t size;                   // 1..4
+    uint8_t component;              // GWR_mesh_component_e
+    uint8_t mode;                   // GWR_mesh_attrib_mode_e
+    uint8_t normalized;
+    uint8_t pad[3];
+    uint32_t offset;
+} GWR_mesh_attrib_t;
+
+// lod 0 is the full mesh; coarser levels follow with a growing error
+typedef struct {
+    uint32_t first_index;
+    uint32_t index_count;
+    float error;                    // object-space deviation from lod 0
+} GWR_mesh_lod_t;
+
+// a small cluster of lod 0 triangles with culling bounds
+typedef struct {
+    uint32_t first_index;
+    uint32_t index_count;
+    float center[3];
+    float radius;
+    float cone_axis[3];
+    float cone_cutoff;              // cos of the normal cone half-angle, -1 when it cannot cull
+} GWR_mesh_meshlet_t;
+
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+
+    uint32_t vertex_count;
+    uint32_t vertex_stride;
+    uint32_t index_count;
+    uint32_t index_size;            // bytes per index, 2 or 4
+    uint32_t attrib_count;
+    uint32_t lod_count;
+    uint32_t meshlet_count;
+    uint32_t flags;
+
+    uint64_t vertex_offset;
+    uint64_t index_offset;
+    uint64_t lod_offset;
+    uint64_t meshlet_offset;
+
+    float bounds_min[3];
+    float bounds_max[3];
+
+    GWR_mesh_attrib_t attribs[GWR_MESH_MAX_ATTRIBS];
+} GWR_mesh_header_t;
+
+GWR_STATIC_ASSERT(sizeof(GWR_mesh_attrib_t) == 12, "GWR_mesh_attrib_t layout changed");
+GWR_STATIC_ASSERT(sizeof(GWR_mesh_lod_t) == 12, "GWR_mesh_lod_t layout changed");
+GWR_STATIC_ASSERT(sizeof(GWR_mesh_meshlet_t) == 40, "GWR_mesh_meshlet_t layout changed");
+GWR_STATIC_ASSERT(sizeof(GWR_mesh_header_t) == 288, "GWR_mesh_header_t layout changed");
@@ -0,0 +1,58 @@
+#pragma once
+
+#include "internal/gwr_element_buffer.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+CPU passes over indexed triangle lists, meant to run once before the data
+reaches a buffer (tools/obj2mesh runs them offline). The usual order is:
+
+    vertex_count = GWR_mesh_opt_weld(vertices, vertex_count, stride, indices, index_count);
+    GWR_mesh_opt_vertex_cache(indices, indices, index_count, vertex_count);
+    GWR_mesh_opt_overdraw(indices, indices, index_count, vertices, vertex_count, stride);
+    vertex_count = GWR_mesh_opt_vertex_fetch(out_vertices, vertices, vertex_count, stride, indices, index_count);
+    GWR_element_buffer_t *ebo = GWR_mesh_opt_create_element_buffer(indices, index_count, vertex_count, GL_STATIC_DRAW);
+
+Each pass keeps the triangle set intact, only its order and the vertex
+numbering change. `dst` may alias `indices`. Positions are read as three
+floats at the start of each vertex.
+*/
+
+#define GWR_MESH_OPT_CACHE_SIZE         32      // vertex cache modelled by vertex_cache
+#define GWR_MESH_OPT_FIFO_SIZE          16      // fifo used for acmr and overdraw clustering
+
+// merges byte-identical vertices in place (first occurrence wins) and remaps
+// indices; returns the new vertex count
+size_t GWR_mesh_opt_weld(void *vertices, size_t vertex_count, size_t stride, uint32_t *indices, size_t index_count);
+
+// Forsyth's linear-speed vertex cache optimisation
+bool GWR_mesh_opt_vertex_cache(uint32_t *dst, const uint32_t *indices, size_t index_count, size_t vertex_count);
+
+// splits the triangle order into clusters whose acmr stays close to the
+// input's and draws outward-facing clusters first; run after vertex_cache
+bool GWR_mesh_opt_overdraw(
+    uint32_t *dst, const uint32_t *indices, size_t index_count,
+    const void *vertices, size_t vertex_count, size_t stride
+);
+
+// renumbers vertices in first-use order and copies them to `dst` (which must
+// not alias `vertices`); unreferenced ones are dropped, returns the new count
+size_t GWR_mesh_opt_vertex_fetch(
+    void *dst, const void *vertices, size_t vertex_count, size_t stride,
+    uint32_t *indices, size_t index_count
+);
+
+// average cache misses per triangle for a GWR_MESH_OPT_FIFO_SIZE fifo, 0.5..3
+float GWR_mesh_opt_acmr(const uint32_t *indices, size_t index_count, size_t vertex_count);
+
+// narrowest index type that can address `vertex_count` vertices
+GLenum GWR_mesh_opt_index_type(size_t vertex_count);
+// writes `indices` as `type` into dst (which may alias), returns bytes written
+size_t GWR_mesh_opt_pack_indices(void *dst, const uint32_t *indices, size_t index_count, GLenum type);
+// element buffer with the narrowest index type for the mesh
+GWR_element_buffer_t *GWR_mesh_opt_create_element_buffer(
+    const uint32_t *indices, size_t index_count, size_t vertex_count, GLenum usage
+);
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "internal/gwr_util.h"
+
+/*
+On-disk layout of .gpak archives, shared by the VFS and tools/mkpak.
+Everything is little-endian:
+
+    GWR_pak_header_t
+    entry data      (each entry GWR_PAK_ALIGNMENT aligned)
+    names           (names_size bytes, not NUL-terminated)
+    toc             (entry_count * GWR_pak_entry_t, sorted by hash)
+
+Names are paths relative to the packed root with '/' separators. Stored
+entries are one contiguous run of bytes, so a mapped archive hands them out
+without copying and .gmesh blobs keep their alignment. GWR_PAK_LZ entries are
+cut into block_size pieces compressed independently with gwr_lz;
+`blocks_offset` points at block_count + 1 offsets, relative to `offset`, that
+bound each compressed block. A block whose compressed length equals its
+decompressed length is stored raw. Any range of the entry can be read by
+decoding only the blocks that cover it.
+*/
+
+#define GWR_PAK_MAGIC               0x4B415047u     // "GPAK"
+#define GWR_PAK_VERSION             1u
+#define GWR_PAK_ALIGNMENT           64u
+#define GWR_PAK_DEFAULT_BLOCK_SIZE  (64u * 1024u)
+
+typedef enum {
+    GWR_PAK_STORED = 0,
+    GWR_PAK_LZ,
+} GWR_pak_compression_e;
+
+typedef struct {
+    uint64_t hash;                  // GWR_pak_hash(name)
+    uint64_t offset;                // data or first block
+    uint64_t size;                  // decompressed
+    uint64_t stored_size;           // bytes at `offset`, block table excluded
+    uint64_t blocks_offset;         // GWR_PAK_LZ only
+    uint32_t name_offset;           // into the names blob
+    uint32_t name_length;
+    uint32_t compression;           // GWR_pak_compression_e
+    uint32_t block_count;
+} GWR_pak_entry_t;
+
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t entry_count;
+    uint32_t block_size;
+    uint64_t names_offset;
+    uint64_t names_size;
+    uint64_t toc_offset;
+} GWR_pak_header_t;
+
+// FNV-1a over the normalized name
+static inline uint64_t GWR_pak_hash(const char *name, size_t len) {
+    return GWR_fnv1a(GWR_FNV_OFFSET, name, len);
+}
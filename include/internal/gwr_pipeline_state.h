@@ -0,0 +1,93 @@
+#pragma once
+
+#include "glad/glad.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/*
+Immutable blend/depth/stencil/raster bundles. A cache interns descriptors by
+hash, so equal descriptors yield the same state object and the same small id,
+and remembers what it last applied, so applying a state only issues the GL
+calls for fields that differ.
+
+    GWR_pipeline_state_desc_t desc = GWR_pipeline_state_desc_default();
+    desc.blend_enable = true;
+    desc.blend_src_rgb = desc.blend_src_alpha = GL_SRC_ALPHA;
+    desc.blend_dst_rgb = desc.blend_dst_alpha = GL_ONE_MINUS_SRC_ALPHA;
+    desc.depth_write = false;
+    const GWR_pipeline_state_t *transparent = GWR_pipeline_state_cache_get(cache, &desc);
+
+    GWR_pipeline_state_apply(transparent);
+
+Applied state is tracked per cache, so use one cache per GL context. Call
+GWR_pipeline_state_cache_invalidate() after touching any of these states with
+raw GL, the next apply then sets every field.
+*/
+
+typedef struct {
+    bool blend_enable;
+    GLenum blend_src_rgb;
+    GLenum blend_dst_rgb;
+    GLenum blend_src_alpha;
+    GLenum blend_dst_alpha;
+    GLenum blend_op_rgb;
+    GLenum blend_op_alpha;
+    bool color_write[4];
+
+    bool depth_test;
+    bool depth_write;
+    GLenum depth_func;
+
+    bool stencil_test;
+    GLenum stencil_func;
+    GLint stencil_ref;
+    GLuint stencil_read_mask;
+    GLuint stencil_write_mask;
+    GLenum stencil_fail;
+    GLenum stencil_depth_fail;
+    GLenum stencil_pass;
+
+    GLenum cull_face;               // GL_NONE disables culling
+    GLenum front_face;
+    GLenum polygon_mode;
+
+    bool polygon_offset;            // for GL_FILL
+    float polygon_offset_factor;
+    float polygon_offset_units;
+} GWR_pipeline_state_desc_t;
+
+typedef struct {
+    uint64_t requests;
+    uint64_t hits;
+    uint64_t applies;
+    uint64_t redundant_applies;     // same state as the last apply
+    uint64_t gl_calls;
+} GWR_pipeline_state_stats_t;
+
+typedef struct GWR_pipeline_state_t GWR_pipeline_state_t;
+typedef struct GWR_pipeline_state_cache_t GWR_pipeline_state_cache_t;
+
+// GL defaults: no blending, depth test off, no stencil, no culling, CCW, fill
+GWR_pipeline_state_desc_t GWR_pipeline_state_desc_default(void);
+
+GWR_pipeline_state_cache_t *GWR_pipeline_state_cache_create(void);
+// destroys every state the cache interned
+void GWR_pipeline_state_cache_destroy(GWR_pipeline_state_cache_t *cache);
+
+// NULL on failure; the state belongs to the cache and lives as long as it
+const GWR_pipeline_state_t *GWR_pipeline_state_cache_get(
+    GWR_pipeline_state_cache_t *cache,
+    const GWR_pipeline_state_desc_t *desc
+);
+
+// forgets the applied state, the next apply sets every field
+void GWR_pipeline_state_cache_invalidate(GWR_pipeline_state_cache_t *cache);
+
+GWR_pipeline_state_stats_t GWR_pipeline_state_cache_get_stats(const GWR_pipeline_state_cache_t *cache);
+
+void GWR_pipeline_state_apply(const GWR_pipeline_state_t *state);
+
+// dense, starting at 1, unique within the owning cache; suited to sort keys
+uint16_t GWR_pipeline_state_get_id(const GWR_pipeline_state_t *state);
+const GWR_pipeline_state_desc_t *GWR_pipeline_state_get_desc(const GWR_pipeline_state_t *state);
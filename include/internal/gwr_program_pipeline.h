@@ -0,0 +1,64 @@
+#pragma once
+
+#include "internal/gwr_shader.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+Program pipelines combine single-stage separable programs at bind time, so
+N vertex and M fragment variants cost N + M links instead of N * M, and
+swapping only the fragment stage does not touch the vertex program.
+
+    GWR_shader_t *vs = GWR_shader_create_separable_path(GL_VERTEX_SHADER, "shaders/mesh.vert");
+    GWR_shader_t *fs = GWR_shader_create_separable_path(GL_FRAGMENT_SHADER, "shaders/lit.frag");
+    GWR_program_pipeline_bind(GWR_program_pipeline_cache_get(cache, vs, fs));
+
+Uniforms go to the stage programs themselves (GWR_shader_set_val_* already
+uses glProgramUniform*). A program bound with GWR_shader_use() overrides any
+pipeline, so binding a pipeline unbinds the current program.
+*/
+
+typedef struct GWR_program_pipeline_t GWR_program_pipeline_t;
+
+GWR_program_pipeline_t *GWR_program_pipeline_create(void);
+void GWR_program_pipeline_destroy(GWR_program_pipeline_t *pipeline);
+
+// attaches `program` to every stage in its GWR_shader_get_stages() mask
+void GWR_program_pipeline_set_stages(GWR_program_pipeline_t *pipeline, const GWR_shader_t *program);
+void GWR_program_pipeline_clear_stages(GWR_program_pipeline_t *pipeline, GLbitfield stages);
+
+// checks the stage interfaces against the current GL state, logs the info log on failure
+bool GWR_program_pipeline_validate(const GWR_program_pipeline_t *pipeline);
+
+void GWR_program_pipeline_bind(const GWR_program_pipeline_t *pipeline);
+void GWR_program_pipeline_unbind(void);
+GLuint GWR_program_pipeline_get_id(const GWR_program_pipeline_t *pipeline);
+
+/*
+Pipelines keyed by their (vertex, fragment) program ids. The cache owns the
+pipelines, the programs stay with the caller and must outlive their pipelines.
+*/
+
+typedef struct {
+    uint64_t requests;
+    uint64_t hits;
+    size_t pipelines;
+} GWR_program_pipeline_cache_stats_t;
+
+typedef struct GWR_program_pipeline_cache_t GWR_program_pipeline_cache_t;
+
+GWR_program_pipeline_cache_t *GWR_program_pipeline_cache_create(void);
+void GWR_program_pipeline_cache_destroy(GWR_program_pipeline_cache_t *cache);
+
+// NULL on failure
+GWR_program_pipeline_t *GWR_program_pipeline_cache_get(
+    GWR_program_pipeline_cache_t *cache,
+    const GWR_shader_t *vertex,
+    const GWR_shader_t *fragment
+);
+// destroys every pipeline using `program`, call before destroying it
+void GWR_program_pipeline_cache_evict(GWR_program_pipeline_cache_t *cache, const GWR_shader_t *program);
+
+GWR_program_pipeline_cache_stats_t GWR_program_pipeline_cache_get_stats(const GWR_program_pipeline_cache_t *cache);
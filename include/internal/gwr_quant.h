@@ -0,0 +1,97 @@
+#pragma once
+
+#include "internal/gwr_mesh_format.h"
+#include "internal/gwr_simd.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "cglm/cglm.h"
+
+/*
+Vertex attribute quantization. Each GWR_quant_format_e has an encoder and a
+GWR_mesh_attrib_t descriptor (GWR_quant_attrib) that GWR_mesh_apply_layout
+feeds to the vertex array, so the GPU expands the compact data for free:
+
+    positions   snorm16x4 relative to GWR_quant_bounds_t, or half4
+    normals     octahedral snorm16x2, or snorm 2_10_10_10 (w = handedness)
+    uvs         half2
+    colors      unorm8x4
+
+The batch encoders share the backend of gwr_simd (AVX2 adds F16C for
+halves, SSE2 covers the rest, NEON and scalar use the reference code).
+
+snorm16 positions come out in -1..1 and need the bounds in the shader, and
+octahedral normals need unfolding:
+
+    pos = a_pos.xyz * u_extent + u_center;
+
+    vec3 oct_decode(vec2 e) {
+        vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+        float t = max(-n.z, 0.0);
+        n.xy += vec2(n.x >= 0.0 ? -t : t, n.y >= 0.0 ? -t : t);
+        return normalize(n);
+    }
+*/
+
+typedef enum {
+    GWR_QUANT_FLOAT32x3 = 0,        // unquantized, 12 bytes
+    GWR_QUANT_HALF4,                // 8 bytes
+    GWR_QUANT_HALF2,                // 4 bytes
+    GWR_QUANT_SNORM16x4,            // 8 bytes
+    GWR_QUANT_OCT_SNORM16x2,        // 4 bytes, decode in the shader
+    GWR_QUANT_SNORM_2_10_10_10,     // 4 bytes
+    GWR_QUANT_UNORM8x4,             // 4 bytes
+
+    GWR_QUANT__COUNT
+} GWR_quant_format_e;
+
+// snorm16 positions encode (p - center) / extent
+typedef struct {
+    vec3 center;
+    vec3 extent;                    // half size, never 0
+} GWR_quant_bounds_t;
+
+// 20 bytes against 32 for GWR_vert_t, and it carries a normal
+typedef struct {
+    int16_t pos[4];                 // GWR_QUANT_SNORM16x4, w = 1
+    int16_t normal[2];              // GWR_QUANT_OCT_SNORM16x2
+    uint16_t tex_coord[2];          // GWR_QUANT_HALF2
+    uint8_t color[4];               // GWR_QUANT_UNORM8x4
+} GWR_quant_vert_t;
+
+#define GWR_QUANT_VERT_ATTRIBS  4
+
+uint32_t GWR_quant_format_size(GWR_quant_format_e format);
+GWR_mesh_attrib_t GWR_quant_attrib(uint8_t location, GWR_quant_format_e format, uint32_t offset);
+// locations 0 pos, 1 normal, 2 tex_coord, 3 color; returns the attribute count
+size_t GWR_quant_vert_layout(GWR_mesh_attrib_t out[GWR_QUANT_VERT_ATTRIBS]);
+
+// single values
+uint16_t GWR_quant_half(float v);
+float GWR_quant_half_to_float(uint16_t h);
+int16_t GWR_quant_snorm16(float v);
+uint8_t GWR_quant_unorm8(float v);
+void GWR_quant_oct(const vec3 n, int16_t out[2]);
+void GWR_quant_oct_decode(const int16_t in[2], vec3 out);
+// w is the tangent handedness, -1, 0 or 1
+uint32_t GWR_quant_snorm_2_10_10_10(const vec3 v, float w);
+
+GWR_quant_bounds_t GWR_quant_compute_bounds(const vec3 *positions, size_t n);
+
+// batch encoders over flat arrays
+void GWR_quant_encode_half_n(const float *in, uint16_t *out, size_t n);
+void GWR_quant_encode_unorm8_n(const float *in, uint8_t *out, size_t n);
+// positions, w is written as 1
+void GWR_quant_encode_positions_snorm16(const vec3 *in, const GWR_quant_bounds_t *bounds, int16_t (*out)[4], size_t n);
+// positions relative to `center` (may be NULL), w is written as 1
+void GWR_quant_encode_positions_half(const vec3 *in, const float *center, uint16_t (*out)[4], size_t n);
+void GWR_quant_encode_normals_oct(const vec3 *in, int16_t (*out)[2], size_t n);
+// w may be NULL for 0
+void GWR_quant_encode_normals_2_10_10_10(const vec3 *in, const float *w, uint32_t *out, size_t n);
+
+// any input but positions may be NULL and is then zeroed (white for colors)
+void GWR_quant_encode_verts(
+    const vec3 *positions, const vec3 *normals, const vec2 *tex_coords, const vec4 *colors,
+    const GWR_quant_bounds_t *bounds, GWR_quant_vert_t *out, size_t n
+);
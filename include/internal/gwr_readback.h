@@ -0,0 +1,80 @@
+#pragma once
+
+#include "glad/glad.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+Asynchronous pixel readback. Each capture reads into one of `slots` pixel
+pack buffers and fences it; GWR_readback_poll() checks the fences without
+blocking and hands finished frames to a worker thread, which calls the
+frame callback (e.g. to encode or dump it) off the render thread. A slot
+returns to the ring once the callback is done with it, so a slow consumer
+drops captures instead of stalling the GPU.
+
+    GWR_readback_t *rb = GWR_readback_create(w, h, GL_RGBA, 3, GWR_readback_dump_ppm, "capture_%05llu.ppm");
+
+    // every frame, after rendering
+    GWR_readback_capture(rb, 0, 0);
+    GWR_readback_poll(rb);
+
+With buffer storage the pack buffers stay persistently mapped and the worker
+reads them in place; otherwise poll() copies each finished frame out of a
+temporary mapping.
+*/
+
+#define GWR_READBACK_DEFAULT_SLOTS 3
+
+typedef struct {
+    const uint8_t *data;            // bottom row first, as GL returns it
+    GLsizei width;
+    GLsizei height;
+    GLsizei stride;                 // bytes per row
+    GLenum format;                  // GL_RGBA, GL_BGRA or GL_RGB, GL_UNSIGNED_BYTE
+    uint64_t index;                 // capture counter, dropped captures included
+} GWR_readback_frame_t;
+
+// runs on the worker thread; `frame->data` is only valid during the call
+typedef void (*GWR_readback_frame_fn)(const GWR_readback_frame_t *frame, void *user);
+
+typedef struct {
+    uint64_t captured;
+    uint64_t completed;
+    uint64_t dropped;               // no free slot at capture time
+} GWR_readback_stats_t;
+
+typedef struct GWR_readback_t GWR_readback_t;
+
+GWR_readback_t *GWR_readback_create(
+    GLsizei width,
+    GLsizei height,
+    GLenum format,
+    GLsizei slots,
+    GWR_readback_frame_fn fn,
+    void *user
+);
+// frames still in flight are dropped; queued ones are delivered first
+void GWR_readback_destroy(GWR_readback_t *rb);
+
+// reads width x height at (x, y) of the current read framebuffer; false if dropped
+bool GWR_readback_capture(GWR_readback_t *rb, GLint x, GLint y);
+// reads level `level` of a 2D texture (needs DSA); false if dropped
+bool GWR_readback_capture_texture(GWR_readback_t *rb, GLuint texture, GLint level);
+
+// non-blocking: moves every finished capture to the worker
+void GWR_readback_poll(GWR_readback_t *rb);
+// blocks until every capture so far has been delivered
+void GWR_readback_flush(GWR_readback_t *rb);
+
+GWR_readback_stats_t GWR_readback_get_stats(const GWR_readback_t *rb);
+
+// ready-made callbacks; `user` is a printf pattern taking the frame index as unsigned long long
+void GWR_readback_dump_ppm(const GWR_readback_frame_t *frame, void *user);
+void GWR_readback_dump_raw(const GWR_readback_frame_t *frame, void *user);
+
+// binary PPM (P6), flipped top row first, alpha dropped
+bool GWR_readback_write_ppm(const char *path, const GWR_readback_frame_t *frame);
+// the frame bytes as they are
+bool GWR_readback_write_raw(const char *path, const GWR_readback_frame_t *frame);
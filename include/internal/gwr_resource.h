@@ -0,0 +1,88 @@
+#pragma once
+
+#include "internal/gwr_texture.h"
+#include "internal/gwr_shader.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/*
+Shared, reference-counted textures and shaders keyed by what they were loaded
+from. The first acquire of a key loads it; later acquires return the same
+handle with its refcount bumped, and an acquire that arrives while another
+thread is still loading that key waits for that load instead of starting a
+second one.
+
+    GWR_resource_cache_t *cache = GWR_resource_cache_create(256ll << 20);
+
+    GWR_resource_t *albedo = GWR_resource_acquire_texture(cache, "assets/rock.png");
+    GWR_resource_t *lit = GWR_resource_acquire_shader(cache, "shaders/lit.vert", "shaders/lit.frag");
+    ... GWR_resource_get_texture(albedo), GWR_resource_get_shader(lit) ...
+    GWR_resource_release(albedo);
+    GWR_resource_release(lit);
+
+Keys are built from the resolved file paths (realpath, falling back to the
+path as given), so "a/../b.png" and "b.png" share an entry. Released entries
+stay resident in LRU order and are only destroyed once the resident total
+exceeds the budget, so a level transition that releases and re-acquires the
+same assets does not reload them.
+
+Loads and evictions make GL calls on the calling thread, which needs a
+current context; loader threads use windows created with
+GWR_window_create_shared(). A handle loaded in one context and first used
+from another is fenced with glWaitSync before it is returned.
+
+Failed loads are not remembered: the acquire (and any waiters) return NULL
+and the next acquire tries again.
+*/
+
+typedef enum {
+    GWR_RESOURCE_TEXTURE = 0,
+    GWR_RESOURCE_TEXTURE_ARRAY,
+    GWR_RESOURCE_SHADER,            // VS + FS program
+    GWR_RESOURCE_SEPARABLE,         // single-stage separable program
+} GWR_resource_kind_e;
+
+typedef struct {
+    uint64_t requests;
+    uint64_t hits;                  // resident, including released entries
+    uint64_t waits;                 // joined a load in flight on another thread
+    uint64_t loads;
+    uint64_t failures;
+    uint64_t evictions;
+    int64_t resident_bytes;         // estimate: texture memory, program binary length
+    int64_t unused_bytes;           // resident with no references
+    int resident;
+    int unused;
+} GWR_resource_stats_t;
+
+typedef struct GWR_resource_t GWR_resource_t;
+typedef struct GWR_resource_cache_t GWR_resource_cache_t;
+
+// budget in bytes for everything resident; 0 evicts released entries immediately
+GWR_resource_cache_t *GWR_resource_cache_create(int64_t budget);
+// destroys every resident resource; handles still referenced are reported and destroyed too
+void GWR_resource_cache_destroy(GWR_resource_cache_t *cache);
+
+void GWR_resource_cache_set_budget(GWR_resource_cache_t *cache, int64_t budget);
+// evicts unreferenced entries, least recently released first, until the resident
+// total is at most `target` bytes; returns the bytes freed
+int64_t GWR_resource_cache_trim(GWR_resource_cache_t *cache, int64_t target);
+GWR_resource_stats_t GWR_resource_cache_get_stats(GWR_resource_cache_t *cache);
+
+// each successful acquire holds one reference; NULL on failure
+GWR_resource_t *GWR_resource_acquire_texture(GWR_resource_cache_t *cache, const char *path);
+GWR_resource_t *GWR_resource_acquire_texture_array(GWR_resource_cache_t *cache, const char *const *paths, GLsizei count);
+GWR_resource_t *GWR_resource_acquire_shader(GWR_resource_cache_t *cache, const char *vertex_path, const char *fragment_path);
+GWR_resource_t *GWR_resource_acquire_separable(GWR_resource_cache_t *cache, GLenum type, const char *path);
+
+void GWR_resource_retain(GWR_resource_t *res);
+// the last release moves the entry to the LRU list; it is not destroyed until evicted
+void GWR_resource_release(GWR_resource_t *res);
+
+GWR_resource_kind_e GWR_resource_get_kind(const GWR_resource_t *res);
+// NULL if the handle holds the other kind
+GWR_texture_t *GWR_resource_get_texture(const GWR_resource_t *res);
+GWR_shader_t *GWR_resource_get_shader(const GWR_resource_t *res);
+int GWR_resource_get_refs(GWR_resource_t *res);
+int64_t GWR_resource_get_size(const GWR_resource_t *res);
@@ -0,0 +1,74 @@
+#pragma once
+
+#include "glad/glad.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/*
+Sampler objects keep filtering, wrapping and comparison out of the texture,
+so one image can be sampled several ways. A sampler bound to a unit
+overrides the texture's parameters; loaded images keep GL's defaults and
+render targets from GWR_texture_create() default to clamp + linear.
+
+    GWR_sampler_desc_t desc = GWR_sampler_desc_default();
+    desc.max_anisotropy = 8.f;
+    const GWR_sampler_t *aniso = GWR_sampler_cache_get(cache, &desc);
+
+    desc = GWR_sampler_desc_default();
+    desc.min_filter = desc.mag_filter = GL_NEAREST;
+    const GWR_sampler_t *point = GWR_sampler_cache_get(cache, &desc);
+
+    const GWR_sampler_t *samplers[] = {aniso, point};
+    GWR_sampler_bind_range(0, GWR_ARR_LEN(samplers), samplers);
+
+The cache interns samplers by descriptor, so equal descriptors share one GL
+object. Binding a range uses glBindSamplers when multi-bind is available.
+*/
+
+typedef struct {
+    GLenum min_filter;
+    GLenum mag_filter;
+    GLenum wrap_s;
+    GLenum wrap_t;
+    GLenum wrap_r;
+    float max_anisotropy;           // 1 disables, clamped to the device maximum
+    float lod_bias;
+    float min_lod;
+    float max_lod;
+    bool compare;                   // depth comparison for shadow samplers
+    GLenum compare_func;
+    float border_color[4];          // for GL_CLAMP_TO_BORDER
+} GWR_sampler_desc_t;
+
+typedef struct {
+    uint64_t requests;
+    uint64_t hits;
+} GWR_sampler_cache_stats_t;
+
+typedef struct GWR_sampler_t GWR_sampler_t;
+typedef struct GWR_sampler_cache_t GWR_sampler_cache_t;
+
+// repeat + trilinear, what textures used to bake into themselves
+GWR_sampler_desc_t GWR_sampler_desc_default(void);
+// clamp to edge + linear, no mipmaps; for sampling render targets
+GWR_sampler_desc_t GWR_sampler_desc_clamp_linear(void);
+
+GWR_sampler_t *GWR_sampler_create(const GWR_sampler_desc_t *desc);
+void GWR_sampler_destroy(GWR_sampler_t *sampler);
+
+GLuint GWR_sampler_get_id(const GWR_sampler_t *sampler);
+const GWR_sampler_desc_t *GWR_sampler_get_desc(const GWR_sampler_t *sampler);
+
+void GWR_sampler_bind(GLuint unit, const GWR_sampler_t *sampler);
+// NULL entries (or a NULL array) unbind; one glBindSamplers call with multi-bind
+void GWR_sampler_bind_range(GLuint first, GLsizei count, const GWR_sampler_t *const *samplers);
+
+GWR_sampler_cache_t *GWR_sampler_cache_create(void);
+// destroys every sampler the cache made
+void GWR_sampler_cache_destroy(GWR_sampler_cache_t *cache);
+
+// NULL on failure; the sampler belongs to the cache
+const GWR_sampler_t *GWR_sampler_cache_get(GWR_sampler_cache_t *cache, const GWR_sampler_desc_t *desc);
+
+GWR_sampler_cache_stats_t GWR_sampler_cache_get_stats(const GWR_sampler_cache_t *cache);
@@ -1,6 +1,8 @@
 #pragma once
 
 #include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
 
 #include "glad/glad.h"
 
@@ -36,6 +38,13 @@ typedef enum {
     GWR_SHADER_UNIFORM__COUNT
 } GWR_shader_uniform_data_type_t;
 
+typedef enum {
+    GWR_SHADER_RELOAD_IDLE = 0,     // nothing in flight
+    GWR_SHADER_RELOAD_PENDING,      // driver still compiling
+    GWR_SHADER_RELOAD_SWAPPED,      // new program is live
+    GWR_SHADER_RELOAD_FAILED,       // errors logged, old program kept
+} GWR_shader_reload_e;
+
 typedef struct GWR_shader_t GWR_shader_t;
 
 bool GWR_shader_is_valid(const GWR_shader_t *shader);
@@ -47,10 +56,42 @@ GWR_shader_t *GWR_shader_create(GLuint vertex_shader, GLuint fragment_shader);
 GWR_shader_t *GWR_shader_create_src(const char *vertex_shader_src, const char *fragment_shader_src);
 GWR_shader_t *GWR_shader_create_path(const char *vertex_shader_path, const char *fragment_shader_path);
 
+// single-stage GL_PROGRAM_SEPARABLE programs, combined by GWR_program_pipeline_t
+GWR_shader_t *GWR_shader_create_separable(GLenum type, GLuint stage_shader);
+GWR_shader_t *GWR_shader_create_separable_src(GLenum type, const char *src);
+GWR_shader_t *GWR_shader_create_separable_path(GLenum type, const char *path);
+
 void GWR_shader_destroy(GWR_shader_t *shader);
 void GWR_shader_use(const GWR_shader_t *shader);
 GLuint GWR_shader_get_id(const GWR_shader_t *shader);
 GLint GWR_shader_get_uniform_loc(const GWR_shader_t *shader, const char *name);
+// GL_*_SHADER_BIT mask for separable programs, 0 for VS+FS ones
+GLbitfield GWR_shader_get_stages(const GWR_shader_t *shader);
+
+/*
+Stages loaded from a path go through GWR_shader_preproc_t without defines or
+include paths, so `#include "file"` resolves next to the including file.
+
+Reloading (shaders made by GWR_shader_create_path only): reload_begin
+re-reads the files and submits compile + link into a new program; with
+KHR_parallel_shader_compile the driver does that on its own threads and
+reload_poll returns PENDING until it is done. On success the program id
+inside the shader is swapped and the generation bumped, so anything caching
+uniform locations or the id must compare generations. On failure the old
+program stays.
+*/
+bool GWR_shader_reload_begin(GWR_shader_t *shader);
+GWR_shader_reload_e GWR_shader_reload_poll(GWR_shader_t *shader);
+// deletes a reload still in flight without waiting for it; the current program stays
+void GWR_shader_reload_cancel(GWR_shader_t *shader);
+bool GWR_shader_can_reload(const GWR_shader_t *shader);
+uint32_t GWR_shader_get_generation(const GWR_shader_t *shader);
+// NULL for stages that were not loaded from a file
+const char *GWR_shader_get_path(const GWR_shader_t *shader, GLenum type);
+// files the last expansion of the path stages read: the stage files and their
+// includes; updated by reload_begin
+size_t GWR_shader_get_dep_count(const GWR_shader_t *shader);
+const char *GWR_shader_get_dep(const GWR_shader_t *shader, size_t idx);
 
 void GWR_shader_set_val_loc(
     const GWR_shader_t *shader,
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/*
+Text-level preprocessing before the GLSL compiler sees a stage:
+
+  - `#include "file"` is looked up next to the including file, then in the
+    search paths; `#include <file>` only in the search paths. `#pragma once`
+    is honoured. Every file gets `#line <n> <index>` markers, so compiler
+    errors like "2(17)" mean line 17 of GWR_shader_preproc_get_file(pp, 2).
+  - the `#version` line is hoisted and the define set is injected right
+    after it, before any code.
+
+Nothing else is expanded: #if/#ifdef/macros are left to the driver. The
+preprocessor only tracks the conditionals it can decide from the define set
+and earlier #define/#undef lines (#ifdef, #ifndef, #if <integer>, #if NAME,
+#if [!]defined(NAME), with #elif/#else), so an #include in a branch known to
+be inactive is not followed. GL_* and __* names belong to the driver, and any
+other expression counts as active.
+*/
+
+#define GWR_SHADER_PREPROC_MAX_INCLUDE_PATHS    16
+#define GWR_SHADER_PREPROC_MAX_DEPTH            32
+
+typedef struct {
+    const char *name;
+    const char *value;      // NULL = "1"
+} GWR_shader_define_t;
+
+typedef struct GWR_shader_preproc_t GWR_shader_preproc_t;
+
+GWR_shader_preproc_t *GWR_shader_preproc_create(void);
+void GWR_shader_preproc_destroy(GWR_shader_preproc_t *pp);
+
+bool GWR_shader_preproc_add_include_path(GWR_shader_preproc_t *pp, const char *dir);
+
+// returns malloc'ed source or NULL; `origin` names src in #line markers and
+// resolves relative includes (may be NULL for the working directory)
+char *GWR_shader_preproc_run(
+    GWR_shader_preproc_t *pp,
+    const char *src,
+    const char *origin,
+    const GWR_shader_define_t *defines,
+    size_t define_count
+);
+char *GWR_shader_preproc_run_path(
+    GWR_shader_preproc_t *pp,
+    const char *path,
+    const GWR_shader_define_t *defines,
+    size_t define_count
+);
+
+// files touched by the last run, index 0 is the origin
+size_t GWR_shader_preproc_get_file_count(const GWR_shader_preproc_t *pp);
+const char *GWR_shader_preproc_get_file(const GWR_shader_preproc_t *pp, size_t idx);
@@ -0,0 +1,79 @@
+#pragma once
+
+#include "internal/gwr_shader.h"
+#include "internal/gwr_shader_preproc.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+Compiles each (stage source, define set) permutation once. Requests are
+keyed by the raw source or path and the define set, whose order does not
+matter but whose names must be unique; stage objects are additionally keyed
+by the preprocessed text, so define sets that expand to identical code share
+one compile. Hashes only pick the candidates, keys are compared in full.
+Programs are keyed by their stage objects and owned by the cache.
+
+Path requests remember the size and mtime of every file their expansion
+read. Lookups never touch the disk: GWR_shader_variant_cache_refresh() stats
+those files and marks the requests whose files changed, and the next lookup
+of a marked request expands and builds it again. Files served from a mounted
+archive are taken as unchanging, and includes of source requests are not
+checked.
+
+    const GWR_shader_define_t defs[] = {{"USE_NORMAL_MAP", NULL}, {"MAX_LIGHTS", "8"}};
+    GWR_shader_t *prog = GWR_shader_variant_cache_get_program_path(
+        cache, "shaders/lit.vert", "shaders/lit.frag", defs, GWR_ARR_LEN(defs)
+    );
+
+Failed compiles are remembered too, so a broken permutation is reported once.
+*/
+
+typedef struct {
+    uint64_t stage_requests;
+    uint64_t stage_hits;            // same source + define set
+    uint64_t stage_shared;          // different key, identical expanded source
+    uint64_t stage_stale;           // path request rebuilt after a file changed
+    uint64_t stage_compiles;
+    uint64_t program_requests;
+    uint64_t program_links;
+} GWR_shader_variant_stats_t;
+
+typedef struct GWR_shader_variant_cache_t GWR_shader_variant_cache_t;
+
+// pp is borrowed and must outlive the cache
+GWR_shader_variant_cache_t *GWR_shader_variant_cache_create(GWR_shader_preproc_t *pp);
+// destroys every program and stage object the cache made
+void GWR_shader_variant_cache_destroy(GWR_shader_variant_cache_t *cache);
+
+// 0 on failure; the stage object belongs to the cache
+GLuint GWR_shader_variant_cache_get_stage(
+    GWR_shader_variant_cache_t *cache,
+    GLenum type,
+    const char *src,
+    const char *origin,
+    const GWR_shader_define_t *defines,
+    size_t define_count
+);
+GLuint GWR_shader_variant_cache_get_stage_path(
+    GWR_shader_variant_cache_t *cache,
+    GLenum type,
+    const char *path,
+    const GWR_shader_define_t *defines,
+    size_t define_count
+);
+
+// NULL on failure; the program belongs to the cache
+GWR_shader_t *GWR_shader_variant_cache_get_program_path(
+    GWR_shader_variant_cache_t *cache,
+    const char *vertex_path,
+    const char *fragment_path,
+    const GWR_shader_define_t *defines,
+    size_t define_count
+);
+
+// stats the files of every path request, e.g. once a GWR_shader_watcher_t
+// update reports a change; returns how many requests will be rebuilt
+size_t GWR_shader_variant_cache_refresh(GWR_shader_variant_cache_t *cache);
+
+GWR_shader_variant_stats_t GWR_shader_variant_cache_get_stats(const GWR_shader_variant_cache_t *cache);
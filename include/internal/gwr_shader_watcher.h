@@ -0,0 +1,42 @@
+#pragma once
+
+#include "internal/gwr_shader.h"
+
+#include <stdbool.h>
+
+/*
+Opt-in hot reload for shaders made by GWR_shader_create_path:
+
+    GWR_shader_watcher_t *watcher = GWR_shader_watcher_create();
+    GWR_shader_watcher_add(watcher, shader);
+    ...
+    // once per frame, on the thread that owns the GL context
+    GWR_shader_watcher_update(watcher);
+
+Every file the shader's stages read is watched, #include dependencies too
+(GWR_shader_get_dep); the list is taken again after each reload, so includes
+an edit adds or drops are followed. On Linux a background thread blocks on
+inotify for the directories of the watched files (editors often save by renaming a temporary file, so the
+directory is watched rather than the file). Elsewhere update() polls file
+modification times. Changes are debounced, then the shader is rebuilt with
+GWR_shader_reload_begin/poll: the old program keeps drawing until the new
+one links, and stays if it does not.
+
+Reloads read through the VFS, where a mounted archive wins over the edited
+loose file; call GWR_vfs_set_prefer_loose(true) when watching archived shaders.
+*/
+
+#define GWR_SHADER_WATCHER_MAX_SHADERS    64
+#define GWR_SHADER_WATCHER_DEBOUNCE_MS    100
+
+typedef struct GWR_shader_watcher_t GWR_shader_watcher_t;
+
+GWR_shader_watcher_t *GWR_shader_watcher_create(void);
+void GWR_shader_watcher_destroy(GWR_shader_watcher_t *watcher);
+
+bool GWR_shader_watcher_add(GWR_shader_watcher_t *watcher, GWR_shader_t *shader);
+// must be called before the shader is destroyed; cancels a reload still in flight
+void GWR_shader_watcher_remove(GWR_shader_watcher_t *watcher, GWR_shader_t *shader);
+
+// starts pending reloads and swaps finished ones; returns how many programs were swapped
+int GWR_shader_watcher_update(GWR_shader_watcher_t *watcher);
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "cglm/cglm.h"
+
+/*
+Bulk transform and culling kernels over cglm types (column-major mat4).
+The backend is picked at runtime on first use: AVX2+FMA or SSE2 on x86,
+NEON on ARM, and a scalar reference built on cglm everywhere else.
+In-place calls (out == in) are allowed.
+*/
+
+typedef enum {
+    GWR_SIMD_SCALAR = 0,
+    GWR_SIMD_SSE,
+    GWR_SIMD_AVX2,
+    GWR_SIMD_NEON,
+
+    GWR_SIMD__COUNT
+} GWR_simd_backend_e;
+
+typedef struct {
+    vec3 min;
+    vec3 max;
+} GWR_aabb_t;
+
+GWR_simd_backend_e GWR_simd_get_backend(void);
+const char *GWR_simd_get_backend_name(GWR_simd_backend_e backend);
+bool GWR_simd_is_supported(GWR_simd_backend_e backend);
+// e.g. GWR_SIMD_SCALAR to compare against the cglm reference; false if unsupported
+bool GWR_simd_set_backend(GWR_simd_backend_e backend);
+
+void GWR_simd_mat4_mul(mat4 a, mat4 b, mat4 dest);
+// out[i] = m * in[i]
+void GWR_simd_mat4_mul_n(mat4 m, mat4 *in, mat4 *out, size_t n);
+
+// positions with w = 1, perspective divide is not applied
+void GWR_simd_transform_points_aos(mat4 m, vec3 *in, vec3 *out, size_t n);
+void GWR_simd_transform_points_soa(
+    mat4 m,
+    const float *x, const float *y, const float *z,
+    float *out_x, float *out_y, float *out_z,
+    size_t n
+);
+
+// tight bounds of the transformed boxes (Arvo)
+void GWR_simd_aabb_transform(mat4 m, const GWR_aabb_t *in, GWR_aabb_t *out, size_t n);
+
+// normalized planes of view_proj, in cglm order (left, right, bottom, top, near, far)
+void GWR_simd_frustum_planes(mat4 view_proj, vec4 planes[6]);
+// visible[i] = 1 when boxes[i] intersects the frustum, returns the visible count
+size_t GWR_simd_frustum_cull_aabbs(vec4 planes[6], const GWR_aabb_t *boxes, size_t n, uint8_t *visible);
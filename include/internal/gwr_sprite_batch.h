@@ -0,0 +1,61 @@
+#pragma once
+
+#include "glad/glad.h"
+
+#include "gwr_texture.h"
+#include "gwr_math.h"
+
+/*
+Accumulates textured quads (4 GWR_vert_t each) into a stream buffer and draws
+them with a shared static index buffer. A flush happens on texture change or
+when `capacity` sprites are queued, so prefer GL_TEXTURE_2D_ARRAY textures
+(GWR_texture_load_array) and GWR_sprite_t.layer over switching textures.
+Flushes draw successive pieces of one stream buffer region and the batch only
+moves to the next region once `capacity` sprites filled it, so a switch costs
+a draw call but never a fence wait.
+
+For array textures the layer travels in GWR_vert_t.pos[2]; sprites are 2D,
+draw order is submission order.
+
+No allocations happen after GWR_sprite_batch_create.
+*/
+
+#define GWR_SPRITE_BATCH_DEFAULT_CAPACITY (1 << 16)
+
+typedef struct {
+    float x;
+    float y;
+    float w;
+    float h;
+    float uv[4];    // u0, v0, u1, v1
+    float color[3];
+    float layer;    // ignored for GL_TEXTURE_2D
+} GWR_sprite_t;
+
+typedef struct {
+    GLsizei sprites;
+    GLsizei draw_calls;
+    GLsizei texture_flushes;
+} GWR_sprite_batch_stats_t;
+
+typedef struct GWR_sprite_batch_t GWR_sprite_batch_t;
+
+GWR_sprite_batch_t *GWR_sprite_batch_create(GLsizei capacity);
+void GWR_sprite_batch_destroy(GWR_sprite_batch_t *batch);
+
+// proj: column-major 4x4 matrix applied to sprite positions
+void GWR_sprite_batch_begin(GWR_sprite_batch_t *batch, const float *proj);
+void GWR_sprite_batch_end(GWR_sprite_batch_t *batch);
+
+void GWR_sprite_batch_draw(GWR_sprite_batch_t *batch, const GWR_texture_t *texture, const GWR_sprite_t *sprite);
+void GWR_sprite_batch_draw_n(
+    GWR_sprite_batch_t *batch,
+    const GWR_texture_t *texture,
+    const GWR_sprite_t *sprites,
+    GLsizei n
+);
+
+void GWR_sprite_batch_flush(GWR_sprite_batch_t *batch);
+
+// counters since the last GWR_sprite_batch_begin
+GWR_sprite_batch_stats_t GWR_sprite_batch_get_stats(const GWR_sprite_batch_t *batch);
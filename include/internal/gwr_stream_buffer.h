@@ -0,0 +1,46 @@
+#pragma once
+
+#include "glad/glad.h"
+
+/*
+Ring of `regions` fixed-size regions of `capacity` elements each, refilled
+every frame (or every batch). Region i starts at element i * capacity, so
+the value returned by GWR_stream_buffer_get_base() can be passed directly as
+base instance / base vertex and attribute pointers never need to change.
+
+Typical frame:
+    void *dst = GWR_stream_buffer_map(sb);
+    ... write up to capacity elements ...
+    GWR_stream_buffer_unmap(sb, count);
+    GWR_draw_*_instanced(..., GWR_stream_buffer_get_base(sb));
+    GWR_stream_buffer_fence(sb);
+
+A region can also be consumed in pieces: keep writing past what was drawn,
+publish each piece with GWR_stream_buffer_unmap_range() and draw it at base +
+first. The region stays writable until the next map, and each fence covers
+everything drawn from the region before it.
+*/
+
+#define GWR_STREAM_BUFFER_DEFAULT_REGIONS 3
+
+typedef struct GWR_stream_buffer_t GWR_stream_buffer_t;
+
+GWR_stream_buffer_t *GWR_stream_buffer_create(GLsizei stride, GLsizei capacity, GLsizei regions);
+void GWR_stream_buffer_destroy(GWR_stream_buffer_t *sb);
+
+// advances to the next region and waits until the GPU is done with it (the
+// glBufferSubData fallback for drivers without persistent mapping never waits)
+void *GWR_stream_buffer_map(GWR_stream_buffer_t *sb);
+// publishes `count` written elements of the current region
+void GWR_stream_buffer_unmap(GWR_stream_buffer_t *sb, GLsizei count);
+// publishes elements [first, first + count) of the current region
+void GWR_stream_buffer_unmap_range(GWR_stream_buffer_t *sb, GLsizei first, GLsizei count);
+// must be called after the last draw that reads the current region
+void GWR_stream_buffer_fence(GWR_stream_buffer_t *sb);
+
+GLuint GWR_stream_buffer_get_id(const GWR_stream_buffer_t *sb);
+GLuint GWR_stream_buffer_get_base(const GWR_stream_buffer_t *sb);
+GLintptr GWR_stream_buffer_get_offset(const GWR_stream_buffer_t *sb);
+GLsizei GWR_stream_buffer_get_stride(const GWR_stream_buffer_t *sb);
+GLsizei GWR_stream_buffer_get_capacity(const GWR_stream_buffer_t *sb);
+GLsizeiptr GWR_stream_buffer_get_size(const GWR_stream_buffer_t *sb);
@@ -2,11 +2,36 @@
 
 #include "glad/glad.h"
 
+#include <stdint.h>
+
+/*
+Textures carry no sampling parameters; bind a GWR_sampler_t to the same unit
+to choose filtering and wrapping. Without one, GL's per-texture defaults apply
+(repeat, GL_NEAREST_MIPMAP_LINEAR/GL_LINEAR), which still sample complete
+textures: loaded images get a full mip chain and immutable storage is
+complete at any level count.
+*/
+
 typedef struct GWR_texture_t GWR_texture_t;
 
 GWR_texture_t *GWR_texture_load(const char *path);
+// GL_TEXTURE_2D_ARRAY with one layer per image; all images must have the same size
+GWR_texture_t *GWR_texture_load_array(const char *const *paths, GLsizei count);
+// immutable storage, no data, clamp + linear unless a sampler is bound;
+// samples > 1 creates a GL_TEXTURE_2D_MULTISAMPLE (levels ignored)
+GWR_texture_t *GWR_texture_create(GLenum internal_format, GLsizei width, GLsizei height, GLsizei levels, GLsizei samples);
 void GWR_texture_destroy(GWR_texture_t *texture);
 
 GLuint GWR_texture_get_id(const GWR_texture_t *texture);
 GLsizei GWR_texture_get_width(const GWR_texture_t *texture);
 GLsizei GWR_texture_get_height(const GWR_texture_t *texture);
+GLsizei GWR_texture_get_layers(const GWR_texture_t *texture);
+GLenum GWR_texture_get_target(const GWR_texture_t *texture);
+GLenum GWR_texture_get_format(const GWR_texture_t *texture);
+GLsizei GWR_texture_get_samples(const GWR_texture_t *texture);
+
+// estimated bytes including mips, layers and samples
+int64_t GWR_texture_get_memory_size(const GWR_texture_t *texture);
+
+// bytes per texel of a sized internal format (estimate for packed/unknown formats)
+GLsizeiptr GWR_texture_format_bytes(GLenum internal_format);
@@ -0,0 +1,55 @@
+#pragma once
+
+#include "glad/glad.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/*
+GL call tracing for performance repros. While a trace is active, every GL
+entry point the library uses goes through a recording wrapper that writes
+the call, its arguments, the client memory it reads (vertex data, pixels,
+shader sources, uniforms) and the time spent in the driver to a compact
+binary file (see gwr_trace_format.h). Identical payloads are stored once.
+tools/gwr_replay plays the file back headless, frame by frame, with per-call
+timings:
+
+    GWR_TRACE=slow_frame.gtrace ./app          // whole run, started by the first window
+
+    GWR_trace_begin("slow_frame.gtrace");      // or around a region of interest
+    ... frames ...
+    GWR_trace_end();
+
+Tracing swaps the loaded GL function pointers, so it covers calls made by
+application code between GWR_* calls as well; begin it on a thread with a
+current context after the first window exists. Objects created before
+tracing began are unknown to the replay. GWR_window_swap_buffers() marks
+frame boundaries.
+
+CPU writes into persistently mapped buffers never pass through GL; stream
+buffers report theirs with GWR_trace_buffer_write(), and code that keeps its
+own persistent mappings must do the same for the replay to see the data.
+*/
+
+typedef struct {
+    uint64_t calls;
+    uint64_t frames;
+    uint64_t payload_bytes;         // client memory referenced by calls
+    uint64_t stored_bytes;          // of which written to the file after dedup
+    uint64_t file_bytes;
+} GWR_trace_stats_t;
+
+// false if a trace is already active, no context is current or the file cannot be created
+bool GWR_trace_begin(const char *path);
+void GWR_trace_end(void);
+bool GWR_trace_is_active(void);
+
+// frame boundary; called by GWR_window_swap_buffers()
+void GWR_trace_frame(void);
+// free-form note shown by the replay
+void GWR_trace_marker(const char *text);
+
+// `size` bytes at `data` were written to `buffer` at `offset` through a persistent mapping
+void GWR_trace_buffer_write(GLuint buffer, GLintptr offset, GLsizeiptr size, const void *data);
+
+GWR_trace_stats_t GWR_trace_get_stats(void);
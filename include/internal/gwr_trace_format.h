@@ -0,0 +1,351 @@
+#pragma once
+
+#include "glad/glad.h"
+
+#include <stdint.h>
+
+/*
+On-disk layout of .gtrace files, shared by gwr_trace and tools/gwr_replay.
+Everything is little-endian:
+
+    GWR_trace_header_t
+    records         (GWR_trace_record_t, then `size` argument bytes)
+
+A record's `call` is one of GWR_trace_record_e. Arguments follow in
+declaration order: 32-bit values as 4 bytes, pointer-sized and 64-bit values
+as 8. Object names are the names the traced process saw; replay maps them to
+its own. Pointers to client memory become blob references (64-bit hash, then
+64-bit size, GWR_TRACE_NULL_BLOB for NULL); the bytes are written once, in a
+GWR_TRACE_BLOB record ahead of the first call that uses them, and later calls
+with identical bytes only repeat the reference. A reference resolves to the
+latest blob written under its hash, so payloads whose hashes collide are
+written again wherever they alternate. Arrays of GLintptr and pointers are
+stored as the tracing process laid them out, so traces replay on 64-bit
+hosts only.
+
+The call tables below drive both the recording wrappers and the replay
+decoder, so a call is added in one place. Ids follow list order; any change
+to the lists bumps GWR_TRACE_VERSION.
+*/
+
+#define GWR_TRACE_MAGIC         0x43525447u     // "GTRC"
+#define GWR_TRACE_VERSION       2u
+#define GWR_TRACE_NULL_BLOB     UINT64_MAX
+
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    int32_t gl_major;
+    int32_t gl_minor;
+    int32_t width;                  // viewport when tracing began; sizes the replay surface
+    int32_t height;
+} GWR_trace_header_t;
+
+typedef struct {
+    uint16_t call;
+    uint16_t flags;                 // reserved, 0
+    uint32_t size;                  // argument bytes that follow
+    uint32_t duration_ns;           // time spent in the driver call, saturated
+} GWR_trace_record_t;
+
+// argument kinds -> C types; object kinds are GLuint names remapped on replay
+#define GWR_TRACE_T_ENUM        GLenum
+#define GWR_TRACE_T_INT         GLint
+#define GWR_TRACE_T_UINT        GLuint
+#define GWR_TRACE_T_SIZEI       GLsizei
+#define GWR_TRACE_T_BOOL        GLboolean
+#define GWR_TRACE_T_BITS        GLbitfield
+#define GWR_TRACE_T_FLOAT       GLfloat
+#define GWR_TRACE_T_INTPTR      GLintptr
+#define GWR_TRACE_T_SIZEIPTR    GLsizeiptr
+#define GWR_TRACE_T_OFFSET      const void *    // offset into a bound buffer
+#define GWR_TRACE_T_BUF         GLuint
+#define GWR_TRACE_T_TEX         GLuint
+#define GWR_TRACE_T_VAO         GLuint
+#define GWR_TRACE_T_FBO         GLuint
+#define GWR_TRACE_T_RBO         GLuint
+#define GWR_TRACE_T_SMP         GLuint
+#define GWR_TRACE_T_PROG        GLuint
+#define GWR_TRACE_T_SHD         GLuint
+#define GWR_TRACE_T_PIPE        GLuint
+#define GWR_TRACE_T_QRY         GLuint
+
+// calls whose arguments are all scalars or names; Xn takes n argument kinds
+#define GWR_TRACE_SIMPLE_CALLS(X0, X1, X2, X3, X4, X5, X6)                                 \
+    X1(glActiveTexture, ENUM)                                                           \
+    X2(glAttachShader, PROG, SHD)                                                       \
+    X2(glBeginQuery, ENUM, QRY)                                                         \
+    X2(glBindBuffer, ENUM, BUF)                                                         \
+    X3(glBindBufferBase, ENUM, UINT, BUF)                                               \
+    X5(glBindBufferRange, ENUM, UINT, BUF, INTPTR, SIZEIPTR)                            \
+    X2(glBindFramebuffer, ENUM, FBO)                                                    \
+    X1(glBindProgramPipeline, PIPE)                                                     \
+    X2(glBindRenderbuffer, ENUM, RBO)                                                   \
+    X2(glBindSampler, UINT, SMP)                                                        \
+    X2(glBindTexture, ENUM, TEX)                                                        \
+    X2(glBindTextureUnit, UINT, TEX)                                                    \
+    X1(glBindVertexArray, VAO)                                                          \
+    X4(glBindVertexBuffer, UINT, BUF, INTPTR, SIZEI)                                    \
+    X2(glBlendEquationSeparate, ENUM, ENUM)                                             \
+    X4(glBlendFuncSeparate, ENUM, ENUM, ENUM, ENUM)                                     \
+    X1(glClear, BITS)                                                                   \
+    X4(glClearBufferfi, ENUM, INT, FLOAT, INT)                                          \
+    X4(glClearColor, FLOAT, FLOAT, FLOAT, FLOAT)                                        \
+    X5(glClearNamedFramebufferfi, FBO, ENUM, INT, FLOAT, INT)                           \
+    X4(glColorMask, BOOL, BOOL, BOOL, BOOL)                                             \
+    X1(glCompileShader, SHD)                                                            \
+    X1(glCullFace, ENUM)                                                                \
+    X1(glDeleteProgram, PROG)                                                           \
+    X1(glDeleteShader, SHD)                                                             \
+    X1(glDepthFunc, ENUM)                                                               \
+    X1(glDepthMask, BOOL)                                                               \
+    X2(glDetachShader, PROG, SHD)                                                       \
+    X1(glDisable, ENUM)                                                                 \
+    X1(glDisableVertexAttribArray, UINT)                                                \
+    X3(glDrawArrays, ENUM, INT, SIZEI)                                                  \
+    X5(glDrawArraysInstancedBaseInstance, ENUM, INT, SIZEI, SIZEI, UINT)                \
+    X1(glDrawBuffer, ENUM)                                                              \
+    X4(glDrawElements, ENUM, SIZEI, ENUM, OFFSET)                                       \
+    X5(glDrawElementsBaseVertex, ENUM, SIZEI, ENUM, OFFSET, INT)                        \
+    X6(glDrawElementsInstancedBaseInstance, ENUM, SIZEI, ENUM, OFFSET, SIZEI, UINT)     \
+    X1(glEnable, ENUM)                                                                  \
+    X1(glEnableVertexAttribArray, UINT)                                                 \
+    X1(glEndQuery, ENUM)                                                                \
+    X0(glFlush)                                                                         \
+    X4(glFramebufferRenderbuffer, ENUM, ENUM, ENUM, RBO)                                \
+    X4(glFramebufferTexture, ENUM, ENUM, TEX, INT)                                      \
+    X1(glFrontFace, ENUM)                                                               \
+    X1(glGenerateMipmap, ENUM)                                                          \
+    X1(glLinkProgram, PROG)                                                             \
+    X1(glMemoryBarrier, BITS)                                                           \
+    X2(glNamedFramebufferDrawBuffer, FBO, ENUM)                                         \
+    X2(glNamedFramebufferReadBuffer, FBO, ENUM)                                         \
+    X4(glNamedFramebufferRenderbuffer, FBO, ENUM, ENUM, RBO)                            \
+    X4(glNamedFramebufferTexture, FBO, ENUM, TEX, INT)                                  \
+    X5(glNamedRenderbufferStorageMultisample, RBO, SIZEI, ENUM, SIZEI, SIZEI)           \
+    X2(glPixelStorei, ENUM, INT)                                                        \
+    X2(glPolygonMode, ENUM, ENUM)                                                       \
+    X2(glPolygonOffset, FLOAT, FLOAT)                                                   \
+    X0(glPopDebugGroup)                                                                 \
+    X3(glProgramParameteri, PROG, ENUM, INT)                                            \
+    X1(glReadBuffer, ENUM)                                                              \
+    X5(glRenderbufferStorageMultisample, ENUM, SIZEI, ENUM, SIZEI, SIZEI)               \
+    X3(glSamplerParameterf, SMP, ENUM, FLOAT)                                           \
+    X3(glSamplerParameteri, SMP, ENUM, INT)                                             \
+    X3(glStencilFunc, ENUM, INT, UINT)                                                  \
+    X1(glStencilMask, UINT)                                                             \
+    X3(glStencilOp, ENUM, ENUM, ENUM)                                                   \
+    X5(glTexStorage2D, ENUM, SIZEI, ENUM, SIZEI, SIZEI)                                 \
+    X6(glTexStorage2DMultisample, ENUM, SIZEI, ENUM, SIZEI, SIZEI, BOOL)                \
+    X5(glTextureStorage2D, TEX, SIZEI, ENUM, SIZEI, SIZEI)                              \
+    X6(glTextureStorage2DMultisample, TEX, SIZEI, ENUM, SIZEI, SIZEI, BOOL)             \
+    X1(glUseProgram, PROG)                                                              \
+    X3(glUseProgramStages, PIPE, BITS, PROG)                                            \
+    X1(glValidateProgramPipeline, PIPE)                                                 \
+    X3(glVertexArrayBindingDivisor, VAO, UINT, UINT)                                    \
+    X2(glVertexAttribDivisor, UINT, UINT)                                               \
+    X5(glVertexAttribIPointer, UINT, INT, ENUM, SIZEI, OFFSET)                          \
+    X5(glVertexAttribLPointer, UINT, INT, ENUM, SIZEI, OFFSET)                          \
+    X6(glVertexAttribPointer, UINT, INT, ENUM, BOOL, SIZEI, OFFSET)                     \
+    X4(glViewport, INT, INT, SIZEI, SIZEI)
+
+// void fn(GLsizei n, GLuint *names) creating names of one kind
+#define GWR_TRACE_GEN_CALLS(X)                                                          \
+    X(glGenBuffers, BUF)                                                                \
+    X(glCreateBuffers, BUF)                                                             \
+    X(glGenTextures, TEX)                                                               \
+    X(glGenVertexArrays, VAO)                                                           \
+    X(glGenFramebuffers, FBO)                                                           \
+    X(glCreateFramebuffers, FBO)                                                        \
+    X(glGenRenderbuffers, RBO)                                                          \
+    X(glCreateRenderbuffers, RBO)                                                       \
+    X(glGenSamplers, SMP)                                                               \
+    X(glCreateSamplers, SMP)                                                            \
+    X(glGenProgramPipelines, PIPE)                                                      \
+    X(glCreateProgramPipelines, PIPE)                                                   \
+    X(glGenQueries, QRY)
+
+// void fn(GLsizei n, const GLuint *names)
+#define GWR_TRACE_DELETE_CALLS(X)                                                       \
+    X(glDeleteBuffers, BUF)                                                             \
+    X(glDeleteTextures, TEX)                                                            \
+    X(glDeleteVertexArrays, VAO)                                                        \
+    X(glDeleteFramebuffers, FBO)                                                        \
+    X(glDeleteRenderbuffers, RBO)                                                       \
+    X(glDeleteSamplers, SMP)                                                            \
+    X(glDeleteProgramPipelines, PIPE)                                                   \
+    X(glDeleteQueries, QRY)
+
+// void fn(GLuint program, GLint location, GLsizei count, const T *value); V for
+// vectors, M for matrices (with a transpose flag); last column is T's components
+#define GWR_TRACE_UNIFORM_CALLS(V, M)                                                   \
+    V(glProgramUniform1iv, GLint, 1)                                                    \
+    V(glProgramUniform2iv, GLint, 2)                                                    \
+    V(glProgramUniform3iv, GLint, 3)                                                    \
+    V(glProgramUniform4iv, GLint, 4)                                                    \
+    V(glProgramUniform1uiv, GLuint, 1)                                                  \
+    V(glProgramUniform2uiv, GLuint, 2)                                                  \
+    V(glProgramUniform3uiv, GLuint, 3)                                                  \
+    V(glProgramUniform4uiv, GLuint, 4)                                                  \
+    V(glProgramUniform1fv, GLfloat, 1)                                                  \
+    V(glProgramUniform2fv, GLfloat, 2)                                                  \
+    V(glProgramUniform3fv, GLfloat, 3)                                                  \
+    V(glProgramUniform4fv, GLfloat, 4)                                                  \
+    V(glProgramUniform1dv, GLdouble, 1)                                                 \
+    V(glProgramUniform2dv, GLdouble, 2)                                                 \
+    V(glProgramUniform3dv, GLdouble, 3)                                                 \
+    V(glProgramUniform4dv, GLdouble, 4)                                                 \
+    M(glProgramUniformMatrix2fv, GLfloat, 4)                                            \
+    M(glProgramUniformMatrix3fv, GLfloat, 9)                                            \
+    M(glProgramUniformMatrix4fv, GLfloat, 16)                                           \
+    M(glProgramUniformMatrix2dv, GLdouble, 4)                                           \
+    M(glProgramUniformMatrix3dv, GLdouble, 9)                                           \
+    M(glProgramUniformMatrix4dv, GLdouble, 16)
+
+// hand-written on both sides: pointers with computed sizes, return values, syncs
+#define GWR_TRACE_CUSTOM_CALLS(X)                                                       \
+    X(glCreateTextures)                                                                 \
+    X(glCreateShader)                                                                   \
+    X(glCreateProgram)                                                                  \
+    X(glGetUniformLocation)                                                             \
+    X(glShaderSource)                                                                   \
+    X(glBufferData)                                                                     \
+    X(glNamedBufferData)                                                                \
+    X(glBufferStorage)                                                                  \
+    X(glNamedBufferStorage)                                                             \
+    X(glBufferSubData)                                                                  \
+    X(glMapBufferRange)                                                                 \
+    X(glMapNamedBufferRange)                                                            \
+    X(glUnmapBuffer)                                                                    \
+    X(glUnmapNamedBuffer)                                                               \
+    X(glTexImage2D)                                                                     \
+    X(glTexImage3D)                                                                     \
+    X(glTexSubImage3D)                                                                  \
+    X(glReadPixels)                                                                     \
+    X(glGetTextureSubImage)                                                             \
+    X(glSamplerParameterfv)                                                             \
+    X(glDrawBuffers)                                                                    \
+    X(glNamedFramebufferDrawBuffers)                                                    \
+    X(glClearBufferfv)                                                                  \
+    X(glClearNamedFramebufferfv)                                                        \
+    X(glClearBufferiv)                                                                  \
+    X(glClearNamedFramebufferiv)                                                        \
+    X(glInvalidateFramebuffer)                                                          \
+    X(glInvalidateNamedFramebufferData)                                                 \
+    X(glBlitFramebuffer)                                                                \
+    X(glBlitNamedFramebuffer)                                                           \
+    X(glBindTextures)                                                                   \
+    X(glBindSamplers)                                                                   \
+    X(glBindBuffersBase)                                                                \
+    X(glBindBuffersRange)                                                               \
+    X(glBindVertexBuffers)                                                              \
+    X(glVertexArrayVertexBuffers)                                                       \
+    X(glFenceSync)                                                                      \
+    X(glClientWaitSync)                                                                 \
+    X(glWaitSync)                                                                       \
+    X(glDeleteSync)                                                                     \
+    X(glObjectLabel)                                                                    \
+    X(glPushDebugGroup)
+
+#define GWR_TRACE_ID_(fn, ...)                  GWR_TRACE_ID_##fn,
+#define GWR_TRACE_ID0_(fn)                      GWR_TRACE_ID_##fn,
+#define GWR_TRACE_ID2_(fn, a)                   GWR_TRACE_ID_##fn,
+#define GWR_TRACE_ID3_(fn, a, b)                GWR_TRACE_ID_##fn,
+
+typedef enum {
+    GWR_TRACE_BLOB = 1,             // u64 hash, then the bytes
+    GWR_TRACE_FRAME,                // u64 frame index, u64 ns since tracing began
+    GWR_TRACE_BUFFER_WRITE,         // BUF, u64 offset, blob: CPU writes into a mapping
+    GWR_TRACE_MARKER,               // blob: GWR_trace_marker() text
+
+    GWR_TRACE_FIRST_CALL = 16,
+    GWR_TRACE_ID__FIRST = GWR_TRACE_FIRST_CALL - 1,
+    GWR_TRACE_SIMPLE_CALLS(GWR_TRACE_ID0_, GWR_TRACE_ID_, GWR_TRACE_ID_, GWR_TRACE_ID_, GWR_TRACE_ID_, GWR_TRACE_ID_, GWR_TRACE_ID_)
+    GWR_TRACE_GEN_CALLS(GWR_TRACE_ID2_)
+    GWR_TRACE_DELETE_CALLS(GWR_TRACE_ID2_)
+    GWR_TRACE_UNIFORM_CALLS(GWR_TRACE_ID3_, GWR_TRACE_ID3_)
+    GWR_TRACE_CUSTOM_CALLS(GWR_TRACE_ID0_)
+
+    GWR_TRACE__COUNT
+} GWR_trace_record_e;
+
+// bytes per pixel of a client-memory format/type pair, 0 if unknown
+static inline uint32_t GWR_trace_pixel_bytes(GLenum format, GLenum type) {
+    switch (type) {
+        case GL_UNSIGNED_INT_8_8_8_8:
+        case GL_UNSIGNED_INT_8_8_8_8_REV:
+        case GL_UNSIGNED_INT_2_10_10_10_REV:
+        case GL_UNSIGNED_INT_10F_11F_11F_REV:
+        case GL_UNSIGNED_INT_5_9_9_9_REV:
+        case GL_UNSIGNED_INT_24_8:
+            return 4;
+        case GL_UNSIGNED_SHORT_5_6_5:
+        case GL_UNSIGNED_SHORT_4_4_4_4:
+        case GL_UNSIGNED_SHORT_5_5_5_1:
+            return 2;
+        case GL_FLOAT_32_UNSIGNED_INT_24_8_REV:
+            return 8;
+        default:
+            break;
+    }
+
+    uint32_t channels = 0;
+    switch (format) {
+        case GL_RED:
+        case GL_RED_INTEGER:
+        case GL_DEPTH_COMPONENT:
+        case GL_STENCIL_INDEX:
+            channels = 1;
+            break;
+        case GL_RG:
+        case GL_RG_INTEGER:
+        case GL_DEPTH_STENCIL:
+            channels = 2;
+            break;
+        case GL_RGB:
+        case GL_BGR:
+        case GL_RGB_INTEGER:
+            channels = 3;
+            break;
+        case GL_RGBA:
+        case GL_BGRA:
+        case GL_RGBA_INTEGER:
+            channels = 4;
+            break;
+        default:
+            return 0;
+    }
+
+    switch (type) {
+        case GL_UNSIGNED_BYTE:
+        case GL_BYTE:
+            return channels;
+        case GL_UNSIGNED_SHORT:
+        case GL_SHORT:
+        case GL_HALF_FLOAT:
+            return channels * 2;
+        case GL_UNSIGNED_INT:
+        case GL_INT:
+        case GL_FLOAT:
+            return channels * 4;
+        default:
+            return 0;
+    }
+}
+
+// bytes a w x h x d image occupies in client memory under the given row length
+// (0 = w) and alignment pixel store state
+static inline uint64_t GWR_trace_image_bytes(
+    GLsizei w, GLsizei h, GLsizei d, GLenum format, GLenum type, GLint row_length, GLint alignment
+) {
+    const uint64_t bpp = GWR_trace_pixel_bytes(format, type);
+    if (w <= 0 || h <= 0 || d <= 0 || !bpp) {
+        return 0;
+    }
+
+    const uint64_t a = alignment > 0 ? (uint64_t) alignment : 4;
+    const uint64_t pixels = row_length > w ? (uint64_t) row_length : (uint64_t) w;
+    const uint64_t row = (pixels * bpp + a - 1) / a * a;
+    // the last row is not padded
+    return row * ((uint64_t) h * (uint64_t) d - 1) + (uint64_t) w * bpp;
+}
@@ -1,7 +1,10 @@
 #pragma once
 
+#include <stddef.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #define GWR_ARR_LEN(arr)    (sizeof((arr)) / sizeof((arr)[0]))
 
@@ -44,3 +47,32 @@
     } while (0)                                     
 
 #define GWR_STATIC_ASSERT(cond, msg) _Static_assert(cond, msg)
+
+#define GWR_FNV_OFFSET      0xcbf29ce484222325ull
+#define GWR_FNV_PRIME       0x100000001b3ull
+
+// 64-bit FNV-1a; chain calls by passing the previous result as h
+static inline uint64_t GWR_fnv1a(uint64_t h, const void *data, size_t n) {
+    const unsigned char *p = data;
+    for (size_t i = 0; i < n; ++i) {
+        h = (h ^ p[i]) * GWR_FNV_PRIME;
+    }
+    return h;
+}
+
+static inline uint64_t GWR_fnv1a_str(uint64_t h, const char *s) {
+    return GWR_fnv1a(h, s, strlen(s));
+}
+
+// CLOCK_MONOTONIC in nanoseconds; out of line so public headers stay ISO C
+uint64_t GWR_now_ns(void);
+
+// malloc'd copy of s, NULL on allocation failure
+static inline char *GWR_dup_str(const char *s) {
+    const size_t len = strlen(s);
+    char *copy = malloc(len + 1);
+    if (copy) {
+        memcpy(copy, s, len + 1);
+    }
+    return copy;
+}
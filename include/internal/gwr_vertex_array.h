@@ -2,6 +2,7 @@
 
 #include "gwr_vertex_buffer.h"
 #include "gwr_element_buffer.h"
+#include "gwr_stream_buffer.h"
 
 typedef struct GWR_vertex_array_t GWR_vertex_array_t;
 
@@ -36,3 +37,21 @@ void GWR_vertex_array_attrib_pointerl(
     GLuint idx, GLint size, GLenum type,
     GLsizei stride, const void *pointer
 );
+
+// per-instance attributes: the attribute at `idx` advances once every `divisor` instances
+void GWR_vertex_array_set_attrib_divisor(const GWR_vertex_array_t *vao, GLuint idx, GLuint divisor);
+
+// same as attrib_pointerf/i but sourced from a stream buffer; offsets are relative to its start,
+// the current region is selected at draw time through base instance / base vertex
+void GWR_vertex_array_stream_attrib_pointerf(
+    const GWR_vertex_array_t *vao,
+    const GWR_stream_buffer_t *sb,
+    GLuint idx, GLint size, GLenum type, GLboolean normalized,
+    const void *pointer
+);
+void GWR_vertex_array_stream_attrib_pointeri(
+    const GWR_vertex_array_t *vao,
+    const GWR_stream_buffer_t *sb,
+    GLuint idx, GLint size, GLenum type,
+    const void *pointer
+);
@@ -10,6 +10,8 @@ map/unmap
 typedef struct GWR_vertex_buffer_t GWR_vertex_buffer_t;
 
 GWR_vertex_buffer_t *GWR_vertex_buffer_create(const void *data, GLsizeiptr size, GLenum usage);
+// immutable storage (glBufferStorage); set_data is refused, flags 0 = static contents
+GWR_vertex_buffer_t *GWR_vertex_buffer_create_storage(const void *data, GLsizeiptr size, GLbitfield flags);
 void GWR_vertex_buffer_destroy(GWR_vertex_buffer_t *vbo);
 
 void GWR_vertex_buffer_bind(const GWR_vertex_buffer_t *vbo);
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+Read-only virtual file system over memory-mapped .gpak archives (see
+gwr_pak_format.h and tools/mkpak) with a fallback to loose files. Shader,
+preprocessor include, texture and mesh loading all read through it, so a
+mounted archive serves every asset without an open() per file:
+
+    GWR_vfs_mount("data/base.gpak", "assets/");
+    GWR_vfs_mount("data/patch.gpak", "assets/");    // searched first
+    ...
+    GWR_texture_t *tex = GWR_texture_load("assets/textures/rock.png");
+
+A path is looked up in the archives mounted under a matching prefix, most
+recent mount first, with the prefix stripped; if no archive has it, the
+loose file is read. "./" segments and repeated '/' are ignored and "dir/.."
+is folded away before the lookup.
+
+Archives win over loose files, so while one is mounted, edits to the loose
+copy of an archived file are not seen, by GWR_shader_watcher_t reloads
+either. During development, GWR_vfs_set_prefer_loose(true) makes an existing
+loose file win instead.
+
+GWR_vfs_open() returns a view: stored entries point straight into the
+archive mapping, compressed ones are decoded into a private buffer and loose
+files are mapped. Views must be closed before their archive is unmounted.
+Mounting and unmounting take a write lock; lookups from loader threads run
+concurrently.
+*/
+
+#define GWR_VFS_MAX_MOUNTS 16
+
+typedef struct {
+    const void *data;
+    size_t size;
+
+    // owned by the VFS
+    void *buffer;
+    void *map;
+    size_t map_size;
+} GWR_vfs_file_t;
+
+typedef struct {
+    uint64_t pak_reads;
+    uint64_t loose_reads;
+    uint64_t misses;
+    uint64_t blocks_decoded;
+    uint64_t bytes_decoded;
+} GWR_vfs_stats_t;
+
+// prefix may be NULL or "" to mount at the root; false if the archive is missing or invalid
+bool GWR_vfs_mount(const char *pak_path, const char *prefix);
+bool GWR_vfs_unmount(const char *pak_path);
+void GWR_vfs_unmount_all(void);
+
+bool GWR_vfs_exists(const char *path);
+// -1 if the file does not exist
+int64_t GWR_vfs_size(const char *path);
+
+bool GWR_vfs_open(const char *path, GWR_vfs_file_t *file);
+void GWR_vfs_close(GWR_vfs_file_t *file);
+
+// whole file in a malloc'd, NUL-terminated buffer; size may be NULL
+char *GWR_vfs_read_text(const char *path, size_t *size);
+
+// copies up to `n` bytes from `offset`, decoding only the blocks that cover them;
+// returns the bytes copied, -1 on error
+int64_t GWR_vfs_read(const char *path, uint64_t offset, void *dst, size_t n);
+
+// false by default; when set, a loose file that exists is read instead of the archived copy
+void GWR_vfs_set_prefer_loose(bool prefer);
+
+GWR_vfs_stats_t GWR_vfs_get_stats(void);
@@ -4,15 +4,41 @@
 
 typedef struct GWR_window_t GWR_window_t;
 
+typedef void (*GWR_window_frame_fn)(GWR_window_t *window, void *user);
+
+/*
+Windows share one GLFW instance that lives while any window does. Each
+window keeps its own framebuffer size, pending viewport and swap interval;
+GWR_window_set_current() skips the context switch when the window is already
+current on the calling thread.
+
+Windows created with a `share` window see its textures, buffers, shaders and
+sync objects. Container objects (vertex arrays, framebuffers, program
+pipelines) stay per context.
+
+Creation sets only the context hints (version, core profile, debug), so
+other glfwWindowHint() calls made while GLFW is up (samples, resizable, ...)
+still apply to the next window.
+*/
+
 GWR_window_t *GWR_window_create(int width, int height, const char *title);
+GWR_window_t *GWR_window_create_shared(int width, int height, const char *title, const GWR_window_t *share);
 
 void GWR_window_destroy(GWR_window_t *window);
 
+// windows created afterwards get a debug context (see GWR_debug_init)
+void GWR_window_hint_debug_context(bool enabled);
+
 // returns GLFWwindow *
 void *GWR_window_get_handle(const GWR_window_t *window);
 
 void GWR_window_set_vsync(bool enabled);
 
+// applies to the current context; a negative interval requests adaptive vsync
+// and falls back to its absolute value when EXT_swap_control_tear is missing
+void GWR_window_set_swap_interval(int interval);
+int GWR_window_get_swap_interval(void);
+
 bool GWR_window_should_close(const GWR_window_t *window);
 
 void GWR_window_process_input(const GWR_window_t *window);
@@ -27,6 +53,21 @@ void GWR_window_clear(void);
 
 void GWR_window_set_current(GWR_window_t *window);
 
+// window whose context is current on the calling thread
+GWR_window_t *GWR_window_get_current(void);
+
 int GWR_window_get_width(const GWR_window_t *window);
 
 int GWR_window_get_height(const GWR_window_t *window);
+
+int GWR_window_get_framebuffer_width(const GWR_window_t *window);
+
+int GWR_window_get_framebuffer_height(const GWR_window_t *window);
+
+void GWR_window_set_user_data(GWR_window_t *window, void *user_data);
+
+void *GWR_window_get_user_data(const GWR_window_t *window);
+
+// makes each open window current, calls `frame` and swaps, then polls events;
+// returns once every window was asked to close
+void GWR_window_run(GWR_window_t *const *windows, int count, GWR_window_frame_fn frame, void *user);
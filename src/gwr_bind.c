@@ -0,0 +1,343 @@
+#include "internal/gwr_bind.h"
+#include "internal/gwr_log.h"
+#include "internal/gwr_cap.h"
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <assert.h>
+
+#define BIND_LOG(level, msg, ...)    GWR_LOG_AT(GWR_LOG_SYS_BIND, (level), msg, ##__VA_ARGS__)
+
+typedef enum {
+    BUFFER_SLOT_UNIFORM = 0,
+    BUFFER_SLOT_STORAGE,
+
+    BUFFER_SLOT__COUNT
+} buffer_slot_e;
+
+typedef struct {
+    GLuint buffers[GWR_BIND_MAX_UNITS];
+    GLintptr offsets[GWR_BIND_MAX_UNITS];
+    GLsizeiptr sizes[GWR_BIND_MAX_UNITS];       // 0 for whole-buffer bindings
+    bool known[GWR_BIND_MAX_UNITS];
+} buffer_units_t;
+
+struct GWR_bind_cache_t {
+    GLuint textures[GWR_BIND_MAX_UNITS];
+    GLenum texture_targets[GWR_BIND_MAX_UNITS];
+    bool textures_known[GWR_BIND_MAX_UNITS];
+
+    GLuint samplers[GWR_BIND_MAX_UNITS];
+    bool samplers_known[GWR_BIND_MAX_UNITS];
+
+    buffer_units_t buffer_units[BUFFER_SLOT__COUNT];
+
+    GLuint vao;
+    GLuint vertex_buffers[GWR_BIND_MAX_UNITS];
+    GLintptr vertex_offsets[GWR_BIND_MAX_UNITS];
+    GLsizei vertex_strides[GWR_BIND_MAX_UNITS];
+    bool vertex_known[GWR_BIND_MAX_UNITS];
+
+    GWR_bind_stats_t stats;
+};
+
+// inner funcs decls
+
+static void grow_range(GLsizei i, GLsizei *lo, GLsizei *hi);
+static void count_request(GWR_bind_cache_t *cache, GLsizei count, GLsizei lo, GLsizei hi);
+
+// public funcs defs
+
+GWR_bind_cache_t *GWR_bind_cache_create(void) {
+    GWR_bind_cache_t *cache = calloc(1, sizeof(GWR_bind_cache_t));
+    if (!cache) {
+        BIND_LOG(GWR_LOG_ERROR, "failed to allocate GWR_bind_cache_t");
+        return NULL;
+    }
+
+    return cache;
+}
+
+void GWR_bind_cache_destroy(GWR_bind_cache_t *cache) {
+    assert(cache);
+
+    free(cache);
+}
+
+void GWR_bind_cache_invalidate(GWR_bind_cache_t *cache) {
+    assert(cache);
+
+    const GWR_bind_stats_t stats = cache->stats;
+    *cache = (GWR_bind_cache_t) {0};
+    cache->stats = stats;
+}
+
+GWR_bind_stats_t GWR_bind_cache_get_stats(const GWR_bind_cache_t *cache) {
+    assert(cache);
+
+    return cache->stats;
+}
+
+void GWR_bind_textures(
+    GWR_bind_cache_t *cache,
+    GLuint first,
+    GLsizei count,
+    const GWR_texture_t *const *textures
+) {
+    assert(cache);
+    assert(count >= 0 && first + (GLuint) count <= GWR_BIND_MAX_UNITS);
+
+    GLuint ids[GWR_BIND_MAX_UNITS];
+    GLsizei lo = count, hi = -1;
+    for (GLsizei i = 0; i < count; ++i) {
+        const GWR_texture_t *tex = textures ? textures[i] : NULL;
+        const GLuint unit = first + (GLuint) i;
+        ids[i] = tex ? GWR_texture_get_id(tex) : 0;
+
+        if (!cache->textures_known[unit] || cache->textures[unit] != ids[i]) {
+            grow_range(i, &lo, &hi);
+        }
+    }
+    count_request(cache, count, lo, hi);
+    if (hi < lo) {
+        return;
+    }
+
+    if (GWR_cap_has(GWR_FEATURE_MULTI_BIND)) {
+        glBindTextures(first + (GLuint) lo, hi - lo + 1, &ids[lo]);
+        ++cache->stats.gl_calls;
+    } else {
+        for (GLsizei i = lo; i <= hi; ++i) {
+            const GLuint unit = first + (GLuint) i;
+            if (cache->textures_known[unit] && cache->textures[unit] == ids[i]) {
+                continue;
+            }
+            if (GWR_cap_has(GWR_FEATURE_DIRECT_STATE_ACCESS)) {
+                glBindTextureUnit(unit, ids[i]);
+                ++cache->stats.gl_calls;
+            } else {
+                // unbinding needs the target the unit was bound with
+                const GLenum target = textures && textures[i] ? GWR_texture_get_target(textures[i])
+                                      : cache->texture_targets[unit] ? cache->texture_targets[unit]
+                                      : GL_TEXTURE_2D;
+                glActiveTexture(GL_TEXTURE0 + unit);
+                glBindTexture(target, ids[i]);
+                cache->stats.gl_calls += 2;
+            }
+        }
+        if (!GWR_cap_has(GWR_FEATURE_DIRECT_STATE_ACCESS)) {
+            glActiveTexture(GL_TEXTURE0);
+            ++cache->stats.gl_calls;
+        }
+    }
+
+    for (GLsizei i = lo; i <= hi; ++i) {
+        const GLuint unit = first + (GLuint) i;
+        cache->textures[unit] = ids[i];
+        cache->texture_targets[unit] = textures && textures[i] ? GWR_texture_get_target(textures[i]) : GL_NONE;
+        cache->textures_known[unit] = true;
+    }
+}
+
+void GWR_bind_samplers(
+    GWR_bind_cache_t *cache,
+    GLuint first,
+    GLsizei count,
+    const GWR_sampler_t *const *samplers
+) {
+    assert(cache);
+    assert(count >= 0 && first + (GLuint) count <= GWR_BIND_MAX_UNITS);
+
+    GLuint ids[GWR_BIND_MAX_UNITS];
+    GLsizei lo = count, hi = -1;
+    for (GLsizei i = 0; i < count; ++i) {
+        const GWR_sampler_t *sampler = samplers ? samplers[i] : NULL;
+        const GLuint unit = first + (GLuint) i;
+        ids[i] = sampler ? GWR_sampler_get_id(sampler) : 0;
+
+        if (!cache->samplers_known[unit] || cache->samplers[unit] != ids[i]) {
+            grow_range(i, &lo, &hi);
+        }
+    }
+    count_request(cache, count, lo, hi);
+    if (hi < lo) {
+        return;
+    }
+
+    if (GWR_cap_has(GWR_FEATURE_MULTI_BIND)) {
+        glBindSamplers(first + (GLuint) lo, hi - lo + 1, &ids[lo]);
+        ++cache->stats.gl_calls;
+    } else {
+        for (GLsizei i = lo; i <= hi; ++i) {
+            const GLuint unit = first + (GLuint) i;
+            if (!cache->samplers_known[unit] || cache->samplers[unit] != ids[i]) {
+                glBindSampler(unit, ids[i]);
+                ++cache->stats.gl_calls;
+            }
+        }
+    }
+
+    for (GLsizei i = lo; i <= hi; ++i) {
+        const GLuint unit = first + (GLuint) i;
+        cache->samplers[unit] = ids[i];
+        cache->samplers_known[unit] = true;
+    }
+}
+
+void GWR_bind_buffers_range(
+    GWR_bind_cache_t *cache,
+    GLenum target,
+    GLuint first,
+    GLsizei count,
+    const GLuint *buffers,
+    const GLintptr *offsets,
+    const GLsizeiptr *sizes
+) {
+    assert(cache);
+    assert(buffers);
+    assert((offsets == NULL) == (sizes == NULL));
+    assert(count >= 0 && first + (GLuint) count <= GWR_BIND_MAX_UNITS);
+
+    buffer_units_t *units = NULL;
+    switch (target) {
+        case GL_UNIFORM_BUFFER:
+            units = &cache->buffer_units[BUFFER_SLOT_UNIFORM];
+            break;
+        case GL_SHADER_STORAGE_BUFFER:
+            units = &cache->buffer_units[BUFFER_SLOT_STORAGE];
+            break;
+        default:
+            BIND_LOG(GWR_LOG_ERROR, "unsupported buffer target 0x%04X", target);
+            return;
+    }
+
+    const bool whole = offsets == NULL;
+    GLsizei lo = count, hi = -1;
+    for (GLsizei i = 0; i < count; ++i) {
+        const GLuint unit = first + (GLuint) i;
+        const GLintptr offset = whole ? 0 : offsets[i];
+        const GLsizeiptr size = whole ? 0 : sizes[i];
+
+        if (!units->known[unit] || units->buffers[unit] != buffers[i] ||
+            units->offsets[unit] != offset || units->sizes[unit] != size) {
+            grow_range(i, &lo, &hi);
+        }
+    }
+    count_request(cache, count, lo, hi);
+    if (hi < lo) {
+        return;
+    }
+
+    if (GWR_cap_has(GWR_FEATURE_MULTI_BIND)) {
+        if (whole) {
+            glBindBuffersBase(target, first + (GLuint) lo, hi - lo + 1, &buffers[lo]);
+        } else {
+            glBindBuffersRange(target, first + (GLuint) lo, hi - lo + 1, &buffers[lo], &offsets[lo], &sizes[lo]);
+        }
+        ++cache->stats.gl_calls;
+    } else {
+        for (GLsizei i = lo; i <= hi; ++i) {
+            const GLuint unit = first + (GLuint) i;
+            if (whole || !buffers[i]) {
+                glBindBufferBase(target, unit, buffers[i]);
+            } else {
+                glBindBufferRange(target, unit, buffers[i], offsets[i], sizes[i]);
+            }
+            ++cache->stats.gl_calls;
+        }
+    }
+
+    for (GLsizei i = lo; i <= hi; ++i) {
+        const GLuint unit = first + (GLuint) i;
+        units->buffers[unit] = buffers[i];
+        units->offsets[unit] = whole ? 0 : offsets[i];
+        units->sizes[unit] = whole ? 0 : sizes[i];
+        units->known[unit] = true;
+    }
+}
+
+void GWR_bind_vertex_buffers(
+    GWR_bind_cache_t *cache,
+    const GWR_vertex_array_t *vao,
+    GLuint first,
+    GLsizei count,
+    const GLuint *buffers,
+    const GLintptr *offsets,
+    const GLsizei *strides
+) {
+    assert(cache);
+    assert(vao);
+    assert(buffers);
+    assert(offsets);
+    assert(strides);
+    assert(count >= 0 && first + (GLuint) count <= GWR_BIND_MAX_UNITS);
+
+    const GLuint vao_id = GWR_vertex_array_get_id(vao);
+    if (cache->vao != vao_id) {
+        // the bindings live in the vao, so another vao starts unknown
+        for (int i = 0; i < GWR_BIND_MAX_UNITS; ++i) {
+            cache->vertex_known[i] = false;
+        }
+        cache->vao = vao_id;
+    }
+
+    GLsizei lo = count, hi = -1;
+    for (GLsizei i = 0; i < count; ++i) {
+        const GLuint unit = first + (GLuint) i;
+        if (!cache->vertex_known[unit] || cache->vertex_buffers[unit] != buffers[i] ||
+            cache->vertex_offsets[unit] != offsets[i] || cache->vertex_strides[unit] != strides[i]) {
+            grow_range(i, &lo, &hi);
+        }
+    }
+    count_request(cache, count, lo, hi);
+    if (hi < lo) {
+        return;
+    }
+
+    const GLuint lo_unit = first + (GLuint) lo;
+    const GLsizei n = hi - lo + 1;
+    if (GWR_cap_has(GWR_FEATURE_DIRECT_STATE_ACCESS)) {
+        glVertexArrayVertexBuffers(vao_id, lo_unit, n, &buffers[lo], &offsets[lo], &strides[lo]);
+        ++cache->stats.gl_calls;
+    } else {
+        GWR_vertex_array_bind(vao);
+        if (GWR_cap_has(GWR_FEATURE_MULTI_BIND)) {
+            glBindVertexBuffers(lo_unit, n, &buffers[lo], &offsets[lo], &strides[lo]);
+            ++cache->stats.gl_calls;
+        } else {
+            for (GLsizei i = lo; i <= hi; ++i) {
+                glBindVertexBuffer(first + (GLuint) i, buffers[i], offsets[i], strides[i]);
+                ++cache->stats.gl_calls;
+            }
+        }
+        GWR_vertex_array_unbind();
+        cache->stats.gl_calls += 2;
+    }
+
+    for (GLsizei i = lo; i <= hi; ++i) {
+        const GLuint unit = first + (GLuint) i;
+        cache->vertex_buffers[unit] = buffers[i];
+        cache->vertex_offsets[unit] = offsets[i];
+        cache->vertex_strides[unit] = strides[i];
+        cache->vertex_known[unit] = true;
+    }
+}
+
+// inner funcs defs
+
+static void grow_range(GLsizei i, GLsizei *lo, GLsizei *hi) {
+    if (i < *lo) {
+        *lo = i;
+    }
+    if (i > *hi) {
+        *hi = i;
+    }
+}
+
+static void count_request(GWR_bind_cache_t *cache, GLsizei count, GLsizei lo, GLsizei hi) {
+    ++cache->stats.requests;
+    cache->stats.units_requested += (uint64_t) count;
+    if (hi >= lo) {
+        cache->stats.units_bound += (uint64_t) (hi - lo + 1);
+    }
+}
@@ -1,21 +1,120 @@
 #include "internal/gwr_cap.h"
 #include "internal/gwr_log.h"
+#include "internal/gwr_util.h"
 
 #include "glad/glad.h"
 
 #include <stddef.h>
+#include <string.h>
 
-#define CAP_LOG(level, msg, ...)    GWR_log((level), "[CAPS]: " msg, ##__VA_ARGS__)
+#define CAP_LOG(level, msg, ...)    GWR_LOG_AT(GWR_LOG_SYS_CAPS, (level), msg, ##__VA_ARGS__)
+
+#define CAP_STRING_SIZE    256
+#define CAP_MAX_EXTS       3
 
 typedef struct {
 	int major;
 	int minor;
 
-	bool has_buffer_storage;
-	bool has_dsa;
-	bool has_debug_output;
+	bool features[GWR_FEATURE__COUNT];
+	int64_t limits[GWR_LIMIT__COUNT];
+	float max_anisotropy;
+
+	char vendor[CAP_STRING_SIZE];
+	char renderer[CAP_STRING_SIZE];
+	char version[CAP_STRING_SIZE];
+	char glsl[CAP_STRING_SIZE];
 } GWR_cap_t;
 
+// a feature is present if the core version flag or any of the extension flags is set
+typedef struct {
+	const char *name;
+	const int *core;
+	const int *exts[CAP_MAX_EXTS];
+} cap_feature_desc_t;
+
+// a limit is queried if the core version flag is set or `feature` is present
+typedef struct {
+	const char *name;
+	GLenum pname;
+	const int *core;
+	int feature;
+} cap_limit_desc_t;
+
+static const cap_feature_desc_t s_feature_descs[] = {
+	[GWR_FEATURE_DEBUG_OUTPUT] = {"debug_output", &GLAD_GL_VERSION_4_3, {&GLAD_GL_KHR_debug, &GLAD_GL_ARB_debug_output}},
+	[GWR_FEATURE_DIRECT_STATE_ACCESS] = {"direct_state_access", &GLAD_GL_VERSION_4_5, {&GLAD_GL_ARB_direct_state_access}},
+	[GWR_FEATURE_BUFFER_STORAGE] = {"buffer_storage", &GLAD_GL_VERSION_4_4, {&GLAD_GL_ARB_buffer_storage}},
+	[GWR_FEATURE_TEXTURE_STORAGE] = {"texture_storage", &GLAD_GL_VERSION_4_2, {&GLAD_GL_ARB_texture_storage}},
+	[GWR_FEATURE_TEXTURE_VIEW] = {"texture_view", &GLAD_GL_VERSION_4_3, {&GLAD_GL_ARB_texture_view}},
+	[GWR_FEATURE_SAMPLER_OBJECTS] = {"sampler_objects", &GLAD_GL_VERSION_3_3, {&GLAD_GL_ARB_sampler_objects}},
+	[GWR_FEATURE_MULTI_BIND] = {"multi_bind", &GLAD_GL_VERSION_4_4, {&GLAD_GL_ARB_multi_bind}},
+	[GWR_FEATURE_VERTEX_ATTRIB_BINDING] = {"vertex_attrib_binding", &GLAD_GL_VERSION_4_3, {&GLAD_GL_ARB_vertex_attrib_binding}},
+	[GWR_FEATURE_BASE_INSTANCE] = {"base_instance", &GLAD_GL_VERSION_4_2, {&GLAD_GL_ARB_base_instance}},
+	[GWR_FEATURE_MULTI_DRAW_INDIRECT] = {"multi_draw_indirect", &GLAD_GL_VERSION_4_3, {&GLAD_GL_ARB_multi_draw_indirect}},
+	[GWR_FEATURE_INDIRECT_PARAMETERS] = {"indirect_parameters", &GLAD_GL_VERSION_4_6, {&GLAD_GL_ARB_indirect_parameters}},
+	[GWR_FEATURE_SHADER_DRAW_PARAMETERS] = {"shader_draw_parameters", &GLAD_GL_VERSION_4_6, {&GLAD_GL_ARB_shader_draw_parameters}},
+	[GWR_FEATURE_SEPARATE_SHADER_OBJECTS] = {"separate_shader_objects", &GLAD_GL_VERSION_4_1, {&GLAD_GL_ARB_separate_shader_objects}},
+	[GWR_FEATURE_PROGRAM_BINARY] = {"program_binary", &GLAD_GL_VERSION_4_1, {&GLAD_GL_ARB_get_program_binary}},
+	[GWR_FEATURE_PARALLEL_SHADER_COMPILE] = {"parallel_shader_compile", NULL, {&GLAD_GL_KHR_parallel_shader_compile, &GLAD_GL_ARB_parallel_shader_compile}},
+	[GWR_FEATURE_SPIRV] = {"spirv", &GLAD_GL_VERSION_4_6, {&GLAD_GL_ARB_gl_spirv}},
+	[GWR_FEATURE_COMPUTE_SHADER] = {"compute_shader", &GLAD_GL_VERSION_4_3, {&GLAD_GL_ARB_compute_shader}},
+	[GWR_FEATURE_SHADER_STORAGE_BUFFER] = {"shader_storage_buffer", &GLAD_GL_VERSION_4_3, {&GLAD_GL_ARB_shader_storage_buffer_object}},
+	[GWR_FEATURE_SHADER_IMAGE_LOAD_STORE] = {"shader_image_load_store", &GLAD_GL_VERSION_4_2, {&GLAD_GL_ARB_shader_image_load_store}},
+	[GWR_FEATURE_BINDLESS_TEXTURE] = {"bindless_texture", NULL, {&GLAD_GL_ARB_bindless_texture}},
+	[GWR_FEATURE_SPARSE_TEXTURE] = {"sparse_texture", NULL, {&GLAD_GL_ARB_sparse_texture}},
+	[GWR_FEATURE_SPARSE_BUFFER] = {"sparse_buffer", NULL, {&GLAD_GL_ARB_sparse_buffer}},
+	[GWR_FEATURE_INVALIDATE_SUBDATA] = {"invalidate_subdata", &GLAD_GL_VERSION_4_3, {&GLAD_GL_ARB_invalidate_subdata}},
+	[GWR_FEATURE_CLIP_CONTROL] = {"clip_control", &GLAD_GL_VERSION_4_5, {&GLAD_GL_ARB_clip_control}},
+	[GWR_FEATURE_TIMER_QUERY] = {"timer_query", &GLAD_GL_VERSION_3_3, {&GLAD_GL_ARB_timer_query}},
+	[GWR_FEATURE_TEXTURE_FILTER_ANISOTROPIC] = {"texture_filter_anisotropic", &GLAD_GL_VERSION_4_6, {&GLAD_GL_ARB_texture_filter_anisotropic, &GLAD_GL_EXT_texture_filter_anisotropic}},
+	[GWR_FEATURE_TEXTURE_COMPRESSION_S3TC] = {"texture_compression_s3tc", NULL, {&GLAD_GL_EXT_texture_compression_s3tc}},
+	[GWR_FEATURE_TEXTURE_COMPRESSION_RGTC] = {"texture_compression_rgtc", &GLAD_GL_VERSION_3_0, {&GLAD_GL_ARB_texture_compression_rgtc}},
+	[GWR_FEATURE_TEXTURE_COMPRESSION_BPTC] = {"texture_compression_bptc", &GLAD_GL_VERSION_4_2, {&GLAD_GL_ARB_texture_compression_bptc}},
+	[GWR_FEATURE_TEXTURE_COMPRESSION_ETC2] = {"texture_compression_etc2", &GLAD_GL_VERSION_4_3, {&GLAD_GL_ARB_ES3_compatibility}},
+	[GWR_FEATURE_TEXTURE_COMPRESSION_ASTC_LDR] = {"texture_compression_astc_ldr", NULL, {&GLAD_GL_KHR_texture_compression_astc_ldr}},
+	[GWR_FEATURE_MEMORY_INFO_NVX] = {"memory_info_nvx", NULL, {&GLAD_GL_NVX_gpu_memory_info}},
+	[GWR_FEATURE_MEMORY_INFO_ATI] = {"memory_info_ati", NULL, {&GLAD_GL_ATI_meminfo}},
+};
+
+static const cap_limit_desc_t s_limit_descs[] = {
+	[GWR_LIMIT_MAX_TEXTURE_SIZE] = {"max_texture_size", GL_MAX_TEXTURE_SIZE, &GLAD_GL_VERSION_1_0, -1},
+	[GWR_LIMIT_MAX_3D_TEXTURE_SIZE] = {"max_3d_texture_size", GL_MAX_3D_TEXTURE_SIZE, &GLAD_GL_VERSION_1_2, -1},
+	[GWR_LIMIT_MAX_CUBE_MAP_TEXTURE_SIZE] = {"max_cube_map_texture_size", GL_MAX_CUBE_MAP_TEXTURE_SIZE, &GLAD_GL_VERSION_1_3, -1},
+	[GWR_LIMIT_MAX_ARRAY_TEXTURE_LAYERS] = {"max_array_texture_layers", GL_MAX_ARRAY_TEXTURE_LAYERS, &GLAD_GL_VERSION_3_0, -1},
+	[GWR_LIMIT_MAX_RENDERBUFFER_SIZE] = {"max_renderbuffer_size", GL_MAX_RENDERBUFFER_SIZE, &GLAD_GL_VERSION_3_0, -1},
+	[GWR_LIMIT_MAX_SAMPLES] = {"max_samples", GL_MAX_SAMPLES, &GLAD_GL_VERSION_3_0, -1},
+	[GWR_LIMIT_MAX_COLOR_ATTACHMENTS] = {"max_color_attachments", GL_MAX_COLOR_ATTACHMENTS, &GLAD_GL_VERSION_3_0, -1},
+	[GWR_LIMIT_MAX_DRAW_BUFFERS] = {"max_draw_buffers", GL_MAX_DRAW_BUFFERS, &GLAD_GL_VERSION_2_0, -1},
+	[GWR_LIMIT_MAX_VIEWPORTS] = {"max_viewports", GL_MAX_VIEWPORTS, &GLAD_GL_VERSION_4_1, -1},
+	[GWR_LIMIT_MAX_VERTEX_ATTRIBS] = {"max_vertex_attribs", GL_MAX_VERTEX_ATTRIBS, &GLAD_GL_VERSION_2_0, -1},
+	[GWR_LIMIT_MAX_VERTEX_ATTRIB_BINDINGS] = {"max_vertex_attrib_bindings", GL_MAX_VERTEX_ATTRIB_BINDINGS, &GLAD_GL_VERSION_4_3, GWR_FEATURE_VERTEX_ATTRIB_BINDING},
+	[GWR_LIMIT_MAX_VERTEX_ATTRIB_STRIDE] = {"max_vertex_attrib_stride", GL_MAX_VERTEX_ATTRIB_STRIDE, &GLAD_GL_VERSION_4_4, -1},
+	[GWR_LIMIT_MAX_ELEMENTS_VERTICES] = {"max_elements_vertices", GL_MAX_ELEMENTS_VERTICES, &GLAD_GL_VERSION_1_2, -1},
+	[GWR_LIMIT_MAX_ELEMENTS_INDICES] = {"max_elements_indices", GL_MAX_ELEMENTS_INDICES, &GLAD_GL_VERSION_1_2, -1},
+	[GWR_LIMIT_MAX_TEXTURE_IMAGE_UNITS] = {"max_texture_image_units", GL_MAX_TEXTURE_IMAGE_UNITS, &GLAD_GL_VERSION_2_0, -1},
+	[GWR_LIMIT_MAX_COMBINED_TEXTURE_IMAGE_UNITS] = {"max_combined_texture_image_units", GL_MAX_COMBINED_TEXTURE_IMAGE_UNITS, &GLAD_GL_VERSION_2_0, -1},
+	[GWR_LIMIT_MAX_IMAGE_UNITS] = {"max_image_units", GL_MAX_IMAGE_UNITS, &GLAD_GL_VERSION_4_2, GWR_FEATURE_SHADER_IMAGE_LOAD_STORE},
+	[GWR_LIMIT_MAX_UNIFORM_BLOCK_SIZE] = {"max_uniform_block_size", GL_MAX_UNIFORM_BLOCK_SIZE, &GLAD_GL_VERSION_3_1, -1},
+	[GWR_LIMIT_MAX_UNIFORM_BUFFER_BINDINGS] = {"max_uniform_buffer_bindings", GL_MAX_UNIFORM_BUFFER_BINDINGS, &GLAD_GL_VERSION_3_1, -1},
+	[GWR_LIMIT_UNIFORM_BUFFER_OFFSET_ALIGNMENT] = {"uniform_buffer_offset_alignment", GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &GLAD_GL_VERSION_3_1, -1},
+	[GWR_LIMIT_MAX_SHADER_STORAGE_BLOCK_SIZE] = {"max_shader_storage_block_size", GL_MAX_SHADER_STORAGE_BLOCK_SIZE, &GLAD_GL_VERSION_4_3, GWR_FEATURE_SHADER_STORAGE_BUFFER},
+	[GWR_LIMIT_MAX_SHADER_STORAGE_BUFFER_BINDINGS] = {"max_shader_storage_buffer_bindings", GL_MAX_SHADER_STORAGE_BUFFER_BINDINGS, &GLAD_GL_VERSION_4_3, GWR_FEATURE_SHADER_STORAGE_BUFFER},
+	[GWR_LIMIT_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT] = {"shader_storage_buffer_offset_alignment", GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT, &GLAD_GL_VERSION_4_3, GWR_FEATURE_SHADER_STORAGE_BUFFER},
+	[GWR_LIMIT_MIN_MAP_BUFFER_ALIGNMENT] = {"min_map_buffer_alignment", GL_MIN_MAP_BUFFER_ALIGNMENT, &GLAD_GL_VERSION_4_2, -1},
+	[GWR_LIMIT_MAX_COMPUTE_WORK_GROUP_INVOCATIONS] = {"max_compute_work_group_invocations", GL_MAX_COMPUTE_WORK_GROUP_INVOCATIONS, &GLAD_GL_VERSION_4_3, GWR_FEATURE_COMPUTE_SHADER},
+	[GWR_LIMIT_MAX_COMPUTE_SHARED_MEMORY_SIZE] = {"max_compute_shared_memory_size", GL_MAX_COMPUTE_SHARED_MEMORY_SIZE, &GLAD_GL_VERSION_4_3, GWR_FEATURE_COMPUTE_SHADER},
+	[GWR_LIMIT_MAX_SERVER_WAIT_TIMEOUT] = {"max_server_wait_timeout", GL_MAX_SERVER_WAIT_TIMEOUT, &GLAD_GL_VERSION_3_2, -1},
+	[GWR_LIMIT_MAX_LABEL_LENGTH] = {"max_label_length", GL_MAX_LABEL_LENGTH, &GLAD_GL_VERSION_4_3, -1},
+	[GWR_LIMIT_MAX_DEBUG_MESSAGE_LENGTH] = {"max_debug_message_length", GL_MAX_DEBUG_MESSAGE_LENGTH, &GLAD_GL_VERSION_4_3, GWR_FEATURE_DEBUG_OUTPUT},
+	[GWR_LIMIT_NUM_PROGRAM_BINARY_FORMATS] = {"num_program_binary_formats", GL_NUM_PROGRAM_BINARY_FORMATS, &GLAD_GL_VERSION_4_1, GWR_FEATURE_PROGRAM_BINARY},
+	[GWR_LIMIT_NUM_COMPRESSED_TEXTURE_FORMATS] = {"num_compressed_texture_formats", GL_NUM_COMPRESSED_TEXTURE_FORMATS, &GLAD_GL_VERSION_1_3, -1},
+	[GWR_LIMIT_NUM_EXTENSIONS] = {"num_extensions", GL_NUM_EXTENSIONS, &GLAD_GL_VERSION_3_0, -1},
+};
+
+GWR_STATIC_ASSERT(GWR_ARR_LEN(s_feature_descs) == GWR_FEATURE__COUNT, "s_feature_descs out of sync");
+GWR_STATIC_ASSERT(GWR_ARR_LEN(s_limit_descs) == GWR_LIMIT__COUNT, "s_limit_descs out of sync");
+
 static GWR_cap_t s_cap;
 static bool s_inited = false;
 
@@ -23,22 +122,31 @@ static void detect_version(GWR_cap_t *cap);
 
 static void detect_features(GWR_cap_t *cap);
 
+static void detect_limits(GWR_cap_t *cap);
+
+static void copy_gl_string(char *dst, GLenum name);
+
+static void write_json_string(FILE *out, const char *str);
+
 bool GWR_cap_init(void) {
 	if (s_inited) {
 		return true;
 	}
 
-	s_cap.major = 0;
-	s_cap.minor = 0;
-	s_cap.has_buffer_storage = false;
-	s_cap.has_dsa = false;
-	s_cap.has_debug_output = false;
+	memset(&s_cap, 0, sizeof(s_cap));
 
 	detect_version(&s_cap);
 	detect_features(&s_cap);
+	detect_limits(&s_cap);
 
 	s_inited = true;
 
+	int n_features = 0;
+	for (int i = 0; i < GWR_FEATURE__COUNT; ++i) {
+		n_features += s_cap.features[i];
+	}
+	CAP_LOG(GWR_LOG_INFO, "GL %d.%d, %d/%d features", s_cap.major, s_cap.minor, n_features, GWR_FEATURE__COUNT);
+
 	return true;
 }
 
@@ -56,20 +164,63 @@ void GWR_cap_get_version(int *major, int *minor) {
 }
 
 bool GWR_cap_has(GWR_feature_e feature) {
-	if (!s_inited) {
+	if (!s_inited || feature >= GWR_FEATURE__COUNT) {
 		return false;
 	}
 
-	switch (feature) {
-		case GWR_FEATURE_DEBUG_OUTPUT:
-			return s_cap.has_debug_output;
-		case GWR_FEATURE_BUFFER_STORAGE:
-			return s_cap.has_buffer_storage;
-		case GWR_FEATURE_DIRECT_STATE_ACCESS:
-			return s_cap.has_dsa;
-		default:
-			return false;
+	return s_cap.features[feature];
+}
+
+int64_t GWR_cap_get_limit(GWR_limit_e limit) {
+	if (!s_inited || limit >= GWR_LIMIT__COUNT) {
+		return 0;
+	}
+
+	return s_cap.limits[limit];
+}
+
+float GWR_cap_get_max_anisotropy(void) {
+	return s_inited ? s_cap.max_anisotropy : 1.f;
+}
+
+const char *GWR_cap_get_feature_name(GWR_feature_e feature) {
+	return feature < GWR_FEATURE__COUNT ? s_feature_descs[feature].name : "unknown";
+}
+
+const char *GWR_cap_get_limit_name(GWR_limit_e limit) {
+	return limit < GWR_LIMIT__COUNT ? s_limit_descs[limit].name : "unknown";
+}
+
+void GWR_cap_dump_json(FILE *out) {
+	if (!out) {
+		return;
+	}
+
+	fprintf(out, "{\n");
+	fprintf(out, "\t\"version\": \"%d.%d\",\n", s_cap.major, s_cap.minor);
+	fprintf(out, "\t\"version_string\": ");
+	write_json_string(out, s_cap.version);
+	fprintf(out, ",\n\t\"glsl\": ");
+	write_json_string(out, s_cap.glsl);
+	fprintf(out, ",\n\t\"vendor\": ");
+	write_json_string(out, s_cap.vendor);
+	fprintf(out, ",\n\t\"renderer\": ");
+	write_json_string(out, s_cap.renderer);
+
+	fprintf(out, ",\n\t\"features\": {\n");
+	for (int i = 0; i < GWR_FEATURE__COUNT; ++i) {
+		fprintf(out, "\t\t\"%s\": %s%s\n", s_feature_descs[i].name, s_cap.features[i] ? "true" : "false",
+		        i + 1 < GWR_FEATURE__COUNT ? "," : "");
 	}
+	fprintf(out, "\t},\n");
+
+	fprintf(out, "\t\"limits\": {\n");
+	for (int i = 0; i < GWR_LIMIT__COUNT; ++i) {
+		fprintf(out, "\t\t\"%s\": %lld,\n", s_limit_descs[i].name, (long long) s_cap.limits[i]);
+	}
+	fprintf(out, "\t\t\"max_texture_max_anisotropy\": %g\n", (double) s_cap.max_anisotropy);
+	fprintf(out, "\t}\n");
+	fprintf(out, "}\n");
 }
 
 static void detect_version(GWR_cap_t *cap) {
@@ -79,10 +230,70 @@ static void detect_version(GWR_cap_t *cap) {
 
 	cap->major = major;
 	cap->minor = minor;
+
+	copy_gl_string(cap->vendor, GL_VENDOR);
+	copy_gl_string(cap->renderer, GL_RENDERER);
+	copy_gl_string(cap->version, GL_VERSION);
+	copy_gl_string(cap->glsl, GL_SHADING_LANGUAGE_VERSION);
 }
 
 static void detect_features(GWR_cap_t *cap) {
-	cap->has_dsa = GLAD_GL_VERSION_4_5 || GLAD_GL_ARB_direct_state_access;
-	cap->has_buffer_storage = GLAD_GL_VERSION_4_4 || GLAD_GL_ARB_buffer_storage;
-	cap->has_debug_output = GLAD_GL_VERSION_4_3 || GLAD_GL_KHR_debug  || GLAD_GL_ARB_debug_output;
+	for (int i = 0; i < GWR_FEATURE__COUNT; ++i) {
+		const cap_feature_desc_t *desc = &s_feature_descs[i];
+
+		bool present = desc->core && *desc->core;
+		for (int j = 0; j < CAP_MAX_EXTS && !present; ++j) {
+			present = desc->exts[j] && *desc->exts[j];
+		}
+		cap->features[i] = present;
+	}
+}
+
+static void detect_limits(GWR_cap_t *cap) {
+	// glGetInteger64v is core since 3.2, below the minimum context we create
+	for (int i = 0; i < GWR_LIMIT__COUNT; ++i) {
+		const cap_limit_desc_t *desc = &s_limit_descs[i];
+
+		const bool available = (desc->core && *desc->core) || (desc->feature >= 0 && cap->features[desc->feature]);
+		if (!available) {
+			continue;
+		}
+
+		GLint64 value = 0;
+		glGetInteger64v(desc->pname, &value);
+		cap->limits[i] = value;
+	}
+
+	cap->max_anisotropy = 1.f;
+	if (cap->features[GWR_FEATURE_TEXTURE_FILTER_ANISOTROPIC]) {
+		glGetFloatv(GL_MAX_TEXTURE_MAX_ANISOTROPY, &cap->max_anisotropy);
+	}
+
+	// drain errors from limits the driver advertises but does not answer
+	while (glGetError() != GL_NO_ERROR) {
+	}
+}
+
+static void copy_gl_string(char *dst, GLenum name) {
+	const char *str = (const char *) glGetString(name);
+
+	dst[0] = '\0';
+	if (str) {
+		strncat(dst, str, CAP_STRING_SIZE - 1);
+	}
+}
+
+static void write_json_string(FILE *out, const char *str) {
+	fputc('"', out);
+	for (const unsigned char *p = (const unsigned char *) str; *p; ++p) {
+		if (*p == '"' || *p == '\\') {
+			fputc('\\', out);
+			fputc(*p, out);
+		} else if (*p < 0x20) {
+			fprintf(out, "\\u%04x", *p);
+		} else {
+			fputc(*p, out);
+		}
+	}
+	fputc('"', out);
 }
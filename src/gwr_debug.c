@@ -0,0 +1,334 @@
+#include "internal/gwr_debug.h"
+#include "internal/gwr_log.h"
+#include "internal/gwr_cap.h"
+#include "internal/gwr_util.h"
+
+#include <stdarg.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+#include <assert.h>
+#include <pthread.h>
+
+#define DEBUG_LOG(level, msg, ...)    GWR_LOG_AT(GWR_LOG_SYS_GL_DEBUG, (level), msg, ##__VA_ARGS__)
+
+#define DEBUG_LABEL_SIZE 256
+
+static atomic_bool s_enabled = false;
+static GLenum s_min_severity = GL_DEBUG_SEVERITY_MEDIUM;
+static GLint s_max_label = DEBUG_LABEL_SIZE;
+
+// the driver may call back from its own threads unless the output is synchronous
+static pthread_mutex_t s_mutex = PTHREAD_MUTEX_INITIALIZER;
+static GWR_debug_stats_t s_stats;
+static GWR_debug_perf_entry_t s_perf[GWR_DEBUG_MAX_PERF_IDS];
+static int s_perf_count = 0;
+static uint64_t s_perf_overflow = 0;
+
+// inner funcs decls
+
+static void APIENTRY on_message(
+    GLenum source, GLenum type, GLuint id, GLenum severity,
+    GLsizei length, const GLchar *message, const void *user
+);
+static void count_perf(GLenum source, GLuint id, const GLchar *message, GLsizei length);
+static int severity_rank(GLenum severity);
+static GWR_log_level_e severity_level(GLenum type, GLenum severity);
+static const char *source_name(GLenum source);
+static const char *type_name(GLenum type);
+static int cmp_perf_desc(const void *a, const void *b);
+
+// public funcs defs
+
+bool GWR_debug_init(const GWR_debug_desc_t *desc) {
+    assert(desc);
+
+    if (atomic_load(&s_enabled)) {
+        return true;
+    }
+
+    if (!GWR_cap_has(GWR_FEATURE_DEBUG_OUTPUT) || !glDebugMessageCallback || !glObjectLabel) {
+        DEBUG_LOG(GWR_LOG_WARNING, "KHR_debug is not available, debug layer stays off");
+        return false;
+    }
+
+    GLint flags = 0;
+    glGetIntegerv(GL_CONTEXT_FLAGS, &flags);
+    if (!(flags & GL_CONTEXT_FLAG_DEBUG_BIT)) {
+        DEBUG_LOG(GWR_LOG_INFO, "not a debug context, drivers may report little or nothing");
+    }
+
+    s_min_severity = desc->min_severity ? desc->min_severity : GL_DEBUG_SEVERITY_MEDIUM;
+    const int64_t max_label = GWR_cap_get_limit(GWR_LIMIT_MAX_LABEL_LENGTH);
+    s_max_label = max_label > 0 && max_label < DEBUG_LABEL_SIZE ? (GLint) max_label : DEBUG_LABEL_SIZE;
+
+    GWR_debug_reset_stats();
+
+    glEnable(GL_DEBUG_OUTPUT);
+    if (desc->synchronous) {
+        glEnable(GL_DEBUG_OUTPUT_SYNCHRONOUS);
+    } else {
+        glDisable(GL_DEBUG_OUTPUT_SYNCHRONOUS);
+    }
+    // everything reaches the callback so perf messages are counted at any severity
+    glDebugMessageControl(GL_DONT_CARE, GL_DONT_CARE, GL_DONT_CARE, 0, NULL, GL_TRUE);
+    if (desc->ignored_ids && desc->ignored_count > 0) {
+        glDebugMessageControl(
+            GL_DONT_CARE, GL_DONT_CARE, GL_DONT_CARE, desc->ignored_count, desc->ignored_ids, GL_FALSE
+        );
+    }
+    glDebugMessageCallback(on_message, NULL);
+
+    atomic_store(&s_enabled, true);
+    return true;
+}
+
+void GWR_debug_shutdown(void) {
+    if (!atomic_load(&s_enabled)) {
+        return;
+    }
+
+    atomic_store(&s_enabled, false);
+    glDebugMessageCallback(NULL, NULL);
+    glDisable(GL_DEBUG_OUTPUT_SYNCHRONOUS);
+    glDisable(GL_DEBUG_OUTPUT);
+}
+
+bool GWR_debug_is_enabled(void) {
+    return atomic_load(&s_enabled);
+}
+
+void GWR_debug_set_id_enabled(GLuint id, bool enabled) {
+    if (!atomic_load(&s_enabled)) {
+        return;
+    }
+
+    glDebugMessageControl(GL_DONT_CARE, GL_DONT_CARE, GL_DONT_CARE, 1, &id, enabled ? GL_TRUE : GL_FALSE);
+}
+
+GWR_debug_stats_t GWR_debug_get_stats(void) {
+    pthread_mutex_lock(&s_mutex);
+    const GWR_debug_stats_t stats = s_stats;
+    pthread_mutex_unlock(&s_mutex);
+
+    return stats;
+}
+
+int GWR_debug_get_perf(GWR_debug_perf_entry_t *out, int max) {
+    assert(out || max == 0);
+
+    GWR_debug_perf_entry_t sorted[GWR_DEBUG_MAX_PERF_IDS];
+
+    pthread_mutex_lock(&s_mutex);
+    const int count = s_perf_count;
+    memcpy(sorted, s_perf, (size_t) count * sizeof(GWR_debug_perf_entry_t));
+    pthread_mutex_unlock(&s_mutex);
+
+    qsort(sorted, (size_t) count, sizeof(GWR_debug_perf_entry_t), cmp_perf_desc);
+
+    const int n = count < max ? count : max;
+    memcpy(out, sorted, (size_t) n * sizeof(GWR_debug_perf_entry_t));
+    return n;
+}
+
+void GWR_debug_reset_stats(void) {
+    pthread_mutex_lock(&s_mutex);
+    memset(&s_stats, 0, sizeof(s_stats));
+    s_perf_count = 0;
+    s_perf_overflow = 0;
+    pthread_mutex_unlock(&s_mutex);
+}
+
+void GWR_debug_dump_perf(FILE *out) {
+    assert(out);
+
+    GWR_debug_perf_entry_t entries[GWR_DEBUG_MAX_PERF_IDS];
+    const int n = GWR_debug_get_perf(entries, GWR_ARR_LEN(entries));
+    const GWR_debug_stats_t stats = GWR_debug_get_stats();
+
+    fprintf(
+        out, "gl debug: %llu messages, %llu errors, %llu performance\n",
+        (unsigned long long) stats.messages, (unsigned long long) stats.errors,
+        (unsigned long long) stats.performance
+    );
+    for (int i = 0; i < n; ++i) {
+        fprintf(
+            out, "  %8llu  %-12s id %-10u %s\n",
+            (unsigned long long) entries[i].count, source_name(entries[i].source), entries[i].id, entries[i].text
+        );
+    }
+
+    pthread_mutex_lock(&s_mutex);
+    const uint64_t overflow = s_perf_overflow;
+    pthread_mutex_unlock(&s_mutex);
+    if (overflow) {
+        fprintf(out, "  %8llu  (ids beyond the first %d)\n", (unsigned long long) overflow, GWR_DEBUG_MAX_PERF_IDS);
+    }
+}
+
+void GWR_debug_label(GLenum identifier, GLuint name, const char *fmt, ...) {
+    assert(fmt);
+
+    if (!atomic_load(&s_enabled) || !name) {
+        return;
+    }
+
+    char label[DEBUG_LABEL_SIZE];
+    va_list args;
+    va_start(args, fmt);
+    vsnprintf(label, (size_t) s_max_label, fmt, args);
+    va_end(args);
+
+    glObjectLabel(identifier, name, -1, label);
+}
+
+void GWR_debug_push_group(const char *name) {
+    assert(name);
+
+    if (!atomic_load(&s_enabled)) {
+        return;
+    }
+
+    glPushDebugGroup(GL_DEBUG_SOURCE_APPLICATION, 0, -1, name);
+}
+
+void GWR_debug_pop_group(void) {
+    if (!atomic_load(&s_enabled)) {
+        return;
+    }
+
+    glPopDebugGroup();
+}
+
+// inner funcs defs
+
+static void APIENTRY on_message(
+    GLenum source, GLenum type, GLuint id, GLenum severity,
+    GLsizei length, const GLchar *message, const void *user
+) {
+    (void) user;
+
+    // our own group markers come back as notifications
+    if (type == GL_DEBUG_TYPE_PUSH_GROUP || type == GL_DEBUG_TYPE_POP_GROUP) {
+        return;
+    }
+
+    const bool log = severity_rank(severity) >= severity_rank(s_min_severity);
+
+    pthread_mutex_lock(&s_mutex);
+    ++s_stats.messages;
+    if (type == GL_DEBUG_TYPE_ERROR) {
+        ++s_stats.errors;
+    } else if (type == GL_DEBUG_TYPE_PERFORMANCE) {
+        ++s_stats.performance;
+        count_perf(source, id, message, length);
+    } else {
+        ++s_stats.other;
+    }
+    if (log) {
+        ++s_stats.logged;
+    }
+    pthread_mutex_unlock(&s_mutex);
+
+    if (log) {
+        DEBUG_LOG(
+            severity_level(type, severity), "[%s %s %u] %s",
+            source_name(source), type_name(type), id, message
+        );
+    }
+}
+
+// called with s_mutex held
+static void count_perf(GLenum source, GLuint id, const GLchar *message, GLsizei length) {
+    for (int i = 0; i < s_perf_count; ++i) {
+        if (s_perf[i].id == id && s_perf[i].source == source) {
+            ++s_perf[i].count;
+            return;
+        }
+    }
+
+    if (s_perf_count == GWR_DEBUG_MAX_PERF_IDS) {
+        ++s_perf_overflow;
+        return;
+    }
+
+    GWR_debug_perf_entry_t *e = &s_perf[s_perf_count++];
+    e->id = id;
+    e->source = source;
+    e->count = 1;
+    const size_t n = length > 0 && (size_t) length < sizeof(e->text) ? (size_t) length : sizeof(e->text) - 1;
+    strncpy(e->text, message, n);
+    e->text[n] = '\0';
+    // drivers often end messages with a newline
+    const size_t len = strlen(e->text);
+    if (len > 0 && e->text[len - 1] == '\n') {
+        e->text[len - 1] = '\0';
+    }
+}
+
+static int severity_rank(GLenum severity) {
+    switch (severity) {
+        case GL_DEBUG_SEVERITY_NOTIFICATION:
+            return 0;
+        case GL_DEBUG_SEVERITY_LOW:
+            return 1;
+        case GL_DEBUG_SEVERITY_MEDIUM:
+            return 2;
+        case GL_DEBUG_SEVERITY_HIGH:
+            return 3;
+        default:
+            return 0;
+    }
+}
+
+static GWR_log_level_e severity_level(GLenum type, GLenum severity) {
+    if (type == GL_DEBUG_TYPE_ERROR || severity == GL_DEBUG_SEVERITY_HIGH) {
+        return GWR_LOG_ERROR;
+    }
+    if (severity == GL_DEBUG_SEVERITY_MEDIUM || type == GL_DEBUG_TYPE_PERFORMANCE) {
+        return GWR_LOG_WARNING;
+    }
+    return GWR_LOG_INFO;
+}
+
+static const char *source_name(GLenum source) {
+    switch (source) {
+        case GL_DEBUG_SOURCE_API:
+            return "api";
+        case GL_DEBUG_SOURCE_WINDOW_SYSTEM:
+            return "window";
+        case GL_DEBUG_SOURCE_SHADER_COMPILER:
+            return "compiler";
+        case GL_DEBUG_SOURCE_THIRD_PARTY:
+            return "third-party";
+        case GL_DEBUG_SOURCE_APPLICATION:
+            return "application";
+        default:
+            return "other";
+    }
+}
+
+static const char *type_name(GLenum type) {
+    switch (type) {
+        case GL_DEBUG_TYPE_ERROR:
+            return "error";
+        case GL_DEBUG_TYPE_DEPRECATED_BEHAVIOR:
+            return "deprecated";
+        case GL_DEBUG_TYPE_UNDEFINED_BEHAVIOR:
+            return "undefined";
+        case GL_DEBUG_TYPE_PORTABILITY:
+            return "portability";
+        case GL_DEBUG_TYPE_PERFORMANCE:
+            return "performance";
+        case GL_DEBUG_TYPE_MARKER:
+            return "marker";
+        default:
+            return "other";
+    }
+}
+
+static int cmp_perf_desc(const void *a, const void *b) {
+    const uint64_t ca = ((const GWR_debug_perf_entry_t *) a)->count;
+    const uint64_t cb = ((const GWR_debug_perf_entry_t *) b)->count;
+    return (ca < cb) - (ca > cb);
+}
@@ -1,5 +1,6 @@
 #include "internal/gwr_draw.h"
 #include "internal/gwr_util.h"
+#include "internal/gwr_math.h"
 
 #include <assert.h>
 
@@ -27,5 +28,96 @@ void GWR_draw_elements(
     GLsizei count,
     GLintptr offset
 ) {
-    GWR_UNIMPLEMENTED();
+    assert(vao);
+    assert(shader);
+    assert(ebo);
+
+    GWR_shader_use(shader);
+    GWR_vertex_array_bind(vao);
+    GWR_element_buffer_bind(ebo);
+    glDrawElements(mode, count, GWR_element_buffer_get_type(ebo), (const void *) offset);
+    GWR_vertex_array_unbind();
+}
+
+void GWR_draw_arrays_instanced(
+    GLenum mode,
+    const GWR_vertex_array_t *vao,
+    const GWR_shader_t *shader,
+    GLint first,
+    GLsizei count,
+    GLsizei instance_count,
+    GLuint base_instance
+) {
+    assert(vao);
+    assert(shader);
+
+    GWR_shader_use(shader);
+    GWR_vertex_array_bind(vao);
+    glDrawArraysInstancedBaseInstance(mode, first, count, instance_count, base_instance);
+    GWR_vertex_array_unbind();
+}
+
+void GWR_draw_elements_instanced(
+    GLenum mode,
+    const GWR_vertex_array_t *vao,
+    const GWR_shader_t *shader,
+    const GWR_element_buffer_t *ebo,
+    GLsizei count,
+    GLintptr offset,
+    GLsizei instance_count,
+    GLuint base_instance
+) {
+    assert(vao);
+    assert(shader);
+    assert(ebo);
+
+    GWR_shader_use(shader);
+    GWR_vertex_array_bind(vao);
+    GWR_element_buffer_bind(ebo);
+    glDrawElementsInstancedBaseInstance(
+        mode, count, GWR_element_buffer_get_type(ebo), (const void *) offset, instance_count, base_instance
+    );
+    GWR_vertex_array_unbind();
+}
+
+void GWR_draw_arrays_state(
+    const GWR_pipeline_state_t *state,
+    GLenum mode,
+    const GWR_vertex_array_t *vao,
+    const GWR_shader_t *shader,
+    GLint first,
+    GLsizei count
+) {
+    assert(state);
+
+    GWR_pipeline_state_apply(state);
+    GWR_draw_arrays(mode, vao, shader, first, count);
+}
+
+void GWR_draw_elements_state(
+    const GWR_pipeline_state_t *state,
+    GLenum mode,
+    const GWR_vertex_array_t *vao,
+    const GWR_shader_t *shader,
+    const GWR_element_buffer_t *ebo,
+    GLsizei count,
+    GLintptr offset
+) {
+    assert(state);
+
+    GWR_pipeline_state_apply(state);
+    GWR_draw_elements(mode, vao, shader, ebo, count, offset);
+}
+
+uint64_t GWR_draw_sort_key(const GWR_pipeline_state_t *state, const GWR_shader_t *shader, float depth) {
+    assert(state);
+    assert(shader);
+
+    const uint64_t state_id = GWR_pipeline_state_get_id(state);
+    // the whole GL name, so programs never share a bucket; depth only orders
+    // draws within one bucket and gives up the bits
+    const uint64_t program = GWR_shader_get_id(shader);
+    const uint64_t depth_bits = (uint64_t) (GWR_clamp(depth, 0.f, 1.f) * UINT16_MAX);
+
+    return state_id << 48 | program << 16 | depth_bits;
 }
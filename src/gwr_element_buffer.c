@@ -1,12 +1,14 @@
 #include "internal/gwr_element_buffer.h"
 #include "internal/gwr_log.h"
 #include "internal/gwr_cap.h"
+#include "internal/gwr_memory.h"
+#include "internal/gwr_debug.h"
 
 #include <stdlib.h>
 #include <stdbool.h>
 #include <assert.h>
 
-#define EB_LOG(level, msg, ...)    GWR_log((level), "[ELEMENT BUFFER]: " msg, ##__VA_ARGS__)
+#define EB_LOG(level, msg, ...)    GWR_LOG_AT(GWR_LOG_SYS_ELEMENT_BUFFER, (level), msg, ##__VA_ARGS__)
 
 struct GWR_element_buffer_t {
     GLuint id;
@@ -14,6 +16,8 @@ struct GWR_element_buffer_t {
     GLsizei count;
     GLenum type;
     GLenum usage;
+    bool immutable;
+    GWR_mem_tag_t mem_tag;
 };
 
 typedef bool (*eb_create)(GWR_element_buffer_t *, const void *, GLsizeiptr, GLenum);
@@ -33,11 +37,23 @@ static bool backend_create_buffer_bind(GWR_element_buffer_t *ebo, const void *da
 static void backend_set_data_dsa(GWR_element_buffer_t *ebo, const void *data, GLsizeiptr size);
 static void backend_set_data_bind(GWR_element_buffer_t *ebo, const void *data, GLsizeiptr size);
 
+static bool create_storage(GWR_element_buffer_t *ebo, const void *data, GLsizeiptr size, GLbitfield flags);
+
 static void eb_pick_backend(void);
 
 // public funcs defs
 
 GWR_element_buffer_t *GWR_element_buffer_create(const void *data, GLsizeiptr size, GLenum usage) {
+    return GWR_element_buffer_create_typed(data, size, GL_UNSIGNED_INT, usage);
+}
+
+GWR_element_buffer_t *GWR_element_buffer_create_typed(const void *data, GLsizeiptr size, GLenum type, GLenum usage) {
+    const GLsizeiptr type_size = GWR_element_buffer_type_size(type);
+    if (!type_size) {
+        EB_LOG(GWR_LOG_ERROR, "unsupported index type 0x%x", type);
+        return NULL;
+    }
+
     eb_pick_backend();
 
     GWR_element_buffer_t *ebo = malloc(sizeof(GWR_element_buffer_t));
@@ -49,8 +65,9 @@ GWR_element_buffer_t *GWR_element_buffer_create(const void *data, GLsizeiptr siz
     ebo->id = 0;
     ebo->size = 0;
     ebo->count = 0;
-    ebo->type = GL_UNSIGNED_INT;
+    ebo->type = type;
     ebo->usage = usage;
+    ebo->immutable = false;
 
     if (!s_eb_create(ebo, data, size, usage)) {
         free(ebo);
@@ -58,15 +75,53 @@ GWR_element_buffer_t *GWR_element_buffer_create(const void *data, GLsizeiptr siz
     }
 
     ebo->size  = size;
-    ebo->count = size / sizeof(GLuint);
+    ebo->count = (GLsizei) (size / type_size);
+    ebo->mem_tag = GWR_mem_record_alloc(GWR_MEM_ELEMENT_BUFFER, size);
+    GWR_debug_label(GL_BUFFER, ebo->id, "element buffer %td bytes", size);
 
     return ebo;
 }
 
+GWR_element_buffer_t *GWR_element_buffer_create_storage(const void *data, GLsizeiptr size, GLenum type, GLbitfield flags) {
+    const GLsizeiptr type_size = GWR_element_buffer_type_size(type);
+    if (!type_size) {
+        EB_LOG(GWR_LOG_ERROR, "unsupported index type 0x%x", type);
+        return NULL;
+    }
+
+    eb_pick_backend();
+
+    GWR_element_buffer_t *ebo = malloc(sizeof(GWR_element_buffer_t));
+    if (!ebo) {
+        EB_LOG(GWR_LOG_ERROR, "failed to allocate GWR_element_buffer_t");
+        return NULL;
+    }
+
+    ebo->id = 0;
+    ebo->size = 0;
+    ebo->count = 0;
+    ebo->type = type;
+    ebo->usage = GL_STATIC_DRAW;
+    ebo->immutable = true;
+
+    if (!create_storage(ebo, data, size, flags)) {
+        free(ebo);
+        return NULL;
+    }
+
+    ebo->size = size;
+    ebo->count = (GLsizei) (size / type_size);
+    ebo->mem_tag = GWR_mem_record_alloc(GWR_MEM_ELEMENT_BUFFER, size);
+    GWR_debug_label(GL_BUFFER, ebo->id, "element buffer %td bytes", size);
+    return ebo;
+}
+
 void GWR_element_buffer_destroy(GWR_element_buffer_t *ebo) {
     assert(ebo);
     assert(ebo->id);
 
+    GWR_mem_record_free(GWR_MEM_ELEMENT_BUFFER, ebo->mem_tag, ebo->size);
+
     glDeleteBuffers(1, &ebo->id);
     ebo->id = 0;
 
@@ -90,10 +145,29 @@ void GWR_element_buffer_set_data(GWR_element_buffer_t *ebo, const void *data, GL
     assert(ebo->type);
     assert(ebo->usage);
 
+    if (ebo->immutable) {
+        EB_LOG(GWR_LOG_ERROR, "buffer %u has immutable storage", ebo->id);
+        return;
+    }
+
     s_eb_set_data(ebo, data, size);
 
+    GWR_mem_record_resize(GWR_MEM_ELEMENT_BUFFER, ebo->mem_tag, ebo->size, size);
     ebo->size  = size;
-    ebo->count = size / sizeof(GLuint);
+    ebo->count = (GLsizei) (size / GWR_element_buffer_type_size(ebo->type));
+}
+
+GLsizeiptr GWR_element_buffer_type_size(GLenum type) {
+    switch (type) {
+        case GL_UNSIGNED_BYTE:
+            return sizeof(GLubyte);
+        case GL_UNSIGNED_SHORT:
+            return sizeof(GLushort);
+        case GL_UNSIGNED_INT:
+            return sizeof(GLuint);
+        default:
+            return 0;
+    }
 }
 
 GLuint GWR_element_buffer_get_id(const GWR_element_buffer_t *ebo) {
@@ -219,6 +293,54 @@ static void backend_set_data_bind(GWR_element_buffer_t *ebo, const void *data, G
     glBindVertexArray((GLuint)prev_vao);
 }
 
+static bool create_storage(GWR_element_buffer_t *ebo, const void *data, GLsizeiptr size, GLbitfield flags) {
+    assert(ebo);
+
+    if (!GWR_cap_has(GWR_FEATURE_BUFFER_STORAGE)) {
+        // same contents, the driver just cannot rely on the size never changing
+        return s_eb_create(ebo, data, size, GL_STATIC_DRAW);
+    }
+
+    if (GWR_cap_has(GWR_FEATURE_DIRECT_STATE_ACCESS)) {
+        glCreateBuffers(1, &ebo->id);
+        if (!ebo->id) {
+            EB_LOG(GWR_LOG_ERROR, "glCreateBuffers returned 0");
+            return false;
+        }
+        glNamedBufferStorage(ebo->id, size, data, flags);
+        if (!check_created_size_named(ebo->id, size)) {
+            EB_LOG(GWR_LOG_ERROR, "glNamedBufferStorage failed to allocate %td bytes", size);
+            glDeleteBuffers(1, &ebo->id);
+            ebo->id = 0;
+            return false;
+        }
+        return true;
+    }
+
+    glGenBuffers(1, &ebo->id);
+    if (!ebo->id) {
+        EB_LOG(GWR_LOG_ERROR, "glGenBuffers failed");
+        return false;
+    }
+
+    GLint prev = 0;
+    glGetIntegerv(GL_COPY_WRITE_BUFFER_BINDING, &prev);
+
+    // the copy target does not disturb the VAO's element binding
+    glBindBuffer(GL_COPY_WRITE_BUFFER, ebo->id);
+    glBufferStorage(GL_COPY_WRITE_BUFFER, size, data, flags);
+    const bool ok = check_created_size_bound(GL_COPY_WRITE_BUFFER, size);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, prev);
+
+    if (!ok) {
+        EB_LOG(GWR_LOG_ERROR, "glBufferStorage failed to allocate %td bytes", size);
+        glDeleteBuffers(1, &ebo->id);
+        ebo->id = 0;
+        return false;
+    }
+    return true;
+}
+
 static void eb_pick_backend(void) {
     if (s_eb_create && s_eb_set_data) {
         return;
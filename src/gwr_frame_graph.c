@@ -0,0 +1,1070 @@
+#include "internal/gwr_frame_graph.h"
+#include "internal/gwr_log.h"
+#include "internal/gwr_cap.h"
+#include "internal/gwr_util.h"
+#include "internal/gwr_debug.h"
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <assert.h>
+
+#define FG_LOG(level, msg, ...)    GWR_LOG_AT(GWR_LOG_SYS_FRAME_GRAPH, (level), msg, ##__VA_ARGS__)
+
+#define FG_NAME_SIZE           32
+#define FG_TIMER_FRAMES        4
+#define FG_MAX_FRAMEBUFFERS    (GWR_FRAME_GRAPH_MAX_PASSES * 2)
+#define FG_MAX_TIMINGS         (GWR_FRAME_GRAPH_MAX_PASSES * 2)
+#define FG_LABEL_SIZE          256
+#define FG_TIMING_SMOOTHING    0.1
+
+typedef enum {
+    FG_RES_TRANSIENT = 0,
+    FG_RES_TEXTURE,
+    FG_RES_BUFFER,
+    FG_RES_BACKBUFFER,
+} fg_res_kind_e;
+
+typedef struct {
+    GWR_fg_resource_t res;
+    GWR_fg_access_e access;
+    bool write;
+} fg_access_t;
+
+typedef struct {
+    char name[FG_NAME_SIZE];
+    GWR_fg_execute_fn fn;
+    void *user;
+    fg_access_t accesses[GWR_FRAME_GRAPH_MAX_ACCESSES];
+    int access_count;
+    bool side_effect;
+    bool alive;
+    GLbitfield barrier;
+    GLbitfield invalidate;
+    bool to_backbuffer;
+    GWR_framebuffer_t *fb;
+} fg_pass_t;
+
+typedef struct {
+    char name[FG_NAME_SIZE];
+    fg_res_kind_e kind;
+    GWR_fg_texture_desc_t desc;
+    GWR_texture_t *texture;
+    GLuint buffer;
+    int first;      // execution positions, -1 if no live pass touches it
+    int last;
+    int slot;       // alias slot of transient textures
+} fg_resource_t;
+
+typedef struct {
+    GWR_fg_texture_desc_t desc;
+    GWR_texture_t *texture;
+    bool used;
+} fg_physical_t;
+
+typedef struct {
+    GWR_texture_t *colors[GWR_FRAMEBUFFER_MAX_COLOR_ATTACHMENTS];
+    int color_count;
+    GWR_texture_t *depth;
+    GWR_framebuffer_t *fb;
+    bool used;
+} fg_fb_entry_t;
+
+typedef struct {
+    char name[FG_NAME_SIZE];
+    double last_ms;
+    double avg_ms;
+    bool valid;
+} fg_timing_t;
+
+typedef struct {
+    GLuint queries[GWR_FRAME_GRAPH_MAX_PASSES];
+    int timing_idx[GWR_FRAME_GRAPH_MAX_PASSES];
+    int count;
+} fg_timer_frame_t;
+
+struct GWR_frame_graph_t {
+    fg_pass_t passes[GWR_FRAME_GRAPH_MAX_PASSES];
+    int pass_count;
+    fg_resource_t resources[GWR_FRAME_GRAPH_MAX_RESOURCES];
+    int resource_count;
+
+    int order[GWR_FRAME_GRAPH_MAX_PASSES];
+    int order_count;
+    bool deps[GWR_FRAME_GRAPH_MAX_PASSES][GWR_FRAME_GRAPH_MAX_PASSES];    // schedule() scratch
+    bool compiled;
+    int current_pass;
+
+    fg_physical_t physical[GWR_FRAME_GRAPH_MAX_RESOURCES];
+    int physical_count;
+    fg_fb_entry_t fbs[FG_MAX_FRAMEBUFFERS];
+    int fb_count;
+
+    bool timing;
+    bool queries_created;
+    fg_timer_frame_t timer_frames[FG_TIMER_FRAMES];
+    int timer_frame;
+    fg_timing_t timings[FG_MAX_TIMINGS];
+    int timing_count;
+
+    GWR_frame_graph_stats_t stats;
+};
+
+static const char *access_names[] = {
+    "color_attachment",
+    "depth_attachment",
+    "sampled",
+    "storage_image",
+    "storage_buffer",
+    "uniform_buffer",
+    "vertex_buffer",
+    "index_buffer",
+    "indirect_buffer",
+    "transfer",
+};
+
+static const char *kind_names[] = {
+    "transient",
+    "texture",
+    "buffer",
+    "backbuffer",
+};
+
+GWR_STATIC_ASSERT(GWR_ARR_LEN(access_names) == GWR_FG_ACCESS__COUNT, "access_names out of sync");
+
+// inner funcs decls
+
+static GWR_fg_resource_t add_resource(GWR_frame_graph_t *fg, const char *name, fg_res_kind_e kind);
+static void add_access(GWR_frame_graph_t *fg, int pass, GWR_fg_resource_t res, GWR_fg_access_e access, bool write);
+
+static bool is_attachment(GWR_fg_access_e access);
+static bool is_incoherent_write(GWR_fg_access_e access);
+static GLbitfield barrier_bit(GWR_fg_access_e access);
+static bool pass_reads(const fg_pass_t *pass, GWR_fg_resource_t res);
+static bool pass_writes(const fg_pass_t *pass, GWR_fg_resource_t res);
+static bool desc_equal(const GWR_fg_texture_desc_t *a, const GWR_fg_texture_desc_t *b);
+static GLsizeiptr desc_size(const GWR_fg_texture_desc_t *desc);
+
+static void cull(GWR_frame_graph_t *fg);
+static bool schedule(GWR_frame_graph_t *fg);
+static void compute_lifetimes(GWR_frame_graph_t *fg);
+static bool assign_physical(GWR_frame_graph_t *fg);
+static void label_physical(const GWR_frame_graph_t *fg, int physical, const int *sorted, int sorted_count, const int *slot_physical);
+static void compute_barriers(GWR_frame_graph_t *fg);
+static bool build_framebuffers(GWR_frame_graph_t *fg);
+static void release_unused(GWR_frame_graph_t *fg);
+
+static GWR_framebuffer_t *get_framebuffer(GWR_frame_graph_t *fg, const char *pass, GWR_texture_t *const *colors, int color_count, GWR_texture_t *depth);
+
+static int find_timing(const GWR_frame_graph_t *fg, const char *name);
+static void collect_timings(GWR_frame_graph_t *fg, fg_timer_frame_t *frame);
+
+// public funcs defs
+
+GWR_frame_graph_t *GWR_frame_graph_create(void) {
+    GWR_frame_graph_t *fg = calloc(1, sizeof(GWR_frame_graph_t));
+    if (!fg) {
+        FG_LOG(GWR_LOG_ERROR, "failed to allocate GWR_frame_graph_t");
+        return NULL;
+    }
+
+    fg->current_pass = -1;
+
+    return fg;
+}
+
+void GWR_frame_graph_destroy(GWR_frame_graph_t *fg) {
+    assert(fg);
+
+    for (int i = 0; i < fg->fb_count; ++i) {
+        GWR_framebuffer_destroy(fg->fbs[i].fb);
+    }
+    for (int i = 0; i < fg->physical_count; ++i) {
+        GWR_texture_destroy(fg->physical[i].texture);
+    }
+    if (fg->queries_created) {
+        for (int i = 0; i < FG_TIMER_FRAMES; ++i) {
+            glDeleteQueries(GWR_FRAME_GRAPH_MAX_PASSES, fg->timer_frames[i].queries);
+        }
+    }
+
+    free(fg);
+}
+
+void GWR_frame_graph_reset(GWR_frame_graph_t *fg) {
+    assert(fg);
+
+    fg->pass_count = 0;
+    fg->resource_count = 0;
+    fg->order_count = 0;
+    fg->compiled = false;
+    fg->current_pass = -1;
+}
+
+GWR_fg_resource_t GWR_frame_graph_create_texture(GWR_frame_graph_t *fg, const char *name, const GWR_fg_texture_desc_t *desc) {
+    assert(fg);
+    assert(desc);
+    assert(desc->width > 0 && desc->height > 0 && desc->format);
+
+    const GWR_fg_resource_t res = add_resource(fg, name, FG_RES_TRANSIENT);
+    if (res != GWR_FG_INVALID) {
+        fg->resources[res].desc = *desc;
+        fg->resources[res].desc.samples = desc->samples > 1 ? desc->samples : 1;
+    }
+    return res;
+}
+
+GWR_fg_resource_t GWR_frame_graph_import_texture(GWR_frame_graph_t *fg, const char *name, GWR_texture_t *texture) {
+    assert(fg);
+    assert(texture);
+
+    const GWR_fg_resource_t res = add_resource(fg, name, FG_RES_TEXTURE);
+    if (res != GWR_FG_INVALID) {
+        fg_resource_t *r = &fg->resources[res];
+        r->texture = texture;
+        r->desc.width = GWR_texture_get_width(texture);
+        r->desc.height = GWR_texture_get_height(texture);
+        r->desc.format = GWR_texture_get_format(texture);
+        r->desc.samples = GWR_texture_get_samples(texture);
+    }
+    return res;
+}
+
+GWR_fg_resource_t GWR_frame_graph_import_buffer(GWR_frame_graph_t *fg, const char *name, GLuint buffer) {
+    assert(fg);
+    assert(buffer);
+
+    const GWR_fg_resource_t res = add_resource(fg, name, FG_RES_BUFFER);
+    if (res != GWR_FG_INVALID) {
+        fg->resources[res].buffer = buffer;
+    }
+    return res;
+}
+
+GWR_fg_resource_t GWR_frame_graph_import_backbuffer(GWR_frame_graph_t *fg, const char *name) {
+    assert(fg);
+
+    return add_resource(fg, name, FG_RES_BACKBUFFER);
+}
+
+int GWR_frame_graph_add_pass(GWR_frame_graph_t *fg, const char *name, GWR_fg_execute_fn fn, void *user) {
+    assert(fg);
+    assert(name);
+    assert(fn);
+
+    if (fg->pass_count == GWR_FRAME_GRAPH_MAX_PASSES) {
+        FG_LOG(GWR_LOG_ERROR, "too many passes (max %d), '%s' dropped", GWR_FRAME_GRAPH_MAX_PASSES, name);
+        return GWR_FG_INVALID;
+    }
+
+    fg_pass_t *p = &fg->passes[fg->pass_count];
+    memset(p, 0, sizeof(*p));
+    snprintf(p->name, sizeof(p->name), "%s", name);
+    p->fn = fn;
+    p->user = user;
+    fg->compiled = false;
+
+    return fg->pass_count++;
+}
+
+void GWR_frame_graph_read(GWR_frame_graph_t *fg, int pass, GWR_fg_resource_t res, GWR_fg_access_e access) {
+    add_access(fg, pass, res, access, false);
+}
+
+void GWR_frame_graph_write(GWR_frame_graph_t *fg, int pass, GWR_fg_resource_t res, GWR_fg_access_e access) {
+    add_access(fg, pass, res, access, true);
+}
+
+void GWR_frame_graph_set_side_effect(GWR_frame_graph_t *fg, int pass) {
+    assert(fg);
+
+    if (pass >= 0 && pass < fg->pass_count) {
+        fg->passes[pass].side_effect = true;
+    }
+}
+
+bool GWR_frame_graph_compile(GWR_frame_graph_t *fg) {
+    assert(fg);
+
+    memset(&fg->stats, 0, sizeof(fg->stats));
+    fg->compiled = false;
+
+    cull(fg);
+    if (!schedule(fg)) {
+        return false;
+    }
+    compute_lifetimes(fg);
+    if (!assign_physical(fg)) {
+        return false;
+    }
+    compute_barriers(fg);
+    if (!build_framebuffers(fg)) {
+        return false;
+    }
+    release_unused(fg);
+
+    fg->stats.passes = fg->order_count;
+    fg->stats.culled_passes = fg->pass_count - fg->order_count;
+    fg->compiled = true;
+
+    return true;
+}
+
+void GWR_frame_graph_execute(GWR_frame_graph_t *fg) {
+    assert(fg);
+
+    if (!fg->compiled) {
+        FG_LOG(GWR_LOG_ERROR, "execute called without a successful compile");
+        return;
+    }
+
+    fg_timer_frame_t *frame = NULL;
+    if (fg->timing) {
+        frame = &fg->timer_frames[fg->timer_frame % FG_TIMER_FRAMES];
+        collect_timings(fg, frame);
+        ++fg->timer_frame;
+    }
+
+    const bool has_barriers = GWR_cap_has(GWR_FEATURE_SHADER_IMAGE_LOAD_STORE);
+
+    for (int i = 0; i < fg->order_count; ++i) {
+        fg_pass_t *p = &fg->passes[fg->order[i]];
+        fg->current_pass = fg->order[i];
+        GWR_debug_push_group(p->name);
+
+        if (p->barrier && has_barriers) {
+            glMemoryBarrier(p->barrier);
+        }
+
+        if (frame) {
+            int idx = find_timing(fg, p->name);
+            if (idx < 0 && fg->timing_count < FG_MAX_TIMINGS) {
+                idx = fg->timing_count++;
+                // both FG_NAME_SIZE and already terminated
+                memcpy(fg->timings[idx].name, p->name, sizeof(fg->timings[idx].name));
+                fg->timings[idx].valid = false;
+            }
+            frame->timing_idx[frame->count] = idx;
+            glBeginQuery(GL_TIME_ELAPSED, frame->queries[frame->count]);
+        }
+
+        if (p->fb || p->to_backbuffer) {
+            GWR_framebuffer_bind(p->fb);
+        }
+
+        p->fn(fg, p->user);
+
+        if (p->invalidate && p->fb) {
+            GWR_framebuffer_invalidate(p->fb, p->invalidate);
+        }
+
+        if (frame) {
+            glEndQuery(GL_TIME_ELAPSED);
+            ++frame->count;
+        }
+        GWR_debug_pop_group();
+    }
+
+    fg->current_pass = -1;
+    GWR_framebuffer_bind(NULL);
+}
+
+GWR_texture_t *GWR_frame_graph_get_texture(const GWR_frame_graph_t *fg, GWR_fg_resource_t res) {
+    assert(fg);
+    assert(res >= 0 && res < fg->resource_count);
+
+    return fg->resources[res].texture;
+}
+
+GLuint GWR_frame_graph_get_buffer(const GWR_frame_graph_t *fg, GWR_fg_resource_t res) {
+    assert(fg);
+    assert(res >= 0 && res < fg->resource_count);
+
+    return fg->resources[res].buffer;
+}
+
+GWR_framebuffer_t *GWR_frame_graph_get_framebuffer(const GWR_frame_graph_t *fg) {
+    assert(fg);
+
+    return fg->current_pass >= 0 ? fg->passes[fg->current_pass].fb : NULL;
+}
+
+void GWR_frame_graph_set_timing(GWR_frame_graph_t *fg, bool enabled) {
+    assert(fg);
+
+    if (enabled && !GWR_cap_has(GWR_FEATURE_TIMER_QUERY)) {
+        FG_LOG(GWR_LOG_WARNING, "timer queries not supported; pass timing stays off");
+        return;
+    }
+
+    if (enabled && !fg->queries_created) {
+        for (int i = 0; i < FG_TIMER_FRAMES; ++i) {
+            glGenQueries(GWR_FRAME_GRAPH_MAX_PASSES, fg->timer_frames[i].queries);
+            fg->timer_frames[i].count = 0;
+        }
+        fg->queries_created = true;
+    }
+
+    fg->timing = enabled;
+}
+
+bool GWR_frame_graph_get_pass_time(const GWR_frame_graph_t *fg, const char *name, double *last_ms, double *avg_ms) {
+    assert(fg);
+    assert(name);
+
+    const int idx = find_timing(fg, name);
+    if (idx < 0 || !fg->timings[idx].valid) {
+        return false;
+    }
+
+    if (last_ms) {
+        *last_ms = fg->timings[idx].last_ms;
+    }
+    if (avg_ms) {
+        *avg_ms = fg->timings[idx].avg_ms;
+    }
+    return true;
+}
+
+GWR_frame_graph_stats_t GWR_frame_graph_get_stats(const GWR_frame_graph_t *fg) {
+    assert(fg);
+
+    return fg->stats;
+}
+
+void GWR_frame_graph_dump(const GWR_frame_graph_t *fg, FILE *out) {
+    assert(fg);
+
+    if (!out) {
+        return;
+    }
+
+    const GWR_frame_graph_stats_t *s = &fg->stats;
+    fprintf(out, "frame graph: %d passes (%d culled), %d barriers\n", s->passes, s->culled_passes, s->barriers);
+    fprintf(
+        out, "transient memory: %.2f MiB unaliased, %.2f MiB aliased (%d textures -> %d physical)\n",
+        (double) s->memory_unaliased / (1024.0 * 1024.0), (double) s->memory_aliased / (1024.0 * 1024.0),
+        s->transient_textures, s->physical_textures
+    );
+
+    fprintf(out, "passes:\n");
+    for (int i = 0; i < fg->order_count; ++i) {
+        const fg_pass_t *p = &fg->passes[fg->order[i]];
+
+        double last_ms = 0.0;
+        if (GWR_frame_graph_get_pass_time(fg, p->name, &last_ms, NULL)) {
+            fprintf(out, "  #%d %s (%.3f ms)\n", i, p->name, last_ms);
+        } else {
+            fprintf(out, "  #%d %s\n", i, p->name);
+        }
+        if (p->barrier) {
+            fprintf(out, "      barrier 0x%08X\n", p->barrier);
+        }
+        for (int j = 0; j < p->access_count; ++j) {
+            const fg_access_t *a = &p->accesses[j];
+            fprintf(
+                out, "      %s %s (%s)\n", a->write ? "write" : "read ",
+                fg->resources[a->res].name, access_names[a->access]
+            );
+        }
+        if (p->invalidate) {
+            fprintf(out, "      invalidate 0x%08X\n", p->invalidate);
+        }
+    }
+
+    for (int i = 0; i < fg->pass_count; ++i) {
+        if (!fg->passes[i].alive) {
+            fprintf(out, "  culled %s\n", fg->passes[i].name);
+        }
+    }
+
+    fprintf(out, "resources:\n");
+    for (int i = 0; i < fg->resource_count; ++i) {
+        const fg_resource_t *r = &fg->resources[i];
+        fprintf(out, "  %-24s %-10s", r->name, kind_names[r->kind]);
+        if (r->kind == FG_RES_TRANSIENT || r->kind == FG_RES_TEXTURE) {
+            fprintf(out, " %dx%d fmt 0x%04X x%d", r->desc.width, r->desc.height, r->desc.format, r->desc.samples);
+        }
+        if (r->first >= 0) {
+            fprintf(out, " life [%d, %d]", r->first, r->last);
+        } else {
+            fprintf(out, " unused");
+        }
+        if (r->kind == FG_RES_TRANSIENT && r->first >= 0) {
+            fprintf(out, " slot %d", r->slot);
+        }
+        fprintf(out, "\n");
+    }
+}
+
+void GWR_frame_graph_dump_dot(const GWR_frame_graph_t *fg, FILE *out) {
+    assert(fg);
+
+    if (!out) {
+        return;
+    }
+
+    fprintf(out, "digraph frame_graph {\n");
+    fprintf(out, "    rankdir=LR;\n");
+    fprintf(out, "    node [fontname=\"monospace\"];\n");
+
+    for (int i = 0; i < fg->pass_count; ++i) {
+        const fg_pass_t *p = &fg->passes[i];
+        fprintf(
+            out, "    p%d [shape=box, label=\"%s\"%s];\n", i, p->name,
+            p->alive ? ", style=filled, fillcolor=lightblue" : ", style=dashed, color=gray"
+        );
+    }
+
+    for (int i = 0; i < fg->resource_count; ++i) {
+        const fg_resource_t *r = &fg->resources[i];
+        if (r->kind == FG_RES_TRANSIENT) {
+            fprintf(out, "    r%d [shape=ellipse, label=\"%s\\nslot %d\"];\n", i, r->name, r->slot);
+        } else {
+            fprintf(out, "    r%d [shape=ellipse, style=bold, label=\"%s\\n(%s)\"];\n", i, r->name, kind_names[r->kind]);
+        }
+    }
+
+    for (int i = 0; i < fg->pass_count; ++i) {
+        const fg_pass_t *p = &fg->passes[i];
+        for (int j = 0; j < p->access_count; ++j) {
+            const fg_access_t *a = &p->accesses[j];
+            if (a->write) {
+                fprintf(out, "    p%d -> r%d [label=\"%s\"];\n", i, a->res, access_names[a->access]);
+            } else {
+                fprintf(out, "    r%d -> p%d [label=\"%s\"];\n", a->res, i, access_names[a->access]);
+            }
+        }
+    }
+
+    fprintf(out, "}\n");
+}
+
+// inner funcs defs
+
+static GWR_fg_resource_t add_resource(GWR_frame_graph_t *fg, const char *name, fg_res_kind_e kind) {
+    assert(name);
+
+    if (fg->resource_count == GWR_FRAME_GRAPH_MAX_RESOURCES) {
+        FG_LOG(GWR_LOG_ERROR, "too many resources (max %d), '%s' dropped", GWR_FRAME_GRAPH_MAX_RESOURCES, name);
+        return GWR_FG_INVALID;
+    }
+
+    fg_resource_t *r = &fg->resources[fg->resource_count];
+    memset(r, 0, sizeof(*r));
+    snprintf(r->name, sizeof(r->name), "%s", name);
+    r->kind = kind;
+    r->first = -1;
+    r->last = -1;
+    r->slot = -1;
+    fg->compiled = false;
+
+    return fg->resource_count++;
+}
+
+static void add_access(GWR_frame_graph_t *fg, int pass, GWR_fg_resource_t res, GWR_fg_access_e access, bool write) {
+    assert(fg);
+    assert(access < GWR_FG_ACCESS__COUNT);
+
+    if (pass < 0 || pass >= fg->pass_count || res < 0 || res >= fg->resource_count) {
+        // creation already failed and was logged
+        return;
+    }
+
+    fg_pass_t *p = &fg->passes[pass];
+    if (p->access_count == GWR_FRAME_GRAPH_MAX_ACCESSES) {
+        FG_LOG(GWR_LOG_ERROR, "pass '%s': too many accesses (max %d)", p->name, GWR_FRAME_GRAPH_MAX_ACCESSES);
+        return;
+    }
+
+    p->accesses[p->access_count++] = (fg_access_t) {res, access, write};
+    fg->compiled = false;
+}
+
+static bool is_attachment(GWR_fg_access_e access) {
+    return access == GWR_FG_ACCESS_COLOR_ATTACHMENT || access == GWR_FG_ACCESS_DEPTH_ATTACHMENT;
+}
+
+static bool is_incoherent_write(GWR_fg_access_e access) {
+    // writes that are not ordered with later reads without glMemoryBarrier
+    return access == GWR_FG_ACCESS_STORAGE_IMAGE || access == GWR_FG_ACCESS_STORAGE_BUFFER;
+}
+
+static GLbitfield barrier_bit(GWR_fg_access_e access) {
+    switch (access) {
+        case GWR_FG_ACCESS_COLOR_ATTACHMENT:
+        case GWR_FG_ACCESS_DEPTH_ATTACHMENT:
+            return GL_FRAMEBUFFER_BARRIER_BIT;
+        case GWR_FG_ACCESS_SAMPLED:
+            return GL_TEXTURE_FETCH_BARRIER_BIT;
+        case GWR_FG_ACCESS_STORAGE_IMAGE:
+            return GL_SHADER_IMAGE_ACCESS_BARRIER_BIT;
+        case GWR_FG_ACCESS_STORAGE_BUFFER:
+            return GL_SHADER_STORAGE_BARRIER_BIT;
+        case GWR_FG_ACCESS_UNIFORM_BUFFER:
+            return GL_UNIFORM_BARRIER_BIT;
+        case GWR_FG_ACCESS_VERTEX_BUFFER:
+            return GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT;
+        case GWR_FG_ACCESS_INDEX_BUFFER:
+            return GL_ELEMENT_ARRAY_BARRIER_BIT;
+        case GWR_FG_ACCESS_INDIRECT_BUFFER:
+            return GL_COMMAND_BARRIER_BIT;
+        case GWR_FG_ACCESS_TRANSFER:
+            return GL_TEXTURE_UPDATE_BARRIER_BIT | GL_BUFFER_UPDATE_BARRIER_BIT | GL_PIXEL_BUFFER_BARRIER_BIT;
+        default:
+            return 0;
+    }
+}
+
+static bool pass_reads(const fg_pass_t *pass, GWR_fg_resource_t res) {
+    for (int i = 0; i < pass->access_count; ++i) {
+        if (pass->accesses[i].res == res && !pass->accesses[i].write) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool pass_writes(const fg_pass_t *pass, GWR_fg_resource_t res) {
+    for (int i = 0; i < pass->access_count; ++i) {
+        if (pass->accesses[i].res == res && pass->accesses[i].write) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool desc_equal(const GWR_fg_texture_desc_t *a, const GWR_fg_texture_desc_t *b) {
+    return a->width == b->width && a->height == b->height && a->format == b->format && a->samples == b->samples;
+}
+
+static GLsizeiptr desc_size(const GWR_fg_texture_desc_t *desc) {
+    return (GLsizeiptr) desc->width * desc->height * desc->samples * GWR_texture_format_bytes(desc->format);
+}
+
+static void cull(GWR_frame_graph_t *fg) {
+    // roots: side effects and writes to anything that outlives the frame
+    for (int i = 0; i < fg->pass_count; ++i) {
+        fg_pass_t *p = &fg->passes[i];
+        p->alive = p->side_effect;
+        for (int j = 0; j < p->access_count && !p->alive; ++j) {
+            const fg_access_t *a = &p->accesses[j];
+            p->alive = a->write && fg->resources[a->res].kind != FG_RES_TRANSIENT;
+        }
+    }
+
+    // a live reader keeps alive the last writer before it of what it reads;
+    // passes run in declaration order and a write replaces the contents, so
+    // writers before that one are overwritten unseen. Walking backwards, a
+    // writer kept here is visited later and keeps its own inputs
+    for (int i = fg->pass_count - 1; i >= 0; --i) {
+        const fg_pass_t *p = &fg->passes[i];
+        if (!p->alive) {
+            continue;
+        }
+        for (int j = 0; j < p->access_count; ++j) {
+            if (p->accesses[j].write) {
+                // overwriting needs nothing from earlier writers
+                continue;
+            }
+            const GWR_fg_resource_t res = p->accesses[j].res;
+            for (int k = i - 1; k >= 0; --k) {
+                if (pass_writes(&fg->passes[k], res)) {
+                    fg->passes[k].alive = true;
+                    break;
+                }
+            }
+        }
+    }
+}
+
+static bool schedule(GWR_frame_graph_t *fg) {
+    // Kahn's algorithm over RAW/WAR/WAW edges, ties broken by declaration order
+    bool (*dep)[GWR_FRAME_GRAPH_MAX_PASSES] = fg->deps;
+    bool scheduled[GWR_FRAME_GRAPH_MAX_PASSES];
+    memset(fg->deps, 0, sizeof(fg->deps));
+    memset(scheduled, 0, sizeof(scheduled));
+
+    int alive_count = 0;
+    for (int i = 0; i < fg->pass_count; ++i) {
+        const fg_pass_t *p = &fg->passes[i];
+        if (!p->alive) {
+            continue;
+        }
+        ++alive_count;
+        for (int k = 0; k < i; ++k) {
+            const fg_pass_t *q = &fg->passes[k];
+            if (!q->alive) {
+                continue;
+            }
+            for (int j = 0; j < p->access_count && !dep[i][k]; ++j) {
+                const fg_access_t *a = &p->accesses[j];
+                dep[i][k] = pass_writes(q, a->res) || (a->write && pass_reads(q, a->res));
+            }
+        }
+    }
+
+    fg->order_count = 0;
+    while (fg->order_count < alive_count) {
+        int next = -1;
+        for (int i = 0; i < fg->pass_count && next < 0; ++i) {
+            if (!fg->passes[i].alive || scheduled[i]) {
+                continue;
+            }
+            bool ready = true;
+            for (int k = 0; k < fg->pass_count && ready; ++k) {
+                ready = !dep[i][k] || scheduled[k];
+            }
+            if (ready) {
+                next = i;
+            }
+        }
+        if (next < 0) {
+            FG_LOG(GWR_LOG_ERROR, "dependency cycle between passes");
+            return false;
+        }
+        scheduled[next] = true;
+        fg->order[fg->order_count++] = next;
+    }
+
+    return true;
+}
+
+static void compute_lifetimes(GWR_frame_graph_t *fg) {
+    for (int i = 0; i < fg->resource_count; ++i) {
+        fg->resources[i].first = -1;
+        fg->resources[i].last = -1;
+        fg->resources[i].slot = -1;
+    }
+
+    for (int i = 0; i < fg->order_count; ++i) {
+        const fg_pass_t *p = &fg->passes[fg->order[i]];
+        for (int j = 0; j < p->access_count; ++j) {
+            fg_resource_t *r = &fg->resources[p->accesses[j].res];
+            if (r->first < 0) {
+                r->first = i;
+            }
+            r->last = i;
+        }
+    }
+}
+
+static bool assign_physical(GWR_frame_graph_t *fg) {
+    // GL cannot place different textures in one allocation, so aliasing
+    // means reusing a texture with an identical desc once its previous
+    // user is done with it
+    GWR_fg_texture_desc_t slot_desc[GWR_FRAME_GRAPH_MAX_RESOURCES];
+    int slot_last[GWR_FRAME_GRAPH_MAX_RESOURCES];
+    int slot_physical[GWR_FRAME_GRAPH_MAX_RESOURCES];
+    int slot_count = 0;
+
+    int sorted[GWR_FRAME_GRAPH_MAX_RESOURCES];
+    int sorted_count = 0;
+    for (int i = 0; i < fg->resource_count; ++i) {
+        const fg_resource_t *r = &fg->resources[i];
+        if (r->kind != FG_RES_TRANSIENT || r->first < 0) {
+            continue;
+        }
+        int j = sorted_count++;
+        while (j > 0 && fg->resources[sorted[j - 1]].first > r->first) {
+            sorted[j] = sorted[j - 1];
+            --j;
+        }
+        sorted[j] = i;
+    }
+
+    for (int i = 0; i < sorted_count; ++i) {
+        fg_resource_t *r = &fg->resources[sorted[i]];
+
+        int slot = -1;
+        for (int s = 0; s < slot_count && slot < 0; ++s) {
+            if (slot_last[s] < r->first && desc_equal(&slot_desc[s], &r->desc)) {
+                slot = s;
+            }
+        }
+        if (slot < 0) {
+            slot = slot_count++;
+            slot_desc[slot] = r->desc;
+            fg->stats.memory_aliased += desc_size(&r->desc);
+        }
+        slot_last[slot] = r->last;
+        r->slot = slot;
+        fg->stats.memory_unaliased += desc_size(&r->desc);
+    }
+
+    for (int i = 0; i < fg->physical_count; ++i) {
+        fg->physical[i].used = false;
+    }
+
+    for (int s = 0; s < slot_count; ++s) {
+        int idx = -1;
+        for (int i = 0; i < fg->physical_count && idx < 0; ++i) {
+            if (!fg->physical[i].used && desc_equal(&fg->physical[i].desc, &slot_desc[s])) {
+                idx = i;
+            }
+        }
+        if (idx < 0) {
+            if (fg->physical_count == GWR_FRAME_GRAPH_MAX_RESOURCES) {
+                FG_LOG(GWR_LOG_ERROR, "out of physical texture slots");
+                return false;
+            }
+            GWR_texture_t *tex = GWR_texture_create(
+                slot_desc[s].format, slot_desc[s].width, slot_desc[s].height, 1, slot_desc[s].samples
+            );
+            if (!tex) {
+                return false;
+            }
+            idx = fg->physical_count++;
+            fg->physical[idx].desc = slot_desc[s];
+            fg->physical[idx].texture = tex;
+        }
+        fg->physical[idx].used = true;
+        slot_physical[s] = idx;
+    }
+
+    for (int i = 0; i < sorted_count; ++i) {
+        fg_resource_t *r = &fg->resources[sorted[i]];
+        r->texture = fg->physical[slot_physical[r->slot]].texture;
+    }
+
+    if (GWR_debug_is_enabled()) {
+        for (int i = 0; i < fg->physical_count; ++i) {
+            if (fg->physical[i].used) {
+                label_physical(fg, i, sorted, sorted_count, slot_physical);
+            }
+        }
+    }
+
+    fg->stats.transient_textures = sorted_count;
+    fg->stats.physical_textures = slot_count;
+
+    return true;
+}
+
+static void label_physical(const GWR_frame_graph_t *fg, int physical, const int *sorted, int sorted_count, const int *slot_physical) {
+    // one texture backs every resource aliased onto it this frame
+    char label[FG_LABEL_SIZE];
+    size_t len = (size_t) snprintf(label, sizeof(label), "frame graph");
+    for (int i = 0; i < sorted_count && len < sizeof(label); ++i) {
+        const fg_resource_t *r = &fg->resources[sorted[i]];
+        if (slot_physical[r->slot] == physical) {
+            len += (size_t) snprintf(label + len, sizeof(label) - len, " '%s'", r->name);
+        }
+    }
+    GWR_debug_label(GL_TEXTURE, GWR_texture_get_id(fg->physical[physical].texture), "%s", label);
+}
+
+static void compute_barriers(GWR_frame_graph_t *fg) {
+    // per resource: is there an incoherent write not yet covered, and which
+    // barrier bits were issued since it
+    bool pending[GWR_FRAME_GRAPH_MAX_RESOURCES];
+    GLbitfield issued[GWR_FRAME_GRAPH_MAX_RESOURCES];
+    memset(pending, 0, sizeof(pending));
+    memset(issued, 0, sizeof(issued));
+
+    for (int i = 0; i < fg->order_count; ++i) {
+        fg_pass_t *p = &fg->passes[fg->order[i]];
+
+        p->barrier = 0;
+        for (int j = 0; j < p->access_count; ++j) {
+            const fg_access_t *a = &p->accesses[j];
+            const GLbitfield bit = barrier_bit(a->access);
+            if (pending[a->res] && !(issued[a->res] & bit)) {
+                p->barrier |= bit;
+            }
+        }
+
+        if (p->barrier) {
+            ++fg->stats.barriers;
+            // glMemoryBarrier is global: it covers every pending write
+            for (int r = 0; r < fg->resource_count; ++r) {
+                issued[r] |= pending[r] ? p->barrier : 0;
+            }
+        }
+
+        for (int j = 0; j < p->access_count; ++j) {
+            const fg_access_t *a = &p->accesses[j];
+            if (a->write) {
+                pending[a->res] = is_incoherent_write(a->access);
+                issued[a->res] = 0;
+            }
+        }
+    }
+}
+
+static bool build_framebuffers(GWR_frame_graph_t *fg) {
+    for (int i = 0; i < fg->fb_count; ++i) {
+        fg->fbs[i].used = false;
+    }
+
+    for (int i = 0; i < fg->order_count; ++i) {
+        fg_pass_t *p = &fg->passes[fg->order[i]];
+
+        GWR_texture_t *colors[GWR_FRAMEBUFFER_MAX_COLOR_ATTACHMENTS];
+        GWR_fg_resource_t color_res[GWR_FRAMEBUFFER_MAX_COLOR_ATTACHMENTS];
+        int color_count = 0;
+        GWR_texture_t *depth = NULL;
+        GWR_fg_resource_t depth_res = GWR_FG_INVALID;
+
+        p->fb = NULL;
+        p->to_backbuffer = false;
+        p->invalidate = 0;
+
+        for (int j = 0; j < p->access_count; ++j) {
+            const fg_access_t *a = &p->accesses[j];
+            if (!is_attachment(a->access)) {
+                continue;
+            }
+
+            const fg_resource_t *r = &fg->resources[a->res];
+            if (r->kind == FG_RES_BACKBUFFER) {
+                p->to_backbuffer = true;
+                continue;
+            }
+            if (r->kind == FG_RES_BUFFER) {
+                FG_LOG(GWR_LOG_ERROR, "pass '%s': buffer '%s' used as attachment", p->name, r->name);
+                return false;
+            }
+
+            if (a->access == GWR_FG_ACCESS_DEPTH_ATTACHMENT) {
+                depth = r->texture;
+                depth_res = a->res;
+                continue;
+            }
+
+            bool dup = false;
+            for (int k = 0; k < color_count; ++k) {
+                dup = dup || color_res[k] == a->res;
+            }
+            if (!dup && color_count < GWR_FRAMEBUFFER_MAX_COLOR_ATTACHMENTS) {
+                color_res[color_count] = a->res;
+                colors[color_count++] = r->texture;
+            }
+        }
+
+        if (p->to_backbuffer) {
+            if (color_count || depth) {
+                FG_LOG(GWR_LOG_ERROR, "pass '%s': backbuffer cannot be combined with other attachments", p->name);
+                return false;
+            }
+            continue;
+        }
+        if (!color_count && !depth) {
+            continue;
+        }
+
+        p->fb = get_framebuffer(fg, p->name, colors, color_count, depth);
+        if (!p->fb) {
+            return false;
+        }
+
+        // transient attachments nobody reads afterwards need no store
+        bool colors_die = color_count > 0;
+        for (int k = 0; k < color_count; ++k) {
+            const fg_resource_t *r = &fg->resources[color_res[k]];
+            colors_die = colors_die && r->kind == FG_RES_TRANSIENT && r->last == i;
+        }
+        if (colors_die) {
+            p->invalidate |= GL_COLOR_BUFFER_BIT;
+        }
+        if (depth_res != GWR_FG_INVALID) {
+            const fg_resource_t *r = &fg->resources[depth_res];
+            if (r->kind == FG_RES_TRANSIENT && r->last == i) {
+                p->invalidate |= GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT;
+            }
+        }
+    }
+
+    return true;
+}
+
+static void release_unused(GWR_frame_graph_t *fg) {
+    // framebuffers first: they reference physical textures without owning them
+    for (int i = 0; i < fg->fb_count;) {
+        if (!fg->fbs[i].used) {
+            GWR_framebuffer_destroy(fg->fbs[i].fb);
+            fg->fbs[i] = fg->fbs[--fg->fb_count];
+        } else {
+            ++i;
+        }
+    }
+
+    for (int i = 0; i < fg->physical_count;) {
+        if (!fg->physical[i].used) {
+            GWR_texture_destroy(fg->physical[i].texture);
+            fg->physical[i] = fg->physical[--fg->physical_count];
+        } else {
+            ++i;
+        }
+    }
+}
+
+static GWR_framebuffer_t *get_framebuffer(GWR_frame_graph_t *fg, const char *pass, GWR_texture_t *const *colors, int color_count, GWR_texture_t *depth) {
+    for (int i = 0; i < fg->fb_count; ++i) {
+        fg_fb_entry_t *e = &fg->fbs[i];
+        if (e->color_count != color_count || e->depth != depth) {
+            continue;
+        }
+        bool same = true;
+        for (int k = 0; k < color_count && same; ++k) {
+            same = e->colors[k] == colors[k];
+        }
+        if (same) {
+            e->used = true;
+            return e->fb;
+        }
+    }
+
+    if (fg->fb_count == FG_MAX_FRAMEBUFFERS) {
+        FG_LOG(GWR_LOG_ERROR, "out of framebuffer cache slots");
+        return NULL;
+    }
+
+    GWR_framebuffer_t *fb = GWR_framebuffer_create_from(colors, color_count, depth);
+    if (!fb) {
+        return NULL;
+    }
+    // cached by attachments, so later passes with the same targets share it
+    GWR_debug_label(GL_FRAMEBUFFER, GWR_framebuffer_get_id(fb), "frame graph '%s'", pass);
+
+    fg_fb_entry_t *e = &fg->fbs[fg->fb_count++];
+    memset(e, 0, sizeof(*e));
+    memcpy(e->colors, colors, (size_t) color_count * sizeof(colors[0]));
+    e->color_count = color_count;
+    e->depth = depth;
+    e->fb = fb;
+    e->used = true;
+
+    return fb;
+}
+
+static int find_timing(const GWR_frame_graph_t *fg, const char *name) {
+    for (int i = 0; i < fg->timing_count; ++i) {
+        if (strncmp(fg->timings[i].name, name, FG_NAME_SIZE - 1) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+static void collect_timings(GWR_frame_graph_t *fg, fg_timer_frame_t *frame) {
+    // queries of this slot were issued FG_TIMER_FRAMES frames ago; results
+    // that are still not available are dropped rather than waited for
+    for (int i = 0; i < frame->count; ++i) {
+        GLint available = 0;
+        glGetQueryObjectiv(frame->queries[i], GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available || frame->timing_idx[i] < 0) {
+            continue;
+        }
+
+        GLuint64 ns = 0;
+        glGetQueryObjectui64v(frame->queries[i], GL_QUERY_RESULT, &ns);
+
+        fg_timing_t *t = &fg->timings[frame->timing_idx[i]];
+        t->last_ms = (double) ns / 1e6;
+        t->avg_ms = t->valid ? t->avg_ms + (t->last_ms - t->avg_ms) * FG_TIMING_SMOOTHING : t->last_ms;
+        t->valid = true;
+    }
+
+    frame->count = 0;
+}
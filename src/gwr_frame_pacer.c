@@ -0,0 +1,329 @@
+#include "internal/gwr_frame_pacer.h"
+#include "internal/gwr_log.h"
+#include "internal/gwr_util.h"
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <assert.h>
+#include <time.h>
+
+#include "glad/glad.h"
+
+#define FP_LOG(level, msg, ...)    GWR_LOG_AT(GWR_LOG_SYS_FRAME_PACER, (level), msg, ##__VA_ARGS__)
+
+#define FP_WAIT_TIMEOUT_NS    1000000000ull
+
+struct GWR_frame_pacer_t {
+    uint64_t period_ns;         // 0 = uncapped
+    uint64_t spin_ns;
+    uint64_t deadline_ns;       // when the next frame may start
+    int max_frames_in_flight;
+
+    GLsync fences[GWR_FRAME_PACER_MAX_FRAMES_IN_FLIGHT];
+    int fence_idx;
+
+    uint64_t frame_start_ns;    // 0 before the first frame
+
+    uint32_t histogram[GWR_FRAME_PACER_HISTOGRAM_BUCKETS];
+    uint64_t frames;
+    double last_ms;
+    double min_ms;
+    double max_ms;
+    double sum_ms;
+    double fence_wait_ms;
+    double sleep_ms;
+    double swap_ms;
+    uint64_t swaps;
+};
+
+// inner funcs decls
+
+static void sleep_until(uint64_t deadline_ns, uint64_t spin_ns);
+static double wait_fence(GLsync fence);
+static void record_frame(GWR_frame_pacer_t *pacer, double ms);
+
+// public funcs defs
+
+GWR_frame_pacer_t *GWR_frame_pacer_create(double target_fps, int max_frames_in_flight) {
+    GWR_frame_pacer_t *pacer = calloc(1, sizeof(GWR_frame_pacer_t));
+    if (!pacer) {
+        FP_LOG(GWR_LOG_ERROR, "failed to allocate GWR_frame_pacer_t");
+        return NULL;
+    }
+
+    pacer->spin_ns = (uint64_t) GWR_FRAME_PACER_DEFAULT_SPIN_US * 1000ull;
+    GWR_frame_pacer_set_target_fps(pacer, target_fps);
+    GWR_frame_pacer_set_max_frames_in_flight(pacer, max_frames_in_flight);
+    GWR_frame_pacer_reset_stats(pacer);
+
+    return pacer;
+}
+
+void GWR_frame_pacer_destroy(GWR_frame_pacer_t *pacer) {
+    assert(pacer);
+
+    for (int i = 0; i < GWR_FRAME_PACER_MAX_FRAMES_IN_FLIGHT; ++i) {
+        if (pacer->fences[i]) {
+            glDeleteSync(pacer->fences[i]);
+        }
+    }
+
+    free(pacer);
+}
+
+void GWR_frame_pacer_set_target_fps(GWR_frame_pacer_t *pacer, double target_fps) {
+    assert(pacer);
+
+    pacer->period_ns = target_fps > 0.0 ? (uint64_t) (1e9 / target_fps) : 0;
+    pacer->deadline_ns = 0;
+}
+
+void GWR_frame_pacer_set_max_frames_in_flight(GWR_frame_pacer_t *pacer, int frames) {
+    assert(pacer);
+
+    if (frames <= 0) {
+        frames = GWR_FRAME_PACER_DEFAULT_FRAMES_IN_FLIGHT;
+    }
+    if (frames > GWR_FRAME_PACER_MAX_FRAMES_IN_FLIGHT) {
+        FP_LOG(GWR_LOG_WARNING, "%d frames in flight clamped to %d", frames, GWR_FRAME_PACER_MAX_FRAMES_IN_FLIGHT);
+        frames = GWR_FRAME_PACER_MAX_FRAMES_IN_FLIGHT;
+    }
+
+    // fences that fall out of a shrunk ring are dropped, not waited on
+    for (int i = frames; i < GWR_FRAME_PACER_MAX_FRAMES_IN_FLIGHT; ++i) {
+        if (pacer->fences[i]) {
+            glDeleteSync(pacer->fences[i]);
+            pacer->fences[i] = NULL;
+        }
+    }
+    if (pacer->fence_idx >= frames) {
+        pacer->fence_idx = 0;
+    }
+
+    pacer->max_frames_in_flight = frames;
+}
+
+void GWR_frame_pacer_set_spin_threshold(GWR_frame_pacer_t *pacer, int spin_us) {
+    assert(pacer);
+
+    pacer->spin_ns = spin_us > 0 ? (uint64_t) spin_us * 1000ull : 0;
+}
+
+void GWR_frame_pacer_begin_frame(GWR_frame_pacer_t *pacer) {
+    assert(pacer);
+
+    // the fence in this slot belongs to the frame max_frames_in_flight back
+    GLsync *fence = &pacer->fences[pacer->fence_idx];
+    if (*fence) {
+        pacer->fence_wait_ms += wait_fence(*fence);
+        glDeleteSync(*fence);
+        *fence = NULL;
+    }
+
+    if (pacer->period_ns) {
+        const uint64_t before = GWR_now_ns();
+        if (pacer->deadline_ns && before < pacer->deadline_ns) {
+            sleep_until(pacer->deadline_ns, pacer->spin_ns);
+        }
+
+        const uint64_t now = GWR_now_ns();
+        pacer->sleep_ms += (double) (now - before) / 1e6;
+
+        // advance on the ideal schedule so jitter does not accumulate, but
+        // do not try to catch up after a long stall
+        if (!pacer->deadline_ns || now > pacer->deadline_ns + pacer->period_ns) {
+            pacer->deadline_ns = now + pacer->period_ns;
+        } else {
+            pacer->deadline_ns += pacer->period_ns;
+        }
+    }
+
+    const uint64_t start = GWR_now_ns();
+    if (pacer->frame_start_ns) {
+        record_frame(pacer, (double) (start - pacer->frame_start_ns) / 1e6);
+    }
+    pacer->frame_start_ns = start;
+}
+
+void GWR_frame_pacer_end_frame(GWR_frame_pacer_t *pacer, const GWR_window_t *window) {
+    assert(pacer);
+    assert(window);
+
+    const uint64_t before = GWR_now_ns();
+    GWR_window_swap_buffers(window);
+    pacer->swap_ms += (double) (GWR_now_ns() - before) / 1e6;
+    ++pacer->swaps;
+
+    // placed after the swap so it also covers the present
+    GLsync *fence = &pacer->fences[pacer->fence_idx];
+    assert(!*fence);
+    *fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+    pacer->fence_idx = (pacer->fence_idx + 1) % pacer->max_frames_in_flight;
+}
+
+GWR_frame_pacer_stats_t GWR_frame_pacer_get_stats(const GWR_frame_pacer_t *pacer) {
+    assert(pacer);
+
+    GWR_frame_pacer_stats_t stats;
+    memset(&stats, 0, sizeof(stats));
+
+    stats.frames = pacer->frames;
+    if (!pacer->frames) {
+        return stats;
+    }
+
+    const double n = (double) pacer->frames;
+    stats.last_ms = pacer->last_ms;
+    stats.min_ms = pacer->min_ms;
+    stats.max_ms = pacer->max_ms;
+    stats.avg_ms = pacer->sum_ms / n;
+    stats.p50_ms = GWR_frame_pacer_get_percentile(pacer, 50.0);
+    stats.p95_ms = GWR_frame_pacer_get_percentile(pacer, 95.0);
+    stats.p99_ms = GWR_frame_pacer_get_percentile(pacer, 99.0);
+    stats.avg_fence_wait_ms = pacer->fence_wait_ms / n;
+    stats.avg_sleep_ms = pacer->sleep_ms / n;
+    stats.avg_swap_ms = pacer->swaps ? pacer->swap_ms / (double) pacer->swaps : 0.0;
+
+    return stats;
+}
+
+double GWR_frame_pacer_get_percentile(const GWR_frame_pacer_t *pacer, double percentile) {
+    assert(pacer);
+
+    if (!pacer->frames) {
+        return 0.0;
+    }
+
+    const uint64_t target = (uint64_t) ((double) pacer->frames * percentile / 100.0 + 0.5);
+    uint64_t count = 0;
+    for (int i = 0; i < GWR_FRAME_PACER_HISTOGRAM_BUCKETS; ++i) {
+        count += pacer->histogram[i];
+        if (count >= target && count) {
+            // upper edge of the bucket, clamped to what was actually seen
+            const double edge = (i + 1) * GWR_FRAME_PACER_HISTOGRAM_BUCKET_MS;
+            return edge < pacer->max_ms ? edge : pacer->max_ms;
+        }
+    }
+
+    return pacer->max_ms;
+}
+
+const uint32_t *GWR_frame_pacer_get_histogram(const GWR_frame_pacer_t *pacer) {
+    assert(pacer);
+
+    return pacer->histogram;
+}
+
+void GWR_frame_pacer_reset_stats(GWR_frame_pacer_t *pacer) {
+    assert(pacer);
+
+    memset(pacer->histogram, 0, sizeof(pacer->histogram));
+    pacer->frames = 0;
+    pacer->last_ms = 0.0;
+    pacer->min_ms = 0.0;
+    pacer->max_ms = 0.0;
+    pacer->sum_ms = 0.0;
+    pacer->fence_wait_ms = 0.0;
+    pacer->sleep_ms = 0.0;
+    pacer->swap_ms = 0.0;
+    pacer->swaps = 0;
+}
+
+void GWR_frame_pacer_dump_histogram(const GWR_frame_pacer_t *pacer, FILE *out) {
+    assert(pacer);
+
+    if (!out) {
+        return;
+    }
+
+    const GWR_frame_pacer_stats_t s = GWR_frame_pacer_get_stats(pacer);
+    fprintf(
+        out, "frames %llu: avg %.2f ms, min %.2f, max %.2f, p50 %.2f, p95 %.2f, p99 %.2f\n",
+        (unsigned long long) s.frames, s.avg_ms, s.min_ms, s.max_ms, s.p50_ms, s.p95_ms, s.p99_ms
+    );
+    fprintf(
+        out, "per frame: fence wait %.3f ms, sleep %.3f ms, swap %.3f ms\n",
+        s.avg_fence_wait_ms, s.avg_sleep_ms, s.avg_swap_ms
+    );
+
+    uint32_t peak = 0;
+    for (int i = 0; i < GWR_FRAME_PACER_HISTOGRAM_BUCKETS; ++i) {
+        peak = pacer->histogram[i] > peak ? pacer->histogram[i] : peak;
+    }
+    if (!peak) {
+        return;
+    }
+
+    for (int i = 0; i < GWR_FRAME_PACER_HISTOGRAM_BUCKETS; ++i) {
+        const uint32_t count = pacer->histogram[i];
+        if (!count) {
+            continue;
+        }
+        const int bar = (int) ((uint64_t) count * 50 / peak);
+        fprintf(out, "%7.2f ms %8u |", i * GWR_FRAME_PACER_HISTOGRAM_BUCKET_MS, count);
+        for (int j = 0; j < bar; ++j) {
+            fputc('#', out);
+        }
+        fputc('\n', out);
+    }
+}
+
+// inner funcs defs
+
+static void sleep_until(uint64_t deadline_ns, uint64_t spin_ns) {
+    // sleep overshoots by up to a scheduler tick, so only the bulk of the
+    // wait is slept and the last spin_ns are burned polling the clock
+    for (;;) {
+        const uint64_t now = GWR_now_ns();
+        if (now >= deadline_ns) {
+            return;
+        }
+        const uint64_t left = deadline_ns - now;
+        if (left <= spin_ns) {
+            break;
+        }
+        const uint64_t chunk = left - spin_ns;
+        const struct timespec ts = {(time_t) (chunk / 1000000000ull), (long) (chunk % 1000000000ull)};
+        nanosleep(&ts, NULL);
+    }
+
+    while (GWR_now_ns() < deadline_ns) {
+        // spin
+    }
+}
+
+static double wait_fence(GLsync fence) {
+    const uint64_t before = GWR_now_ns();
+
+    GLbitfield flags = GL_SYNC_FLUSH_COMMANDS_BIT;
+    for (;;) {
+        const GLenum res = glClientWaitSync(fence, flags, FP_WAIT_TIMEOUT_NS);
+        if (res == GL_ALREADY_SIGNALED || res == GL_CONDITION_SATISFIED) {
+            break;
+        }
+        if (res == GL_WAIT_FAILED) {
+            FP_LOG(GWR_LOG_ERROR, "glClientWaitSync failed");
+            break;
+        }
+        FP_LOG(GWR_LOG_WARNING, "GPU is more than a second behind");
+        flags = 0;
+    }
+
+    return (double) (GWR_now_ns() - before) / 1e6;
+}
+
+static void record_frame(GWR_frame_pacer_t *pacer, double ms) {
+    int bucket = (int) (ms / GWR_FRAME_PACER_HISTOGRAM_BUCKET_MS);
+    if (bucket >= GWR_FRAME_PACER_HISTOGRAM_BUCKETS) {
+        bucket = GWR_FRAME_PACER_HISTOGRAM_BUCKETS - 1;
+    }
+    ++pacer->histogram[bucket];
+
+    pacer->min_ms = pacer->frames == 0 || ms < pacer->min_ms ? ms : pacer->min_ms;
+    pacer->max_ms = ms > pacer->max_ms ? ms : pacer->max_ms;
+    pacer->last_ms = ms;
+    pacer->sum_ms += ms;
+    ++pacer->frames;
+}
@@ -0,0 +1,798 @@
+#include "internal/gwr_framebuffer.h"
+#include "internal/gwr_log.h"
+#include "internal/gwr_cap.h"
+#include "internal/gwr_util.h"
+#include "internal/gwr_memory.h"
+#include "internal/gwr_debug.h"
+
+#include "GLFW/glfw3.h"
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <assert.h>
+
+#define FB_LOG(level, msg, ...)    GWR_LOG_AT(GWR_LOG_SYS_FRAMEBUFFER, (level), msg, ##__VA_ARGS__)
+
+struct GWR_framebuffer_t {
+    GLuint id;
+    GWR_framebuffer_desc_t desc;
+    GLsizei color_count;
+    GWR_texture_t *colors[GWR_FRAMEBUFFER_MAX_COLOR_ATTACHMENTS];
+    GLuint color_rbs[GWR_FRAMEBUFFER_MAX_COLOR_ATTACHMENTS];
+    GWR_texture_t *depth;
+    GLuint depth_rb;
+    bool has_depth;
+    bool has_stencil;
+    bool owns_attachments;
+    int64_t mem_size;               // owned attachments
+    GWR_mem_tag_t rb_mem_tag;
+    int64_t rb_mem_size;            // renderbuffers only; textures account for themselves
+};
+
+typedef GLuint (*fb_create)(void);
+typedef void (*fb_attach)(GLuint, GLenum, GLuint, GLuint);
+typedef void (*fb_set_draw_buffers)(GLuint, GLsizei, const GLenum *);
+typedef GLenum (*fb_check_status)(GLuint);
+typedef GLuint (*fb_create_renderbuffer)(GLenum, GLsizei, GLsizei, GLsizei);
+typedef void (*fb_blit)(GLuint, GLuint, GLenum, GLenum, const GLint *, const GLint *, GLbitfield, GLenum);
+typedef void (*fb_set_read_buffer)(GLuint, GLenum);
+typedef void (*fb_clear)(GLuint, GLenum, GLint, const GLfloat *, GLfloat, GLint);
+typedef void (*fb_invalidate)(GLuint, GLsizei, const GLenum *);
+
+static fb_create s_fb_create = NULL;
+static fb_attach s_fb_attach = NULL;
+static fb_set_draw_buffers s_fb_set_draw_buffers = NULL;
+static fb_check_status s_fb_check_status = NULL;
+static fb_create_renderbuffer s_fb_create_renderbuffer = NULL;
+static fb_blit s_fb_blit = NULL;
+static fb_set_read_buffer s_fb_set_read_buffer = NULL;
+static fb_clear s_fb_clear = NULL;
+static fb_invalidate s_fb_invalidate = NULL;
+
+// inner funcs decls
+
+static GWR_framebuffer_t *fb_alloc(void);
+static bool fb_finish(GWR_framebuffer_t *fb);
+static void fb_release_attachments(GWR_framebuffer_t *fb);
+
+static bool is_depth_stencil_format(GLenum format);
+static void get_size(const GWR_framebuffer_t *fb, GLsizei *w, GLsizei *h);
+static GLenum get_read_buffer(GLuint fbo);
+static void account_attachments(GWR_framebuffer_t *fb);
+static void label_framebuffer(const GWR_framebuffer_t *fb);
+
+static GLuint backend_create_dsa(void);
+static void backend_attach_dsa(GLuint fbo, GLenum attachment, GLuint texture, GLuint renderbuffer);
+static void backend_set_draw_buffers_dsa(GLuint fbo, GLsizei n, const GLenum *bufs);
+static GLenum backend_check_status_dsa(GLuint fbo);
+static GLuint backend_create_renderbuffer_dsa(GLenum format, GLsizei samples, GLsizei w, GLsizei h);
+static void backend_blit_dsa(GLuint src, GLuint dst, GLenum read_buf, GLenum draw_buf,
+                             const GLint *src_rect, const GLint *dst_rect, GLbitfield mask, GLenum filter);
+static void backend_set_read_buffer_dsa(GLuint fbo, GLenum buf);
+static void backend_clear_dsa(GLuint fbo, GLenum buffer, GLint drawbuffer, const GLfloat *color, GLfloat depth, GLint stencil);
+static void backend_invalidate_dsa(GLuint fbo, GLsizei n, const GLenum *attachments);
+
+static GLuint backend_create_bind(void);
+static void backend_attach_bind(GLuint fbo, GLenum attachment, GLuint texture, GLuint renderbuffer);
+static void backend_set_draw_buffers_bind(GLuint fbo, GLsizei n, const GLenum *bufs);
+static GLenum backend_check_status_bind(GLuint fbo);
+static GLuint backend_create_renderbuffer_bind(GLenum format, GLsizei samples, GLsizei w, GLsizei h);
+static void backend_blit_bind(GLuint src, GLuint dst, GLenum read_buf, GLenum draw_buf,
+                              const GLint *src_rect, const GLint *dst_rect, GLbitfield mask, GLenum filter);
+static void backend_set_read_buffer_bind(GLuint fbo, GLenum buf);
+static void backend_clear_bind(GLuint fbo, GLenum buffer, GLint drawbuffer, const GLfloat *color, GLfloat depth, GLint stencil);
+static void backend_invalidate_bind(GLuint fbo, GLsizei n, const GLenum *attachments);
+
+static void fb_pick_backend(void);
+
+// public funcs defs
+
+GWR_framebuffer_t *GWR_framebuffer_create(const GWR_framebuffer_desc_t *desc) {
+    assert(desc);
+    assert(desc->width > 0 && desc->height > 0);
+
+    fb_pick_backend();
+
+    GWR_framebuffer_t *fb = fb_alloc();
+    if (!fb) {
+        return NULL;
+    }
+    fb->desc = *desc;
+    fb->desc.samples = desc->samples > 1 ? desc->samples : 1;
+    fb->owns_attachments = true;
+
+    const GLsizei w = desc->width;
+    const GLsizei h = desc->height;
+    const GLsizei samples = fb->desc.samples;
+
+    const int64_t max_samples = GWR_cap_get_limit(GWR_LIMIT_MAX_SAMPLES);
+    if (max_samples > 0 && samples > max_samples) {
+        FB_LOG(GWR_LOG_ERROR, "%d samples exceed GL_MAX_SAMPLES (%lld)", samples, (long long) max_samples);
+        GWR_framebuffer_destroy(fb);
+        return NULL;
+    }
+
+    for (GLsizei i = 0; i < GWR_FRAMEBUFFER_MAX_COLOR_ATTACHMENTS && desc->color_formats[i]; ++i) {
+        const GLenum attachment = GL_COLOR_ATTACHMENT0 + (GLenum) i;
+        if (desc->color_renderbuffer) {
+            fb->color_rbs[i] = s_fb_create_renderbuffer(desc->color_formats[i], samples, w, h);
+            if (!fb->color_rbs[i]) {
+                GWR_framebuffer_destroy(fb);
+                return NULL;
+            }
+            s_fb_attach(fb->id, attachment, 0, fb->color_rbs[i]);
+        } else {
+            fb->colors[i] = GWR_texture_create(desc->color_formats[i], w, h, 1, samples);
+            if (!fb->colors[i]) {
+                GWR_framebuffer_destroy(fb);
+                return NULL;
+            }
+            s_fb_attach(fb->id, attachment, GWR_texture_get_id(fb->colors[i]), 0);
+        }
+        fb->color_count = i + 1;
+    }
+
+    if (desc->depth_format) {
+        fb->has_depth = true;
+        fb->has_stencil = is_depth_stencil_format(desc->depth_format);
+        const GLenum attachment = fb->has_stencil ? GL_DEPTH_STENCIL_ATTACHMENT : GL_DEPTH_ATTACHMENT;
+        if (desc->depth_renderbuffer) {
+            fb->depth_rb = s_fb_create_renderbuffer(desc->depth_format, samples, w, h);
+            if (!fb->depth_rb) {
+                GWR_framebuffer_destroy(fb);
+                return NULL;
+            }
+            s_fb_attach(fb->id, attachment, 0, fb->depth_rb);
+        } else {
+            fb->depth = GWR_texture_create(desc->depth_format, w, h, 1, samples);
+            if (!fb->depth) {
+                GWR_framebuffer_destroy(fb);
+                return NULL;
+            }
+            s_fb_attach(fb->id, attachment, GWR_texture_get_id(fb->depth), 0);
+        }
+    }
+
+    if (!fb_finish(fb)) {
+        GWR_framebuffer_destroy(fb);
+        return NULL;
+    }
+
+    account_attachments(fb);
+    label_framebuffer(fb);
+
+    return fb;
+}
+
+GWR_framebuffer_t *GWR_framebuffer_create_from(GWR_texture_t *const *colors, GLsizei color_count, GWR_texture_t *depth) {
+    assert(color_count >= 0 && color_count <= GWR_FRAMEBUFFER_MAX_COLOR_ATTACHMENTS);
+    assert(color_count == 0 || colors);
+    assert(color_count > 0 || depth);
+
+    fb_pick_backend();
+
+    GWR_framebuffer_t *fb = fb_alloc();
+    if (!fb) {
+        return NULL;
+    }
+    fb->owns_attachments = false;
+
+    const GWR_texture_t *first = color_count > 0 ? colors[0] : depth;
+    fb->desc.width = GWR_texture_get_width(first);
+    fb->desc.height = GWR_texture_get_height(first);
+    fb->desc.samples = GWR_texture_get_samples(first);
+
+    for (GLsizei i = 0; i < color_count; ++i) {
+        assert(colors[i]);
+        if (GWR_texture_get_width(colors[i]) != fb->desc.width ||
+            GWR_texture_get_height(colors[i]) != fb->desc.height) {
+            FB_LOG(GWR_LOG_ERROR, "color attachment %d size mismatch", i);
+            GWR_framebuffer_destroy(fb);
+            return NULL;
+        }
+        fb->colors[i] = colors[i];
+        fb->desc.color_formats[i] = GWR_texture_get_format(colors[i]);
+        s_fb_attach(fb->id, GL_COLOR_ATTACHMENT0 + (GLenum) i, GWR_texture_get_id(colors[i]), 0);
+    }
+    fb->color_count = color_count;
+
+    if (depth) {
+        fb->depth = depth;
+        fb->has_depth = true;
+        fb->desc.depth_format = GWR_texture_get_format(depth);
+        fb->has_stencil = is_depth_stencil_format(fb->desc.depth_format);
+        s_fb_attach(
+            fb->id, fb->has_stencil ? GL_DEPTH_STENCIL_ATTACHMENT : GL_DEPTH_ATTACHMENT,
+            GWR_texture_get_id(depth), 0
+        );
+    }
+
+    if (!fb_finish(fb)) {
+        GWR_framebuffer_destroy(fb);
+        return NULL;
+    }
+
+    label_framebuffer(fb);
+
+    return fb;
+}
+
+void GWR_framebuffer_destroy(GWR_framebuffer_t *fb) {
+    assert(fb);
+
+    if (fb->id) {
+        glDeleteFramebuffers(1, &fb->id);
+        fb->id = 0;
+    }
+
+    if (fb->owns_attachments) {
+        fb_release_attachments(fb);
+    }
+
+    if (fb->rb_mem_size > 0) {
+        GWR_mem_record_free(GWR_MEM_RENDER_TARGET, fb->rb_mem_tag, fb->rb_mem_size);
+    }
+
+    free(fb);
+}
+
+void GWR_framebuffer_bind(const GWR_framebuffer_t *fb) {
+    GLsizei w = 0, h = 0;
+    get_size(fb, &w, &h);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, fb ? fb->id : 0);
+    glViewport(0, 0, w, h);
+}
+
+void GWR_framebuffer_clear(GWR_framebuffer_t *fb, GLbitfield mask, const float color[4], float depth, GLint stencil) {
+    assert(!(mask & GL_COLOR_BUFFER_BIT) || color);
+
+    fb_pick_backend();
+
+    const GLuint id = fb ? fb->id : 0;
+    const GLsizei color_count = fb ? fb->color_count : 1;
+
+    if (mask & GL_COLOR_BUFFER_BIT) {
+        for (GLsizei i = 0; i < color_count; ++i) {
+            s_fb_clear(id, GL_COLOR, i, color, 0.f, 0);
+        }
+    }
+
+    // the default framebuffer is assumed to have what the caller asks for
+    const bool clear_depth = (mask & GL_DEPTH_BUFFER_BIT) && (!fb || fb->has_depth);
+    const bool clear_stencil = (mask & GL_STENCIL_BUFFER_BIT) && (!fb || fb->has_stencil);
+    if (clear_depth && clear_stencil) {
+        s_fb_clear(id, GL_DEPTH_STENCIL, 0, NULL, depth, stencil);
+    } else if (clear_depth) {
+        s_fb_clear(id, GL_DEPTH, 0, NULL, depth, 0);
+    } else if (clear_stencil) {
+        s_fb_clear(id, GL_STENCIL, 0, NULL, 0.f, stencil);
+    }
+}
+
+void GWR_framebuffer_blit(const GWR_framebuffer_t *src, const GWR_framebuffer_t *dst, GLbitfield mask, GLenum filter) {
+    assert(src || dst);
+
+    fb_pick_backend();
+
+    GLint src_rect[4] = {0, 0, 0, 0};
+    GLint dst_rect[4] = {0, 0, 0, 0};
+    get_size(src, &src_rect[2], &src_rect[3]);
+    get_size(dst, &dst_rect[2], &dst_rect[3]);
+
+    const GLuint src_id = src ? src->id : 0;
+    const GLuint dst_id = dst ? dst->id : 0;
+
+    if (mask & GL_COLOR_BUFFER_BIT) {
+        // a blit reads one buffer; MRT attachments are copied pairwise
+        const GLsizei src_count = src ? src->color_count : 1;
+        const GLsizei dst_count = dst ? dst->color_count : 1;
+        const GLsizei count = src_count < dst_count ? src_count : dst_count;
+        const GLenum prev_read_buf = get_read_buffer(src_id);
+
+        for (GLsizei i = 0; i < count; ++i) {
+            const GLenum read_buf = src ? GL_COLOR_ATTACHMENT0 + (GLenum) i : GL_BACK;
+            const GLenum draw_buf = dst ? GL_COLOR_ATTACHMENT0 + (GLenum) i : GL_BACK;
+            s_fb_blit(src_id, dst_id, read_buf, draw_buf, src_rect, dst_rect, GL_COLOR_BUFFER_BIT, filter);
+        }
+
+        // restore the read buffer and draw buffer set changed above
+        s_fb_set_read_buffer(src_id, prev_read_buf);
+        if (dst && dst->color_count > 1) {
+            GLenum bufs[GWR_FRAMEBUFFER_MAX_COLOR_ATTACHMENTS];
+            for (GLsizei i = 0; i < dst->color_count; ++i) {
+                bufs[i] = GL_COLOR_ATTACHMENT0 + (GLenum) i;
+            }
+            s_fb_set_draw_buffers(dst->id, dst->color_count, bufs);
+        }
+    }
+
+    const GLbitfield ds_mask = mask & (GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
+    if (ds_mask) {
+        // depth/stencil blits must use GL_NEAREST
+        s_fb_blit(src_id, dst_id, GL_NONE, GL_NONE, src_rect, dst_rect, ds_mask, GL_NEAREST);
+    }
+}
+
+void GWR_framebuffer_resolve(const GWR_framebuffer_t *src, const GWR_framebuffer_t *dst) {
+    assert(src);
+
+    GLbitfield mask = GL_COLOR_BUFFER_BIT;
+    if (src->has_depth && dst && dst->has_depth) {
+        mask |= GL_DEPTH_BUFFER_BIT;
+        if (src->has_stencil && dst->has_stencil) {
+            mask |= GL_STENCIL_BUFFER_BIT;
+        }
+    }
+
+    GWR_framebuffer_blit(src, dst, mask, GL_NEAREST);
+}
+
+void GWR_framebuffer_invalidate(GWR_framebuffer_t *fb, GLbitfield mask) {
+    fb_pick_backend();
+
+    GLenum attachments[GWR_FRAMEBUFFER_MAX_COLOR_ATTACHMENTS + 2];
+    GLsizei n = 0;
+
+    if (mask & GL_COLOR_BUFFER_BIT) {
+        if (fb) {
+            for (GLsizei i = 0; i < fb->color_count; ++i) {
+                attachments[n++] = GL_COLOR_ATTACHMENT0 + (GLenum) i;
+            }
+        } else {
+            attachments[n++] = GL_COLOR;
+        }
+    }
+    if ((mask & GL_DEPTH_BUFFER_BIT) && (!fb || fb->has_depth)) {
+        attachments[n++] = fb ? GL_DEPTH_ATTACHMENT : GL_DEPTH;
+    }
+    if ((mask & GL_STENCIL_BUFFER_BIT) && (!fb || fb->has_stencil)) {
+        attachments[n++] = fb ? GL_STENCIL_ATTACHMENT : GL_STENCIL;
+    }
+
+    if (n) {
+        s_fb_invalidate(fb ? fb->id : 0, n, attachments);
+    }
+}
+
+GLuint GWR_framebuffer_get_id(const GWR_framebuffer_t *fb) {
+    assert(fb);
+
+    return fb->id;
+}
+
+GLsizei GWR_framebuffer_get_width(const GWR_framebuffer_t *fb) {
+    assert(fb);
+
+    return fb->desc.width;
+}
+
+GLsizei GWR_framebuffer_get_height(const GWR_framebuffer_t *fb) {
+    assert(fb);
+
+    return fb->desc.height;
+}
+
+GLsizei GWR_framebuffer_get_samples(const GWR_framebuffer_t *fb) {
+    assert(fb);
+
+    return fb->desc.samples;
+}
+
+GLsizei GWR_framebuffer_get_color_count(const GWR_framebuffer_t *fb) {
+    assert(fb);
+
+    return fb->color_count;
+}
+
+GWR_texture_t *GWR_framebuffer_get_color(const GWR_framebuffer_t *fb, GLsizei index) {
+    assert(fb);
+    assert(index >= 0 && index < fb->color_count);
+
+    return fb->colors[index];
+}
+
+GWR_texture_t *GWR_framebuffer_get_depth(const GWR_framebuffer_t *fb) {
+    assert(fb);
+
+    return fb->depth;
+}
+
+const GWR_framebuffer_desc_t *GWR_framebuffer_get_desc(const GWR_framebuffer_t *fb) {
+    assert(fb);
+
+    return &fb->desc;
+}
+
+GLsizeiptr GWR_framebuffer_get_memory_size(const GWR_framebuffer_t *fb) {
+    assert(fb);
+
+    return (GLsizeiptr) fb->mem_size;
+}
+
+// inner funcs defs
+
+static GWR_framebuffer_t *fb_alloc(void) {
+    GWR_framebuffer_t *fb = calloc(1, sizeof(GWR_framebuffer_t));
+    if (!fb) {
+        FB_LOG(GWR_LOG_ERROR, "failed to allocate GWR_framebuffer_t");
+        return NULL;
+    }
+
+    fb->id = s_fb_create();
+    if (!fb->id) {
+        FB_LOG(GWR_LOG_ERROR, "failed to create framebuffer object");
+        free(fb);
+        return NULL;
+    }
+
+    return fb;
+}
+
+static bool fb_finish(GWR_framebuffer_t *fb) {
+    GLenum bufs[GWR_FRAMEBUFFER_MAX_COLOR_ATTACHMENTS];
+    for (GLsizei i = 0; i < fb->color_count; ++i) {
+        bufs[i] = GL_COLOR_ATTACHMENT0 + (GLenum) i;
+    }
+    // depth-only targets draw to no color buffer
+    s_fb_set_draw_buffers(fb->id, fb->color_count, bufs);
+
+    const GLenum status = s_fb_check_status(fb->id);
+    if (status != GL_FRAMEBUFFER_COMPLETE) {
+        FB_LOG(GWR_LOG_ERROR, "framebuffer incomplete: 0x%04X", status);
+        return false;
+    }
+    return true;
+}
+
+static void fb_release_attachments(GWR_framebuffer_t *fb) {
+    for (GLsizei i = 0; i < GWR_FRAMEBUFFER_MAX_COLOR_ATTACHMENTS; ++i) {
+        if (fb->colors[i]) {
+            GWR_texture_destroy(fb->colors[i]);
+            fb->colors[i] = NULL;
+        }
+        if (fb->color_rbs[i]) {
+            glDeleteRenderbuffers(1, &fb->color_rbs[i]);
+            fb->color_rbs[i] = 0;
+        }
+    }
+    if (fb->depth) {
+        GWR_texture_destroy(fb->depth);
+        fb->depth = NULL;
+    }
+    if (fb->depth_rb) {
+        glDeleteRenderbuffers(1, &fb->depth_rb);
+        fb->depth_rb = 0;
+    }
+}
+
+static bool is_depth_stencil_format(GLenum format) {
+    return format == GL_DEPTH24_STENCIL8 || format == GL_DEPTH32F_STENCIL8;
+}
+
+static void get_size(const GWR_framebuffer_t *fb, GLsizei *w, GLsizei *h) {
+    if (fb) {
+        *w = fb->desc.width;
+        *h = fb->desc.height;
+        return;
+    }
+
+    int fw = 0, fh = 0;
+    GLFWwindow *current = glfwGetCurrentContext();
+    if (current) {
+        glfwGetFramebufferSize(current, &fw, &fh);
+    }
+    *w = fw;
+    *h = fh;
+}
+
+static GLenum get_read_buffer(GLuint fbo) {
+    // GL_READ_BUFFER is only queryable for the bound read framebuffer
+    GLint prev = 0, buf = GL_NONE;
+    glGetIntegerv(GL_READ_FRAMEBUFFER_BINDING, &prev);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, fbo);
+    glGetIntegerv(GL_READ_BUFFER, &buf);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, (GLuint) prev);
+
+    return (GLenum) buf;
+}
+
+static void account_attachments(GWR_framebuffer_t *fb) {
+    // one size per attachment, shared by get_memory_size and the renderbuffer accounting
+    const GWR_framebuffer_desc_t *d = &fb->desc;
+    for (GLsizei i = 0; i < fb->color_count; ++i) {
+        const int64_t size = GWR_mem_texture_size(d->color_formats[i], d->width, d->height, 1, 1, d->samples);
+        fb->mem_size += size;
+        if (fb->color_rbs[i]) {
+            fb->rb_mem_size += size;
+        }
+    }
+    if (fb->has_depth) {
+        const int64_t size = GWR_mem_texture_size(d->depth_format, d->width, d->height, 1, 1, d->samples);
+        fb->mem_size += size;
+        if (fb->depth_rb) {
+            fb->rb_mem_size += size;
+        }
+    }
+    if (fb->rb_mem_size > 0) {
+        fb->rb_mem_tag = GWR_mem_record_alloc(GWR_MEM_RENDER_TARGET, fb->rb_mem_size);
+    }
+}
+
+static void label_framebuffer(const GWR_framebuffer_t *fb) {
+    const GWR_framebuffer_desc_t *d = &fb->desc;
+    GWR_debug_label(GL_FRAMEBUFFER, fb->id, "framebuffer %dx%d", d->width, d->height);
+    if (!fb->owns_attachments) {
+        // borrowed textures keep whatever their creator called them
+        return;
+    }
+
+    for (GLsizei i = 0; i < fb->color_count; ++i) {
+        if (fb->color_rbs[i]) {
+            GWR_debug_label(GL_RENDERBUFFER, fb->color_rbs[i], "framebuffer %u color %d", fb->id, i);
+        } else {
+            GWR_debug_label(GL_TEXTURE, GWR_texture_get_id(fb->colors[i]), "framebuffer %u color %d", fb->id, i);
+        }
+    }
+    if (fb->depth_rb) {
+        GWR_debug_label(GL_RENDERBUFFER, fb->depth_rb, "framebuffer %u depth", fb->id);
+    } else if (fb->depth) {
+        GWR_debug_label(GL_TEXTURE, GWR_texture_get_id(fb->depth), "framebuffer %u depth", fb->id);
+    }
+}
+
+static GLuint backend_create_dsa(void) {
+    GLuint id = 0;
+    glCreateFramebuffers(1, &id);
+    return id;
+}
+
+static void backend_attach_dsa(GLuint fbo, GLenum attachment, GLuint texture, GLuint renderbuffer) {
+    if (renderbuffer) {
+        glNamedFramebufferRenderbuffer(fbo, attachment, GL_RENDERBUFFER, renderbuffer);
+    } else {
+        glNamedFramebufferTexture(fbo, attachment, texture, 0);
+    }
+}
+
+static void backend_set_draw_buffers_dsa(GLuint fbo, GLsizei n, const GLenum *bufs) {
+    if (n) {
+        glNamedFramebufferDrawBuffers(fbo, n, bufs);
+        glNamedFramebufferReadBuffer(fbo, GL_COLOR_ATTACHMENT0);
+    } else {
+        glNamedFramebufferDrawBuffer(fbo, GL_NONE);
+        glNamedFramebufferReadBuffer(fbo, GL_NONE);
+    }
+}
+
+static GLenum backend_check_status_dsa(GLuint fbo) {
+    return glCheckNamedFramebufferStatus(fbo, GL_FRAMEBUFFER);
+}
+
+static GLuint backend_create_renderbuffer_dsa(GLenum format, GLsizei samples, GLsizei w, GLsizei h) {
+    GLuint id = 0;
+    glCreateRenderbuffers(1, &id);
+    if (!id) {
+        FB_LOG(GWR_LOG_ERROR, "glCreateRenderbuffers returned 0");
+        return 0;
+    }
+    glNamedRenderbufferStorageMultisample(id, samples > 1 ? samples : 0, format, w, h);
+    return id;
+}
+
+static void backend_blit_dsa(GLuint src, GLuint dst, GLenum read_buf, GLenum draw_buf,
+                             const GLint *src_rect, const GLint *dst_rect, GLbitfield mask, GLenum filter) {
+    if (read_buf != GL_NONE) {
+        glNamedFramebufferReadBuffer(src, read_buf);
+    }
+    if (draw_buf != GL_NONE) {
+        glNamedFramebufferDrawBuffer(dst, draw_buf);
+    }
+
+    glBlitNamedFramebuffer(
+        src, dst,
+        src_rect[0], src_rect[1], src_rect[2], src_rect[3],
+        dst_rect[0], dst_rect[1], dst_rect[2], dst_rect[3],
+        mask, filter
+    );
+}
+
+static void backend_set_read_buffer_dsa(GLuint fbo, GLenum buf) {
+    glNamedFramebufferReadBuffer(fbo, buf);
+}
+
+static void backend_clear_dsa(GLuint fbo, GLenum buffer, GLint drawbuffer, const GLfloat *color, GLfloat depth, GLint stencil) {
+    switch (buffer) {
+        case GL_COLOR:
+            glClearNamedFramebufferfv(fbo, GL_COLOR, drawbuffer, color);
+            break;
+        case GL_DEPTH:
+            glClearNamedFramebufferfv(fbo, GL_DEPTH, 0, &depth);
+            break;
+        case GL_STENCIL:
+            glClearNamedFramebufferiv(fbo, GL_STENCIL, 0, &stencil);
+            break;
+        case GL_DEPTH_STENCIL:
+            glClearNamedFramebufferfi(fbo, GL_DEPTH_STENCIL, 0, depth, stencil);
+            break;
+        default:
+            GWR_UNREACHABLE();
+    }
+}
+
+static void backend_invalidate_dsa(GLuint fbo, GLsizei n, const GLenum *attachments) {
+    glInvalidateNamedFramebufferData(fbo, n, attachments);
+}
+
+static GLuint backend_create_bind(void) {
+    GLuint id = 0;
+    glGenFramebuffers(1, &id);
+    if (!id) {
+        return 0;
+    }
+
+    // the object only exists after its first bind
+    GLint prev = 0;
+    glGetIntegerv(GL_FRAMEBUFFER_BINDING, &prev);
+    glBindFramebuffer(GL_FRAMEBUFFER, id);
+    glBindFramebuffer(GL_FRAMEBUFFER, (GLuint) prev);
+
+    return id;
+}
+
+static void backend_attach_bind(GLuint fbo, GLenum attachment, GLuint texture, GLuint renderbuffer) {
+    GLint prev = 0;
+    glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &prev);
+
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, fbo);
+    if (renderbuffer) {
+        glFramebufferRenderbuffer(GL_DRAW_FRAMEBUFFER, attachment, GL_RENDERBUFFER, renderbuffer);
+    } else {
+        glFramebufferTexture(GL_DRAW_FRAMEBUFFER, attachment, texture, 0);
+    }
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, (GLuint) prev);
+}
+
+static void backend_set_draw_buffers_bind(GLuint fbo, GLsizei n, const GLenum *bufs) {
+    GLint prev_draw = 0, prev_read = 0;
+    glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &prev_draw);
+    glGetIntegerv(GL_READ_FRAMEBUFFER_BINDING, &prev_read);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+    if (n) {
+        glDrawBuffers(n, bufs);
+        glReadBuffer(GL_COLOR_ATTACHMENT0);
+    } else {
+        glDrawBuffer(GL_NONE);
+        glReadBuffer(GL_NONE);
+    }
+
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, (GLuint) prev_draw);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, (GLuint) prev_read);
+}
+
+static GLenum backend_check_status_bind(GLuint fbo) {
+    GLint prev = 0;
+    glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &prev);
+
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, fbo);
+    const GLenum status = glCheckFramebufferStatus(GL_DRAW_FRAMEBUFFER);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, (GLuint) prev);
+
+    return status;
+}
+
+static GLuint backend_create_renderbuffer_bind(GLenum format, GLsizei samples, GLsizei w, GLsizei h) {
+    GLuint id = 0;
+    glGenRenderbuffers(1, &id);
+    if (!id) {
+        FB_LOG(GWR_LOG_ERROR, "glGenRenderbuffers failed");
+        return 0;
+    }
+
+    GLint prev = 0;
+    glGetIntegerv(GL_RENDERBUFFER_BINDING, &prev);
+
+    glBindRenderbuffer(GL_RENDERBUFFER, id);
+    glRenderbufferStorageMultisample(GL_RENDERBUFFER, samples > 1 ? samples : 0, format, w, h);
+    glBindRenderbuffer(GL_RENDERBUFFER, (GLuint) prev);
+
+    return id;
+}
+
+static void backend_blit_bind(GLuint src, GLuint dst, GLenum read_buf, GLenum draw_buf,
+                              const GLint *src_rect, const GLint *dst_rect, GLbitfield mask, GLenum filter) {
+    GLint prev_draw = 0, prev_read = 0;
+    glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &prev_draw);
+    glGetIntegerv(GL_READ_FRAMEBUFFER_BINDING, &prev_read);
+
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, src);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, dst);
+    if (read_buf != GL_NONE) {
+        glReadBuffer(read_buf);
+    }
+    if (draw_buf != GL_NONE) {
+        glDrawBuffer(draw_buf);
+    }
+
+    glBlitFramebuffer(
+        src_rect[0], src_rect[1], src_rect[2], src_rect[3],
+        dst_rect[0], dst_rect[1], dst_rect[2], dst_rect[3],
+        mask, filter
+    );
+
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, (GLuint) prev_draw);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, (GLuint) prev_read);
+}
+
+static void backend_set_read_buffer_bind(GLuint fbo, GLenum buf) {
+    GLint prev = 0;
+    glGetIntegerv(GL_READ_FRAMEBUFFER_BINDING, &prev);
+
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, fbo);
+    glReadBuffer(buf);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, (GLuint) prev);
+}
+
+static void backend_clear_bind(GLuint fbo, GLenum buffer, GLint drawbuffer, const GLfloat *color, GLfloat depth, GLint stencil) {
+    GLint prev = 0;
+    glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &prev);
+
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, fbo);
+    switch (buffer) {
+        case GL_COLOR:
+            glClearBufferfv(GL_COLOR, drawbuffer, color);
+            break;
+        case GL_DEPTH:
+            glClearBufferfv(GL_DEPTH, 0, &depth);
+            break;
+        case GL_STENCIL:
+            glClearBufferiv(GL_STENCIL, 0, &stencil);
+            break;
+        case GL_DEPTH_STENCIL:
+            glClearBufferfi(GL_DEPTH_STENCIL, 0, depth, stencil);
+            break;
+        default:
+            GWR_UNREACHABLE();
+    }
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, (GLuint) prev);
+}
+
+static void backend_invalidate_bind(GLuint fbo, GLsizei n, const GLenum *attachments) {
+    if (!GWR_cap_has(GWR_FEATURE_INVALIDATE_SUBDATA)) {
+        // purely a hint; nothing to fall back to
+        return;
+    }
+
+    GLint prev = 0;
+    glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &prev);
+
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, fbo);
+    glInvalidateFramebuffer(GL_DRAW_FRAMEBUFFER, n, attachments);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, (GLuint) prev);
+}
+
+static void fb_pick_backend(void) {
+    if (s_fb_create && s_fb_attach && s_fb_set_draw_buffers && s_fb_check_status &&
+        s_fb_create_renderbuffer && s_fb_blit && s_fb_set_read_buffer && s_fb_clear && s_fb_invalidate) {
+        return;
+    }
+
+    if (!GWR_cap_is_init()) {
+        FB_LOG(GWR_LOG_ERROR, "cap not initialized; call GWR_cap_init() first");
+        return;
+    }
+
+    const bool has_dsa = GWR_cap_has(GWR_FEATURE_DIRECT_STATE_ACCESS);
+
+    s_fb_create = has_dsa ? backend_create_dsa : backend_create_bind;
+    s_fb_attach = has_dsa ? backend_attach_dsa : backend_attach_bind;
+    s_fb_set_draw_buffers = has_dsa ? backend_set_draw_buffers_dsa : backend_set_draw_buffers_bind;
+    s_fb_check_status = has_dsa ? backend_check_status_dsa : backend_check_status_bind;
+    s_fb_create_renderbuffer = has_dsa ? backend_create_renderbuffer_dsa : backend_create_renderbuffer_bind;
+    s_fb_blit = has_dsa ? backend_blit_dsa : backend_blit_bind;
+    s_fb_set_read_buffer = has_dsa ? backend_set_read_buffer_dsa : backend_set_read_buffer_bind;
+    s_fb_clear = has_dsa ? backend_clear_dsa : backend_clear_bind;
+    s_fb_invalidate = has_dsa ? backend_invalidate_dsa : backend_invalidate_bind;
+}
@@ -0,0 +1,221 @@
+#include "internal/gwr_framebuffer_pool.h"
+#include "internal/gwr_log.h"
+#include "internal/gwr_util.h"
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <assert.h>
+
+#define FB_POOL_LOG(level, msg, ...)    GWR_LOG_AT(GWR_LOG_SYS_FRAMEBUFFER_POOL, (level), msg, ##__VA_ARGS__)
+
+#define FB_POOL_INITIAL_CAPACITY 16
+
+typedef struct {
+    GWR_framebuffer_t *fb;
+    GWR_framebuffer_desc_t desc;
+    uint64_t hash;
+    uint64_t last_used;
+    bool in_use;
+} fb_pool_entry_t;
+
+struct GWR_framebuffer_pool_t {
+    fb_pool_entry_t *entries;
+    size_t count;
+    size_t capacity;
+    uint64_t frame;
+    uint32_t max_idle_frames;
+    GWR_framebuffer_pool_stats_t stats;
+};
+
+// inner funcs decls
+
+static GWR_framebuffer_desc_t normalize_desc(const GWR_framebuffer_desc_t *desc);
+static uint64_t hash_desc(const GWR_framebuffer_desc_t *desc);
+static bool desc_equal(const GWR_framebuffer_desc_t *a, const GWR_framebuffer_desc_t *b);
+static void remove_entry(GWR_framebuffer_pool_t *pool, size_t idx);
+
+// public funcs defs
+
+GWR_framebuffer_pool_t *GWR_framebuffer_pool_create(uint32_t max_idle_frames) {
+    GWR_framebuffer_pool_t *pool = calloc(1, sizeof(GWR_framebuffer_pool_t));
+    if (!pool) {
+        FB_POOL_LOG(GWR_LOG_ERROR, "failed to allocate GWR_framebuffer_pool_t");
+        return NULL;
+    }
+
+    pool->entries = malloc(FB_POOL_INITIAL_CAPACITY * sizeof(fb_pool_entry_t));
+    if (!pool->entries) {
+        FB_POOL_LOG(GWR_LOG_ERROR, "failed to allocate entries");
+        free(pool);
+        return NULL;
+    }
+    pool->capacity = FB_POOL_INITIAL_CAPACITY;
+    pool->max_idle_frames = max_idle_frames ? max_idle_frames : GWR_FRAMEBUFFER_POOL_DEFAULT_MAX_IDLE_FRAMES;
+
+    return pool;
+}
+
+void GWR_framebuffer_pool_destroy(GWR_framebuffer_pool_t *pool) {
+    assert(pool);
+
+    for (size_t i = 0; i < pool->count; ++i) {
+        GWR_framebuffer_destroy(pool->entries[i].fb);
+    }
+    free(pool->entries);
+    free(pool);
+}
+
+GWR_framebuffer_t *GWR_framebuffer_pool_acquire(GWR_framebuffer_pool_t *pool, const GWR_framebuffer_desc_t *desc) {
+    assert(pool);
+    assert(desc);
+
+    const GWR_framebuffer_desc_t key = normalize_desc(desc);
+    const uint64_t hash = hash_desc(&key);
+
+    for (size_t i = 0; i < pool->count; ++i) {
+        fb_pool_entry_t *e = &pool->entries[i];
+        if (!e->in_use && e->hash == hash && desc_equal(&e->desc, &key)) {
+            e->in_use = true;
+            e->last_used = pool->frame;
+            ++pool->stats.hits;
+            ++pool->stats.in_use;
+            return e->fb;
+        }
+    }
+
+    if (pool->count == pool->capacity) {
+        const size_t new_capacity = pool->capacity * 2;
+        fb_pool_entry_t *entries = realloc(pool->entries, new_capacity * sizeof(fb_pool_entry_t));
+        if (!entries) {
+            FB_POOL_LOG(GWR_LOG_ERROR, "failed to grow to %zu entries", new_capacity);
+            return NULL;
+        }
+        pool->entries = entries;
+        pool->capacity = new_capacity;
+    }
+
+    GWR_framebuffer_t *fb = GWR_framebuffer_create(&key);
+    if (!fb) {
+        return NULL;
+    }
+
+    fb_pool_entry_t *e = &pool->entries[pool->count++];
+    e->fb = fb;
+    e->desc = key;
+    e->hash = hash;
+    e->last_used = pool->frame;
+    e->in_use = true;
+
+    ++pool->stats.misses;
+    ++pool->stats.in_use;
+    ++pool->stats.live;
+    pool->stats.memory_size += GWR_framebuffer_get_memory_size(fb);
+
+    return fb;
+}
+
+void GWR_framebuffer_pool_release(GWR_framebuffer_pool_t *pool, GWR_framebuffer_t *fb) {
+    assert(pool);
+    assert(fb);
+
+    for (size_t i = 0; i < pool->count; ++i) {
+        fb_pool_entry_t *e = &pool->entries[i];
+        if (e->fb == fb) {
+            assert(e->in_use);
+            e->in_use = false;
+            e->last_used = pool->frame;
+            --pool->stats.in_use;
+            return;
+        }
+    }
+
+    FB_POOL_LOG(GWR_LOG_WARNING, "released framebuffer %u does not belong to the pool", GWR_framebuffer_get_id(fb));
+}
+
+void GWR_framebuffer_pool_end_frame(GWR_framebuffer_pool_t *pool) {
+    assert(pool);
+
+    for (size_t i = 0; i < pool->count;) {
+        const fb_pool_entry_t *e = &pool->entries[i];
+        if (!e->in_use && pool->frame - e->last_used >= pool->max_idle_frames) {
+            remove_entry(pool, i);
+        } else {
+            ++i;
+        }
+    }
+
+    ++pool->frame;
+}
+
+void GWR_framebuffer_pool_trim(GWR_framebuffer_pool_t *pool) {
+    assert(pool);
+
+    for (size_t i = 0; i < pool->count;) {
+        if (!pool->entries[i].in_use) {
+            remove_entry(pool, i);
+        } else {
+            ++i;
+        }
+    }
+}
+
+GWR_framebuffer_pool_stats_t GWR_framebuffer_pool_get_stats(const GWR_framebuffer_pool_t *pool) {
+    assert(pool);
+
+    return pool->stats;
+}
+
+// inner funcs defs
+
+static GWR_framebuffer_desc_t normalize_desc(const GWR_framebuffer_desc_t *desc) {
+    // canonical copy: nothing after the first empty color slot
+    GWR_framebuffer_desc_t key;
+    memset(&key, 0, sizeof(key));
+
+    key.width = desc->width;
+    key.height = desc->height;
+    key.samples = desc->samples > 1 ? desc->samples : 1;
+    for (int i = 0; i < GWR_FRAMEBUFFER_MAX_COLOR_ATTACHMENTS && desc->color_formats[i]; ++i) {
+        key.color_formats[i] = desc->color_formats[i];
+    }
+    key.depth_format = desc->depth_format;
+    key.color_renderbuffer = desc->color_renderbuffer;
+    key.depth_renderbuffer = desc->depth_format ? desc->depth_renderbuffer : false;
+
+    return key;
+}
+
+static uint64_t hash_desc(const GWR_framebuffer_desc_t *desc) {
+    // FNV-1a over the fields
+    const uint64_t words[] = {
+        (uint64_t) desc->width, (uint64_t) desc->height, (uint64_t) desc->samples, desc->depth_format,
+        (uint64_t) desc->color_renderbuffer << 1 | (uint64_t) desc->depth_renderbuffer,
+    };
+
+    const uint64_t h = GWR_fnv1a(GWR_FNV_OFFSET, words, sizeof(words));
+    return GWR_fnv1a(h, desc->color_formats, sizeof(desc->color_formats));
+}
+
+static bool desc_equal(const GWR_framebuffer_desc_t *a, const GWR_framebuffer_desc_t *b) {
+    // field-wise: struct copies are not guaranteed to preserve padding bytes
+    return a->width == b->width &&
+           a->height == b->height &&
+           a->samples == b->samples &&
+           memcmp(a->color_formats, b->color_formats, sizeof(a->color_formats)) == 0 &&
+           a->depth_format == b->depth_format &&
+           a->color_renderbuffer == b->color_renderbuffer &&
+           a->depth_renderbuffer == b->depth_renderbuffer;
+}
+
+static void remove_entry(GWR_framebuffer_pool_t *pool, size_t idx) {
+    fb_pool_entry_t *e = &pool->entries[idx];
+
+    pool->stats.memory_size -= GWR_framebuffer_get_memory_size(e->fb);
+    --pool->stats.live;
+    ++pool->stats.evictions;
+
+    GWR_framebuffer_destroy(e->fb);
+
+    pool->entries[idx] = pool->entries[--pool->count];
+}
@@ -0,0 +1,472 @@
+#include "internal/gwr_input.h"
+#include "internal/gwr_log.h"
+#include "internal/gwr_util.h"
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdatomic.h>
+#include <assert.h>
+#include <time.h>
+
+#include "GLFW/glfw3.h"
+
+#define INPUT_LOG(level, msg, ...)    GWR_LOG_AT(GWR_LOG_SYS_INPUT, (level), msg, ##__VA_ARGS__)
+
+#define INPUT_MAX_WINDOWS    8
+
+#define INPUT_DOWN        0x1
+#define INPUT_PRESSED     0x2
+#define INPUT_RELEASED    0x4
+
+struct GWR_input_t {
+    GLFWwindow *handle;
+
+    GWR_input_event_t *events;
+    size_t mask;
+    _Atomic size_t head;        // written by the GLFW thread only
+    _Atomic size_t tail;        // written by the consumer only
+    _Atomic uint64_t dropped;
+
+    // window state at create, for GWR_input_snapshot_init()
+    int width;
+    int height;
+    double cursor_x;
+    double cursor_y;
+    bool focused;
+
+    GLFWkeyfun prev_key;
+    GLFWcharfun prev_char;
+    GLFWmousebuttonfun prev_button;
+    GLFWcursorposfun prev_cursor;
+    GLFWscrollfun prev_scroll;
+    GLFWframebuffersizefun prev_resize;
+    GLFWwindowfocusfun prev_focus;
+};
+
+// callbacks only get the GLFWwindow; the user pointer is left to the application
+static GWR_input_t *s_inputs[INPUT_MAX_WINDOWS];
+
+// inner funcs decls
+
+static GWR_input_t *find_input(GLFWwindow *handle);
+static void push(GWR_input_t *input, GWR_input_event_t *ev);
+static void apply_button(uint8_t *state, int action);
+static bool test_bit(const uint8_t *states, int count, int idx, uint8_t bit);
+
+static void key_callback(GLFWwindow *handle, int key, int scancode, int action, int mods);
+static void char_callback(GLFWwindow *handle, unsigned int codepoint);
+static void button_callback(GLFWwindow *handle, int button, int action, int mods);
+static void cursor_callback(GLFWwindow *handle, double x, double y);
+static void scroll_callback(GLFWwindow *handle, double dx, double dy);
+static void resize_callback(GLFWwindow *handle, int width, int height);
+static void focus_callback(GLFWwindow *handle, int focused);
+
+// public funcs defs
+
+GWR_input_t *GWR_input_create(GWR_window_t *window, size_t capacity) {
+    assert(window);
+
+    GLFWwindow *handle = GWR_window_get_handle(window);
+    assert(handle);
+
+    if (find_input(handle)) {
+        INPUT_LOG(GWR_LOG_ERROR, "window already has an input queue");
+        return NULL;
+    }
+
+    int slot = -1;
+    for (int i = 0; i < INPUT_MAX_WINDOWS && slot < 0; ++i) {
+        if (!s_inputs[i]) {
+            slot = i;
+        }
+    }
+    if (slot < 0) {
+        INPUT_LOG(GWR_LOG_ERROR, "too many input queues (max %d)", INPUT_MAX_WINDOWS);
+        return NULL;
+    }
+
+    // stop doubling before cap or its byte size wraps around
+    const size_t want = capacity ? capacity : GWR_INPUT_DEFAULT_CAPACITY;
+    const size_t max_cap = SIZE_MAX / sizeof(GWR_input_event_t);
+    size_t cap = 1;
+    while (cap < want && cap <= max_cap / 2) {
+        cap <<= 1;
+    }
+    if (cap < want) {
+        INPUT_LOG(GWR_LOG_ERROR, "input capacity %zu is too large", capacity);
+        return NULL;
+    }
+
+    GWR_input_t *input = calloc(1, sizeof(GWR_input_t));
+    if (!input) {
+        INPUT_LOG(GWR_LOG_ERROR, "failed to allocate GWR_input_t");
+        return NULL;
+    }
+
+    input->events = malloc(cap * sizeof(GWR_input_event_t));
+    if (!input->events) {
+        INPUT_LOG(GWR_LOG_ERROR, "failed to allocate %zu events", cap);
+        free(input);
+        return NULL;
+    }
+
+    input->handle = handle;
+    input->mask = cap - 1;
+    atomic_init(&input->head, 0);
+    atomic_init(&input->tail, 0);
+    atomic_init(&input->dropped, 0);
+
+    glfwGetFramebufferSize(handle, &input->width, &input->height);
+    glfwGetCursorPos(handle, &input->cursor_x, &input->cursor_y);
+    input->focused = glfwGetWindowAttrib(handle, GLFW_FOCUSED) == GLFW_TRUE;
+
+    s_inputs[slot] = input;
+
+    input->prev_key = glfwSetKeyCallback(handle, key_callback);
+    input->prev_char = glfwSetCharCallback(handle, char_callback);
+    input->prev_button = glfwSetMouseButtonCallback(handle, button_callback);
+    input->prev_cursor = glfwSetCursorPosCallback(handle, cursor_callback);
+    input->prev_scroll = glfwSetScrollCallback(handle, scroll_callback);
+    input->prev_resize = glfwSetFramebufferSizeCallback(handle, resize_callback);
+    input->prev_focus = glfwSetWindowFocusCallback(handle, focus_callback);
+
+    return input;
+}
+
+void GWR_input_destroy(GWR_input_t *input) {
+    assert(input);
+
+    // anything installed after create would be unhooked here and its own
+    // restore would then reinstall our callbacks on a freed queue
+    bool ours = glfwSetKeyCallback(input->handle, input->prev_key) == key_callback;
+    ours &= glfwSetCharCallback(input->handle, input->prev_char) == char_callback;
+    ours &= glfwSetMouseButtonCallback(input->handle, input->prev_button) == button_callback;
+    ours &= glfwSetCursorPosCallback(input->handle, input->prev_cursor) == cursor_callback;
+    ours &= glfwSetScrollCallback(input->handle, input->prev_scroll) == scroll_callback;
+    ours &= glfwSetFramebufferSizeCallback(input->handle, input->prev_resize) == resize_callback;
+    ours &= glfwSetWindowFocusCallback(input->handle, input->prev_focus) == focus_callback;
+    if (!ours) {
+        INPUT_LOG(GWR_LOG_ERROR, "callbacks set after GWR_input_create() were still installed at destroy");
+    }
+    assert(ours);
+
+    for (int i = 0; i < INPUT_MAX_WINDOWS; ++i) {
+        if (s_inputs[i] == input) {
+            s_inputs[i] = NULL;
+        }
+    }
+
+    free(input->events);
+    free(input);
+}
+
+size_t GWR_input_poll(GWR_input_t *input, GWR_input_event_t *events, size_t max) {
+    assert(input);
+    assert(events || !max);
+
+    const size_t tail = atomic_load_explicit(&input->tail, memory_order_relaxed);
+    const size_t head = atomic_load_explicit(&input->head, memory_order_acquire);
+
+    size_t count = head - tail;
+    if (count > max) {
+        count = max;
+    }
+    for (size_t i = 0; i < count; ++i) {
+        events[i] = input->events[(tail + i) & input->mask];
+    }
+
+    atomic_store_explicit(&input->tail, tail + count, memory_order_release);
+
+    return count;
+}
+
+void GWR_input_update(GWR_input_t *input, GWR_input_snapshot_t *snap) {
+    assert(input);
+    assert(snap);
+
+    for (int i = 0; i < GWR_INPUT_MAX_KEYS; ++i) {
+        snap->keys[i] &= INPUT_DOWN;
+    }
+    for (int i = 0; i < GWR_INPUT_MAX_BUTTONS; ++i) {
+        snap->buttons[i] &= INPUT_DOWN;
+    }
+    snap->cursor_dx = 0.0;
+    snap->cursor_dy = 0.0;
+    snap->scroll_dx = 0.0;
+    snap->scroll_dy = 0.0;
+    snap->resized = false;
+    snap->text_len = 0;
+    snap->text_dropped = 0;
+
+    // only what is queued now: a producer that keeps pushing must not hold
+    // the consumer here forever
+    size_t remaining =
+        atomic_load_explicit(&input->head, memory_order_acquire) -
+        atomic_load_explicit(&input->tail, memory_order_relaxed);
+
+    GWR_input_event_t batch[64];
+    while (remaining > 0) {
+        const size_t count = GWR_input_poll(input, batch, remaining < GWR_ARR_LEN(batch) ? remaining : GWR_ARR_LEN(batch));
+        remaining -= count;
+        for (size_t i = 0; i < count; ++i) {
+            const GWR_input_event_t *ev = &batch[i];
+            switch (ev->type) {
+                case GWR_INPUT_EVENT_KEY:
+                    if (ev->key.key >= 0 && ev->key.key < GWR_INPUT_MAX_KEYS) {
+                        apply_button(&snap->keys[ev->key.key], ev->key.action);
+                    }
+                    snap->mods = ev->key.mods;
+                    break;
+                case GWR_INPUT_EVENT_CHAR:
+                    if (snap->text_len < (int) GWR_ARR_LEN(snap->text)) {
+                        snap->text[snap->text_len++] = ev->chr.codepoint;
+                    } else {
+                        ++snap->text_dropped;
+                    }
+                    break;
+                case GWR_INPUT_EVENT_MOUSE_BUTTON:
+                    if (ev->button.button >= 0 && ev->button.button < GWR_INPUT_MAX_BUTTONS) {
+                        apply_button(&snap->buttons[ev->button.button], ev->button.action);
+                    }
+                    snap->mods = ev->button.mods;
+                    break;
+                case GWR_INPUT_EVENT_CURSOR:
+                    snap->cursor_dx += ev->cursor.x - snap->cursor_x;
+                    snap->cursor_dy += ev->cursor.y - snap->cursor_y;
+                    snap->cursor_x = ev->cursor.x;
+                    snap->cursor_y = ev->cursor.y;
+                    break;
+                case GWR_INPUT_EVENT_SCROLL:
+                    snap->scroll_dx += ev->scroll.dx;
+                    snap->scroll_dy += ev->scroll.dy;
+                    break;
+                case GWR_INPUT_EVENT_RESIZE:
+                    snap->width = ev->resize.width;
+                    snap->height = ev->resize.height;
+                    snap->resized = true;
+                    break;
+                case GWR_INPUT_EVENT_FOCUS:
+                    // GLFW itself emits releases for held keys on focus loss
+                    snap->focused = ev->focus.focused;
+                    break;
+                default:
+                    GWR_UNREACHABLE();
+            }
+            snap->time_ns = ev->time_ns;
+        }
+    }
+
+    if (snap->text_dropped > 0) {
+        INPUT_LOG(
+            GWR_LOG_WARNING, "%d codepoints typed past the %zu-char text buffer were dropped",
+            snap->text_dropped, GWR_ARR_LEN(snap->text)
+        );
+    }
+}
+
+void GWR_input_snapshot_init(const GWR_input_t *input, GWR_input_snapshot_t *snap) {
+    assert(input);
+    assert(snap);
+
+    memset(snap, 0, sizeof(*snap));
+    snap->width = input->width;
+    snap->height = input->height;
+    snap->cursor_x = input->cursor_x;
+    snap->cursor_y = input->cursor_y;
+    snap->focused = input->focused;
+}
+
+uint64_t GWR_input_get_dropped(const GWR_input_t *input) {
+    assert(input);
+
+    return atomic_load_explicit(&((GWR_input_t *) input)->dropped, memory_order_relaxed);
+}
+
+bool GWR_input_set_raw_mouse(GWR_input_t *input, bool enabled) {
+    assert(input);
+
+    if (enabled && !glfwRawMouseMotionSupported()) {
+        INPUT_LOG(GWR_LOG_WARNING, "raw mouse motion not supported");
+        return false;
+    }
+
+    glfwSetInputMode(input->handle, GLFW_RAW_MOUSE_MOTION, enabled ? GLFW_TRUE : GLFW_FALSE);
+    return true;
+}
+
+bool GWR_input_key_down(const GWR_input_snapshot_t *snap, int key) {
+    return test_bit(snap->keys, GWR_INPUT_MAX_KEYS, key, INPUT_DOWN);
+}
+
+bool GWR_input_key_pressed(const GWR_input_snapshot_t *snap, int key) {
+    return test_bit(snap->keys, GWR_INPUT_MAX_KEYS, key, INPUT_PRESSED);
+}
+
+bool GWR_input_key_released(const GWR_input_snapshot_t *snap, int key) {
+    return test_bit(snap->keys, GWR_INPUT_MAX_KEYS, key, INPUT_RELEASED);
+}
+
+bool GWR_input_button_down(const GWR_input_snapshot_t *snap, int button) {
+    return test_bit(snap->buttons, GWR_INPUT_MAX_BUTTONS, button, INPUT_DOWN);
+}
+
+bool GWR_input_button_pressed(const GWR_input_snapshot_t *snap, int button) {
+    return test_bit(snap->buttons, GWR_INPUT_MAX_BUTTONS, button, INPUT_PRESSED);
+}
+
+bool GWR_input_button_released(const GWR_input_snapshot_t *snap, int button) {
+    return test_bit(snap->buttons, GWR_INPUT_MAX_BUTTONS, button, INPUT_RELEASED);
+}
+
+// inner funcs defs
+
+static GWR_input_t *find_input(GLFWwindow *handle) {
+    for (int i = 0; i < INPUT_MAX_WINDOWS; ++i) {
+        if (s_inputs[i] && s_inputs[i]->handle == handle) {
+            return s_inputs[i];
+        }
+    }
+    return NULL;
+}
+
+static void push(GWR_input_t *input, GWR_input_event_t *ev) {
+    ev->time_ns = GWR_now_ns();
+
+    const size_t head = atomic_load_explicit(&input->head, memory_order_relaxed);
+    const size_t tail = atomic_load_explicit(&input->tail, memory_order_acquire);
+    if (head - tail > input->mask) {
+        atomic_fetch_add_explicit(&input->dropped, 1, memory_order_relaxed);
+        return;
+    }
+
+    input->events[head & input->mask] = *ev;
+    atomic_store_explicit(&input->head, head + 1, memory_order_release);
+}
+
+static void apply_button(uint8_t *state, int action) {
+    if (action == GLFW_PRESS) {
+        *state |= INPUT_DOWN | INPUT_PRESSED;
+    } else if (action == GLFW_RELEASE) {
+        *state = (uint8_t) ((*state & ~INPUT_DOWN) | INPUT_RELEASED);
+    }
+    // GLFW_REPEAT leaves the state alone
+}
+
+static bool test_bit(const uint8_t *states, int count, int idx, uint8_t bit) {
+    return idx >= 0 && idx < count && (states[idx] & bit);
+}
+
+static void key_callback(GLFWwindow *handle, int key, int scancode, int action, int mods) {
+    GWR_input_t *input = find_input(handle);
+    if (!input) {
+        return;
+    }
+
+    GWR_input_event_t ev = {.type = GWR_INPUT_EVENT_KEY};
+    ev.key.key = key;
+    ev.key.scancode = scancode;
+    ev.key.action = action;
+    ev.key.mods = mods;
+    push(input, &ev);
+
+    if (input->prev_key) {
+        input->prev_key(handle, key, scancode, action, mods);
+    }
+}
+
+static void char_callback(GLFWwindow *handle, unsigned int codepoint) {
+    GWR_input_t *input = find_input(handle);
+    if (!input) {
+        return;
+    }
+
+    GWR_input_event_t ev = {.type = GWR_INPUT_EVENT_CHAR};
+    ev.chr.codepoint = codepoint;
+    push(input, &ev);
+
+    if (input->prev_char) {
+        input->prev_char(handle, codepoint);
+    }
+}
+
+static void button_callback(GLFWwindow *handle, int button, int action, int mods) {
+    GWR_input_t *input = find_input(handle);
+    if (!input) {
+        return;
+    }
+
+    GWR_input_event_t ev = {.type = GWR_INPUT_EVENT_MOUSE_BUTTON};
+    ev.button.button = button;
+    ev.button.action = action;
+    ev.button.mods = mods;
+    push(input, &ev);
+
+    if (input->prev_button) {
+        input->prev_button(handle, button, action, mods);
+    }
+}
+
+static void cursor_callback(GLFWwindow *handle, double x, double y) {
+    GWR_input_t *input = find_input(handle);
+    if (!input) {
+        return;
+    }
+
+    GWR_input_event_t ev = {.type = GWR_INPUT_EVENT_CURSOR};
+    ev.cursor.x = x;
+    ev.cursor.y = y;
+    push(input, &ev);
+
+    if (input->prev_cursor) {
+        input->prev_cursor(handle, x, y);
+    }
+}
+
+static void scroll_callback(GLFWwindow *handle, double dx, double dy) {
+    GWR_input_t *input = find_input(handle);
+    if (!input) {
+        return;
+    }
+
+    GWR_input_event_t ev = {.type = GWR_INPUT_EVENT_SCROLL};
+    ev.scroll.dx = dx;
+    ev.scroll.dy = dy;
+    push(input, &ev);
+
+    if (input->prev_scroll) {
+        input->prev_scroll(handle, dx, dy);
+    }
+}
+
+static void resize_callback(GLFWwindow *handle, int width, int height) {
+    GWR_input_t *input = find_input(handle);
+    if (!input) {
+        return;
+    }
+
+    GWR_input_event_t ev = {.type = GWR_INPUT_EVENT_RESIZE};
+    ev.resize.width = width;
+    ev.resize.height = height;
+    push(input, &ev);
+
+    if (input->prev_resize) {
+        input->prev_resize(handle, width, height);
+    }
+}
+
+static void focus_callback(GLFWwindow *handle, int focused) {
+    GWR_input_t *input = find_input(handle);
+    if (!input) {
+        return;
+    }
+
+    GWR_input_event_t ev = {.type = GWR_INPUT_EVENT_FOCUS};
+    ev.focus.focused = focused == GLFW_TRUE;
+    push(input, &ev);
+
+    if (input->prev_focus) {
+        input->prev_focus(handle, focused);
+    }
+}
@@ -1,10 +1,69 @@
 #include "internal/gwr_log.h"
+#include "internal/gwr_util.h"
 
 #include <assert.h>
 #include <stddef.h>
 #include <stdio.h>
 #include <stdarg.h>
 #include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <time.h>
+#include <pthread.h>
+
+#define LOG_LINE_SIZE          1024
+#define LOG_SLOT_PAYLOAD       224
+#define LOG_SPEC_SIZE          48
+#define LOG_RATE_SLOTS         256
+#define LOG_RATE_PROBES        8
+#define LOG_IDLE_SLEEP_NS      1000000L
+
+typedef enum {
+    LEN_NONE = 0,
+    LEN_HH,
+    LEN_H,
+    LEN_L,
+    LEN_LL,
+    LEN_Z,
+    LEN_J,
+    LEN_T,
+    LEN_BIG_L,
+} log_len_e;
+
+// one parsed conversion specification of a printf format
+typedef struct {
+    const char *flags;
+    size_t flags_len;
+    const char *width;          // digits, NULL if absent or '*'
+    size_t width_len;
+    bool width_star;
+    bool has_prec;
+    const char *prec;           // digits, NULL if absent or '*'
+    size_t prec_len;
+    bool prec_star;
+    log_len_e len;
+    char conv;
+} log_spec_t;
+
+// ring slot; arguments are stored back to back in `payload` in format order
+typedef struct {
+    _Atomic size_t seq;
+    const char *fmt;
+    uint32_t suppressed;
+    uint16_t used;
+    uint8_t level;
+    uint8_t sys;
+    bool truncated;
+    unsigned char payload[LOG_SLOT_PAYLOAD];
+} log_slot_t;
+
+typedef struct {
+    _Atomic(const char *) key;
+    _Atomic uint64_t window_start;
+    atomic_uint count;
+    atomic_uint suppressed;
+} log_rate_t;
 
 static const char *level_names[] = {
     "INFO",
@@ -13,23 +72,840 @@ static const char *level_names[] = {
     "FATAL"
 };
 
-void GWR_log(GWR_log_level_e level, const char *msg, ...) {
+static const char *sys_names[] = {
+    "",
+    "LOG",
+    "WINDOW",
+    "GLAD",
+    "CAPS",
+    "SHADER",
+    "TEXTURE",
+    "VERTEX BUFFER",
+    "ELEMENT BUFFER",
+    "VERTEX ARRAY",
+    "STREAM BUFFER",
+    "SPRITE BATCH",
+    "SIMD",
+    "FRAMEBUFFER",
+    "FRAMEBUFFER POOL",
+    "FRAME GRAPH",
+    "FRAME PACER",
+    "INPUT",
+    "SHADER WATCHER",
+    "SHADER PREPROC",
+    "SHADER VARIANT",
+    "PROGRAM PIPELINE",
+    "MESH",
+    "MESH OPT",
+    "QUANT",
+    "PIPELINE STATE",
+    "SAMPLER",
+    "BIND",
+    "READBACK",
+    "GL DEBUG",
+    "MEMORY",
+    "RESOURCE",
+    "VFS",
+    "TRACE",
+};
+
+GWR_STATIC_ASSERT(GWR_ARR_LEN(level_names) == GWR_LOG__COUNT, "level_names out of sync");
+GWR_STATIC_ASSERT(GWR_ARR_LEN(sys_names) == GWR_LOG_SYS__COUNT, "sys_names out of sync");
+
+static atomic_int s_levels[GWR_LOG_SYS__COUNT];
+
+// read together by emit() on producers and the drain thread
+static pthread_mutex_t s_sink_lock = PTHREAD_MUTEX_INITIALIZER;
+static GWR_log_sink_fn s_sink = NULL;
+static void *s_sink_user = NULL;
+
+static atomic_uint s_rate_burst = GWR_LOG_DEFAULT_RATE_BURST;
+static _Atomic uint64_t s_rate_window_ns = (uint64_t) GWR_LOG_DEFAULT_RATE_WINDOW_MS * 1000000ull;
+static log_rate_t s_rate[LOG_RATE_SLOTS];
+
+static log_slot_t *s_slots = NULL;
+static size_t s_mask = 0;
+static _Atomic size_t s_enqueue_pos = 0;
+static _Atomic size_t s_dequeue_pos = 0;
+
+static atomic_bool s_running = false;
+static atomic_bool s_stop = false;
+static atomic_int s_producers = 0;
+static _Atomic uint64_t s_dropped = 0;
+static uint64_t s_dropped_reported = 0;
+static pthread_t s_thread;
+
+// inner funcs decls
+
+static void log_v(GWR_log_sys_e sys, GWR_log_level_e level, const char *msg, va_list args);
+
+static void emit(GWR_log_level_e level, GWR_log_sys_e sys, const char *line);
+static void default_sink(GWR_log_level_e level, GWR_log_sys_e sys, const char *line, void *user);
+
+static bool rate_allow(const char *fmt, uint32_t *suppressed);
+
+static size_t write_prefix(char *buf, size_t cap, GWR_log_level_e level, GWR_log_sys_e sys);
+static void append(char *buf, size_t cap, size_t *n, const char *fmt, ...);
+static void format_sync(char *buf, size_t cap, GWR_log_sys_e sys, GWR_log_level_e level,
+                        uint32_t suppressed, const char *msg, va_list args);
+
+static const char *parse_spec(const char *p, log_spec_t *spec);
+static void build_spec(const log_spec_t *spec, int width, int prec, char *out);
+
+static bool capture_args(log_slot_t *slot, const char *fmt, va_list args);
+static bool put(log_slot_t *slot, const void *src, size_t size);
+static bool put_str(log_slot_t *slot, const char *str);
+static bool get(const log_slot_t *slot, size_t *off, void *dst, size_t size);
+
+static bool enqueue(GWR_log_sys_e sys, GWR_log_level_e level, uint32_t suppressed, const char *msg, va_list args);
+static size_t drain(void);
+static void render_slot(const log_slot_t *slot, char *buf, size_t cap);
+static void *drain_thread(void *arg);
+
+// public funcs defs
+
+bool GWR_log_init(size_t capacity) {
+    if (atomic_load(&s_running)) {
+        return true;
+    }
+
+    size_t cap = 2;
+    const size_t want = capacity ? capacity : GWR_LOG_DEFAULT_CAPACITY;
+    while (cap < want) {
+        cap <<= 1;
+    }
+
+    s_slots = malloc(cap * sizeof(log_slot_t));
+    if (!s_slots) {
+        GWR_log_sys(GWR_LOG_SYS_LOG, GWR_LOG_ERROR, "failed to allocate %zu slots", cap);
+        return false;
+    }
+    for (size_t i = 0; i < cap; ++i) {
+        atomic_init(&s_slots[i].seq, i);
+    }
+    s_mask = cap - 1;
+    atomic_store(&s_enqueue_pos, 0);
+    atomic_store(&s_dequeue_pos, 0);
+    atomic_store(&s_stop, false);
+
+    if (pthread_create(&s_thread, NULL, drain_thread, NULL) != 0) {
+        free(s_slots);
+        s_slots = NULL;
+        GWR_log_sys(GWR_LOG_SYS_LOG, GWR_LOG_ERROR, "failed to start drain thread; logging stays synchronous");
+        return false;
+    }
+
+    atomic_store(&s_running, true);
+
+    return true;
+}
+
+void GWR_log_shutdown(void) {
+    if (!atomic_load(&s_running)) {
+        return;
+    }
+
+    // new messages go the synchronous path; wait for in-flight producers to commit
+    atomic_store(&s_running, false);
+    while (atomic_load(&s_producers) > 0) {
+        // spin: producers hold the counter only for the duration of one enqueue
+    }
+
+    atomic_store(&s_stop, true);
+    pthread_join(s_thread, NULL);
+
+    free(s_slots);
+    s_slots = NULL;
+    s_mask = 0;
+}
+
+void GWR_log_flush(void) {
+    if (atomic_load(&s_running)) {
+        const size_t target = atomic_load(&s_enqueue_pos);
+        const struct timespec ts = {0, LOG_IDLE_SLEEP_NS / 10};
+        while (atomic_load(&s_dequeue_pos) < target && atomic_load(&s_running)) {
+            nanosleep(&ts, NULL);
+        }
+    }
+
+    fflush(stdout);
+    fflush(stderr);
+}
+
+void GWR_log_set_level(GWR_log_sys_e sys, GWR_log_level_e level) {
+    assert(sys < GWR_LOG_SYS__COUNT);
     assert(level < GWR_LOG__COUNT);
-    assert(msg);
 
-    printf("[%s] ", level_names[level]);
+    atomic_store_explicit(&s_levels[sys], (int) level, memory_order_relaxed);
+}
 
-    FILE *out = level == GWR_LOG_INFO || level == GWR_LOG_WARNING ? stdout : stderr;
+void GWR_log_set_level_all(GWR_log_level_e level) {
+    for (int i = 0; i < GWR_LOG_SYS__COUNT; ++i) {
+        GWR_log_set_level((GWR_log_sys_e) i, level);
+    }
+}
+
+GWR_log_level_e GWR_log_get_level(GWR_log_sys_e sys) {
+    assert(sys < GWR_LOG_SYS__COUNT);
+
+    return (GWR_log_level_e) atomic_load_explicit(&s_levels[sys], memory_order_relaxed);
+}
+
+bool GWR_log_is_enabled(GWR_log_sys_e sys, GWR_log_level_e level) {
+    assert(sys < GWR_LOG_SYS__COUNT);
+
+    return level == GWR_LOG_FATAL || (int) level >= atomic_load_explicit(&s_levels[sys], memory_order_relaxed);
+}
 
+void GWR_log_set_sink(GWR_log_sink_fn sink, void *user) {
+    // messages logged before the call still go to the old sink
+    GWR_log_flush();
+
+    pthread_mutex_lock(&s_sink_lock);
+    s_sink = sink;
+    s_sink_user = user;
+    pthread_mutex_unlock(&s_sink_lock);
+}
+
+void GWR_log_set_rate_limit(uint32_t burst, uint32_t window_ms) {
+    atomic_store(&s_rate_burst, burst);
+    atomic_store(&s_rate_window_ns, (uint64_t) window_ms * 1000000ull);
+}
+
+uint64_t GWR_log_get_dropped(void) {
+    return atomic_load(&s_dropped);
+}
+
+void GWR_log(GWR_log_level_e level, const char *msg, ...) {
+    va_list args;
+    va_start(args, msg);
+    log_v(GWR_LOG_SYS_GENERAL, level, msg, args);
+    va_end(args);
+}
+
+void GWR_log_sys(GWR_log_sys_e sys, GWR_log_level_e level, const char *msg, ...) {
     va_list args;
     va_start(args, msg);
-    vfprintf(out, msg, args);
+    log_v(sys, level, msg, args);
     va_end(args);
+}
+
+// inner funcs defs
+
+static void log_v(GWR_log_sys_e sys, GWR_log_level_e level, const char *msg, va_list args) {
+    assert(level < GWR_LOG__COUNT);
+    assert(sys < GWR_LOG_SYS__COUNT);
+    assert(msg);
 
-    fprintf(out, "\n");
-    fflush(out);
+    if (!GWR_log_is_enabled(sys, level)) {
+        return;
+    }
+
+    // errors are never limited: one format often covers many distinct failures
+    uint32_t suppressed = 0;
+    if (level < GWR_LOG_ERROR && !rate_allow(msg, &suppressed)) {
+        return;
+    }
+
+    bool queued = false;
+    atomic_fetch_add(&s_producers, 1);
+    if (atomic_load(&s_running)) {
+        va_list copy;
+        va_copy(copy, args);
+        queued = enqueue(sys, level, suppressed, msg, copy);
+        va_end(copy);
+        if (!queued && level < GWR_LOG_ERROR) {
+            atomic_fetch_add_explicit(&s_dropped, 1, memory_order_relaxed);
+            atomic_fetch_sub(&s_producers, 1);
+            return;
+        }
+    }
+    atomic_fetch_sub(&s_producers, 1);
+
+    if (!queued) {
+        // not started, or ring full for an error: never lose errors
+        char line[LOG_LINE_SIZE];
+        format_sync(line, sizeof(line), sys, level, suppressed, msg, args);
+        emit(level, sys, line);
+    }
 
     if (level == GWR_LOG_FATAL) {
+        GWR_log_flush();
         exit(EXIT_FAILURE);
     }
 }
+
+static void emit(GWR_log_level_e level, GWR_log_sys_e sys, const char *line) {
+    // copied out so a sink that logs does not deadlock on the sync path
+    pthread_mutex_lock(&s_sink_lock);
+    const GWR_log_sink_fn sink = s_sink;
+    void *user = s_sink_user;
+    pthread_mutex_unlock(&s_sink_lock);
+
+    if (sink) {
+        sink(level, sys, line, user);
+    } else {
+        default_sink(level, sys, line, NULL);
+    }
+}
+
+static void default_sink(GWR_log_level_e level, GWR_log_sys_e sys, const char *line, void *user) {
+    GWR_UNUSED(sys);
+    GWR_UNUSED(user);
+
+    FILE *out = level == GWR_LOG_INFO || level == GWR_LOG_WARNING ? stdout : stderr;
+
+    fputs(line, out);
+    fputc('\n', out);
+
+    // the drain thread flushes stdout once per batch
+    if (out == stderr || !atomic_load_explicit(&s_running, memory_order_relaxed)) {
+        fflush(out);
+    }
+}
+
+static bool rate_allow(const char *fmt, uint32_t *suppressed) {
+    const uint32_t burst = atomic_load_explicit(&s_rate_burst, memory_order_relaxed);
+    if (!burst) {
+        return true;
+    }
+
+    // call sites are keyed by the address of their format literal
+    const uintptr_t h = ((uintptr_t) fmt >> 3) * (uintptr_t) 0x9E3779B97F4A7C15ull;
+    log_rate_t *entry = NULL;
+    for (size_t i = 0; i < LOG_RATE_PROBES; ++i) {
+        log_rate_t *e = &s_rate[(h + i) & (LOG_RATE_SLOTS - 1)];
+        const char *key = atomic_load_explicit(&e->key, memory_order_acquire);
+        if (key == fmt) {
+            entry = e;
+            break;
+        }
+        if (!key) {
+            const char *expected = NULL;
+            if (atomic_compare_exchange_strong(&e->key, &expected, fmt) || expected == fmt) {
+                entry = e;
+                break;
+            }
+        }
+    }
+    if (!entry) {
+        // table saturated: do not limit what we cannot track
+        return true;
+    }
+
+    const uint64_t now = GWR_now_ns();
+    const uint64_t window = atomic_load_explicit(&s_rate_window_ns, memory_order_relaxed);
+    uint64_t start = atomic_load_explicit(&entry->window_start, memory_order_relaxed);
+    if (now - start >= window &&
+        atomic_compare_exchange_strong(&entry->window_start, &start, now)) {
+        atomic_store_explicit(&entry->count, 1, memory_order_relaxed);
+        *suppressed = atomic_exchange_explicit(&entry->suppressed, 0, memory_order_relaxed);
+        return true;
+    }
+
+    if (atomic_fetch_add_explicit(&entry->count, 1, memory_order_relaxed) < burst) {
+        return true;
+    }
+    atomic_fetch_add_explicit(&entry->suppressed, 1, memory_order_relaxed);
+
+    return false;
+}
+
+static size_t write_prefix(char *buf, size_t cap, GWR_log_level_e level, GWR_log_sys_e sys) {
+    size_t n = 0;
+    if (sys == GWR_LOG_SYS_GENERAL) {
+        append(buf, cap, &n, "[%s] ", level_names[level]);
+    } else {
+        append(buf, cap, &n, "[%s] [%s]: ", level_names[level], sys_names[sys]);
+    }
+    return n;
+}
+
+static void append(char *buf, size_t cap, size_t *n, const char *fmt, ...) {
+    if (*n + 1 >= cap) {
+        return;
+    }
+
+    va_list args;
+    va_start(args, fmt);
+    const int w = vsnprintf(buf + *n, cap - *n, fmt, args);
+    va_end(args);
+
+    if (w > 0) {
+        *n += (size_t) w < cap - *n ? (size_t) w : cap - *n - 1;
+    }
+}
+
+static void format_sync(char *buf, size_t cap, GWR_log_sys_e sys, GWR_log_level_e level,
+                        uint32_t suppressed, const char *msg, va_list args) {
+    size_t n = write_prefix(buf, cap, level, sys);
+
+    if (n + 1 < cap) {
+        const int w = vsnprintf(buf + n, cap - n, msg, args);
+        if (w > 0) {
+            n += (size_t) w < cap - n ? (size_t) w : cap - n - 1;
+        }
+    }
+
+    if (suppressed) {
+        append(buf, cap, &n, " (%u similar messages suppressed)", suppressed);
+    }
+}
+
+static const char *parse_spec(const char *p, log_spec_t *spec) {
+    // p points just past '%'
+    memset(spec, 0, sizeof(*spec));
+
+    spec->flags = p;
+    while (*p && strchr("-+ #0'", *p)) {
+        ++p;
+    }
+    spec->flags_len = (size_t) (p - spec->flags);
+
+    if (*p == '*') {
+        spec->width_star = true;
+        ++p;
+    } else {
+        spec->width = p;
+        while (*p >= '0' && *p <= '9') {
+            ++p;
+        }
+        spec->width_len = (size_t) (p - spec->width);
+    }
+
+    if (*p == '.') {
+        spec->has_prec = true;
+        ++p;
+        if (*p == '*') {
+            spec->prec_star = true;
+            ++p;
+        } else {
+            spec->prec = p;
+            while (*p >= '0' && *p <= '9') {
+                ++p;
+            }
+            spec->prec_len = (size_t) (p - spec->prec);
+        }
+    }
+
+    switch (*p) {
+        case 'h':
+            spec->len = p[1] == 'h' ? LEN_HH : LEN_H;
+            p += spec->len == LEN_HH ? 2 : 1;
+            break;
+        case 'l':
+            spec->len = p[1] == 'l' ? LEN_LL : LEN_L;
+            p += spec->len == LEN_LL ? 2 : 1;
+            break;
+        case 'z':
+            spec->len = LEN_Z;
+            ++p;
+            break;
+        case 'j':
+            spec->len = LEN_J;
+            ++p;
+            break;
+        case 't':
+            spec->len = LEN_T;
+            ++p;
+            break;
+        case 'L':
+            spec->len = LEN_BIG_L;
+            ++p;
+            break;
+        default:
+            break;
+    }
+
+    spec->conv = *p;
+
+    return *p ? p + 1 : p;
+}
+
+static void build_spec(const log_spec_t *spec, int width, int prec, char *out) {
+    // star width/precision are replaced by the captured values, integer
+    // lengths are normalized to ll since the payload stores 64-bit values
+    size_t n = 0;
+    out[n++] = '%';
+
+    const size_t flags_len = spec->flags_len < 8 ? spec->flags_len : 8;
+    memcpy(out + n, spec->flags, flags_len);
+    n += flags_len;
+
+    if (spec->width_star) {
+        n += (size_t) snprintf(out + n, LOG_SPEC_SIZE - n, "%d", width);
+    } else if (spec->width_len) {
+        const size_t len = spec->width_len < 10 ? spec->width_len : 10;
+        memcpy(out + n, spec->width, len);
+        n += len;
+    }
+
+    if (spec->has_prec && !(spec->prec_star && prec < 0)) {
+        out[n++] = '.';
+        if (spec->prec_star) {
+            n += (size_t) snprintf(out + n, LOG_SPEC_SIZE - n, "%d", prec);
+        } else {
+            const size_t len = spec->prec_len < 10 ? spec->prec_len : 10;
+            memcpy(out + n, spec->prec, len);
+            n += len;
+        }
+    }
+
+    switch (spec->conv) {
+        case 'd': case 'i': case 'u': case 'o': case 'x': case 'X':
+            out[n++] = 'l';
+            out[n++] = 'l';
+            break;
+        case 'f': case 'F': case 'e': case 'E': case 'g': case 'G': case 'a': case 'A':
+            if (spec->len == LEN_BIG_L) {
+                out[n++] = 'L';
+            }
+            break;
+        default:
+            break;
+    }
+
+    out[n++] = spec->conv;
+    out[n] = '\0';
+}
+
+static bool capture_args(log_slot_t *slot, const char *fmt, va_list args) {
+    // on the caller thread only the argument values are copied; nothing is formatted
+    for (const char *p = fmt; *p;) {
+        if (*p++ != '%') {
+            continue;
+        }
+        if (*p == '%') {
+            ++p;
+            continue;
+        }
+
+        log_spec_t spec;
+        p = parse_spec(p, &spec);
+
+        bool ok = true;
+        if (spec.width_star) {
+            const int w = va_arg(args, int);
+            ok = ok && put(slot, &w, sizeof(w));
+        }
+        if (spec.prec_star) {
+            const int pr = va_arg(args, int);
+            ok = ok && put(slot, &pr, sizeof(pr));
+        }
+
+        switch (spec.conv) {
+            case 'd':
+            case 'i': {
+                long long v = 0;
+                switch (spec.len) {
+                    case LEN_HH: v = (signed char) va_arg(args, int); break;
+                    case LEN_H: v = (short) va_arg(args, int); break;
+                    case LEN_L: v = va_arg(args, long); break;
+                    case LEN_LL: v = va_arg(args, long long); break;
+                    case LEN_Z: v = (long long) va_arg(args, size_t); break;
+                    case LEN_J: v = (long long) va_arg(args, intmax_t); break;
+                    case LEN_T: v = (long long) va_arg(args, ptrdiff_t); break;
+                    default: v = va_arg(args, int); break;
+                }
+                ok = ok && put(slot, &v, sizeof(v));
+                break;
+            }
+            case 'u':
+            case 'o':
+            case 'x':
+            case 'X': {
+                unsigned long long v = 0;
+                switch (spec.len) {
+                    case LEN_HH: v = (unsigned char) va_arg(args, unsigned int); break;
+                    case LEN_H: v = (unsigned short) va_arg(args, unsigned int); break;
+                    case LEN_L: v = va_arg(args, unsigned long); break;
+                    case LEN_LL: v = va_arg(args, unsigned long long); break;
+                    case LEN_Z: v = va_arg(args, size_t); break;
+                    case LEN_J: v = (unsigned long long) va_arg(args, uintmax_t); break;
+                    case LEN_T: v = (unsigned long long) va_arg(args, ptrdiff_t); break;
+                    default: v = va_arg(args, unsigned int); break;
+                }
+                ok = ok && put(slot, &v, sizeof(v));
+                break;
+            }
+            case 'c': {
+                const int v = va_arg(args, int);
+                ok = ok && put(slot, &v, sizeof(v));
+                break;
+            }
+            case 'f': case 'F': case 'e': case 'E': case 'g': case 'G': case 'a': case 'A':
+                if (spec.len == LEN_BIG_L) {
+                    const long double v = va_arg(args, long double);
+                    ok = ok && put(slot, &v, sizeof(v));
+                } else {
+                    const double v = va_arg(args, double);
+                    ok = ok && put(slot, &v, sizeof(v));
+                }
+                break;
+            case 's': {
+                // the string may not outlive the call, so it is copied
+                const char *v = va_arg(args, const char *);
+                ok = ok && put_str(slot, v ? v : "(null)");
+                break;
+            }
+            case 'p': {
+                void *v = va_arg(args, void *);
+                ok = ok && put(slot, &v, sizeof(v));
+                break;
+            }
+            case 'n':
+                // writing back through the pointer is not supported
+                (void) va_arg(args, void *);
+                break;
+            default:
+                // unknown conversion: the rest of the arguments cannot be decoded
+                return false;
+        }
+
+        if (!ok) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static bool put(log_slot_t *slot, const void *src, size_t size) {
+    if (slot->used + size > LOG_SLOT_PAYLOAD) {
+        return false;
+    }
+    memcpy(slot->payload + slot->used, src, size);
+    slot->used += (uint16_t) size;
+
+    return true;
+}
+
+static bool put_str(log_slot_t *slot, const char *str) {
+    const size_t room = LOG_SLOT_PAYLOAD - slot->used;
+    if (!room) {
+        return false;
+    }
+
+    const size_t len = strlen(str);
+    const size_t n = len < room - 1 ? len : room - 1;
+    memcpy(slot->payload + slot->used, str, n);
+    slot->payload[slot->used + n] = '\0';
+    slot->used += (uint16_t) (n + 1);
+
+    return n == len;
+}
+
+static bool get(const log_slot_t *slot, size_t *off, void *dst, size_t size) {
+    if (*off + size > slot->used) {
+        return false;
+    }
+    memcpy(dst, slot->payload + *off, size);
+    *off += size;
+
+    return true;
+}
+
+static bool enqueue(GWR_log_sys_e sys, GWR_log_level_e level, uint32_t suppressed, const char *msg, va_list args) {
+    // bounded MPMC queue (D. Vyukov) used with a single consumer
+    log_slot_t *slot = NULL;
+    size_t pos = atomic_load_explicit(&s_enqueue_pos, memory_order_relaxed);
+    for (;;) {
+        slot = &s_slots[pos & s_mask];
+        const size_t seq = atomic_load_explicit(&slot->seq, memory_order_acquire);
+        const intptr_t dif = (intptr_t) seq - (intptr_t) pos;
+        if (dif == 0) {
+            if (atomic_compare_exchange_weak_explicit(&s_enqueue_pos, &pos, pos + 1,
+                                                      memory_order_relaxed, memory_order_relaxed)) {
+                break;
+            }
+        } else if (dif < 0) {
+            return false;
+        } else {
+            pos = atomic_load_explicit(&s_enqueue_pos, memory_order_relaxed);
+        }
+    }
+
+    slot->fmt = msg;
+    slot->suppressed = suppressed;
+    slot->used = 0;
+    slot->level = (uint8_t) level;
+    slot->sys = (uint8_t) sys;
+    slot->truncated = !capture_args(slot, msg, args);
+
+    atomic_store_explicit(&slot->seq, pos + 1, memory_order_release);
+
+    return true;
+}
+
+static size_t drain(void) {
+    char line[LOG_LINE_SIZE];
+    size_t count = 0;
+
+    for (;;) {
+        const size_t pos = atomic_load_explicit(&s_dequeue_pos, memory_order_relaxed);
+        log_slot_t *slot = &s_slots[pos & s_mask];
+        const size_t seq = atomic_load_explicit(&slot->seq, memory_order_acquire);
+        if (seq != pos + 1) {
+            break;
+        }
+
+        render_slot(slot, line, sizeof(line));
+        const GWR_log_level_e level = (GWR_log_level_e) slot->level;
+        const GWR_log_sys_e sys = (GWR_log_sys_e) slot->sys;
+
+        atomic_store_explicit(&slot->seq, pos + s_mask + 1, memory_order_release);
+
+        emit(level, sys, line);
+        atomic_store_explicit(&s_dequeue_pos, pos + 1, memory_order_release);
+        ++count;
+    }
+
+    const uint64_t dropped = atomic_load_explicit(&s_dropped, memory_order_relaxed);
+    if (dropped != s_dropped_reported) {
+        size_t n = write_prefix(line, sizeof(line), GWR_LOG_WARNING, GWR_LOG_SYS_LOG);
+        append(line, sizeof(line), &n, "ring full, dropped %llu messages",
+               (unsigned long long) (dropped - s_dropped_reported));
+        s_dropped_reported = dropped;
+        emit(GWR_LOG_WARNING, GWR_LOG_SYS_LOG, line);
+    }
+
+    if (count) {
+        pthread_mutex_lock(&s_sink_lock);
+        const bool to_stdout = !s_sink;
+        pthread_mutex_unlock(&s_sink_lock);
+        if (to_stdout) {
+            fflush(stdout);
+        }
+    }
+
+    return count;
+}
+
+static void render_slot(const log_slot_t *slot, char *buf, size_t cap) {
+    size_t n = write_prefix(buf, cap, (GWR_log_level_e) slot->level, (GWR_log_sys_e) slot->sys);
+    size_t off = 0;
+    char spec_buf[LOG_SPEC_SIZE];
+
+    for (const char *p = slot->fmt; *p && n + 1 < cap;) {
+        if (*p != '%') {
+            const char *lit = p;
+            while (*p && *p != '%') {
+                ++p;
+            }
+            append(buf, cap, &n, "%.*s", (int) (p - lit), lit);
+            continue;
+        }
+
+        ++p;
+        if (*p == '%') {
+            append(buf, cap, &n, "%%");
+            ++p;
+            continue;
+        }
+
+        log_spec_t spec;
+        p = parse_spec(p, &spec);
+
+        int width = 0;
+        int prec = -1;
+        bool ok = true;
+        if (spec.width_star) {
+            ok = ok && get(slot, &off, &width, sizeof(width));
+        }
+        if (spec.prec_star) {
+            ok = ok && get(slot, &off, &prec, sizeof(prec));
+        }
+        build_spec(&spec, width, prec, spec_buf);
+
+        switch (spec.conv) {
+            case 'd':
+            case 'i': {
+                long long v;
+                if ((ok = ok && get(slot, &off, &v, sizeof(v)))) {
+                    append(buf, cap, &n, spec_buf, v);
+                }
+                break;
+            }
+            case 'u':
+            case 'o':
+            case 'x':
+            case 'X': {
+                unsigned long long v;
+                if ((ok = ok && get(slot, &off, &v, sizeof(v)))) {
+                    append(buf, cap, &n, spec_buf, v);
+                }
+                break;
+            }
+            case 'c': {
+                int v;
+                if ((ok = ok && get(slot, &off, &v, sizeof(v)))) {
+                    append(buf, cap, &n, spec_buf, v);
+                }
+                break;
+            }
+            case 'f': case 'F': case 'e': case 'E': case 'g': case 'G': case 'a': case 'A':
+                if (spec.len == LEN_BIG_L) {
+                    long double v;
+                    if ((ok = ok && get(slot, &off, &v, sizeof(v)))) {
+                        append(buf, cap, &n, spec_buf, v);
+                    }
+                } else {
+                    double v;
+                    if ((ok = ok && get(slot, &off, &v, sizeof(v)))) {
+                        append(buf, cap, &n, spec_buf, v);
+                    }
+                }
+                break;
+            case 's': {
+                const char *v = (const char *) slot->payload + off;
+                if ((ok = ok && off < slot->used)) {
+                    append(buf, cap, &n, spec_buf, v);
+                    off += strlen(v) + 1;
+                }
+                break;
+            }
+            case 'p': {
+                void *v;
+                if ((ok = ok && get(slot, &off, &v, sizeof(v)))) {
+                    append(buf, cap, &n, spec_buf, v);
+                }
+                break;
+            }
+            case 'n':
+                break;
+            default:
+                ok = false;
+                break;
+        }
+
+        if (!ok) {
+            break;
+        }
+    }
+
+    if (slot->truncated) {
+        append(buf, cap, &n, "...");
+    }
+    if (slot->suppressed) {
+        append(buf, cap, &n, " (%u similar messages suppressed)", slot->suppressed);
+    }
+}
+
+static void *drain_thread(void *arg) {
+    GWR_UNUSED(arg);
+
+    const struct timespec ts = {0, LOG_IDLE_SLEEP_NS};
+    for (;;) {
+        if (drain()) {
+            continue;
+        }
+        if (atomic_load(&s_stop)) {
+            // producers are quiesced before s_stop is set, one last pass is enough
+            drain();
+            break;
+        }
+        nanosleep(&ts, NULL);
+    }
+
+    return NULL;
+}
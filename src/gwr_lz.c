@@ -0,0 +1,193 @@
+#include "internal/gwr_lz.h"
+
+#include <stdint.h>
+#include <string.h>
+
+#define LZ_MIN_MATCH     4
+#define LZ_MAX_OFFSET    65535u
+// the format requires the last 5 bytes to be literals and the last match to start 12 bytes before the end
+#define LZ_LAST_LITERALS 5
+#define LZ_MATCH_GUARD   12
+#define LZ_HASH_BITS     12
+
+typedef struct {
+    unsigned char *p;
+    unsigned char *end;
+    bool overflow;
+} out_t;
+
+// inner funcs decls
+
+static uint32_t read32(const unsigned char *p);
+static uint32_t hash4(uint32_t v);
+static void put_byte(out_t *o, unsigned char b);
+static void put_length(out_t *o, size_t len);
+static void emit(out_t *o, const unsigned char *lit, size_t lit_len, size_t offset, size_t match_len);
+static bool read_length(const unsigned char *src, size_t n, size_t *ip, size_t *len);
+
+// public funcs defs
+
+size_t GWR_lz_bound(size_t n) {
+    return n + n / 255 + 16;
+}
+
+size_t GWR_lz_compress(const void *src, size_t n, void *dst, size_t cap) {
+    const unsigned char *in = src;
+    out_t o = {.p = dst, .end = (unsigned char *) dst + cap, .overflow = false};
+
+    // positions + 1, 0 = empty
+    uint32_t table[1u << LZ_HASH_BITS];
+    memset(table, 0, sizeof(table));
+
+    size_t anchor = 0;
+    size_t i = 0;
+    const size_t limit = n > LZ_MATCH_GUARD ? n - LZ_MATCH_GUARD : 0;
+    const size_t match_end = n > LZ_LAST_LITERALS ? n - LZ_LAST_LITERALS : 0;
+
+    while (i < limit) {
+        const uint32_t seq = read32(in + i);
+        const uint32_t h = hash4(seq);
+        const uint32_t cand = table[h];
+        table[h] = (uint32_t) i + 1;
+
+        if (cand && i - (cand - 1) <= LZ_MAX_OFFSET && read32(in + cand - 1) == seq) {
+            const size_t from = cand - 1;
+            size_t len = LZ_MIN_MATCH;
+            while (i + len < match_end && in[from + len] == in[i + len]) {
+                ++len;
+            }
+
+            emit(&o, in + anchor, i - anchor, i - from, len);
+            i += len;
+            anchor = i;
+            continue;
+        }
+        ++i;
+    }
+
+    // trailing literals form the last sequence, which has no match part
+    emit(&o, in + anchor, n - anchor, 0, 0);
+
+    return o.overflow ? 0 : (size_t) (o.p - (unsigned char *) dst);
+}
+
+bool GWR_lz_decompress(const void *src, size_t n, void *dst, size_t dst_size) {
+    const unsigned char *in = src;
+    unsigned char *out = dst;
+    size_t ip = 0;
+    size_t op = 0;
+
+    while (ip < n) {
+        const unsigned char token = in[ip++];
+
+        size_t lit = token >> 4;
+        if (lit == 15 && !read_length(in, n, &ip, &lit)) {
+            return false;
+        }
+        if (lit > n - ip || lit > dst_size - op) {
+            return false;
+        }
+        memcpy(out + op, in + ip, lit);
+        ip += lit;
+        op += lit;
+
+        if (ip == n) {
+            break;
+        }
+
+        if (n - ip < 2) {
+            return false;
+        }
+        const size_t offset = (size_t) in[ip] | (size_t) in[ip + 1] << 8;
+        ip += 2;
+        if (offset == 0 || offset > op) {
+            return false;
+        }
+
+        size_t len = token & 15;
+        if (len == 15 && !read_length(in, n, &ip, &len)) {
+            return false;
+        }
+        len += LZ_MIN_MATCH;
+        if (len > dst_size - op) {
+            return false;
+        }
+
+        // matches may overlap their own output, so copy forward byte by byte when they do
+        const unsigned char *from = out + op - offset;
+        if (offset >= len) {
+            memcpy(out + op, from, len);
+        } else {
+            for (size_t k = 0; k < len; ++k) {
+                out[op + k] = from[k];
+            }
+        }
+        op += len;
+    }
+
+    return op == dst_size;
+}
+
+// inner funcs defs
+
+static uint32_t read32(const unsigned char *p) {
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static uint32_t hash4(uint32_t v) {
+    return (v * 2654435761u) >> (32 - LZ_HASH_BITS);
+}
+
+static void put_byte(out_t *o, unsigned char b) {
+    if (o->p == o->end) {
+        o->overflow = true;
+        return;
+    }
+    *o->p++ = b;
+}
+
+static void put_length(out_t *o, size_t len) {
+    for (; len >= 255; len -= 255) {
+        put_byte(o, 255);
+    }
+    put_byte(o, (unsigned char) len);
+}
+
+static void emit(out_t *o, const unsigned char *lit, size_t lit_len, size_t offset, size_t match_len) {
+    const size_t m = match_len ? match_len - LZ_MIN_MATCH : 0;
+    put_byte(o, (unsigned char) ((lit_len < 15 ? lit_len : 15) << 4 | (m < 15 ? m : 15)));
+    if (lit_len >= 15) {
+        put_length(o, lit_len - 15);
+    }
+
+    if (o->overflow || (size_t) (o->end - o->p) < lit_len) {
+        o->overflow = true;
+        return;
+    }
+    memcpy(o->p, lit, lit_len);
+    o->p += lit_len;
+
+    if (!match_len) {
+        return;
+    }
+    put_byte(o, (unsigned char) (offset & 0xff));
+    put_byte(o, (unsigned char) (offset >> 8));
+    if (m >= 15) {
+        put_length(o, m - 15);
+    }
+}
+
+static bool read_length(const unsigned char *src, size_t n, size_t *ip, size_t *len) {
+    unsigned char b;
+    do {
+        if (*ip == n) {
+            return false;
+        }
+        b = src[(*ip)++];
+        *len += b;
+    } while (b == 255);
+
+    return true;
+}
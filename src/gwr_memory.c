@@ -0,0 +1,421 @@
+#include "internal/gwr_memory.h"
+#include "internal/gwr_log.h"
+#include "internal/gwr_cap.h"
+#include "internal/gwr_util.h"
+#include "internal/gwr_texture.h"
+
+#include <string.h>
+#include <assert.h>
+#include <pthread.h>
+
+#define MEM_LOG(level, msg, ...)    GWR_LOG_AT(GWR_LOG_SYS_MEMORY, (level), msg, ##__VA_ARGS__)
+
+#define MEM_KB 1024ll
+#define MEM_MB (1024ll * 1024ll)
+
+typedef struct {
+    GWR_mem_stats_t stats;
+    GWR_mem_budget_fn fn;
+    void *user;
+} mem_category_t;
+
+// resources are created on loader threads too
+static pthread_mutex_t s_mutex = PTHREAD_MUTEX_INITIALIZER;
+static mem_category_t s_categories[GWR_MEM__COUNT];
+static GWR_mem_tag_stats_t s_tags[GWR_MEM_MAX_TAGS] = {[0] = {.name = "untagged"}};
+static int s_tag_count = 1;
+
+static _Thread_local GWR_mem_tag_t s_tag_stack[GWR_MEM_TAG_DEPTH];
+static _Thread_local int s_tag_depth = 0;
+static _Thread_local bool s_in_budget_fn = false;
+
+static const char *s_category_names[] = {
+    "vertex buffers",
+    "element buffers",
+    "stream buffers",
+    "textures",
+    "render targets",
+    "readback",
+    "other",
+};
+
+GWR_STATIC_ASSERT(GWR_ARR_LEN(s_category_names) == GWR_MEM__COUNT, "category names out of sync");
+
+// inner funcs decls
+
+static GWR_mem_tag_t intern_tag(const char *name);
+static void check_budget(GWR_mem_category_e category);
+static int64_t block_bytes(GLenum internal_format, int *block);
+static void print_bytes(FILE *out, int64_t bytes);
+
+// public funcs defs
+
+void GWR_mem_push_tag(const char *name) {
+    assert(name);
+
+    if (s_tag_depth == GWR_MEM_TAG_DEPTH) {
+        MEM_LOG(GWR_LOG_WARNING, "tag '%s' exceeds the tag depth (%d), ignored", name, GWR_MEM_TAG_DEPTH);
+        ++s_tag_depth;
+        return;
+    }
+
+    pthread_mutex_lock(&s_mutex);
+    const GWR_mem_tag_t tag = intern_tag(name);
+    pthread_mutex_unlock(&s_mutex);
+
+    s_tag_stack[s_tag_depth++] = tag;
+}
+
+void GWR_mem_pop_tag(void) {
+    assert(s_tag_depth > 0);
+
+    --s_tag_depth;
+}
+
+GWR_mem_tag_t GWR_mem_record_alloc(GWR_mem_category_e category, int64_t bytes) {
+    assert(category >= 0 && category < GWR_MEM__COUNT);
+    assert(bytes >= 0);
+
+    const int depth = s_tag_depth < GWR_MEM_TAG_DEPTH ? s_tag_depth : GWR_MEM_TAG_DEPTH;
+    const GWR_mem_tag_t tag = depth > 0 ? s_tag_stack[depth - 1] : 0;
+
+    pthread_mutex_lock(&s_mutex);
+    GWR_mem_stats_t *s = &s_categories[category].stats;
+    s->current += bytes;
+    s->peak = s->current > s->peak ? s->current : s->peak;
+    ++s->live;
+    ++s->allocs;
+
+    GWR_mem_tag_stats_t *t = &s_tags[tag];
+    t->current += bytes;
+    t->peak = t->current > t->peak ? t->current : t->peak;
+    pthread_mutex_unlock(&s_mutex);
+
+    check_budget(category);
+    return tag;
+}
+
+void GWR_mem_record_resize(GWR_mem_category_e category, GWR_mem_tag_t tag, int64_t old_bytes, int64_t new_bytes) {
+    assert(category >= 0 && category < GWR_MEM__COUNT);
+    assert(tag < GWR_MEM_MAX_TAGS);
+
+    pthread_mutex_lock(&s_mutex);
+    GWR_mem_stats_t *s = &s_categories[category].stats;
+    s->current += new_bytes - old_bytes;
+    s->peak = s->current > s->peak ? s->current : s->peak;
+
+    GWR_mem_tag_stats_t *t = &s_tags[tag];
+    t->current += new_bytes - old_bytes;
+    t->peak = t->current > t->peak ? t->current : t->peak;
+    pthread_mutex_unlock(&s_mutex);
+
+    if (new_bytes > old_bytes) {
+        check_budget(category);
+    }
+}
+
+void GWR_mem_record_free(GWR_mem_category_e category, GWR_mem_tag_t tag, int64_t bytes) {
+    assert(category >= 0 && category < GWR_MEM__COUNT);
+    assert(tag < GWR_MEM_MAX_TAGS);
+
+    pthread_mutex_lock(&s_mutex);
+    GWR_mem_stats_t *s = &s_categories[category].stats;
+    s->current -= bytes;
+    --s->live;
+    s_tags[tag].current -= bytes;
+    pthread_mutex_unlock(&s_mutex);
+}
+
+void GWR_mem_set_budget(GWR_mem_category_e category, int64_t budget, GWR_mem_budget_fn fn, void *user) {
+    assert(category >= 0 && category < GWR_MEM__COUNT);
+    assert(budget >= 0);
+
+    pthread_mutex_lock(&s_mutex);
+    s_categories[category].stats.budget = budget;
+    s_categories[category].fn = fn;
+    s_categories[category].user = user;
+    pthread_mutex_unlock(&s_mutex);
+}
+
+GWR_mem_stats_t GWR_mem_get_stats(GWR_mem_category_e category) {
+    assert(category >= 0 && category < GWR_MEM__COUNT);
+
+    pthread_mutex_lock(&s_mutex);
+    const GWR_mem_stats_t stats = s_categories[category].stats;
+    pthread_mutex_unlock(&s_mutex);
+
+    return stats;
+}
+
+GWR_mem_stats_t GWR_mem_get_total(void) {
+    GWR_mem_stats_t total = {0};
+
+    pthread_mutex_lock(&s_mutex);
+    for (int i = 0; i < GWR_MEM__COUNT; ++i) {
+        const GWR_mem_stats_t *s = &s_categories[i].stats;
+        total.current += s->current;
+        // categories peak at different times, so this is an upper bound
+        total.peak += s->peak;
+        total.live += s->live;
+        total.allocs += s->allocs;
+    }
+    pthread_mutex_unlock(&s_mutex);
+
+    return total;
+}
+
+int GWR_mem_get_tags(GWR_mem_tag_stats_t *out, int max) {
+    assert(out || max == 0);
+
+    pthread_mutex_lock(&s_mutex);
+    int n = 0;
+    for (int i = 0; i < s_tag_count && n < max; ++i) {
+        if (s_tags[i].peak > 0) {
+            out[n++] = s_tags[i];
+        }
+    }
+    pthread_mutex_unlock(&s_mutex);
+
+    return n;
+}
+
+void GWR_mem_reset_peaks(void) {
+    pthread_mutex_lock(&s_mutex);
+    for (int i = 0; i < GWR_MEM__COUNT; ++i) {
+        s_categories[i].stats.peak = s_categories[i].stats.current;
+    }
+    for (int i = 0; i < s_tag_count; ++i) {
+        s_tags[i].peak = s_tags[i].current;
+    }
+    pthread_mutex_unlock(&s_mutex);
+}
+
+bool GWR_mem_query_driver(GWR_mem_driver_info_t *info) {
+    assert(info);
+
+    *info = (GWR_mem_driver_info_t) {
+        .source = NULL,
+        .dedicated = -1,
+        .total_available = -1,
+        .current_available = -1,
+        .evicted = -1,
+        .eviction_count = -1,
+    };
+
+    if (GWR_cap_has(GWR_FEATURE_MEMORY_INFO_NVX)) {
+        GLint v = 0;
+        info->source = "NVX";
+        glGetIntegerv(GL_GPU_MEMORY_INFO_DEDICATED_VIDMEM_NVX, &v);
+        info->dedicated = v * MEM_KB;
+        glGetIntegerv(GL_GPU_MEMORY_INFO_TOTAL_AVAILABLE_MEMORY_NVX, &v);
+        info->total_available = v * MEM_KB;
+        glGetIntegerv(GL_GPU_MEMORY_INFO_CURRENT_AVAILABLE_VIDMEM_NVX, &v);
+        info->current_available = v * MEM_KB;
+        glGetIntegerv(GL_GPU_MEMORY_INFO_EVICTED_MEMORY_NVX, &v);
+        info->evicted = v * MEM_KB;
+        glGetIntegerv(GL_GPU_MEMORY_INFO_EVICTION_COUNT_NVX, &v);
+        info->eviction_count = v;
+        return true;
+    }
+
+    if (GWR_cap_has(GWR_FEATURE_MEMORY_INFO_ATI)) {
+        // {total free, largest free block, total auxiliary free, largest auxiliary block} in KB
+        GLint tex[4] = {0}, vbo[4] = {0};
+        info->source = "ATI";
+        glGetIntegerv(GL_TEXTURE_FREE_MEMORY_ATI, tex);
+        glGetIntegerv(GL_VBO_FREE_MEMORY_ATI, vbo);
+        // both pools usually alias the same heap; report the larger one
+        info->current_available = (tex[0] > vbo[0] ? tex[0] : vbo[0]) * MEM_KB;
+        return true;
+    }
+
+    return false;
+}
+
+void GWR_mem_dump(FILE *out) {
+    assert(out);
+
+    fprintf(out, "gpu memory (tracked estimates)\n");
+    for (int i = 0; i < GWR_MEM__COUNT; ++i) {
+        const GWR_mem_stats_t s = GWR_mem_get_stats((GWR_mem_category_e) i);
+        if (!s.allocs) {
+            continue;
+        }
+        fprintf(out, "  %-16s ", s_category_names[i]);
+        print_bytes(out, s.current);
+        fprintf(out, "  peak ");
+        print_bytes(out, s.peak);
+        fprintf(out, "  live %lld", (long long) s.live);
+        if (s.budget) {
+            fprintf(out, "  budget ");
+            print_bytes(out, s.budget);
+        }
+        fprintf(out, "\n");
+    }
+
+    const GWR_mem_stats_t total = GWR_mem_get_total();
+    fprintf(out, "  %-16s ", "total");
+    print_bytes(out, total.current);
+    fprintf(out, "\n");
+
+    GWR_mem_tag_stats_t tags[GWR_MEM_MAX_TAGS];
+    const int tag_count = GWR_mem_get_tags(tags, GWR_MEM_MAX_TAGS);
+    if (tag_count > 1 || (tag_count == 1 && strcmp(tags[0].name, "untagged") != 0)) {
+        fprintf(out, "by tag\n");
+        for (int i = 0; i < tag_count; ++i) {
+            fprintf(out, "  %-24s ", tags[i].name);
+            print_bytes(out, tags[i].current);
+            fprintf(out, "  peak ");
+            print_bytes(out, tags[i].peak);
+            fprintf(out, "\n");
+        }
+    }
+
+    GWR_mem_driver_info_t info;
+    if (!GWR_mem_query_driver(&info)) {
+        fprintf(out, "driver: no memory info extension\n");
+        return;
+    }
+    fprintf(out, "driver (%s): available ", info.source);
+    print_bytes(out, info.current_available);
+    if (info.total_available >= 0) {
+        // includes other processes and the driver's own allocations
+        const int64_t used = info.total_available - info.current_available;
+        fprintf(out, " of ");
+        print_bytes(out, info.total_available);
+        fprintf(out, ", used ");
+        print_bytes(out, used);
+        fprintf(out, " (tracked %.0f%%)", used > 0 ? 100.0 * (double) total.current / (double) used : 0.0);
+    }
+    if (info.eviction_count > 0) {
+        fprintf(out, ", %lld evictions (", (long long) info.eviction_count);
+        print_bytes(out, info.evicted);
+        fprintf(out, ")");
+    }
+    fprintf(out, "\n");
+}
+
+const char *GWR_mem_category_name(GWR_mem_category_e category) {
+    assert(category >= 0 && category < GWR_MEM__COUNT);
+
+    return s_category_names[category];
+}
+
+int64_t GWR_mem_texture_size(GLenum internal_format, GLsizei width, GLsizei height, GLsizei layers, GLsizei levels, GLsizei samples) {
+    assert(width > 0);
+    assert(height > 0);
+
+    layers = layers > 0 ? layers : 1;
+    samples = samples > 0 ? samples : 1;
+    if (levels <= 0) {
+        levels = 1;
+        for (GLsizei d = width > height ? width : height; d > 1; d >>= 1) {
+            ++levels;
+        }
+    }
+
+    int block = 1;
+    int64_t unit = block_bytes(internal_format, &block);
+    if (!unit) {
+        unit = GWR_texture_format_bytes(internal_format);
+    }
+
+    int64_t total = 0;
+    for (GLsizei l = 0; l < levels; ++l) {
+        const int64_t w = width >> l > 0 ? width >> l : 1;
+        const int64_t h = height >> l > 0 ? height >> l : 1;
+        total += ((w + block - 1) / block) * ((h + block - 1) / block) * unit;
+    }
+
+    return total * layers * samples;
+}
+
+// inner funcs defs
+
+// called with s_mutex held
+static GWR_mem_tag_t intern_tag(const char *name) {
+    for (int i = 0; i < s_tag_count; ++i) {
+        if (strncmp(s_tags[i].name, name, GWR_MEM_TAG_NAME_SIZE - 1) == 0) {
+            return (GWR_mem_tag_t) i;
+        }
+    }
+
+    if (s_tag_count == GWR_MEM_MAX_TAGS) {
+        MEM_LOG(GWR_LOG_WARNING, "too many tags, '%s' is counted as untagged", name);
+        return 0;
+    }
+
+    GWR_mem_tag_stats_t *t = &s_tags[s_tag_count];
+    snprintf(t->name, sizeof(t->name), "%s", name);
+    return (GWR_mem_tag_t) s_tag_count++;
+}
+
+static void check_budget(GWR_mem_category_e category) {
+    pthread_mutex_lock(&s_mutex);
+    const mem_category_t c = s_categories[category];
+    pthread_mutex_unlock(&s_mutex);
+
+    if (!c.stats.budget || c.stats.current <= c.stats.budget) {
+        return;
+    }
+
+    // allocations made while evicting must not re-enter
+    if (c.fn && !s_in_budget_fn) {
+        s_in_budget_fn = true;
+        c.fn(category, c.stats.current - c.stats.budget, c.user);
+        s_in_budget_fn = false;
+        return;
+    }
+    if (!c.fn) {
+        MEM_LOG(
+            GWR_LOG_WARNING, "%s over budget by %lld bytes",
+            s_category_names[category], (long long) (c.stats.current - c.stats.budget)
+        );
+    }
+}
+
+// bytes per block for block-compressed formats, 0 otherwise
+static int64_t block_bytes(GLenum internal_format, int *block) {
+    *block = 4;
+    switch (internal_format) {
+        case GL_COMPRESSED_RGB_S3TC_DXT1_EXT:
+        case GL_COMPRESSED_RGBA_S3TC_DXT1_EXT:
+        case GL_COMPRESSED_SRGB_S3TC_DXT1_EXT:
+        case GL_COMPRESSED_RED_RGTC1:
+        case GL_COMPRESSED_SIGNED_RED_RGTC1:
+        case GL_COMPRESSED_RGB8_ETC2:
+        case GL_COMPRESSED_SRGB8_ETC2:
+        case GL_COMPRESSED_RGB8_PUNCHTHROUGH_ALPHA1_ETC2:
+        case GL_COMPRESSED_R11_EAC:
+        case GL_COMPRESSED_SIGNED_R11_EAC:
+            return 8;
+        case GL_COMPRESSED_RGBA_S3TC_DXT3_EXT:
+        case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT:
+        case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT:
+        case GL_COMPRESSED_RG_RGTC2:
+        case GL_COMPRESSED_SIGNED_RG_RGTC2:
+        case GL_COMPRESSED_RGBA_BPTC_UNORM:
+        case GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM:
+        case GL_COMPRESSED_RGB_BPTC_SIGNED_FLOAT:
+        case GL_COMPRESSED_RGB_BPTC_UNSIGNED_FLOAT:
+        case GL_COMPRESSED_RGBA8_ETC2_EAC:
+        case GL_COMPRESSED_SRGB8_ALPHA8_ETC2_EAC:
+        case GL_COMPRESSED_RG11_EAC:
+        case GL_COMPRESSED_SIGNED_RG11_EAC:
+        case GL_COMPRESSED_RGBA_ASTC_4x4_KHR:
+            return 16;
+        default:
+            *block = 1;
+            return 0;
+    }
+}
+
+static void print_bytes(FILE *out, int64_t bytes) {
+    if (bytes < 0) {
+        fprintf(out, "?");
+    } else if (bytes >= MEM_MB) {
+        fprintf(out, "%.1f MiB", (double) bytes / (double) MEM_MB);
+    } else {
+        fprintf(out, "%.1f KiB", (double) bytes / (double) MEM_KB);
+    }
+}
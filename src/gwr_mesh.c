@@ -0,0 +1,443 @@
+#include "internal/gwr_mesh.h"
+#include "internal/gwr_draw.h"
+#include "internal/gwr_log.h"
+#include "internal/gwr_util.h"
+#include "internal/gwr_debug.h"
+#include "internal/gwr_vfs.h"
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <assert.h>
+
+#define MESH_LOG(level, msg, ...)    GWR_LOG_AT(GWR_LOG_SYS_MESH, (level), msg, ##__VA_ARGS__)
+
+struct GWR_mesh_t {
+    GWR_vertex_array_t *vao;
+    GWR_vertex_buffer_t *vbo;
+    GWR_element_buffer_t *ebo;
+
+    GLenum index_type;
+    size_t index_size;
+    size_t vertex_count;
+    size_t index_count;
+    float bounds_min[3];
+    float bounds_max[3];
+
+    GWR_mesh_lod_t *lods;
+    size_t lod_count;
+    GWR_mesh_meshlet_t *meshlets;
+    size_t meshlet_count;
+};
+
+typedef struct {
+    GLenum type;
+    uint32_t bytes;
+} component_info_t;
+
+static const component_info_t s_components[] = {
+    [GWR_MESH_COMPONENT_F32] = {GL_FLOAT, 4},
+    [GWR_MESH_COMPONENT_F16] = {GL_HALF_FLOAT, 2},
+    [GWR_MESH_COMPONENT_F64] = {GL_DOUBLE, 8},
+    [GWR_MESH_COMPONENT_I8] = {GL_BYTE, 1},
+    [GWR_MESH_COMPONENT_U8] = {GL_UNSIGNED_BYTE, 1},
+    [GWR_MESH_COMPONENT_I16] = {GL_SHORT, 2},
+    [GWR_MESH_COMPONENT_U16] = {GL_UNSIGNED_SHORT, 2},
+    [GWR_MESH_COMPONENT_I32] = {GL_INT, 4},
+    [GWR_MESH_COMPONENT_U32] = {GL_UNSIGNED_INT, 4},
+    // packed formats hold all four components in one word
+    [GWR_MESH_COMPONENT_I2_10_10_10] = {GL_INT_2_10_10_10_REV, 1},
+    [GWR_MESH_COMPONENT_U2_10_10_10] = {GL_UNSIGNED_INT_2_10_10_10_REV, 1},
+};
+
+GWR_STATIC_ASSERT(GWR_ARR_LEN(s_components) == GWR_MESH_COMPONENT__COUNT, "s_components out of sync");
+
+// inner funcs decls
+
+static bool validate_header(const GWR_mesh_header_t *h, size_t file_size, const char *path);
+static bool range_ok(uint64_t offset, uint64_t size, size_t file_size);
+static uint32_t attrib_bytes(const GWR_mesh_attrib_t *a);
+static bool is_packed(uint8_t component);
+static bool mode_accepts(uint8_t mode, uint8_t component);
+static bool indices_in_range(const unsigned char *indices, const GWR_mesh_header_t *h);
+static bool upload(GWR_mesh_t *mesh, const unsigned char *base, const GWR_mesh_header_t *h);
+static void *dup_table(const unsigned char *base, uint64_t offset, size_t count, size_t elem);
+
+// public funcs defs
+
+GWR_mesh_t *GWR_mesh_load(const char *path) {
+    assert(path);
+
+    GWR_vfs_file_t file;
+    if (!GWR_vfs_open(path, &file)) {
+        MESH_LOG(GWR_LOG_ERROR, "failed to open '%s'", path);
+        return NULL;
+    }
+    if (file.size < sizeof(GWR_mesh_header_t)) {
+        MESH_LOG(GWR_LOG_ERROR, "'%s' is too small to be a mesh", path);
+        GWR_vfs_close(&file);
+        return NULL;
+    }
+
+    // loose files are mapped, archived ones point into the archive mapping
+    const size_t file_size = file.size;
+    const unsigned char *base = file.data;
+    const GWR_mesh_header_t *h = file.data;
+    GWR_mesh_t *mesh = NULL;
+
+    if (!validate_header(h, file_size, path)) {
+        goto fail;
+    }
+
+    mesh = calloc(1, sizeof(GWR_mesh_t));
+    if (!mesh) {
+        MESH_LOG(GWR_LOG_ERROR, "failed to allocate GWR_mesh_t");
+        goto fail;
+    }
+
+    mesh->vertex_count = h->vertex_count;
+    mesh->index_count = h->index_count;
+    mesh->index_size = h->index_size;
+    mesh->index_type = h->index_size == 2 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+    memcpy(mesh->bounds_min, h->bounds_min, sizeof(mesh->bounds_min));
+    memcpy(mesh->bounds_max, h->bounds_max, sizeof(mesh->bounds_max));
+
+    mesh->lod_count = h->lod_count;
+    mesh->lods = dup_table(base, h->lod_offset, h->lod_count, sizeof(GWR_mesh_lod_t));
+    mesh->meshlet_count = h->meshlet_count;
+    mesh->meshlets = dup_table(base, h->meshlet_offset, h->meshlet_count, sizeof(GWR_mesh_meshlet_t));
+    if ((h->lod_count && !mesh->lods) || (h->meshlet_count && !mesh->meshlets)) {
+        MESH_LOG(GWR_LOG_ERROR, "failed to allocate lod/meshlet tables");
+        goto fail;
+    }
+
+    if (!upload(mesh, base, h)) {
+        goto fail;
+    }
+    GWR_mesh_apply_layout(mesh->vao, mesh->vbo, h->attribs, h->attrib_count, h->vertex_stride);
+    GWR_vertex_array_set_element_buffer(mesh->vao, mesh->ebo);
+
+    GWR_debug_label(GL_VERTEX_ARRAY, GWR_vertex_array_get_id(mesh->vao), "mesh '%s'", path);
+    GWR_debug_label(GL_BUFFER, GWR_vertex_buffer_get_id(mesh->vbo), "mesh '%s' vertices", path);
+    GWR_debug_label(GL_BUFFER, GWR_element_buffer_get_id(mesh->ebo), "mesh '%s' indices", path);
+
+    MESH_LOG(
+        GWR_LOG_INFO, "loaded '%s': %u vertices, %u indices, %u lods, %u meshlets",
+        path, h->vertex_count, h->index_count, h->lod_count, h->meshlet_count
+    );
+
+    // buffer storage copied the data during the call, the view can go
+    GWR_vfs_close(&file);
+    return mesh;
+
+fail:
+    if (mesh) {
+        GWR_mesh_destroy(mesh);
+    }
+    GWR_vfs_close(&file);
+    return NULL;
+}
+
+void GWR_mesh_destroy(GWR_mesh_t *mesh) {
+    assert(mesh);
+
+    if (mesh->vao) {
+        GWR_vertex_array_destroy(mesh->vao);
+    }
+    if (mesh->ebo) {
+        GWR_element_buffer_destroy(mesh->ebo);
+    }
+    if (mesh->vbo) {
+        GWR_vertex_buffer_destroy(mesh->vbo);
+    }
+    free(mesh->lods);
+    free(mesh->meshlets);
+    free(mesh);
+}
+
+void GWR_mesh_draw(const GWR_mesh_t *mesh, const GWR_shader_t *shader, size_t lod) {
+    assert(mesh);
+    assert(shader);
+
+    size_t first = 0;
+    size_t count = mesh->index_count;
+    if (mesh->lod_count) {
+        const GWR_mesh_lod_t *l = &mesh->lods[lod < mesh->lod_count ? lod : mesh->lod_count - 1];
+        first = l->first_index;
+        count = l->index_count;
+    }
+
+    GWR_draw_elements(
+        GL_TRIANGLES, mesh->vao, shader, mesh->ebo,
+        (GLsizei) count, (GLintptr) (first * mesh->index_size)
+    );
+}
+
+void GWR_mesh_apply_layout(
+    const GWR_vertex_array_t *vao,
+    const GWR_vertex_buffer_t *vbo,
+    const GWR_mesh_attrib_t *attribs,
+    size_t attrib_count,
+    uint32_t stride
+) {
+    assert(vao);
+    assert(vbo);
+    assert(attribs || !attrib_count);
+
+    for (size_t i = 0; i < attrib_count; ++i) {
+        const GWR_mesh_attrib_t *a = &attribs[i];
+        assert(a->component < GWR_MESH_COMPONENT__COUNT);
+
+        const GLenum type = s_components[a->component].type;
+        const void *offset = (const void *) (uintptr_t) a->offset;
+
+        switch ((GWR_mesh_attrib_mode_e) a->mode) {
+            case GWR_MESH_ATTRIB_FLOAT:
+                GWR_vertex_array_attrib_pointerf(
+                    vao, vbo, a->location, a->size, type, a->normalized ? GL_TRUE : GL_FALSE, (GLsizei) stride, offset
+                );
+                break;
+            case GWR_MESH_ATTRIB_INT:
+                GWR_vertex_array_attrib_pointeri(vao, vbo, a->location, a->size, type, (GLsizei) stride, offset);
+                break;
+            case GWR_MESH_ATTRIB_DOUBLE:
+                GWR_vertex_array_attrib_pointerl(vao, vbo, a->location, a->size, type, (GLsizei) stride, offset);
+                break;
+            default:
+                GWR_UNREACHABLE();
+        }
+    }
+    GWR_vertex_array_unbind();
+}
+
+const GWR_vertex_array_t *GWR_mesh_get_vertex_array(const GWR_mesh_t *mesh) {
+    assert(mesh);
+
+    return mesh->vao;
+}
+
+const GWR_vertex_buffer_t *GWR_mesh_get_vertex_buffer(const GWR_mesh_t *mesh) {
+    assert(mesh);
+
+    return mesh->vbo;
+}
+
+const GWR_element_buffer_t *GWR_mesh_get_element_buffer(const GWR_mesh_t *mesh) {
+    assert(mesh);
+
+    return mesh->ebo;
+}
+
+GLenum GWR_mesh_get_index_type(const GWR_mesh_t *mesh) {
+    assert(mesh);
+
+    return mesh->index_type;
+}
+
+size_t GWR_mesh_get_vertex_count(const GWR_mesh_t *mesh) {
+    assert(mesh);
+
+    return mesh->vertex_count;
+}
+
+size_t GWR_mesh_get_index_count(const GWR_mesh_t *mesh) {
+    assert(mesh);
+
+    return mesh->index_count;
+}
+
+void GWR_mesh_get_bounds(const GWR_mesh_t *mesh, float out_min[3], float out_max[3]) {
+    assert(mesh);
+    assert(out_min);
+    assert(out_max);
+
+    memcpy(out_min, mesh->bounds_min, sizeof(mesh->bounds_min));
+    memcpy(out_max, mesh->bounds_max, sizeof(mesh->bounds_max));
+}
+
+size_t GWR_mesh_get_lod_count(const GWR_mesh_t *mesh) {
+    assert(mesh);
+
+    return mesh->lod_count;
+}
+
+const GWR_mesh_lod_t *GWR_mesh_get_lod(const GWR_mesh_t *mesh, size_t idx) {
+    assert(mesh);
+
+    return idx < mesh->lod_count ? &mesh->lods[idx] : NULL;
+}
+
+size_t GWR_mesh_get_meshlet_count(const GWR_mesh_t *mesh) {
+    assert(mesh);
+
+    return mesh->meshlet_count;
+}
+
+const GWR_mesh_meshlet_t *GWR_mesh_get_meshlets(const GWR_mesh_t *mesh) {
+    assert(mesh);
+
+    return mesh->meshlets;
+}
+
+// inner funcs defs
+
+static bool validate_header(const GWR_mesh_header_t *h, size_t file_size, const char *path) {
+    if (h->magic != GWR_MESH_MAGIC) {
+        MESH_LOG(GWR_LOG_ERROR, "'%s' is not a mesh file", path);
+        return false;
+    }
+    if (h->version != GWR_MESH_VERSION) {
+        MESH_LOG(GWR_LOG_ERROR, "'%s' has version %u, expected %u", path, h->version, GWR_MESH_VERSION);
+        return false;
+    }
+    if (h->index_size != 2 && h->index_size != 4) {
+        MESH_LOG(GWR_LOG_ERROR, "'%s' uses %u byte indices", path, h->index_size);
+        return false;
+    }
+    if (!h->vertex_count || !h->vertex_stride || !h->index_count || h->index_count % 3) {
+        MESH_LOG(GWR_LOG_ERROR, "'%s' has no triangles", path);
+        return false;
+    }
+    if (!h->attrib_count || h->attrib_count > GWR_MESH_MAX_ATTRIBS) {
+        MESH_LOG(GWR_LOG_ERROR, "'%s' has %u attributes", path, h->attrib_count);
+        return false;
+    }
+
+    const uint64_t blobs[][2] = {
+        {h->vertex_offset, (uint64_t) h->vertex_count * h->vertex_stride},
+        {h->index_offset, (uint64_t) h->index_count * h->index_size},
+        {h->lod_offset, (uint64_t) h->lod_count * sizeof(GWR_mesh_lod_t)},
+        {h->meshlet_offset, (uint64_t) h->meshlet_count * sizeof(GWR_mesh_meshlet_t)},
+    };
+    for (size_t i = 0; i < GWR_ARR_LEN(blobs); ++i) {
+        if (blobs[i][1] && (blobs[i][0] % GWR_MESH_BLOB_ALIGNMENT || !range_ok(blobs[i][0], blobs[i][1], file_size))) {
+            MESH_LOG(GWR_LOG_ERROR, "'%s' is truncated or misaligned", path);
+            return false;
+        }
+    }
+
+    for (uint32_t i = 0; i < h->attrib_count; ++i) {
+        const GWR_mesh_attrib_t *a = &h->attribs[i];
+        if (a->component >= GWR_MESH_COMPONENT__COUNT || a->mode >= GWR_MESH_ATTRIB__COUNT ||
+            a->size < 1 || a->size > 4 || (uint64_t) a->offset + attrib_bytes(a) > h->vertex_stride) {
+            MESH_LOG(GWR_LOG_ERROR, "'%s' attribute %u is malformed", path, i);
+            return false;
+        }
+        if (is_packed(a->component) && a->size != 4) {
+            MESH_LOG(GWR_LOG_ERROR, "'%s' attribute %u is packed but has %u components", path, i, a->size);
+            return false;
+        }
+        if (!mode_accepts(a->mode, a->component)) {
+            MESH_LOG(GWR_LOG_ERROR, "'%s' attribute %u pairs mode %u with component %u", path, i, a->mode, a->component);
+            return false;
+        }
+    }
+
+    const unsigned char *base = (const unsigned char *) h;
+
+    for (uint32_t i = 0; i < h->lod_count; ++i) {
+        const GWR_mesh_lod_t *l = (const GWR_mesh_lod_t *) (base + h->lod_offset) + i;
+        if ((uint64_t) l->first_index + l->index_count > h->index_count) {
+            MESH_LOG(GWR_LOG_ERROR, "'%s' lod %u is out of range", path, i);
+            return false;
+        }
+    }
+
+    for (uint32_t i = 0; i < h->meshlet_count; ++i) {
+        const GWR_mesh_meshlet_t *m = (const GWR_mesh_meshlet_t *) (base + h->meshlet_offset) + i;
+        if ((uint64_t) m->first_index + m->index_count > h->index_count) {
+            MESH_LOG(GWR_LOG_ERROR, "'%s' meshlet %u is out of range", path, i);
+            return false;
+        }
+    }
+
+    // the driver does not bounds-check fetches, so a stray index reads past the vertex store
+    if (!indices_in_range(base + h->index_offset, h)) {
+        MESH_LOG(GWR_LOG_ERROR, "'%s' references vertices past %u", path, h->vertex_count);
+        return false;
+    }
+
+    return true;
+}
+
+static bool range_ok(uint64_t offset, uint64_t size, size_t file_size) {
+    return offset <= file_size && size <= file_size - offset;
+}
+
+static uint32_t attrib_bytes(const GWR_mesh_attrib_t *a) {
+    const component_info_t *c = &s_components[a->component];
+    if (is_packed(a->component)) {
+        return 4;
+    }
+    return c->bytes * a->size;
+}
+
+static bool is_packed(uint8_t component) {
+    return component == GWR_MESH_COMPONENT_I2_10_10_10 || component == GWR_MESH_COMPONENT_U2_10_10_10;
+}
+
+static bool mode_accepts(uint8_t mode, uint8_t component) {
+    switch (mode) {
+        case GWR_MESH_ATTRIB_FLOAT:
+            // glVertexAttribPointer converts every component type
+            return true;
+        case GWR_MESH_ATTRIB_INT:
+            return component >= GWR_MESH_COMPONENT_I8 && component <= GWR_MESH_COMPONENT_U32;
+        case GWR_MESH_ATTRIB_DOUBLE:
+            return component == GWR_MESH_COMPONENT_F64;
+        default:
+            return false;
+    }
+}
+
+static bool indices_in_range(const unsigned char *indices, const GWR_mesh_header_t *h) {
+    // blob alignment guarantees both index widths are naturally aligned
+    if (h->index_size == 2) {
+        const uint16_t *idx = (const uint16_t *) indices;
+        for (uint32_t i = 0; i < h->index_count; ++i) {
+            if (idx[i] >= h->vertex_count) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    const uint32_t *idx = (const uint32_t *) indices;
+    for (uint32_t i = 0; i < h->index_count; ++i) {
+        if (idx[i] >= h->vertex_count) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool upload(GWR_mesh_t *mesh, const unsigned char *base, const GWR_mesh_header_t *h) {
+    // straight from the page cache into immutable storage
+    mesh->vbo = GWR_vertex_buffer_create_storage(
+        base + h->vertex_offset, (GLsizeiptr) h->vertex_count * h->vertex_stride, 0
+    );
+    if (!mesh->vbo) {
+        return false;
+    }
+
+    mesh->ebo = GWR_element_buffer_create_storage(
+        base + h->index_offset, (GLsizeiptr) h->index_count * h->index_size, mesh->index_type, 0
+    );
+    if (!mesh->ebo) {
+        return false;
+    }
+
+    mesh->vao = GWR_vertex_array_create();
+    return mesh->vao != NULL;
+}
+
+static void *dup_table(const unsigned char *base, uint64_t offset, size_t count, size_t elem) {
+    if (!count) {
+        return NULL;
+    }
+    void *table = malloc(count * elem);
+    if (table) {
+        memcpy(table, base + offset, count * elem);
+    }
+    return table;
+}
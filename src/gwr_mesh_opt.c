@@ -0,0 +1,548 @@
+#include "internal/gwr_mesh_opt.h"
+#include "internal/gwr_log.h"
+#include "internal/gwr_util.h"
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <math.h>
+#include <assert.h>
+
+#define MESH_OPT_LOG(level, msg, ...)    GWR_LOG_AT(GWR_LOG_SYS_MESH_OPT, (level), msg, ##__VA_ARGS__)
+
+// Forsyth's scoring constants
+#define FORSYTH_CACHE_DECAY_POWER       1.5f
+#define FORSYTH_LAST_TRI_SCORE          0.75f
+#define FORSYTH_VALENCE_BOOST_SCALE     2.0f
+#define FORSYTH_VALENCE_BOOST_POWER     0.5f
+
+// Sander et al.: a cluster may end once its running acmr is within this
+// factor of its patch's; higher means fewer, longer clusters
+#define OVERDRAW_ACMR_THRESHOLD         1.05f
+
+typedef struct {
+    uint32_t first;
+    uint32_t count;
+    float key;
+} cluster_t;
+
+// inner funcs decls
+
+static float vertex_score(int cache_pos, uint32_t live);
+static const float *position(const void *vertices, size_t stride, uint32_t idx);
+static int cmp_cluster(const void *a, const void *b);
+static int fifo_misses(uint32_t *stamp, uint32_t *time, const uint32_t *tri);
+
+// public funcs defs
+
+size_t GWR_mesh_opt_weld(void *vertices, size_t vertex_count, size_t stride, uint32_t *indices, size_t index_count) {
+    assert(vertices || !vertex_count);
+    assert(indices || !index_count);
+    assert(stride);
+
+    size_t cap = 16;
+    while (cap < vertex_count * 2) {
+        cap <<= 1;
+    }
+    uint32_t *slots = malloc(cap * sizeof(uint32_t));
+    uint32_t *remap = malloc(vertex_count * sizeof(uint32_t));
+    if (!slots || !remap) {
+        MESH_OPT_LOG(GWR_LOG_ERROR, "failed to allocate weld tables");
+        free(slots);
+        free(remap);
+        return vertex_count;
+    }
+    memset(slots, 0xff, cap * sizeof(uint32_t));
+
+    unsigned char *bytes = vertices;
+    size_t unique = 0;
+    for (size_t v = 0; v < vertex_count; ++v) {
+        const unsigned char *src = bytes + v * stride;
+        size_t s = GWR_fnv1a(GWR_FNV_OFFSET, src, stride) & (cap - 1);
+        while (slots[s] != UINT32_MAX && memcmp(bytes + (size_t) slots[s] * stride, src, stride) != 0) {
+            s = (s + 1) & (cap - 1);
+        }
+
+        if (slots[s] == UINT32_MAX) {
+            // kept vertices only move towards the front, so this never clobbers one still to be read
+            if (unique != v) {
+                memmove(bytes + unique * stride, src, stride);
+            }
+            slots[s] = (uint32_t) unique++;
+        }
+        remap[v] = slots[s];
+    }
+
+    for (size_t i = 0; i < index_count; ++i) {
+        assert(indices[i] < vertex_count);
+        indices[i] = remap[indices[i]];
+    }
+
+    free(slots);
+    free(remap);
+    return unique;
+}
+
+bool GWR_mesh_opt_vertex_cache(uint32_t *dst, const uint32_t *indices, size_t index_count, size_t vertex_count) {
+    assert(dst);
+    assert(indices || !index_count);
+    assert(index_count % 3 == 0);
+
+    const size_t tri_count = index_count / 3;
+    if (!tri_count) {
+        return true;
+    }
+
+    uint32_t *offsets = calloc(vertex_count + 1, sizeof(uint32_t));
+    uint32_t *live = calloc(vertex_count, sizeof(uint32_t));
+    uint32_t *adjacency = malloc(index_count * sizeof(uint32_t));
+    int *cache_pos = malloc(vertex_count * sizeof(int));
+    float *score = malloc(vertex_count * sizeof(float));
+    float *tri_score = malloc(tri_count * sizeof(float));
+    bool *emitted = calloc(tri_count, sizeof(bool));
+    uint32_t *input = malloc(index_count * sizeof(uint32_t));
+    bool ok = offsets && live && adjacency && cache_pos && score && tri_score && emitted && input;
+    if (!ok) {
+        MESH_OPT_LOG(GWR_LOG_ERROR, "failed to allocate vertex cache tables");
+        goto cleanup;
+    }
+
+    // dst may alias indices
+    memcpy(input, indices, index_count * sizeof(uint32_t));
+
+    // per-vertex triangle lists
+    for (size_t i = 0; i < index_count; ++i) {
+        assert(input[i] < vertex_count);
+        ++live[input[i]];
+    }
+    for (size_t v = 0; v < vertex_count; ++v) {
+        offsets[v + 1] = offsets[v] + live[v];
+        live[v] = 0;
+    }
+    for (size_t t = 0; t < tri_count; ++t) {
+        for (int k = 0; k < 3; ++k) {
+            const uint32_t v = input[t * 3 + k];
+            adjacency[offsets[v] + live[v]++] = (uint32_t) t;
+        }
+    }
+
+    for (size_t v = 0; v < vertex_count; ++v) {
+        cache_pos[v] = -1;
+        score[v] = vertex_score(-1, live[v]);
+    }
+
+    size_t best = 0;
+    for (size_t t = 0; t < tri_count; ++t) {
+        const uint32_t *tri = &input[t * 3];
+        tri_score[t] = score[tri[0]] + score[tri[1]] + score[tri[2]];
+        if (tri_score[t] > tri_score[best]) {
+            best = t;
+        }
+    }
+
+    uint32_t cache[GWR_MESH_OPT_CACHE_SIZE + 3];
+    size_t cache_count = 0;
+    size_t cursor = 0;
+
+    for (size_t out = 0; out < tri_count; ++out) {
+        if (best == SIZE_MAX) {
+            // nothing in the cache has triangles left, take the next one in input order
+            while (emitted[cursor]) {
+                ++cursor;
+            }
+            best = cursor;
+        }
+
+        const uint32_t *tri = &input[best * 3];
+        memcpy(&dst[out * 3], tri, 3 * sizeof(uint32_t));
+        emitted[best] = true;
+
+        // drop the triangle from its vertices' lists
+        for (int k = 0; k < 3; ++k) {
+            const uint32_t v = tri[k];
+            uint32_t *list = &adjacency[offsets[v]];
+            for (uint32_t i = 0; i < live[v]; ++i) {
+                if (list[i] == best) {
+                    list[i] = list[--live[v]];
+                    break;
+                }
+            }
+        }
+
+        // the triangle's vertices move to the front, the rest shift back
+        uint32_t next[GWR_MESH_OPT_CACHE_SIZE + 3];
+        size_t next_count = 0;
+        for (int k = 0; k < 3; ++k) {
+            next[next_count++] = tri[k];
+        }
+        for (size_t i = 0; i < cache_count; ++i) {
+            const uint32_t v = cache[i];
+            if (v != tri[0] && v != tri[1] && v != tri[2]) {
+                next[next_count++] = v;
+            }
+        }
+
+        for (size_t i = 0; i < next_count; ++i) {
+            const uint32_t v = next[i];
+            cache_pos[v] = i < GWR_MESH_OPT_CACHE_SIZE ? (int) i : -1;
+            score[v] = vertex_score(cache_pos[v], live[v]);
+        }
+
+        best = SIZE_MAX;
+        float best_score = -1.f;
+        for (size_t i = 0; i < next_count; ++i) {
+            const uint32_t v = next[i];
+            for (uint32_t j = 0; j < live[v]; ++j) {
+                const uint32_t t = adjacency[offsets[v] + j];
+                const uint32_t *adj = &input[(size_t) t * 3];
+                tri_score[t] = score[adj[0]] + score[adj[1]] + score[adj[2]];
+                if (tri_score[t] > best_score) {
+                    best_score = tri_score[t];
+                    best = t;
+                }
+            }
+        }
+
+        cache_count = next_count < GWR_MESH_OPT_CACHE_SIZE ? next_count : GWR_MESH_OPT_CACHE_SIZE;
+        memcpy(cache, next, cache_count * sizeof(uint32_t));
+    }
+
+cleanup:
+    free(offsets);
+    free(live);
+    free(adjacency);
+    free(cache_pos);
+    free(score);
+    free(tri_score);
+    free(emitted);
+    free(input);
+    return ok;
+}
+
+bool GWR_mesh_opt_overdraw(
+    uint32_t *dst, const uint32_t *indices, size_t index_count,
+    const void *vertices, size_t vertex_count, size_t stride
+) {
+    assert(dst);
+    assert(indices || !index_count);
+    assert(vertices || !vertex_count);
+    assert(index_count % 3 == 0);
+
+    const size_t tri_count = index_count / 3;
+    if (!tri_count) {
+        return true;
+    }
+
+    // one extra slot: a patch briefly holds a trailing boundary before it is merged
+    cluster_t *clusters = malloc((tri_count + 1) * sizeof(cluster_t));
+    uint32_t *patches = malloc(tri_count * sizeof(uint32_t));
+    uint32_t *stamp = malloc(vertex_count * sizeof(uint32_t));
+    uint32_t *input = malloc(index_count * sizeof(uint32_t));
+    if (!clusters || !patches || !stamp || !input) {
+        MESH_OPT_LOG(GWR_LOG_ERROR, "failed to allocate overdraw tables");
+        free(clusters);
+        free(patches);
+        free(stamp);
+        free(input);
+        return false;
+    }
+    memcpy(input, indices, index_count * sizeof(uint32_t));
+
+    // hard boundaries: a triangle missing all three vertices starts a patch
+    // that shares nothing with the cache state before it
+    memset(stamp, 0, vertex_count * sizeof(uint32_t));
+    uint32_t time = GWR_MESH_OPT_FIFO_SIZE + 1;
+    size_t patch_count = 0;
+    for (size_t t = 0; t < tri_count; ++t) {
+        if (fifo_misses(stamp, &time, &input[t * 3]) == 3 || t == 0) {
+            patches[patch_count++] = (uint32_t) t;
+        }
+    }
+
+    // soft boundaries: a cache-optimised mesh is mostly one patch, so split it
+    // wherever the acmr so far is already close to the patch's own; reordering
+    // such clusters costs little vertex cache efficiency
+    size_t cluster_count = 0;
+    for (size_t p = 0; p < patch_count; ++p) {
+        const size_t start = patches[p];
+        const size_t end = p + 1 < patch_count ? patches[p + 1] : tri_count;
+
+        time += GWR_MESH_OPT_FIFO_SIZE + 1;
+        uint32_t patch_misses = 0;
+        for (size_t t = start; t < end; ++t) {
+            patch_misses += (uint32_t) fifo_misses(stamp, &time, &input[t * 3]);
+        }
+        const float threshold = OVERDRAW_ACMR_THRESHOLD * (float) patch_misses / (float) (end - start);
+
+        clusters[cluster_count++] = (cluster_t) {.first = (uint32_t) start};
+        time += GWR_MESH_OPT_FIFO_SIZE + 1;
+        uint32_t run_misses = 0;
+        uint32_t run_tris = 0;
+        for (size_t t = start; t < end; ++t) {
+            run_misses += (uint32_t) fifo_misses(stamp, &time, &input[t * 3]);
+            ++run_tris;
+            if ((float) run_misses <= threshold * (float) run_tris) {
+                clusters[cluster_count++] = (cluster_t) {.first = (uint32_t) (t + 1)};
+                time += GWR_MESH_OPT_FIFO_SIZE + 1;
+                run_misses = 0;
+                run_tris = 0;
+            }
+        }
+        // the tail after the last split has a poor acmr of its own; fold it
+        // into the cluster before (this also drops a boundary sitting at `end`)
+        if (clusters[cluster_count - 1].first != start) {
+            --cluster_count;
+        }
+    }
+    for (size_t c = 0; c < cluster_count; ++c) {
+        const size_t next = c + 1 < cluster_count ? clusters[c + 1].first : tri_count;
+        clusters[c].count = (uint32_t) (next - clusters[c].first);
+    }
+    free(patches);
+
+    // cluster normals, the mesh centroid is accumulated area weighted on the way
+    float *normals = malloc(cluster_count * 3 * sizeof(float));
+    if (!normals) {
+        MESH_OPT_LOG(GWR_LOG_ERROR, "failed to allocate overdraw tables");
+        free(clusters);
+        free(stamp);
+        free(input);
+        return false;
+    }
+
+    float mesh_center[3] = {0.f, 0.f, 0.f};
+    float mesh_area = 0.f;
+    for (size_t c = 0; c < cluster_count; ++c) {
+        float center[3] = {0.f, 0.f, 0.f};
+        float *normal = &normals[c * 3];
+        float area = 0.f;
+        normal[0] = normal[1] = normal[2] = 0.f;
+
+        for (uint32_t t = clusters[c].first; t < clusters[c].first + clusters[c].count; ++t) {
+            const float *a = position(vertices, stride, input[t * 3]);
+            const float *b = position(vertices, stride, input[t * 3 + 1]);
+            const float *p = position(vertices, stride, input[t * 3 + 2]);
+            const float e0[3] = {b[0] - a[0], b[1] - a[1], b[2] - a[2]};
+            const float e1[3] = {p[0] - a[0], p[1] - a[1], p[2] - a[2]};
+            const float n[3] = {
+                e0[1] * e1[2] - e0[2] * e1[1],
+                e0[2] * e1[0] - e0[0] * e1[2],
+                e0[0] * e1[1] - e0[1] * e1[0],
+            };
+            const float w = sqrtf(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]) * 0.5f;
+            for (int k = 0; k < 3; ++k) {
+                center[k] += (a[k] + b[k] + p[k]) * (w / 3.f);
+                normal[k] += n[k];
+            }
+            area += w;
+        }
+
+        for (int k = 0; k < 3; ++k) {
+            mesh_center[k] += center[k];
+        }
+        mesh_area += area;
+
+        const float len = sqrtf(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+        if (len > 0.f) {
+            normal[0] /= len, normal[1] /= len, normal[2] /= len;
+        }
+        // dot(cluster centre, normal); the mesh centre term is subtracted below
+        clusters[c].key = area > 0.f
+            ? (center[0] * normal[0] + center[1] * normal[1] + center[2] * normal[2]) / area
+            : 0.f;
+    }
+    for (int k = 0; k < 3; ++k) {
+        mesh_center[k] = mesh_area > 0.f ? mesh_center[k] / mesh_area : 0.f;
+    }
+
+    // clusters facing away from the centre tend to occlude the rest, draw them first
+    for (size_t c = 0; c < cluster_count; ++c) {
+        const float *n = &normals[c * 3];
+        clusters[c].key -= mesh_center[0] * n[0] + mesh_center[1] * n[1] + mesh_center[2] * n[2];
+    }
+    qsort(clusters, cluster_count, sizeof(cluster_t), cmp_cluster);
+
+    size_t out = 0;
+    for (size_t c = 0; c < cluster_count; ++c) {
+        const size_t n = (size_t) clusters[c].count * 3;
+        memcpy(&dst[out], &input[(size_t) clusters[c].first * 3], n * sizeof(uint32_t));
+        out += n;
+    }
+
+    free(normals);
+    free(clusters);
+    free(stamp);
+    free(input);
+    return true;
+}
+
+size_t GWR_mesh_opt_vertex_fetch(
+    void *dst, const void *vertices, size_t vertex_count, size_t stride,
+    uint32_t *indices, size_t index_count
+) {
+    assert(dst);
+    assert(dst != vertices);
+    assert(vertices || !vertex_count);
+    assert(indices || !index_count);
+
+    uint32_t *remap = malloc(vertex_count * sizeof(uint32_t));
+    if (!remap) {
+        MESH_OPT_LOG(GWR_LOG_ERROR, "failed to allocate fetch remap");
+        memcpy(dst, vertices, vertex_count * stride);
+        return vertex_count;
+    }
+    memset(remap, 0xff, vertex_count * sizeof(uint32_t));
+
+    const unsigned char *src = vertices;
+    unsigned char *out = dst;
+    uint32_t next = 0;
+    for (size_t i = 0; i < index_count; ++i) {
+        const uint32_t v = indices[i];
+        assert(v < vertex_count);
+        if (remap[v] == UINT32_MAX) {
+            memcpy(out + (size_t) next * stride, src + (size_t) v * stride, stride);
+            remap[v] = next++;
+        }
+        indices[i] = remap[v];
+    }
+
+    free(remap);
+    return next;
+}
+
+float GWR_mesh_opt_acmr(const uint32_t *indices, size_t index_count, size_t vertex_count) {
+    assert(indices || !index_count);
+
+    if (index_count < 3) {
+        return 0.f;
+    }
+
+    uint32_t *stamp = calloc(vertex_count, sizeof(uint32_t));
+    if (!stamp) {
+        MESH_OPT_LOG(GWR_LOG_ERROR, "failed to allocate acmr table");
+        return 0.f;
+    }
+
+    uint32_t time = GWR_MESH_OPT_FIFO_SIZE + 1;
+    size_t misses = 0;
+    for (size_t i = 0; i < index_count; ++i) {
+        const uint32_t v = indices[i];
+        if (time - stamp[v] > GWR_MESH_OPT_FIFO_SIZE) {
+            stamp[v] = time++;
+            ++misses;
+        }
+    }
+
+    free(stamp);
+    return (float) misses / (float) (index_count / 3);
+}
+
+GLenum GWR_mesh_opt_index_type(size_t vertex_count) {
+    // 8-bit indices are emulated on a lot of hardware, 0xFFFF stays free for primitive restart
+    return vertex_count <= UINT16_MAX ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+}
+
+size_t GWR_mesh_opt_pack_indices(void *dst, const uint32_t *indices, size_t index_count, GLenum type) {
+    assert(dst);
+    assert(indices || !index_count);
+
+    switch (type) {
+        case GL_UNSIGNED_BYTE: {
+            uint8_t *out = dst;
+            // front to back is safe in place, every write lands at or before its read
+            for (size_t i = 0; i < index_count; ++i) {
+                assert(indices[i] <= UINT8_MAX);
+                out[i] = (uint8_t) indices[i];
+            }
+            return index_count * sizeof(uint8_t);
+        }
+        case GL_UNSIGNED_SHORT: {
+            uint16_t *out = dst;
+            for (size_t i = 0; i < index_count; ++i) {
+                assert(indices[i] <= UINT16_MAX);
+                out[i] = (uint16_t) indices[i];
+            }
+            return index_count * sizeof(uint16_t);
+        }
+        case GL_UNSIGNED_INT:
+            if (dst != indices) {
+                memmove(dst, indices, index_count * sizeof(uint32_t));
+            }
+            return index_count * sizeof(uint32_t);
+        default:
+            MESH_OPT_LOG(GWR_LOG_ERROR, "unsupported index type 0x%x", type);
+            return 0;
+    }
+}
+
+GWR_element_buffer_t *GWR_mesh_opt_create_element_buffer(
+    const uint32_t *indices, size_t index_count, size_t vertex_count, GLenum usage
+) {
+    assert(indices);
+
+    const GLenum type = GWR_mesh_opt_index_type(vertex_count);
+    if (type == GL_UNSIGNED_INT) {
+        return GWR_element_buffer_create_typed(
+            indices, (GLsizeiptr) (index_count * sizeof(uint32_t)), type, usage
+        );
+    }
+
+    void *packed = malloc(index_count * sizeof(uint16_t));
+    if (!packed) {
+        MESH_OPT_LOG(GWR_LOG_ERROR, "failed to allocate %zu packed indices", index_count);
+        return NULL;
+    }
+    const size_t size = GWR_mesh_opt_pack_indices(packed, indices, index_count, type);
+    GWR_element_buffer_t *ebo = GWR_element_buffer_create_typed(packed, (GLsizeiptr) size, type, usage);
+    free(packed);
+    return ebo;
+}
+
+// inner funcs defs
+
+static float vertex_score(int cache_pos, uint32_t live) {
+    if (live == 0) {
+        // no triangles left to draw with it
+        return -1.f;
+    }
+
+    float score = 0.f;
+    if (cache_pos >= 0) {
+        if (cache_pos < 3) {
+            // part of the last triangle, deliberately not the best choice to avoid strips
+            score = FORSYTH_LAST_TRI_SCORE;
+        } else {
+            const float scaler = 1.f / (GWR_MESH_OPT_CACHE_SIZE - 3);
+            score = powf(1.f - (float) (cache_pos - 3) * scaler, FORSYTH_CACHE_DECAY_POWER);
+        }
+    }
+
+    // finish off vertices with few triangles left so they do not linger
+    score += FORSYTH_VALENCE_BOOST_SCALE * powf((float) live, -FORSYTH_VALENCE_BOOST_POWER);
+    return score;
+}
+
+static const float *position(const void *vertices, size_t stride, uint32_t idx) {
+    return (const float *) ((const unsigned char *) vertices + (size_t) idx * stride);
+}
+
+static int fifo_misses(uint32_t *stamp, uint32_t *time, const uint32_t *tri) {
+    int misses = 0;
+    for (int k = 0; k < 3; ++k) {
+        if (*time - stamp[tri[k]] > GWR_MESH_OPT_FIFO_SIZE) {
+            stamp[tri[k]] = (*time)++;
+            ++misses;
+        }
+    }
+    return misses;
+}
+
+static int cmp_cluster(const void *a, const void *b) {
+    const cluster_t *ca = a;
+    const cluster_t *cb = b;
+    if (ca->key != cb->key) {
+        return ca->key > cb->key ? -1 : 1;
+    }
+    // stable for equal keys
+    return ca->first < cb->first ? -1 : (ca->first > cb->first);
+}
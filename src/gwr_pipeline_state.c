@@ -0,0 +1,510 @@
+#include "internal/gwr_pipeline_state.h"
+#include "internal/gwr_log.h"
+#include "internal/gwr_util.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+#define PSTATE_LOG(level, msg, ...)    GWR_LOG_AT(GWR_LOG_SYS_PIPELINE_STATE, (level), msg, ##__VA_ARGS__)
+
+#define PSTATE_CACHE_INITIAL_CAPACITY 16
+#define PSTATE_MAX_STATES UINT16_MAX
+
+
+struct GWR_pipeline_state_t {
+    GWR_pipeline_state_desc_t desc;
+    uint64_t hash;
+    uint16_t id;
+    GWR_pipeline_state_cache_t *cache;
+};
+
+struct GWR_pipeline_state_cache_t {
+    GWR_pipeline_state_t **states;  // by id - 1
+    size_t count;
+    size_t capacity;
+
+    // open addressing on state->hash, linear probing, NULL is empty
+    GWR_pipeline_state_t **slots;
+    size_t slot_cap;                // power of two, kept at least twice count
+
+    // mirrors the GL context; only meaningful while `applied_valid`
+    GWR_pipeline_state_desc_t applied;
+    bool applied_cull;
+    bool applied_valid;
+    const GWR_pipeline_state_t *last;
+
+    GWR_pipeline_state_stats_t stats;
+};
+
+// inner funcs decls
+
+static GWR_pipeline_state_desc_t normalize(const GWR_pipeline_state_desc_t *desc);
+static uint64_t hash_desc(const GWR_pipeline_state_desc_t *desc);
+static bool desc_equal(const GWR_pipeline_state_desc_t *a, const GWR_pipeline_state_desc_t *b);
+static const GWR_pipeline_state_t *find(const GWR_pipeline_state_cache_t *cache, const GWR_pipeline_state_desc_t *desc, uint64_t hash);
+static bool reserve_slot(GWR_pipeline_state_cache_t *cache);
+static void insert_slot(GWR_pipeline_state_cache_t *cache, GWR_pipeline_state_t *state);
+static void apply_diff(GWR_pipeline_state_cache_t *cache, const GWR_pipeline_state_desc_t *desc, bool force);
+static void set_cap(GLenum cap, bool enable);
+
+// public funcs defs
+
+GWR_pipeline_state_desc_t GWR_pipeline_state_desc_default(void) {
+    return (GWR_pipeline_state_desc_t) {
+        .blend_enable = false,
+        .blend_src_rgb = GL_ONE,
+        .blend_dst_rgb = GL_ZERO,
+        .blend_src_alpha = GL_ONE,
+        .blend_dst_alpha = GL_ZERO,
+        .blend_op_rgb = GL_FUNC_ADD,
+        .blend_op_alpha = GL_FUNC_ADD,
+        .color_write = {true, true, true, true},
+
+        .depth_test = false,
+        .depth_write = true,
+        .depth_func = GL_LESS,
+
+        .stencil_test = false,
+        .stencil_func = GL_ALWAYS,
+        .stencil_ref = 0,
+        .stencil_read_mask = 0xFFFFFFFFu,
+        .stencil_write_mask = 0xFFFFFFFFu,
+        .stencil_fail = GL_KEEP,
+        .stencil_depth_fail = GL_KEEP,
+        .stencil_pass = GL_KEEP,
+
+        .cull_face = GL_NONE,
+        .front_face = GL_CCW,
+        .polygon_mode = GL_FILL,
+
+        .polygon_offset = false,
+        .polygon_offset_factor = 0.f,
+        .polygon_offset_units = 0.f,
+    };
+}
+
+GWR_pipeline_state_cache_t *GWR_pipeline_state_cache_create(void) {
+    GWR_pipeline_state_cache_t *cache = calloc(1, sizeof(GWR_pipeline_state_cache_t));
+    if (!cache) {
+        PSTATE_LOG(GWR_LOG_ERROR, "failed to allocate GWR_pipeline_state_cache_t");
+        return NULL;
+    }
+
+    cache->states = malloc(PSTATE_CACHE_INITIAL_CAPACITY * sizeof(GWR_pipeline_state_t *));
+    cache->slots = calloc(PSTATE_CACHE_INITIAL_CAPACITY * 2, sizeof(GWR_pipeline_state_t *));
+    if (!cache->states || !cache->slots) {
+        PSTATE_LOG(GWR_LOG_ERROR, "failed to allocate states");
+        free(cache->states);
+        free(cache->slots);
+        free(cache);
+        return NULL;
+    }
+    cache->capacity = PSTATE_CACHE_INITIAL_CAPACITY;
+    cache->slot_cap = PSTATE_CACHE_INITIAL_CAPACITY * 2;
+
+    return cache;
+}
+
+void GWR_pipeline_state_cache_destroy(GWR_pipeline_state_cache_t *cache) {
+    assert(cache);
+
+    for (size_t i = 0; i < cache->count; ++i) {
+        free(cache->states[i]);
+    }
+    free(cache->states);
+    free(cache->slots);
+    free(cache);
+}
+
+const GWR_pipeline_state_t *GWR_pipeline_state_cache_get(
+    GWR_pipeline_state_cache_t *cache,
+    const GWR_pipeline_state_desc_t *desc
+) {
+    assert(cache);
+    assert(desc);
+
+    ++cache->stats.requests;
+
+    const GWR_pipeline_state_desc_t norm = normalize(desc);
+    const uint64_t hash = hash_desc(&norm);
+
+    const GWR_pipeline_state_t *found = find(cache, &norm, hash);
+    if (found) {
+        ++cache->stats.hits;
+        return found;
+    }
+
+    if (cache->count == PSTATE_MAX_STATES) {
+        PSTATE_LOG(GWR_LOG_ERROR, "too many pipeline states (%d)", PSTATE_MAX_STATES);
+        return NULL;
+    }
+
+    if (cache->count == cache->capacity) {
+        const size_t new_capacity = cache->capacity * 2;
+        GWR_pipeline_state_t **states = realloc(cache->states, new_capacity * sizeof(GWR_pipeline_state_t *));
+        if (!states) {
+            PSTATE_LOG(GWR_LOG_ERROR, "failed to grow states");
+            return NULL;
+        }
+        cache->states = states;
+        cache->capacity = new_capacity;
+    }
+    if (!reserve_slot(cache)) {
+        PSTATE_LOG(GWR_LOG_ERROR, "failed to grow state index");
+        return NULL;
+    }
+
+    GWR_pipeline_state_t *state = calloc(1, sizeof(GWR_pipeline_state_t));
+    if (!state) {
+        PSTATE_LOG(GWR_LOG_ERROR, "failed to allocate GWR_pipeline_state_t");
+        return NULL;
+    }
+    state->desc = norm;
+    state->hash = hash;
+    state->id = (uint16_t) (cache->count + 1);
+    state->cache = cache;
+
+    cache->states[cache->count++] = state;
+    insert_slot(cache, state);
+
+    return state;
+}
+
+void GWR_pipeline_state_cache_invalidate(GWR_pipeline_state_cache_t *cache) {
+    assert(cache);
+
+    cache->applied_valid = false;
+    cache->last = NULL;
+}
+
+GWR_pipeline_state_stats_t GWR_pipeline_state_cache_get_stats(const GWR_pipeline_state_cache_t *cache) {
+    assert(cache);
+
+    return cache->stats;
+}
+
+void GWR_pipeline_state_apply(const GWR_pipeline_state_t *state) {
+    assert(state);
+
+    GWR_pipeline_state_cache_t *cache = state->cache;
+    ++cache->stats.applies;
+
+    if (cache->last == state) {
+        ++cache->stats.redundant_applies;
+        return;
+    }
+
+    apply_diff(cache, &state->desc, !cache->applied_valid);
+    cache->applied_valid = true;
+    cache->last = state;
+}
+
+uint16_t GWR_pipeline_state_get_id(const GWR_pipeline_state_t *state) {
+    assert(state);
+
+    return state->id;
+}
+
+const GWR_pipeline_state_desc_t *GWR_pipeline_state_get_desc(const GWR_pipeline_state_t *state) {
+    assert(state);
+
+    return &state->desc;
+}
+
+// inner funcs defs
+
+// fields a disabled group ignores are reset to defaults, so descriptors that
+// only differ there intern to one state
+static GWR_pipeline_state_desc_t normalize(const GWR_pipeline_state_desc_t *desc) {
+    const GWR_pipeline_state_desc_t def = GWR_pipeline_state_desc_default();
+    GWR_pipeline_state_desc_t n = *desc;
+
+    if (!n.blend_enable) {
+        n.blend_src_rgb = def.blend_src_rgb;
+        n.blend_dst_rgb = def.blend_dst_rgb;
+        n.blend_src_alpha = def.blend_src_alpha;
+        n.blend_dst_alpha = def.blend_dst_alpha;
+        n.blend_op_rgb = def.blend_op_rgb;
+        n.blend_op_alpha = def.blend_op_alpha;
+    }
+    if (!n.depth_test) {
+        n.depth_func = def.depth_func;
+    }
+    if (!n.stencil_test) {
+        n.stencil_func = def.stencil_func;
+        n.stencil_ref = def.stencil_ref;
+        n.stencil_read_mask = def.stencil_read_mask;
+        n.stencil_fail = def.stencil_fail;
+        n.stencil_depth_fail = def.stencil_depth_fail;
+        n.stencil_pass = def.stencil_pass;
+    }
+    if (n.cull_face == GL_NONE) {
+        n.front_face = def.front_face;
+    }
+    if (!n.polygon_offset) {
+        n.polygon_offset_factor = def.polygon_offset_factor;
+        n.polygon_offset_units = def.polygon_offset_units;
+    }
+    // adding 0.f turns -0.f into +0.f, which desc_equal already treats as equal
+    n.polygon_offset_factor += 0.f;
+    n.polygon_offset_units += 0.f;
+
+    return n;
+}
+
+static uint64_t hash_u32(uint64_t h, uint32_t v) {
+    return GWR_fnv1a(h, &v, sizeof(v));
+}
+
+static uint64_t hash_f32(uint64_t h, float v) {
+    uint32_t bits;
+    memcpy(&bits, &v, sizeof(bits));
+    return hash_u32(h, bits);
+}
+
+// every field widened to 32 bits; the bools and enums leave holes in the struct
+static uint64_t hash_desc(const GWR_pipeline_state_desc_t *d) {
+    uint64_t h = GWR_FNV_OFFSET;
+
+    h = hash_u32(h, d->blend_enable);
+    h = hash_u32(h, d->blend_src_rgb);
+    h = hash_u32(h, d->blend_dst_rgb);
+    h = hash_u32(h, d->blend_src_alpha);
+    h = hash_u32(h, d->blend_dst_alpha);
+    h = hash_u32(h, d->blend_op_rgb);
+    h = hash_u32(h, d->blend_op_alpha);
+    h = hash_u32(h, d->color_write[0] | d->color_write[1] << 1 | d->color_write[2] << 2 | d->color_write[3] << 3);
+
+    h = hash_u32(h, d->depth_test);
+    h = hash_u32(h, d->depth_write);
+    h = hash_u32(h, d->depth_func);
+
+    h = hash_u32(h, d->stencil_test);
+    h = hash_u32(h, d->stencil_func);
+    h = hash_u32(h, (uint32_t) d->stencil_ref);
+    h = hash_u32(h, d->stencil_read_mask);
+    h = hash_u32(h, d->stencil_write_mask);
+    h = hash_u32(h, d->stencil_fail);
+    h = hash_u32(h, d->stencil_depth_fail);
+    h = hash_u32(h, d->stencil_pass);
+
+    h = hash_u32(h, d->cull_face);
+    h = hash_u32(h, d->front_face);
+    h = hash_u32(h, d->polygon_mode);
+
+    h = hash_u32(h, d->polygon_offset);
+    h = hash_f32(h, d->polygon_offset_factor);
+    h = hash_f32(h, d->polygon_offset_units);
+
+    return h;
+}
+
+static bool desc_equal(const GWR_pipeline_state_desc_t *a, const GWR_pipeline_state_desc_t *b) {
+    return a->blend_enable == b->blend_enable &&
+           a->blend_src_rgb == b->blend_src_rgb &&
+           a->blend_dst_rgb == b->blend_dst_rgb &&
+           a->blend_src_alpha == b->blend_src_alpha &&
+           a->blend_dst_alpha == b->blend_dst_alpha &&
+           a->blend_op_rgb == b->blend_op_rgb &&
+           a->blend_op_alpha == b->blend_op_alpha &&
+           memcmp(a->color_write, b->color_write, sizeof(a->color_write)) == 0 &&
+           a->depth_test == b->depth_test &&
+           a->depth_write == b->depth_write &&
+           a->depth_func == b->depth_func &&
+           a->stencil_test == b->stencil_test &&
+           a->stencil_func == b->stencil_func &&
+           a->stencil_ref == b->stencil_ref &&
+           a->stencil_read_mask == b->stencil_read_mask &&
+           a->stencil_write_mask == b->stencil_write_mask &&
+           a->stencil_fail == b->stencil_fail &&
+           a->stencil_depth_fail == b->stencil_depth_fail &&
+           a->stencil_pass == b->stencil_pass &&
+           a->cull_face == b->cull_face &&
+           a->front_face == b->front_face &&
+           a->polygon_mode == b->polygon_mode &&
+           a->polygon_offset == b->polygon_offset &&
+           a->polygon_offset_factor == b->polygon_offset_factor &&
+           a->polygon_offset_units == b->polygon_offset_units;
+}
+
+static const GWR_pipeline_state_t *find(const GWR_pipeline_state_cache_t *cache, const GWR_pipeline_state_desc_t *desc, uint64_t hash) {
+    const size_t mask = cache->slot_cap - 1;
+    for (size_t i = hash & mask; cache->slots[i]; i = (i + 1) & mask) {
+        const GWR_pipeline_state_t *s = cache->slots[i];
+        if (s->hash == hash && desc_equal(&s->desc, desc)) {
+            return s;
+        }
+    }
+    return NULL;
+}
+
+// makes room for one more state, keeping the load factor under 1/2
+static bool reserve_slot(GWR_pipeline_state_cache_t *cache) {
+    if ((cache->count + 1) * 2 <= cache->slot_cap) {
+        return true;
+    }
+
+    const size_t new_cap = cache->slot_cap * 2;
+    GWR_pipeline_state_t **slots = calloc(new_cap, sizeof(GWR_pipeline_state_t *));
+    if (!slots) {
+        return false;
+    }
+    free(cache->slots);
+    cache->slots = slots;
+    cache->slot_cap = new_cap;
+    // states[] holds every state, so the index is simply rebuilt from it
+    for (size_t i = 0; i < cache->count; ++i) {
+        insert_slot(cache, cache->states[i]);
+    }
+    return true;
+}
+
+static void insert_slot(GWR_pipeline_state_cache_t *cache, GWR_pipeline_state_t *state) {
+    const size_t mask = cache->slot_cap - 1;
+    size_t i = state->hash & mask;
+    while (cache->slots[i]) {
+        i = (i + 1) & mask;
+    }
+    cache->slots[i] = state;
+}
+
+// fields of a disabled group are left as they are unless `force`, which sets
+// every field so `applied` matches GL afterwards
+static void apply_diff(GWR_pipeline_state_cache_t *cache, const GWR_pipeline_state_desc_t *d, bool force) {
+    GWR_pipeline_state_desc_t *a = &cache->applied;
+    uint64_t calls = 0;
+
+    if (force || a->blend_enable != d->blend_enable) {
+        set_cap(GL_BLEND, d->blend_enable);
+        a->blend_enable = d->blend_enable;
+        ++calls;
+    }
+    if (force || d->blend_enable) {
+        if (force ||
+            a->blend_src_rgb != d->blend_src_rgb || a->blend_dst_rgb != d->blend_dst_rgb ||
+            a->blend_src_alpha != d->blend_src_alpha || a->blend_dst_alpha != d->blend_dst_alpha) {
+            glBlendFuncSeparate(d->blend_src_rgb, d->blend_dst_rgb, d->blend_src_alpha, d->blend_dst_alpha);
+            a->blend_src_rgb = d->blend_src_rgb;
+            a->blend_dst_rgb = d->blend_dst_rgb;
+            a->blend_src_alpha = d->blend_src_alpha;
+            a->blend_dst_alpha = d->blend_dst_alpha;
+            ++calls;
+        }
+        if (force || a->blend_op_rgb != d->blend_op_rgb || a->blend_op_alpha != d->blend_op_alpha) {
+            glBlendEquationSeparate(d->blend_op_rgb, d->blend_op_alpha);
+            a->blend_op_rgb = d->blend_op_rgb;
+            a->blend_op_alpha = d->blend_op_alpha;
+            ++calls;
+        }
+    }
+    if (force || memcmp(a->color_write, d->color_write, sizeof(d->color_write)) != 0) {
+        glColorMask(d->color_write[0], d->color_write[1], d->color_write[2], d->color_write[3]);
+        memcpy(a->color_write, d->color_write, sizeof(d->color_write));
+        ++calls;
+    }
+
+    if (force || a->depth_test != d->depth_test) {
+        set_cap(GL_DEPTH_TEST, d->depth_test);
+        a->depth_test = d->depth_test;
+        ++calls;
+    }
+    if (force || (d->depth_test && a->depth_func != d->depth_func)) {
+        glDepthFunc(d->depth_func);
+        a->depth_func = d->depth_func;
+        ++calls;
+    }
+    // the depth mask also guards glClear, so it is applied even with the test off
+    if (force || a->depth_write != d->depth_write) {
+        glDepthMask(d->depth_write ? GL_TRUE : GL_FALSE);
+        a->depth_write = d->depth_write;
+        ++calls;
+    }
+
+    if (force || a->stencil_test != d->stencil_test) {
+        set_cap(GL_STENCIL_TEST, d->stencil_test);
+        a->stencil_test = d->stencil_test;
+        ++calls;
+    }
+    if (force || d->stencil_test) {
+        if (force ||
+            a->stencil_func != d->stencil_func || a->stencil_ref != d->stencil_ref ||
+            a->stencil_read_mask != d->stencil_read_mask) {
+            glStencilFunc(d->stencil_func, d->stencil_ref, d->stencil_read_mask);
+            a->stencil_func = d->stencil_func;
+            a->stencil_ref = d->stencil_ref;
+            a->stencil_read_mask = d->stencil_read_mask;
+            ++calls;
+        }
+        if (force ||
+            a->stencil_fail != d->stencil_fail || a->stencil_depth_fail != d->stencil_depth_fail ||
+            a->stencil_pass != d->stencil_pass) {
+            glStencilOp(d->stencil_fail, d->stencil_depth_fail, d->stencil_pass);
+            a->stencil_fail = d->stencil_fail;
+            a->stencil_depth_fail = d->stencil_depth_fail;
+            a->stencil_pass = d->stencil_pass;
+            ++calls;
+        }
+    }
+    if (force || a->stencil_write_mask != d->stencil_write_mask) {
+        glStencilMask(d->stencil_write_mask);
+        a->stencil_write_mask = d->stencil_write_mask;
+        ++calls;
+    }
+
+    const bool cull = d->cull_face != GL_NONE;
+    if (force || cache->applied_cull != cull) {
+        set_cap(GL_CULL_FACE, cull);
+        cache->applied_cull = cull;
+        ++calls;
+    }
+    if (cull) {
+        if (force || a->cull_face != d->cull_face) {
+            glCullFace(d->cull_face);
+            a->cull_face = d->cull_face;
+            ++calls;
+        }
+        if (force || a->front_face != d->front_face) {
+            glFrontFace(d->front_face);
+            a->front_face = d->front_face;
+            ++calls;
+        }
+    } else if (force) {
+        glFrontFace(d->front_face);
+        a->front_face = d->front_face;
+        // glCullFace(GL_NONE) is invalid; a stale face is set again on enable
+        a->cull_face = GL_NONE;
+        ++calls;
+    }
+
+    if (force || a->polygon_mode != d->polygon_mode) {
+        glPolygonMode(GL_FRONT_AND_BACK, d->polygon_mode);
+        a->polygon_mode = d->polygon_mode;
+        ++calls;
+    }
+
+    if (force || a->polygon_offset != d->polygon_offset) {
+        set_cap(GL_POLYGON_OFFSET_FILL, d->polygon_offset);
+        a->polygon_offset = d->polygon_offset;
+        ++calls;
+    }
+    if (force ||
+        (d->polygon_offset &&
+         (a->polygon_offset_factor != d->polygon_offset_factor ||
+          a->polygon_offset_units != d->polygon_offset_units))) {
+        glPolygonOffset(d->polygon_offset_factor, d->polygon_offset_units);
+        a->polygon_offset_factor = d->polygon_offset_factor;
+        a->polygon_offset_units = d->polygon_offset_units;
+        ++calls;
+    }
+
+    cache->stats.gl_calls += calls;
+}
+
+static void set_cap(GLenum cap, bool enable) {
+    if (enable) {
+        glEnable(cap);
+    } else {
+        glDisable(cap);
+    }
+}
@@ -0,0 +1,312 @@
+#include "internal/gwr_program_pipeline.h"
+#include "internal/gwr_log.h"
+#include "internal/gwr_cap.h"
+#include "internal/gwr_debug.h"
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <assert.h>
+
+#define PIPELINE_LOG(level, msg, ...)    GWR_LOG_AT(GWR_LOG_SYS_PROGRAM_PIPELINE, (level), msg, ##__VA_ARGS__)
+
+#define PIPELINE_CACHE_INITIAL_CAPACITY 16
+#define PIPELINE_INFO_LOG_SIZE 1024
+
+struct GWR_program_pipeline_t {
+    GLuint id;
+};
+
+typedef struct {
+    GLuint vertex;
+    GLuint fragment;
+    uint64_t hash;
+    GWR_program_pipeline_t *pipeline;
+} pipeline_entry_t;
+
+struct GWR_program_pipeline_cache_t {
+    pipeline_entry_t *entries;
+    size_t count;
+    size_t capacity;
+
+    // open addressing on entry hashes, linear probing; entry indices, -1 is empty
+    int *slots;
+    size_t slot_cap;        // power of two, kept at least twice count
+    GWR_program_pipeline_cache_stats_t stats;
+};
+
+// inner funcs decls
+
+static uint64_t hash_key(GLuint vertex, GLuint fragment);
+static int find(const GWR_program_pipeline_cache_t *cache, GLuint vertex, GLuint fragment, uint64_t hash);
+static bool reserve_slot(GWR_program_pipeline_cache_t *cache);
+static void insert_slot(GWR_program_pipeline_cache_t *cache, int idx);
+static void rebuild_slots(GWR_program_pipeline_cache_t *cache);
+
+// public funcs defs
+
+GWR_program_pipeline_t *GWR_program_pipeline_create(void) {
+    GWR_program_pipeline_t *pipeline = calloc(1, sizeof(GWR_program_pipeline_t));
+    if (!pipeline) {
+        PIPELINE_LOG(GWR_LOG_ERROR, "failed to allocate GWR_program_pipeline_t");
+        return NULL;
+    }
+
+    if (GWR_cap_has(GWR_FEATURE_DIRECT_STATE_ACCESS)) {
+        glCreateProgramPipelines(1, &pipeline->id);
+    } else {
+        // the object only exists after its first bind
+        glGenProgramPipelines(1, &pipeline->id);
+        glBindProgramPipeline(pipeline->id);
+        glBindProgramPipeline(0);
+    }
+
+    if (!pipeline->id) {
+        PIPELINE_LOG(GWR_LOG_ERROR, "failed to create program pipeline");
+        free(pipeline);
+        return NULL;
+    }
+
+    GWR_debug_label(GL_PROGRAM_PIPELINE, pipeline->id, "program pipeline %u", pipeline->id);
+
+    return pipeline;
+}
+
+void GWR_program_pipeline_destroy(GWR_program_pipeline_t *pipeline) {
+    assert(pipeline);
+
+    glDeleteProgramPipelines(1, &pipeline->id);
+    free(pipeline);
+}
+
+void GWR_program_pipeline_set_stages(GWR_program_pipeline_t *pipeline, const GWR_shader_t *program) {
+    assert(pipeline);
+    assert(program);
+
+    const GLbitfield stages = GWR_shader_get_stages(program);
+    if (!stages) {
+        PIPELINE_LOG(GWR_LOG_ERROR, "program %u is not separable", GWR_shader_get_id(program));
+        return;
+    }
+
+    glUseProgramStages(pipeline->id, stages, GWR_shader_get_id(program));
+}
+
+void GWR_program_pipeline_clear_stages(GWR_program_pipeline_t *pipeline, GLbitfield stages) {
+    assert(pipeline);
+
+    glUseProgramStages(pipeline->id, stages, 0);
+}
+
+bool GWR_program_pipeline_validate(const GWR_program_pipeline_t *pipeline) {
+    assert(pipeline);
+
+    glValidateProgramPipeline(pipeline->id);
+
+    GLint ok = GL_FALSE;
+    glGetProgramPipelineiv(pipeline->id, GL_VALIDATE_STATUS, &ok);
+    if (!ok) {
+        GLchar info[PIPELINE_INFO_LOG_SIZE] = {0};
+        glGetProgramPipelineInfoLog(pipeline->id, sizeof(info), NULL, info);
+        PIPELINE_LOG(GWR_LOG_ERROR, "pipeline %u failed validation: %s", pipeline->id, info);
+    }
+    return ok == GL_TRUE;
+}
+
+void GWR_program_pipeline_bind(const GWR_program_pipeline_t *pipeline) {
+    assert(pipeline);
+
+    // a bound program takes precedence over the pipeline
+    glUseProgram(0);
+    glBindProgramPipeline(pipeline->id);
+}
+
+void GWR_program_pipeline_unbind(void) {
+    glBindProgramPipeline(0);
+}
+
+GLuint GWR_program_pipeline_get_id(const GWR_program_pipeline_t *pipeline) {
+    assert(pipeline);
+
+    return pipeline->id;
+}
+
+GWR_program_pipeline_cache_t *GWR_program_pipeline_cache_create(void) {
+    GWR_program_pipeline_cache_t *cache = calloc(1, sizeof(GWR_program_pipeline_cache_t));
+    if (!cache) {
+        PIPELINE_LOG(GWR_LOG_ERROR, "failed to allocate GWR_program_pipeline_cache_t");
+        return NULL;
+    }
+
+    cache->entries = malloc(PIPELINE_CACHE_INITIAL_CAPACITY * sizeof(pipeline_entry_t));
+    cache->slots = malloc(PIPELINE_CACHE_INITIAL_CAPACITY * 2 * sizeof(int));
+    if (!cache->entries || !cache->slots) {
+        PIPELINE_LOG(GWR_LOG_ERROR, "failed to allocate entries");
+        free(cache->entries);
+        free(cache->slots);
+        free(cache);
+        return NULL;
+    }
+    cache->capacity = PIPELINE_CACHE_INITIAL_CAPACITY;
+    cache->slot_cap = PIPELINE_CACHE_INITIAL_CAPACITY * 2;
+    memset(cache->slots, 0xff, cache->slot_cap * sizeof(int));
+
+    return cache;
+}
+
+void GWR_program_pipeline_cache_destroy(GWR_program_pipeline_cache_t *cache) {
+    assert(cache);
+
+    for (size_t i = 0; i < cache->count; ++i) {
+        GWR_program_pipeline_destroy(cache->entries[i].pipeline);
+    }
+    free(cache->entries);
+    free(cache->slots);
+    free(cache);
+}
+
+GWR_program_pipeline_t *GWR_program_pipeline_cache_get(
+    GWR_program_pipeline_cache_t *cache,
+    const GWR_shader_t *vertex,
+    const GWR_shader_t *fragment
+) {
+    assert(cache);
+    assert(vertex);
+    assert(fragment);
+
+    ++cache->stats.requests;
+
+    const GLuint vertex_id = GWR_shader_get_id(vertex);
+    const GLuint fragment_id = GWR_shader_get_id(fragment);
+    const uint64_t hash = hash_key(vertex_id, fragment_id);
+
+    const int found = find(cache, vertex_id, fragment_id, hash);
+    if (found >= 0) {
+        ++cache->stats.hits;
+        return cache->entries[found].pipeline;
+    }
+
+    if (!(GWR_shader_get_stages(vertex) & GL_VERTEX_SHADER_BIT) ||
+        !(GWR_shader_get_stages(fragment) & GL_FRAGMENT_SHADER_BIT)) {
+        PIPELINE_LOG(GWR_LOG_ERROR, "programs %u/%u are not separable vertex/fragment stages", vertex_id, fragment_id);
+        return NULL;
+    }
+
+    if (cache->count == cache->capacity) {
+        const size_t new_capacity = cache->capacity * 2;
+        pipeline_entry_t *entries = realloc(cache->entries, new_capacity * sizeof(pipeline_entry_t));
+        if (!entries) {
+            PIPELINE_LOG(GWR_LOG_ERROR, "failed to grow entries");
+            return NULL;
+        }
+        cache->entries = entries;
+        cache->capacity = new_capacity;
+    }
+    if (!reserve_slot(cache)) {
+        PIPELINE_LOG(GWR_LOG_ERROR, "failed to grow pipeline index");
+        return NULL;
+    }
+
+    GWR_program_pipeline_t *pipeline = GWR_program_pipeline_create();
+    if (!pipeline) {
+        return NULL;
+    }
+    glUseProgramStages(pipeline->id, GL_VERTEX_SHADER_BIT, vertex_id);
+    glUseProgramStages(pipeline->id, GL_FRAGMENT_SHADER_BIT, fragment_id);
+    // the stage programs carry the file names
+    GWR_debug_label(GL_PROGRAM_PIPELINE, pipeline->id, "program pipeline %u + %u", vertex_id, fragment_id);
+
+    cache->entries[cache->count++] = (pipeline_entry_t) {
+        .vertex = vertex_id,
+        .fragment = fragment_id,
+        .hash = hash,
+        .pipeline = pipeline,
+    };
+    insert_slot(cache, (int) cache->count - 1);
+    cache->stats.pipelines = cache->count;
+
+    return pipeline;
+}
+
+void GWR_program_pipeline_cache_evict(GWR_program_pipeline_cache_t *cache, const GWR_shader_t *program) {
+    assert(cache);
+    assert(program);
+
+    const GLuint id = GWR_shader_get_id(program);
+    const size_t count = cache->count;
+    for (size_t i = 0; i < cache->count;) {
+        pipeline_entry_t *e = &cache->entries[i];
+        if (e->vertex == id || e->fragment == id) {
+            GWR_program_pipeline_destroy(e->pipeline);
+            *e = cache->entries[--cache->count];
+        } else {
+            ++i;
+        }
+    }
+    if (cache->count != count) {
+        // removal moved entries around; evicting is rare, so reindex from scratch
+        rebuild_slots(cache);
+    }
+    cache->stats.pipelines = cache->count;
+}
+
+GWR_program_pipeline_cache_stats_t GWR_program_pipeline_cache_get_stats(const GWR_program_pipeline_cache_t *cache) {
+    assert(cache);
+
+    return cache->stats;
+}
+
+// inner funcs defs
+
+static uint64_t hash_key(GLuint vertex, GLuint fragment) {
+    uint64_t h = ((uint64_t) vertex << 32) | fragment;
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdull;
+    h ^= h >> 33;
+    return h;
+}
+
+static int find(const GWR_program_pipeline_cache_t *cache, GLuint vertex, GLuint fragment, uint64_t hash) {
+    const size_t mask = cache->slot_cap - 1;
+    for (size_t i = hash & mask; cache->slots[i] >= 0; i = (i + 1) & mask) {
+        const pipeline_entry_t *e = &cache->entries[cache->slots[i]];
+        if (e->hash == hash && e->vertex == vertex && e->fragment == fragment) {
+            return cache->slots[i];
+        }
+    }
+    return -1;
+}
+
+// makes room for one more entry, keeping the load factor under 1/2
+static bool reserve_slot(GWR_program_pipeline_cache_t *cache) {
+    if ((cache->count + 1) * 2 <= cache->slot_cap) {
+        return true;
+    }
+
+    const size_t new_cap = cache->slot_cap * 2;
+    int *slots = malloc(new_cap * sizeof(int));
+    if (!slots) {
+        return false;
+    }
+    free(cache->slots);
+    cache->slots = slots;
+    cache->slot_cap = new_cap;
+    rebuild_slots(cache);
+    return true;
+}
+
+static void insert_slot(GWR_program_pipeline_cache_t *cache, int idx) {
+    const size_t mask = cache->slot_cap - 1;
+    size_t i = cache->entries[idx].hash & mask;
+    while (cache->slots[i] >= 0) {
+        i = (i + 1) & mask;
+    }
+    cache->slots[i] = idx;
+}
+
+static void rebuild_slots(GWR_program_pipeline_cache_t *cache) {
+    memset(cache->slots, 0xff, cache->slot_cap * sizeof(int));
+    for (size_t i = 0; i < cache->count; ++i) {
+        insert_slot(cache, (int) i);
+    }
+}
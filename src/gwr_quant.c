@@ -0,0 +1,486 @@
+#include "internal/gwr_quant.h"
+#include "internal/gwr_log.h"
+#include "internal/gwr_util.h"
+#include "internal/gwr_math.h"
+
+#include <string.h>
+#include <float.h>
+#include <math.h>
+#include <assert.h>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__)) && defined(__SSE2__)
+#define QUANT_HAS_X86 1
+#include <immintrin.h>
+#define QUANT_TARGET_F16C __attribute__((target("avx2,f16c")))
+#else
+#define QUANT_HAS_X86 0
+#endif
+
+#define QUANT_LOG(level, msg, ...)    GWR_LOG_AT(GWR_LOG_SYS_QUANT, (level), msg, ##__VA_ARGS__)
+
+// vertices staged on the stack per batch call
+#define QUANT_CHUNK 64
+
+#define QUANT_SNORM16_MAX 32767.f
+#define QUANT_SNORM10_MAX 511.f
+
+typedef struct {
+    void (*half_n)(const float *, uint16_t *, size_t);
+    // out[i] = snorm16((in[i] - bias[i % 4]) * scale[i % 4]) over n groups of 4
+    void (*snorm16x4_n)(const float *, int16_t *, size_t, const float *, const float *);
+    void (*unorm8_n)(const float *, uint8_t *, size_t);
+    void (*oct_n)(const vec3 *, int16_t (*)[2], size_t);
+} quant_kernels_t;
+
+typedef struct {
+    uint8_t size;
+    uint8_t component;
+    uint8_t mode;
+    uint8_t normalized;
+    uint32_t bytes;
+} quant_format_info_t;
+
+static const quant_format_info_t s_formats[] = {
+    [GWR_QUANT_FLOAT32x3] = {3, GWR_MESH_COMPONENT_F32, GWR_MESH_ATTRIB_FLOAT, 0, 12},
+    [GWR_QUANT_HALF4] = {4, GWR_MESH_COMPONENT_F16, GWR_MESH_ATTRIB_FLOAT, 0, 8},
+    [GWR_QUANT_HALF2] = {2, GWR_MESH_COMPONENT_F16, GWR_MESH_ATTRIB_FLOAT, 0, 4},
+    [GWR_QUANT_SNORM16x4] = {4, GWR_MESH_COMPONENT_I16, GWR_MESH_ATTRIB_FLOAT, 1, 8},
+    [GWR_QUANT_OCT_SNORM16x2] = {2, GWR_MESH_COMPONENT_I16, GWR_MESH_ATTRIB_FLOAT, 1, 4},
+    [GWR_QUANT_SNORM_2_10_10_10] = {4, GWR_MESH_COMPONENT_I2_10_10_10, GWR_MESH_ATTRIB_FLOAT, 1, 4},
+    [GWR_QUANT_UNORM8x4] = {4, GWR_MESH_COMPONENT_U8, GWR_MESH_ATTRIB_FLOAT, 1, 4},
+};
+
+GWR_STATIC_ASSERT(GWR_ARR_LEN(s_formats) == GWR_QUANT__COUNT, "s_formats out of sync");
+GWR_STATIC_ASSERT(sizeof(GWR_quant_vert_t) == 20, "GWR_quant_vert_t must stay tightly packed");
+
+// inner funcs decls
+
+static const quant_kernels_t *quant_pick_kernels(void);
+
+static void scalar_half_n(const float *in, uint16_t *out, size_t n);
+static void scalar_snorm16x4_n(const float *in, int16_t *out, size_t n, const float *bias, const float *scale);
+static void scalar_unorm8_n(const float *in, uint8_t *out, size_t n);
+static void scalar_oct_n(const vec3 *in, int16_t (*out)[2], size_t n);
+
+#if QUANT_HAS_X86
+static void sse_snorm16x4_n(const float *in, int16_t *out, size_t n, const float *bias, const float *scale);
+static void sse_unorm8_n(const float *in, uint8_t *out, size_t n);
+static void sse_oct_n(const vec3 *in, int16_t (*out)[2], size_t n);
+static void f16c_half_n(const float *in, uint16_t *out, size_t n);
+#endif
+
+static const quant_kernels_t s_scalar_kernels = {
+    scalar_half_n, scalar_snorm16x4_n, scalar_unorm8_n, scalar_oct_n
+};
+#if QUANT_HAS_X86
+static const quant_kernels_t s_sse_kernels = {
+    scalar_half_n, sse_snorm16x4_n, sse_unorm8_n, sse_oct_n
+};
+static const quant_kernels_t s_avx2_kernels = {
+    f16c_half_n, sse_snorm16x4_n, sse_unorm8_n, sse_oct_n
+};
+#endif
+
+// public funcs defs
+
+uint32_t GWR_quant_format_size(GWR_quant_format_e format) {
+    assert(format < GWR_QUANT__COUNT);
+
+    return s_formats[format].bytes;
+}
+
+GWR_mesh_attrib_t GWR_quant_attrib(uint8_t location, GWR_quant_format_e format, uint32_t offset) {
+    assert(format < GWR_QUANT__COUNT);
+
+    const quant_format_info_t *f = &s_formats[format];
+    return (GWR_mesh_attrib_t) {
+        .location = location,
+        .size = f->size,
+        .component = f->component,
+        .mode = f->mode,
+        .normalized = f->normalized,
+        .offset = offset,
+    };
+}
+
+size_t GWR_quant_vert_layout(GWR_mesh_attrib_t out[GWR_QUANT_VERT_ATTRIBS]) {
+    assert(out);
+
+    out[0] = GWR_quant_attrib(0, GWR_QUANT_SNORM16x4, offsetof(GWR_quant_vert_t, pos));
+    out[1] = GWR_quant_attrib(1, GWR_QUANT_OCT_SNORM16x2, offsetof(GWR_quant_vert_t, normal));
+    out[2] = GWR_quant_attrib(2, GWR_QUANT_HALF2, offsetof(GWR_quant_vert_t, tex_coord));
+    out[3] = GWR_quant_attrib(3, GWR_QUANT_UNORM8x4, offsetof(GWR_quant_vert_t, color));
+    return GWR_QUANT_VERT_ATTRIBS;
+}
+
+uint16_t GWR_quant_half(float v) {
+    // round to nearest even, denormals and inf/nan preserved (after F. Giesen)
+    uint32_t f;
+    memcpy(&f, &v, sizeof(f));
+    const uint16_t sign = (uint16_t) ((f >> 16) & 0x8000u);
+    f &= 0x7fffffffu;
+
+    if (f >= 0x47800000u) {
+        // too big for a half, or already inf/nan
+        return sign | (f > 0x7f800000u ? 0x7e00u : 0x7c00u);
+    }
+    if (f < 0x38800000u) {
+        // denormal half: let the fpu align and round the mantissa
+        float a;
+        memcpy(&a, &f, sizeof(a));
+        a += 0.5f;
+        uint32_t r;
+        memcpy(&r, &a, sizeof(r));
+        return sign | (uint16_t) (r - 0x3f000000u);
+    }
+
+    const uint32_t mant_odd = (f >> 13) & 1u;
+    f += 0xc8000fffu + mant_odd;
+    return sign | (uint16_t) (f >> 13);
+}
+
+float GWR_quant_half_to_float(uint16_t h) {
+    const uint32_t sign = (uint32_t) (h & 0x8000u) << 16;
+    const uint32_t exp = (h >> 10) & 0x1fu;
+    const uint32_t mant = h & 0x3ffu;
+
+    float out;
+    if (exp == 0) {
+        out = ldexpf((float) mant, -24);
+        uint32_t bits;
+        memcpy(&bits, &out, sizeof(bits));
+        bits |= sign;
+        memcpy(&out, &bits, sizeof(out));
+        return out;
+    }
+
+    uint32_t bits = sign | (exp == 31 ? 0x7f800000u | (mant << 13) : ((exp + 112u) << 23) | (mant << 13));
+    memcpy(&out, &bits, sizeof(out));
+    return out;
+}
+
+int16_t GWR_quant_snorm16(float v) {
+    return (int16_t) lrintf(GWR_clamp(v, -1.f, 1.f) * QUANT_SNORM16_MAX);
+}
+
+uint8_t GWR_quant_unorm8(float v) {
+    return (uint8_t) lrintf(GWR_clamp(v, 0.f, 1.f) * 255.f);
+}
+
+void GWR_quant_oct(const vec3 n, int16_t out[2]) {
+    assert(n);
+    assert(out);
+
+    scalar_oct_n((const vec3 *) n, (int16_t (*)[2]) out, 1);
+}
+
+void GWR_quant_oct_decode(const int16_t in[2], vec3 out) {
+    assert(in);
+    assert(out);
+
+    const float x = fmaxf((float) in[0] / QUANT_SNORM16_MAX, -1.f);
+    const float y = fmaxf((float) in[1] / QUANT_SNORM16_MAX, -1.f);
+    vec3 n = {x, y, 1.f - fabsf(x) - fabsf(y)};
+    const float t = fmaxf(-n[2], 0.f);
+    n[0] += n[0] >= 0.f ? -t : t;
+    n[1] += n[1] >= 0.f ? -t : t;
+    glm_vec3_normalize_to(n, out);
+}
+
+uint32_t GWR_quant_snorm_2_10_10_10(const vec3 v, float w) {
+    assert(v);
+
+    const int32_t x = (int32_t) lrintf(GWR_clamp(v[0], -1.f, 1.f) * QUANT_SNORM10_MAX);
+    const int32_t y = (int32_t) lrintf(GWR_clamp(v[1], -1.f, 1.f) * QUANT_SNORM10_MAX);
+    const int32_t z = (int32_t) lrintf(GWR_clamp(v[2], -1.f, 1.f) * QUANT_SNORM10_MAX);
+    const int32_t iw = w > 0.5f ? 1 : (w < -0.5f ? -1 : 0);
+
+    return ((uint32_t) x & 0x3ffu) | (((uint32_t) y & 0x3ffu) << 10) |
+           (((uint32_t) z & 0x3ffu) << 20) | (((uint32_t) iw & 0x3u) << 30);
+}
+
+GWR_quant_bounds_t GWR_quant_compute_bounds(const vec3 *positions, size_t n) {
+    assert(positions || !n);
+
+    vec3 lo = {FLT_MAX, FLT_MAX, FLT_MAX};
+    vec3 hi = {-FLT_MAX, -FLT_MAX, -FLT_MAX};
+    for (size_t i = 0; i < n; ++i) {
+        glm_vec3_minv(lo, (float *) positions[i], lo);
+        glm_vec3_maxv(hi, (float *) positions[i], hi);
+    }
+
+    GWR_quant_bounds_t b = {0};
+    for (int k = 0; k < 3; ++k) {
+        b.center[k] = n ? (lo[k] + hi[k]) * 0.5f : 0.f;
+        // flat axes still need a divisor
+        b.extent[k] = n ? fmaxf((hi[k] - lo[k]) * 0.5f, FLT_MIN) : 1.f;
+    }
+    return b;
+}
+
+void GWR_quant_encode_half_n(const float *in, uint16_t *out, size_t n) {
+    assert(in || !n);
+    assert(out || !n);
+
+    quant_pick_kernels()->half_n(in, out, n);
+}
+
+void GWR_quant_encode_unorm8_n(const float *in, uint8_t *out, size_t n) {
+    assert(in || !n);
+    assert(out || !n);
+
+    quant_pick_kernels()->unorm8_n(in, out, n);
+}
+
+void GWR_quant_encode_positions_snorm16(const vec3 *in, const GWR_quant_bounds_t *bounds, int16_t (*out)[4], size_t n) {
+    assert(in || !n);
+    assert(out || !n);
+    assert(bounds);
+
+    const quant_kernels_t *k = quant_pick_kernels();
+    const float bias[4] = {bounds->center[0], bounds->center[1], bounds->center[2], 0.f};
+    const float scale[4] = {1.f / bounds->extent[0], 1.f / bounds->extent[1], 1.f / bounds->extent[2], 1.f};
+
+    float tmp[QUANT_CHUNK][4];
+    for (size_t i = 0; i < n; i += QUANT_CHUNK) {
+        const size_t m = n - i < QUANT_CHUNK ? n - i : QUANT_CHUNK;
+        for (size_t j = 0; j < m; ++j) {
+            memcpy(tmp[j], in[i + j], sizeof(vec3));
+            tmp[j][3] = 1.f;
+        }
+        k->snorm16x4_n(tmp[0], out[i], m, bias, scale);
+    }
+}
+
+void GWR_quant_encode_positions_half(const vec3 *in, const float *center, uint16_t (*out)[4], size_t n) {
+    assert(in || !n);
+    assert(out || !n);
+
+    const quant_kernels_t *k = quant_pick_kernels();
+    const vec3 zero = {0.f, 0.f, 0.f};
+    const float *c = center ? center : zero;
+
+    float tmp[QUANT_CHUNK][4];
+    for (size_t i = 0; i < n; i += QUANT_CHUNK) {
+        const size_t m = n - i < QUANT_CHUNK ? n - i : QUANT_CHUNK;
+        for (size_t j = 0; j < m; ++j) {
+            tmp[j][0] = in[i + j][0] - c[0];
+            tmp[j][1] = in[i + j][1] - c[1];
+            tmp[j][2] = in[i + j][2] - c[2];
+            tmp[j][3] = 1.f;
+        }
+        k->half_n(tmp[0], out[i], m * 4);
+    }
+}
+
+void GWR_quant_encode_normals_oct(const vec3 *in, int16_t (*out)[2], size_t n) {
+    assert(in || !n);
+    assert(out || !n);
+
+    quant_pick_kernels()->oct_n(in, out, n);
+}
+
+void GWR_quant_encode_normals_2_10_10_10(const vec3 *in, const float *w, uint32_t *out, size_t n) {
+    assert(in || !n);
+    assert(out || !n);
+
+    for (size_t i = 0; i < n; ++i) {
+        out[i] = GWR_quant_snorm_2_10_10_10(in[i], w ? w[i] : 0.f);
+    }
+}
+
+void GWR_quant_encode_verts(
+    const vec3 *positions, const vec3 *normals, const vec2 *tex_coords, const vec4 *colors,
+    const GWR_quant_bounds_t *bounds, GWR_quant_vert_t *out, size_t n
+) {
+    assert(positions || !n);
+    assert(out || !n);
+    assert(bounds);
+
+    const quant_kernels_t *k = quant_pick_kernels();
+
+    int16_t pos[QUANT_CHUNK][4];
+    int16_t nrm[QUANT_CHUNK][2];
+    uint16_t uv[QUANT_CHUNK][2];
+    uint8_t col[QUANT_CHUNK][4];
+
+    for (size_t i = 0; i < n; i += QUANT_CHUNK) {
+        const size_t m = n - i < QUANT_CHUNK ? n - i : QUANT_CHUNK;
+
+        GWR_quant_encode_positions_snorm16(positions + i, bounds, pos, m);
+        if (normals) {
+            k->oct_n(normals + i, nrm, m);
+        } else {
+            memset(nrm, 0, sizeof(nrm));
+        }
+        if (tex_coords) {
+            k->half_n(tex_coords[i], uv[0], m * 2);
+        } else {
+            memset(uv, 0, sizeof(uv));
+        }
+        if (colors) {
+            k->unorm8_n(colors[i], col[0], m * 4);
+        } else {
+            memset(col, 0xff, sizeof(col));
+        }
+
+        for (size_t j = 0; j < m; ++j) {
+            GWR_quant_vert_t *v = &out[i + j];
+            memcpy(v->pos, pos[j], sizeof(v->pos));
+            memcpy(v->normal, nrm[j], sizeof(v->normal));
+            memcpy(v->tex_coord, uv[j], sizeof(v->tex_coord));
+            memcpy(v->color, col[j], sizeof(v->color));
+        }
+    }
+}
+
+// inner funcs defs
+
+static const quant_kernels_t *quant_pick_kernels(void) {
+    // follows whatever gwr_simd runs on, including GWR_simd_set_backend overrides
+    switch (GWR_simd_get_backend()) {
+#if QUANT_HAS_X86
+        case GWR_SIMD_AVX2: {
+            static int has_f16c = -1;
+            if (has_f16c < 0) {
+                __builtin_cpu_init();
+                has_f16c = __builtin_cpu_supports("f16c") ? 1 : 0;
+            }
+            return has_f16c ? &s_avx2_kernels : &s_sse_kernels;
+        }
+        case GWR_SIMD_SSE:
+            return &s_sse_kernels;
+#endif
+        default:
+            return &s_scalar_kernels;
+    }
+}
+
+// scalar: reference
+
+static void scalar_half_n(const float *in, uint16_t *out, size_t n) {
+    for (size_t i = 0; i < n; ++i) {
+        out[i] = GWR_quant_half(in[i]);
+    }
+}
+
+static void scalar_snorm16x4_n(const float *in, int16_t *out, size_t n, const float *bias, const float *scale) {
+    for (size_t i = 0; i < n * 4; ++i) {
+        out[i] = GWR_quant_snorm16((in[i] - bias[i & 3]) * scale[i & 3]);
+    }
+}
+
+static void scalar_unorm8_n(const float *in, uint8_t *out, size_t n) {
+    for (size_t i = 0; i < n; ++i) {
+        out[i] = GWR_quant_unorm8(in[i]);
+    }
+}
+
+static void scalar_oct_n(const vec3 *in, int16_t (*out)[2], size_t n) {
+    for (size_t i = 0; i < n; ++i) {
+        const float l1 = fabsf(in[i][0]) + fabsf(in[i][1]) + fabsf(in[i][2]);
+        const float inv = l1 > 0.f ? 1.f / l1 : 0.f;
+        float x = in[i][0] * inv;
+        float y = in[i][1] * inv;
+        if (in[i][2] < 0.f) {
+            // fold the lower hemisphere over the diagonals
+            const float fx = (1.f - fabsf(y)) * (x >= 0.f ? 1.f : -1.f);
+            const float fy = (1.f - fabsf(x)) * (y >= 0.f ? 1.f : -1.f);
+            x = fx;
+            y = fy;
+        }
+        out[i][0] = GWR_quant_snorm16(x);
+        out[i][1] = GWR_quant_snorm16(y);
+    }
+}
+
+#if QUANT_HAS_X86
+
+// sse2
+
+static inline __m128i sse_snorm16_lanes(__m128 v) {
+    v = _mm_min_ps(_mm_max_ps(v, _mm_set1_ps(-1.f)), _mm_set1_ps(1.f));
+    return _mm_cvtps_epi32(_mm_mul_ps(v, _mm_set1_ps(QUANT_SNORM16_MAX)));
+}
+
+static void sse_snorm16x4_n(const float *in, int16_t *out, size_t n, const float *bias, const float *scale) {
+    const __m128 b = _mm_loadu_ps(bias);
+    const __m128 s = _mm_loadu_ps(scale);
+
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2) {
+        const __m128i a = sse_snorm16_lanes(_mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(in + i * 4), b), s));
+        const __m128i c = sse_snorm16_lanes(_mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(in + i * 4 + 4), b), s));
+        _mm_storeu_si128((__m128i *) (out + i * 4), _mm_packs_epi32(a, c));
+    }
+    scalar_snorm16x4_n(in + i * 4, out + i * 4, n - i, bias, scale);
+}
+
+static void sse_unorm8_n(const float *in, uint8_t *out, size_t n) {
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 one = _mm_set1_ps(1.f);
+    const __m128 max = _mm_set1_ps(255.f);
+
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m128i q[4];
+        for (int k = 0; k < 4; ++k) {
+            const __m128 v = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(in + i + k * 4), zero), one);
+            q[k] = _mm_cvtps_epi32(_mm_mul_ps(v, max));
+        }
+        const __m128i lo = _mm_packs_epi32(q[0], q[1]);
+        const __m128i hi = _mm_packs_epi32(q[2], q[3]);
+        _mm_storeu_si128((__m128i *) (out + i), _mm_packus_epi16(lo, hi));
+    }
+    scalar_unorm8_n(in + i, out + i, n - i);
+}
+
+static void sse_oct_n(const vec3 *in, int16_t (*out)[2], size_t n) {
+    const __m128 abs_mask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 one = _mm_set1_ps(1.f);
+    const __m128 minus_one = _mm_set1_ps(-1.f);
+
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        const __m128 x = _mm_setr_ps(in[i][0], in[i + 1][0], in[i + 2][0], in[i + 3][0]);
+        const __m128 y = _mm_setr_ps(in[i][1], in[i + 1][1], in[i + 2][1], in[i + 3][1]);
+        const __m128 z = _mm_setr_ps(in[i][2], in[i + 1][2], in[i + 2][2], in[i + 3][2]);
+
+        const __m128 l1 = _mm_add_ps(_mm_add_ps(_mm_and_ps(x, abs_mask), _mm_and_ps(y, abs_mask)), _mm_and_ps(z, abs_mask));
+        const __m128 nonzero = _mm_cmpgt_ps(l1, zero);
+        const __m128 inv = _mm_and_ps(_mm_div_ps(one, _mm_or_ps(l1, _mm_andnot_ps(nonzero, one))), nonzero);
+        const __m128 px = _mm_mul_ps(x, inv);
+        const __m128 py = _mm_mul_ps(y, inv);
+
+        // fold where z < 0, signs follow the scalar x >= 0 ? 1 : -1
+        const __m128 sx = _mm_or_ps(_mm_and_ps(_mm_cmpge_ps(px, zero), one), _mm_andnot_ps(_mm_cmpge_ps(px, zero), minus_one));
+        const __m128 sy = _mm_or_ps(_mm_and_ps(_mm_cmpge_ps(py, zero), one), _mm_andnot_ps(_mm_cmpge_ps(py, zero), minus_one));
+        const __m128 fx = _mm_mul_ps(_mm_sub_ps(one, _mm_and_ps(py, abs_mask)), sx);
+        const __m128 fy = _mm_mul_ps(_mm_sub_ps(one, _mm_and_ps(px, abs_mask)), sy);
+        const __m128 neg = _mm_cmplt_ps(z, zero);
+        const __m128 ox = _mm_or_ps(_mm_and_ps(neg, fx), _mm_andnot_ps(neg, px));
+        const __m128 oy = _mm_or_ps(_mm_and_ps(neg, fy), _mm_andnot_ps(neg, py));
+
+        const __m128i qx = sse_snorm16_lanes(ox);
+        const __m128i qy = sse_snorm16_lanes(oy);
+        // x0 y0 x1 y1 | x2 y2 x3 y3
+        const __m128i packed = _mm_packs_epi32(_mm_unpacklo_epi32(qx, qy), _mm_unpackhi_epi32(qx, qy));
+        _mm_storeu_si128((__m128i *) out[i], packed);
+    }
+    scalar_oct_n(in + i, out + i, n - i);
+}
+
+// avx2: f16c halves, the rest is shared with sse2
+
+QUANT_TARGET_F16C
+static void f16c_half_n(const float *in, uint16_t *out, size_t n) {
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        const __m128i h = _mm256_cvtps_ph(_mm256_loadu_ps(in + i), _MM_FROUND_TO_NEAREST_INT);
+        _mm_storeu_si128((__m128i *) (out + i), h);
+    }
+    scalar_half_n(in + i, out + i, n - i);
+}
+
+#endif
@@ -0,0 +1,534 @@
+#include "internal/gwr_readback.h"
+#include "internal/gwr_log.h"
+#include "internal/gwr_cap.h"
+#include "internal/gwr_memory.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+#include <assert.h>
+#include <pthread.h>
+
+#define RB_LOG(level, msg, ...)    GWR_LOG_AT(GWR_LOG_SYS_READBACK, (level), msg, ##__VA_ARGS__)
+
+#define RB_WAIT_TIMEOUT_NS    1000000000ull
+#define RB_PATH_MAX           1024
+
+typedef enum {
+    SLOT_FREE = 0,
+    SLOT_IN_FLIGHT,         // read issued, fence pending
+    SLOT_QUEUED,            // owned by the worker until it frees it
+} slot_state_e;
+
+typedef struct {
+    GLuint pbo;
+    GLsync fence;
+    void *ptr;              // persistent mapping or a copy made by poll()
+    slot_state_e state;
+    uint64_t index;
+} slot_t;
+
+struct GWR_readback_t {
+    GLsizei width;
+    GLsizei height;
+    GLenum format;
+    GLsizei stride;
+    GLsizeiptr size;
+    bool persistent;
+    bool mem_recorded;
+    GWR_mem_tag_t mem_tag;
+
+    slot_t *slots;
+    GLsizei slot_count;
+    GLsizei head;           // next slot to capture into
+    GLsizei tail;           // oldest slot in flight
+    GLsizei in_flight;      // render thread only
+    GLint prev_pack_alignment;
+    GLsizei work;           // next slot the worker delivers
+
+    GWR_readback_frame_fn fn;
+    void *user;
+
+    pthread_t thread;
+    pthread_mutex_t mutex;
+    pthread_cond_t queued;
+    pthread_cond_t freed;
+    bool stop;
+    bool thread_started;
+
+    uint64_t captured;
+    uint64_t dropped;
+    _Atomic uint64_t completed;
+};
+
+// inner funcs decls
+
+static int format_channels(GLenum format);
+static bool create_slot(GWR_readback_t *rb, slot_t *slot);
+static void release_slot(GWR_readback_t *rb, slot_t *slot);
+static slot_t *begin_capture(GWR_readback_t *rb);
+static void end_capture(GWR_readback_t *rb, slot_t *slot);
+static void deliver(GWR_readback_t *rb, slot_t *slot);
+static void *worker_thread(void *arg);
+static void dump(const GWR_readback_frame_t *frame, void *user, bool ppm);
+
+// public funcs defs
+
+GWR_readback_t *GWR_readback_create(
+    GLsizei width,
+    GLsizei height,
+    GLenum format,
+    GLsizei slots,
+    GWR_readback_frame_fn fn,
+    void *user
+) {
+    assert(width > 0);
+    assert(height > 0);
+    assert(slots > 0);
+    assert(fn);
+
+    const int channels = format_channels(format);
+    if (!channels) {
+        RB_LOG(GWR_LOG_ERROR, "unsupported readback format 0x%04X", format);
+        return NULL;
+    }
+
+    GWR_readback_t *rb = calloc(1, sizeof(GWR_readback_t));
+    if (!rb) {
+        RB_LOG(GWR_LOG_ERROR, "failed to allocate GWR_readback_t");
+        return NULL;
+    }
+    rb->width = width;
+    rb->height = height;
+    rb->format = format;
+    rb->stride = width * channels;
+    rb->size = (GLsizeiptr) rb->stride * height;
+    rb->persistent = GWR_cap_has(GWR_FEATURE_BUFFER_STORAGE);
+    rb->fn = fn;
+    rb->user = user;
+    atomic_init(&rb->completed, 0);
+
+    pthread_mutex_init(&rb->mutex, NULL);
+    pthread_cond_init(&rb->queued, NULL);
+    pthread_cond_init(&rb->freed, NULL);
+
+    rb->slots = calloc(slots, sizeof(slot_t));
+    if (!rb->slots) {
+        RB_LOG(GWR_LOG_ERROR, "failed to allocate slots");
+        goto fail;
+    }
+    rb->slot_count = slots;
+    for (GLsizei i = 0; i < slots; ++i) {
+        if (!create_slot(rb, &rb->slots[i])) {
+            goto fail;
+        }
+    }
+
+    if (pthread_create(&rb->thread, NULL, worker_thread, rb) != 0) {
+        RB_LOG(GWR_LOG_ERROR, "failed to start readback worker");
+        goto fail;
+    }
+    rb->thread_started = true;
+    rb->mem_tag = GWR_mem_record_alloc(GWR_MEM_READBACK, (int64_t) rb->size * slots);
+    rb->mem_recorded = true;
+
+    return rb;
+
+fail:
+    GWR_readback_destroy(rb);
+    return NULL;
+}
+
+void GWR_readback_destroy(GWR_readback_t *rb) {
+    assert(rb);
+
+    if (rb->thread_started) {
+        pthread_mutex_lock(&rb->mutex);
+        rb->stop = true;
+        pthread_cond_signal(&rb->queued);
+        pthread_mutex_unlock(&rb->mutex);
+        pthread_join(rb->thread, NULL);
+    }
+
+    if (rb->mem_recorded) {
+        GWR_mem_record_free(GWR_MEM_READBACK, rb->mem_tag, (int64_t) rb->size * rb->slot_count);
+    }
+
+    if (rb->slots) {
+        for (GLsizei i = 0; i < rb->slot_count; ++i) {
+            release_slot(rb, &rb->slots[i]);
+        }
+        free(rb->slots);
+    }
+
+    pthread_cond_destroy(&rb->freed);
+    pthread_cond_destroy(&rb->queued);
+    pthread_mutex_destroy(&rb->mutex);
+    free(rb);
+}
+
+bool GWR_readback_capture(GWR_readback_t *rb, GLint x, GLint y) {
+    assert(rb);
+
+    slot_t *slot = begin_capture(rb);
+    if (!slot) {
+        return false;
+    }
+
+    glReadPixels(x, y, rb->width, rb->height, rb->format, GL_UNSIGNED_BYTE, NULL);
+
+    end_capture(rb, slot);
+    return true;
+}
+
+bool GWR_readback_capture_texture(GWR_readback_t *rb, GLuint texture, GLint level) {
+    assert(rb);
+    assert(texture);
+
+    if (!GWR_cap_has(GWR_FEATURE_DIRECT_STATE_ACCESS)) {
+        RB_LOG(GWR_LOG_ERROR, "texture readback needs direct state access");
+        return false;
+    }
+
+    slot_t *slot = begin_capture(rb);
+    if (!slot) {
+        return false;
+    }
+
+    glGetTextureSubImage(
+        texture, level, 0, 0, 0, rb->width, rb->height, 1,
+        rb->format, GL_UNSIGNED_BYTE, (GLsizei) rb->size, NULL
+    );
+
+    end_capture(rb, slot);
+    return true;
+}
+
+void GWR_readback_poll(GWR_readback_t *rb) {
+    assert(rb);
+
+    while (rb->in_flight > 0) {
+        slot_t *slot = &rb->slots[rb->tail];
+        const GLenum res = glClientWaitSync(slot->fence, 0, 0);
+        if (res != GL_ALREADY_SIGNALED && res != GL_CONDITION_SATISFIED) {
+            return;
+        }
+        deliver(rb, slot);
+        rb->tail = (rb->tail + 1) % rb->slot_count;
+        --rb->in_flight;
+    }
+}
+
+void GWR_readback_flush(GWR_readback_t *rb) {
+    assert(rb);
+
+    while (rb->in_flight > 0) {
+        slot_t *slot = &rb->slots[rb->tail];
+        GLenum res;
+        do {
+            res = glClientWaitSync(slot->fence, GL_SYNC_FLUSH_COMMANDS_BIT, RB_WAIT_TIMEOUT_NS);
+        } while (res == GL_TIMEOUT_EXPIRED);
+        if (res == GL_WAIT_FAILED) {
+            RB_LOG(GWR_LOG_ERROR, "glClientWaitSync failed");
+        }
+        deliver(rb, slot);
+        rb->tail = (rb->tail + 1) % rb->slot_count;
+        --rb->in_flight;
+    }
+
+    pthread_mutex_lock(&rb->mutex);
+    for (GLsizei i = 0; i < rb->slot_count; ++i) {
+        while (rb->slots[i].state == SLOT_QUEUED) {
+            pthread_cond_wait(&rb->freed, &rb->mutex);
+        }
+    }
+    pthread_mutex_unlock(&rb->mutex);
+}
+
+GWR_readback_stats_t GWR_readback_get_stats(const GWR_readback_t *rb) {
+    assert(rb);
+
+    return (GWR_readback_stats_t) {
+        .captured = rb->captured,
+        .completed = atomic_load(&rb->completed),
+        .dropped = rb->dropped,
+    };
+}
+
+void GWR_readback_dump_ppm(const GWR_readback_frame_t *frame, void *user) {
+    dump(frame, user, true);
+}
+
+void GWR_readback_dump_raw(const GWR_readback_frame_t *frame, void *user) {
+    dump(frame, user, false);
+}
+
+bool GWR_readback_write_ppm(const char *path, const GWR_readback_frame_t *frame) {
+    assert(path);
+    assert(frame);
+
+    const int channels = format_channels(frame->format);
+    if (!channels) {
+        RB_LOG(GWR_LOG_ERROR, "unsupported frame format 0x%04X", frame->format);
+        return false;
+    }
+
+    uint8_t *row = malloc((size_t) frame->width * 3);
+    if (!row) {
+        RB_LOG(GWR_LOG_ERROR, "failed to allocate row");
+        return false;
+    }
+
+    FILE *f = fopen(path, "wb");
+    if (!f) {
+        RB_LOG(GWR_LOG_ERROR, "failed to open '%s'", path);
+        free(row);
+        return false;
+    }
+
+    bool ok = fprintf(f, "P6\n%d %d\n255\n", frame->width, frame->height) > 0;
+    const bool bgra = frame->format == GL_BGRA;
+    for (GLsizei y = frame->height - 1; ok && y >= 0; --y) {
+        const uint8_t *src = frame->data + (size_t) y * frame->stride;
+        for (GLsizei x = 0; x < frame->width; ++x, src += channels) {
+            row[x * 3 + 0] = bgra ? src[2] : src[0];
+            row[x * 3 + 1] = src[1];
+            row[x * 3 + 2] = bgra ? src[0] : src[2];
+        }
+        ok = fwrite(row, 3, (size_t) frame->width, f) == (size_t) frame->width;
+    }
+
+    if (fclose(f) != 0) {
+        ok = false;
+    }
+    if (!ok) {
+        RB_LOG(GWR_LOG_ERROR, "failed to write '%s'", path);
+    }
+    free(row);
+    return ok;
+}
+
+bool GWR_readback_write_raw(const char *path, const GWR_readback_frame_t *frame) {
+    assert(path);
+    assert(frame);
+
+    FILE *f = fopen(path, "wb");
+    if (!f) {
+        RB_LOG(GWR_LOG_ERROR, "failed to open '%s'", path);
+        return false;
+    }
+
+    const size_t size = (size_t) frame->stride * frame->height;
+    bool ok = fwrite(frame->data, 1, size, f) == size;
+    if (fclose(f) != 0) {
+        ok = false;
+    }
+    if (!ok) {
+        RB_LOG(GWR_LOG_ERROR, "failed to write '%s'", path);
+    }
+    return ok;
+}
+
+// inner funcs defs
+
+static int format_channels(GLenum format) {
+    switch (format) {
+        case GL_RGBA:
+        case GL_BGRA:
+            return 4;
+        case GL_RGB:
+            return 3;
+        default:
+            return 0;
+    }
+}
+
+static bool create_slot(GWR_readback_t *rb, slot_t *slot) {
+    const bool dsa = GWR_cap_has(GWR_FEATURE_DIRECT_STATE_ACCESS);
+    const GLbitfield flags = GL_MAP_READ_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+
+    if (dsa) {
+        glCreateBuffers(1, &slot->pbo);
+    } else {
+        glGenBuffers(1, &slot->pbo);
+    }
+    if (!slot->pbo) {
+        RB_LOG(GWR_LOG_ERROR, "failed to create pack buffer");
+        return false;
+    }
+
+    if (rb->persistent) {
+        // GL_CLIENT_STORAGE_BIT: the CPU reads every byte, keep it in system memory
+        if (dsa) {
+            glNamedBufferStorage(slot->pbo, rb->size, NULL, flags | GL_CLIENT_STORAGE_BIT);
+            slot->ptr = glMapNamedBufferRange(slot->pbo, 0, rb->size, flags);
+        } else {
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, slot->pbo);
+            glBufferStorage(GL_PIXEL_PACK_BUFFER, rb->size, NULL, flags | GL_CLIENT_STORAGE_BIT);
+            slot->ptr = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, rb->size, flags);
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        }
+        if (!slot->ptr) {
+            RB_LOG(GWR_LOG_ERROR, "failed to map pack buffer %u", slot->pbo);
+            return false;
+        }
+        return true;
+    }
+
+    if (dsa) {
+        glNamedBufferData(slot->pbo, rb->size, NULL, GL_STREAM_READ);
+    } else {
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, slot->pbo);
+        glBufferData(GL_PIXEL_PACK_BUFFER, rb->size, NULL, GL_STREAM_READ);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    }
+    slot->ptr = malloc((size_t) rb->size);
+    if (!slot->ptr) {
+        RB_LOG(GWR_LOG_ERROR, "failed to allocate frame copy");
+        return false;
+    }
+    return true;
+}
+
+static void release_slot(GWR_readback_t *rb, slot_t *slot) {
+    if (slot->fence) {
+        glDeleteSync(slot->fence);
+        slot->fence = NULL;
+    }
+    if (!rb->persistent) {
+        free(slot->ptr);
+    }
+    slot->ptr = NULL;
+    if (slot->pbo) {
+        // deleting a mapped buffer unmaps it
+        glDeleteBuffers(1, &slot->pbo);
+        slot->pbo = 0;
+    }
+}
+
+// NULL (and counted as dropped) if the next slot is still busy
+static slot_t *begin_capture(GWR_readback_t *rb) {
+    const uint64_t index = rb->captured++;
+    slot_t *slot = &rb->slots[rb->head];
+
+    pthread_mutex_lock(&rb->mutex);
+    const bool free_slot = slot->state == SLOT_FREE;
+    pthread_mutex_unlock(&rb->mutex);
+
+    if (!free_slot) {
+        ++rb->dropped;
+        return NULL;
+    }
+
+    slot->index = index;
+
+    // tight rows for any width; restored in end_capture
+    glGetIntegerv(GL_PACK_ALIGNMENT, &rb->prev_pack_alignment);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, slot->pbo);
+
+    return slot;
+}
+
+static void end_capture(GWR_readback_t *rb, slot_t *slot) {
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    glPixelStorei(GL_PACK_ALIGNMENT, rb->prev_pack_alignment);
+
+    slot->fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    // the read may sit in the command queue until the next swap otherwise
+    glFlush();
+
+    pthread_mutex_lock(&rb->mutex);
+    slot->state = SLOT_IN_FLIGHT;
+    pthread_mutex_unlock(&rb->mutex);
+
+    rb->head = (rb->head + 1) % rb->slot_count;
+    ++rb->in_flight;
+}
+
+static void deliver(GWR_readback_t *rb, slot_t *slot) {
+    glDeleteSync(slot->fence);
+    slot->fence = NULL;
+
+    if (!rb->persistent) {
+        const void *src;
+        if (GWR_cap_has(GWR_FEATURE_DIRECT_STATE_ACCESS)) {
+            src = glMapNamedBufferRange(slot->pbo, 0, rb->size, GL_MAP_READ_BIT);
+            if (src) {
+                memcpy(slot->ptr, src, (size_t) rb->size);
+            }
+            glUnmapNamedBuffer(slot->pbo);
+        } else {
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, slot->pbo);
+            src = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, rb->size, GL_MAP_READ_BIT);
+            if (src) {
+                memcpy(slot->ptr, src, (size_t) rb->size);
+            }
+            glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        }
+        if (!src) {
+            RB_LOG(GWR_LOG_ERROR, "failed to map pack buffer %u", slot->pbo);
+        }
+    }
+
+    pthread_mutex_lock(&rb->mutex);
+    slot->state = SLOT_QUEUED;
+    pthread_cond_signal(&rb->queued);
+    pthread_mutex_unlock(&rb->mutex);
+}
+
+// delivers slots in capture order; queued frames are drained before stopping
+static void *worker_thread(void *arg) {
+    GWR_readback_t *rb = arg;
+
+    pthread_mutex_lock(&rb->mutex);
+    for (;;) {
+        slot_t *slot = &rb->slots[rb->work];
+        while (slot->state != SLOT_QUEUED && !rb->stop) {
+            pthread_cond_wait(&rb->queued, &rb->mutex);
+        }
+        if (slot->state != SLOT_QUEUED) {
+            break;
+        }
+        pthread_mutex_unlock(&rb->mutex);
+
+        const GWR_readback_frame_t frame = {
+            .data = slot->ptr,
+            .width = rb->width,
+            .height = rb->height,
+            .stride = rb->stride,
+            .format = rb->format,
+            .index = slot->index,
+        };
+        rb->fn(&frame, rb->user);
+        atomic_fetch_add(&rb->completed, 1);
+
+        pthread_mutex_lock(&rb->mutex);
+        slot->state = SLOT_FREE;
+        rb->work = (rb->work + 1) % rb->slot_count;
+        pthread_cond_broadcast(&rb->freed);
+    }
+    pthread_mutex_unlock(&rb->mutex);
+
+    return NULL;
+}
+
+static void dump(const GWR_readback_frame_t *frame, void *user, bool ppm) {
+    assert(frame);
+    assert(user);
+
+    char path[RB_PATH_MAX];
+    const int n = snprintf(path, sizeof(path), (const char *) user, (unsigned long long) frame->index);
+    if (n < 0 || (size_t) n >= sizeof(path)) {
+        RB_LOG(GWR_LOG_ERROR, "capture path too long");
+        return;
+    }
+
+    if (ppm) {
+        GWR_readback_write_ppm(path, frame);
+    } else {
+        GWR_readback_write_raw(path, frame);
+    }
+}
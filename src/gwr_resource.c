@@ -0,0 +1,599 @@
+#include "internal/gwr_resource.h"
+#include "internal/gwr_log.h"
+#include "internal/gwr_window.h"
+#include "internal/gwr_util.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <assert.h>
+#include <pthread.h>
+
+#define RES_LOG(level, msg, ...)    GWR_LOG_AT(GWR_LOG_SYS_RESOURCE, (level), msg, ##__VA_ARGS__)
+
+#define RES_INITIAL_CAPACITY    64
+
+typedef enum {
+    STATE_LOADING = 0,
+    STATE_READY,
+    STATE_FAILED,           // out of the table, freed by whoever drops the last reference
+} state_e;
+
+struct GWR_resource_t {
+    GWR_resource_cache_t *cache;
+    GWR_resource_kind_e kind;
+    char *key;
+    uint64_t hash;
+    state_e state;
+    int refs;               // guarded by cache->mutex
+
+    void *object;           // GWR_texture_t * or GWR_shader_t *
+    int64_t size;
+    GLsync fence;           // set after the load, before READY is published
+    const GWR_window_t *context;
+
+    // LRU of unreferenced entries, or the eviction chain once unlinked
+    GWR_resource_t *lru_prev;
+    GWR_resource_t *lru_next;
+};
+
+struct GWR_resource_cache_t {
+    pthread_mutex_t mutex;
+    pthread_cond_t loaded;
+
+    // open addressing on res->hash, linear probing, NULL is empty
+    GWR_resource_t **slots;
+    size_t count;
+    size_t cap;             // power of two, kept at least twice count
+
+    GWR_resource_t *lru_head;   // least recently released
+    GWR_resource_t *lru_tail;
+
+    int64_t budget;
+    GWR_resource_stats_t stats;
+};
+
+typedef struct {
+    GWR_resource_kind_e kind;
+    const char *const *paths;
+    GLsizei count;
+    GLenum type;
+} load_args_t;
+
+// inner funcs decls
+
+static GWR_resource_t *acquire(GWR_resource_cache_t *cache, const load_args_t *args);
+static char *build_key(const load_args_t *args);
+
+static GWR_resource_t *find(const GWR_resource_cache_t *cache, const char *key, uint64_t hash);
+static bool table_add(GWR_resource_cache_t *cache, GWR_resource_t *res);
+static void table_remove(GWR_resource_cache_t *cache, const GWR_resource_t *res);
+
+static void lru_push(GWR_resource_cache_t *cache, GWR_resource_t *res);
+static void lru_unlink(GWR_resource_cache_t *cache, GWR_resource_t *res);
+static GWR_resource_t *evict_locked(GWR_resource_cache_t *cache, int64_t target, int64_t *freed);
+static void destroy_chain(GWR_resource_t *chain);
+
+static void *load(const load_args_t *args, int64_t *size);
+static void destroy_object(GWR_resource_kind_e kind, void *object);
+static void free_entry(GWR_resource_t *res);
+static void sync_context(const GWR_resource_t *res);
+
+// public funcs defs
+
+GWR_resource_cache_t *GWR_resource_cache_create(int64_t budget) {
+    assert(budget >= 0);
+
+    GWR_resource_cache_t *cache = calloc(1, sizeof(GWR_resource_cache_t));
+    if (!cache) {
+        RES_LOG(GWR_LOG_ERROR, "failed to allocate GWR_resource_cache_t");
+        return NULL;
+    }
+
+    cache->slots = calloc(RES_INITIAL_CAPACITY, sizeof(GWR_resource_t *));
+    if (!cache->slots) {
+        RES_LOG(GWR_LOG_ERROR, "failed to allocate slots");
+        free(cache);
+        return NULL;
+    }
+    cache->cap = RES_INITIAL_CAPACITY;
+    cache->budget = budget;
+
+    pthread_mutex_init(&cache->mutex, NULL);
+    pthread_cond_init(&cache->loaded, NULL);
+
+    return cache;
+}
+
+void GWR_resource_cache_destroy(GWR_resource_cache_t *cache) {
+    assert(cache);
+
+    for (size_t i = 0; i < cache->cap; ++i) {
+        GWR_resource_t *res = cache->slots[i];
+        if (!res) {
+            continue;
+        }
+        assert(res->state != STATE_LOADING);
+        if (res->refs > 0) {
+            RES_LOG(GWR_LOG_WARNING, "'%s' destroyed with %d references", res->key, res->refs);
+        }
+        destroy_object(res->kind, res->object);
+        free_entry(res);
+    }
+
+    pthread_cond_destroy(&cache->loaded);
+    pthread_mutex_destroy(&cache->mutex);
+    free(cache->slots);
+    free(cache);
+}
+
+void GWR_resource_cache_set_budget(GWR_resource_cache_t *cache, int64_t budget) {
+    assert(cache);
+    assert(budget >= 0);
+
+    int64_t freed = 0;
+    pthread_mutex_lock(&cache->mutex);
+    cache->budget = budget;
+    GWR_resource_t *evicted = evict_locked(cache, budget, &freed);
+    pthread_mutex_unlock(&cache->mutex);
+
+    destroy_chain(evicted);
+}
+
+int64_t GWR_resource_cache_trim(GWR_resource_cache_t *cache, int64_t target) {
+    assert(cache);
+    assert(target >= 0);
+
+    int64_t freed = 0;
+    pthread_mutex_lock(&cache->mutex);
+    GWR_resource_t *evicted = evict_locked(cache, target, &freed);
+    pthread_mutex_unlock(&cache->mutex);
+
+    destroy_chain(evicted);
+    return freed;
+}
+
+GWR_resource_stats_t GWR_resource_cache_get_stats(GWR_resource_cache_t *cache) {
+    assert(cache);
+
+    pthread_mutex_lock(&cache->mutex);
+    const GWR_resource_stats_t stats = cache->stats;
+    pthread_mutex_unlock(&cache->mutex);
+
+    return stats;
+}
+
+GWR_resource_t *GWR_resource_acquire_texture(GWR_resource_cache_t *cache, const char *path) {
+    assert(cache);
+    assert(path);
+
+    const load_args_t args = {.kind = GWR_RESOURCE_TEXTURE, .paths = &path, .count = 1};
+    return acquire(cache, &args);
+}
+
+GWR_resource_t *GWR_resource_acquire_texture_array(GWR_resource_cache_t *cache, const char *const *paths, GLsizei count) {
+    assert(cache);
+    assert(paths);
+    assert(count > 0);
+
+    const load_args_t args = {.kind = GWR_RESOURCE_TEXTURE_ARRAY, .paths = paths, .count = count};
+    return acquire(cache, &args);
+}
+
+GWR_resource_t *GWR_resource_acquire_shader(GWR_resource_cache_t *cache, const char *vertex_path, const char *fragment_path) {
+    assert(cache);
+    assert(vertex_path);
+    assert(fragment_path);
+
+    const char *paths[] = {vertex_path, fragment_path};
+    const load_args_t args = {.kind = GWR_RESOURCE_SHADER, .paths = paths, .count = 2};
+    return acquire(cache, &args);
+}
+
+GWR_resource_t *GWR_resource_acquire_separable(GWR_resource_cache_t *cache, GLenum type, const char *path) {
+    assert(cache);
+    assert(path);
+
+    const load_args_t args = {.kind = GWR_RESOURCE_SEPARABLE, .paths = &path, .count = 1, .type = type};
+    return acquire(cache, &args);
+}
+
+void GWR_resource_retain(GWR_resource_t *res) {
+    assert(res);
+
+    pthread_mutex_lock(&res->cache->mutex);
+    assert(res->refs > 0);
+    ++res->refs;
+    pthread_mutex_unlock(&res->cache->mutex);
+}
+
+void GWR_resource_release(GWR_resource_t *res) {
+    assert(res);
+
+    GWR_resource_cache_t *cache = res->cache;
+    GWR_resource_t *evicted = NULL;
+    int64_t freed = 0;
+
+    pthread_mutex_lock(&cache->mutex);
+    assert(res->refs > 0);
+    assert(res->state == STATE_READY);
+    if (--res->refs == 0) {
+        lru_push(cache, res);
+        evicted = evict_locked(cache, cache->budget, &freed);
+    }
+    pthread_mutex_unlock(&cache->mutex);
+
+    destroy_chain(evicted);
+}
+
+GWR_resource_kind_e GWR_resource_get_kind(const GWR_resource_t *res) {
+    assert(res);
+
+    return res->kind;
+}
+
+GWR_texture_t *GWR_resource_get_texture(const GWR_resource_t *res) {
+    assert(res);
+
+    return res->kind == GWR_RESOURCE_TEXTURE || res->kind == GWR_RESOURCE_TEXTURE_ARRAY ? res->object : NULL;
+}
+
+GWR_shader_t *GWR_resource_get_shader(const GWR_resource_t *res) {
+    assert(res);
+
+    return res->kind == GWR_RESOURCE_SHADER || res->kind == GWR_RESOURCE_SEPARABLE ? res->object : NULL;
+}
+
+int GWR_resource_get_refs(GWR_resource_t *res) {
+    assert(res);
+
+    pthread_mutex_lock(&res->cache->mutex);
+    const int refs = res->refs;
+    pthread_mutex_unlock(&res->cache->mutex);
+
+    return refs;
+}
+
+int64_t GWR_resource_get_size(const GWR_resource_t *res) {
+    assert(res);
+
+    return res->size;
+}
+
+// inner funcs defs
+
+static GWR_resource_t *acquire(GWR_resource_cache_t *cache, const load_args_t *args) {
+    char *key = build_key(args);
+    if (!key) {
+        RES_LOG(GWR_LOG_ERROR, "failed to allocate key");
+        return NULL;
+    }
+    const uint64_t hash = GWR_fnv1a_str(GWR_FNV_OFFSET, key);
+
+    pthread_mutex_lock(&cache->mutex);
+    ++cache->stats.requests;
+
+    GWR_resource_t *res = find(cache, key, hash);
+    if (res) {
+        free(key);
+        if (res->refs++ == 0 && res->state == STATE_READY) {
+            lru_unlink(cache, res);
+        }
+
+        if (res->state == STATE_LOADING) {
+            ++cache->stats.waits;
+            while (res->state == STATE_LOADING) {
+                pthread_cond_wait(&cache->loaded, &cache->mutex);
+            }
+        } else {
+            ++cache->stats.hits;
+        }
+
+        if (res->state == STATE_FAILED) {
+            const bool last = --res->refs == 0;
+            pthread_mutex_unlock(&cache->mutex);
+            if (last) {
+                free_entry(res);
+            }
+            return NULL;
+        }
+
+        pthread_mutex_unlock(&cache->mutex);
+        sync_context(res);
+        return res;
+    }
+
+    res = calloc(1, sizeof(GWR_resource_t));
+    if (!res || !table_add(cache, res)) {
+        pthread_mutex_unlock(&cache->mutex);
+        RES_LOG(GWR_LOG_ERROR, "failed to allocate an entry for '%s'", key);
+        free(res);
+        free(key);
+        return NULL;
+    }
+    res->cache = cache;
+    res->kind = args->kind;
+    res->key = key;
+    res->hash = hash;
+    res->state = STATE_LOADING;
+    res->refs = 1;
+    pthread_mutex_unlock(&cache->mutex);
+
+    // loading runs unlocked; acquires of the same key wait on `loaded`
+    int64_t size = 0;
+    void *object = load(args, &size);
+    GLsync fence = NULL;
+    if (object) {
+        fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        // other contexts can only wait on a fence that has been flushed
+        glFlush();
+    }
+
+    GWR_resource_t *evicted = NULL;
+    int64_t freed = 0;
+
+    pthread_mutex_lock(&cache->mutex);
+    if (object) {
+        res->object = object;
+        res->size = size;
+        res->fence = fence;
+        res->context = GWR_window_get_current();
+        res->state = STATE_READY;
+        ++cache->stats.loads;
+        ++cache->stats.resident;
+        cache->stats.resident_bytes += size;
+        evicted = evict_locked(cache, cache->budget, &freed);
+    } else {
+        res->state = STATE_FAILED;
+        ++cache->stats.failures;
+        table_remove(cache, res);
+    }
+    pthread_cond_broadcast(&cache->loaded);
+
+    bool last = false;
+    if (!object) {
+        last = --res->refs == 0;
+    }
+    pthread_mutex_unlock(&cache->mutex);
+
+    destroy_chain(evicted);
+    if (!object) {
+        if (last) {
+            free_entry(res);
+        }
+        return NULL;
+    }
+    return res;
+}
+
+// kind and resolved paths, newline separated
+static char *build_key(const load_args_t *args) {
+    static const char *prefixes[] = {"texture", "texture array", "shader", "separable"};
+
+    char head[48];
+    if (args->kind == GWR_RESOURCE_SEPARABLE) {
+        snprintf(head, sizeof(head), "%s 0x%x", prefixes[args->kind], (unsigned) args->type);
+    } else {
+        snprintf(head, sizeof(head), "%s", prefixes[args->kind]);
+    }
+
+    char **resolved = calloc((size_t) args->count, sizeof(char *));
+    if (!resolved) {
+        return NULL;
+    }
+
+    size_t len = strlen(head) + 1;
+    for (GLsizei i = 0; i < args->count; ++i) {
+        // a path that does not resolve is keyed as given and fails to load anyway
+        resolved[i] = realpath(args->paths[i], NULL);
+        len += strlen(resolved[i] ? resolved[i] : args->paths[i]) + 1;
+    }
+
+    char *key = malloc(len);
+    if (key) {
+        char *p = key + sprintf(key, "%s", head);
+        for (GLsizei i = 0; i < args->count; ++i) {
+            p += sprintf(p, "\n%s", resolved[i] ? resolved[i] : args->paths[i]);
+        }
+    }
+
+    for (GLsizei i = 0; i < args->count; ++i) {
+        free(resolved[i]);
+    }
+    free(resolved);
+
+    return key;
+}
+
+static GWR_resource_t *find(const GWR_resource_cache_t *cache, const char *key, uint64_t hash) {
+    const size_t mask = cache->cap - 1;
+    for (size_t i = hash & mask; cache->slots[i]; i = (i + 1) & mask) {
+        GWR_resource_t *res = cache->slots[i];
+        if (res->hash == hash && strcmp(res->key, key) == 0) {
+            return res;
+        }
+    }
+    return NULL;
+}
+
+static bool table_add(GWR_resource_cache_t *cache, GWR_resource_t *res) {
+    if ((cache->count + 1) * 2 > cache->cap) {
+        const size_t new_cap = cache->cap * 2;
+        GWR_resource_t **slots = calloc(new_cap, sizeof(GWR_resource_t *));
+        if (!slots) {
+            return false;
+        }
+        for (size_t i = 0; i < cache->cap; ++i) {
+            GWR_resource_t *old = cache->slots[i];
+            if (old) {
+                size_t k = old->hash & (new_cap - 1);
+                while (slots[k]) {
+                    k = (k + 1) & (new_cap - 1);
+                }
+                slots[k] = old;
+            }
+        }
+        free(cache->slots);
+        cache->slots = slots;
+        cache->cap = new_cap;
+    }
+
+    const size_t mask = cache->cap - 1;
+    size_t i = res->hash & mask;
+    while (cache->slots[i]) {
+        i = (i + 1) & mask;
+    }
+    cache->slots[i] = res;
+    ++cache->count;
+    return true;
+}
+
+static void table_remove(GWR_resource_cache_t *cache, const GWR_resource_t *res) {
+    const size_t mask = cache->cap - 1;
+    size_t i = res->hash & mask;
+    while (cache->slots[i] != res) {
+        if (!cache->slots[i]) {
+            return;
+        }
+        i = (i + 1) & mask;
+    }
+
+    // backward shift: later members of the probe run move into the hole so
+    // lookups never stop early at it
+    cache->slots[i] = NULL;
+    for (size_t j = (i + 1) & mask; cache->slots[j]; j = (j + 1) & mask) {
+        const size_t home = cache->slots[j]->hash & mask;
+        // slot j may stay only if its home lies cyclically in (i, j]
+        const bool stays = i < j ? (home > i && home <= j) : (home > i || home <= j);
+        if (!stays) {
+            cache->slots[i] = cache->slots[j];
+            cache->slots[j] = NULL;
+            i = j;
+        }
+    }
+    --cache->count;
+}
+
+static void lru_push(GWR_resource_cache_t *cache, GWR_resource_t *res) {
+    res->lru_prev = cache->lru_tail;
+    res->lru_next = NULL;
+    if (cache->lru_tail) {
+        cache->lru_tail->lru_next = res;
+    } else {
+        cache->lru_head = res;
+    }
+    cache->lru_tail = res;
+
+    ++cache->stats.unused;
+    cache->stats.unused_bytes += res->size;
+}
+
+static void lru_unlink(GWR_resource_cache_t *cache, GWR_resource_t *res) {
+    if (res->lru_prev) {
+        res->lru_prev->lru_next = res->lru_next;
+    } else {
+        cache->lru_head = res->lru_next;
+    }
+    if (res->lru_next) {
+        res->lru_next->lru_prev = res->lru_prev;
+    } else {
+        cache->lru_tail = res->lru_prev;
+    }
+    res->lru_prev = NULL;
+    res->lru_next = NULL;
+
+    --cache->stats.unused;
+    cache->stats.unused_bytes -= res->size;
+}
+
+// unlinks entries and returns them chained through lru_next; GL objects are
+// destroyed by the caller after the mutex is dropped
+static GWR_resource_t *evict_locked(GWR_resource_cache_t *cache, int64_t target, int64_t *freed) {
+    GWR_resource_t *chain = NULL;
+
+    while (cache->stats.resident_bytes > target && cache->lru_head) {
+        GWR_resource_t *res = cache->lru_head;
+        lru_unlink(cache, res);
+        table_remove(cache, res);
+
+        --cache->stats.resident;
+        cache->stats.resident_bytes -= res->size;
+        ++cache->stats.evictions;
+        *freed += res->size;
+
+        res->lru_next = chain;
+        chain = res;
+    }
+
+    return chain;
+}
+
+static void destroy_chain(GWR_resource_t *chain) {
+    while (chain) {
+        GWR_resource_t *next = chain->lru_next;
+        RES_LOG(GWR_LOG_INFO, "evicted '%s' (%lld bytes)", chain->key, (long long) chain->size);
+        destroy_object(chain->kind, chain->object);
+        free_entry(chain);
+        chain = next;
+    }
+}
+
+static void *load(const load_args_t *args, int64_t *size) {
+    switch (args->kind) {
+        case GWR_RESOURCE_TEXTURE:
+        case GWR_RESOURCE_TEXTURE_ARRAY: {
+            GWR_texture_t *tex = args->kind == GWR_RESOURCE_TEXTURE
+                                     ? GWR_texture_load(args->paths[0])
+                                     : GWR_texture_load_array(args->paths, args->count);
+            if (tex) {
+                *size = GWR_texture_get_memory_size(tex);
+            }
+            return tex;
+        }
+        case GWR_RESOURCE_SHADER:
+        case GWR_RESOURCE_SEPARABLE: {
+            GWR_shader_t *shader = args->kind == GWR_RESOURCE_SHADER
+                                       ? GWR_shader_create_path(args->paths[0], args->paths[1])
+                                       : GWR_shader_create_separable_path(args->type, args->paths[0]);
+            if (shader && !GWR_shader_is_valid(shader)) {
+                GWR_shader_destroy(shader);
+                shader = NULL;
+            }
+            if (shader) {
+                // the driver's own size for the linked program; 0 where it does not say
+                GLint length = 0;
+                glGetProgramiv(GWR_shader_get_id(shader), GL_PROGRAM_BINARY_LENGTH, &length);
+                *size = length;
+            }
+            return shader;
+        }
+    }
+
+    return NULL;
+}
+
+static void destroy_object(GWR_resource_kind_e kind, void *object) {
+    if (!object) {
+        return;
+    }
+
+    if (kind == GWR_RESOURCE_TEXTURE || kind == GWR_RESOURCE_TEXTURE_ARRAY) {
+        GWR_texture_destroy(object);
+    } else {
+        GWR_shader_destroy(object);
+    }
+}
+
+static void free_entry(GWR_resource_t *res) {
+    if (res->fence) {
+        glDeleteSync(res->fence);
+    }
+    free(res->key);
+    free(res);
+}
+
+static void sync_context(const GWR_resource_t *res) {
+    if (res->fence && res->context != GWR_window_get_current()) {
+        glWaitSync(res->fence, 0, GL_TIMEOUT_IGNORED);
+    }
+}
@@ -0,0 +1,359 @@
+#include "internal/gwr_sampler.h"
+#include "internal/gwr_log.h"
+#include "internal/gwr_cap.h"
+#include "internal/gwr_math.h"
+#include "internal/gwr_util.h"
+#include "internal/gwr_debug.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+#define SAMPLER_LOG(level, msg, ...)    GWR_LOG_AT(GWR_LOG_SYS_SAMPLER, (level), msg, ##__VA_ARGS__)
+
+#define SAMPLER_CACHE_INITIAL_CAPACITY 16
+#define SAMPLER_BIND_BATCH 32
+
+
+struct GWR_sampler_t {
+    GLuint id;
+    GWR_sampler_desc_t desc;
+};
+
+typedef struct {
+    uint64_t hash;
+    GWR_sampler_t *sampler;
+} sampler_entry_t;
+
+struct GWR_sampler_cache_t {
+    sampler_entry_t *entries;
+    size_t count;
+    size_t capacity;
+    GWR_sampler_cache_stats_t stats;
+};
+
+// inner funcs decls
+
+static GWR_sampler_desc_t normalize(const GWR_sampler_desc_t *desc);
+static uint64_t hash_desc(const GWR_sampler_desc_t *desc);
+static bool desc_equal(const GWR_sampler_desc_t *a, const GWR_sampler_desc_t *b);
+static bool uses_border(const GWR_sampler_desc_t *desc);
+static const char *filter_name(GLenum filter);
+static const char *wrap_name(GLenum wrap);
+
+// public funcs defs
+
+GWR_sampler_desc_t GWR_sampler_desc_default(void) {
+    return (GWR_sampler_desc_t) {
+        .min_filter = GL_LINEAR_MIPMAP_LINEAR,
+        .mag_filter = GL_LINEAR,
+        .wrap_s = GL_REPEAT,
+        .wrap_t = GL_REPEAT,
+        .wrap_r = GL_REPEAT,
+        .max_anisotropy = 1.f,
+        .lod_bias = 0.f,
+        .min_lod = -1000.f,
+        .max_lod = 1000.f,
+        .compare = false,
+        .compare_func = GL_LEQUAL,
+        .border_color = {0.f, 0.f, 0.f, 0.f},
+    };
+}
+
+GWR_sampler_desc_t GWR_sampler_desc_clamp_linear(void) {
+    GWR_sampler_desc_t desc = GWR_sampler_desc_default();
+    desc.min_filter = GL_LINEAR;
+    desc.wrap_s = desc.wrap_t = desc.wrap_r = GL_CLAMP_TO_EDGE;
+    return desc;
+}
+
+GWR_sampler_t *GWR_sampler_create(const GWR_sampler_desc_t *desc) {
+    assert(desc);
+
+    if (!GWR_cap_has(GWR_FEATURE_SAMPLER_OBJECTS)) {
+        SAMPLER_LOG(GWR_LOG_ERROR, "sampler objects are not supported");
+        return NULL;
+    }
+
+    GWR_sampler_t *sampler = calloc(1, sizeof(GWR_sampler_t));
+    if (!sampler) {
+        SAMPLER_LOG(GWR_LOG_ERROR, "failed to allocate GWR_sampler_t");
+        return NULL;
+    }
+    sampler->desc = normalize(desc);
+
+    // unlike other objects, generated sampler names are objects right away
+    if (GWR_cap_has(GWR_FEATURE_DIRECT_STATE_ACCESS)) {
+        glCreateSamplers(1, &sampler->id);
+    } else {
+        glGenSamplers(1, &sampler->id);
+    }
+    if (!sampler->id) {
+        SAMPLER_LOG(GWR_LOG_ERROR, "failed to create sampler");
+        free(sampler);
+        return NULL;
+    }
+
+    const GWR_sampler_desc_t *d = &sampler->desc;
+    const GLuint id = sampler->id;
+    glSamplerParameteri(id, GL_TEXTURE_MIN_FILTER, (GLint) d->min_filter);
+    glSamplerParameteri(id, GL_TEXTURE_MAG_FILTER, (GLint) d->mag_filter);
+    glSamplerParameteri(id, GL_TEXTURE_WRAP_S, (GLint) d->wrap_s);
+    glSamplerParameteri(id, GL_TEXTURE_WRAP_T, (GLint) d->wrap_t);
+    glSamplerParameteri(id, GL_TEXTURE_WRAP_R, (GLint) d->wrap_r);
+    glSamplerParameterf(id, GL_TEXTURE_LOD_BIAS, d->lod_bias);
+    glSamplerParameterf(id, GL_TEXTURE_MIN_LOD, d->min_lod);
+    glSamplerParameterf(id, GL_TEXTURE_MAX_LOD, d->max_lod);
+    if (d->compare) {
+        glSamplerParameteri(id, GL_TEXTURE_COMPARE_MODE, GL_COMPARE_REF_TO_TEXTURE);
+        glSamplerParameteri(id, GL_TEXTURE_COMPARE_FUNC, (GLint) d->compare_func);
+    }
+    if (uses_border(d)) {
+        glSamplerParameterfv(id, GL_TEXTURE_BORDER_COLOR, d->border_color);
+    }
+    if (d->max_anisotropy > 1.f) {
+        glSamplerParameterf(id, GL_TEXTURE_MAX_ANISOTROPY, d->max_anisotropy);
+    }
+
+    // samplers have no creator to name them after, so spell out the state
+    GWR_debug_label(
+        GL_SAMPLER, id, "sampler %s/%s %s/%s/%s x%.0f%s",
+        filter_name(d->min_filter), filter_name(d->mag_filter),
+        wrap_name(d->wrap_s), wrap_name(d->wrap_t), wrap_name(d->wrap_r),
+        d->max_anisotropy, d->compare ? " compare" : ""
+    );
+
+    return sampler;
+}
+
+void GWR_sampler_destroy(GWR_sampler_t *sampler) {
+    assert(sampler);
+
+    glDeleteSamplers(1, &sampler->id);
+    free(sampler);
+}
+
+GLuint GWR_sampler_get_id(const GWR_sampler_t *sampler) {
+    assert(sampler);
+
+    return sampler->id;
+}
+
+const GWR_sampler_desc_t *GWR_sampler_get_desc(const GWR_sampler_t *sampler) {
+    assert(sampler);
+
+    return &sampler->desc;
+}
+
+void GWR_sampler_bind(GLuint unit, const GWR_sampler_t *sampler) {
+    glBindSampler(unit, sampler ? sampler->id : 0);
+}
+
+void GWR_sampler_bind_range(GLuint first, GLsizei count, const GWR_sampler_t *const *samplers) {
+    assert(count >= 0);
+
+    if (!GWR_cap_has(GWR_FEATURE_MULTI_BIND)) {
+        for (GLsizei i = 0; i < count; ++i) {
+            GWR_sampler_bind(first + (GLuint) i, samplers ? samplers[i] : NULL);
+        }
+        return;
+    }
+
+    if (!samplers) {
+        glBindSamplers(first, count, NULL);
+        return;
+    }
+
+    GLuint ids[SAMPLER_BIND_BATCH];
+    for (GLsizei base = 0; base < count; base += SAMPLER_BIND_BATCH) {
+        const GLsizei n = count - base < SAMPLER_BIND_BATCH ? count - base : SAMPLER_BIND_BATCH;
+        for (GLsizei i = 0; i < n; ++i) {
+            ids[i] = samplers[base + i] ? samplers[base + i]->id : 0;
+        }
+        glBindSamplers(first + (GLuint) base, n, ids);
+    }
+}
+
+GWR_sampler_cache_t *GWR_sampler_cache_create(void) {
+    GWR_sampler_cache_t *cache = calloc(1, sizeof(GWR_sampler_cache_t));
+    if (!cache) {
+        SAMPLER_LOG(GWR_LOG_ERROR, "failed to allocate GWR_sampler_cache_t");
+        return NULL;
+    }
+
+    cache->entries = malloc(SAMPLER_CACHE_INITIAL_CAPACITY * sizeof(sampler_entry_t));
+    if (!cache->entries) {
+        SAMPLER_LOG(GWR_LOG_ERROR, "failed to allocate entries");
+        free(cache);
+        return NULL;
+    }
+    cache->capacity = SAMPLER_CACHE_INITIAL_CAPACITY;
+
+    return cache;
+}
+
+void GWR_sampler_cache_destroy(GWR_sampler_cache_t *cache) {
+    assert(cache);
+
+    for (size_t i = 0; i < cache->count; ++i) {
+        GWR_sampler_destroy(cache->entries[i].sampler);
+    }
+    free(cache->entries);
+    free(cache);
+}
+
+const GWR_sampler_t *GWR_sampler_cache_get(GWR_sampler_cache_t *cache, const GWR_sampler_desc_t *desc) {
+    assert(cache);
+    assert(desc);
+
+    ++cache->stats.requests;
+
+    const GWR_sampler_desc_t norm = normalize(desc);
+    const uint64_t hash = hash_desc(&norm);
+
+    for (size_t i = 0; i < cache->count; ++i) {
+        const sampler_entry_t *e = &cache->entries[i];
+        if (e->hash == hash && desc_equal(&e->sampler->desc, &norm)) {
+            ++cache->stats.hits;
+            return e->sampler;
+        }
+    }
+
+    if (cache->count == cache->capacity) {
+        const size_t new_capacity = cache->capacity * 2;
+        sampler_entry_t *entries = realloc(cache->entries, new_capacity * sizeof(sampler_entry_t));
+        if (!entries) {
+            SAMPLER_LOG(GWR_LOG_ERROR, "failed to grow entries");
+            return NULL;
+        }
+        cache->entries = entries;
+        cache->capacity = new_capacity;
+    }
+
+    GWR_sampler_t *sampler = GWR_sampler_create(&norm);
+    if (!sampler) {
+        return NULL;
+    }
+
+    cache->entries[cache->count++] = (sampler_entry_t) {
+        .hash = hash,
+        .sampler = sampler,
+    };
+
+    return sampler;
+}
+
+GWR_sampler_cache_stats_t GWR_sampler_cache_get_stats(const GWR_sampler_cache_t *cache) {
+    assert(cache);
+
+    return cache->stats;
+}
+
+// inner funcs defs
+
+// clamps anisotropy and resets fields GL ignores, so descriptors that only
+// differ there share a sampler
+static GWR_sampler_desc_t normalize(const GWR_sampler_desc_t *desc) {
+    const GWR_sampler_desc_t def = GWR_sampler_desc_default();
+    GWR_sampler_desc_t n = *desc;
+
+    float max_aniso = 1.f;
+    if (GWR_cap_has(GWR_FEATURE_TEXTURE_FILTER_ANISOTROPIC)) {
+        max_aniso = GWR_cap_get_max_anisotropy();
+    }
+    n.max_anisotropy = GWR_clamp(n.max_anisotropy, 1.f, max_aniso > 1.f ? max_aniso : 1.f);
+
+    if (!n.compare) {
+        n.compare_func = def.compare_func;
+    }
+    if (!uses_border(&n)) {
+        memcpy(n.border_color, def.border_color, sizeof(n.border_color));
+    }
+    // a negative zero bias or border would otherwise hash apart from its positive twin
+    n.lod_bias += 0.f;
+    n.min_lod += 0.f;
+    n.max_lod += 0.f;
+    for (int i = 0; i < 4; ++i) {
+        n.border_color[i] += 0.f;
+    }
+
+    return n;
+}
+
+// the bool compare sits between enums, so the desc is not hashed as one blob
+static uint64_t hash_desc(const GWR_sampler_desc_t *d) {
+    uint64_t h = GWR_FNV_OFFSET;
+    const unsigned char compare = d->compare;
+
+    h = GWR_fnv1a(h, &d->min_filter, sizeof(d->min_filter));
+    h = GWR_fnv1a(h, &d->mag_filter, sizeof(d->mag_filter));
+    h = GWR_fnv1a(h, &d->wrap_s, sizeof(d->wrap_s));
+    h = GWR_fnv1a(h, &d->wrap_t, sizeof(d->wrap_t));
+    h = GWR_fnv1a(h, &d->wrap_r, sizeof(d->wrap_r));
+    h = GWR_fnv1a(h, &d->max_anisotropy, sizeof(d->max_anisotropy));
+    h = GWR_fnv1a(h, &d->lod_bias, sizeof(d->lod_bias));
+    h = GWR_fnv1a(h, &d->min_lod, sizeof(d->min_lod));
+    h = GWR_fnv1a(h, &d->max_lod, sizeof(d->max_lod));
+    h = GWR_fnv1a(h, &compare, sizeof(compare));
+    h = GWR_fnv1a(h, &d->compare_func, sizeof(d->compare_func));
+    h = GWR_fnv1a(h, d->border_color, sizeof(d->border_color));
+
+    return h;
+}
+
+static bool desc_equal(const GWR_sampler_desc_t *a, const GWR_sampler_desc_t *b) {
+    return a->min_filter == b->min_filter &&
+           a->mag_filter == b->mag_filter &&
+           a->wrap_s == b->wrap_s &&
+           a->wrap_t == b->wrap_t &&
+           a->wrap_r == b->wrap_r &&
+           a->max_anisotropy == b->max_anisotropy &&
+           a->lod_bias == b->lod_bias &&
+           a->min_lod == b->min_lod &&
+           a->max_lod == b->max_lod &&
+           a->compare == b->compare &&
+           a->compare_func == b->compare_func &&
+           memcmp(a->border_color, b->border_color, sizeof(a->border_color)) == 0;
+}
+
+static bool uses_border(const GWR_sampler_desc_t *desc) {
+    return desc->wrap_s == GL_CLAMP_TO_BORDER ||
+           desc->wrap_t == GL_CLAMP_TO_BORDER ||
+           desc->wrap_r == GL_CLAMP_TO_BORDER;
+}
+
+static const char *filter_name(GLenum filter) {
+    switch (filter) {
+        case GL_NEAREST:
+            return "nearest";
+        case GL_LINEAR:
+            return "linear";
+        case GL_NEAREST_MIPMAP_NEAREST:
+            return "nearest_mip_nearest";
+        case GL_LINEAR_MIPMAP_NEAREST:
+            return "linear_mip_nearest";
+        case GL_NEAREST_MIPMAP_LINEAR:
+            return "nearest_mip_linear";
+        case GL_LINEAR_MIPMAP_LINEAR:
+            return "trilinear";
+        default:
+            return "?";
+    }
+}
+
+static const char *wrap_name(GLenum wrap) {
+    switch (wrap) {
+        case GL_REPEAT:
+            return "repeat";
+        case GL_MIRRORED_REPEAT:
+            return "mirror";
+        case GL_CLAMP_TO_EDGE:
+            return "edge";
+        case GL_CLAMP_TO_BORDER:
+            return "border";
+        case GL_MIRROR_CLAMP_TO_EDGE:
+            return "mirror_edge";
+        default:
+            return "?";
+    }
+}
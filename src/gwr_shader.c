@@ -1,5 +1,9 @@
 #include "internal/gwr_shader.h"
+#include "internal/gwr_shader_preproc.h"
 #include "internal/gwr_log.h"
+#include "internal/gwr_cap.h"
+#include "internal/gwr_debug.h"
+#include "internal/gwr_util.h"
 
 #include <stdio.h>
 #include <stdlib.h>
@@ -7,10 +11,27 @@
 #include <string.h>
 #include <assert.h>
 
-#define SHADER_LOG(level, msg, ...)    GWR_log((level), "[SHADER]: " msg, ##__VA_ARGS__)
+#define SHADER_LOG(level, msg, ...)    GWR_LOG_AT(GWR_LOG_SYS_SHADER, (level), msg, ##__VA_ARGS__)
 
 struct GWR_shader_t {
     GLuint id;
+    uint32_t generation;
+
+    // GL_*_SHADER_BIT mask of a separable program, 0 for a monolithic one
+    GLbitfield stages;
+
+    // set by GWR_shader_create_path, used for reloads
+    char *vertex_path;
+    char *fragment_path;
+
+    // every file the last expansion of the path stages read, includes too
+    char **deps;
+    size_t dep_count;
+
+    // reload in flight, 0 if none
+    GLuint pending;
+    GLuint pending_vertex;
+    GLuint pending_fragment;
 };
 
 // helper funcs decls
@@ -49,7 +70,14 @@ static GLboolean check_compile_errors(GLuint shader_id, const char *type);
 
 static GLboolean check_link_errors(GLuint program);
 
-static char *read_from_text_file(const char *path, size_t *out_size);
+static char *expand_path(const char *path, char ***deps, size_t *dep_count);
+static void free_deps(char **deps, size_t count);
+static GLuint compile_path(GLenum type, const char *path, char ***deps, size_t *dep_count);
+
+static GLbitfield stage_bit(GLenum type);
+
+static GLuint submit_shader(GLenum type, const char *path, char ***deps, size_t *dep_count);
+static void drop_pending(GWR_shader_t *shader);
 
 // public API
 
@@ -92,26 +120,14 @@ GLuint GWR_shader_compile_src(GLenum type, const char *src) {
 GLuint GWR_shader_compile_path(GLenum type, const char *path) {
     assert(path);
 
-    size_t sz = 0;
-    char *src = read_from_text_file(path, &sz);
-    if (!src) {
-        SHADER_LOG(GWR_LOG_ERROR, "read failed: '%s'", path);
-        return 0;
-    }
-
-    const GLuint id = GWR_shader_compile_src(type, src);
-    if (!id) {
-        SHADER_LOG(GWR_LOG_ERROR, "compile failed: '%s'", path);
-    }
-    free(src);
-    return id;
+    return compile_path(type, path, NULL, NULL);
 }
 
 GWR_shader_t *GWR_shader_create(GLuint vertex_shader, GLuint fragment_shader) {
     assert(vertex_shader);
     assert(fragment_shader);
 
-    GWR_shader_t *shader = malloc(sizeof(GWR_shader_t));
+    GWR_shader_t *shader = calloc(1, sizeof(GWR_shader_t));
     if (!shader) {
         SHADER_LOG(GWR_LOG_ERROR, "failed to allocate shader_t");
         return NULL;
@@ -168,30 +184,123 @@ GWR_shader_t *GWR_shader_create_path(const char *vertex_shader_path, const char
     assert(vertex_shader_path);
     assert(fragment_shader_path);
 
-    const GLuint vertex_shader = GWR_shader_compile_path(GL_VERTEX_SHADER, vertex_shader_path);
+    char **deps = NULL;
+    size_t dep_count = 0;
+
+    const GLuint vertex_shader = compile_path(GL_VERTEX_SHADER, vertex_shader_path, &deps, &dep_count);
     if (vertex_shader == 0) {
+        free_deps(deps, dep_count);
         return NULL;
     }
 
-    const GLuint fragment_shader = GWR_shader_compile_path(GL_FRAGMENT_SHADER, fragment_shader_path);
+    const GLuint fragment_shader = compile_path(GL_FRAGMENT_SHADER, fragment_shader_path, &deps, &dep_count);
     if (fragment_shader == 0) {
         glDeleteShader(vertex_shader);
+        free_deps(deps, dep_count);
         return NULL;
     }
 
     GWR_shader_t *prog = GWR_shader_create(vertex_shader, fragment_shader);
     glDeleteShader(vertex_shader);
     glDeleteShader(fragment_shader);
+
+    if (!prog) {
+        free_deps(deps, dep_count);
+    } else {
+        prog->deps = deps;
+        prog->dep_count = dep_count;
+        GWR_debug_label(GL_PROGRAM, prog->id, "program '%s' + '%s'", vertex_shader_path, fragment_shader_path);
+        prog->vertex_path = GWR_dup_str(vertex_shader_path);
+        prog->fragment_path = GWR_dup_str(fragment_shader_path);
+        if (!prog->vertex_path || !prog->fragment_path) {
+            SHADER_LOG(GWR_LOG_WARNING, "failed to keep paths, '%s' will not reload", vertex_shader_path);
+        }
+    }
     return prog;
 }
 
+GWR_shader_t *GWR_shader_create_separable(GLenum type, GLuint stage_shader) {
+    assert(stage_shader);
+
+    const GLbitfield bit = stage_bit(type);
+    if (!bit) {
+        SHADER_LOG(GWR_LOG_ERROR, "unsupported separable stage 0x%x", type);
+        return NULL;
+    }
+
+    GWR_shader_t *shader = calloc(1, sizeof(GWR_shader_t));
+    if (!shader) {
+        SHADER_LOG(GWR_LOG_ERROR, "failed to allocate shader_t");
+        return NULL;
+    }
+
+    const GLuint program = glCreateProgram();
+    if (program == 0) {
+        SHADER_LOG(GWR_LOG_ERROR, "glCreateProgram failed");
+        free(shader);
+        return NULL;
+    }
+
+    shader->id = program;
+    shader->stages = bit;
+
+    glProgramParameteri(shader->id, GL_PROGRAM_SEPARABLE, GL_TRUE);
+    glAttachShader(shader->id, stage_shader);
+    glLinkProgram(shader->id);
+    glDetachShader(shader->id, stage_shader);
+
+    if (!check_link_errors(shader->id)) {
+        glDeleteProgram(shader->id);
+        free(shader);
+        return NULL;
+    }
+
+    return shader;
+}
+
+GWR_shader_t *GWR_shader_create_separable_src(GLenum type, const char *src) {
+    assert(src);
+
+    const GLuint stage_shader = GWR_shader_compile_src(type, src);
+    if (stage_shader == 0) {
+        return NULL;
+    }
+
+    GWR_shader_t *shader = GWR_shader_create_separable(type, stage_shader);
+    glDeleteShader(stage_shader);
+
+    return shader;
+}
+
+GWR_shader_t *GWR_shader_create_separable_path(GLenum type, const char *path) {
+    assert(path);
+
+    const GLuint stage_shader = GWR_shader_compile_path(type, path);
+    if (stage_shader == 0) {
+        return NULL;
+    }
+
+    GWR_shader_t *shader = GWR_shader_create_separable(type, stage_shader);
+    glDeleteShader(stage_shader);
+    if (shader) {
+        GWR_debug_label(GL_PROGRAM, shader->id, "separable program '%s'", path);
+    }
+
+    return shader;
+}
+
 void GWR_shader_destroy(GWR_shader_t *shader) {
     assert(shader);
     assert(shader->id);
 
+    drop_pending(shader);
+
     glDeleteProgram(shader->id);
     shader->id = 0;
 
+    free(shader->vertex_path);
+    free(shader->fragment_path);
+    free_deps(shader->deps, shader->dep_count);
     free(shader);
 }
 
@@ -216,6 +325,148 @@ GLint GWR_shader_get_uniform_loc(const GWR_shader_t *shader, const char *name) {
     return glGetUniformLocation(shader->id, name);
 }
 
+bool GWR_shader_can_reload(const GWR_shader_t *shader) {
+    assert(shader);
+
+    return shader->vertex_path && shader->fragment_path;
+}
+
+bool GWR_shader_reload_begin(GWR_shader_t *shader) {
+    assert(shader);
+
+    if (!GWR_shader_can_reload(shader)) {
+        SHADER_LOG(GWR_LOG_WARNING, "shader %u was not created from files", shader->id);
+        return false;
+    }
+
+    // a newer edit supersedes whatever is still compiling
+    drop_pending(shader);
+
+    if (GWR_cap_has(GWR_FEATURE_PARALLEL_SHADER_COMPILE)) {
+        if (glMaxShaderCompilerThreadsKHR) {
+            glMaxShaderCompilerThreadsKHR(0xFFFFFFFFu);
+        } else if (glMaxShaderCompilerThreadsARB) {
+            glMaxShaderCompilerThreadsARB(0xFFFFFFFFu);
+        }
+    }
+
+    char **deps = NULL;
+    size_t dep_count = 0;
+    shader->pending_vertex = submit_shader(GL_VERTEX_SHADER, shader->vertex_path, &deps, &dep_count);
+    shader->pending_fragment = submit_shader(GL_FRAGMENT_SHADER, shader->fragment_path, &deps, &dep_count);
+
+    // kept even when the compile fails, so fixing a newly included file reloads again
+    if (dep_count) {
+        free_deps(shader->deps, shader->dep_count);
+        shader->deps = deps;
+        shader->dep_count = dep_count;
+    } else {
+        free(deps);
+    }
+
+    shader->pending = glCreateProgram();
+    if (!shader->pending_vertex || !shader->pending_fragment || !shader->pending) {
+        drop_pending(shader);
+        return false;
+    }
+
+    // no status queries here: they would wait for the compile
+    glAttachShader(shader->pending, shader->pending_vertex);
+    glAttachShader(shader->pending, shader->pending_fragment);
+    glLinkProgram(shader->pending);
+
+    return true;
+}
+
+void GWR_shader_reload_cancel(GWR_shader_t *shader) {
+    assert(shader);
+
+    drop_pending(shader);
+}
+
+GWR_shader_reload_e GWR_shader_reload_poll(GWR_shader_t *shader) {
+    assert(shader);
+
+    if (!shader->pending) {
+        return GWR_SHADER_RELOAD_IDLE;
+    }
+
+    if (GWR_cap_has(GWR_FEATURE_PARALLEL_SHADER_COMPILE)) {
+        GLint done = GL_FALSE;
+        glGetProgramiv(shader->pending, GL_COMPLETION_STATUS_KHR, &done);
+        if (!done) {
+            return GWR_SHADER_RELOAD_PENDING;
+        }
+    }
+
+    const bool ok =
+        check_compile_errors(shader->pending_vertex, shader->vertex_path) &&
+        check_compile_errors(shader->pending_fragment, shader->fragment_path) &&
+        check_link_errors(shader->pending);
+
+    if (!ok) {
+        SHADER_LOG(GWR_LOG_ERROR, "reload of '%s' failed, keeping program %u", shader->vertex_path, shader->id);
+        drop_pending(shader);
+        return GWR_SHADER_RELOAD_FAILED;
+    }
+
+    glDetachShader(shader->pending, shader->pending_vertex);
+    glDetachShader(shader->pending, shader->pending_fragment);
+    glDeleteShader(shader->pending_vertex);
+    glDeleteShader(shader->pending_fragment);
+    shader->pending_vertex = 0;
+    shader->pending_fragment = 0;
+
+    glDeleteProgram(shader->id);
+    shader->id = shader->pending;
+    shader->pending = 0;
+    ++shader->generation;
+    GWR_debug_label(
+        GL_PROGRAM, shader->id, "program '%s' + '%s' (reload %u)",
+        shader->vertex_path, shader->fragment_path, shader->generation
+    );
+
+    SHADER_LOG(GWR_LOG_INFO, "reloaded '%s' as program %u", shader->vertex_path, shader->id);
+    return GWR_SHADER_RELOAD_SWAPPED;
+}
+
+uint32_t GWR_shader_get_generation(const GWR_shader_t *shader) {
+    assert(shader);
+
+    return shader->generation;
+}
+
+GLbitfield GWR_shader_get_stages(const GWR_shader_t *shader) {
+    assert(shader);
+
+    return shader->stages;
+}
+
+size_t GWR_shader_get_dep_count(const GWR_shader_t *shader) {
+    assert(shader);
+
+    return shader->dep_count;
+}
+
+const char *GWR_shader_get_dep(const GWR_shader_t *shader, size_t idx) {
+    assert(shader);
+
+    return idx < shader->dep_count ? shader->deps[idx] : NULL;
+}
+
+const char *GWR_shader_get_path(const GWR_shader_t *shader, GLenum type) {
+    assert(shader);
+
+    switch (type) {
+        case GL_VERTEX_SHADER:
+            return shader->vertex_path;
+        case GL_FRAGMENT_SHADER:
+            return shader->fragment_path;
+        default:
+            return NULL;
+    }
+}
+
 void GWR_shader_set_val_loc(
     const GWR_shader_t *shader,
     GLint loc,
@@ -523,50 +774,115 @@ static GLboolean check_link_errors(GLuint program) {
     return GL_TRUE;
 }
 
-static char *read_from_text_file(const char *path, size_t *out_size) {
-    assert(path);
+// reads through the VFS and resolves #include; appends the files it read to
+// deps (skipping ones already there) when deps is not NULL
+static char *expand_path(const char *path, char ***deps, size_t *dep_count) {
+    GWR_shader_preproc_t *pp = GWR_shader_preproc_create();
+    if (!pp) {
+        return NULL;
+    }
 
-    if (out_size) {
-        *out_size = 0;
+    char *src = GWR_shader_preproc_run_path(pp, path, NULL, 0);
+
+    const size_t n = deps ? GWR_shader_preproc_get_file_count(pp) : 0;
+    for (size_t i = 0; i < n; ++i) {
+        const char *file = GWR_shader_preproc_get_file(pp, i);
+        bool known = false;
+        for (size_t k = 0; k < *dep_count && !known; ++k) {
+            known = strcmp((*deps)[k], file) == 0;
+        }
+        if (known) {
+            continue;
+        }
+
+        char **grown = realloc(*deps, (*dep_count + 1) * sizeof(char *));
+        char *copy = grown ? GWR_dup_str(file) : NULL;
+        if (grown) {
+            *deps = grown;
+        }
+        if (!copy) {
+            SHADER_LOG(GWR_LOG_WARNING, "failed to record '%s' as a dependency of '%s'", file, path);
+            break;
+        }
+        (*deps)[(*dep_count)++] = copy;
     }
 
-    FILE *f = fopen(path, "rb");
-    if (!f) {
-        SHADER_LOG(GWR_LOG_ERROR, "can't open file: '%s'", path);
-        return NULL;
+    GWR_shader_preproc_destroy(pp);
+    return src;
+}
+
+static void free_deps(char **deps, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        free(deps[i]);
     }
+    free(deps);
+}
 
-    if (fseek(f, 0, SEEK_END) != 0) {
-        fclose(f);
-        return NULL;
+static GLuint compile_path(GLenum type, const char *path, char ***deps, size_t *dep_count) {
+    char *src = expand_path(path, deps, dep_count);
+    if (!src) {
+        SHADER_LOG(GWR_LOG_ERROR, "read failed: '%s'", path);
+        return 0;
     }
-    const long len = ftell(f);
-    if (len < 0) {
-        fclose(f);
-        return NULL;
+
+    const GLuint id = GWR_shader_compile_src(type, src);
+    if (!id) {
+        SHADER_LOG(GWR_LOG_ERROR, "compile failed: '%s'", path);
     }
-    if (fseek(f, 0, SEEK_SET) != 0) {
-        fclose(f);
-        return NULL;
+    free(src);
+    return id;
+}
+
+static GLbitfield stage_bit(GLenum type) {
+    switch (type) {
+        case GL_VERTEX_SHADER:
+            return GL_VERTEX_SHADER_BIT;
+        case GL_FRAGMENT_SHADER:
+            return GL_FRAGMENT_SHADER_BIT;
+        case GL_GEOMETRY_SHADER:
+            return GL_GEOMETRY_SHADER_BIT;
+        case GL_TESS_CONTROL_SHADER:
+            return GL_TESS_CONTROL_SHADER_BIT;
+        case GL_TESS_EVALUATION_SHADER:
+            return GL_TESS_EVALUATION_SHADER_BIT;
+        case GL_COMPUTE_SHADER:
+            return GL_COMPUTE_SHADER_BIT;
+        default:
+            return 0;
     }
+}
 
-    const size_t n = len;
-    char *buf = malloc(n + 1);
-    if (!buf) {
-        fclose(f);
-        return NULL;
+static GLuint submit_shader(GLenum type, const char *path, char ***deps, size_t *dep_count) {
+    char *src = expand_path(path, deps, dep_count);
+    if (!src) {
+        SHADER_LOG(GWR_LOG_ERROR, "read failed: '%s'", path);
+        return 0;
     }
 
-    const size_t rd = fread(buf, 1, n, f);
-    fclose(f);
-    if (rd != n) {
-        free(buf);
-        return NULL;
+    const GLuint id = glCreateShader(type);
+    if (id) {
+        const char *srcs[] = {src};
+        glShaderSource(id, 1, srcs, NULL);
+        glCompileShader(id);
+    } else {
+        SHADER_LOG(GWR_LOG_ERROR, "glCreateShader failed");
     }
 
-    buf[n] = '\0';
-    if (out_size) {
-        *out_size = n;
+    free(src);
+    return id;
+}
+
+static void drop_pending(GWR_shader_t *shader) {
+    if (shader->pending) {
+        glDeleteProgram(shader->pending);
+        shader->pending = 0;
+    }
+    if (shader->pending_vertex) {
+        glDeleteShader(shader->pending_vertex);
+        shader->pending_vertex = 0;
+    }
+    if (shader->pending_fragment) {
+        glDeleteShader(shader->pending_fragment);
+        shader->pending_fragment = 0;
     }
-    return buf;
 }
@@ -0,0 +1,811 @@
+#include "internal/gwr_shader_preproc.h"
+#include "internal/gwr_log.h"
+#include "internal/gwr_util.h"
+#include "internal/gwr_vfs.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <stdbool.h>
+#include <string.h>
+#include <ctype.h>
+#include <assert.h>
+
+#define PREPROC_LOG(level, msg, ...)    GWR_LOG_AT(GWR_LOG_SYS_SHADER_PREPROC, (level), msg, ##__VA_ARGS__)
+
+#define PREPROC_PATH_SIZE           1024
+#define PREPROC_INITIAL_CAPACITY    4096
+#define PREPROC_MAX_IF_DEPTH        64
+
+typedef struct {
+    char *data;
+    size_t len;
+    size_t cap;
+    bool failed;
+} str_buf_t;
+
+// what the preprocessor can tell about a conditional branch; ordered so the
+// state of a nested branch is the minimum over the enclosing ones
+typedef enum {
+    COND_DEAD = 0,
+    COND_UNKNOWN,
+    COND_LIVE,
+} cond_e;
+
+typedef struct {
+    cond_e state;           // of the current branch
+    cond_e taken;           // best state of the branches before it
+} cond_frame_t;
+
+// macros defined by the define set and by #define lines in live code
+typedef struct {
+    char *name;
+    char *value;            // NULL if not known
+    bool maybe;             // (un)defined in a branch that could not be decided
+} macro_t;
+
+struct GWR_shader_preproc_t {
+    char *include_paths[GWR_SHADER_PREPROC_MAX_INCLUDE_PATHS];
+    size_t include_path_count;
+
+    // per run
+    char **files;
+    size_t file_count;
+    size_t file_cap;
+    bool *once;             // parallel to files
+    macro_t *macros;
+    size_t macro_count;
+    size_t macro_cap;
+};
+
+// inner funcs decls
+
+static bool sb_reserve(str_buf_t *sb, size_t n);
+static void sb_append(str_buf_t *sb, const char *s, size_t n);
+static void sb_printf(str_buf_t *sb, const char *fmt, ...) __attribute__((format(printf, 2, 3)));
+
+static char *read_file(const char *path);
+static bool file_exists(const char *path);
+static void reset_files(GWR_shader_preproc_t *pp);
+static void reset_macros(GWR_shader_preproc_t *pp);
+static const macro_t *find_macro(const GWR_shader_preproc_t *pp, const char *name, size_t len);
+static bool set_macro(
+    GWR_shader_preproc_t *pp, const char *name, size_t len, const char *value, size_t value_len, bool maybe
+);
+static void remove_macro(GWR_shader_preproc_t *pp, const char *name, size_t len);
+static int add_file(GWR_shader_preproc_t *pp, const char *path);
+static int find_file(const GWR_shader_preproc_t *pp, const char *path);
+
+static int resolve_include(
+    const GWR_shader_preproc_t *pp, const char *from, const char *name, bool quoted, char *out, size_t out_size
+);
+static bool directive_is(const char *line, const char *end, const char *name, const char **rest);
+static const char *skip_space(const char *p, const char *end);
+static const char *skip_ident(const char *p, const char *end);
+static bool is_builtin(const char *name, size_t len);
+static cond_e eval_defined(const GWR_shader_preproc_t *pp, const char *p, const char *end, const char **after);
+static cond_e eval_if(const GWR_shader_preproc_t *pp, const char *p, const char *end);
+static cond_e region_state(const cond_frame_t *conds, int depth);
+static bool track_define(GWR_shader_preproc_t *pp, const char *p, const char *end, cond_e state);
+static void track_undef(GWR_shader_preproc_t *pp, const char *p, const char *end, cond_e state);
+static bool expand(
+    GWR_shader_preproc_t *pp, str_buf_t *sb, const char *src, int file_idx, int depth, const char **version_line
+);
+
+// public funcs defs
+
+GWR_shader_preproc_t *GWR_shader_preproc_create(void) {
+    GWR_shader_preproc_t *pp = calloc(1, sizeof(GWR_shader_preproc_t));
+    if (!pp) {
+        PREPROC_LOG(GWR_LOG_ERROR, "failed to allocate GWR_shader_preproc_t");
+        return NULL;
+    }
+    return pp;
+}
+
+void GWR_shader_preproc_destroy(GWR_shader_preproc_t *pp) {
+    assert(pp);
+
+    for (size_t i = 0; i < pp->include_path_count; ++i) {
+        free(pp->include_paths[i]);
+    }
+    reset_files(pp);
+    reset_macros(pp);
+    free(pp->files);
+    free(pp->once);
+    free(pp->macros);
+    free(pp);
+}
+
+bool GWR_shader_preproc_add_include_path(GWR_shader_preproc_t *pp, const char *dir) {
+    assert(pp);
+    assert(dir);
+
+    if (pp->include_path_count == GWR_SHADER_PREPROC_MAX_INCLUDE_PATHS) {
+        PREPROC_LOG(GWR_LOG_ERROR, "too many include paths (max %d)", GWR_SHADER_PREPROC_MAX_INCLUDE_PATHS);
+        return false;
+    }
+
+    char *copy = GWR_dup_str(dir);
+    if (!copy) {
+        PREPROC_LOG(GWR_LOG_ERROR, "failed to allocate include path");
+        return false;
+    }
+
+    // strip trailing slashes so joining is uniform
+    size_t len = strlen(copy);
+    while (len > 1 && copy[len - 1] == '/') {
+        copy[--len] = '\0';
+    }
+
+    pp->include_paths[pp->include_path_count++] = copy;
+    return true;
+}
+
+char *GWR_shader_preproc_run(
+    GWR_shader_preproc_t *pp,
+    const char *src,
+    const char *origin,
+    const GWR_shader_define_t *defines,
+    size_t define_count
+) {
+    assert(pp);
+    assert(src);
+    assert(defines || !define_count);
+
+    reset_files(pp);
+    reset_macros(pp);
+    if (add_file(pp, origin ? origin : "<source>") < 0) {
+        return NULL;
+    }
+    for (size_t i = 0; i < define_count; ++i) {
+        assert(defines[i].name);
+        const char *value = defines[i].value ? defines[i].value : "1";
+        if (!set_macro(pp, defines[i].name, strlen(defines[i].name), value, strlen(value), false)) {
+            return NULL;
+        }
+    }
+
+    str_buf_t body = {0};
+    const char *version_line = NULL;
+    const bool ok = expand(pp, &body, src, 0, 0, &version_line);
+    if (!ok || body.failed) {
+        if (body.failed) {
+            PREPROC_LOG(GWR_LOG_ERROR, "out of memory expanding '%s'", pp->files[0]);
+        }
+        free(body.data);
+        return NULL;
+    }
+
+    str_buf_t out = {0};
+    if (version_line) {
+        const char *eol = strchr(version_line, '\n');
+        sb_append(&out, version_line, eol ? (size_t) (eol - version_line) : strlen(version_line));
+        sb_append(&out, "\n", 1);
+    }
+    for (size_t i = 0; i < define_count; ++i) {
+        sb_printf(&out, "#define %s %s\n", defines[i].name, defines[i].value ? defines[i].value : "1");
+    }
+    sb_append(&out, "#line 1 0\n", 10);
+    sb_append(&out, body.data ? body.data : "", body.len);
+    free(body.data);
+
+    if (out.failed) {
+        PREPROC_LOG(GWR_LOG_ERROR, "out of memory expanding '%s'", pp->files[0]);
+        free(out.data);
+        return NULL;
+    }
+    return out.data;
+}
+
+char *GWR_shader_preproc_run_path(
+    GWR_shader_preproc_t *pp,
+    const char *path,
+    const GWR_shader_define_t *defines,
+    size_t define_count
+) {
+    assert(pp);
+    assert(path);
+
+    char *src = read_file(path);
+    if (!src) {
+        PREPROC_LOG(GWR_LOG_ERROR, "can't read '%s'", path);
+        // the file list still names what this run tried to read
+        reset_files(pp);
+        add_file(pp, path);
+        return NULL;
+    }
+
+    char *out = GWR_shader_preproc_run(pp, src, path, defines, define_count);
+    free(src);
+    return out;
+}
+
+size_t GWR_shader_preproc_get_file_count(const GWR_shader_preproc_t *pp) {
+    assert(pp);
+
+    return pp->file_count;
+}
+
+const char *GWR_shader_preproc_get_file(const GWR_shader_preproc_t *pp, size_t idx) {
+    assert(pp);
+
+    return idx < pp->file_count ? pp->files[idx] : NULL;
+}
+
+// inner funcs defs
+
+static bool sb_reserve(str_buf_t *sb, size_t n) {
+    if (sb->failed) {
+        return false;
+    }
+    if (sb->len + n + 1 > sb->cap) {
+        size_t cap = sb->cap ? sb->cap : PREPROC_INITIAL_CAPACITY;
+        while (sb->len + n + 1 > cap) {
+            cap *= 2;
+        }
+        char *data = realloc(sb->data, cap);
+        if (!data) {
+            sb->failed = true;
+            return false;
+        }
+        sb->data = data;
+        sb->cap = cap;
+    }
+    return true;
+}
+
+static void sb_append(str_buf_t *sb, const char *s, size_t n) {
+    if (!sb_reserve(sb, n)) {
+        return;
+    }
+    memcpy(sb->data + sb->len, s, n);
+    sb->len += n;
+    sb->data[sb->len] = '\0';
+}
+
+static void sb_printf(str_buf_t *sb, const char *fmt, ...) {
+    // measured first, so long define values are not cut by a scratch buffer
+    va_list args;
+    va_start(args, fmt);
+    const int n = vsnprintf(NULL, 0, fmt, args);
+    va_end(args);
+    if (n < 0) {
+        sb->failed = true;
+        return;
+    }
+    if (!sb_reserve(sb, (size_t) n)) {
+        return;
+    }
+
+    va_start(args, fmt);
+    vsnprintf(sb->data + sb->len, (size_t) n + 1, fmt, args);
+    va_end(args);
+    sb->len += (size_t) n;
+}
+
+static char *read_file(const char *path) {
+    return GWR_vfs_read_text(path, NULL);
+}
+
+static bool file_exists(const char *path) {
+    return GWR_vfs_exists(path);
+}
+
+static void reset_files(GWR_shader_preproc_t *pp) {
+    for (size_t i = 0; i < pp->file_count; ++i) {
+        free(pp->files[i]);
+    }
+    pp->file_count = 0;
+}
+
+static int add_file(GWR_shader_preproc_t *pp, const char *path) {
+    if (pp->file_count == pp->file_cap) {
+        const size_t cap = pp->file_cap ? pp->file_cap * 2 : 8;
+        char **files = realloc(pp->files, cap * sizeof(char *));
+        if (!files) {
+            PREPROC_LOG(GWR_LOG_ERROR, "failed to grow file table");
+            return -1;
+        }
+        pp->files = files;
+        bool *once = realloc(pp->once, cap * sizeof(bool));
+        if (!once) {
+            PREPROC_LOG(GWR_LOG_ERROR, "failed to grow file table");
+            return -1;
+        }
+        pp->once = once;
+        pp->file_cap = cap;
+    }
+
+    char *copy = GWR_dup_str(path);
+    if (!copy) {
+        PREPROC_LOG(GWR_LOG_ERROR, "failed to allocate file name");
+        return -1;
+    }
+
+    pp->files[pp->file_count] = copy;
+    pp->once[pp->file_count] = false;
+    return (int) pp->file_count++;
+}
+
+static int find_file(const GWR_shader_preproc_t *pp, const char *path) {
+    for (size_t i = 0; i < pp->file_count; ++i) {
+        if (strcmp(pp->files[i], path) == 0) {
+            return (int) i;
+        }
+    }
+    return -1;
+}
+
+static void reset_macros(GWR_shader_preproc_t *pp) {
+    for (size_t i = 0; i < pp->macro_count; ++i) {
+        free(pp->macros[i].name);
+        free(pp->macros[i].value);
+    }
+    pp->macro_count = 0;
+}
+
+static const macro_t *find_macro(const GWR_shader_preproc_t *pp, const char *name, size_t len) {
+    for (size_t i = 0; i < pp->macro_count; ++i) {
+        if (strncmp(pp->macros[i].name, name, len) == 0 && pp->macros[i].name[len] == '\0') {
+            return &pp->macros[i];
+        }
+    }
+    return NULL;
+}
+
+static bool set_macro(
+    GWR_shader_preproc_t *pp, const char *name, size_t len, const char *value, size_t value_len, bool maybe
+) {
+    char *v = NULL;
+    if (value) {
+        v = malloc(value_len + 1);
+        if (!v) {
+            PREPROC_LOG(GWR_LOG_ERROR, "failed to allocate macro value");
+            return false;
+        }
+        memcpy(v, value, value_len);
+        v[value_len] = '\0';
+    }
+
+    macro_t *m = (macro_t *) find_macro(pp, name, len);
+    if (m) {
+        free(m->value);
+        m->value = v;
+        m->maybe = maybe;
+        return true;
+    }
+
+    if (pp->macro_count == pp->macro_cap) {
+        const size_t cap = pp->macro_cap ? pp->macro_cap * 2 : 16;
+        macro_t *macros = realloc(pp->macros, cap * sizeof(macro_t));
+        if (!macros) {
+            PREPROC_LOG(GWR_LOG_ERROR, "failed to grow macro table");
+            free(v);
+            return false;
+        }
+        pp->macros = macros;
+        pp->macro_cap = cap;
+    }
+
+    char *n = malloc(len + 1);
+    if (!n) {
+        PREPROC_LOG(GWR_LOG_ERROR, "failed to allocate macro name");
+        free(v);
+        return false;
+    }
+    memcpy(n, name, len);
+    n[len] = '\0';
+
+    pp->macros[pp->macro_count++] = (macro_t) {n, v, maybe};
+    return true;
+}
+
+static void remove_macro(GWR_shader_preproc_t *pp, const char *name, size_t len) {
+    macro_t *m = (macro_t *) find_macro(pp, name, len);
+    if (m) {
+        free(m->name);
+        free(m->value);
+        *m = pp->macros[--pp->macro_count];
+    }
+}
+
+// 1 if found, 0 if not, -1 if a candidate path does not fit in out
+static int resolve_include(
+    const GWR_shader_preproc_t *pp, const char *from, const char *name, bool quoted, char *out, size_t out_size
+) {
+    int n;
+    if (name[0] == '/') {
+        n = snprintf(out, out_size, "%s", name);
+        if (n < 0 || (size_t) n >= out_size) {
+            return -1;
+        }
+        return file_exists(out);
+    }
+
+    if (quoted) {
+        const char *slash = strrchr(from, '/');
+        if (slash) {
+            n = snprintf(out, out_size, "%.*s/%s", (int) (slash - from), from, name);
+        } else {
+            n = snprintf(out, out_size, "%s", name);
+        }
+        if (n < 0 || (size_t) n >= out_size) {
+            return -1;
+        }
+        if (file_exists(out)) {
+            return 1;
+        }
+    }
+
+    for (size_t i = 0; i < pp->include_path_count; ++i) {
+        n = snprintf(out, out_size, "%s/%s", pp->include_paths[i], name);
+        if (n < 0 || (size_t) n >= out_size) {
+            return -1;
+        }
+        if (file_exists(out)) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+static bool directive_is(const char *line, const char *end, const char *name, const char **rest) {
+    const char *p = line;
+    while (p < end && (*p == ' ' || *p == '\t')) {
+        ++p;
+    }
+    if (p == end || *p != '#') {
+        return false;
+    }
+    ++p;
+    while (p < end && (*p == ' ' || *p == '\t')) {
+        ++p;
+    }
+
+    const size_t n = strlen(name);
+    if ((size_t) (end - p) < n || strncmp(p, name, n) != 0) {
+        return false;
+    }
+    p += n;
+    if (p < end && *p != ' ' && *p != '\t' && *p != '\r') {
+        return false;
+    }
+
+    while (p < end && (*p == ' ' || *p == '\t')) {
+        ++p;
+    }
+    *rest = p;
+    return true;
+}
+
+static const char *skip_space(const char *p, const char *end) {
+    while (p < end && (*p == ' ' || *p == '\t' || *p == '\r')) {
+        ++p;
+    }
+    return p;
+}
+
+static const char *skip_ident(const char *p, const char *end) {
+    if (p < end && (isalpha((unsigned char) *p) || *p == '_')) {
+        while (p < end && (isalnum((unsigned char) *p) || *p == '_')) {
+            ++p;
+        }
+    }
+    return p;
+}
+
+static bool is_builtin(const char *name, size_t len) {
+    // GL_ES, __VERSION__ and every supported extension are defined by the driver
+    return (len >= 3 && strncmp(name, "GL_", 3) == 0) || (len >= 2 && strncmp(name, "__", 2) == 0);
+}
+
+// `NAME` or `(NAME)` at p; *after is set past it, or to NULL if p holds neither
+static cond_e eval_defined(const GWR_shader_preproc_t *pp, const char *p, const char *end, const char **after) {
+    *after = NULL;
+    p = skip_space(p, end);
+    const bool paren = p < end && *p == '(';
+    if (paren) {
+        p = skip_space(p + 1, end);
+    }
+
+    const char *name = p;
+    p = skip_ident(p, end);
+    if (p == name) {
+        return COND_UNKNOWN;
+    }
+    const size_t len = (size_t) (p - name);
+
+    if (paren) {
+        p = skip_space(p, end);
+        if (p == end || *p != ')') {
+            return COND_UNKNOWN;
+        }
+        ++p;
+    }
+    *after = p;
+
+    if (is_builtin(name, len)) {
+        return COND_UNKNOWN;
+    }
+    const macro_t *m = find_macro(pp, name, len);
+    if (!m) {
+        return COND_DEAD;
+    }
+    return m->maybe ? COND_UNKNOWN : COND_LIVE;
+}
+
+static cond_e eval_if(const GWR_shader_preproc_t *pp, const char *p, const char *end) {
+    // only the forms below are decided; any other expression counts as live
+    for (const char *c = p; c + 1 < end; ++c) {
+        if (c[0] == '/' && (c[1] == '/' || c[1] == '*')) {
+            end = c;
+            break;
+        }
+    }
+    p = skip_space(p, end);
+    while (end > p && (end[-1] == ' ' || end[-1] == '\t' || end[-1] == '\r')) {
+        --end;
+    }
+
+    bool negate = false;
+    if (p < end && *p == '!') {
+        negate = true;
+        p = skip_space(p + 1, end);
+    }
+
+    const char *word_end = skip_ident(p, end);
+    if ((size_t) (word_end - p) == 7 && strncmp(p, "defined", 7) == 0) {
+        const char *after = NULL;
+        const cond_e c = eval_defined(pp, word_end, end, &after);
+        if (!after || skip_space(after, end) != end || c == COND_UNKNOWN) {
+            return COND_UNKNOWN;
+        }
+        return (c == COND_LIVE) != negate ? COND_LIVE : COND_DEAD;
+    }
+
+    char number[32];
+    if (word_end == end && word_end > p) {
+        // a lone macro: decided only if its value is a known integer
+        const size_t len = (size_t) (end - p);
+        const macro_t *m = is_builtin(p, len) ? NULL : find_macro(pp, p, len);
+        if (!m || m->maybe || !m->value || strlen(m->value) >= sizeof(number)) {
+            return COND_UNKNOWN;
+        }
+        strcpy(number, m->value);
+    } else {
+        const size_t len = (size_t) (end - p);
+        if (len == 0 || len >= sizeof(number)) {
+            return COND_UNKNOWN;
+        }
+        memcpy(number, p, len);
+        number[len] = '\0';
+    }
+
+    char *num_end = NULL;
+    const long long v = strtoll(number, &num_end, 0);
+    if (num_end == number || (*num_end && strcmp(num_end, "u") != 0 && strcmp(num_end, "U") != 0)) {
+        return COND_UNKNOWN;
+    }
+    return (v != 0) != negate ? COND_LIVE : COND_DEAD;
+}
+
+static cond_e region_state(const cond_frame_t *conds, int depth) {
+    cond_e state = COND_LIVE;
+    for (int i = 0; i < depth; ++i) {
+        if (conds[i].state < state) {
+            state = conds[i].state;
+        }
+    }
+    return state;
+}
+
+static bool track_define(GWR_shader_preproc_t *pp, const char *p, const char *end, cond_e state) {
+    const char *name = p;
+    p = skip_ident(p, end);
+    if (p == name) {
+        return true;
+    }
+    const size_t len = (size_t) (p - name);
+
+    // function-like macros and defines in undecided branches have no usable value
+    if (state == COND_UNKNOWN || (p < end && *p == '(')) {
+        return set_macro(pp, name, len, NULL, 0, state == COND_UNKNOWN);
+    }
+
+    const char *value = skip_space(p, end);
+    const char *value_end = end;
+    for (const char *c = value; c + 1 < value_end; ++c) {
+        if (c[0] == '/' && (c[1] == '/' || c[1] == '*')) {
+            value_end = c;
+            break;
+        }
+    }
+    while (value_end > value && (value_end[-1] == ' ' || value_end[-1] == '\t' || value_end[-1] == '\r')) {
+        --value_end;
+    }
+    return set_macro(pp, name, len, value, (size_t) (value_end - value), false);
+}
+
+static void track_undef(GWR_shader_preproc_t *pp, const char *p, const char *end, cond_e state) {
+    const char *name = p;
+    p = skip_ident(p, end);
+    if (p == name) {
+        return;
+    }
+    const size_t len = (size_t) (p - name);
+
+    macro_t *m = (macro_t *) find_macro(pp, name, len);
+    if (!m) {
+        return;
+    }
+    if (state == COND_UNKNOWN) {
+        free(m->value);
+        m->value = NULL;
+        m->maybe = true;
+    } else {
+        remove_macro(pp, name, len);
+    }
+}
+
+static bool expand(
+    GWR_shader_preproc_t *pp, str_buf_t *sb, const char *src, int file_idx, int depth, const char **version_line
+) {
+    if (depth > GWR_SHADER_PREPROC_MAX_DEPTH) {
+        PREPROC_LOG(GWR_LOG_ERROR, "includes nested deeper than %d at '%s'", GWR_SHADER_PREPROC_MAX_DEPTH, pp->files[file_idx]);
+        return false;
+    }
+
+    // conditionals stay in the output for the driver; they are only tracked
+    // so includes in branches known to be inactive are not followed
+    cond_frame_t conds[PREPROC_MAX_IF_DEPTH];
+    int cond_depth = 0;
+    cond_e state = COND_LIVE;
+
+    int line_no = 1;
+    for (const char *line = src; *line; ++line_no) {
+        const char *eol = strchr(line, '\n');
+        const char *end = eol ? eol : line + strlen(line);
+        const char *next = eol ? eol + 1 : end;
+        const char *rest = NULL;
+        bool keep = true;
+
+        const bool is_if = directive_is(line, end, "if", &rest);
+        const bool is_ifdef = !is_if && directive_is(line, end, "ifdef", &rest);
+        const bool is_ifndef = !is_if && !is_ifdef && directive_is(line, end, "ifndef", &rest);
+
+        if (is_if || is_ifdef || is_ifndef) {
+            if (cond_depth == PREPROC_MAX_IF_DEPTH) {
+                PREPROC_LOG(GWR_LOG_ERROR, "%s:%d: #if nested deeper than %d", pp->files[file_idx], line_no, PREPROC_MAX_IF_DEPTH);
+                return false;
+            }
+            cond_e c = COND_UNKNOWN;
+            if (is_if) {
+                c = eval_if(pp, rest, end);
+            } else {
+                const char *after = NULL;
+                c = eval_defined(pp, rest, end, &after);
+                if (is_ifndef && c != COND_UNKNOWN) {
+                    c = c == COND_LIVE ? COND_DEAD : COND_LIVE;
+                }
+            }
+            conds[cond_depth++] = (cond_frame_t) {c, c};
+            state = region_state(conds, cond_depth);
+        } else if (directive_is(line, end, "elif", &rest)) {
+            if (cond_depth > 0) {
+                cond_frame_t *f = &conds[cond_depth - 1];
+                cond_e c = f->taken == COND_LIVE ? COND_DEAD : eval_if(pp, rest, end);
+                if (f->taken == COND_UNKNOWN && c == COND_LIVE) {
+                    c = COND_UNKNOWN;
+                }
+                f->state = c;
+                f->taken = c > f->taken ? c : f->taken;
+                state = region_state(conds, cond_depth);
+            }
+        } else if (directive_is(line, end, "else", &rest)) {
+            if (cond_depth > 0) {
+                cond_frame_t *f = &conds[cond_depth - 1];
+                f->state = f->taken == COND_LIVE ? COND_DEAD : f->taken == COND_UNKNOWN ? COND_UNKNOWN : COND_LIVE;
+                f->taken = COND_LIVE;
+                state = region_state(conds, cond_depth);
+            }
+        } else if (directive_is(line, end, "endif", &rest)) {
+            if (cond_depth > 0) {
+                --cond_depth;
+                state = region_state(conds, cond_depth);
+            }
+        } else if (state == COND_DEAD) {
+            // left to the driver, which skips it anyway
+            if (directive_is(line, end, "include", &rest)) {
+                sb_append(sb, "\n", 1);
+                keep = false;
+            }
+        } else if (directive_is(line, end, "define", &rest)) {
+            if (!track_define(pp, rest, end, state)) {
+                return false;
+            }
+        } else if (directive_is(line, end, "undef", &rest)) {
+            track_undef(pp, rest, end, state);
+        } else if (directive_is(line, end, "version", &rest)) {
+            if (depth == 0 && !*version_line) {
+                *version_line = line;
+            } else {
+                PREPROC_LOG(GWR_LOG_WARNING, "%s:%d: extra #version dropped", pp->files[file_idx], line_no);
+            }
+            // blank line keeps the numbering
+            sb_append(sb, "\n", 1);
+            keep = false;
+        } else if (directive_is(line, end, "pragma", &rest) && (size_t) (end - rest) >= 4 && strncmp(rest, "once", 4) == 0) {
+            pp->once[file_idx] = true;
+            sb_append(sb, "\n", 1);
+            keep = false;
+        } else if (directive_is(line, end, "include", &rest)) {
+            keep = false;
+
+            const char open = *rest;
+            const char close = open == '"' ? '"' : '>';
+            const char *name_end = (open == '"' || open == '<') ? memchr(rest + 1, close, (size_t) (end - rest - 1)) : NULL;
+            if (!name_end) {
+                PREPROC_LOG(GWR_LOG_ERROR, "%s:%d: malformed #include", pp->files[file_idx], line_no);
+                return false;
+            }
+
+            const size_t name_len = (size_t) (name_end - rest - 1);
+            char name[PREPROC_PATH_SIZE];
+            if (name_len >= sizeof(name)) {
+                PREPROC_LOG(GWR_LOG_ERROR, "%s:%d: include name longer than %d bytes", pp->files[file_idx], line_no, PREPROC_PATH_SIZE - 1);
+                return false;
+            }
+            memcpy(name, rest + 1, name_len);
+            name[name_len] = '\0';
+
+            char path[PREPROC_PATH_SIZE];
+            const int found = resolve_include(pp, pp->files[file_idx], name, open == '"', path, sizeof(path));
+            if (found < 0) {
+                PREPROC_LOG(
+                    GWR_LOG_ERROR, "%s:%d: path for include '%s' is longer than %d bytes",
+                    pp->files[file_idx], line_no, name, PREPROC_PATH_SIZE - 1
+                );
+                return false;
+            }
+            if (!found) {
+                PREPROC_LOG(GWR_LOG_ERROR, "%s:%d: can't find include '%s'", pp->files[file_idx], line_no, name);
+                return false;
+            }
+
+            int idx = find_file(pp, path);
+            if (idx >= 0 && pp->once[idx]) {
+                sb_append(sb, "\n", 1);
+            } else {
+                char *inc = read_file(path);
+                if (!inc) {
+                    PREPROC_LOG(GWR_LOG_ERROR, "%s:%d: can't read '%s'", pp->files[file_idx], line_no, path);
+                    return false;
+                }
+                if (idx < 0 && (idx = add_file(pp, path)) < 0) {
+                    free(inc);
+                    return false;
+                }
+
+                sb_printf(sb, "#line 1 %d\n", idx);
+                const bool ok = expand(pp, sb, inc, idx, depth + 1, version_line);
+                free(inc);
+                if (!ok) {
+                    return false;
+                }
+                sb_printf(sb, "\n#line %d %d\n", line_no + 1, file_idx);
+            }
+        }
+
+        if (keep) {
+            sb_append(sb, line, (size_t) (next - line));
+            if (!eol) {
+                sb_append(sb, "\n", 1);
+            }
+        }
+
+        line = next;
+    }
+
+    return !sb->failed;
+}
@@ -0,0 +1,617 @@
+#include "internal/gwr_shader_variant.h"
+#include "internal/gwr_log.h"
+#include "internal/gwr_util.h"
+#include "internal/gwr_debug.h"
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <assert.h>
+#include <sys/stat.h>
+
+#define VARIANT_LOG(level, msg, ...)    GWR_LOG_AT(GWR_LOG_SYS_SHADER_VARIANT, (level), msg, ##__VA_ARGS__)
+
+#define VARIANT_INITIAL_CAPACITY    64
+
+typedef enum {
+    KEY_SOURCE = 0,
+    KEY_PATH,
+} key_kind_e;
+
+// a file a path request was expanded from, as it was on disk then
+typedef struct {
+    char *path;
+    bool exists;            // false for files served by an archive
+    struct timespec mtime;
+    off_t size;
+} dep_t;
+
+// (source or path, define set, stage) -> stage entry
+typedef struct {
+    uint64_t hash;
+    char *key;              // see make_key()
+    size_t key_len;
+    GLenum type;
+    key_kind_e kind;
+    dep_t *deps;            // KEY_PATH only
+    size_t dep_count;
+    bool stale;             // a dep changed, set by GWR_shader_variant_cache_refresh()
+    int stage;              // -1 if it failed to build
+} request_t;
+
+// expanded source -> compiled stage object
+typedef struct {
+    uint64_t hash;
+    char *src;
+    GLenum type;
+    GLuint id;
+} stage_t;
+
+typedef struct {
+    GLuint vertex;
+    GLuint fragment;
+    GWR_shader_t *shader;   // NULL if linking failed
+} program_t;
+
+// open addressing over entry indices; each table keeps its own 64-bit hashes
+typedef struct {
+    uint64_t *hashes;
+    int *idx;               // -1 = empty
+    size_t cap;
+    size_t count;
+} index_t;
+
+struct GWR_shader_variant_cache_t {
+    GWR_shader_preproc_t *pp;
+
+    request_t *requests;
+    size_t request_count;
+    size_t request_cap;
+    index_t request_index;
+
+    stage_t *stages;
+    size_t stage_count;
+    size_t stage_cap;
+    index_t stage_index;
+
+    program_t *programs;
+    size_t program_count;
+    size_t program_cap;
+    index_t program_index;
+
+    GWR_shader_variant_stats_t stats;
+};
+
+// inner funcs decls
+
+static uint64_t mix(uint64_t h);
+static int compare_defines(const void *a, const void *b);
+static char *make_key(
+    key_kind_e kind, const char *text, const GWR_shader_define_t *defines, size_t define_count, size_t *len
+);
+
+static bool index_init(index_t *ix);
+static void index_free(index_t *ix);
+static bool index_insert(index_t *ix, uint64_t hash, int idx);
+static int index_next(const index_t *ix, uint64_t hash, size_t *pos);
+
+static bool grow(void **data, size_t *cap, size_t count, size_t elem);
+
+static GLuint get_stage(
+    GWR_shader_variant_cache_t *cache, GLenum type, key_kind_e kind, const char *text, const char *origin,
+    const GWR_shader_define_t *defines, size_t define_count
+);
+static int find_request(const GWR_shader_variant_cache_t *cache, const request_t *key);
+static int expand_and_build(
+    GWR_shader_variant_cache_t *cache, GLenum type, key_kind_e kind, const char *text, const char *origin,
+    const GWR_shader_define_t *defines, size_t define_count
+);
+static int build_stage(GWR_shader_variant_cache_t *cache, GLenum type, const char *expanded, const char *name, size_t define_count);
+static bool add_request(GWR_shader_variant_cache_t *cache, const request_t *r);
+
+static bool collect_deps(const GWR_shader_preproc_t *pp, dep_t **deps, size_t *count);
+static bool deps_changed(const dep_t *deps, size_t count);
+static void free_deps(dep_t *deps, size_t count);
+static struct timespec stat_mtime(const struct stat *st);
+
+// public funcs defs
+
+GWR_shader_variant_cache_t *GWR_shader_variant_cache_create(GWR_shader_preproc_t *pp) {
+    assert(pp);
+
+    GWR_shader_variant_cache_t *cache = calloc(1, sizeof(GWR_shader_variant_cache_t));
+    if (!cache) {
+        VARIANT_LOG(GWR_LOG_ERROR, "failed to allocate GWR_shader_variant_cache_t");
+        return NULL;
+    }
+
+    cache->pp = pp;
+    if (!index_init(&cache->request_index) || !index_init(&cache->stage_index) || !index_init(&cache->program_index)) {
+        VARIANT_LOG(GWR_LOG_ERROR, "failed to allocate indices");
+        GWR_shader_variant_cache_destroy(cache);
+        return NULL;
+    }
+
+    return cache;
+}
+
+void GWR_shader_variant_cache_destroy(GWR_shader_variant_cache_t *cache) {
+    assert(cache);
+
+    for (size_t i = 0; i < cache->program_count; ++i) {
+        if (cache->programs[i].shader) {
+            GWR_shader_destroy(cache->programs[i].shader);
+        }
+    }
+    for (size_t i = 0; i < cache->stage_count; ++i) {
+        glDeleteShader(cache->stages[i].id);
+        free(cache->stages[i].src);
+    }
+    for (size_t i = 0; i < cache->request_count; ++i) {
+        free(cache->requests[i].key);
+        free_deps(cache->requests[i].deps, cache->requests[i].dep_count);
+    }
+
+    free(cache->requests);
+    free(cache->stages);
+    free(cache->programs);
+    index_free(&cache->request_index);
+    index_free(&cache->stage_index);
+    index_free(&cache->program_index);
+    free(cache);
+}
+
+GLuint GWR_shader_variant_cache_get_stage(
+    GWR_shader_variant_cache_t *cache,
+    GLenum type,
+    const char *src,
+    const char *origin,
+    const GWR_shader_define_t *defines,
+    size_t define_count
+) {
+    assert(cache);
+    assert(src);
+    // origin only resolves includes and names the source in #line markers, it is not part of the key
+    return get_stage(cache, type, KEY_SOURCE, src, origin, defines, define_count);
+}
+
+GLuint GWR_shader_variant_cache_get_stage_path(
+    GWR_shader_variant_cache_t *cache,
+    GLenum type,
+    const char *path,
+    const GWR_shader_define_t *defines,
+    size_t define_count
+) {
+    assert(cache);
+    assert(path);
+
+    return get_stage(cache, type, KEY_PATH, path, NULL, defines, define_count);
+}
+
+GWR_shader_t *GWR_shader_variant_cache_get_program_path(
+    GWR_shader_variant_cache_t *cache,
+    const char *vertex_path,
+    const char *fragment_path,
+    const GWR_shader_define_t *defines,
+    size_t define_count
+) {
+    assert(cache);
+    assert(vertex_path);
+    assert(fragment_path);
+
+    ++cache->stats.program_requests;
+
+    const GLuint vertex = GWR_shader_variant_cache_get_stage_path(cache, GL_VERTEX_SHADER, vertex_path, defines, define_count);
+    const GLuint fragment = GWR_shader_variant_cache_get_stage_path(cache, GL_FRAGMENT_SHADER, fragment_path, defines, define_count);
+    if (!vertex || !fragment) {
+        return NULL;
+    }
+
+    const uint64_t hash = mix(((uint64_t) vertex << 32) | fragment);
+    size_t pos = 0;
+    for (int idx; (idx = index_next(&cache->program_index, hash, &pos)) >= 0;) {
+        const program_t *p = &cache->programs[idx];
+        if (p->vertex == vertex && p->fragment == fragment) {
+            return p->shader;
+        }
+    }
+
+    if (!grow((void **) &cache->programs, &cache->program_cap, cache->program_count, sizeof(program_t))) {
+        VARIANT_LOG(GWR_LOG_ERROR, "failed to grow program table");
+        return NULL;
+    }
+
+    program_t *p = &cache->programs[cache->program_count];
+    p->vertex = vertex;
+    p->fragment = fragment;
+    p->shader = GWR_shader_create(vertex, fragment);
+    ++cache->stats.program_links;
+    if (p->shader) {
+        GWR_debug_label(
+            GL_PROGRAM, GWR_shader_get_id(p->shader), "variant '%s' + '%s' (%zu defines)",
+            vertex_path, fragment_path, define_count
+        );
+    }
+
+    if (!index_insert(&cache->program_index, hash, (int) cache->program_count)) {
+        VARIANT_LOG(GWR_LOG_ERROR, "failed to grow program index");
+        if (p->shader) {
+            GWR_shader_destroy(p->shader);
+        }
+        return NULL;
+    }
+    ++cache->program_count;
+
+    return p->shader;
+}
+
+size_t GWR_shader_variant_cache_refresh(GWR_shader_variant_cache_t *cache) {
+    assert(cache);
+
+    size_t stale = 0;
+    for (size_t i = 0; i < cache->request_count; ++i) {
+        request_t *r = &cache->requests[i];
+        if (r->kind == KEY_PATH && !r->stale && deps_changed(r->deps, r->dep_count)) {
+            r->stale = true;
+            ++stale;
+        }
+    }
+    return stale;
+}
+
+GWR_shader_variant_stats_t GWR_shader_variant_cache_get_stats(const GWR_shader_variant_cache_t *cache) {
+    assert(cache);
+
+    return cache->stats;
+}
+
+// inner funcs defs
+
+static uint64_t mix(uint64_t h) {
+    // splitmix64 finalizer
+    h ^= h >> 30;
+    h *= 0xbf58476d1ce4e5b9ull;
+    h ^= h >> 27;
+    h *= 0x94d049bb133111ebull;
+    h ^= h >> 31;
+    return h;
+}
+
+static int compare_defines(const void *a, const void *b) {
+    const GWR_shader_define_t *da = *(const GWR_shader_define_t *const *) a;
+    const GWR_shader_define_t *db = *(const GWR_shader_define_t *const *) b;
+    return strcmp(da->name, db->name);
+}
+
+// kind, text and the define set sorted by name, each part NUL-terminated, so
+// the order the caller lists defines in does not matter; NULL on a duplicate name
+static char *make_key(
+    key_kind_e kind, const char *text, const GWR_shader_define_t *defines, size_t define_count, size_t *len
+) {
+    const GWR_shader_define_t **sorted = NULL;
+    if (define_count) {
+        sorted = malloc(define_count * sizeof(*sorted));
+        if (!sorted) {
+            VARIANT_LOG(GWR_LOG_ERROR, "failed to allocate define list");
+            return NULL;
+        }
+    }
+
+    size_t size = 1 + strlen(text) + 1;
+    for (size_t i = 0; i < define_count; ++i) {
+        assert(defines[i].name);
+        sorted[i] = &defines[i];
+        size += strlen(defines[i].name) + 1 + strlen(defines[i].value ? defines[i].value : "1") + 1;
+    }
+    if (define_count) {
+        qsort(sorted, define_count, sizeof(*sorted), compare_defines);
+    }
+    for (size_t i = 1; i < define_count; ++i) {
+        // the emitted #define order would decide which one wins
+        if (strcmp(sorted[i - 1]->name, sorted[i]->name) == 0) {
+            VARIANT_LOG(GWR_LOG_ERROR, "define '%s' given more than once", sorted[i]->name);
+            free(sorted);
+            return NULL;
+        }
+    }
+
+    char *key = malloc(size);
+    if (!key) {
+        VARIANT_LOG(GWR_LOG_ERROR, "failed to allocate variant key");
+        free(sorted);
+        return NULL;
+    }
+
+    char *p = key;
+    *p++ = (char) ('0' + kind);
+    const size_t text_len = strlen(text) + 1;
+    memcpy(p, text, text_len);
+    p += text_len;
+    for (size_t i = 0; i < define_count; ++i) {
+        const char *value = sorted[i]->value ? sorted[i]->value : "1";
+        const size_t name_len = strlen(sorted[i]->name) + 1;
+        const size_t value_len = strlen(value) + 1;
+        memcpy(p, sorted[i]->name, name_len);
+        p += name_len;
+        memcpy(p, value, value_len);
+        p += value_len;
+    }
+    free(sorted);
+
+    *len = size;
+    return key;
+}
+
+static bool index_init(index_t *ix) {
+    ix->cap = VARIANT_INITIAL_CAPACITY;
+    ix->count = 0;
+    ix->hashes = malloc(ix->cap * sizeof(uint64_t));
+    ix->idx = malloc(ix->cap * sizeof(int));
+    if (!ix->hashes || !ix->idx) {
+        return false;
+    }
+    memset(ix->idx, 0xff, ix->cap * sizeof(int));
+    return true;
+}
+
+static void index_free(index_t *ix) {
+    free(ix->hashes);
+    free(ix->idx);
+    ix->hashes = NULL;
+    ix->idx = NULL;
+}
+
+static bool index_insert(index_t *ix, uint64_t hash, int idx) {
+    // keep the load factor under 1/2
+    if ((ix->count + 1) * 2 > ix->cap) {
+        index_t bigger = {0};
+        bigger.cap = ix->cap * 2;
+        bigger.hashes = malloc(bigger.cap * sizeof(uint64_t));
+        bigger.idx = malloc(bigger.cap * sizeof(int));
+        if (!bigger.hashes || !bigger.idx) {
+            index_free(&bigger);
+            return false;
+        }
+        memset(bigger.idx, 0xff, bigger.cap * sizeof(int));
+        for (size_t i = 0; i < ix->cap; ++i) {
+            if (ix->idx[i] >= 0) {
+                index_insert(&bigger, ix->hashes[i], ix->idx[i]);
+            }
+        }
+        index_free(ix);
+        *ix = bigger;
+    }
+
+    const size_t mask = ix->cap - 1;
+    size_t i = hash & mask;
+    while (ix->idx[i] >= 0) {
+        i = (i + 1) & mask;
+    }
+    ix->hashes[i] = hash;
+    ix->idx[i] = idx;
+    ++ix->count;
+    return true;
+}
+
+static int index_next(const index_t *ix, uint64_t hash, size_t *pos) {
+    // *pos is 0 on the first call, then the probe distance to resume from
+    const size_t mask = ix->cap - 1;
+    for (size_t i = (hash + *pos) & mask; ix->idx[i] >= 0; i = (i + 1) & mask) {
+        ++*pos;
+        if (ix->hashes[i] == hash) {
+            return ix->idx[i];
+        }
+    }
+    return -1;
+}
+
+static bool grow(void **data, size_t *cap, size_t count, size_t elem) {
+    if (count < *cap) {
+        return true;
+    }
+    const size_t new_cap = *cap ? *cap * 2 : VARIANT_INITIAL_CAPACITY;
+    void *p = realloc(*data, new_cap * elem);
+    if (!p) {
+        return false;
+    }
+    *data = p;
+    *cap = new_cap;
+    return true;
+}
+
+static GLuint get_stage(
+    GWR_shader_variant_cache_t *cache, GLenum type, key_kind_e kind, const char *text, const char *origin,
+    const GWR_shader_define_t *defines, size_t define_count
+) {
+    assert(defines || !define_count);
+
+    ++cache->stats.stage_requests;
+
+    request_t key = {.type = type, .kind = kind, .stage = -1};
+    key.key = make_key(kind, text, defines, define_count, &key.key_len);
+    if (!key.key) {
+        return 0;
+    }
+    key.hash = mix(GWR_fnv1a(GWR_FNV_OFFSET, key.key, key.key_len) ^ type);
+
+    const int found = find_request(cache, &key);
+    if (found >= 0) {
+        free(key.key);
+        request_t *r = &cache->requests[found];
+        if (r->stale) {
+            // edited on disk since it was built; the old stage stays for other requests
+            ++cache->stats.stage_stale;
+            r->stale = false;
+            r->stage = expand_and_build(cache, type, kind, text, origin, defines, define_count);
+            free_deps(r->deps, r->dep_count);
+            r->deps = NULL;
+            r->dep_count = 0;
+            if (!collect_deps(cache->pp, &r->deps, &r->dep_count)) {
+                VARIANT_LOG(GWR_LOG_WARNING, "failed to record the files of '%s', edits will not be seen", text);
+            }
+        } else {
+            ++cache->stats.stage_hits;
+        }
+        return r->stage >= 0 ? cache->stages[r->stage].id : 0;
+    }
+
+    key.stage = expand_and_build(cache, type, kind, text, origin, defines, define_count);
+    if (kind == KEY_PATH && !collect_deps(cache->pp, &key.deps, &key.dep_count)) {
+        VARIANT_LOG(GWR_LOG_WARNING, "failed to record the files of '%s', edits will not be seen", text);
+    }
+
+    // failures are cached too, so a broken permutation is reported once
+    const int stage = key.stage;
+    if (!add_request(cache, &key)) {
+        VARIANT_LOG(GWR_LOG_WARNING, "failed to remember variant, it will be rebuilt");
+        free(key.key);
+        free_deps(key.deps, key.dep_count);
+    }
+
+    return stage >= 0 ? cache->stages[stage].id : 0;
+}
+
+static int find_request(const GWR_shader_variant_cache_t *cache, const request_t *key) {
+    size_t pos = 0;
+    for (int idx; (idx = index_next(&cache->request_index, key->hash, &pos)) >= 0;) {
+        const request_t *r = &cache->requests[idx];
+        if (r->type == key->type && r->key_len == key->key_len && memcmp(r->key, key->key, key->key_len) == 0) {
+            return idx;
+        }
+    }
+    return -1;
+}
+
+static int expand_and_build(
+    GWR_shader_variant_cache_t *cache, GLenum type, key_kind_e kind, const char *text, const char *origin,
+    const GWR_shader_define_t *defines, size_t define_count
+) {
+    char *expanded = kind == KEY_PATH
+        ? GWR_shader_preproc_run_path(cache->pp, text, defines, define_count)
+        : GWR_shader_preproc_run(cache->pp, text, origin, defines, define_count);
+
+    const char *name = kind == KEY_PATH ? text : origin ? origin : "<source>";
+    const int stage = expanded ? build_stage(cache, type, expanded, name, define_count) : -1;
+    free(expanded);
+
+    if (stage < 0) {
+        VARIANT_LOG(GWR_LOG_ERROR, "variant of '%s' with %zu defines failed to build", name, define_count);
+    }
+    return stage;
+}
+
+static int build_stage(GWR_shader_variant_cache_t *cache, GLenum type, const char *expanded, const char *name, size_t define_count) {
+    const uint64_t hash = mix(GWR_fnv1a_str(GWR_FNV_OFFSET, expanded) ^ type);
+
+    size_t pos = 0;
+    for (int idx; (idx = index_next(&cache->stage_index, hash, &pos)) >= 0;) {
+        if (cache->stages[idx].type == type && strcmp(cache->stages[idx].src, expanded) == 0) {
+            ++cache->stats.stage_shared;
+            return idx;
+        }
+    }
+
+    if (!grow((void **) &cache->stages, &cache->stage_cap, cache->stage_count, sizeof(stage_t))) {
+        VARIANT_LOG(GWR_LOG_ERROR, "failed to grow stage table");
+        return -1;
+    }
+
+    char *src = GWR_dup_str(expanded);
+    if (!src) {
+        VARIANT_LOG(GWR_LOG_ERROR, "failed to allocate stage source");
+        return -1;
+    }
+
+    ++cache->stats.stage_compiles;
+    const GLuint id = GWR_shader_compile_src(type, expanded);
+    if (!id) {
+        free(src);
+        return -1;
+    }
+
+    const int idx = (int) cache->stage_count;
+    if (!index_insert(&cache->stage_index, hash, idx)) {
+        VARIANT_LOG(GWR_LOG_ERROR, "failed to grow stage index");
+        glDeleteShader(id);
+        free(src);
+        return -1;
+    }
+
+    // a stage shared by several permutations keeps the name of the first
+    GWR_debug_label(GL_SHADER, id, "variant '%s' (%zu defines)", name, define_count);
+
+    cache->stages[idx] = (stage_t) {hash, src, type, id};
+    ++cache->stage_count;
+    return idx;
+}
+
+static bool add_request(GWR_shader_variant_cache_t *cache, const request_t *r) {
+    if (!grow((void **) &cache->requests, &cache->request_cap, cache->request_count, sizeof(request_t))) {
+        return false;
+    }
+    if (!index_insert(&cache->request_index, r->hash, (int) cache->request_count)) {
+        return false;
+    }
+    cache->requests[cache->request_count++] = *r;
+    return true;
+}
+
+static bool collect_deps(const GWR_shader_preproc_t *pp, dep_t **deps, size_t *count) {
+    // the preprocessor still holds the files of the run that just finished
+    const size_t n = GWR_shader_preproc_get_file_count(pp);
+    dep_t *d = calloc(n ? n : 1, sizeof(dep_t));
+    if (!d) {
+        return false;
+    }
+
+    for (size_t i = 0; i < n; ++i) {
+        d[i].path = GWR_dup_str(GWR_shader_preproc_get_file(pp, i));
+        if (!d[i].path) {
+            free_deps(d, i);
+            return false;
+        }
+        struct stat st;
+        if (stat(d[i].path, &st) == 0) {
+            d[i].exists = true;
+            d[i].mtime = stat_mtime(&st);
+            d[i].size = st.st_size;
+        }
+    }
+
+    *deps = d;
+    *count = n;
+    return true;
+}
+
+static bool deps_changed(const dep_t *deps, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        struct stat st;
+        const bool exists = stat(deps[i].path, &st) == 0;
+        if (exists != deps[i].exists) {
+            return true;
+        }
+        if (!exists) {
+            continue;
+        }
+        const struct timespec mtime = stat_mtime(&st);
+        if (mtime.tv_sec != deps[i].mtime.tv_sec || mtime.tv_nsec != deps[i].mtime.tv_nsec || st.st_size != deps[i].size) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void free_deps(dep_t *deps, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        free(deps[i].path);
+    }
+    free(deps);
+}
+
+static struct timespec stat_mtime(const struct stat *st) {
+#ifdef __APPLE__
+    return st->st_mtimespec;
+#else
+    return st->st_mtim;
+#endif
+}
@@ -0,0 +1,422 @@
+#include "internal/gwr_shader_watcher.h"
+#include "internal/gwr_log.h"
+#include "internal/gwr_util.h"
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdatomic.h>
+#include <assert.h>
+#include <time.h>
+#include <pthread.h>
+#include <sys/stat.h>
+
+#ifdef __linux__
+#include <poll.h>
+#include <unistd.h>
+#include <sys/inotify.h>
+#endif
+
+#define WATCHER_LOG(level, msg, ...)    GWR_LOG_AT(GWR_LOG_SYS_SHADER_WATCHER, (level), msg, ##__VA_ARGS__)
+
+#define WATCHER_POLL_MS           100
+#define WATCHER_STAT_PERIOD_NS    500000000ull
+
+typedef struct {
+    char *path;
+    const char *name;           // basename inside path
+    int wd;                     // inotify watch of the directory
+    struct timespec mtime;      // zero if the file was missing
+} watch_file_t;
+
+typedef struct {
+    GWR_shader_t *shader;
+    watch_file_t *files;        // stage files and their includes
+    int file_count;
+    bool dirty;
+    uint64_t last_event_ns;
+} watch_entry_t;
+
+struct GWR_shader_watcher_t {
+    watch_entry_t entries[GWR_SHADER_WATCHER_MAX_SHADERS];
+    int count;
+    pthread_mutex_t lock;           // entries are read by the notify thread
+
+    int fd;                         // inotify fd, -1 when polling mtimes
+    pthread_t thread;
+    atomic_bool stop;
+
+    uint64_t last_stat_ns;
+};
+
+// inner funcs decls
+
+static const char *base_name(const char *path);
+static struct timespec file_mtime(const char *path);
+static void mark_dirty(watch_entry_t *e);
+static void poll_mtimes(GWR_shader_watcher_t *watcher);
+static bool collect_files(const GWR_shader_watcher_t *watcher, const GWR_shader_t *shader, watch_file_t **files, int *count);
+static void release_files(GWR_shader_watcher_t *watcher, watch_file_t *files, int count);
+static void refresh_files(GWR_shader_watcher_t *watcher, GWR_shader_t *shader);
+
+#ifdef __linux__
+static int add_dir_watch(int fd, const char *path);
+static void release_dir_watch(GWR_shader_watcher_t *watcher, int wd);
+static void *notify_thread(void *arg);
+#endif
+
+// public funcs defs
+
+GWR_shader_watcher_t *GWR_shader_watcher_create(void) {
+    GWR_shader_watcher_t *watcher = calloc(1, sizeof(GWR_shader_watcher_t));
+    if (!watcher) {
+        WATCHER_LOG(GWR_LOG_ERROR, "failed to allocate GWR_shader_watcher_t");
+        return NULL;
+    }
+
+    pthread_mutex_init(&watcher->lock, NULL);
+    atomic_init(&watcher->stop, false);
+    watcher->fd = -1;
+
+#ifdef __linux__
+    watcher->fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (watcher->fd < 0) {
+        WATCHER_LOG(GWR_LOG_WARNING, "inotify unavailable, polling file times");
+    } else if (pthread_create(&watcher->thread, NULL, notify_thread, watcher) != 0) {
+        WATCHER_LOG(GWR_LOG_WARNING, "failed to start notify thread, polling file times");
+        close(watcher->fd);
+        watcher->fd = -1;
+    }
+#endif
+
+    return watcher;
+}
+
+void GWR_shader_watcher_destroy(GWR_shader_watcher_t *watcher) {
+    assert(watcher);
+
+#ifdef __linux__
+    if (watcher->fd >= 0) {
+        atomic_store(&watcher->stop, true);
+        pthread_join(watcher->thread, NULL);
+        close(watcher->fd);
+    }
+#endif
+
+    for (int i = 0; i < watcher->count; ++i) {
+        watch_entry_t *e = &watcher->entries[i];
+        for (int f = 0; f < e->file_count; ++f) {
+            free(e->files[f].path);
+        }
+        free(e->files);
+    }
+
+    pthread_mutex_destroy(&watcher->lock);
+    free(watcher);
+}
+
+bool GWR_shader_watcher_add(GWR_shader_watcher_t *watcher, GWR_shader_t *shader) {
+    assert(watcher);
+    assert(shader);
+
+    if (!GWR_shader_can_reload(shader)) {
+        WATCHER_LOG(GWR_LOG_WARNING, "shader %u has no source files to watch", GWR_shader_get_id(shader));
+        return false;
+    }
+
+    watch_file_t *files = NULL;
+    int file_count = 0;
+    if (!collect_files(watcher, shader, &files, &file_count)) {
+        WATCHER_LOG(GWR_LOG_ERROR, "failed to allocate the watched files of shader %u", GWR_shader_get_id(shader));
+        return false;
+    }
+
+    pthread_mutex_lock(&watcher->lock);
+
+    if (watcher->count == GWR_SHADER_WATCHER_MAX_SHADERS) {
+        release_files(watcher, files, file_count);
+        pthread_mutex_unlock(&watcher->lock);
+        WATCHER_LOG(GWR_LOG_ERROR, "too many watched shaders (max %d)", GWR_SHADER_WATCHER_MAX_SHADERS);
+        return false;
+    }
+
+    watch_entry_t *e = &watcher->entries[watcher->count++];
+    memset(e, 0, sizeof(*e));
+    e->shader = shader;
+    e->files = files;
+    e->file_count = file_count;
+
+    pthread_mutex_unlock(&watcher->lock);
+
+    return true;
+}
+
+void GWR_shader_watcher_remove(GWR_shader_watcher_t *watcher, GWR_shader_t *shader) {
+    assert(watcher);
+    assert(shader);
+
+    pthread_mutex_lock(&watcher->lock);
+
+    for (int i = 0; i < watcher->count; ++i) {
+        if (watcher->entries[i].shader != shader) {
+            continue;
+        }
+
+        watch_entry_t removed = watcher->entries[i];
+        watcher->entries[i] = watcher->entries[--watcher->count];
+        release_files(watcher, removed.files, removed.file_count);
+        break;
+    }
+
+    pthread_mutex_unlock(&watcher->lock);
+
+    // a reload may still be compiling; drop it rather than wait for the driver
+    GWR_shader_reload_cancel(shader);
+}
+
+int GWR_shader_watcher_update(GWR_shader_watcher_t *watcher) {
+    assert(watcher);
+
+    if (watcher->fd < 0) {
+        poll_mtimes(watcher);
+    }
+
+    const uint64_t now = GWR_now_ns();
+    const uint64_t debounce_ns = (uint64_t) GWR_SHADER_WATCHER_DEBOUNCE_MS * 1000000ull;
+
+    GWR_shader_t *start[GWR_SHADER_WATCHER_MAX_SHADERS];
+    GWR_shader_t *watched[GWR_SHADER_WATCHER_MAX_SHADERS];
+    int start_count = 0;
+    int watched_count = 0;
+
+    // GL work happens outside the lock so the notify thread never waits on the driver
+    pthread_mutex_lock(&watcher->lock);
+    for (int i = 0; i < watcher->count; ++i) {
+        watch_entry_t *e = &watcher->entries[i];
+        watched[watched_count++] = e->shader;
+        if (e->dirty && now - e->last_event_ns >= debounce_ns) {
+            e->dirty = false;
+            start[start_count++] = e->shader;
+        }
+    }
+    pthread_mutex_unlock(&watcher->lock);
+
+    for (int i = 0; i < start_count; ++i) {
+        GWR_shader_reload_begin(start[i]);
+        // the edit may have added or dropped includes
+        refresh_files(watcher, start[i]);
+    }
+
+    int swapped = 0;
+    for (int i = 0; i < watched_count; ++i) {
+        swapped += GWR_shader_reload_poll(watched[i]) == GWR_SHADER_RELOAD_SWAPPED;
+    }
+
+    return swapped;
+}
+
+// inner funcs defs
+
+static const char *base_name(const char *path) {
+    const char *slash = strrchr(path, '/');
+    return slash ? slash + 1 : path;
+}
+
+// nanosecond resolution, so two saves within one second both count
+static struct timespec file_mtime(const char *path) {
+    struct stat st;
+    if (stat(path, &st) != 0) {
+        return (struct timespec) {0, 0};
+    }
+#ifdef __APPLE__
+    return st.st_mtimespec;
+#else
+    return st.st_mtim;
+#endif
+}
+
+static void mark_dirty(watch_entry_t *e) {
+    e->dirty = true;
+    e->last_event_ns = GWR_now_ns();
+}
+
+static void poll_mtimes(GWR_shader_watcher_t *watcher) {
+    const uint64_t now = GWR_now_ns();
+    if (now - watcher->last_stat_ns < WATCHER_STAT_PERIOD_NS) {
+        return;
+    }
+    watcher->last_stat_ns = now;
+
+    pthread_mutex_lock(&watcher->lock);
+    for (int i = 0; i < watcher->count; ++i) {
+        watch_entry_t *e = &watcher->entries[i];
+        for (int f = 0; f < e->file_count; ++f) {
+            watch_file_t *file = &e->files[f];
+            const struct timespec mtime = file_mtime(file->path);
+            const bool exists = mtime.tv_sec || mtime.tv_nsec;
+            if (exists && (mtime.tv_sec != file->mtime.tv_sec || mtime.tv_nsec != file->mtime.tv_nsec)) {
+                file->mtime = mtime;
+                mark_dirty(e);
+            }
+        }
+    }
+    pthread_mutex_unlock(&watcher->lock);
+}
+
+// copies the shader's file list, so the notify thread never reads memory a reload frees
+static bool collect_files(const GWR_shader_watcher_t *watcher, const GWR_shader_t *shader, watch_file_t **files, int *count) {
+    const size_t n = GWR_shader_get_dep_count(shader);
+    watch_file_t *list = calloc(n ? n : 1, sizeof(watch_file_t));
+    if (!list) {
+        return false;
+    }
+
+    for (size_t i = 0; i < n; ++i) {
+        watch_file_t *file = &list[i];
+        file->path = GWR_dup_str(GWR_shader_get_dep(shader, i));
+        if (!file->path) {
+            for (size_t k = 0; k < i; ++k) {
+                free(list[k].path);
+            }
+            free(list);
+            return false;
+        }
+        file->name = base_name(file->path);
+        file->mtime = file_mtime(file->path);
+        file->wd = -1;
+    }
+
+#ifdef __linux__
+    // after the copies, so a failed allocation leaves no watch behind
+    for (size_t i = 0; i < n && watcher->fd >= 0; ++i) {
+        list[i].wd = add_dir_watch(watcher->fd, list[i].path);
+    }
+#else
+    GWR_UNUSED(watcher);
+#endif
+
+    *files = list;
+    *count = (int) n;
+    return true;
+}
+
+// called with the lock held, after the files left the entry list
+static void release_files(GWR_shader_watcher_t *watcher, watch_file_t *files, int count) {
+    for (int i = 0; i < count; ++i) {
+#ifdef __linux__
+        release_dir_watch(watcher, files[i].wd);
+#endif
+        free(files[i].path);
+    }
+    free(files);
+#ifndef __linux__
+    GWR_UNUSED(watcher);
+#endif
+}
+
+static void refresh_files(GWR_shader_watcher_t *watcher, GWR_shader_t *shader) {
+    watch_file_t *files = NULL;
+    int file_count = 0;
+    if (!collect_files(watcher, shader, &files, &file_count)) {
+        WATCHER_LOG(GWR_LOG_WARNING, "failed to update the watched files of shader %u", GWR_shader_get_id(shader));
+        return;
+    }
+
+    pthread_mutex_lock(&watcher->lock);
+    for (int i = 0; i < watcher->count; ++i) {
+        watch_entry_t *e = &watcher->entries[i];
+        if (e->shader != shader) {
+            continue;
+        }
+        watch_file_t *old = e->files;
+        const int old_count = e->file_count;
+        e->files = files;
+        e->file_count = file_count;
+        files = old;
+        file_count = old_count;
+        break;
+    }
+    // the replaced list, or the new one if the shader is no longer watched
+    release_files(watcher, files, file_count);
+    pthread_mutex_unlock(&watcher->lock);
+}
+
+#ifdef __linux__
+
+static int add_dir_watch(int fd, const char *path) {
+    char dir[4096];
+    const char *slash = strrchr(path, '/');
+    if (!slash) {
+        snprintf(dir, sizeof(dir), ".");
+    } else if (slash == path) {
+        snprintf(dir, sizeof(dir), "/");
+    } else {
+        snprintf(dir, sizeof(dir), "%.*s", (int) (slash - path), path);
+    }
+
+    // the same directory always maps to the same watch descriptor
+    const int wd = inotify_add_watch(fd, dir, IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE);
+    if (wd < 0) {
+        WATCHER_LOG(GWR_LOG_WARNING, "can't watch '%s'", dir);
+    }
+    return wd;
+}
+
+static void release_dir_watch(GWR_shader_watcher_t *watcher, int wd) {
+    if (wd < 0) {
+        return;
+    }
+    for (int i = 0; i < watcher->count; ++i) {
+        const watch_entry_t *e = &watcher->entries[i];
+        for (int f = 0; f < e->file_count; ++f) {
+            if (e->files[f].wd == wd) {
+                return;
+            }
+        }
+    }
+    inotify_rm_watch(watcher->fd, wd);
+}
+
+static void *notify_thread(void *arg) {
+    GWR_shader_watcher_t *watcher = arg;
+
+    // aligned as inotify_event requires
+    char buf[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+    struct pollfd pfd = {.fd = watcher->fd, .events = POLLIN};
+
+    while (!atomic_load(&watcher->stop)) {
+        if (poll(&pfd, 1, WATCHER_POLL_MS) <= 0) {
+            continue;
+        }
+
+        const ssize_t len = read(watcher->fd, buf, sizeof(buf));
+        if (len <= 0) {
+            continue;
+        }
+
+        pthread_mutex_lock(&watcher->lock);
+        for (ssize_t off = 0; off < len;) {
+            const struct inotify_event *ev = (const struct inotify_event *) (buf + off);
+            off += (ssize_t) (sizeof(struct inotify_event) + ev->len);
+            if (!ev->len) {
+                continue;
+            }
+
+            for (int i = 0; i < watcher->count; ++i) {
+                watch_entry_t *e = &watcher->entries[i];
+                for (int f = 0; f < e->file_count; ++f) {
+                    if (e->files[f].wd == ev->wd && strcmp(e->files[f].name, ev->name) == 0) {
+                        mark_dirty(e);
+                        break;
+                    }
+                }
+            }
+        }
+        pthread_mutex_unlock(&watcher->lock);
+    }
+
+    return NULL;
+}
+
+#endif
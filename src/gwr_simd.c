@@ -0,0 +1,778 @@
+#include "internal/gwr_simd.h"
+#include "internal/gwr_log.h"
+#include "internal/gwr_util.h"
+
+#include <assert.h>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__)) && defined(__SSE2__)
+#define SIMD_HAS_X86 1
+#include <immintrin.h>
+#define SIMD_TARGET_AVX2 __attribute__((target("avx2,fma")))
+#else
+#define SIMD_HAS_X86 0
+#endif
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define SIMD_HAS_NEON 1
+#include <arm_neon.h>
+#else
+#define SIMD_HAS_NEON 0
+#endif
+
+#define SIMD_LOG(level, msg, ...)    GWR_LOG_AT(GWR_LOG_SYS_SIMD, (level), msg, ##__VA_ARGS__)
+
+// frustum planes padded to 8 lanes, the padding planes (0, 0, 0, 1) never reject
+#define SIMD_PLANE_LANES 8
+
+GWR_STATIC_ASSERT(sizeof(GWR_aabb_t) == 6 * sizeof(float), "GWR_aabb_t must alias vec3[2]");
+
+typedef struct {
+    void (*mat4_mul)(mat4, mat4, mat4);
+    void (*transform_aos)(mat4, vec3 *, vec3 *, size_t);
+    void (*transform_soa)(mat4, const float *, const float *, const float *, float *, float *, float *, size_t);
+    void (*aabb_transform)(mat4, const GWR_aabb_t *, GWR_aabb_t *, size_t);
+    size_t (*cull_aabbs)(vec4 *, const GWR_aabb_t *, size_t, uint8_t *);
+} simd_backend_t;
+
+static const simd_backend_t *s_backend = NULL;
+static GWR_simd_backend_e s_backend_id = GWR_SIMD_SCALAR;
+
+static const char *s_backend_names[] = {
+    "scalar",
+    "sse2",
+    "avx2",
+    "neon"
+};
+
+GWR_STATIC_ASSERT(GWR_ARR_LEN(s_backend_names) == GWR_SIMD__COUNT, "backend names out of sync");
+
+// inner funcs decls
+
+static void point_transform(mat4 m, float x, float y, float z, float *out);
+
+static void planes_to_soa(vec4 planes[6], float soa[4][SIMD_PLANE_LANES]);
+
+static void scalar_mat4_mul(mat4 a, mat4 b, mat4 dest);
+static void scalar_transform_aos(mat4 m, vec3 *in, vec3 *out, size_t n);
+static void scalar_transform_soa(
+    mat4 m, const float *x, const float *y, const float *z, float *ox, float *oy, float *oz, size_t n
+);
+static void scalar_aabb_transform(mat4 m, const GWR_aabb_t *in, GWR_aabb_t *out, size_t n);
+static size_t scalar_cull_aabbs(vec4 *planes, const GWR_aabb_t *boxes, size_t n, uint8_t *visible);
+
+#if SIMD_HAS_X86
+static void sse_mat4_mul(mat4 a, mat4 b, mat4 dest);
+static void sse_transform_aos(mat4 m, vec3 *in, vec3 *out, size_t n);
+static void sse_transform_soa(
+    mat4 m, const float *x, const float *y, const float *z, float *ox, float *oy, float *oz, size_t n
+);
+static void sse_aabb_transform(mat4 m, const GWR_aabb_t *in, GWR_aabb_t *out, size_t n);
+static size_t sse_cull_aabbs(vec4 *planes, const GWR_aabb_t *boxes, size_t n, uint8_t *visible);
+
+static void avx2_mat4_mul(mat4 a, mat4 b, mat4 dest);
+static void avx2_transform_aos(mat4 m, vec3 *in, vec3 *out, size_t n);
+static void avx2_transform_soa(
+    mat4 m, const float *x, const float *y, const float *z, float *ox, float *oy, float *oz, size_t n
+);
+static void avx2_aabb_transform(mat4 m, const GWR_aabb_t *in, GWR_aabb_t *out, size_t n);
+static size_t avx2_cull_aabbs(vec4 *planes, const GWR_aabb_t *boxes, size_t n, uint8_t *visible);
+#endif
+
+#if SIMD_HAS_NEON
+static void neon_mat4_mul(mat4 a, mat4 b, mat4 dest);
+static void neon_transform_aos(mat4 m, vec3 *in, vec3 *out, size_t n);
+static void neon_transform_soa(
+    mat4 m, const float *x, const float *y, const float *z, float *ox, float *oy, float *oz, size_t n
+);
+static void neon_aabb_transform(mat4 m, const GWR_aabb_t *in, GWR_aabb_t *out, size_t n);
+static size_t neon_cull_aabbs(vec4 *planes, const GWR_aabb_t *boxes, size_t n, uint8_t *visible);
+#endif
+
+static const simd_backend_t s_backends[GWR_SIMD__COUNT] = {
+    [GWR_SIMD_SCALAR] = {
+        scalar_mat4_mul, scalar_transform_aos, scalar_transform_soa, scalar_aabb_transform, scalar_cull_aabbs
+    },
+#if SIMD_HAS_X86
+    [GWR_SIMD_SSE] = {
+        sse_mat4_mul, sse_transform_aos, sse_transform_soa, sse_aabb_transform, sse_cull_aabbs
+    },
+    [GWR_SIMD_AVX2] = {
+        avx2_mat4_mul, avx2_transform_aos, avx2_transform_soa, avx2_aabb_transform, avx2_cull_aabbs
+    },
+#endif
+#if SIMD_HAS_NEON
+    [GWR_SIMD_NEON] = {
+        neon_mat4_mul, neon_transform_aos, neon_transform_soa, neon_aabb_transform, neon_cull_aabbs
+    },
+#endif
+};
+
+static const simd_backend_t *simd_pick_backend(void);
+
+// public funcs defs
+
+GWR_simd_backend_e GWR_simd_get_backend(void) {
+    simd_pick_backend();
+
+    return s_backend_id;
+}
+
+const char *GWR_simd_get_backend_name(GWR_simd_backend_e backend) {
+    assert(backend < GWR_SIMD__COUNT);
+
+    return s_backend_names[backend];
+}
+
+bool GWR_simd_is_supported(GWR_simd_backend_e backend) {
+    if (backend >= GWR_SIMD__COUNT || !s_backends[backend].mat4_mul) {
+        return false;
+    }
+
+#if SIMD_HAS_X86
+    if (backend == GWR_SIMD_AVX2) {
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+    }
+#endif
+    return true;
+}
+
+bool GWR_simd_set_backend(GWR_simd_backend_e backend) {
+    if (!GWR_simd_is_supported(backend)) {
+        SIMD_LOG(GWR_LOG_WARNING, "backend '%s' is not supported", GWR_simd_get_backend_name(backend));
+        return false;
+    }
+
+    s_backend_id = backend;
+    s_backend = &s_backends[backend];
+    return true;
+}
+
+void GWR_simd_mat4_mul(mat4 a, mat4 b, mat4 dest) {
+    assert(a);
+    assert(b);
+    assert(dest);
+
+    simd_pick_backend()->mat4_mul(a, b, dest);
+}
+
+void GWR_simd_mat4_mul_n(mat4 m, mat4 *in, mat4 *out, size_t n) {
+    assert(m);
+    assert(in || !n);
+    assert(out || !n);
+
+    const simd_backend_t *backend = simd_pick_backend();
+    for (size_t i = 0; i < n; ++i) {
+        backend->mat4_mul(m, in[i], out[i]);
+    }
+}
+
+void GWR_simd_transform_points_aos(mat4 m, vec3 *in, vec3 *out, size_t n) {
+    assert(m);
+    assert(in || !n);
+    assert(out || !n);
+
+    simd_pick_backend()->transform_aos(m, in, out, n);
+}
+
+void GWR_simd_transform_points_soa(
+    mat4 m,
+    const float *x, const float *y, const float *z,
+    float *out_x, float *out_y, float *out_z,
+    size_t n
+) {
+    assert(m);
+    assert((x && y && z) || !n);
+    assert((out_x && out_y && out_z) || !n);
+
+    simd_pick_backend()->transform_soa(m, x, y, z, out_x, out_y, out_z, n);
+}
+
+void GWR_simd_aabb_transform(mat4 m, const GWR_aabb_t *in, GWR_aabb_t *out, size_t n) {
+    assert(m);
+    assert(in || !n);
+    assert(out || !n);
+
+    simd_pick_backend()->aabb_transform(m, in, out, n);
+}
+
+void GWR_simd_frustum_planes(mat4 view_proj, vec4 planes[6]) {
+    assert(view_proj);
+    assert(planes);
+
+    glm_frustum_planes(view_proj, planes);
+}
+
+size_t GWR_simd_frustum_cull_aabbs(vec4 planes[6], const GWR_aabb_t *boxes, size_t n, uint8_t *visible) {
+    assert(planes);
+    assert(boxes || !n);
+    assert(visible || !n);
+
+    return simd_pick_backend()->cull_aabbs(planes, boxes, n, visible);
+}
+
+// inner funcs defs
+
+static const simd_backend_t *simd_pick_backend(void) {
+    if (s_backend) {
+        return s_backend;
+    }
+
+    GWR_simd_backend_e id = GWR_SIMD_SCALAR;
+    if (GWR_simd_is_supported(GWR_SIMD_AVX2)) {
+        id = GWR_SIMD_AVX2;
+    } else if (GWR_simd_is_supported(GWR_SIMD_SSE)) {
+        id = GWR_SIMD_SSE;
+    } else if (GWR_simd_is_supported(GWR_SIMD_NEON)) {
+        id = GWR_SIMD_NEON;
+    }
+
+    s_backend_id = id;
+    s_backend = &s_backends[id];
+    return s_backend;
+}
+
+static void point_transform(mat4 m, float x, float y, float z, float *out) {
+    const float rx = m[0][0] * x + m[1][0] * y + m[2][0] * z + m[3][0];
+    const float ry = m[0][1] * x + m[1][1] * y + m[2][1] * z + m[3][1];
+    const float rz = m[0][2] * x + m[1][2] * y + m[2][2] * z + m[3][2];
+    out[0] = rx;
+    out[1] = ry;
+    out[2] = rz;
+}
+
+static void planes_to_soa(vec4 planes[6], float soa[4][SIMD_PLANE_LANES]) {
+    for (int i = 0; i < SIMD_PLANE_LANES; ++i) {
+        for (int c = 0; c < 4; ++c) {
+            soa[c][i] = i < 6 ? planes[i][c] : (c == 3 ? 1.f : 0.f);
+        }
+    }
+}
+
+// scalar: cglm reference
+
+static void scalar_mat4_mul(mat4 a, mat4 b, mat4 dest) {
+    glm_mat4_mul(a, b, dest);
+}
+
+static void scalar_transform_aos(mat4 m, vec3 *in, vec3 *out, size_t n) {
+    for (size_t i = 0; i < n; ++i) {
+        glm_mat4_mulv3(m, (float *) in[i], 1.f, out[i]);
+    }
+}
+
+static void scalar_transform_soa(
+    mat4 m, const float *x, const float *y, const float *z, float *ox, float *oy, float *oz, size_t n
+) {
+    for (size_t i = 0; i < n; ++i) {
+        float r[3];
+        point_transform(m, x[i], y[i], z[i], r);
+        ox[i] = r[0];
+        oy[i] = r[1];
+        oz[i] = r[2];
+    }
+}
+
+static void scalar_aabb_transform(mat4 m, const GWR_aabb_t *in, GWR_aabb_t *out, size_t n) {
+    for (size_t i = 0; i < n; ++i) {
+        glm_aabb_transform((vec3 *) &in[i], m, (vec3 *) &out[i]);
+    }
+}
+
+static size_t scalar_cull_aabbs(vec4 *planes, const GWR_aabb_t *boxes, size_t n, uint8_t *visible) {
+    size_t count = 0;
+    for (size_t i = 0; i < n; ++i) {
+        visible[i] = glm_aabb_frustum((vec3 *) &boxes[i], planes) ? 1 : 0;
+        count += visible[i];
+    }
+    return count;
+}
+
+#if SIMD_HAS_X86
+
+// sse2
+
+static inline __m128 sse_splat(__m128 v, int lane) {
+    switch (lane) {
+        case 0: return _mm_shuffle_ps(v, v, _MM_SHUFFLE(0, 0, 0, 0));
+        case 1: return _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 1, 1, 1));
+        case 2: return _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 2, 2, 2));
+        default: return _mm_shuffle_ps(v, v, _MM_SHUFFLE(3, 3, 3, 3));
+    }
+}
+
+static inline __m128 sse_abs(__m128 v) {
+    return _mm_andnot_ps(_mm_set1_ps(-0.f), v);
+}
+
+static inline __m128 sse_load3(const float *src) {
+    return _mm_setr_ps(src[0], src[1], src[2], 0.f);
+}
+
+static inline void sse_store3(float *dst, __m128 v) {
+    _mm_storel_pi((__m64 *) dst, v);
+    _mm_store_ss(dst + 2, _mm_movehl_ps(v, v));
+}
+
+// 4 packed xyz points (12 floats) <-> x, y, z lanes
+static inline void sse_load_xyz4(const float *src, __m128 *x, __m128 *y, __m128 *z) {
+    const __m128 v0 = _mm_loadu_ps(src);        // x0 y0 z0 x1
+    const __m128 v1 = _mm_loadu_ps(src + 4);    // y1 z1 x2 y2
+    const __m128 v2 = _mm_loadu_ps(src + 8);    // z2 x3 y3 z3
+
+    const __m128 xa = _mm_shuffle_ps(v0, v1, _MM_SHUFFLE(0, 2, 3, 0));  // x0 x1 x2 y1
+    const __m128 xb = _mm_shuffle_ps(xa, v2, _MM_SHUFFLE(1, 1, 2, 2));  // x2 x2 x3 x3
+    *x = _mm_shuffle_ps(xa, xb, _MM_SHUFFLE(2, 0, 1, 0));
+
+    const __m128 ya = _mm_shuffle_ps(v0, v1, _MM_SHUFFLE(3, 0, 1, 1));  // y0 y0 y1 y2
+    const __m128 yb = _mm_shuffle_ps(ya, v2, _MM_SHUFFLE(2, 2, 3, 3));  // y2 y2 y3 y3
+    *y = _mm_shuffle_ps(ya, yb, _MM_SHUFFLE(2, 0, 2, 0));
+
+    const __m128 za = _mm_shuffle_ps(v0, v1, _MM_SHUFFLE(1, 1, 2, 2));  // z0 z0 z1 z1
+    *z = _mm_shuffle_ps(za, v2, _MM_SHUFFLE(3, 0, 2, 0));
+}
+
+static inline void sse_store_xyz4(float *dst, __m128 x, __m128 y, __m128 z) {
+    const __m128 a = _mm_unpacklo_ps(x, y);     // x0 y0 x1 y1
+    const __m128 b = _mm_unpackhi_ps(x, y);     // x2 y2 x3 y3
+
+    const __m128 t0 = _mm_shuffle_ps(z, a, _MM_SHUFFLE(2, 2, 0, 0));    // z0 z0 x1 x1
+    const __m128 t1 = _mm_shuffle_ps(a, z, _MM_SHUFFLE(1, 1, 3, 3));    // y1 y1 z1 z1
+    const __m128 t2 = _mm_shuffle_ps(z, b, _MM_SHUFFLE(3, 2, 3, 2));    // z2 z3 x3 y3
+
+    _mm_storeu_ps(dst, _mm_shuffle_ps(a, t0, _MM_SHUFFLE(2, 0, 1, 0)));
+    _mm_storeu_ps(dst + 4, _mm_shuffle_ps(t1, b, _MM_SHUFFLE(1, 0, 2, 0)));
+    _mm_storeu_ps(dst + 8, _mm_shuffle_ps(t2, t2, _MM_SHUFFLE(1, 3, 2, 0)));
+}
+
+static inline void sse_transform4(
+    mat4 m, __m128 x, __m128 y, __m128 z, __m128 *ox, __m128 *oy, __m128 *oz
+) {
+    __m128 *outs[3] = {ox, oy, oz};
+    for (int r = 0; r < 3; ++r) {
+        __m128 acc = _mm_set1_ps(m[3][r]);
+        acc = _mm_add_ps(acc, _mm_mul_ps(x, _mm_set1_ps(m[0][r])));
+        acc = _mm_add_ps(acc, _mm_mul_ps(y, _mm_set1_ps(m[1][r])));
+        acc = _mm_add_ps(acc, _mm_mul_ps(z, _mm_set1_ps(m[2][r])));
+        *outs[r] = acc;
+    }
+}
+
+static void sse_mat4_mul(mat4 a, mat4 b, mat4 dest) {
+    const __m128 a0 = _mm_loadu_ps(a[0]);
+    const __m128 a1 = _mm_loadu_ps(a[1]);
+    const __m128 a2 = _mm_loadu_ps(a[2]);
+    const __m128 a3 = _mm_loadu_ps(a[3]);
+
+    __m128 cols[4];
+    for (int j = 0; j < 4; ++j) {
+        cols[j] = _mm_loadu_ps(b[j]);
+    }
+
+    for (int j = 0; j < 4; ++j) {
+        __m128 r = _mm_mul_ps(a0, sse_splat(cols[j], 0));
+        r = _mm_add_ps(r, _mm_mul_ps(a1, sse_splat(cols[j], 1)));
+        r = _mm_add_ps(r, _mm_mul_ps(a2, sse_splat(cols[j], 2)));
+        r = _mm_add_ps(r, _mm_mul_ps(a3, sse_splat(cols[j], 3)));
+        _mm_storeu_ps(dest[j], r);
+    }
+}
+
+static void sse_transform_aos(mat4 m, vec3 *in, vec3 *out, size_t n) {
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128 x, y, z, ox, oy, oz;
+        sse_load_xyz4(in[i], &x, &y, &z);
+        sse_transform4(m, x, y, z, &ox, &oy, &oz);
+        sse_store_xyz4(out[i], ox, oy, oz);
+    }
+    for (; i < n; ++i) {
+        point_transform(m, in[i][0], in[i][1], in[i][2], out[i]);
+    }
+}
+
+static void sse_transform_soa(
+    mat4 m, const float *x, const float *y, const float *z, float *ox, float *oy, float *oz, size_t n
+) {
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128 rx, ry, rz;
+        sse_transform4(m, _mm_loadu_ps(x + i), _mm_loadu_ps(y + i), _mm_loadu_ps(z + i), &rx, &ry, &rz);
+        _mm_storeu_ps(ox + i, rx);
+        _mm_storeu_ps(oy + i, ry);
+        _mm_storeu_ps(oz + i, rz);
+    }
+    scalar_transform_soa(m, x + i, y + i, z + i, ox + i, oy + i, oz + i, n - i);
+}
+
+static void sse_aabb_transform(mat4 m, const GWR_aabb_t *in, GWR_aabb_t *out, size_t n) {
+    const __m128 c0 = _mm_loadu_ps(m[0]);
+    const __m128 c1 = _mm_loadu_ps(m[1]);
+    const __m128 c2 = _mm_loadu_ps(m[2]);
+    const __m128 c3 = _mm_loadu_ps(m[3]);
+    const __m128 a0 = sse_abs(c0);
+    const __m128 a1 = sse_abs(c1);
+    const __m128 a2 = sse_abs(c2);
+    const __m128 half = _mm_set1_ps(0.5f);
+
+    for (size_t i = 0; i < n; ++i) {
+        const __m128 mn = sse_load3(in[i].min);
+        const __m128 mx = sse_load3(in[i].max);
+        const __m128 c = _mm_mul_ps(_mm_add_ps(mn, mx), half);
+        const __m128 e = _mm_mul_ps(_mm_sub_ps(mx, mn), half);
+
+        __m128 nc = _mm_add_ps(c3, _mm_mul_ps(c0, sse_splat(c, 0)));
+        nc = _mm_add_ps(nc, _mm_mul_ps(c1, sse_splat(c, 1)));
+        nc = _mm_add_ps(nc, _mm_mul_ps(c2, sse_splat(c, 2)));
+
+        __m128 ne = _mm_mul_ps(a0, sse_splat(e, 0));
+        ne = _mm_add_ps(ne, _mm_mul_ps(a1, sse_splat(e, 1)));
+        ne = _mm_add_ps(ne, _mm_mul_ps(a2, sse_splat(e, 2)));
+
+        sse_store3(out[i].min, _mm_sub_ps(nc, ne));
+        sse_store3(out[i].max, _mm_add_ps(nc, ne));
+    }
+}
+
+static size_t sse_cull_aabbs(vec4 *planes, const GWR_aabb_t *boxes, size_t n, uint8_t *visible) {
+    float soa[4][SIMD_PLANE_LANES];
+    planes_to_soa(planes, soa);
+
+    __m128 p[4][2], ap[3][2];
+    for (int c = 0; c < 4; ++c) {
+        for (int h = 0; h < 2; ++h) {
+            p[c][h] = _mm_loadu_ps(&soa[c][h * 4]);
+            if (c < 3) {
+                ap[c][h] = sse_abs(p[c][h]);
+            }
+        }
+    }
+
+    const __m128 half = _mm_set1_ps(0.5f);
+    const __m128 zero = _mm_setzero_ps();
+
+    size_t count = 0;
+    for (size_t i = 0; i < n; ++i) {
+        const __m128 mn = sse_load3(boxes[i].min);
+        const __m128 mx = sse_load3(boxes[i].max);
+        const __m128 c = _mm_mul_ps(_mm_add_ps(mn, mx), half);
+        const __m128 e = _mm_mul_ps(_mm_sub_ps(mx, mn), half);
+
+        int outside = 0;
+        for (int h = 0; h < 2; ++h) {
+            // signed distance of the center plus the box radius along the plane normal
+            __m128 d = p[3][h];
+            for (int k = 0; k < 3; ++k) {
+                d = _mm_add_ps(d, _mm_mul_ps(p[k][h], sse_splat(c, k)));
+                d = _mm_add_ps(d, _mm_mul_ps(ap[k][h], sse_splat(e, k)));
+            }
+            outside |= _mm_movemask_ps(_mm_cmplt_ps(d, zero));
+        }
+
+        visible[i] = outside ? 0 : 1;
+        count += visible[i];
+    }
+    return count;
+}
+
+// avx2 + fma
+
+SIMD_TARGET_AVX2
+static void avx2_mat4_mul(mat4 a, mat4 b, mat4 dest) {
+    const __m256 a0 = _mm256_broadcast_ps((const __m128 *) a[0]);
+    const __m256 a1 = _mm256_broadcast_ps((const __m128 *) a[1]);
+    const __m256 a2 = _mm256_broadcast_ps((const __m128 *) a[2]);
+    const __m256 a3 = _mm256_broadcast_ps((const __m128 *) a[3]);
+
+    // two columns of b per register
+    const __m256 b01 = _mm256_loadu_ps(b[0]);
+    const __m256 b23 = _mm256_loadu_ps(b[2]);
+
+    __m256 r01 = _mm256_mul_ps(a0, _mm256_permute_ps(b01, 0x00));
+    r01 = _mm256_fmadd_ps(a1, _mm256_permute_ps(b01, 0x55), r01);
+    r01 = _mm256_fmadd_ps(a2, _mm256_permute_ps(b01, 0xAA), r01);
+    r01 = _mm256_fmadd_ps(a3, _mm256_permute_ps(b01, 0xFF), r01);
+
+    __m256 r23 = _mm256_mul_ps(a0, _mm256_permute_ps(b23, 0x00));
+    r23 = _mm256_fmadd_ps(a1, _mm256_permute_ps(b23, 0x55), r23);
+    r23 = _mm256_fmadd_ps(a2, _mm256_permute_ps(b23, 0xAA), r23);
+    r23 = _mm256_fmadd_ps(a3, _mm256_permute_ps(b23, 0xFF), r23);
+
+    _mm256_storeu_ps(dest[0], r01);
+    _mm256_storeu_ps(dest[2], r23);
+}
+
+SIMD_TARGET_AVX2
+static inline void avx2_transform8(
+    mat4 m, __m256 x, __m256 y, __m256 z, __m256 *ox, __m256 *oy, __m256 *oz
+) {
+    __m256 *outs[3] = {ox, oy, oz};
+    for (int r = 0; r < 3; ++r) {
+        __m256 acc = _mm256_set1_ps(m[3][r]);
+        acc = _mm256_fmadd_ps(x, _mm256_set1_ps(m[0][r]), acc);
+        acc = _mm256_fmadd_ps(y, _mm256_set1_ps(m[1][r]), acc);
+        acc = _mm256_fmadd_ps(z, _mm256_set1_ps(m[2][r]), acc);
+        *outs[r] = acc;
+    }
+}
+
+SIMD_TARGET_AVX2
+static void avx2_transform_aos(mat4 m, vec3 *in, vec3 *out, size_t n) {
+    const __m256i idx = _mm256_setr_epi32(0, 3, 6, 9, 12, 15, 18, 21);
+
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        const float *src = in[i];
+        const __m256 x = _mm256_i32gather_ps(src, idx, 4);
+        const __m256 y = _mm256_i32gather_ps(src + 1, idx, 4);
+        const __m256 z = _mm256_i32gather_ps(src + 2, idx, 4);
+
+        __m256 ox, oy, oz;
+        avx2_transform8(m, x, y, z, &ox, &oy, &oz);
+
+        sse_store_xyz4(
+            out[i],
+            _mm256_castps256_ps128(ox), _mm256_castps256_ps128(oy), _mm256_castps256_ps128(oz)
+        );
+        sse_store_xyz4(
+            out[i + 4],
+            _mm256_extractf128_ps(ox, 1), _mm256_extractf128_ps(oy, 1), _mm256_extractf128_ps(oz, 1)
+        );
+    }
+    sse_transform_aos(m, in + i, out + i, n - i);
+}
+
+SIMD_TARGET_AVX2
+static void avx2_transform_soa(
+    mat4 m, const float *x, const float *y, const float *z, float *ox, float *oy, float *oz, size_t n
+) {
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256 rx, ry, rz;
+        avx2_transform8(
+            m, _mm256_loadu_ps(x + i), _mm256_loadu_ps(y + i), _mm256_loadu_ps(z + i), &rx, &ry, &rz
+        );
+        _mm256_storeu_ps(ox + i, rx);
+        _mm256_storeu_ps(oy + i, ry);
+        _mm256_storeu_ps(oz + i, rz);
+    }
+    sse_transform_soa(m, x + i, y + i, z + i, ox + i, oy + i, oz + i, n - i);
+}
+
+SIMD_TARGET_AVX2
+static void avx2_aabb_transform(mat4 m, const GWR_aabb_t *in, GWR_aabb_t *out, size_t n) {
+    const __m256 c0 = _mm256_broadcast_ps((const __m128 *) m[0]);
+    const __m256 c1 = _mm256_broadcast_ps((const __m128 *) m[1]);
+    const __m256 c2 = _mm256_broadcast_ps((const __m128 *) m[2]);
+    const __m256 c3 = _mm256_broadcast_ps((const __m128 *) m[3]);
+    const __m256 sign = _mm256_set1_ps(-0.f);
+    const __m256 a0 = _mm256_andnot_ps(sign, c0);
+    const __m256 a1 = _mm256_andnot_ps(sign, c1);
+    const __m256 a2 = _mm256_andnot_ps(sign, c2);
+    const __m256 half = _mm256_set1_ps(0.5f);
+
+    // one box per 128-bit lane
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2) {
+        const __m256 mn = _mm256_insertf128_ps(
+            _mm256_castps128_ps256(sse_load3(in[i].min)), sse_load3(in[i + 1].min), 1
+        );
+        const __m256 mx = _mm256_insertf128_ps(
+            _mm256_castps128_ps256(sse_load3(in[i].max)), sse_load3(in[i + 1].max), 1
+        );
+        const __m256 c = _mm256_mul_ps(_mm256_add_ps(mn, mx), half);
+        const __m256 e = _mm256_mul_ps(_mm256_sub_ps(mx, mn), half);
+
+        __m256 nc = _mm256_fmadd_ps(c0, _mm256_permute_ps(c, 0x00), c3);
+        nc = _mm256_fmadd_ps(c1, _mm256_permute_ps(c, 0x55), nc);
+        nc = _mm256_fmadd_ps(c2, _mm256_permute_ps(c, 0xAA), nc);
+
+        __m256 ne = _mm256_mul_ps(a0, _mm256_permute_ps(e, 0x00));
+        ne = _mm256_fmadd_ps(a1, _mm256_permute_ps(e, 0x55), ne);
+        ne = _mm256_fmadd_ps(a2, _mm256_permute_ps(e, 0xAA), ne);
+
+        const __m256 rmin = _mm256_sub_ps(nc, ne);
+        const __m256 rmax = _mm256_add_ps(nc, ne);
+
+        sse_store3(out[i].min, _mm256_castps256_ps128(rmin));
+        sse_store3(out[i].max, _mm256_castps256_ps128(rmax));
+        sse_store3(out[i + 1].min, _mm256_extractf128_ps(rmin, 1));
+        sse_store3(out[i + 1].max, _mm256_extractf128_ps(rmax, 1));
+    }
+    sse_aabb_transform(m, in + i, out + i, n - i);
+}
+
+SIMD_TARGET_AVX2
+static size_t avx2_cull_aabbs(vec4 *planes, const GWR_aabb_t *boxes, size_t n, uint8_t *visible) {
+    float soa[4][SIMD_PLANE_LANES];
+    planes_to_soa(planes, soa);
+
+    const __m256 px = _mm256_loadu_ps(soa[0]);
+    const __m256 py = _mm256_loadu_ps(soa[1]);
+    const __m256 pz = _mm256_loadu_ps(soa[2]);
+    const __m256 pw = _mm256_loadu_ps(soa[3]);
+    const __m256 sign = _mm256_set1_ps(-0.f);
+    const __m256 apx = _mm256_andnot_ps(sign, px);
+    const __m256 apy = _mm256_andnot_ps(sign, py);
+    const __m256 apz = _mm256_andnot_ps(sign, pz);
+    const __m256 zero = _mm256_setzero_ps();
+
+    // all six planes of one box per iteration
+    size_t count = 0;
+    for (size_t i = 0; i < n; ++i) {
+        const float *mn = boxes[i].min;
+        const float *mx = boxes[i].max;
+
+        __m256 d = _mm256_fmadd_ps(px, _mm256_set1_ps((mn[0] + mx[0]) * 0.5f), pw);
+        d = _mm256_fmadd_ps(py, _mm256_set1_ps((mn[1] + mx[1]) * 0.5f), d);
+        d = _mm256_fmadd_ps(pz, _mm256_set1_ps((mn[2] + mx[2]) * 0.5f), d);
+        d = _mm256_fmadd_ps(apx, _mm256_set1_ps((mx[0] - mn[0]) * 0.5f), d);
+        d = _mm256_fmadd_ps(apy, _mm256_set1_ps((mx[1] - mn[1]) * 0.5f), d);
+        d = _mm256_fmadd_ps(apz, _mm256_set1_ps((mx[2] - mn[2]) * 0.5f), d);
+
+        visible[i] = _mm256_movemask_ps(_mm256_cmp_ps(d, zero, _CMP_LT_OQ)) ? 0 : 1;
+        count += visible[i];
+    }
+    return count;
+}
+
+#endif // SIMD_HAS_X86
+
+#if SIMD_HAS_NEON
+
+static inline float32x4_t neon_load3(const float *src) {
+    return vsetq_lane_f32(src[2], vcombine_f32(vld1_f32(src), vdup_n_f32(0.f)), 2);
+}
+
+static inline void neon_store3(float *dst, float32x4_t v) {
+    vst1_f32(dst, vget_low_f32(v));
+    dst[2] = vgetq_lane_f32(v, 2);
+}
+
+static inline void neon_transform4(
+    mat4 m, float32x4_t x, float32x4_t y, float32x4_t z, float32x4_t *ox, float32x4_t *oy, float32x4_t *oz
+) {
+    float32x4_t *outs[3] = {ox, oy, oz};
+    for (int r = 0; r < 3; ++r) {
+        float32x4_t acc = vdupq_n_f32(m[3][r]);
+        acc = vmlaq_n_f32(acc, x, m[0][r]);
+        acc = vmlaq_n_f32(acc, y, m[1][r]);
+        acc = vmlaq_n_f32(acc, z, m[2][r]);
+        *outs[r] = acc;
+    }
+}
+
+static void neon_mat4_mul(mat4 a, mat4 b, mat4 dest) {
+    const float32x4_t a0 = vld1q_f32(a[0]);
+    const float32x4_t a1 = vld1q_f32(a[1]);
+    const float32x4_t a2 = vld1q_f32(a[2]);
+    const float32x4_t a3 = vld1q_f32(a[3]);
+
+    float32x4_t cols[4];
+    for (int j = 0; j < 4; ++j) {
+        cols[j] = vld1q_f32(b[j]);
+    }
+
+    for (int j = 0; j < 4; ++j) {
+        float32x4_t r = vmulq_n_f32(a0, vgetq_lane_f32(cols[j], 0));
+        r = vmlaq_n_f32(r, a1, vgetq_lane_f32(cols[j], 1));
+        r = vmlaq_n_f32(r, a2, vgetq_lane_f32(cols[j], 2));
+        r = vmlaq_n_f32(r, a3, vgetq_lane_f32(cols[j], 3));
+        vst1q_f32(dest[j], r);
+    }
+}
+
+static void neon_transform_aos(mat4 m, vec3 *in, vec3 *out, size_t n) {
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        const float32x4x3_t p = vld3q_f32(in[i]);
+        float32x4x3_t r;
+        neon_transform4(m, p.val[0], p.val[1], p.val[2], &r.val[0], &r.val[1], &r.val[2]);
+        vst3q_f32(out[i], r);
+    }
+    for (; i < n; ++i) {
+        point_transform(m, in[i][0], in[i][1], in[i][2], out[i]);
+    }
+}
+
+static void neon_transform_soa(
+    mat4 m, const float *x, const float *y, const float *z, float *ox, float *oy, float *oz, size_t n
+) {
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        float32x4_t rx, ry, rz;
+        neon_transform4(m, vld1q_f32(x + i), vld1q_f32(y + i), vld1q_f32(z + i), &rx, &ry, &rz);
+        vst1q_f32(ox + i, rx);
+        vst1q_f32(oy + i, ry);
+        vst1q_f32(oz + i, rz);
+    }
+    scalar_transform_soa(m, x + i, y + i, z + i, ox + i, oy + i, oz + i, n - i);
+}
+
+static void neon_aabb_transform(mat4 m, const GWR_aabb_t *in, GWR_aabb_t *out, size_t n) {
+    const float32x4_t c0 = vld1q_f32(m[0]);
+    const float32x4_t c1 = vld1q_f32(m[1]);
+    const float32x4_t c2 = vld1q_f32(m[2]);
+    const float32x4_t c3 = vld1q_f32(m[3]);
+    const float32x4_t a0 = vabsq_f32(c0);
+    const float32x4_t a1 = vabsq_f32(c1);
+    const float32x4_t a2 = vabsq_f32(c2);
+
+    for (size_t i = 0; i < n; ++i) {
+        const float32x4_t mn = neon_load3(in[i].min);
+        const float32x4_t mx = neon_load3(in[i].max);
+        const float32x4_t c = vmulq_n_f32(vaddq_f32(mn, mx), 0.5f);
+        const float32x4_t e = vmulq_n_f32(vsubq_f32(mx, mn), 0.5f);
+
+        float32x4_t nc = vmlaq_n_f32(c3, c0, vgetq_lane_f32(c, 0));
+        nc = vmlaq_n_f32(nc, c1, vgetq_lane_f32(c, 1));
+        nc = vmlaq_n_f32(nc, c2, vgetq_lane_f32(c, 2));
+
+        float32x4_t ne = vmulq_n_f32(a0, vgetq_lane_f32(e, 0));
+        ne = vmlaq_n_f32(ne, a1, vgetq_lane_f32(e, 1));
+        ne = vmlaq_n_f32(ne, a2, vgetq_lane_f32(e, 2));
+
+        neon_store3(out[i].min, vsubq_f32(nc, ne));
+        neon_store3(out[i].max, vaddq_f32(nc, ne));
+    }
+}
+
+static size_t neon_cull_aabbs(vec4 *planes, const GWR_aabb_t *boxes, size_t n, uint8_t *visible) {
+    float soa[4][SIMD_PLANE_LANES];
+    planes_to_soa(planes, soa);
+
+    float32x4_t p[4][2], ap[3][2];
+    for (int c = 0; c < 4; ++c) {
+        for (int h = 0; h < 2; ++h) {
+            p[c][h] = vld1q_f32(&soa[c][h * 4]);
+            if (c < 3) {
+                ap[c][h] = vabsq_f32(p[c][h]);
+            }
+        }
+    }
+
+    size_t count = 0;
+    for (size_t i = 0; i < n; ++i) {
+        const float *mn = boxes[i].min;
+        const float *mx = boxes[i].max;
+        const float c[3] = {(mn[0] + mx[0]) * 0.5f, (mn[1] + mx[1]) * 0.5f, (mn[2] + mx[2]) * 0.5f};
+        const float e[3] = {(mx[0] - mn[0]) * 0.5f, (mx[1] - mn[1]) * 0.5f, (mx[2] - mn[2]) * 0.5f};
+
+        uint32x4_t outside = vdupq_n_u32(0);
+        for (int h = 0; h < 2; ++h) {
+            float32x4_t d = p[3][h];
+            for (int k = 0; k < 3; ++k) {
+                d = vmlaq_n_f32(d, p[k][h], c[k]);
+                d = vmlaq_n_f32(d, ap[k][h], e[k]);
+            }
+            outside = vorrq_u32(outside, vcltq_f32(d, vdupq_n_f32(0.f)));
+        }
+
+        const uint32x2_t folded = vorr_u32(vget_low_u32(outside), vget_high_u32(outside));
+        visible[i] = (vget_lane_u32(folded, 0) | vget_lane_u32(folded, 1)) ? 0 : 1;
+        count += visible[i];
+    }
+    return count;
+}
+
+#endif // SIMD_HAS_NEON
@@ -0,0 +1,344 @@
+#include "internal/gwr_sprite_batch.h"
+#include "internal/gwr_stream_buffer.h"
+#include "internal/gwr_element_buffer.h"
+#include "internal/gwr_mesh_opt.h"
+#include "internal/gwr_vertex_array.h"
+#include "internal/gwr_shader.h"
+#include "internal/gwr_sampler.h"
+#include "internal/gwr_log.h"
+#include "internal/gwr_cap.h"
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include <assert.h>
+
+#define SPRITE_LOG(level, msg, ...)    GWR_LOG_AT(GWR_LOG_SYS_SPRITE_BATCH, (level), msg, ##__VA_ARGS__)
+
+#define SPRITE_VERTS      4
+#define SPRITE_INDICES    6
+#define SPRITE_REGIONS    4
+#define SPRITE_MAX_CAPACITY (1 << 24)
+
+struct GWR_sprite_batch_t {
+    GWR_stream_buffer_t *vertices;
+    GWR_element_buffer_t *indices;
+    GWR_vertex_array_t *vao;
+    GWR_sampler_t *sampler;
+
+    GWR_shader_t *shader_2d;
+    GWR_shader_t *shader_array;
+    GLint proj_loc_2d;
+    GLint proj_loc_array;
+
+    GWR_vert_t *dst;        // current region, NULL until the first draw and once it fills
+    GLsizei capacity;
+    GLsizei count;          // sprites written to the region
+    GLsizei first;          // sprites of the region already drawn
+    const GWR_texture_t *texture;
+    bool begun;
+
+    GWR_sprite_batch_stats_t stats;
+};
+
+static const char *s_vertex_src =
+        "#version 460 core\n"
+        "layout (location = 0) in vec3 a_pos;\n"
+        "layout (location = 1) in vec3 a_color;\n"
+        "layout (location = 2) in vec2 a_tex_coord;\n"
+        "uniform mat4 u_proj;\n"
+        "out vec3 color;\n"
+        "out vec3 tex_coord;\n"
+        "void main() {\n"
+        "    gl_Position = u_proj * vec4(a_pos.xy, 0.0, 1.0);\n"
+        "    color = a_color;\n"
+        "    tex_coord = vec3(a_tex_coord, a_pos.z);\n"
+        "}\n";
+
+static const char *s_fragment_2d_src =
+        "#version 460 core\n"
+        "layout (binding = 0) uniform sampler2D u_texture;\n"
+        "in vec3 color;\n"
+        "in vec3 tex_coord;\n"
+        "out vec4 frag_color;\n"
+        "void main() {\n"
+        "    frag_color = texture(u_texture, tex_coord.xy) * vec4(color, 1.0);\n"
+        "}\n";
+
+static const char *s_fragment_array_src =
+        "#version 460 core\n"
+        "layout (binding = 0) uniform sampler2DArray u_texture;\n"
+        "in vec3 color;\n"
+        "in vec3 tex_coord;\n"
+        "out vec4 frag_color;\n"
+        "void main() {\n"
+        "    frag_color = texture(u_texture, tex_coord) * vec4(color, 1.0);\n"
+        "}\n";
+
+// inner funcs decls
+
+static GWR_element_buffer_t *create_quad_indices(GLsizei capacity);
+
+static void write_sprite(GWR_vert_t *dst, const GWR_sprite_t *sprite);
+
+static void bind_texture(const GWR_texture_t *texture);
+
+// public funcs defs
+
+GWR_sprite_batch_t *GWR_sprite_batch_create(GLsizei capacity) {
+    assert(capacity > 0 && capacity <= SPRITE_MAX_CAPACITY);
+
+    GWR_sprite_batch_t *batch = calloc(1, sizeof(GWR_sprite_batch_t));
+    if (!batch) {
+        SPRITE_LOG(GWR_LOG_ERROR, "failed to allocate GWR_sprite_batch_t");
+        return NULL;
+    }
+    batch->capacity = capacity;
+
+    batch->vertices = GWR_stream_buffer_create(sizeof(GWR_vert_t), capacity * SPRITE_VERTS, SPRITE_REGIONS);
+    if (!batch->vertices) {
+        goto fail;
+    }
+
+    batch->indices = create_quad_indices(capacity);
+    if (!batch->indices) {
+        goto fail;
+    }
+
+    batch->shader_2d = GWR_shader_create_src(s_vertex_src, s_fragment_2d_src);
+    batch->shader_array = GWR_shader_create_src(s_vertex_src, s_fragment_array_src);
+    if (!batch->shader_2d || !batch->shader_array) {
+        goto fail;
+    }
+    batch->proj_loc_2d = GWR_shader_get_uniform_loc(batch->shader_2d, "u_proj");
+    batch->proj_loc_array = GWR_shader_get_uniform_loc(batch->shader_array, "u_proj");
+
+    batch->vao = GWR_vertex_array_create();
+    if (!batch->vao) {
+        goto fail;
+    }
+    GWR_vertex_array_stream_attrib_pointerf(
+        batch->vao, batch->vertices,
+        0, 3, GL_FLOAT, GL_FALSE, (void *) offsetof(GWR_vert_t, pos)
+    );
+    GWR_vertex_array_stream_attrib_pointerf(
+        batch->vao, batch->vertices,
+        1, 3, GL_FLOAT, GL_FALSE, (void *) offsetof(GWR_vert_t, color)
+    );
+    GWR_vertex_array_stream_attrib_pointerf(
+        batch->vao, batch->vertices,
+        2, 2, GL_FLOAT, GL_FALSE, (void *) offsetof(GWR_vert_t, tex_coord)
+    );
+    GWR_vertex_array_set_element_buffer(batch->vao, batch->indices);
+
+    const GWR_sampler_desc_t sampler_desc = GWR_sampler_desc_default();
+    batch->sampler = GWR_sampler_create(&sampler_desc);
+    if (!batch->sampler) {
+        goto fail;
+    }
+
+    return batch;
+
+fail:
+    GWR_sprite_batch_destroy(batch);
+    return NULL;
+}
+
+void GWR_sprite_batch_destroy(GWR_sprite_batch_t *batch) {
+    assert(batch);
+
+    if (batch->sampler) {
+        GWR_sampler_destroy(batch->sampler);
+    }
+    if (batch->vao) {
+        GWR_vertex_array_destroy(batch->vao);
+    }
+    if (batch->shader_array) {
+        GWR_shader_destroy(batch->shader_array);
+    }
+    if (batch->shader_2d) {
+        GWR_shader_destroy(batch->shader_2d);
+    }
+    if (batch->indices) {
+        GWR_element_buffer_destroy(batch->indices);
+    }
+    if (batch->vertices) {
+        GWR_stream_buffer_destroy(batch->vertices);
+    }
+
+    free(batch);
+}
+
+void GWR_sprite_batch_begin(GWR_sprite_batch_t *batch, const float *proj) {
+    assert(batch);
+    assert(proj);
+    assert(!batch->begun);
+
+    GWR_shader_set_val_loc(batch->shader_2d, batch->proj_loc_2d, proj, GWR_SHADER_UNIFORM_MAT4);
+    GWR_shader_set_val_loc(batch->shader_array, batch->proj_loc_array, proj, GWR_SHADER_UNIFORM_MAT4);
+
+    memset(&batch->stats, 0, sizeof(batch->stats));
+    batch->texture = NULL;
+    batch->begun = true;
+}
+
+void GWR_sprite_batch_end(GWR_sprite_batch_t *batch) {
+    assert(batch);
+    assert(batch->begun);
+
+    GWR_sprite_batch_flush(batch);
+    batch->begun = false;
+}
+
+void GWR_sprite_batch_draw(GWR_sprite_batch_t *batch, const GWR_texture_t *texture, const GWR_sprite_t *sprite) {
+    GWR_sprite_batch_draw_n(batch, texture, sprite, 1);
+}
+
+void GWR_sprite_batch_draw_n(
+    GWR_sprite_batch_t *batch,
+    const GWR_texture_t *texture,
+    const GWR_sprite_t *sprites,
+    GLsizei n
+) {
+    assert(batch);
+    assert(batch->begun);
+    assert(texture);
+    assert(sprites || n == 0);
+
+    if (batch->texture != texture) {
+        if (batch->count > batch->first) {
+            GWR_sprite_batch_flush(batch);
+            ++batch->stats.texture_flushes;
+        }
+        batch->texture = texture;
+    }
+
+    while (n > 0) {
+        if (!batch->dst) {
+            batch->dst = GWR_stream_buffer_map(batch->vertices);
+        }
+
+        const GLsizei room = batch->capacity - batch->count;
+        const GLsizei chunk = n < room ? n : room;
+
+        GWR_vert_t *dst = batch->dst + (size_t) batch->count * SPRITE_VERTS;
+        for (GLsizei i = 0; i < chunk; ++i) {
+            write_sprite(dst + (size_t) i * SPRITE_VERTS, &sprites[i]);
+        }
+
+        batch->count += chunk;
+        sprites += chunk;
+        n -= chunk;
+
+        if (batch->count == batch->capacity) {
+            GWR_sprite_batch_flush(batch);
+        }
+    }
+}
+
+void GWR_sprite_batch_flush(GWR_sprite_batch_t *batch) {
+    assert(batch);
+
+    const GLsizei pending = batch->count - batch->first;
+    if (!pending) {
+        return;
+    }
+    assert(batch->dst);
+    assert(batch->texture);
+
+    // each flush draws the next piece of the region, so texture switches do
+    // not cycle the ring; only a full region moves on and may wait on a fence
+    const GLuint base = GWR_stream_buffer_get_base(batch->vertices) + (GLuint) batch->first * SPRITE_VERTS;
+    GWR_stream_buffer_unmap_range(batch->vertices, batch->first * SPRITE_VERTS, pending * SPRITE_VERTS);
+
+    const bool is_array = GWR_texture_get_target(batch->texture) == GL_TEXTURE_2D_ARRAY;
+    GWR_shader_use(is_array ? batch->shader_array : batch->shader_2d);
+    bind_texture(batch->texture);
+    GWR_sampler_bind(0, batch->sampler);
+
+    GWR_vertex_array_bind(batch->vao);
+    glDrawElementsBaseVertex(
+        GL_TRIANGLES, pending * SPRITE_INDICES, GWR_element_buffer_get_type(batch->indices), NULL, (GLint) base
+    );
+    GWR_vertex_array_unbind();
+
+    GWR_stream_buffer_fence(batch->vertices);
+
+    batch->stats.sprites += pending;
+    ++batch->stats.draw_calls;
+
+    batch->first = batch->count;
+    if (batch->count == batch->capacity) {
+        batch->dst = NULL;
+        batch->count = 0;
+        batch->first = 0;
+    }
+}
+
+GWR_sprite_batch_stats_t GWR_sprite_batch_get_stats(const GWR_sprite_batch_t *batch) {
+    assert(batch);
+
+    return batch->stats;
+}
+
+// inner funcs defs
+
+static GWR_element_buffer_t *create_quad_indices(GLsizei capacity) {
+    const size_t count = (size_t) capacity * SPRITE_INDICES;
+
+    GLuint *indices = malloc(count * sizeof(GLuint));
+    if (!indices) {
+        SPRITE_LOG(GWR_LOG_ERROR, "failed to allocate %zu indices", count);
+        return NULL;
+    }
+
+    for (GLuint i = 0; i < (GLuint) capacity; ++i) {
+        const GLuint v = i * SPRITE_VERTS;
+        GLuint *dst = indices + (size_t) i * SPRITE_INDICES;
+        dst[0] = v + 0;
+        dst[1] = v + 1;
+        dst[2] = v + 2;
+        dst[3] = v + 2;
+        dst[4] = v + 3;
+        dst[5] = v + 0;
+    }
+
+    // 16-bit indices whenever the batch is small enough
+    GWR_element_buffer_t *ebo = GWR_mesh_opt_create_element_buffer(
+        indices, count, (size_t) capacity * SPRITE_VERTS, GL_STATIC_DRAW
+    );
+    free(indices);
+    return ebo;
+}
+
+static void write_sprite(GWR_vert_t *dst, const GWR_sprite_t *sprite) {
+    const float x0 = sprite->x;
+    const float y0 = sprite->y;
+    const float x1 = sprite->x + sprite->w;
+    const float y1 = sprite->y + sprite->h;
+
+    const GWR_vert_t quad[SPRITE_VERTS] = {
+        {.pos = {x0, y0, sprite->layer}, .tex_coord = {sprite->uv[0], sprite->uv[1]}},
+        {.pos = {x1, y0, sprite->layer}, .tex_coord = {sprite->uv[2], sprite->uv[1]}},
+        {.pos = {x1, y1, sprite->layer}, .tex_coord = {sprite->uv[2], sprite->uv[3]}},
+        {.pos = {x0, y1, sprite->layer}, .tex_coord = {sprite->uv[0], sprite->uv[3]}},
+    };
+
+    for (int i = 0; i < SPRITE_VERTS; ++i) {
+        dst[i] = quad[i];
+        dst[i].color[0] = sprite->color[0];
+        dst[i].color[1] = sprite->color[1];
+        dst[i].color[2] = sprite->color[2];
+    }
+}
+
+static void bind_texture(const GWR_texture_t *texture) {
+    if (GWR_cap_has(GWR_FEATURE_DIRECT_STATE_ACCESS)) {
+        glBindTextureUnit(0, GWR_texture_get_id(texture));
+        return;
+    }
+
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GWR_texture_get_target(texture), GWR_texture_get_id(texture));
+}
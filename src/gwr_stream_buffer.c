@@ -0,0 +1,348 @@
+#include "internal/gwr_stream_buffer.h"
+#include "internal/gwr_log.h"
+#include "internal/gwr_cap.h"
+#include "internal/gwr_memory.h"
+#include "internal/gwr_trace.h"
+#include "internal/gwr_util.h"
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <assert.h>
+
+#define SB_LOG(level, msg, ...)    GWR_LOG_AT(GWR_LOG_SYS_STREAM_BUFFER, (level), msg, ##__VA_ARGS__)
+
+#define SB_WAIT_TIMEOUT_NS    1000000000ull
+
+struct GWR_stream_buffer_t {
+    GLuint id;
+    GLsizei stride;
+    GLsizei capacity;
+    GLsizei regions;
+    GLsizei region;         // current region, -1 before the first map
+    GLsizeiptr region_size;
+    void *ptr;              // persistent mapping or staging memory
+    GLsync *fences;
+    GWR_mem_tag_t mem_tag;
+};
+
+typedef bool (*sb_create)(GWR_stream_buffer_t *);
+typedef void *(*sb_map)(GWR_stream_buffer_t *);
+typedef void (*sb_unmap)(GWR_stream_buffer_t *, GLintptr, GLsizeiptr);
+typedef void (*sb_release)(GWR_stream_buffer_t *);
+typedef void (*sb_fence)(GWR_stream_buffer_t *);
+
+static sb_create s_sb_create = NULL;
+static sb_map s_sb_map = NULL;
+static sb_unmap s_sb_unmap = NULL;
+static sb_release s_sb_release = NULL;
+static sb_fence s_sb_fence = NULL;
+
+// inner funcs decls
+
+static void wait_region(GWR_stream_buffer_t *sb, GLsizei region);
+
+static bool backend_create_persistent(GWR_stream_buffer_t *sb);
+static void *backend_map_persistent(GWR_stream_buffer_t *sb);
+static void backend_unmap_persistent(GWR_stream_buffer_t *sb, GLintptr start, GLsizeiptr size);
+static void backend_release_persistent(GWR_stream_buffer_t *sb);
+static void backend_fence_persistent(GWR_stream_buffer_t *sb);
+
+static bool backend_create_staging(GWR_stream_buffer_t *sb);
+static void *backend_map_staging(GWR_stream_buffer_t *sb);
+static void backend_unmap_staging(GWR_stream_buffer_t *sb, GLintptr start, GLsizeiptr size);
+static void backend_release_staging(GWR_stream_buffer_t *sb);
+static void backend_fence_staging(GWR_stream_buffer_t *sb);
+
+static void sb_pick_backend(void);
+
+// public funcs defs
+
+GWR_stream_buffer_t *GWR_stream_buffer_create(GLsizei stride, GLsizei capacity, GLsizei regions) {
+    assert(stride > 0);
+    assert(capacity > 0);
+    assert(regions > 0);
+
+    sb_pick_backend();
+
+    GWR_stream_buffer_t *sb = malloc(sizeof(GWR_stream_buffer_t));
+    if (!sb) {
+        SB_LOG(GWR_LOG_ERROR, "failed to allocate GWR_stream_buffer_t");
+        return NULL;
+    }
+
+    sb->id = 0;
+    sb->stride = stride;
+    sb->capacity = capacity;
+    sb->regions = regions;
+    sb->region = -1;
+    sb->region_size = (GLsizeiptr) stride * capacity;
+    sb->ptr = NULL;
+    sb->fences = calloc(regions, sizeof(GLsync));
+    if (!sb->fences) {
+        SB_LOG(GWR_LOG_ERROR, "failed to allocate fences");
+        free(sb);
+        return NULL;
+    }
+
+    if (!s_sb_create(sb)) {
+        free(sb->fences);
+        free(sb);
+        return NULL;
+    }
+    sb->mem_tag = GWR_mem_record_alloc(GWR_MEM_STREAM_BUFFER, (int64_t) sb->region_size * regions);
+
+    return sb;
+}
+
+void GWR_stream_buffer_destroy(GWR_stream_buffer_t *sb) {
+    assert(sb);
+    assert(sb->id);
+
+    for (GLsizei i = 0; i < sb->regions; ++i) {
+        if (sb->fences[i]) {
+            glDeleteSync(sb->fences[i]);
+        }
+    }
+    free(sb->fences);
+
+    s_sb_release(sb);
+    GWR_mem_record_free(GWR_MEM_STREAM_BUFFER, sb->mem_tag, (int64_t) sb->region_size * sb->regions);
+
+    glDeleteBuffers(1, &sb->id);
+    sb->id = 0;
+
+    free(sb);
+}
+
+void *GWR_stream_buffer_map(GWR_stream_buffer_t *sb) {
+    assert(sb);
+    assert(sb->id);
+
+    sb->region = (sb->region + 1) % sb->regions;
+    wait_region(sb, sb->region);
+
+    return s_sb_map(sb);
+}
+
+void GWR_stream_buffer_unmap(GWR_stream_buffer_t *sb, GLsizei count) {
+    GWR_stream_buffer_unmap_range(sb, 0, count);
+}
+
+void GWR_stream_buffer_unmap_range(GWR_stream_buffer_t *sb, GLsizei first, GLsizei count) {
+    assert(sb);
+    assert(sb->region >= 0);
+    assert(first >= 0 && count >= 0 && first + count <= sb->capacity);
+
+    s_sb_unmap(sb, (GLintptr) first * sb->stride, (GLsizeiptr) count * sb->stride);
+}
+
+void GWR_stream_buffer_fence(GWR_stream_buffer_t *sb) {
+    assert(sb);
+    assert(sb->region >= 0);
+
+    s_sb_fence(sb);
+}
+
+GLuint GWR_stream_buffer_get_id(const GWR_stream_buffer_t *sb) {
+    assert(sb);
+    assert(sb->id);
+
+    return sb->id;
+}
+
+GLuint GWR_stream_buffer_get_base(const GWR_stream_buffer_t *sb) {
+    assert(sb);
+
+    return sb->region < 0 ? 0 : (GLuint) sb->region * (GLuint) sb->capacity;
+}
+
+GLintptr GWR_stream_buffer_get_offset(const GWR_stream_buffer_t *sb) {
+    assert(sb);
+
+    return sb->region < 0 ? 0 : (GLintptr) sb->region * sb->region_size;
+}
+
+GLsizei GWR_stream_buffer_get_stride(const GWR_stream_buffer_t *sb) {
+    assert(sb);
+
+    return sb->stride;
+}
+
+GLsizei GWR_stream_buffer_get_capacity(const GWR_stream_buffer_t *sb) {
+    assert(sb);
+
+    return sb->capacity;
+}
+
+GLsizeiptr GWR_stream_buffer_get_size(const GWR_stream_buffer_t *sb) {
+    assert(sb);
+
+    return sb->region_size * sb->regions;
+}
+
+// inner funcs defs
+
+static void wait_region(GWR_stream_buffer_t *sb, GLsizei region) {
+    GLsync fence = sb->fences[region];
+    if (!fence) {
+        return;
+    }
+
+    GLbitfield flags = 0;
+    for (;;) {
+        const GLenum res = glClientWaitSync(fence, flags, SB_WAIT_TIMEOUT_NS);
+        if (res == GL_ALREADY_SIGNALED || res == GL_CONDITION_SATISFIED) {
+            break;
+        }
+        if (res == GL_WAIT_FAILED) {
+            SB_LOG(GWR_LOG_ERROR, "glClientWaitSync failed");
+            break;
+        }
+        flags = GL_SYNC_FLUSH_COMMANDS_BIT;
+    }
+
+    glDeleteSync(fence);
+    sb->fences[region] = NULL;
+}
+
+static bool backend_create_persistent(GWR_stream_buffer_t *sb) {
+    assert(sb);
+
+    const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+    const GLsizeiptr size = sb->region_size * sb->regions;
+
+    glCreateBuffers(1, &sb->id);
+    if (!sb->id) {
+        SB_LOG(GWR_LOG_ERROR, "glCreateBuffers returned 0");
+        return false;
+    }
+    glNamedBufferStorage(sb->id, size, NULL, flags);
+
+    sb->ptr = glMapNamedBufferRange(sb->id, 0, size, flags);
+    if (!sb->ptr) {
+        SB_LOG(GWR_LOG_ERROR, "failed to persistently map %td bytes", size);
+        glDeleteBuffers(1, &sb->id);
+        sb->id = 0;
+        return false;
+    }
+    return true;
+}
+
+static void *backend_map_persistent(GWR_stream_buffer_t *sb) {
+    assert(sb);
+
+    return (uint8_t *) sb->ptr + GWR_stream_buffer_get_offset(sb);
+}
+
+static void backend_unmap_persistent(GWR_stream_buffer_t *sb, GLintptr start, GLsizeiptr size) {
+    assert(sb);
+
+    // coherent mapping: writes are visible to commands issued after this point,
+    // but a trace only sees them when told
+    if (GWR_trace_is_active()) {
+        const GLintptr offset = GWR_stream_buffer_get_offset(sb) + start;
+        GWR_trace_buffer_write(sb->id, offset, size, (const uint8_t *) sb->ptr + offset);
+    }
+}
+
+static void backend_release_persistent(GWR_stream_buffer_t *sb) {
+    assert(sb);
+
+    glUnmapNamedBuffer(sb->id);
+    sb->ptr = NULL;
+}
+
+static void backend_fence_persistent(GWR_stream_buffer_t *sb) {
+    assert(sb);
+
+    GLsync *fence = &sb->fences[sb->region];
+    if (*fence) {
+        glDeleteSync(*fence);
+    }
+    *fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
+
+static bool backend_create_staging(GWR_stream_buffer_t *sb) {
+    assert(sb);
+
+    const GLsizeiptr size = sb->region_size * sb->regions;
+
+    sb->ptr = malloc(sb->region_size);
+    if (!sb->ptr) {
+        SB_LOG(GWR_LOG_ERROR, "failed to allocate %td bytes of staging memory", sb->region_size);
+        return false;
+    }
+
+    glGenBuffers(1, &sb->id);
+    if (!sb->id) {
+        SB_LOG(GWR_LOG_ERROR, "glGenBuffers failed");
+        free(sb->ptr);
+        sb->ptr = NULL;
+        return false;
+    }
+
+    GLint prev = 0;
+    glGetIntegerv(GL_ARRAY_BUFFER_BINDING, &prev);
+
+    glBindBuffer(GL_ARRAY_BUFFER, sb->id);
+    glBufferData(GL_ARRAY_BUFFER, size, NULL, GL_STREAM_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, prev);
+
+    return true;
+}
+
+static void *backend_map_staging(GWR_stream_buffer_t *sb) {
+    assert(sb);
+
+    return sb->ptr;
+}
+
+static void backend_unmap_staging(GWR_stream_buffer_t *sb, GLintptr start, GLsizeiptr size) {
+    assert(sb);
+
+    if (!size) {
+        return;
+    }
+
+    GLint prev = 0;
+    glGetIntegerv(GL_ARRAY_BUFFER_BINDING, &prev);
+
+    glBindBuffer(GL_ARRAY_BUFFER, sb->id);
+    glBufferSubData(GL_ARRAY_BUFFER, GWR_stream_buffer_get_offset(sb) + start, size, (const uint8_t *) sb->ptr + start);
+    glBindBuffer(GL_ARRAY_BUFFER, prev);
+}
+
+static void backend_release_staging(GWR_stream_buffer_t *sb) {
+    assert(sb);
+
+    free(sb->ptr);
+    sb->ptr = NULL;
+}
+
+static void backend_fence_staging(GWR_stream_buffer_t *sb) {
+    (void) sb;
+
+    // glBufferSubData copies out of the staging memory and the driver orders
+    // it after earlier reads of the range, so there is nothing to wait for
+    // and map never blocks on this backend
+}
+
+static void sb_pick_backend(void) {
+    if (s_sb_create && s_sb_map && s_sb_unmap && s_sb_release && s_sb_fence) {
+        return;
+    }
+
+    if (!GWR_cap_is_init()) {
+        SB_LOG(GWR_LOG_ERROR, "cap not initialized; call GWR_cap_init() first");
+        return;
+    }
+
+    const bool persistent = GWR_cap_has(GWR_FEATURE_BUFFER_STORAGE) && GWR_cap_has(GWR_FEATURE_DIRECT_STATE_ACCESS);
+
+    s_sb_create = persistent ? backend_create_persistent : backend_create_staging;
+    s_sb_map = persistent ? backend_map_persistent : backend_map_staging;
+    s_sb_unmap = persistent ? backend_unmap_persistent : backend_unmap_staging;
+    s_sb_release = persistent ? backend_release_persistent : backend_release_staging;
+    s_sb_fence = persistent ? backend_fence_persistent : backend_fence_staging;
+}
@@ -1,35 +1,127 @@
 #include "internal/gwr_texture.h"
 #include "internal/gwr_log.h"
+#include "internal/gwr_cap.h"
+#include "internal/gwr_debug.h"
+#include "internal/gwr_memory.h"
+#include "internal/gwr_vfs.h"
 
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdbool.h>
+#include <limits.h>
 #include <assert.h>
 
 #define STB_IMAGE_IMPLEMENTATION
 #include "stb_image.h"
 
-#define TEXTURE_LOG(level, msg, ...)    GWR_log((level), "[TEXTURE]: " msg, ##__VA_ARGS__)
+#define TEXTURE_LOG(level, msg, ...)    GWR_LOG_AT(GWR_LOG_SYS_TEXTURE, (level), msg, ##__VA_ARGS__)
 
 struct GWR_texture_t {
     GLuint id;
+    GLenum target;
     GLsizei width;
     GLsizei height;
+    GLsizei layers;
+    GLsizei samples;
+    GLenum format;
+    GWR_mem_category_e mem_category;
+    GWR_mem_tag_t mem_tag;
+    int64_t mem_size;
 };
 
-static void set_default_params(void);
-
 static bool choose_formats(int channels, GLenum *internal_format, GLenum *format);
 
 static GLuint create_gl_texture_from_pixels(int width, int height, int channels, const unsigned char *pixels);
 
-static GLuint texture_load(const char *path, int *w, int *h);
+static GLuint texture_load(const char *path, int *w, int *h, GLenum *internal_format);
+
+static unsigned char *decode_image(const char *path, int *w, int *h, int *channels, int desired_channels);
+
+static GLuint texture_load_array(const char *const *paths, GLsizei count, int *w, int *h);
+
+static GLuint texture_create_storage(GLenum target, GLenum internal_format, GLsizei width, GLsizei height,
+                                     GLsizei levels, GLsizei samples);
 
 GWR_texture_t *GWR_texture_load(const char *path) {
     assert(path);
 
     GLsizei width, height;
-    const GLuint id = texture_load(path, &width, &height);
+    GLenum format = GL_NONE;
+    const GLuint id = texture_load(path, &width, &height, &format);
+    if (!id) {
+        return NULL;
+    }
+
+    GWR_texture_t *tex = malloc(sizeof(GWR_texture_t));
+    if (!tex) {
+        glDeleteTextures(1, &id);
+        return NULL;
+    }
+    GWR_debug_label(GL_TEXTURE, id, "texture '%s'", path);
+    tex->id = id;
+    tex->target = GL_TEXTURE_2D;
+    tex->width = width;
+    tex->height = height;
+    tex->layers = 1;
+    tex->samples = 1;
+    tex->format = format;
+    // glGenerateMipmap made the full chain
+    tex->mem_category = GWR_MEM_TEXTURE;
+    tex->mem_size = GWR_mem_texture_size(format, width, height, 1, 0, 1);
+    tex->mem_tag = GWR_mem_record_alloc(tex->mem_category, tex->mem_size);
+    return tex;
+}
+
+GWR_texture_t *GWR_texture_load_array(const char *const *paths, GLsizei count) {
+    assert(paths);
+    assert(count > 0);
+
+    const int64_t max_layers = GWR_cap_get_limit(GWR_LIMIT_MAX_ARRAY_TEXTURE_LAYERS);
+    if (max_layers > 0 && count > max_layers) {
+        TEXTURE_LOG(GWR_LOG_ERROR, "%d layers exceed GL_MAX_ARRAY_TEXTURE_LAYERS (%lld)", count, (long long) max_layers);
+        return NULL;
+    }
+
+    GLsizei width, height;
+    const GLuint id = texture_load_array(paths, count, &width, &height);
+    if (!id) {
+        return NULL;
+    }
+
+    GWR_texture_t *tex = malloc(sizeof(GWR_texture_t));
+    if (!tex) {
+        glDeleteTextures(1, &id);
+        return NULL;
+    }
+    GWR_debug_label(GL_TEXTURE, id, "texture array '%s' (+%d)", paths[0], count - 1);
+    tex->id = id;
+    tex->target = GL_TEXTURE_2D_ARRAY;
+    tex->width = width;
+    tex->height = height;
+    tex->layers = count;
+    tex->samples = 1;
+    tex->format = GL_RGBA8;
+    tex->mem_category = GWR_MEM_TEXTURE;
+    tex->mem_size = GWR_mem_texture_size(GL_RGBA8, width, height, count, 0, 1);
+    tex->mem_tag = GWR_mem_record_alloc(tex->mem_category, tex->mem_size);
+    return tex;
+}
+
+GWR_texture_t *GWR_texture_create(GLenum internal_format, GLsizei width, GLsizei height, GLsizei levels, GLsizei samples) {
+    assert(width > 0);
+    assert(height > 0);
+
+    const int64_t max_size = GWR_cap_get_limit(GWR_LIMIT_MAX_TEXTURE_SIZE);
+    if (max_size > 0 && (width > max_size || height > max_size)) {
+        TEXTURE_LOG(GWR_LOG_ERROR, "%dx%d exceeds GL_MAX_TEXTURE_SIZE (%lld)", width, height, (long long) max_size);
+        return NULL;
+    }
+
+    samples = samples > 1 ? samples : 1;
+    levels = samples > 1 || levels < 1 ? 1 : levels;
+    const GLenum target = samples > 1 ? GL_TEXTURE_2D_MULTISAMPLE : GL_TEXTURE_2D;
+
+    const GLuint id = texture_create_storage(target, internal_format, width, height, levels, samples);
     if (!id) {
         return NULL;
     }
@@ -40,8 +132,15 @@ GWR_texture_t *GWR_texture_load(const char *path) {
         return NULL;
     }
     tex->id = id;
+    tex->target = target;
     tex->width = width;
     tex->height = height;
+    tex->layers = 1;
+    tex->samples = samples;
+    tex->format = internal_format;
+    tex->mem_category = GWR_MEM_RENDER_TARGET;
+    tex->mem_size = GWR_mem_texture_size(internal_format, width, height, 1, levels, samples);
+    tex->mem_tag = GWR_mem_record_alloc(tex->mem_category, tex->mem_size);
     return tex;
 }
 
@@ -49,6 +148,8 @@ void GWR_texture_destroy(GWR_texture_t *texture) {
     assert(texture);
     assert(texture->id);
 
+    GWR_mem_record_free(texture->mem_category, texture->mem_tag, texture->mem_size);
+
     glDeleteTextures(1, &texture->id);
     texture->id = 0;
 
@@ -73,12 +174,55 @@ GLsizei GWR_texture_get_height(const GWR_texture_t *texture) {
     return texture->height;
 }
 
-static void set_default_params(void) {
-    // repeat + trilinear (with mipmaps)
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+GLsizei GWR_texture_get_layers(const GWR_texture_t *texture) {
+    assert(texture);
+
+    return texture->layers;
+}
+
+GLenum GWR_texture_get_target(const GWR_texture_t *texture) {
+    assert(texture);
+
+    return texture->target;
+}
+
+GLenum GWR_texture_get_format(const GWR_texture_t *texture) {
+    assert(texture);
+
+    return texture->format;
+}
+
+GLsizei GWR_texture_get_samples(const GWR_texture_t *texture) {
+    assert(texture);
+
+    return texture->samples;
+}
+
+int64_t GWR_texture_get_memory_size(const GWR_texture_t *texture) {
+    assert(texture);
+
+    return texture->mem_size;
+}
+
+GLsizeiptr GWR_texture_format_bytes(GLenum internal_format) {
+    switch (internal_format) {
+        case GL_R8:
+        case GL_STENCIL_INDEX8:
+            return 1;
+        case GL_RG8:
+        case GL_R16F:
+        case GL_DEPTH_COMPONENT16:
+            return 2;
+        case GL_RGBA16F:
+        case GL_RG32F:
+        case GL_DEPTH32F_STENCIL8:
+            return 8;
+        case GL_RGBA32F:
+            return 16;
+        default:
+            // RGBA8, SRGB8_ALPHA8, RGB10_A2, R11F_G11F_B10F, RG16F, R32F, DEPTH24_STENCIL8, ...
+            return 4;
+    }
 }
 
 static bool choose_formats(int channels, GLenum *internal_format, GLenum *format) {
@@ -118,7 +262,6 @@ static GLuint create_gl_texture_from_pixels(int width, int height, int channels,
     }
 
     glBindTexture(GL_TEXTURE_2D, texture_id);
-    set_default_params();
 
     // Ensure tight rows for arbitrary widths
     GLint prev_unpack = 0;
@@ -138,19 +281,159 @@ static GLuint create_gl_texture_from_pixels(int width, int height, int channels,
     return texture_id;
 }
 
-static GLuint texture_load(const char *path, int *w, int *h) {
+static GLuint texture_load(const char *path, int *w, int *h, GLenum *internal_format) {
     assert(path);
 
     int width = 0, height = 0, channels = 0;
-    stbi_set_flip_vertically_on_load(GL_TRUE);
-    unsigned char *data = stbi_load(path, &width, &height, &channels, 0);
+    // per thread: the resource cache decodes on several loader threads at once
+    stbi_set_flip_vertically_on_load_thread(GL_TRUE);
+    unsigned char *data = decode_image(path, &width, &height, &channels, 0);
     if (!data) {
         TEXTURE_LOG(GWR_LOG_ERROR, "failed to load image '%s'", path);
         return 0;
     }
     const GLuint id = create_gl_texture_from_pixels(width, height, channels, data);
+    GLenum format = GL_NONE;
+    choose_formats(channels, internal_format, &format);
     *w = width;
     *h = height;
     stbi_image_free(data);
     return id;
 }
+
+static GLuint texture_load_array(const char *const *paths, GLsizei count, int *w, int *h) {
+    assert(paths);
+    assert(count > 0);
+
+    GLuint texture_id = 0;
+    int width = 0, height = 0;
+
+    stbi_set_flip_vertically_on_load_thread(GL_TRUE);
+
+    GLint prev_unpack = 0;
+    glGetIntegerv(GL_UNPACK_ALIGNMENT, &prev_unpack);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+    for (GLsizei i = 0; i < count; ++i) {
+        assert(paths[i]);
+
+        int lw = 0, lh = 0, channels = 0;
+        unsigned char *data = decode_image(paths[i], &lw, &lh, &channels, 4);
+        if (!data) {
+            TEXTURE_LOG(GWR_LOG_ERROR, "failed to load image '%s'", paths[i]);
+            goto fail;
+        }
+
+        if (i == 0) {
+            width = lw;
+            height = lh;
+
+            glGenTextures(1, &texture_id);
+            if (!texture_id) {
+                stbi_image_free(data);
+                goto fail;
+            }
+            glBindTexture(GL_TEXTURE_2D_ARRAY, texture_id);
+            glTexImage3D(
+                GL_TEXTURE_2D_ARRAY, 0, GL_RGBA8, width, height, count,
+                0, GL_RGBA, GL_UNSIGNED_BYTE, NULL
+            );
+        } else if (lw != width || lh != height) {
+            TEXTURE_LOG(
+                GWR_LOG_ERROR, "layer '%s' is %dx%d, expected %dx%d",
+                paths[i], lw, lh, width, height
+            );
+            stbi_image_free(data);
+            goto fail;
+        }
+
+        glTexSubImage3D(
+            GL_TEXTURE_2D_ARRAY, 0, 0, 0, i, width, height, 1,
+            GL_RGBA, GL_UNSIGNED_BYTE, data
+        );
+        stbi_image_free(data);
+    }
+
+    glGenerateMipmap(GL_TEXTURE_2D_ARRAY);
+
+    glPixelStorei(GL_UNPACK_ALIGNMENT, prev_unpack);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+
+    *w = width;
+    *h = height;
+    return texture_id;
+
+fail:
+    glPixelStorei(GL_UNPACK_ALIGNMENT, prev_unpack);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+    if (texture_id) {
+        glDeleteTextures(1, &texture_id);
+    }
+    return 0;
+}
+
+static GLuint texture_create_storage(GLenum target, GLenum internal_format, GLsizei width, GLsizei height,
+                                     GLsizei levels, GLsizei samples) {
+    // render targets: clamp + linear, no mipmaps unless asked for; a bound
+    // sampler overrides these, they cover passes that sample without one
+    const GLint min_filter = levels > 1 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR;
+    GLuint texture_id = 0;
+
+    if (GWR_cap_has(GWR_FEATURE_DIRECT_STATE_ACCESS)) {
+        glCreateTextures(target, 1, &texture_id);
+        if (!texture_id) {
+            TEXTURE_LOG(GWR_LOG_ERROR, "glCreateTextures returned 0");
+            return 0;
+        }
+        if (samples > 1) {
+            glTextureStorage2DMultisample(texture_id, samples, internal_format, width, height, GL_TRUE);
+        } else {
+            glTextureStorage2D(texture_id, levels, internal_format, width, height);
+            glTextureParameteri(texture_id, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+            glTextureParameteri(texture_id, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+            glTextureParameteri(texture_id, GL_TEXTURE_MIN_FILTER, min_filter);
+            glTextureParameteri(texture_id, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        }
+        return texture_id;
+    }
+
+    if (!GWR_cap_has(GWR_FEATURE_TEXTURE_STORAGE)) {
+        TEXTURE_LOG(GWR_LOG_ERROR, "immutable texture storage is not supported");
+        return 0;
+    }
+
+    glGenTextures(1, &texture_id);
+    if (!texture_id) {
+        return 0;
+    }
+
+    glBindTexture(target, texture_id);
+    if (samples > 1) {
+        glTexStorage2DMultisample(target, samples, internal_format, width, height, GL_TRUE);
+    } else {
+        glTexStorage2D(target, levels, internal_format, width, height);
+        glTexParameteri(target, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(target, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexParameteri(target, GL_TEXTURE_MIN_FILTER, min_filter);
+        glTexParameteri(target, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    }
+    glBindTexture(target, 0);
+
+    return texture_id;
+}
+
+// reads through the VFS so images inside mounted archives decode from the mapping
+static unsigned char *decode_image(const char *path, int *w, int *h, int *channels, int desired_channels) {
+    GWR_vfs_file_t file;
+    if (!GWR_vfs_open(path, &file)) {
+        return NULL;
+    }
+
+    unsigned char *data = NULL;
+    if (file.size <= INT_MAX) {
+        data = stbi_load_from_memory(file.data, (int) file.size, w, h, channels, desired_channels);
+    }
+    GWR_vfs_close(&file);
+
+    return data;
+}
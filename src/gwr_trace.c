@@ -0,0 +1,1059 @@
+#include "internal/gwr_trace.h"
+#include "internal/gwr_trace_format.h"
+#include "internal/gwr_log.h"
+#include "internal/gwr_util.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+#include <assert.h>
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+
+#define TRACE_LOG(level, msg, ...)    GWR_LOG_AT(GWR_LOG_SYS_TRACE, (level), msg, ##__VA_ARGS__)
+
+#define TRACE_FILE_BUFFER_SIZE  (1u << 20)
+#define TRACE_MAX_MAPS          64
+#define TRACE_COMPARE_CHUNK     (1u << 16)
+// a blob record's size field also counts its hash
+#define TRACE_MAX_BLOB          ((uint64_t) UINT32_MAX - sizeof(uint64_t))
+
+// a blob already in the file; replay keeps the latest blob of each hash
+typedef struct {
+    uint64_t hash;          // 0 marks a free slot
+    uint64_t offset;        // of the payload bytes in the file
+    uint64_t size;
+} seen_t;
+
+typedef struct {
+    GLuint buffer;
+    GLintptr offset;
+    GLsizeiptr length;
+    GLbitfield access;
+    void *ptr;
+} map_t;
+
+// everything below is guarded by s_lock; wrappers hold it across the real
+// call so records land in execution order
+static pthread_mutex_t s_lock = PTHREAD_MUTEX_INITIALIZER;
+static atomic_bool s_active = false;
+static FILE *s_file = NULL;
+static bool s_failed = false;
+static uint64_t s_start_ns = 0;
+static GWR_trace_stats_t s_stats = {0};
+
+// arguments of the record being built
+static GWR_trace_record_t s_rec = {0};
+static unsigned char *s_args = NULL;
+static size_t s_args_size = 0;
+static size_t s_args_cap = 0;
+
+// concatenated shader sources
+static char *s_scratch = NULL;
+static size_t s_scratch_cap = 0;
+
+// open addressing over blob hashes already in the file
+static seen_t *s_seen = NULL;
+static size_t s_seen_cap = 0;
+static size_t s_seen_count = 0;
+// file bytes known to have left the stdio buffer, so pread() sees them
+static uint64_t s_flushed = 0;
+static unsigned char *s_compare = NULL;
+
+static map_t s_maps[TRACE_MAX_MAPS];
+static int s_map_count = 0;
+
+// inner funcs decls
+
+static uint64_t call_enter(void);
+static void call_leave(void);
+static void rec_begin(uint16_t call, uint64_t t0);
+static void write_raw(const void *data, size_t size);
+
+static void put_bytes(const void *data, size_t size);
+static void put_u32(uint32_t v);
+static void put_u64(uint64_t v);
+static void put_f32(GLfloat v);
+static void put_blob(const void *data, uint64_t size);
+static void put_unpack(GLsizei w, GLsizei h, GLsizei d, GLenum format, GLenum type, const void *pixels);
+static void put_pack(const void *pixels);
+static uint64_t array_bytes(GLsizei n, size_t elem);
+
+static uint64_t hash_bytes(const void *data, size_t size);
+static seen_t *seen_slot(uint64_t hash);
+static bool blob_matches(const seen_t *seen, const void *data, uint64_t size);
+
+static GLuint bound_buffer(GLenum target);
+static void map_add(GLuint buffer, GLintptr offset, GLsizeiptr length, GLbitfield access, void *ptr);
+static void map_remove(GLuint buffer);
+static void emit_buffer_write(GLuint buffer, GLintptr offset, GLsizeiptr size, const void *data);
+static void flush_map(GLuint buffer);
+
+static void install_wrappers(void);
+static void restore_wrappers(void);
+
+// public funcs defs
+
+bool GWR_trace_begin(const char *path) {
+    assert(path);
+
+    if (!glad_glGetIntegerv || !glGetString(GL_VERSION)) {
+        TRACE_LOG(GWR_LOG_ERROR, "tracing needs a current GL context");
+        return false;
+    }
+
+    pthread_mutex_lock(&s_lock);
+
+    if (s_file) {
+        pthread_mutex_unlock(&s_lock);
+        TRACE_LOG(GWR_LOG_WARNING, "a trace is already being written");
+        return false;
+    }
+
+    // read as well, so repeated payloads can be checked against their first copy
+    FILE *file = fopen(path, "w+b");
+    if (!file) {
+        pthread_mutex_unlock(&s_lock);
+        TRACE_LOG(GWR_LOG_ERROR, "failed to create '%s'", path);
+        return false;
+    }
+    setvbuf(file, NULL, _IOFBF, TRACE_FILE_BUFFER_SIZE);
+
+    GLint viewport[4] = {0};
+    GWR_trace_header_t header = {
+        .magic = GWR_TRACE_MAGIC,
+        .version = GWR_TRACE_VERSION,
+    };
+    glGetIntegerv(GL_MAJOR_VERSION, &header.gl_major);
+    glGetIntegerv(GL_MINOR_VERSION, &header.gl_minor);
+    glGetIntegerv(GL_VIEWPORT, viewport);
+    header.width = viewport[2];
+    header.height = viewport[3];
+
+    s_file = file;
+    s_failed = false;
+    s_start_ns = GWR_now_ns();
+    memset(&s_stats, 0, sizeof(s_stats));
+    if (s_seen) {
+        memset(s_seen, 0, s_seen_cap * sizeof(seen_t));
+    }
+    s_seen_count = 0;
+    s_flushed = 0;
+    s_map_count = 0;
+
+    write_raw(&header, sizeof(header));
+    install_wrappers();
+    atomic_store(&s_active, true);
+
+    pthread_mutex_unlock(&s_lock);
+
+    TRACE_LOG(GWR_LOG_INFO, "tracing GL %d.%d to '%s'", header.gl_major, header.gl_minor, path);
+    return true;
+}
+
+void GWR_trace_end(void) {
+    pthread_mutex_lock(&s_lock);
+
+    if (!s_file) {
+        pthread_mutex_unlock(&s_lock);
+        return;
+    }
+
+    restore_wrappers();
+    atomic_store(&s_active, false);
+
+    if (fclose(s_file) != 0) {
+        s_failed = true;
+    }
+    s_file = NULL;
+    const GWR_trace_stats_t stats = s_stats;
+    const bool failed = s_failed;
+
+    free(s_args);
+    s_args = NULL;
+    s_args_size = s_args_cap = 0;
+    free(s_scratch);
+    s_scratch = NULL;
+    s_scratch_cap = 0;
+    free(s_seen);
+    s_seen = NULL;
+    s_seen_cap = s_seen_count = 0;
+    free(s_compare);
+    s_compare = NULL;
+
+    pthread_mutex_unlock(&s_lock);
+
+    if (failed) {
+        TRACE_LOG(GWR_LOG_ERROR, "trace is incomplete: a write failed");
+    }
+    TRACE_LOG(
+        GWR_LOG_INFO, "trace done: %llu calls, %llu frames, %llu bytes (payload %llu, stored %llu)",
+        (unsigned long long) stats.calls, (unsigned long long) stats.frames,
+        (unsigned long long) stats.file_bytes, (unsigned long long) stats.payload_bytes,
+        (unsigned long long) stats.stored_bytes
+    );
+}
+
+bool GWR_trace_is_active(void) {
+    return atomic_load(&s_active);
+}
+
+void GWR_trace_frame(void) {
+    if (!GWR_trace_is_active()) {
+        return;
+    }
+
+    const uint64_t t0 = call_enter();
+    rec_begin(GWR_TRACE_FRAME, t0);
+    s_rec.duration_ns = 0;
+    put_u64(s_stats.frames++);
+    put_u64(t0 - s_start_ns);
+    call_leave();
+}
+
+void GWR_trace_marker(const char *text) {
+    assert(text);
+
+    if (!GWR_trace_is_active()) {
+        return;
+    }
+
+    const uint64_t t0 = call_enter();
+    rec_begin(GWR_TRACE_MARKER, t0);
+    s_rec.duration_ns = 0;
+    put_blob(text, strlen(text));
+    call_leave();
+}
+
+void GWR_trace_buffer_write(GLuint buffer, GLintptr offset, GLsizeiptr size, const void *data) {
+    assert(data || size == 0);
+
+    if (!GWR_trace_is_active() || size <= 0) {
+        return;
+    }
+
+    pthread_mutex_lock(&s_lock);
+    emit_buffer_write(buffer, offset, size, data);
+    pthread_mutex_unlock(&s_lock);
+}
+
+GWR_trace_stats_t GWR_trace_get_stats(void) {
+    pthread_mutex_lock(&s_lock);
+    const GWR_trace_stats_t stats = s_stats;
+    pthread_mutex_unlock(&s_lock);
+    return stats;
+}
+
+// inner funcs defs
+
+static uint64_t call_enter(void) {
+    pthread_mutex_lock(&s_lock);
+    return GWR_now_ns();
+}
+
+// writes the record built since rec_begin() and releases the lock
+static void call_leave(void) {
+    if (s_file && !s_failed) {
+        s_rec.size = (uint32_t) s_args_size;
+        write_raw(&s_rec, sizeof(s_rec));
+        write_raw(s_args, s_args_size);
+        if (s_rec.call >= GWR_TRACE_FIRST_CALL) {
+            ++s_stats.calls;
+        }
+    }
+    pthread_mutex_unlock(&s_lock);
+}
+
+static void rec_begin(uint16_t call, uint64_t t0) {
+    const uint64_t dt = GWR_now_ns() - t0;
+    s_rec.call = call;
+    s_rec.flags = 0;
+    s_rec.duration_ns = dt > UINT32_MAX ? UINT32_MAX : (uint32_t) dt;
+    s_args_size = 0;
+}
+
+static void write_raw(const void *data, size_t size) {
+    if (!s_file || s_failed || size == 0) {
+        return;
+    }
+    if (fwrite(data, 1, size, s_file) != size) {
+        s_failed = true;
+        return;
+    }
+    s_stats.file_bytes += size;
+}
+
+static void put_bytes(const void *data, size_t size) {
+    if (s_args_size + size > s_args_cap) {
+        size_t cap = s_args_cap ? s_args_cap : 256;
+        while (cap < s_args_size + size) {
+            cap *= 2;
+        }
+        unsigned char *args = realloc(s_args, cap);
+        if (!args) {
+            s_failed = true;
+            return;
+        }
+        s_args = args;
+        s_args_cap = cap;
+    }
+    memcpy(s_args + s_args_size, data, size);
+    s_args_size += size;
+}
+
+static void put_u32(uint32_t v) {
+    put_bytes(&v, sizeof(v));
+}
+
+static void put_u64(uint64_t v) {
+    put_bytes(&v, sizeof(v));
+}
+
+static void put_f32(GLfloat v) {
+    put_bytes(&v, sizeof(v));
+}
+
+// writes the bytes ahead of the current record unless the last blob written
+// under the same hash holds the same bytes
+static void put_blob(const void *data, uint64_t size) {
+    if (!data) {
+        put_u64(0);
+        put_u64(GWR_TRACE_NULL_BLOB);
+        return;
+    }
+    if (size > TRACE_MAX_BLOB) {
+        TRACE_LOG(GWR_LOG_WARNING, "%llu byte payload is too large to trace; recorded as NULL", (unsigned long long) size);
+        put_u64(0);
+        put_u64(GWR_TRACE_NULL_BLOB);
+        return;
+    }
+
+    const uint64_t hash = size ? hash_bytes(data, (size_t) size) : 0;
+    s_stats.payload_bytes += size;
+    seen_t *seen = size ? seen_slot(hash) : NULL;
+    if (size && (!seen || !seen->hash || !blob_matches(seen, data, size))) {
+        // a colliding payload is written under the same hash and replaces
+        // the older one on replay until that is referenced again
+        const GWR_trace_record_t rec = {
+            .call = GWR_TRACE_BLOB,
+            .size = (uint32_t) (sizeof(uint64_t) + size),
+        };
+        write_raw(&rec, sizeof(rec));
+        write_raw(&hash, sizeof(hash));
+        const uint64_t offset = s_stats.file_bytes;
+        write_raw(data, (size_t) size);
+        s_stats.stored_bytes += size;
+        if (seen) {
+            s_seen_count += !seen->hash;
+            *seen = (seen_t) {hash, offset, size};
+        }
+    }
+    put_u64(hash);
+    put_u64(size);
+}
+
+// pixels are an offset into the unpack buffer if one is bound, client memory otherwise
+static void put_unpack(GLsizei w, GLsizei h, GLsizei d, GLenum format, GLenum type, const void *pixels) {
+    GLint pbo = 0;
+    glGetIntegerv(GL_PIXEL_UNPACK_BUFFER_BINDING, &pbo);
+    put_u32(pbo != 0);
+    if (pbo) {
+        put_u64((uint64_t) (uintptr_t) pixels);
+        return;
+    }
+
+    GLint row_length = 0, alignment = 4;
+    glGetIntegerv(GL_UNPACK_ROW_LENGTH, &row_length);
+    glGetIntegerv(GL_UNPACK_ALIGNMENT, &alignment);
+    const uint64_t size = GWR_trace_image_bytes(w, h, d, format, type, row_length, alignment);
+    if (pixels && !size) {
+        TRACE_LOG(GWR_LOG_WARNING, "unknown pixel format 0x%04x/0x%04x; upload recorded as NULL", format, type);
+        pixels = NULL;
+    }
+    put_blob(pixels, size);
+}
+
+// readbacks into client memory go to a scratch buffer on replay; only PBO offsets matter
+static void put_pack(const void *pixels) {
+    GLint pbo = 0;
+    glGetIntegerv(GL_PIXEL_PACK_BUFFER_BINDING, &pbo);
+    put_u32(pbo != 0);
+    put_u64(pbo ? (uint64_t) (uintptr_t) pixels : 0);
+}
+
+static uint64_t array_bytes(GLsizei n, size_t elem) {
+    return n > 0 ? (uint64_t) n * elem : 0;
+}
+
+static uint64_t hash_bytes(const void *data, size_t size) {
+    const unsigned char *p = data;
+    uint64_t h = 0x9e3779b97f4a7c15ull ^ (uint64_t) size;
+
+    for (; size >= sizeof(uint64_t); p += sizeof(uint64_t), size -= sizeof(uint64_t)) {
+        uint64_t w;
+        memcpy(&w, p, sizeof(w));
+        h = (h ^ w) * 0xff51afd7ed558ccdull;
+        h ^= h >> 29;
+    }
+    if (size) {
+        uint64_t w = 0;
+        memcpy(&w, p, size);
+        h = (h ^ w) * 0xff51afd7ed558ccdull;
+    }
+
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ull;
+    h ^= h >> 33;
+    return h ? h : 1;
+}
+
+// the slot holding `hash`, or the free slot it goes to; NULL if the set cannot grow
+static seen_t *seen_slot(uint64_t hash) {
+    if ((s_seen_count + 1) * 2 > s_seen_cap) {
+        const size_t cap = s_seen_cap ? s_seen_cap * 2 : 4096;
+        seen_t *seen = calloc(cap, sizeof(seen_t));
+        if (!seen) {
+            // without the set every payload is written again, which still replays
+            return NULL;
+        }
+        for (size_t i = 0; i < s_seen_cap; ++i) {
+            if (s_seen[i].hash) {
+                size_t j = (size_t) s_seen[i].hash & (cap - 1);
+                while (seen[j].hash) {
+                    j = (j + 1) & (cap - 1);
+                }
+                seen[j] = s_seen[i];
+            }
+        }
+        free(s_seen);
+        s_seen = seen;
+        s_seen_cap = cap;
+    }
+
+    size_t i = (size_t) hash & (s_seen_cap - 1);
+    while (s_seen[i].hash && s_seen[i].hash != hash) {
+        i = (i + 1) & (s_seen_cap - 1);
+    }
+    return &s_seen[i];
+}
+
+// reads the earlier copy back from the file; any failure counts as a mismatch,
+// which only costs writing the payload again
+static bool blob_matches(const seen_t *seen, const void *data, uint64_t size) {
+    if (seen->size != size || !s_file || s_failed) {
+        return false;
+    }
+    if (seen->offset + size > s_flushed) {
+        if (fflush(s_file) != 0) {
+            s_failed = true;
+            return false;
+        }
+        s_flushed = s_stats.file_bytes;
+    }
+    if (!s_compare && !(s_compare = malloc(TRACE_COMPARE_CHUNK))) {
+        return false;
+    }
+
+    const int fd = fileno(s_file);
+    const unsigned char *p = data;
+    for (uint64_t done = 0; done < size;) {
+        const size_t n = size - done < TRACE_COMPARE_CHUNK ? (size_t) (size - done) : TRACE_COMPARE_CHUNK;
+        if (pread(fd, s_compare, n, (off_t) (seen->offset + done)) != (ssize_t) n || memcmp(s_compare, p + done, n) != 0) {
+            return false;
+        }
+        done += n;
+    }
+    return true;
+}
+
+static GLuint bound_buffer(GLenum target) {
+    GLenum binding;
+    switch (target) {
+        case GL_ARRAY_BUFFER:               binding = GL_ARRAY_BUFFER_BINDING; break;
+        case GL_ELEMENT_ARRAY_BUFFER:       binding = GL_ELEMENT_ARRAY_BUFFER_BINDING; break;
+        case GL_COPY_READ_BUFFER:           binding = GL_COPY_READ_BUFFER_BINDING; break;
+        case GL_COPY_WRITE_BUFFER:          binding = GL_COPY_WRITE_BUFFER_BINDING; break;
+        case GL_PIXEL_PACK_BUFFER:          binding = GL_PIXEL_PACK_BUFFER_BINDING; break;
+        case GL_PIXEL_UNPACK_BUFFER:        binding = GL_PIXEL_UNPACK_BUFFER_BINDING; break;
+        case GL_UNIFORM_BUFFER:             binding = GL_UNIFORM_BUFFER_BINDING; break;
+        case GL_SHADER_STORAGE_BUFFER:      binding = GL_SHADER_STORAGE_BUFFER_BINDING; break;
+        case GL_DRAW_INDIRECT_BUFFER:       binding = GL_DRAW_INDIRECT_BUFFER_BINDING; break;
+        case GL_DISPATCH_INDIRECT_BUFFER:   binding = GL_DISPATCH_INDIRECT_BUFFER_BINDING; break;
+        case GL_ATOMIC_COUNTER_BUFFER:      binding = GL_ATOMIC_COUNTER_BUFFER_BINDING; break;
+        case GL_QUERY_BUFFER:               binding = GL_QUERY_BUFFER_BINDING; break;
+        case GL_TEXTURE_BUFFER:             binding = GL_TEXTURE_BUFFER_BINDING; break;
+        case GL_TRANSFORM_FEEDBACK_BUFFER:  binding = GL_TRANSFORM_FEEDBACK_BUFFER_BINDING; break;
+        default:                            return 0;
+    }
+
+    GLint id = 0;
+    glGetIntegerv(binding, &id);
+    return (GLuint) id;
+}
+
+static void map_add(GLuint buffer, GLintptr offset, GLsizeiptr length, GLbitfield access, void *ptr) {
+    map_remove(buffer);
+    if (s_map_count == TRACE_MAX_MAPS) {
+        TRACE_LOG(GWR_LOG_WARNING, "more than %d buffers mapped; writes to buffer %u are not traced", TRACE_MAX_MAPS, buffer);
+        return;
+    }
+    s_maps[s_map_count++] = (map_t) {buffer, offset, length, access, ptr};
+}
+
+static void map_remove(GLuint buffer) {
+    for (int i = 0; i < s_map_count; ++i) {
+        if (s_maps[i].buffer == buffer) {
+            s_maps[i] = s_maps[--s_map_count];
+            return;
+        }
+    }
+}
+
+// records CPU writes to a mapping as their own record, ahead of the current one
+static void emit_buffer_write(GLuint buffer, GLintptr offset, GLsizeiptr size, const void *data) {
+    const GWR_trace_record_t saved = s_rec;
+    const size_t saved_size = s_args_size;
+
+    s_rec = (GWR_trace_record_t) {.call = GWR_TRACE_BUFFER_WRITE};
+    s_args_size = 0;
+    put_u32(buffer);
+    put_u64((uint64_t) offset);
+    put_blob(data, (uint64_t) size);
+    if (s_file && !s_failed) {
+        s_rec.size = (uint32_t) s_args_size;
+        write_raw(&s_rec, sizeof(s_rec));
+        write_raw(s_args, s_args_size);
+    }
+
+    s_rec = saved;
+    s_args_size = saved_size;
+}
+
+// what was written through a transient mapping is captured before it goes away;
+// persistent mappings report their writes through GWR_trace_buffer_write()
+static void flush_map(GLuint buffer) {
+    for (int i = 0; i < s_map_count; ++i) {
+        const map_t *m = &s_maps[i];
+        if (m->buffer == buffer) {
+            if ((m->access & GL_MAP_WRITE_BIT) && !(m->access & GL_MAP_PERSISTENT_BIT)) {
+                emit_buffer_write(m->buffer, m->offset, m->length, m->ptr);
+            }
+            map_remove(buffer);
+            return;
+        }
+    }
+}
+
+// wrappers
+
+#define PUT_ENUM(v)         put_u32((uint32_t) (v))
+#define PUT_INT(v)          put_u32((uint32_t) (v))
+#define PUT_UINT(v)         put_u32((uint32_t) (v))
+#define PUT_SIZEI(v)        put_u32((uint32_t) (v))
+#define PUT_BOOL(v)         put_u32((uint32_t) (v))
+#define PUT_BITS(v)         put_u32((uint32_t) (v))
+#define PUT_FLOAT(v)        put_f32(v)
+#define PUT_INTPTR(v)       put_u64((uint64_t) (v))
+#define PUT_SIZEIPTR(v)     put_u64((uint64_t) (v))
+#define PUT_OFFSET(v)       put_u64((uint64_t) (uintptr_t) (v))
+#define PUT_BUF(v)          put_u32(v)
+#define PUT_TEX(v)          put_u32(v)
+#define PUT_VAO(v)          put_u32(v)
+#define PUT_FBO(v)          put_u32(v)
+#define PUT_RBO(v)          put_u32(v)
+#define PUT_SMP(v)          put_u32(v)
+#define PUT_PROG(v)         put_u32(v)
+#define PUT_SHD(v)          put_u32(v)
+#define PUT_PIPE(v)         put_u32(v)
+#define PUT_QRY(v)          put_u32(v)
+#define PUT_SYNC(v)         put_u64((uint64_t) (uintptr_t) (v))
+
+#define T_(k)               GWR_TRACE_T_##k
+
+// takes pasted names: GL function names passed on to another macro would
+// expand to their glad_* pointers
+#define WRAP_BODY_(real, id, call, record)                                          \
+    {                                                                               \
+        const uint64_t t0 = call_enter();                                           \
+        real call;                                                                  \
+        rec_begin(id, t0);                                                          \
+        record;                                                                     \
+        call_leave();                                                               \
+    }
+
+#define WRAP0(fn)                                                                   \
+    static __typeof__(glad_##fn) real_##fn;                                         \
+    static void APIENTRY wrap_##fn(void)                                            \
+    WRAP_BODY_(real_##fn, GWR_TRACE_ID_##fn, (), (void) 0)
+
+#define WRAP1(fn, k0)                                                               \
+    static __typeof__(glad_##fn) real_##fn;                                         \
+    static void APIENTRY wrap_##fn(T_(k0) a0)                                       \
+    WRAP_BODY_(real_##fn, GWR_TRACE_ID_##fn, (a0), PUT_##k0(a0))
+
+#define WRAP2(fn, k0, k1)                                                           \
+    static __typeof__(glad_##fn) real_##fn;                                         \
+    static void APIENTRY wrap_##fn(T_(k0) a0, T_(k1) a1)                            \
+    WRAP_BODY_(real_##fn, GWR_TRACE_ID_##fn, (a0, a1), PUT_##k0(a0); PUT_##k1(a1))
+
+#define WRAP3(fn, k0, k1, k2)                                                       \
+    static __typeof__(glad_##fn) real_##fn;                                         \
+    static void APIENTRY wrap_##fn(T_(k0) a0, T_(k1) a1, T_(k2) a2)                 \
+    WRAP_BODY_(real_##fn, GWR_TRACE_ID_##fn, (a0, a1, a2), PUT_##k0(a0); PUT_##k1(a1); PUT_##k2(a2))
+
+#define WRAP4(fn, k0, k1, k2, k3)                                                   \
+    static __typeof__(glad_##fn) real_##fn;                                         \
+    static void APIENTRY wrap_##fn(T_(k0) a0, T_(k1) a1, T_(k2) a2, T_(k3) a3)      \
+    WRAP_BODY_(real_##fn, GWR_TRACE_ID_##fn, (a0, a1, a2, a3),                                                \
+        PUT_##k0(a0); PUT_##k1(a1); PUT_##k2(a2); PUT_##k3(a3))
+
+#define WRAP5(fn, k0, k1, k2, k3, k4)                                               \
+    static __typeof__(glad_##fn) real_##fn;                                         \
+    static void APIENTRY wrap_##fn(T_(k0) a0, T_(k1) a1, T_(k2) a2, T_(k3) a3,      \
+                                   T_(k4) a4)                                       \
+    WRAP_BODY_(real_##fn, GWR_TRACE_ID_##fn, (a0, a1, a2, a3, a4),                                            \
+        PUT_##k0(a0); PUT_##k1(a1); PUT_##k2(a2); PUT_##k3(a3); PUT_##k4(a4))
+
+#define WRAP6(fn, k0, k1, k2, k3, k4, k5)                                           \
+    static __typeof__(glad_##fn) real_##fn;                                         \
+    static void APIENTRY wrap_##fn(T_(k0) a0, T_(k1) a1, T_(k2) a2, T_(k3) a3,      \
+                                   T_(k4) a4, T_(k5) a5)                            \
+    WRAP_BODY_(real_##fn, GWR_TRACE_ID_##fn, (a0, a1, a2, a3, a4, a5),                                        \
+        PUT_##k0(a0); PUT_##k1(a1); PUT_##k2(a2); PUT_##k3(a3); PUT_##k4(a4);       \
+        PUT_##k5(a5))
+
+// generated names are only known after the call
+#define WRAP_GEN(fn, ns)                                                            \
+    static __typeof__(glad_##fn) real_##fn;                                         \
+    static void APIENTRY wrap_##fn(GLsizei n, GLuint *names)                        \
+    WRAP_BODY_(real_##fn, GWR_TRACE_ID_##fn, (n, names), PUT_SIZEI(n); put_blob(names, array_bytes(n, sizeof(GLuint))))
+
+#define WRAP_DELETE(fn, ns)                                                         \
+    static __typeof__(glad_##fn) real_##fn;                                         \
+    static void APIENTRY wrap_##fn(GLsizei n, const GLuint *names)                  \
+    WRAP_BODY_(real_##fn, GWR_TRACE_ID_##fn, (n, names), PUT_SIZEI(n); put_blob(names, array_bytes(n, sizeof(GLuint))))
+
+#define WRAP_UNIFORM(fn, type, comps)                                               \
+    static __typeof__(glad_##fn) real_##fn;                                         \
+    static void APIENTRY wrap_##fn(GLuint p, GLint loc, GLsizei count, const type *v) \
+    WRAP_BODY_(real_##fn, GWR_TRACE_ID_##fn, (p, loc, count, v),                                              \
+        PUT_PROG(p); PUT_INT(loc); PUT_SIZEI(count);                                \
+        put_blob(v, array_bytes(count, (comps) * sizeof(type))))
+
+#define WRAP_UNIFORM_MATRIX(fn, type, comps)                                        \
+    static __typeof__(glad_##fn) real_##fn;                                         \
+    static void APIENTRY wrap_##fn(GLuint p, GLint loc, GLsizei count, GLboolean t, const type *v) \
+    WRAP_BODY_(real_##fn, GWR_TRACE_ID_##fn, (p, loc, count, t, v),                                           \
+        PUT_PROG(p); PUT_INT(loc); PUT_SIZEI(count); PUT_BOOL(t);                   \
+        put_blob(v, array_bytes(count, (comps) * sizeof(type))))
+
+GWR_TRACE_SIMPLE_CALLS(WRAP0, WRAP1, WRAP2, WRAP3, WRAP4, WRAP5, WRAP6)
+GWR_TRACE_GEN_CALLS(WRAP_GEN)
+GWR_TRACE_DELETE_CALLS(WRAP_DELETE)
+GWR_TRACE_UNIFORM_CALLS(WRAP_UNIFORM, WRAP_UNIFORM_MATRIX)
+
+// hand-written wrappers, in GWR_TRACE_CUSTOM_CALLS order
+
+static __typeof__(glad_glCreateTextures) real_glCreateTextures;
+static void APIENTRY wrap_glCreateTextures(GLenum target, GLsizei n, GLuint *textures)
+WRAP_BODY_(real_glCreateTextures, GWR_TRACE_ID_glCreateTextures, (target, n, textures),
+    PUT_ENUM(target); PUT_SIZEI(n); put_blob(textures, array_bytes(n, sizeof(GLuint))))
+
+static __typeof__(glad_glCreateShader) real_glCreateShader;
+static GLuint APIENTRY wrap_glCreateShader(GLenum type) {
+    const uint64_t t0 = call_enter();
+    const GLuint shader = real_glCreateShader(type);
+    rec_begin(GWR_TRACE_ID_glCreateShader, t0);
+    PUT_ENUM(type);
+    PUT_SHD(shader);
+    call_leave();
+    return shader;
+}
+
+static __typeof__(glad_glCreateProgram) real_glCreateProgram;
+static GLuint APIENTRY wrap_glCreateProgram(void) {
+    const uint64_t t0 = call_enter();
+    const GLuint program = real_glCreateProgram();
+    rec_begin(GWR_TRACE_ID_glCreateProgram, t0);
+    PUT_PROG(program);
+    call_leave();
+    return program;
+}
+
+static __typeof__(glad_glGetUniformLocation) real_glGetUniformLocation;
+static GLint APIENTRY wrap_glGetUniformLocation(GLuint program, const GLchar *name) {
+    const uint64_t t0 = call_enter();
+    const GLint location = real_glGetUniformLocation(program, name);
+    rec_begin(GWR_TRACE_ID_glGetUniformLocation, t0);
+    PUT_PROG(program);
+    put_blob(name, strlen(name));
+    PUT_INT(location);
+    call_leave();
+    return location;
+}
+
+// the pieces are stored as one source
+static __typeof__(glad_glShaderSource) real_glShaderSource;
+static void APIENTRY wrap_glShaderSource(GLuint shader, GLsizei count, const GLchar *const *string, const GLint *length) {
+    const uint64_t t0 = call_enter();
+    real_glShaderSource(shader, count, string, length);
+    rec_begin(GWR_TRACE_ID_glShaderSource, t0);
+
+    size_t total = 0;
+    for (GLsizei i = 0; i < count; ++i) {
+        total += length && length[i] >= 0 ? (size_t) length[i] : strlen(string[i]);
+    }
+    if (total > s_scratch_cap) {
+        char *scratch = realloc(s_scratch, total);
+        if (scratch) {
+            s_scratch = scratch;
+            s_scratch_cap = total;
+        }
+    }
+
+    PUT_SHD(shader);
+    if (total > s_scratch_cap) {
+        s_failed = true;
+    } else {
+        size_t pos = 0;
+        for (GLsizei i = 0; i < count; ++i) {
+            const size_t n = length && length[i] >= 0 ? (size_t) length[i] : strlen(string[i]);
+            memcpy(s_scratch + pos, string[i], n);
+            pos += n;
+        }
+        put_blob(s_scratch ? s_scratch : "", total);
+    }
+    call_leave();
+}
+
+static __typeof__(glad_glBufferData) real_glBufferData;
+static void APIENTRY wrap_glBufferData(GLenum target, GLsizeiptr size, const void *data, GLenum usage)
+WRAP_BODY_(real_glBufferData, GWR_TRACE_ID_glBufferData, (target, size, data, usage),
+    PUT_ENUM(target); PUT_SIZEIPTR(size); put_blob(data, (uint64_t) size); PUT_ENUM(usage))
+
+static __typeof__(glad_glNamedBufferData) real_glNamedBufferData;
+static void APIENTRY wrap_glNamedBufferData(GLuint buffer, GLsizeiptr size, const void *data, GLenum usage)
+WRAP_BODY_(real_glNamedBufferData, GWR_TRACE_ID_glNamedBufferData, (buffer, size, data, usage),
+    PUT_BUF(buffer); PUT_SIZEIPTR(size); put_blob(data, (uint64_t) size); PUT_ENUM(usage))
+
+static __typeof__(glad_glBufferStorage) real_glBufferStorage;
+static void APIENTRY wrap_glBufferStorage(GLenum target, GLsizeiptr size, const void *data, GLbitfield flags)
+WRAP_BODY_(real_glBufferStorage, GWR_TRACE_ID_glBufferStorage, (target, size, data, flags),
+    PUT_ENUM(target); PUT_SIZEIPTR(size); put_blob(data, (uint64_t) size); PUT_BITS(flags))
+
+static __typeof__(glad_glNamedBufferStorage) real_glNamedBufferStorage;
+static void APIENTRY wrap_glNamedBufferStorage(GLuint buffer, GLsizeiptr size, const void *data, GLbitfield flags)
+WRAP_BODY_(real_glNamedBufferStorage, GWR_TRACE_ID_glNamedBufferStorage, (buffer, size, data, flags),
+    PUT_BUF(buffer); PUT_SIZEIPTR(size); put_blob(data, (uint64_t) size); PUT_BITS(flags))
+
+static __typeof__(glad_glBufferSubData) real_glBufferSubData;
+static void APIENTRY wrap_glBufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, const void *data)
+WRAP_BODY_(real_glBufferSubData, GWR_TRACE_ID_glBufferSubData, (target, offset, size, data),
+    PUT_ENUM(target); PUT_INTPTR(offset); put_blob(data, (uint64_t) size))
+
+static __typeof__(glad_glMapBufferRange) real_glMapBufferRange;
+static void *APIENTRY wrap_glMapBufferRange(GLenum target, GLintptr offset, GLsizeiptr length, GLbitfield access) {
+    const GLuint buffer = bound_buffer(target);
+    const uint64_t t0 = call_enter();
+    void *ptr = real_glMapBufferRange(target, offset, length, access);
+    rec_begin(GWR_TRACE_ID_glMapBufferRange, t0);
+    PUT_ENUM(target);
+    PUT_BUF(buffer);
+    PUT_INTPTR(offset);
+    PUT_SIZEIPTR(length);
+    PUT_BITS(access);
+    if (ptr) {
+        map_add(buffer, offset, length, access, ptr);
+    }
+    call_leave();
+    return ptr;
+}
+
+static __typeof__(glad_glMapNamedBufferRange) real_glMapNamedBufferRange;
+static void *APIENTRY wrap_glMapNamedBufferRange(GLuint buffer, GLintptr offset, GLsizeiptr length, GLbitfield access) {
+    const uint64_t t0 = call_enter();
+    void *ptr = real_glMapNamedBufferRange(buffer, offset, length, access);
+    rec_begin(GWR_TRACE_ID_glMapNamedBufferRange, t0);
+    PUT_BUF(buffer);
+    PUT_INTPTR(offset);
+    PUT_SIZEIPTR(length);
+    PUT_BITS(access);
+    if (ptr) {
+        map_add(buffer, offset, length, access, ptr);
+    }
+    call_leave();
+    return ptr;
+}
+
+static __typeof__(glad_glUnmapBuffer) real_glUnmapBuffer;
+static GLboolean APIENTRY wrap_glUnmapBuffer(GLenum target) {
+    const GLuint buffer = bound_buffer(target);
+    call_enter();
+    flush_map(buffer);
+    const uint64_t t0 = GWR_now_ns();
+    const GLboolean ok = real_glUnmapBuffer(target);
+    rec_begin(GWR_TRACE_ID_glUnmapBuffer, t0);
+    PUT_ENUM(target);
+    PUT_BUF(buffer);
+    call_leave();
+    return ok;
+}
+
+static __typeof__(glad_glUnmapNamedBuffer) real_glUnmapNamedBuffer;
+static GLboolean APIENTRY wrap_glUnmapNamedBuffer(GLuint buffer) {
+    call_enter();
+    flush_map(buffer);
+    const uint64_t t0 = GWR_now_ns();
+    const GLboolean ok = real_glUnmapNamedBuffer(buffer);
+    rec_begin(GWR_TRACE_ID_glUnmapNamedBuffer, t0);
+    PUT_BUF(buffer);
+    call_leave();
+    return ok;
+}
+
+static __typeof__(glad_glTexImage2D) real_glTexImage2D;
+static void APIENTRY wrap_glTexImage2D(
+    GLenum target, GLint level, GLint internalformat, GLsizei width, GLsizei height, GLint border,
+    GLenum format, GLenum type, const void *pixels
+)
+WRAP_BODY_(real_glTexImage2D, GWR_TRACE_ID_glTexImage2D, (target, level, internalformat, width, height, border, format, type, pixels),
+    PUT_ENUM(target); PUT_INT(level); PUT_INT(internalformat); PUT_SIZEI(width); PUT_SIZEI(height);
+    PUT_INT(border); PUT_ENUM(format); PUT_ENUM(type);
+    put_unpack(width, height, 1, format, type, pixels))
+
+static __typeof__(glad_glTexImage3D) real_glTexImage3D;
+static void APIENTRY wrap_glTexImage3D(
+    GLenum target, GLint level, GLint internalformat, GLsizei width, GLsizei height, GLsizei depth,
+    GLint border, GLenum format, GLenum type, const void *pixels
+)
+WRAP_BODY_(real_glTexImage3D, GWR_TRACE_ID_glTexImage3D, (target, level, internalformat, width, height, depth, border, format, type, pixels),
+    PUT_ENUM(target); PUT_INT(level); PUT_INT(internalformat); PUT_SIZEI(width); PUT_SIZEI(height);
+    PUT_SIZEI(depth); PUT_INT(border); PUT_ENUM(format); PUT_ENUM(type);
+    put_unpack(width, height, depth, format, type, pixels))
+
+static __typeof__(glad_glTexSubImage3D) real_glTexSubImage3D;
+static void APIENTRY wrap_glTexSubImage3D(
+    GLenum target, GLint level, GLint xoffset, GLint yoffset, GLint zoffset,
+    GLsizei width, GLsizei height, GLsizei depth, GLenum format, GLenum type, const void *pixels
+)
+WRAP_BODY_(real_glTexSubImage3D, GWR_TRACE_ID_glTexSubImage3D, (target, level, xoffset, yoffset, zoffset, width, height, depth, format, type, pixels),
+    PUT_ENUM(target); PUT_INT(level); PUT_INT(xoffset); PUT_INT(yoffset); PUT_INT(zoffset);
+    PUT_SIZEI(width); PUT_SIZEI(height); PUT_SIZEI(depth); PUT_ENUM(format); PUT_ENUM(type);
+    put_unpack(width, height, depth, format, type, pixels))
+
+static __typeof__(glad_glReadPixels) real_glReadPixels;
+static void APIENTRY wrap_glReadPixels(GLint x, GLint y, GLsizei width, GLsizei height, GLenum format, GLenum type, void *pixels)
+WRAP_BODY_(real_glReadPixels, GWR_TRACE_ID_glReadPixels, (x, y, width, height, format, type, pixels),
+    PUT_INT(x); PUT_INT(y); PUT_SIZEI(width); PUT_SIZEI(height); PUT_ENUM(format); PUT_ENUM(type);
+    put_pack(pixels))
+
+static __typeof__(glad_glGetTextureSubImage) real_glGetTextureSubImage;
+static void APIENTRY wrap_glGetTextureSubImage(
+    GLuint texture, GLint level, GLint xoffset, GLint yoffset, GLint zoffset,
+    GLsizei width, GLsizei height, GLsizei depth, GLenum format, GLenum type, GLsizei bufSize, void *pixels
+)
+WRAP_BODY_(real_glGetTextureSubImage, GWR_TRACE_ID_glGetTextureSubImage, (texture, level, xoffset, yoffset, zoffset, width, height, depth, format, type, bufSize, pixels),
+    PUT_TEX(texture); PUT_INT(level); PUT_INT(xoffset); PUT_INT(yoffset); PUT_INT(zoffset);
+    PUT_SIZEI(width); PUT_SIZEI(height); PUT_SIZEI(depth); PUT_ENUM(format); PUT_ENUM(type);
+    PUT_SIZEI(bufSize); put_pack(pixels))
+
+static __typeof__(glad_glSamplerParameterfv) real_glSamplerParameterfv;
+static void APIENTRY wrap_glSamplerParameterfv(GLuint sampler, GLenum pname, const GLfloat *param)
+WRAP_BODY_(real_glSamplerParameterfv, GWR_TRACE_ID_glSamplerParameterfv, (sampler, pname, param),
+    PUT_SMP(sampler); PUT_ENUM(pname);
+    put_blob(param, (pname == GL_TEXTURE_BORDER_COLOR ? 4 : 1) * sizeof(GLfloat)))
+
+static __typeof__(glad_glDrawBuffers) real_glDrawBuffers;
+static void APIENTRY wrap_glDrawBuffers(GLsizei n, const GLenum *bufs)
+WRAP_BODY_(real_glDrawBuffers, GWR_TRACE_ID_glDrawBuffers, (n, bufs),
+    PUT_SIZEI(n); put_blob(bufs, array_bytes(n, sizeof(GLenum))))
+
+static __typeof__(glad_glNamedFramebufferDrawBuffers) real_glNamedFramebufferDrawBuffers;
+static void APIENTRY wrap_glNamedFramebufferDrawBuffers(GLuint framebuffer, GLsizei n, const GLenum *bufs)
+WRAP_BODY_(real_glNamedFramebufferDrawBuffers, GWR_TRACE_ID_glNamedFramebufferDrawBuffers, (framebuffer, n, bufs),
+    PUT_FBO(framebuffer); PUT_SIZEI(n); put_blob(bufs, array_bytes(n, sizeof(GLenum))))
+
+static __typeof__(glad_glClearBufferfv) real_glClearBufferfv;
+static void APIENTRY wrap_glClearBufferfv(GLenum buffer, GLint drawbuffer, const GLfloat *value)
+WRAP_BODY_(real_glClearBufferfv, GWR_TRACE_ID_glClearBufferfv, (buffer, drawbuffer, value),
+    PUT_ENUM(buffer); PUT_INT(drawbuffer);
+    put_blob(value, (buffer == GL_COLOR ? 4 : 1) * sizeof(GLfloat)))
+
+static __typeof__(glad_glClearNamedFramebufferfv) real_glClearNamedFramebufferfv;
+static void APIENTRY wrap_glClearNamedFramebufferfv(GLuint framebuffer, GLenum buffer, GLint drawbuffer, const GLfloat *value)
+WRAP_BODY_(real_glClearNamedFramebufferfv, GWR_TRACE_ID_glClearNamedFramebufferfv, (framebuffer, buffer, drawbuffer, value),
+    PUT_FBO(framebuffer); PUT_ENUM(buffer); PUT_INT(drawbuffer);
+    put_blob(value, (buffer == GL_COLOR ? 4 : 1) * sizeof(GLfloat)))
+
+static __typeof__(glad_glClearBufferiv) real_glClearBufferiv;
+static void APIENTRY wrap_glClearBufferiv(GLenum buffer, GLint drawbuffer, const GLint *value)
+WRAP_BODY_(real_glClearBufferiv, GWR_TRACE_ID_glClearBufferiv, (buffer, drawbuffer, value),
+    PUT_ENUM(buffer); PUT_INT(drawbuffer);
+    put_blob(value, (buffer == GL_COLOR ? 4 : 1) * sizeof(GLint)))
+
+static __typeof__(glad_glClearNamedFramebufferiv) real_glClearNamedFramebufferiv;
+static void APIENTRY wrap_glClearNamedFramebufferiv(GLuint framebuffer, GLenum buffer, GLint drawbuffer, const GLint *value)
+WRAP_BODY_(real_glClearNamedFramebufferiv, GWR_TRACE_ID_glClearNamedFramebufferiv, (framebuffer, buffer, drawbuffer, value),
+    PUT_FBO(framebuffer); PUT_ENUM(buffer); PUT_INT(drawbuffer);
+    put_blob(value, (buffer == GL_COLOR ? 4 : 1) * sizeof(GLint)))
+
+static __typeof__(glad_glInvalidateFramebuffer) real_glInvalidateFramebuffer;
+static void APIENTRY wrap_glInvalidateFramebuffer(GLenum target, GLsizei n, const GLenum *attachments)
+WRAP_BODY_(real_glInvalidateFramebuffer, GWR_TRACE_ID_glInvalidateFramebuffer, (target, n, attachments),
+    PUT_ENUM(target); PUT_SIZEI(n); put_blob(attachments, array_bytes(n, sizeof(GLenum))))
+
+static __typeof__(glad_glInvalidateNamedFramebufferData) real_glInvalidateNamedFramebufferData;
+static void APIENTRY wrap_glInvalidateNamedFramebufferData(GLuint framebuffer, GLsizei n, const GLenum *attachments)
+WRAP_BODY_(real_glInvalidateNamedFramebufferData, GWR_TRACE_ID_glInvalidateNamedFramebufferData, (framebuffer, n, attachments),
+    PUT_FBO(framebuffer); PUT_SIZEI(n); put_blob(attachments, array_bytes(n, sizeof(GLenum))))
+
+static __typeof__(glad_glBlitFramebuffer) real_glBlitFramebuffer;
+static void APIENTRY wrap_glBlitFramebuffer(
+    GLint sx0, GLint sy0, GLint sx1, GLint sy1, GLint dx0, GLint dy0, GLint dx1, GLint dy1,
+    GLbitfield mask, GLenum filter
+)
+WRAP_BODY_(real_glBlitFramebuffer, GWR_TRACE_ID_glBlitFramebuffer, (sx0, sy0, sx1, sy1, dx0, dy0, dx1, dy1, mask, filter),
+    PUT_INT(sx0); PUT_INT(sy0); PUT_INT(sx1); PUT_INT(sy1);
+    PUT_INT(dx0); PUT_INT(dy0); PUT_INT(dx1); PUT_INT(dy1); PUT_BITS(mask); PUT_ENUM(filter))
+
+static __typeof__(glad_glBlitNamedFramebuffer) real_glBlitNamedFramebuffer;
+static void APIENTRY wrap_glBlitNamedFramebuffer(
+    GLuint read, GLuint draw, GLint sx0, GLint sy0, GLint sx1, GLint sy1,
+    GLint dx0, GLint dy0, GLint dx1, GLint dy1, GLbitfield mask, GLenum filter
+)
+WRAP_BODY_(real_glBlitNamedFramebuffer, GWR_TRACE_ID_glBlitNamedFramebuffer, (read, draw, sx0, sy0, sx1, sy1, dx0, dy0, dx1, dy1, mask, filter),
+    PUT_FBO(read); PUT_FBO(draw); PUT_INT(sx0); PUT_INT(sy0); PUT_INT(sx1); PUT_INT(sy1);
+    PUT_INT(dx0); PUT_INT(dy0); PUT_INT(dx1); PUT_INT(dy1); PUT_BITS(mask); PUT_ENUM(filter))
+
+static __typeof__(glad_glBindTextures) real_glBindTextures;
+static void APIENTRY wrap_glBindTextures(GLuint first, GLsizei count, const GLuint *textures)
+WRAP_BODY_(real_glBindTextures, GWR_TRACE_ID_glBindTextures, (first, count, textures),
+    PUT_UINT(first); PUT_SIZEI(count); put_blob(textures, array_bytes(count, sizeof(GLuint))))
+
+static __typeof__(glad_glBindSamplers) real_glBindSamplers;
+static void APIENTRY wrap_glBindSamplers(GLuint first, GLsizei count, const GLuint *samplers)
+WRAP_BODY_(real_glBindSamplers, GWR_TRACE_ID_glBindSamplers, (first, count, samplers),
+    PUT_UINT(first); PUT_SIZEI(count); put_blob(samplers, array_bytes(count, sizeof(GLuint))))
+
+static __typeof__(glad_glBindBuffersBase) real_glBindBuffersBase;
+static void APIENTRY wrap_glBindBuffersBase(GLenum target, GLuint first, GLsizei count, const GLuint *buffers)
+WRAP_BODY_(real_glBindBuffersBase, GWR_TRACE_ID_glBindBuffersBase, (target, first, count, buffers),
+    PUT_ENUM(target); PUT_UINT(first); PUT_SIZEI(count);
+    put_blob(buffers, array_bytes(count, sizeof(GLuint))))
+
+static __typeof__(glad_glBindBuffersRange) real_glBindBuffersRange;
+static void APIENTRY wrap_glBindBuffersRange(
+    GLenum target, GLuint first, GLsizei count, const GLuint *buffers, const GLintptr *offsets, const GLsizeiptr *sizes
+)
+WRAP_BODY_(real_glBindBuffersRange, GWR_TRACE_ID_glBindBuffersRange, (target, first, count, buffers, offsets, sizes),
+    PUT_ENUM(target); PUT_UINT(first); PUT_SIZEI(count);
+    put_blob(buffers, array_bytes(count, sizeof(GLuint)));
+    put_blob(buffers ? offsets : NULL, array_bytes(count, sizeof(GLintptr)));
+    put_blob(buffers ? sizes : NULL, array_bytes(count, sizeof(GLsizeiptr))))
+
+static __typeof__(glad_glBindVertexBuffers) real_glBindVertexBuffers;
+static void APIENTRY wrap_glBindVertexBuffers(
+    GLuint first, GLsizei count, const GLuint *buffers, const GLintptr *offsets, const GLsizei *strides
+)
+WRAP_BODY_(real_glBindVertexBuffers, GWR_TRACE_ID_glBindVertexBuffers, (first, count, buffers, offsets, strides),
+    PUT_UINT(first); PUT_SIZEI(count);
+    put_blob(buffers, array_bytes(count, sizeof(GLuint)));
+    put_blob(buffers ? offsets : NULL, array_bytes(count, sizeof(GLintptr)));
+    put_blob(buffers ? strides : NULL, array_bytes(count, sizeof(GLsizei))))
+
+static __typeof__(glad_glVertexArrayVertexBuffers) real_glVertexArrayVertexBuffers;
+static void APIENTRY wrap_glVertexArrayVertexBuffers(
+    GLuint vaobj, GLuint first, GLsizei count, const GLuint *buffers, const GLintptr *offsets, const GLsizei *strides
+)
+WRAP_BODY_(real_glVertexArrayVertexBuffers, GWR_TRACE_ID_glVertexArrayVertexBuffers, (vaobj, first, count, buffers, offsets, strides),
+    PUT_VAO(vaobj); PUT_UINT(first); PUT_SIZEI(count);
+    put_blob(buffers, array_bytes(count, sizeof(GLuint)));
+    put_blob(buffers ? offsets : NULL, array_bytes(count, sizeof(GLintptr)));
+    put_blob(buffers ? strides : NULL, array_bytes(count, sizeof(GLsizei))))
+
+static __typeof__(glad_glFenceSync) real_glFenceSync;
+static GLsync APIENTRY wrap_glFenceSync(GLenum condition, GLbitfield flags) {
+    const uint64_t t0 = call_enter();
+    const GLsync sync = real_glFenceSync(condition, flags);
+    rec_begin(GWR_TRACE_ID_glFenceSync, t0);
+    PUT_ENUM(condition);
+    PUT_BITS(flags);
+    PUT_SYNC(sync);
+    call_leave();
+    return sync;
+}
+
+// the wait is recorded with its traced outcome and duration, the stall a repro is usually after
+static __typeof__(glad_glClientWaitSync) real_glClientWaitSync;
+static GLenum APIENTRY wrap_glClientWaitSync(GLsync sync, GLbitfield flags, GLuint64 timeout) {
+    const uint64_t t0 = call_enter();
+    const GLenum result = real_glClientWaitSync(sync, flags, timeout);
+    rec_begin(GWR_TRACE_ID_glClientWaitSync, t0);
+    PUT_SYNC(sync);
+    PUT_BITS(flags);
+    put_u64(timeout);
+    PUT_ENUM(result);
+    call_leave();
+    return result;
+}
+
+static __typeof__(glad_glWaitSync) real_glWaitSync;
+static void APIENTRY wrap_glWaitSync(GLsync sync, GLbitfield flags, GLuint64 timeout)
+WRAP_BODY_(real_glWaitSync, GWR_TRACE_ID_glWaitSync, (sync, flags, timeout),
+    PUT_SYNC(sync); PUT_BITS(flags); put_u64(timeout))
+
+static __typeof__(glad_glDeleteSync) real_glDeleteSync;
+static void APIENTRY wrap_glDeleteSync(GLsync sync)
+WRAP_BODY_(real_glDeleteSync, GWR_TRACE_ID_glDeleteSync, (sync), PUT_SYNC(sync))
+
+static __typeof__(glad_glObjectLabel) real_glObjectLabel;
+static void APIENTRY wrap_glObjectLabel(GLenum identifier, GLuint name, GLsizei length, const GLchar *label)
+WRAP_BODY_(real_glObjectLabel, GWR_TRACE_ID_glObjectLabel, (identifier, name, length, label),
+    PUT_ENUM(identifier); PUT_UINT(name);
+    put_blob(label, label ? (length >= 0 ? (uint64_t) length : strlen(label)) : 0))
+
+static __typeof__(glad_glPushDebugGroup) real_glPushDebugGroup;
+static void APIENTRY wrap_glPushDebugGroup(GLenum source, GLuint id, GLsizei length, const GLchar *message)
+WRAP_BODY_(real_glPushDebugGroup, GWR_TRACE_ID_glPushDebugGroup, (source, id, length, message),
+    PUT_ENUM(source); PUT_UINT(id);
+    put_blob(message, length >= 0 ? (uint64_t) length : strlen(message)))
+
+// entry points the driver does not have stay NULL
+#define INSTALL_(fn, ...)                                                           \
+    if (glad_##fn && glad_##fn != wrap_##fn) {                                      \
+        real_##fn = glad_##fn;                                                      \
+        glad_##fn = wrap_##fn;                                                      \
+    }
+#define INSTALL0_(fn)                                                               \
+    if (glad_##fn && glad_##fn != wrap_##fn) {                                      \
+        real_##fn = glad_##fn;                                                      \
+        glad_##fn = wrap_##fn;                                                      \
+    }
+
+// real_* stay set: a thread already inside a wrapper still reaches the driver
+#define RESTORE_(fn, ...)                                                           \
+    if (glad_##fn == wrap_##fn) {                                                   \
+        glad_##fn = real_##fn;                                                      \
+    }
+#define RESTORE0_(fn)                                                               \
+    if (glad_##fn == wrap_##fn) {                                                   \
+        glad_##fn = real_##fn;                                                      \
+    }
+
+static void install_wrappers(void) {
+    GWR_TRACE_SIMPLE_CALLS(INSTALL0_, INSTALL_, INSTALL_, INSTALL_, INSTALL_, INSTALL_, INSTALL_)
+    GWR_TRACE_GEN_CALLS(INSTALL_)
+    GWR_TRACE_DELETE_CALLS(INSTALL_)
+    GWR_TRACE_UNIFORM_CALLS(INSTALL_, INSTALL_)
+    GWR_TRACE_CUSTOM_CALLS(INSTALL0_)
+}
+
+static void restore_wrappers(void) {
+    GWR_TRACE_SIMPLE_CALLS(RESTORE0_, RESTORE_, RESTORE_, RESTORE_, RESTORE_, RESTORE_, RESTORE_)
+    GWR_TRACE_GEN_CALLS(RESTORE_)
+    GWR_TRACE_DELETE_CALLS(RESTORE_)
+    GWR_TRACE_UNIFORM_CALLS(RESTORE_, RESTORE_)
+    GWR_TRACE_CUSTOM_CALLS(RESTORE0_)
+}
@@ -0,0 +1,13 @@
+// clock_gettime and CLOCK_MONOTONIC are POSIX, not ISO C
+#define _POSIX_C_SOURCE 199309L
+
+#include "internal/gwr_util.h"
+
+#include <time.h>
+
+uint64_t GWR_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (uint64_t) ts.tv_sec * 1000000000ull + (uint64_t) ts.tv_nsec;
+}
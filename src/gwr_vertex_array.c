@@ -1,17 +1,19 @@
 #include "internal/gwr_vertex_array.h"
 #include "internal/gwr_log.h"
+#include "internal/gwr_cap.h"
 
 #include <stdio.h>
 #include <stdlib.h>
 #include <assert.h>
 
-#define VA_LOG(level, msg, ...)    GWR_log((level), "[VERTEX ARRAY]: " msg, ##__VA_ARGS__)
+#define VA_LOG(level, msg, ...)    GWR_LOG_AT(GWR_LOG_SYS_VERTEX_ARRAY, (level), msg, ##__VA_ARGS__)
 
 struct GWR_vertex_array_t {
     GLuint id;
 };
 
 static void bind_vao_and_vbo(const GWR_vertex_array_t *vao, const GWR_vertex_buffer_t *vbo);
+static void bind_vao_and_buffer(const GWR_vertex_array_t *vao, GLuint buffer);
 
 GWR_vertex_array_t *GWR_vertex_array_create(void) {
     GWR_vertex_array_t *array = malloc(sizeof(GWR_vertex_array_t));
@@ -118,10 +120,59 @@ void GWR_vertex_array_attrib_pointerl(
     glEnableVertexAttribArray(idx);
 }
 
+void GWR_vertex_array_set_attrib_divisor(const GWR_vertex_array_t *vao, GLuint idx, GLuint divisor) {
+    assert(vao);
+    assert(vao->id);
+
+    // glVertexAttrib*Pointer binds attribute `idx` to binding point `idx`
+    if (GWR_cap_has(GWR_FEATURE_DIRECT_STATE_ACCESS)) {
+        glVertexArrayBindingDivisor(vao->id, idx, divisor);
+        return;
+    }
+
+    glBindVertexArray(vao->id);
+    glVertexAttribDivisor(idx, divisor);
+}
+
+void GWR_vertex_array_stream_attrib_pointerf(
+    const GWR_vertex_array_t *vao,
+    const GWR_stream_buffer_t *sb,
+    GLuint idx, GLint size, GLenum type, GLboolean normalized,
+    const void *pointer
+) {
+    assert(vao);
+    assert(sb);
+
+    bind_vao_and_buffer(vao, GWR_stream_buffer_get_id(sb));
+    glVertexAttribPointer(idx, size, type, normalized, GWR_stream_buffer_get_stride(sb), pointer);
+    glEnableVertexAttribArray(idx);
+}
+
+void GWR_vertex_array_stream_attrib_pointeri(
+    const GWR_vertex_array_t *vao,
+    const GWR_stream_buffer_t *sb,
+    GLuint idx, GLint size, GLenum type,
+    const void *pointer
+) {
+    assert(vao);
+    assert(sb);
+
+    bind_vao_and_buffer(vao, GWR_stream_buffer_get_id(sb));
+    glVertexAttribIPointer(idx, size, type, GWR_stream_buffer_get_stride(sb), pointer);
+    glEnableVertexAttribArray(idx);
+}
+
 static void bind_vao_and_vbo(const GWR_vertex_array_t *vao, const GWR_vertex_buffer_t *vbo) {
     assert(vao);
     assert(vbo);
 
+    bind_vao_and_buffer(vao, GWR_vertex_buffer_get_id(vbo));
+}
+
+static void bind_vao_and_buffer(const GWR_vertex_array_t *vao, GLuint buffer) {
+    assert(vao);
+    assert(buffer);
+
     glBindVertexArray(vao->id);
-    glBindBuffer(GL_ARRAY_BUFFER, GWR_vertex_buffer_get_id(vbo));
+    glBindBuffer(GL_ARRAY_BUFFER, buffer);
 }
@@ -1,18 +1,22 @@
 #include "internal/gwr_vertex_buffer.h"
 #include "internal/gwr_log.h"
 #include "internal/gwr_cap.h"
+#include "internal/gwr_memory.h"
+#include "internal/gwr_debug.h"
 
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdbool.h>
 #include <assert.h>
 
-#define VB_LOG(level, msg, ...)    GWR_log((level), "[VERTEX BUFFER]: " msg, ##__VA_ARGS__)
+#define VB_LOG(level, msg, ...)    GWR_LOG_AT(GWR_LOG_SYS_VERTEX_BUFFER, (level), msg, ##__VA_ARGS__)
 
 struct GWR_vertex_buffer_t {
     GLuint id;
     GLsizeiptr size;
     GLenum usage;
+    bool immutable;
+    GWR_mem_tag_t mem_tag;
 };
 
 typedef bool (*vb_create)(GWR_vertex_buffer_t *, const void *, GLsizeiptr, GLenum);
@@ -32,6 +36,8 @@ static bool backend_create_buffer_bind(GWR_vertex_buffer_t *vbo, const void *dat
 static void backend_set_data_dsa(GWR_vertex_buffer_t *vbo, const void *data, GLsizeiptr size);
 static void backend_set_data_bind(GWR_vertex_buffer_t *vbo, const void *data, GLsizeiptr size);
 
+static bool create_storage(GWR_vertex_buffer_t *vbo, const void *data, GLsizeiptr size, GLbitfield flags);
+
 static void vb_pick_backend(void);
 
 // public funcs defs
@@ -48,6 +54,7 @@ GWR_vertex_buffer_t *GWR_vertex_buffer_create(const void *data, GLsizeiptr size,
     vbo->id = 0;
     vbo->size = 0;
     vbo->usage = usage;
+    vbo->immutable = false;
 
     if (!s_vb_create(vbo, data, size, usage)) {
         free(vbo);
@@ -55,6 +62,33 @@ GWR_vertex_buffer_t *GWR_vertex_buffer_create(const void *data, GLsizeiptr size,
     }
 
     vbo->size = size;
+    vbo->mem_tag = GWR_mem_record_alloc(GWR_MEM_VERTEX_BUFFER, size);
+    GWR_debug_label(GL_BUFFER, vbo->id, "vertex buffer %td bytes", size);
+    return vbo;
+}
+
+GWR_vertex_buffer_t *GWR_vertex_buffer_create_storage(const void *data, GLsizeiptr size, GLbitfield flags) {
+    vb_pick_backend();
+
+    GWR_vertex_buffer_t *vbo = malloc(sizeof(GWR_vertex_buffer_t));
+    if (!vbo) {
+        VB_LOG(GWR_LOG_ERROR, "failed to allocate memory");
+        return NULL;
+    }
+
+    vbo->id = 0;
+    vbo->size = 0;
+    vbo->usage = GL_STATIC_DRAW;
+    vbo->immutable = true;
+
+    if (!create_storage(vbo, data, size, flags)) {
+        free(vbo);
+        return NULL;
+    }
+
+    vbo->size = size;
+    vbo->mem_tag = GWR_mem_record_alloc(GWR_MEM_VERTEX_BUFFER, size);
+    GWR_debug_label(GL_BUFFER, vbo->id, "vertex buffer %td bytes", size);
     return vbo;
 }
 
@@ -62,6 +96,8 @@ void GWR_vertex_buffer_destroy(GWR_vertex_buffer_t *vbo) {
     assert(vbo);
     assert(vbo->id);
 
+    GWR_mem_record_free(GWR_MEM_VERTEX_BUFFER, vbo->mem_tag, vbo->size);
+
     glDeleteBuffers(1, &vbo->id);
     vbo->id = 0;
 
@@ -83,10 +119,16 @@ void GWR_vertex_buffer_set_data(GWR_vertex_buffer_t *vbo, const void *data, GLsi
     assert(vbo);
     assert(vbo->id);
 
+    if (vbo->immutable) {
+        VB_LOG(GWR_LOG_ERROR, "buffer %u has immutable storage", vbo->id);
+        return;
+    }
+
     vb_pick_backend();
 
     s_vb_set_data(vbo, data, size);
 
+    GWR_mem_record_resize(GWR_MEM_VERTEX_BUFFER, vbo->mem_tag, vbo->size, size);
     vbo->size = size;
 }
 
@@ -187,6 +229,54 @@ static void backend_set_data_bind(GWR_vertex_buffer_t *vbo, const void *data, GL
     glBindBuffer(GL_ARRAY_BUFFER, prev);
 }
 
+static bool create_storage(GWR_vertex_buffer_t *vbo, const void *data, GLsizeiptr size, GLbitfield flags) {
+    assert(vbo);
+
+    if (!GWR_cap_has(GWR_FEATURE_BUFFER_STORAGE)) {
+        // pre-4.4 fallback: a static store the mesh never respecifies behaves the same
+        return s_vb_create(vbo, data, size, GL_STATIC_DRAW);
+    }
+
+    if (GWR_cap_has(GWR_FEATURE_DIRECT_STATE_ACCESS)) {
+        glCreateBuffers(1, &vbo->id);
+        if (!vbo->id) {
+            VB_LOG(GWR_LOG_ERROR, "glCreateBuffers returned 0");
+            return false;
+        }
+        glNamedBufferStorage(vbo->id, size, data, flags);
+        if (!check_created_size_named(vbo->id, size)) {
+            VB_LOG(GWR_LOG_ERROR, "glNamedBufferStorage failed to allocate %td bytes", size);
+            glDeleteBuffers(1, &vbo->id);
+            vbo->id = 0;
+            return false;
+        }
+        return true;
+    }
+
+    glGenBuffers(1, &vbo->id);
+    if (!vbo->id) {
+        VB_LOG(GWR_LOG_ERROR, "glGenBuffers failed");
+        return false;
+    }
+
+    GLint prev = 0;
+    glGetIntegerv(GL_COPY_WRITE_BUFFER_BINDING, &prev);
+
+    // allocate through the copy target so a caller's GL_ARRAY_BUFFER binding survives
+    glBindBuffer(GL_COPY_WRITE_BUFFER, vbo->id);
+    glBufferStorage(GL_COPY_WRITE_BUFFER, size, data, flags);
+    const bool ok = check_created_size_bound(GL_COPY_WRITE_BUFFER, size);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, prev);
+
+    if (!ok) {
+        VB_LOG(GWR_LOG_ERROR, "glBufferStorage failed to allocate %td bytes", size);
+        glDeleteBuffers(1, &vbo->id);
+        vbo->id = 0;
+        return false;
+    }
+    return true;
+}
+
 static void vb_pick_backend(void) {
     if (s_vb_create && s_vb_set_data) {
         return;
@@ -0,0 +1,668 @@
+#include "internal/gwr_vfs.h"
+#include "internal/gwr_pak_format.h"
+#include "internal/gwr_lz.h"
+#include "internal/gwr_log.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+#include <assert.h>
+#include <pthread.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#define VFS_LOG(level, msg, ...)    GWR_LOG_AT(GWR_LOG_SYS_VFS, (level), msg, ##__VA_ARGS__)
+
+#define VFS_PATH_SIZE 1024
+
+typedef struct {
+    char *path;
+    char prefix[VFS_PATH_SIZE];
+    size_t prefix_len;
+
+    const unsigned char *map;
+    size_t map_size;
+    const GWR_pak_header_t *header;
+    const GWR_pak_entry_t *toc;
+    const char *names;
+} mount_t;
+
+typedef struct {
+    const mount_t *mount;
+    const GWR_pak_entry_t *entry;
+} lookup_t;
+
+static pthread_rwlock_t s_lock = PTHREAD_RWLOCK_INITIALIZER;
+static mount_t s_mounts[GWR_VFS_MAX_MOUNTS];
+static int s_mount_count = 0;
+
+static _Atomic uint64_t s_pak_reads = 0;
+static _Atomic uint64_t s_loose_reads = 0;
+static _Atomic uint64_t s_misses = 0;
+static _Atomic uint64_t s_blocks_decoded = 0;
+static _Atomic uint64_t s_bytes_decoded = 0;
+
+static atomic_bool s_prefer_loose = false;
+
+// inner funcs decls
+
+static bool normalize(const char *path, char *out, size_t size);
+static bool find(const char *norm, lookup_t *out);
+static bool loose_wins(const char *path);
+static bool header_ok(const GWR_pak_header_t *h, size_t map_size);
+static bool entry_ok(const mount_t *m, const GWR_pak_entry_t *e);
+static bool decode_block(const mount_t *m, const GWR_pak_entry_t *e, uint32_t block, void *dst);
+static bool read_entry(const mount_t *m, const GWR_pak_entry_t *e, void *dst);
+static int64_t read_entry_range(const mount_t *m, const GWR_pak_entry_t *e, uint64_t offset, void *dst, size_t n);
+static uint64_t read_u64(const unsigned char *p);
+static bool read_fd(int fd, void *dst, size_t n);
+
+// public funcs defs
+
+bool GWR_vfs_mount(const char *pak_path, const char *prefix) {
+    assert(pak_path);
+
+    mount_t m = {0};
+    if (prefix && *prefix && !normalize(prefix, m.prefix, sizeof(m.prefix))) {
+        VFS_LOG(GWR_LOG_ERROR, "mount prefix too long: '%s'", prefix);
+        return false;
+    }
+    m.prefix_len = strlen(m.prefix);
+
+    const int fd = open(pak_path, O_RDONLY);
+    if (fd < 0) {
+        VFS_LOG(GWR_LOG_ERROR, "failed to open '%s'", pak_path);
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t) st.st_size < sizeof(GWR_pak_header_t)) {
+        VFS_LOG(GWR_LOG_ERROR, "'%s' is too small to be an archive", pak_path);
+        close(fd);
+        return false;
+    }
+
+    m.map_size = (size_t) st.st_size;
+    void *map = mmap(NULL, m.map_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        VFS_LOG(GWR_LOG_ERROR, "failed to map '%s'", pak_path);
+        return false;
+    }
+    // entries are read in whatever order assets are requested
+    madvise(map, m.map_size, MADV_RANDOM);
+
+    m.map = map;
+    m.header = map;
+    if (!header_ok(m.header, m.map_size)) {
+        VFS_LOG(GWR_LOG_ERROR, "'%s' is not a valid archive", pak_path);
+        munmap(map, m.map_size);
+        return false;
+    }
+    m.toc = (const GWR_pak_entry_t *) (m.map + m.header->toc_offset);
+    m.names = (const char *) (m.map + m.header->names_offset);
+
+    m.path = malloc(strlen(pak_path) + 1);
+    if (!m.path) {
+        VFS_LOG(GWR_LOG_ERROR, "failed to allocate mount");
+        munmap(map, m.map_size);
+        return false;
+    }
+    strcpy(m.path, pak_path);
+
+    pthread_rwlock_wrlock(&s_lock);
+    if (s_mount_count == GWR_VFS_MAX_MOUNTS) {
+        pthread_rwlock_unlock(&s_lock);
+        VFS_LOG(GWR_LOG_ERROR, "too many mounts (%d), '%s' not mounted", GWR_VFS_MAX_MOUNTS, pak_path);
+        free(m.path);
+        munmap(map, m.map_size);
+        return false;
+    }
+    s_mounts[s_mount_count++] = m;
+    pthread_rwlock_unlock(&s_lock);
+
+    VFS_LOG(
+        GWR_LOG_INFO, "mounted '%s' at '%s': %u entries",
+        pak_path, m.prefix, m.header->entry_count
+    );
+    return true;
+}
+
+bool GWR_vfs_unmount(const char *pak_path) {
+    assert(pak_path);
+
+    pthread_rwlock_wrlock(&s_lock);
+    for (int i = s_mount_count - 1; i >= 0; --i) {
+        if (strcmp(s_mounts[i].path, pak_path) == 0) {
+            munmap((void *) s_mounts[i].map, s_mounts[i].map_size);
+            free(s_mounts[i].path);
+            memmove(&s_mounts[i], &s_mounts[i + 1], (size_t) (s_mount_count - i - 1) * sizeof(mount_t));
+            --s_mount_count;
+            pthread_rwlock_unlock(&s_lock);
+            return true;
+        }
+    }
+    pthread_rwlock_unlock(&s_lock);
+
+    return false;
+}
+
+void GWR_vfs_unmount_all(void) {
+    pthread_rwlock_wrlock(&s_lock);
+    for (int i = 0; i < s_mount_count; ++i) {
+        munmap((void *) s_mounts[i].map, s_mounts[i].map_size);
+        free(s_mounts[i].path);
+    }
+    s_mount_count = 0;
+    pthread_rwlock_unlock(&s_lock);
+}
+
+bool GWR_vfs_exists(const char *path) {
+    return GWR_vfs_size(path) >= 0;
+}
+
+int64_t GWR_vfs_size(const char *path) {
+    assert(path);
+
+    char norm[VFS_PATH_SIZE];
+    if (!normalize(path, norm, sizeof(norm))) {
+        return -1;
+    }
+
+    // loose_wins() stats the disk, so it runs before the lock is taken
+    if (!loose_wins(path)) {
+        lookup_t l;
+        pthread_rwlock_rdlock(&s_lock);
+        const bool found = find(norm, &l);
+        const int64_t size = found ? (int64_t) l.entry->size : -1;
+        pthread_rwlock_unlock(&s_lock);
+        if (found) {
+            return size;
+        }
+    }
+
+    struct stat st;
+    if (stat(path, &st) != 0 || !S_ISREG(st.st_mode)) {
+        return -1;
+    }
+    return (int64_t) st.st_size;
+}
+
+bool GWR_vfs_open(const char *path, GWR_vfs_file_t *file) {
+    assert(path);
+    assert(file);
+
+    *file = (GWR_vfs_file_t) {0};
+
+    char norm[VFS_PATH_SIZE];
+    if (!normalize(path, norm, sizeof(norm))) {
+        VFS_LOG(GWR_LOG_ERROR, "path too long: '%s'", path);
+        return false;
+    }
+
+    lookup_t l;
+    const bool loose = loose_wins(path);
+    pthread_rwlock_rdlock(&s_lock);
+    if (!loose && find(norm, &l)) {
+        bool ok = true;
+        file->size = (size_t) l.entry->size;
+        if (l.entry->compression == GWR_PAK_STORED) {
+            file->data = l.mount->map + l.entry->offset;
+        } else {
+            // one spare byte so a zero-length entry still gets a buffer
+            file->buffer = malloc(file->size + 1);
+            ok = file->buffer && read_entry(l.mount, l.entry, file->buffer);
+            file->data = file->buffer;
+        }
+        if (!ok) {
+            VFS_LOG(GWR_LOG_ERROR, "failed to read '%s' from '%s'", path, l.mount->path);
+        }
+        pthread_rwlock_unlock(&s_lock);
+
+        if (!ok) {
+            GWR_vfs_close(file);
+            return false;
+        }
+        atomic_fetch_add(&s_pak_reads, 1);
+        return true;
+    }
+    pthread_rwlock_unlock(&s_lock);
+
+    const int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        atomic_fetch_add(&s_misses, 1);
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+        return false;
+    }
+
+    file->size = (size_t) st.st_size;
+    if (file->size == 0) {
+        close(fd);
+        file->data = "";
+        atomic_fetch_add(&s_loose_reads, 1);
+        return true;
+    }
+
+    void *map = mmap(NULL, file->size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        VFS_LOG(GWR_LOG_ERROR, "failed to map '%s'", path);
+        return false;
+    }
+    // loaders read the whole file once, front to back
+    madvise(map, file->size, MADV_SEQUENTIAL);
+    madvise(map, file->size, MADV_WILLNEED);
+
+    file->map = map;
+    file->map_size = file->size;
+    file->data = map;
+    atomic_fetch_add(&s_loose_reads, 1);
+    return true;
+}
+
+void GWR_vfs_close(GWR_vfs_file_t *file) {
+    assert(file);
+
+    if (file->map) {
+        munmap(file->map, file->map_size);
+    }
+    free(file->buffer);
+    *file = (GWR_vfs_file_t) {0};
+}
+
+char *GWR_vfs_read_text(const char *path, size_t *size) {
+    assert(path);
+
+    if (size) {
+        *size = 0;
+    }
+
+    char norm[VFS_PATH_SIZE];
+    if (!normalize(path, norm, sizeof(norm))) {
+        return NULL;
+    }
+
+    char *buf = NULL;
+    size_t n = 0;
+
+    lookup_t l;
+    const bool loose = loose_wins(path);
+    pthread_rwlock_rdlock(&s_lock);
+    if (!loose && find(norm, &l)) {
+        n = (size_t) l.entry->size;
+        buf = malloc(n + 1);
+        if (buf && !read_entry(l.mount, l.entry, buf)) {
+            free(buf);
+            buf = NULL;
+        }
+        pthread_rwlock_unlock(&s_lock);
+
+        if (!buf) {
+            return NULL;
+        }
+        atomic_fetch_add(&s_pak_reads, 1);
+    } else {
+        pthread_rwlock_unlock(&s_lock);
+
+        const int fd = open(path, O_RDONLY);
+        if (fd < 0) {
+            atomic_fetch_add(&s_misses, 1);
+            return NULL;
+        }
+        struct stat st;
+        if (fstat(fd, &st) == 0) {
+            n = (size_t) st.st_size;
+            buf = malloc(n + 1);
+        }
+        if (buf && !read_fd(fd, buf, n)) {
+            free(buf);
+            buf = NULL;
+        }
+        close(fd);
+
+        if (!buf) {
+            return NULL;
+        }
+        atomic_fetch_add(&s_loose_reads, 1);
+    }
+
+    buf[n] = '\0';
+    if (size) {
+        *size = n;
+    }
+    return buf;
+}
+
+int64_t GWR_vfs_read(const char *path, uint64_t offset, void *dst, size_t n) {
+    assert(path);
+    assert(dst || n == 0);
+
+    char norm[VFS_PATH_SIZE];
+    if (!normalize(path, norm, sizeof(norm))) {
+        return -1;
+    }
+
+    lookup_t l;
+    const bool loose = loose_wins(path);
+    pthread_rwlock_rdlock(&s_lock);
+    if (!loose && find(norm, &l)) {
+        const int64_t got = read_entry_range(l.mount, l.entry, offset, dst, n);
+        pthread_rwlock_unlock(&s_lock);
+        if (got >= 0) {
+            atomic_fetch_add(&s_pak_reads, 1);
+        }
+        return got;
+    }
+    pthread_rwlock_unlock(&s_lock);
+
+    const int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        atomic_fetch_add(&s_misses, 1);
+        return -1;
+    }
+
+    size_t done = 0;
+    while (done < n) {
+        const ssize_t r = pread(fd, (char *) dst + done, n - done, (off_t) (offset + done));
+        if (r < 0) {
+            close(fd);
+            return -1;
+        }
+        if (r == 0) {
+            break;
+        }
+        done += (size_t) r;
+    }
+    close(fd);
+
+    atomic_fetch_add(&s_loose_reads, 1);
+    return (int64_t) done;
+}
+
+void GWR_vfs_set_prefer_loose(bool prefer) {
+    atomic_store(&s_prefer_loose, prefer);
+}
+
+GWR_vfs_stats_t GWR_vfs_get_stats(void) {
+    return (GWR_vfs_stats_t) {
+        .pak_reads = atomic_load(&s_pak_reads),
+        .loose_reads = atomic_load(&s_loose_reads),
+        .misses = atomic_load(&s_misses),
+        .blocks_decoded = atomic_load(&s_blocks_decoded),
+        .bytes_decoded = atomic_load(&s_bytes_decoded),
+    };
+}
+
+// inner funcs defs
+
+// drops "." segments, folds "seg/.." and collapses repeated '/' so archive
+// names match loose spellings such as the preprocessor's "sub/../common.glsl";
+// a ".." with nothing left to fold is kept
+static bool normalize(const char *path, char *out, size_t size) {
+    const size_t base = path[0] == '/' ? 1 : 0;
+    size_t n = 0;
+    if (base) {
+        if (size < 2) {
+            return false;
+        }
+        out[n++] = '/';
+    }
+
+    const char *p = path;
+    while (*p) {
+        while (*p == '/') {
+            ++p;
+        }
+        const char *seg = p;
+        while (*p && *p != '/') {
+            ++p;
+        }
+        const size_t len = (size_t) (p - seg);
+
+        if (len == 0 || (len == 1 && seg[0] == '.')) {
+            continue;
+        }
+        if (len == 2 && seg[0] == '.' && seg[1] == '.') {
+            size_t last = n;
+            while (last > base && out[last - 1] != '/') {
+                --last;
+            }
+            const bool last_is_up = n - last == 2 && out[last] == '.' && out[last + 1] == '.';
+            if (n > base && !last_is_up) {
+                n = last > base ? last - 1 : base;
+                continue;
+            }
+            if (base) {
+                // "/.." is "/"
+                continue;
+            }
+        }
+
+        const size_t sep = n > base ? 1 : 0;
+        if (n + sep + len + 1 > size) {
+            return false;
+        }
+        if (sep) {
+            out[n++] = '/';
+        }
+        memcpy(out + n, seg, len);
+        n += len;
+    }
+
+    // a trailing '/' is kept so "assets/" as a mount prefix only matches whole segments
+    const size_t in_len = strlen(path);
+    if (in_len > 0 && path[in_len - 1] == '/' && n > base) {
+        if (n + 2 > size) {
+            return false;
+        }
+        out[n++] = '/';
+    }
+    out[n] = '\0';
+
+    return true;
+}
+
+// stats the disk; call without s_lock held
+static bool loose_wins(const char *path) {
+    if (!atomic_load_explicit(&s_prefer_loose, memory_order_relaxed)) {
+        return false;
+    }
+    struct stat st;
+    return stat(path, &st) == 0 && S_ISREG(st.st_mode);
+}
+
+// called with s_lock held
+static bool find(const char *norm, lookup_t *out) {
+    for (int i = s_mount_count - 1; i >= 0; --i) {
+        const mount_t *m = &s_mounts[i];
+        if (strncmp(norm, m->prefix, m->prefix_len) != 0) {
+            continue;
+        }
+
+        const char *rel = norm + m->prefix_len;
+        const size_t len = strlen(rel);
+        const uint64_t hash = GWR_pak_hash(rel, len);
+
+        // lower bound on the sorted hashes, then every entry sharing the hash
+        size_t lo = 0, hi = m->header->entry_count;
+        while (lo < hi) {
+            const size_t mid = lo + (hi - lo) / 2;
+            if (m->toc[mid].hash < hash) {
+                lo = mid + 1;
+            } else {
+                hi = mid;
+            }
+        }
+        for (size_t k = lo; k < m->header->entry_count && m->toc[k].hash == hash; ++k) {
+            const GWR_pak_entry_t *e = &m->toc[k];
+            if (!entry_ok(m, e)) {
+                VFS_LOG(GWR_LOG_ERROR, "corrupt entry %zu in '%s'", k, m->path);
+                continue;
+            }
+            if (e->name_length == len && memcmp(m->names + e->name_offset, rel, len) == 0) {
+                out->mount = m;
+                out->entry = e;
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+static bool header_ok(const GWR_pak_header_t *h, size_t map_size) {
+    if (h->magic != GWR_PAK_MAGIC || h->version != GWR_PAK_VERSION || h->block_size == 0) {
+        return false;
+    }
+    if (h->names_offset > map_size || h->names_size > map_size - h->names_offset) {
+        return false;
+    }
+    // the toc is read in place
+    if (h->toc_offset % sizeof(uint64_t) != 0 || h->toc_offset > map_size) {
+        return false;
+    }
+    return h->entry_count <= (map_size - h->toc_offset) / sizeof(GWR_pak_entry_t);
+}
+
+static bool entry_ok(const mount_t *m, const GWR_pak_entry_t *e) {
+    const uint64_t size = m->map_size;
+    if ((uint64_t) e->name_offset + e->name_length > m->header->names_size) {
+        return false;
+    }
+    if (e->offset > size || e->stored_size > size - e->offset) {
+        return false;
+    }
+    // stored entries are handed out in place, and .gmesh headers are read as uint64_t
+    if (e->offset % GWR_PAK_ALIGNMENT != 0) {
+        return false;
+    }
+    if (e->compression == GWR_PAK_STORED) {
+        return e->stored_size == e->size;
+    }
+    if (e->compression != GWR_PAK_LZ) {
+        return false;
+    }
+
+    const uint64_t bs = m->header->block_size;
+    if (e->block_count != (e->size + bs - 1) / bs) {
+        return false;
+    }
+    const uint64_t table = ((uint64_t) e->block_count + 1) * sizeof(uint64_t);
+    return e->blocks_offset <= size && table <= size - e->blocks_offset;
+}
+
+// dst receives the whole block: min(block_size, what is left of the entry)
+static bool decode_block(const mount_t *m, const GWR_pak_entry_t *e, uint32_t block, void *dst) {
+    const unsigned char *table = m->map + e->blocks_offset;
+    const uint64_t begin = read_u64(table + (size_t) block * sizeof(uint64_t));
+    const uint64_t end = read_u64(table + ((size_t) block + 1) * sizeof(uint64_t));
+    if (begin > end || end > e->stored_size) {
+        return false;
+    }
+
+    const uint64_t bs = m->header->block_size;
+    const uint64_t first = (uint64_t) block * bs;
+    const size_t raw = (size_t) (e->size - first < bs ? e->size - first : bs);
+    const unsigned char *src = m->map + e->offset + begin;
+    const size_t packed = (size_t) (end - begin);
+
+    if (packed == raw) {
+        memcpy(dst, src, raw);
+        return true;
+    }
+    if (!GWR_lz_decompress(src, packed, dst, raw)) {
+        return false;
+    }
+
+    atomic_fetch_add(&s_blocks_decoded, 1);
+    atomic_fetch_add(&s_bytes_decoded, raw);
+    return true;
+}
+
+static bool read_entry(const mount_t *m, const GWR_pak_entry_t *e, void *dst) {
+    if (e->compression == GWR_PAK_STORED) {
+        memcpy(dst, m->map + e->offset, (size_t) e->size);
+        return true;
+    }
+
+    const uint64_t bs = m->header->block_size;
+    for (uint32_t b = 0; b < e->block_count; ++b) {
+        if (!decode_block(m, e, b, (unsigned char *) dst + b * bs)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static int64_t read_entry_range(const mount_t *m, const GWR_pak_entry_t *e, uint64_t offset, void *dst, size_t n) {
+    if (offset >= e->size) {
+        return 0;
+    }
+    if (n > e->size - offset) {
+        n = (size_t) (e->size - offset);
+    }
+
+    if (e->compression == GWR_PAK_STORED) {
+        memcpy(dst, m->map + e->offset + offset, n);
+        return (int64_t) n;
+    }
+
+    const uint64_t bs = m->header->block_size;
+    unsigned char *out = dst;
+    unsigned char *scratch = NULL;
+    uint64_t pos = offset;
+    const uint64_t end = offset + n;
+
+    while (pos < end) {
+        const uint32_t b = (uint32_t) (pos / bs);
+        const uint64_t first = (uint64_t) b * bs;
+        const uint64_t last = first + bs < e->size ? first + bs : e->size;
+        const uint64_t take_end = last < end ? last : end;
+
+        if (pos == first && take_end == last) {
+            // the block lies inside the request, decode in place
+            if (!decode_block(m, e, b, out + (pos - offset))) {
+                free(scratch);
+                return -1;
+            }
+        } else {
+            if (!scratch && !(scratch = malloc((size_t) bs))) {
+                return -1;
+            }
+            if (!decode_block(m, e, b, scratch)) {
+                free(scratch);
+                return -1;
+            }
+            memcpy(out + (pos - offset), scratch + (pos - first), (size_t) (take_end - pos));
+        }
+        pos = take_end;
+    }
+
+    free(scratch);
+    return (int64_t) n;
+}
+
+static uint64_t read_u64(const unsigned char *p) {
+    uint64_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static bool read_fd(int fd, void *dst, size_t n) {
+    size_t done = 0;
+    while (done < n) {
+        const ssize_t r = read(fd, (char *) dst + done, n - done);
+        if (r <= 0) {
+            return false;
+        }
+        done += (size_t) r;
+    }
+    return true;
+}
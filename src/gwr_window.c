@@ -3,6 +3,7 @@
 #include "internal/gwr_log.h"
 #include "internal/gwr_config.h"
 #include "internal/gwr_cap.h"
+#include "internal/gwr_trace.h"
 
 #include <assert.h>
 #include <stdio.h>
@@ -11,28 +12,49 @@
 #include "glad/glad.h"
 #include "GLFW/glfw3.h"
 
-#define WINDOW_LOG(level, msg, ...)    GWR_log((level), "[WINDOW]: " msg, ##__VA_ARGS__)
-#define GLAD_LOG(level, msg, ...)      GWR_log((level), "[GLAD]: " msg, ##__VA_ARGS__)
+#define WINDOW_LOG(level, msg, ...)    GWR_LOG_AT(GWR_LOG_SYS_WINDOW, (level), msg, ##__VA_ARGS__)
+#define GLAD_LOG(level, msg, ...)      GWR_LOG_AT(GWR_LOG_SYS_GLAD, (level), msg, ##__VA_ARGS__)
 
 struct GWR_window_t {
     GLFWwindow *handle;
+    void *user_data;
+
+    // state cache of this window's context
+    int fb_width;
+    int fb_height;
+    bool viewport_dirty;    // resized while another context was current
+    int swap_interval;
+    float clear_color[4];
 };
 
+// GLFW is shared by every window; the last destroy terminates it
+static int s_glfw_refs = 0;
+static bool s_glad_loaded = false;
+// contexts are current per thread
+static _Thread_local GWR_window_t *s_current = NULL;
+static bool s_debug_context = false;
+
 // helper funcs
 
 static void framebuffer_size_callback(GLFWwindow *handle, int width, int height);
 
+static bool glfw_acquire(void);
+static void glfw_release(void);
 static bool init_glad(void);
+static void apply_viewport(GWR_window_t *window);
 
 // public funcs
 
 GWR_window_t *GWR_window_create(int width, int height, const char *title) {
+    return GWR_window_create_shared(width, height, title, NULL);
+}
+
+GWR_window_t *GWR_window_create_shared(int width, int height, const char *title, const GWR_window_t *share) {
     assert(width);
     assert(height);
     assert(title);
 
-    if (!glfwInit()) {
-        WINDOW_LOG(GWR_LOG_ERROR, "failed to initialize GLFW");
+    if (!glfw_acquire()) {
         return NULL;
     }
 
@@ -42,40 +64,54 @@ GWR_window_t *GWR_window_create(int width, int height, const char *title) {
 #ifdef __APPLE__
     glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
 #endif
+    glfwWindowHint(GLFW_OPENGL_DEBUG_CONTEXT, s_debug_context ? GLFW_TRUE : GLFW_FALSE);
 
-    GLFWwindow *handle = glfwCreateWindow(width, height, title, NULL, NULL);
+    GLFWwindow *handle = glfwCreateWindow(width, height, title, NULL, share ? share->handle : NULL);
     if (!handle) {
         WINDOW_LOG(GWR_LOG_ERROR, "failed to create GLFW window");
-        glfwTerminate();
-        return NULL;
-    }
-
-    glfwMakeContextCurrent(handle);
-
-    if (!init_glad()) {
-        glfwDestroyWindow(handle);
-        glfwTerminate();
+        glfw_release();
         return NULL;
     }
 
-    GWR_cap_init();
-
-    glfwSwapInterval(1); // VSync
-
-    int fbw = 0, fbh = 0;
-    glfwGetFramebufferSize(handle, &fbw, &fbh);
-    glViewport(0, 0, fbw, fbh);
-    glfwSetFramebufferSizeCallback(handle, framebuffer_size_callback);
-
-    GWR_window_t *window = malloc(sizeof(GWR_window_t));
+    GWR_window_t *window = calloc(1, sizeof(GWR_window_t));
     if (!window) {
         WINDOW_LOG(GWR_LOG_ERROR, "failed to allocate memory for window");
         glfwDestroyWindow(handle);
-        glfwTerminate();
+        glfw_release();
         return NULL;
     }
 
     window->handle = handle;
+    glfwSetWindowUserPointer(handle, window);
+
+    glfwMakeContextCurrent(handle);
+    s_current = window;
+
+    // one loader and one capability query serve every context: they all come
+    // from the same driver with the same version and profile
+    if (!s_glad_loaded) {
+        if (!init_glad()) {
+            glfwDestroyWindow(handle);
+            free(window);
+            s_current = NULL;
+            glfw_release();
+            return NULL;
+        }
+        s_glad_loaded = true;
+        GWR_cap_init();
+
+        // GWR_TRACE=<file> traces the whole run; see gwr_trace.h
+        const char *trace = getenv("GWR_TRACE");
+        if (trace && *trace) {
+            GWR_trace_begin(trace);
+        }
+    }
+
+    GWR_window_set_swap_interval(GWR_WINDOW_DEFAULT_SWAP_INTERVAL);
+
+    glfwGetFramebufferSize(handle, &window->fb_width, &window->fb_height);
+    apply_viewport(window);
+    glfwSetFramebufferSizeCallback(handle, framebuffer_size_callback);
 
     return window;
 }
@@ -84,12 +120,20 @@ void GWR_window_destroy(GWR_window_t *window) {
     assert(window);
     assert(window->handle);
 
+    if (s_current == window) {
+        s_current = NULL;
+    }
+
     glfwDestroyWindow(window->handle);
     window->handle = NULL;
 
     free(window);
 
-    glfwTerminate();
+    glfw_release();
+}
+
+void GWR_window_hint_debug_context(bool enabled) {
+    s_debug_context = enabled;
 }
 
 void *GWR_window_get_handle(const GWR_window_t *window) {
@@ -97,7 +141,25 @@ void *GWR_window_get_handle(const GWR_window_t *window) {
 }
 
 void GWR_window_set_vsync(bool enabled) {
-    glfwSwapInterval(enabled ? 1 : 0);
+    GWR_window_set_swap_interval(enabled ? 1 : 0);
+}
+
+void GWR_window_set_swap_interval(int interval) {
+    if (interval < 0 &&
+        !glfwExtensionSupported("WGL_EXT_swap_control_tear") &&
+        !glfwExtensionSupported("GLX_EXT_swap_control_tear")) {
+        WINDOW_LOG(GWR_LOG_WARNING, "adaptive vsync not supported, using swap interval %d", -interval);
+        interval = -interval;
+    }
+
+    glfwSwapInterval(interval);
+    if (s_current) {
+        s_current->swap_interval = interval;
+    }
+}
+
+int GWR_window_get_swap_interval(void) {
+    return s_current ? s_current->swap_interval : 0;
 }
 
 bool GWR_window_should_close(const GWR_window_t *window) {
@@ -121,6 +183,7 @@ void GWR_window_swap_buffers(const GWR_window_t *window) {
     assert(window->handle);
 
     glfwSwapBuffers(window->handle);
+    GWR_trace_frame();
 }
 
 void GWR_window_poll_events(void) {
@@ -128,6 +191,16 @@ void GWR_window_poll_events(void) {
 }
 
 void GWR_window_set_clear_color(float r, float g, float b, float a) {
+    if (s_current) {
+        float *c = s_current->clear_color;
+        if (c[0] == r && c[1] == g && c[2] == b && c[3] == a) {
+            return;
+        }
+        c[0] = r;
+        c[1] = g;
+        c[2] = b;
+        c[3] = a;
+    }
     glClearColor(r, g, b, a);
 }
 
@@ -139,7 +212,17 @@ void GWR_window_set_current(GWR_window_t *window) {
     assert(window);
     assert(window->handle);
 
-    glfwMakeContextCurrent(window->handle);
+    if (s_current != window) {
+        glfwMakeContextCurrent(window->handle);
+        s_current = window;
+    }
+    if (window->viewport_dirty) {
+        apply_viewport(window);
+    }
+}
+
+GWR_window_t *GWR_window_get_current(void) {
+    return s_current;
 }
 
 int GWR_window_get_width(const GWR_window_t *window) {
@@ -160,13 +243,108 @@ int GWR_window_get_height(const GWR_window_t *window) {
     return height;
 }
 
+int GWR_window_get_framebuffer_width(const GWR_window_t *window) {
+    assert(window);
+
+    return window->fb_width;
+}
+
+int GWR_window_get_framebuffer_height(const GWR_window_t *window) {
+    assert(window);
+
+    return window->fb_height;
+}
+
+void GWR_window_set_user_data(GWR_window_t *window, void *user_data) {
+    assert(window);
+
+    window->user_data = user_data;
+}
+
+void *GWR_window_get_user_data(const GWR_window_t *window) {
+    assert(window);
+
+    return window->user_data;
+}
+
+void GWR_window_run(GWR_window_t *const *windows, int count, GWR_window_frame_fn frame, void *user) {
+    assert(windows);
+    assert(count > 0);
+    assert(frame);
+
+    // only the first open window waits for vblank, with the interval the
+    // first window had on entry; the others swap with interval 0 so one loop
+    // iteration never blocks once per window
+    const int primary_interval = windows[0] ? windows[0]->swap_interval : GWR_WINDOW_DEFAULT_SWAP_INTERVAL;
+
+    for (;;) {
+        int open = 0;
+        for (int i = 0; i < count; ++i) {
+            GWR_window_t *window = windows[i];
+            if (!window || GWR_window_should_close(window)) {
+                continue;
+            }
+
+            GWR_window_set_current(window);
+            const int interval = open == 0 ? primary_interval : 0;
+            if (window->swap_interval != interval) {
+                GWR_window_set_swap_interval(interval);
+            }
+
+            frame(window, user);
+            GWR_window_swap_buffers(window);
+            ++open;
+        }
+
+        if (!open) {
+            return;
+        }
+
+        GWR_window_poll_events();
+    }
+}
+
 // helper funcs
 
 static void framebuffer_size_callback(GLFWwindow *handle, int width, int height) {
     assert(handle);
 
-    GWR_UNUSED(handle);
-    glViewport(0, 0, width, height);
+    GWR_window_t *window = glfwGetWindowUserPointer(handle);
+    if (!window) {
+        return;
+    }
+
+    window->fb_width = width;
+    window->fb_height = height;
+
+    // glViewport only touches the current context
+    if (window == s_current) {
+        apply_viewport(window);
+    } else {
+        window->viewport_dirty = true;
+    }
+}
+
+static bool glfw_acquire(void) {
+    if (s_glfw_refs == 0 && !glfwInit()) {
+        WINDOW_LOG(GWR_LOG_ERROR, "failed to initialize GLFW");
+        return false;
+    }
+
+    ++s_glfw_refs;
+    return true;
+}
+
+static void glfw_release(void) {
+    assert(s_glfw_refs > 0);
+
+    if (--s_glfw_refs == 0) {
+        // the wrapped entry points belong to the loader being dropped
+        GWR_trace_end();
+        glfwTerminate();
+        // a new GLFW instance may come with a different driver
+        s_glad_loaded = false;
+    }
 }
 
 static bool init_glad(void) {
@@ -176,3 +354,8 @@ static bool init_glad(void) {
     }
     return true;
 }
+
+static void apply_viewport(GWR_window_t *window) {
+    glViewport(0, 0, window->fb_width, window->fb_height);
+    window->viewport_dirty = false;
+}
@@ -0,0 +1,1363 @@
+// gwr_replay: plays back a trace written by GWR_trace_begin() or GWR_TRACE=<file>
+//
+//     gwr_replay [--window | --osmesa] [--frames first[:last]] [--finish] [--top n] trace.gtrace
+//
+// Runs headless by default on an EGL pbuffer, preferring Mesa's surfaceless
+// platform, so the same trace can be timed on llvmpipe on a machine without
+// a display (LIBGL_ALWAYS_SOFTWARE=1 forces it). --osmesa uses GLFW's null
+// platform with OSMesa for Mesa builds that still ship it; --window replays
+// into a visible GLFW window.
+// Every frame is replayed, since later frames depend on the state earlier
+// ones built, but only frames in --frames are reported and replay stops
+// after the last of them. Per frame it prints the call count and the time
+// spent in the driver when traced and when replayed; then the entry points
+// with the most replay time over the reported frames. --finish ends each
+// frame with glFinish() so the replay time includes the GPU work.
+//
+// Names of objects created before tracing began cannot be mapped; they are
+// used as is, with a warning.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <dlfcn.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "glad/glad.h"
+#include "GLFW/glfw3.h"
+
+#include "internal/gwr_trace_format.h"
+#include "internal/gwr_util.h"
+
+// 0-2 hold misaligned payloads, 3 mapped name arrays, 4 readback destinations
+#define SCRATCH_SLOTS 5
+#define SCRATCH_NAMES 3
+#define SCRATCH_PACK  4
+
+typedef struct {
+    const unsigned char *p;
+    const unsigned char *end;
+    bool overrun;
+} reader_t;
+
+typedef struct {
+    uint64_t hash;
+    const unsigned char *data;
+    uint64_t size;
+} blob_t;
+
+typedef enum {
+    NS_BUF = 0,
+    NS_TEX,
+    NS_VAO,
+    NS_FBO,
+    NS_RBO,
+    NS_SMP,
+    NS_PROG,
+    NS_SHD,
+    NS_PIPE,
+    NS_QRY,
+
+    NS__COUNT
+} ns_e;
+
+typedef struct {
+    GLuint traced;                  // 0 marks a free slot
+    GLuint name;                    // 0 once deleted
+} name_entry_t;
+
+// open addressing on the traced name; traced names can be large and sparse
+typedef struct {
+    name_entry_t *entries;
+    size_t cap;
+    size_t count;
+    bool warned;
+} name_map_t;
+
+typedef struct {
+    uint64_t traced;
+    GLsync sync;
+} sync_t;
+
+typedef struct {
+    GLuint program;                 // replay name
+    GLint traced;
+    GLint location;
+} location_t;
+
+typedef struct {
+    GLuint buffer;                  // replay name
+    GLintptr offset;
+    GLsizeiptr length;
+    unsigned char *ptr;
+} mapping_t;
+
+typedef struct {
+    uint64_t count;
+    uint64_t traced_ns;
+    uint64_t replay_ns;
+} call_stats_t;
+
+static const char *const s_ns_names[NS__COUNT] = {
+    "buffer", "texture", "vertex array", "framebuffer", "renderbuffer",
+    "sampler", "program", "shader", "program pipeline", "query",
+};
+
+#define CALL_NAME_(fn, ...)     [GWR_TRACE_ID_##fn] = #fn,
+#define CALL_NAME0_(fn)         [GWR_TRACE_ID_##fn] = #fn,
+
+static const char *const s_call_names[GWR_TRACE__COUNT] = {
+    GWR_TRACE_SIMPLE_CALLS(CALL_NAME0_, CALL_NAME_, CALL_NAME_, CALL_NAME_, CALL_NAME_, CALL_NAME_, CALL_NAME_)
+    GWR_TRACE_GEN_CALLS(CALL_NAME_)
+    GWR_TRACE_DELETE_CALLS(CALL_NAME_)
+    GWR_TRACE_UNIFORM_CALLS(CALL_NAME_, CALL_NAME_)
+    GWR_TRACE_CUSTOM_CALLS(CALL_NAME0_)
+};
+
+static blob_t *s_blobs = NULL;
+static size_t s_blob_cap = 0;
+static size_t s_blob_count = 0;
+
+static name_map_t s_names[NS__COUNT];
+
+static sync_t *s_syncs = NULL;
+static size_t s_sync_count = 0;
+static size_t s_sync_cap = 0;
+
+static location_t *s_locations = NULL;
+static size_t s_location_count = 0;
+static size_t s_location_cap = 0;
+
+static mapping_t *s_mappings = NULL;
+static size_t s_mapping_count = 0;
+static size_t s_mapping_cap = 0;
+
+static struct {
+    void *ptr;
+    size_t cap;
+} s_scratch[SCRATCH_SLOTS];
+
+static call_stats_t s_calls[GWR_TRACE__COUNT];
+static uint64_t s_call_ns = 0;
+
+// helpers
+
+static bool grow(void **array, size_t *cap, size_t need, size_t elem) {
+    if (need <= *cap) {
+        return true;
+    }
+    size_t n = *cap ? *cap : 64;
+    while (n < need) {
+        n *= 2;
+    }
+    void *p = realloc(*array, n * elem);
+    if (!p) {
+        fprintf(stderr, "out of memory\n");
+        exit(1);
+    }
+    *array = p;
+    *cap = n;
+    return true;
+}
+
+static void *scratch(int slot, size_t size) {
+    if (size > s_scratch[slot].cap) {
+        free(s_scratch[slot].ptr);
+        s_scratch[slot].ptr = malloc(size);
+        if (!s_scratch[slot].ptr) {
+            fprintf(stderr, "out of memory\n");
+            exit(1);
+        }
+        s_scratch[slot].cap = size;
+    }
+    return s_scratch[slot].ptr;
+}
+
+static uint32_t get_u32(reader_t *r) {
+    uint32_t v = 0;
+    if ((size_t) (r->end - r->p) < sizeof(v)) {
+        r->overrun = true;
+        return 0;
+    }
+    memcpy(&v, r->p, sizeof(v));
+    r->p += sizeof(v);
+    return v;
+}
+
+static uint64_t get_u64(reader_t *r) {
+    uint64_t v = 0;
+    if ((size_t) (r->end - r->p) < sizeof(v)) {
+        r->overrun = true;
+        return 0;
+    }
+    memcpy(&v, r->p, sizeof(v));
+    r->p += sizeof(v);
+    return v;
+}
+
+static GLfloat get_f32(reader_t *r) {
+    const uint32_t bits = get_u32(r);
+    GLfloat v;
+    memcpy(&v, &bits, sizeof(v));
+    return v;
+}
+
+static void blob_add(uint64_t hash, const unsigned char *data, uint64_t size) {
+    if ((s_blob_count + 1) * 2 > s_blob_cap) {
+        const size_t cap = s_blob_cap ? s_blob_cap * 2 : 4096;
+        blob_t *blobs = calloc(cap, sizeof(blob_t));
+        if (!blobs) {
+            fprintf(stderr, "out of memory\n");
+            exit(1);
+        }
+        for (size_t i = 0; i < s_blob_cap; ++i) {
+            if (s_blobs[i].hash) {
+                size_t j = (size_t) s_blobs[i].hash & (cap - 1);
+                while (blobs[j].hash) {
+                    j = (j + 1) & (cap - 1);
+                }
+                blobs[j] = s_blobs[i];
+            }
+        }
+        free(s_blobs);
+        s_blobs = blobs;
+        s_blob_cap = cap;
+    }
+
+    size_t i = (size_t) hash & (s_blob_cap - 1);
+    while (s_blobs[i].hash && s_blobs[i].hash != hash) {
+        i = (i + 1) & (s_blob_cap - 1);
+    }
+    if (!s_blobs[i].hash) {
+        ++s_blob_count;
+    }
+    s_blobs[i] = (blob_t) {hash, data, size};
+}
+
+// payload of a blob reference, copied to scratch `slot` when the file leaves it
+// misaligned; NULL for NULL and empty references
+static const void *get_blob(reader_t *r, uint64_t *size, int slot) {
+    const uint64_t hash = get_u64(r);
+    const uint64_t n = get_u64(r);
+    if (size) {
+        *size = n == GWR_TRACE_NULL_BLOB ? 0 : n;
+    }
+    if (n == GWR_TRACE_NULL_BLOB || n == 0 || !s_blob_cap) {
+        return NULL;
+    }
+
+    size_t i = (size_t) hash & (s_blob_cap - 1);
+    while (s_blobs[i].hash && s_blobs[i].hash != hash) {
+        i = (i + 1) & (s_blob_cap - 1);
+    }
+    if (!s_blobs[i].hash || s_blobs[i].size != n) {
+        fprintf(stderr, "warning: payload %016llx is missing from the trace\n", (unsigned long long) hash);
+        if (size) {
+            *size = 0;
+        }
+        return NULL;
+    }
+
+    const unsigned char *data = s_blobs[i].data;
+    if ((uintptr_t) data % sizeof(uint64_t) == 0) {
+        return data;
+    }
+    void *copy = scratch(slot, (size_t) n);
+    memcpy(copy, data, (size_t) n);
+    return copy;
+}
+
+// a blob GL reads `n` elements of; NULL, with a warning, if the trace holds fewer
+static const void *get_array(reader_t *r, GLsizei n, size_t elem, int slot) {
+    uint64_t size = 0;
+    const void *data = get_blob(r, &size, slot);
+    if (data && n > 0 && size < (uint64_t) n * elem) {
+        fprintf(
+            stderr, "warning: %llu byte payload is too small for %d elements of %zu bytes; passed as NULL\n",
+            (unsigned long long) size, n, elem
+        );
+        return NULL;
+    }
+    return data;
+}
+
+static size_t name_slot(const name_map_t *m, GLuint traced) {
+    size_t i = (size_t) ((traced * 0x9e3779b97f4a7c15ull) >> 32) & (m->cap - 1);
+    while (m->entries[i].traced && m->entries[i].traced != traced) {
+        i = (i + 1) & (m->cap - 1);
+    }
+    return i;
+}
+
+static void name_set(ns_e ns, GLuint traced, GLuint name) {
+    name_map_t *m = &s_names[ns];
+    if (!traced) {
+        return;
+    }
+    if ((m->count + 1) * 2 > m->cap) {
+        const size_t cap = m->cap ? m->cap * 2 : 256;
+        name_entry_t *entries = calloc(cap, sizeof(name_entry_t));
+        if (!entries) {
+            fprintf(stderr, "out of memory\n");
+            exit(1);
+        }
+        name_map_t bigger = {entries, cap, 0, m->warned};
+        for (size_t i = 0; i < m->cap; ++i) {
+            if (m->entries[i].traced) {
+                bigger.entries[name_slot(&bigger, m->entries[i].traced)] = m->entries[i];
+                ++bigger.count;
+            }
+        }
+        free(m->entries);
+        *m = bigger;
+    }
+
+    // deleted names keep their slot; GL hands the same names out again
+    name_entry_t *e = &m->entries[name_slot(m, traced)];
+    if (!e->traced) {
+        e->traced = traced;
+        ++m->count;
+    }
+    e->name = name;
+}
+
+static GLuint name_get(ns_e ns, GLuint traced) {
+    name_map_t *m = &s_names[ns];
+    if (!traced) {
+        return 0;
+    }
+    if (m->cap) {
+        const name_entry_t *e = &m->entries[name_slot(m, traced)];
+        if (e->name) {
+            return e->name;
+        }
+    }
+    if (!m->warned) {
+        fprintf(
+            stderr, "warning: %s %u was created before tracing began; further unknown %s names are used as is\n",
+            s_ns_names[ns], traced, s_ns_names[ns]
+        );
+        m->warned = true;
+    }
+    return traced;
+}
+
+static ns_e label_ns(GLenum identifier) {
+    switch (identifier) {
+        case GL_TEXTURE:            return NS_TEX;
+        case GL_VERTEX_ARRAY:       return NS_VAO;
+        case GL_FRAMEBUFFER:        return NS_FBO;
+        case GL_RENDERBUFFER:       return NS_RBO;
+        case GL_SAMPLER:            return NS_SMP;
+        case GL_PROGRAM:            return NS_PROG;
+        case GL_SHADER:             return NS_SHD;
+        case GL_PROGRAM_PIPELINE:   return NS_PIPE;
+        case GL_QUERY:              return NS_QRY;
+        default:                    return NS_BUF;
+    }
+}
+
+// maps `n` traced names from a blob read through scratch `slot`
+static const GLuint *get_names(reader_t *r, ns_e ns, GLsizei n, int slot) {
+    const GLuint *traced = get_array(r, n, sizeof(GLuint), slot);
+    if (!traced || n <= 0) {
+        return NULL;
+    }
+    GLuint *names = scratch(SCRATCH_NAMES, (size_t) n * sizeof(GLuint));
+    for (GLsizei i = 0; i < n; ++i) {
+        names[i] = name_get(ns, traced[i]);
+    }
+    return names;
+}
+
+static GLsync sync_get(uint64_t traced) {
+    for (size_t i = 0; i < s_sync_count; ++i) {
+        if (s_syncs[i].traced == traced) {
+            return s_syncs[i].sync;
+        }
+    }
+    return NULL;
+}
+
+static void sync_set(uint64_t traced, GLsync sync) {
+    for (size_t i = 0; i < s_sync_count; ++i) {
+        if (s_syncs[i].traced == traced) {
+            s_syncs[i].sync = sync;
+            return;
+        }
+    }
+    grow((void **) &s_syncs, &s_sync_cap, s_sync_count + 1, sizeof(sync_t));
+    s_syncs[s_sync_count++] = (sync_t) {traced, sync};
+}
+
+static void sync_remove(uint64_t traced) {
+    for (size_t i = 0; i < s_sync_count; ++i) {
+        if (s_syncs[i].traced == traced) {
+            s_syncs[i] = s_syncs[--s_sync_count];
+            return;
+        }
+    }
+}
+
+// drivers agree on locations more often than not, so unknown ones pass through
+static GLint location_get(GLuint program, GLint traced) {
+    for (size_t i = 0; i < s_location_count; ++i) {
+        if (s_locations[i].program == program && s_locations[i].traced == traced) {
+            return s_locations[i].location;
+        }
+    }
+    return traced;
+}
+
+static void location_set(GLuint program, GLint traced, GLint location) {
+    for (size_t i = 0; i < s_location_count; ++i) {
+        if (s_locations[i].program == program && s_locations[i].traced == traced) {
+            s_locations[i].location = location;
+            return;
+        }
+    }
+    grow((void **) &s_locations, &s_location_cap, s_location_count + 1, sizeof(location_t));
+    s_locations[s_location_count++] = (location_t) {program, traced, location};
+}
+
+static void mapping_set(GLuint buffer, GLintptr offset, GLsizeiptr length, void *ptr) {
+    for (size_t i = 0; i < s_mapping_count; ++i) {
+        if (s_mappings[i].buffer == buffer) {
+            s_mappings[i] = (mapping_t) {buffer, offset, length, ptr};
+            return;
+        }
+    }
+    grow((void **) &s_mappings, &s_mapping_cap, s_mapping_count + 1, sizeof(mapping_t));
+    s_mappings[s_mapping_count++] = (mapping_t) {buffer, offset, length, ptr};
+}
+
+static void mapping_remove(GLuint buffer) {
+    for (size_t i = 0; i < s_mapping_count; ++i) {
+        if (s_mappings[i].buffer == buffer) {
+            s_mappings[i] = s_mappings[--s_mapping_count];
+            return;
+        }
+    }
+}
+
+// through the replay's own mapping when the range is mapped, as the traced process did
+static void buffer_write(GLuint buffer, uint64_t offset, const void *data, uint64_t size) {
+    if (!buffer || !data) {
+        return;
+    }
+
+    for (size_t i = 0; i < s_mapping_count; ++i) {
+        const mapping_t *m = &s_mappings[i];
+        if (m->buffer == buffer && offset >= (uint64_t) m->offset &&
+            offset + size <= (uint64_t) m->offset + (uint64_t) m->length) {
+            memcpy(m->ptr + (offset - (uint64_t) m->offset), data, (size_t) size);
+            return;
+        }
+    }
+
+    if (glad_glNamedBufferSubData) {
+        glNamedBufferSubData(buffer, (GLintptr) offset, (GLsizeiptr) size, data);
+        return;
+    }
+    GLint prev = 0;
+    glGetIntegerv(GL_COPY_WRITE_BUFFER_BINDING, &prev);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+    glBufferSubData(GL_COPY_WRITE_BUFFER, (GLintptr) offset, (GLsizeiptr) size, data);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, (GLuint) prev);
+}
+
+// pixels: an unpack buffer offset or a payload
+static const void *get_unpack(reader_t *r, int slot) {
+    if (get_u32(r)) {
+        return (const void *) (uintptr_t) get_u64(r);
+    }
+    return get_blob(r, NULL, slot);
+}
+
+// destination of a readback: the pack buffer offset, or scratch memory sized by the pack state
+static void *get_pack(reader_t *r, GLsizei w, GLsizei h, GLsizei d, GLenum format, GLenum type, GLsizei buf_size) {
+    const bool pbo = get_u32(r) != 0;
+    const uint64_t offset = get_u64(r);
+    if (pbo) {
+        return (void *) (uintptr_t) offset;
+    }
+
+    GLint row_length = 0, alignment = 4;
+    glGetIntegerv(GL_PACK_ROW_LENGTH, &row_length);
+    glGetIntegerv(GL_PACK_ALIGNMENT, &alignment);
+    uint64_t size = GWR_trace_image_bytes(w, h, d, format, type, row_length, alignment);
+    if (buf_size > 0 && (uint64_t) buf_size > size) {
+        size = (uint64_t) buf_size;
+    }
+    return scratch(SCRATCH_PACK, size ? (size_t) size : 1);
+}
+
+// replay
+
+#define GET_ENUM(r)         ((GLenum) get_u32(r))
+#define GET_INT(r)          ((GLint) get_u32(r))
+#define GET_UINT(r)         ((GLuint) get_u32(r))
+#define GET_SIZEI(r)        ((GLsizei) get_u32(r))
+#define GET_BOOL(r)         ((GLboolean) get_u32(r))
+#define GET_BITS(r)         ((GLbitfield) get_u32(r))
+#define GET_FLOAT(r)        get_f32(r)
+#define GET_INTPTR(r)       ((GLintptr) get_u64(r))
+#define GET_SIZEIPTR(r)     ((GLsizeiptr) get_u64(r))
+#define GET_OFFSET(r)       ((const void *) (uintptr_t) get_u64(r))
+#define GET_BUF(r)          name_get(NS_BUF, get_u32(r))
+#define GET_TEX(r)          name_get(NS_TEX, get_u32(r))
+#define GET_VAO(r)          name_get(NS_VAO, get_u32(r))
+#define GET_FBO(r)          name_get(NS_FBO, get_u32(r))
+#define GET_RBO(r)          name_get(NS_RBO, get_u32(r))
+#define GET_SMP(r)          name_get(NS_SMP, get_u32(r))
+#define GET_PROG(r)         name_get(NS_PROG, get_u32(r))
+#define GET_SHD(r)          name_get(NS_SHD, get_u32(r))
+#define GET_PIPE(r)         name_get(NS_PIPE, get_u32(r))
+#define GET_QRY(r)          name_get(NS_QRY, get_u32(r))
+
+#define T_(k)               GWR_TRACE_T_##k
+// arguments are read into locals first: evaluation order inside a call is unspecified
+#define ARG_(i, k)          const T_(k) a##i = GET_##k(r)
+
+#define TIMED(stmt)                                                                 \
+    do {                                                                            \
+        const uint64_t t0_ = GWR_now_ns();                                          \
+        stmt;                                                                       \
+        s_call_ns = GWR_now_ns() - t0_;                                             \
+    } while (0)
+
+#define PLAY0(fn)                                                                   \
+    case GWR_TRACE_ID_##fn:                                                         \
+        TIMED(fn());                                                                \
+        break;
+
+#define PLAY1(fn, k0)                                                               \
+    case GWR_TRACE_ID_##fn: {                                                       \
+        ARG_(0, k0);                                                                \
+        TIMED(fn(a0));                                                              \
+        break;                                                                      \
+    }
+
+#define PLAY2(fn, k0, k1)                                                           \
+    case GWR_TRACE_ID_##fn: {                                                       \
+        ARG_(0, k0); ARG_(1, k1);                                                   \
+        TIMED(fn(a0, a1));                                                          \
+        break;                                                                      \
+    }
+
+#define PLAY3(fn, k0, k1, k2)                                                       \
+    case GWR_TRACE_ID_##fn: {                                                       \
+        ARG_(0, k0); ARG_(1, k1); ARG_(2, k2);                                      \
+        TIMED(fn(a0, a1, a2));                                                      \
+        break;                                                                      \
+    }
+
+#define PLAY4(fn, k0, k1, k2, k3)                                                   \
+    case GWR_TRACE_ID_##fn: {                                                       \
+        ARG_(0, k0); ARG_(1, k1); ARG_(2, k2); ARG_(3, k3);                         \
+        TIMED(fn(a0, a1, a2, a3));                                                  \
+        break;                                                                      \
+    }
+
+#define PLAY5(fn, k0, k1, k2, k3, k4)                                               \
+    case GWR_TRACE_ID_##fn: {                                                       \
+        ARG_(0, k0); ARG_(1, k1); ARG_(2, k2); ARG_(3, k3); ARG_(4, k4);            \
+        TIMED(fn(a0, a1, a2, a3, a4));                                              \
+        break;                                                                      \
+    }
+
+#define PLAY6(fn, k0, k1, k2, k3, k4, k5)                                           \
+    case GWR_TRACE_ID_##fn: {                                                       \
+        ARG_(0, k0); ARG_(1, k1); ARG_(2, k2); ARG_(3, k3); ARG_(4, k4); ARG_(5, k5); \
+        TIMED(fn(a0, a1, a2, a3, a4, a5));                                          \
+        break;                                                                      \
+    }
+
+#define PLAY_GEN(fn, ns)                                                            \
+    case GWR_TRACE_ID_##fn: {                                                       \
+        const GLsizei n = GET_SIZEI(r);                                             \
+        const GLuint *traced = get_array(r, n, sizeof(GLuint), 0);                  \
+        GLuint *names = scratch(1, n > 0 ? (size_t) n * sizeof(GLuint) : 1);        \
+        TIMED(fn(n, names));                                                        \
+        for (GLsizei i = 0; traced && i < n; ++i) {                                 \
+            name_set(NS_##ns, traced[i], names[i]);                                 \
+        }                                                                           \
+        break;                                                                      \
+    }
+
+#define PLAY_DELETE(fn, ns)                                                         \
+    case GWR_TRACE_ID_##fn: {                                                       \
+        const GLsizei n = GET_SIZEI(r);                                             \
+        const GLuint *traced = get_array(r, n, sizeof(GLuint), 0);                  \
+        GLuint *names = scratch(1, n > 0 ? (size_t) n * sizeof(GLuint) : 1);        \
+        for (GLsizei i = 0; traced && i < n; ++i) {                                 \
+            names[i] = name_get(NS_##ns, traced[i]);                                \
+        }                                                                           \
+        TIMED(fn(traced ? n : 0, names));                                           \
+        for (GLsizei i = 0; traced && i < n; ++i) {                                 \
+            name_set(NS_##ns, traced[i], 0);                                        \
+        }                                                                           \
+        break;                                                                      \
+    }
+
+#define PLAY_UNIFORM(fn, type, comps)                                               \
+    case GWR_TRACE_ID_##fn: {                                                       \
+        const GLuint p = GET_PROG(r);                                               \
+        const GLint loc = location_get(p, GET_INT(r));                              \
+        const GLsizei count = GET_SIZEI(r);                                         \
+        const type *v = get_blob(r, NULL, 0);                                       \
+        TIMED(fn(p, loc, count, v));                                                \
+        break;                                                                      \
+    }
+
+#define PLAY_UNIFORM_MATRIX(fn, type, comps)                                        \
+    case GWR_TRACE_ID_##fn: {                                                       \
+        const GLuint p = GET_PROG(r);                                               \
+        const GLint loc = location_get(p, GET_INT(r));                              \
+        const GLsizei count = GET_SIZEI(r);                                         \
+        const GLboolean transpose = GET_BOOL(r);                                    \
+        const type *v = get_blob(r, NULL, 0);                                       \
+        TIMED(fn(p, loc, count, transpose, v));                                     \
+        break;                                                                      \
+    }
+
+// false for ids this build does not know
+static bool play(uint16_t call, reader_t *r) {
+    switch (call) {
+        GWR_TRACE_SIMPLE_CALLS(PLAY0, PLAY1, PLAY2, PLAY3, PLAY4, PLAY5, PLAY6)
+        GWR_TRACE_GEN_CALLS(PLAY_GEN)
+        GWR_TRACE_DELETE_CALLS(PLAY_DELETE)
+        GWR_TRACE_UNIFORM_CALLS(PLAY_UNIFORM, PLAY_UNIFORM_MATRIX)
+
+        case GWR_TRACE_ID_glCreateTextures: {
+            const GLenum target = GET_ENUM(r);
+            const GLsizei n = GET_SIZEI(r);
+            const GLuint *traced = get_blob(r, NULL, 0);
+            GLuint *names = scratch(1, n > 0 ? (size_t) n * sizeof(GLuint) : 1);
+            TIMED(glCreateTextures(target, n, names));
+            for (GLsizei i = 0; traced && i < n; ++i) {
+                name_set(NS_TEX, traced[i], names[i]);
+            }
+            break;
+        }
+        case GWR_TRACE_ID_glCreateShader: {
+            const GLenum type = GET_ENUM(r);
+            const GLuint traced = get_u32(r);
+            GLuint shader = 0;
+            TIMED(shader = glCreateShader(type));
+            name_set(NS_SHD, traced, shader);
+            break;
+        }
+        case GWR_TRACE_ID_glCreateProgram: {
+            const GLuint traced = get_u32(r);
+            GLuint program = 0;
+            TIMED(program = glCreateProgram());
+            name_set(NS_PROG, traced, program);
+            break;
+        }
+        case GWR_TRACE_ID_glGetUniformLocation: {
+            const GLuint program = GET_PROG(r);
+            uint64_t size = 0;
+            const char *name = get_blob(r, &size, 0);
+            const GLint traced = GET_INT(r);
+            char *z = scratch(1, (size_t) size + 1);
+            if (size) {
+                memcpy(z, name, (size_t) size);
+            }
+            z[size] = '\0';
+            GLint location = -1;
+            TIMED(location = glGetUniformLocation(program, z));
+            if (traced >= 0) {
+                location_set(program, traced, location);
+            }
+            break;
+        }
+        case GWR_TRACE_ID_glShaderSource: {
+            const GLuint shader = GET_SHD(r);
+            uint64_t size = 0;
+            const GLchar *source = get_blob(r, &size, 0);
+            const GLint length = (GLint) size;
+            if (!source) {
+                source = "";
+            }
+            TIMED(glShaderSource(shader, 1, &source, &length));
+            break;
+        }
+        case GWR_TRACE_ID_glBufferData: {
+            const GLenum target = GET_ENUM(r);
+            const GLsizeiptr size = GET_SIZEIPTR(r);
+            const void *data = get_blob(r, NULL, 0);
+            const GLenum usage = GET_ENUM(r);
+            TIMED(glBufferData(target, size, data, usage));
+            break;
+        }
+        case GWR_TRACE_ID_glNamedBufferData: {
+            const GLuint buffer = GET_BUF(r);
+            const GLsizeiptr size = GET_SIZEIPTR(r);
+            const void *data = get_blob(r, NULL, 0);
+            const GLenum usage = GET_ENUM(r);
+            TIMED(glNamedBufferData(buffer, size, data, usage));
+            break;
+        }
+        case GWR_TRACE_ID_glBufferStorage: {
+            const GLenum target = GET_ENUM(r);
+            const GLsizeiptr size = GET_SIZEIPTR(r);
+            const void *data = get_blob(r, NULL, 0);
+            const GLbitfield flags = GET_BITS(r);
+            TIMED(glBufferStorage(target, size, data, flags));
+            break;
+        }
+        case GWR_TRACE_ID_glNamedBufferStorage: {
+            const GLuint buffer = GET_BUF(r);
+            const GLsizeiptr size = GET_SIZEIPTR(r);
+            const void *data = get_blob(r, NULL, 0);
+            const GLbitfield flags = GET_BITS(r);
+            TIMED(glNamedBufferStorage(buffer, size, data, flags));
+            break;
+        }
+        case GWR_TRACE_ID_glBufferSubData: {
+            const GLenum target = GET_ENUM(r);
+            const GLintptr offset = GET_INTPTR(r);
+            uint64_t size = 0;
+            const void *data = get_blob(r, &size, 0);
+            TIMED(glBufferSubData(target, offset, (GLsizeiptr) size, data));
+            break;
+        }
+        case GWR_TRACE_ID_glMapBufferRange: {
+            const GLenum target = GET_ENUM(r);
+            const GLuint buffer = GET_BUF(r);
+            const GLintptr offset = GET_INTPTR(r);
+            const GLsizeiptr length = GET_SIZEIPTR(r);
+            const GLbitfield access = GET_BITS(r);
+            void *ptr = NULL;
+            TIMED(ptr = glMapBufferRange(target, offset, length, access));
+            if (ptr) {
+                mapping_set(buffer, offset, length, ptr);
+            }
+            break;
+        }
+        case GWR_TRACE_ID_glMapNamedBufferRange: {
+            const GLuint buffer = GET_BUF(r);
+            const GLintptr offset = GET_INTPTR(r);
+            const GLsizeiptr length = GET_SIZEIPTR(r);
+            const GLbitfield access = GET_BITS(r);
+            void *ptr = NULL;
+            TIMED(ptr = glMapNamedBufferRange(buffer, offset, length, access));
+            if (ptr) {
+                mapping_set(buffer, offset, length, ptr);
+            }
+            break;
+        }
+        case GWR_TRACE_ID_glUnmapBuffer: {
+            const GLenum target = GET_ENUM(r);
+            const GLuint buffer = GET_BUF(r);
+            mapping_remove(buffer);
+            TIMED(glUnmapBuffer(target));
+            break;
+        }
+        case GWR_TRACE_ID_glUnmapNamedBuffer: {
+            const GLuint buffer = GET_BUF(r);
+            mapping_remove(buffer);
+            TIMED(glUnmapNamedBuffer(buffer));
+            break;
+        }
+        case GWR_TRACE_ID_glTexImage2D: {
+            ARG_(0, ENUM); ARG_(1, INT); ARG_(2, INT); ARG_(3, SIZEI); ARG_(4, SIZEI);
+            ARG_(5, INT); ARG_(6, ENUM); ARG_(7, ENUM);
+            const void *pixels = get_unpack(r, 0);
+            TIMED(glTexImage2D(a0, a1, a2, a3, a4, a5, a6, a7, pixels));
+            break;
+        }
+        case GWR_TRACE_ID_glTexImage3D: {
+            ARG_(0, ENUM); ARG_(1, INT); ARG_(2, INT); ARG_(3, SIZEI); ARG_(4, SIZEI);
+            ARG_(5, SIZEI); ARG_(6, INT); ARG_(7, ENUM); ARG_(8, ENUM);
+            const void *pixels = get_unpack(r, 0);
+            TIMED(glTexImage3D(a0, a1, a2, a3, a4, a5, a6, a7, a8, pixels));
+            break;
+        }
+        case GWR_TRACE_ID_glTexSubImage3D: {
+            ARG_(0, ENUM); ARG_(1, INT); ARG_(2, INT); ARG_(3, INT); ARG_(4, INT);
+            ARG_(5, SIZEI); ARG_(6, SIZEI); ARG_(7, SIZEI); ARG_(8, ENUM); ARG_(9, ENUM);
+            const void *pixels = get_unpack(r, 0);
+            TIMED(glTexSubImage3D(a0, a1, a2, a3, a4, a5, a6, a7, a8, a9, pixels));
+            break;
+        }
+        case GWR_TRACE_ID_glReadPixels: {
+            ARG_(0, INT); ARG_(1, INT); ARG_(2, SIZEI); ARG_(3, SIZEI); ARG_(4, ENUM); ARG_(5, ENUM);
+            void *pixels = get_pack(r, a2, a3, 1, a4, a5, 0);
+            TIMED(glReadPixels(a0, a1, a2, a3, a4, a5, pixels));
+            break;
+        }
+        case GWR_TRACE_ID_glGetTextureSubImage: {
+            ARG_(0, TEX); ARG_(1, INT); ARG_(2, INT); ARG_(3, INT); ARG_(4, INT);
+            ARG_(5, SIZEI); ARG_(6, SIZEI); ARG_(7, SIZEI); ARG_(8, ENUM); ARG_(9, ENUM); ARG_(10, SIZEI);
+            void *pixels = get_pack(r, a5, a6, a7, a8, a9, a10);
+            TIMED(glGetTextureSubImage(a0, a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, pixels));
+            break;
+        }
+        case GWR_TRACE_ID_glSamplerParameterfv: {
+            ARG_(0, SMP); ARG_(1, ENUM);
+            const GLfloat *v = get_blob(r, NULL, 0);
+            if (v) {
+                TIMED(glSamplerParameterfv(a0, a1, v));
+            }
+            break;
+        }
+        case GWR_TRACE_ID_glDrawBuffers: {
+            ARG_(0, SIZEI);
+            const GLenum *bufs = get_blob(r, NULL, 0);
+            TIMED(glDrawBuffers(a0, bufs));
+            break;
+        }
+        case GWR_TRACE_ID_glNamedFramebufferDrawBuffers: {
+            ARG_(0, FBO); ARG_(1, SIZEI);
+            const GLenum *bufs = get_blob(r, NULL, 0);
+            TIMED(glNamedFramebufferDrawBuffers(a0, a1, bufs));
+            break;
+        }
+        case GWR_TRACE_ID_glClearBufferfv: {
+            ARG_(0, ENUM); ARG_(1, INT);
+            const GLfloat *v = get_blob(r, NULL, 0);
+            if (v) {
+                TIMED(glClearBufferfv(a0, a1, v));
+            }
+            break;
+        }
+        case GWR_TRACE_ID_glClearNamedFramebufferfv: {
+            ARG_(0, FBO); ARG_(1, ENUM); ARG_(2, INT);
+            const GLfloat *v = get_blob(r, NULL, 0);
+            if (v) {
+                TIMED(glClearNamedFramebufferfv(a0, a1, a2, v));
+            }
+            break;
+        }
+        case GWR_TRACE_ID_glClearBufferiv: {
+            ARG_(0, ENUM); ARG_(1, INT);
+            const GLint *v = get_blob(r, NULL, 0);
+            if (v) {
+                TIMED(glClearBufferiv(a0, a1, v));
+            }
+            break;
+        }
+        case GWR_TRACE_ID_glClearNamedFramebufferiv: {
+            ARG_(0, FBO); ARG_(1, ENUM); ARG_(2, INT);
+            const GLint *v = get_blob(r, NULL, 0);
+            if (v) {
+                TIMED(glClearNamedFramebufferiv(a0, a1, a2, v));
+            }
+            break;
+        }
+        case GWR_TRACE_ID_glInvalidateFramebuffer: {
+            ARG_(0, ENUM); ARG_(1, SIZEI);
+            const GLenum *attachments = get_blob(r, NULL, 0);
+            TIMED(glInvalidateFramebuffer(a0, a1, attachments));
+            break;
+        }
+        case GWR_TRACE_ID_glInvalidateNamedFramebufferData: {
+            ARG_(0, FBO); ARG_(1, SIZEI);
+            const GLenum *attachments = get_blob(r, NULL, 0);
+            TIMED(glInvalidateNamedFramebufferData(a0, a1, attachments));
+            break;
+        }
+        case GWR_TRACE_ID_glBlitFramebuffer: {
+            ARG_(0, INT); ARG_(1, INT); ARG_(2, INT); ARG_(3, INT);
+            ARG_(4, INT); ARG_(5, INT); ARG_(6, INT); ARG_(7, INT); ARG_(8, BITS); ARG_(9, ENUM);
+            TIMED(glBlitFramebuffer(a0, a1, a2, a3, a4, a5, a6, a7, a8, a9));
+            break;
+        }
+        case GWR_TRACE_ID_glBlitNamedFramebuffer: {
+            ARG_(0, FBO); ARG_(1, FBO); ARG_(2, INT); ARG_(3, INT); ARG_(4, INT); ARG_(5, INT);
+            ARG_(6, INT); ARG_(7, INT); ARG_(8, INT); ARG_(9, INT); ARG_(10, BITS); ARG_(11, ENUM);
+            TIMED(glBlitNamedFramebuffer(a0, a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11));
+            break;
+        }
+        case GWR_TRACE_ID_glBindTextures: {
+            ARG_(0, UINT); ARG_(1, SIZEI);
+            const GLuint *names = get_names(r, NS_TEX, a1, 0);
+            TIMED(glBindTextures(a0, a1, names));
+            break;
+        }
+        case GWR_TRACE_ID_glBindSamplers: {
+            ARG_(0, UINT); ARG_(1, SIZEI);
+            const GLuint *names = get_names(r, NS_SMP, a1, 0);
+            TIMED(glBindSamplers(a0, a1, names));
+            break;
+        }
+        case GWR_TRACE_ID_glBindBuffersBase: {
+            ARG_(0, ENUM); ARG_(1, UINT); ARG_(2, SIZEI);
+            const GLuint *names = get_names(r, NS_BUF, a2, 0);
+            TIMED(glBindBuffersBase(a0, a1, a2, names));
+            break;
+        }
+        case GWR_TRACE_ID_glBindBuffersRange: {
+            ARG_(0, ENUM); ARG_(1, UINT); ARG_(2, SIZEI);
+            const GLuint *names = get_names(r, NS_BUF, a2, 0);
+            const GLintptr *offsets = get_array(r, a2, sizeof(GLintptr), 1);
+            const GLsizeiptr *sizes = get_array(r, a2, sizeof(GLsizeiptr), 2);
+            TIMED(glBindBuffersRange(a0, a1, a2, names, offsets, sizes));
+            break;
+        }
+        case GWR_TRACE_ID_glBindVertexBuffers: {
+            ARG_(0, UINT); ARG_(1, SIZEI);
+            const GLuint *names = get_names(r, NS_BUF, a1, 0);
+            const GLintptr *offsets = get_array(r, a1, sizeof(GLintptr), 1);
+            const GLsizei *strides = get_array(r, a1, sizeof(GLsizei), 2);
+            TIMED(glBindVertexBuffers(a0, a1, names, offsets, strides));
+            break;
+        }
+        case GWR_TRACE_ID_glVertexArrayVertexBuffers: {
+            ARG_(0, VAO); ARG_(1, UINT); ARG_(2, SIZEI);
+            const GLuint *names = get_names(r, NS_BUF, a2, 0);
+            const GLintptr *offsets = get_array(r, a2, sizeof(GLintptr), 1);
+            const GLsizei *strides = get_array(r, a2, sizeof(GLsizei), 2);
+            TIMED(glVertexArrayVertexBuffers(a0, a1, a2, names, offsets, strides));
+            break;
+        }
+        case GWR_TRACE_ID_glFenceSync: {
+            ARG_(0, ENUM); ARG_(1, BITS);
+            const uint64_t traced = get_u64(r);
+            GLsync sync = NULL;
+            TIMED(sync = glFenceSync(a0, a1));
+            sync_set(traced, sync);
+            break;
+        }
+        case GWR_TRACE_ID_glClientWaitSync: {
+            const GLsync sync = sync_get(get_u64(r));
+            ARG_(1, BITS);
+            const GLuint64 timeout = get_u64(r);
+            if (sync) {
+                TIMED(glClientWaitSync(sync, a1, timeout));
+            }
+            break;
+        }
+        case GWR_TRACE_ID_glWaitSync: {
+            const GLsync sync = sync_get(get_u64(r));
+            ARG_(1, BITS);
+            const GLuint64 timeout = get_u64(r);
+            if (sync) {
+                TIMED(glWaitSync(sync, a1, timeout));
+            }
+            break;
+        }
+        case GWR_TRACE_ID_glDeleteSync: {
+            const uint64_t traced = get_u64(r);
+            const GLsync sync = sync_get(traced);
+            if (sync) {
+                TIMED(glDeleteSync(sync));
+                sync_remove(traced);
+            }
+            break;
+        }
+        case GWR_TRACE_ID_glObjectLabel: {
+            const GLenum identifier = GET_ENUM(r);
+            const GLuint name = name_get(label_ns(identifier), get_u32(r));
+            uint64_t size = 0;
+            const GLchar *label = get_blob(r, &size, 0);
+            TIMED(glObjectLabel(identifier, name, label ? (GLsizei) size : 0, label));
+            break;
+        }
+        case GWR_TRACE_ID_glPushDebugGroup: {
+            ARG_(0, ENUM); ARG_(1, UINT);
+            uint64_t size = 0;
+            const GLchar *message = get_blob(r, &size, 0);
+            TIMED(glPushDebugGroup(a0, a1, (GLsizei) size, message ? message : ""));
+            break;
+        }
+
+        default:
+            return false;
+    }
+    return true;
+}
+
+// report
+
+static int cmp_calls(const void *a, const void *b) {
+    const call_stats_t *ca = &s_calls[*(const uint16_t *) a];
+    const call_stats_t *cb = &s_calls[*(const uint16_t *) b];
+    if (ca->replay_ns != cb->replay_ns) {
+        return ca->replay_ns < cb->replay_ns ? 1 : -1;
+    }
+    return 0;
+}
+
+static void print_calls(int top) {
+    uint16_t ids[GWR_TRACE__COUNT];
+    int n = 0;
+    for (int id = GWR_TRACE_FIRST_CALL; id < GWR_TRACE__COUNT; ++id) {
+        if (s_calls[id].count) {
+            ids[n++] = (uint16_t) id;
+        }
+    }
+    qsort(ids, (size_t) n, sizeof(ids[0]), cmp_calls);
+
+    printf("\n%-40s %10s %12s %12s %10s\n", "call", "count", "traced ms", "replay ms", "replay us");
+    for (int i = 0; i < n && i < top; ++i) {
+        const call_stats_t *c = &s_calls[ids[i]];
+        printf(
+            "%-40s %10llu %12.3f %12.3f %10.3f\n",
+            s_call_names[ids[i]], (unsigned long long) c->count,
+            (double) c->traced_ns / 1e6, (double) c->replay_ns / 1e6,
+            (double) c->replay_ns / 1e3 / (double) c->count
+        );
+    }
+}
+
+// context: an EGL pbuffer by default, GLFW for --window and --osmesa. EGL is
+// loaded at run time, as GLFW does, so the tool builds without its headers.
+
+#define EGL_NONE                            0x3038
+#define EGL_SURFACE_TYPE                    0x3033
+#define EGL_PBUFFER_BIT                     0x0001
+#define EGL_RENDERABLE_TYPE                 0x3040
+#define EGL_OPENGL_BIT                      0x0008
+#define EGL_RED_SIZE                        0x3024
+#define EGL_GREEN_SIZE                      0x3023
+#define EGL_BLUE_SIZE                       0x3022
+#define EGL_ALPHA_SIZE                      0x3021
+#define EGL_DEPTH_SIZE                      0x3025
+#define EGL_STENCIL_SIZE                    0x3026
+#define EGL_WIDTH                           0x3057
+#define EGL_HEIGHT                          0x3056
+#define EGL_OPENGL_API                      0x30A2
+#define EGL_CONTEXT_MAJOR_VERSION           0x3098
+#define EGL_CONTEXT_MINOR_VERSION           0x30FB
+#define EGL_CONTEXT_OPENGL_PROFILE_MASK     0x30FD
+#define EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT 0x0001
+#define EGL_PLATFORM_SURFACELESS_MESA       0x31DD
+
+typedef int32_t egl_int;
+typedef unsigned int egl_boolean;
+
+typedef struct {
+    void *lib;
+    void *display;
+    void *surface;
+    void *context;
+
+    void *(*GetProcAddress)(const char *);
+    void *(*GetDisplay)(void *);
+    void *(*GetPlatformDisplayEXT)(unsigned int, void *, const egl_int *);
+    egl_boolean (*Initialize)(void *, egl_int *, egl_int *);
+    egl_boolean (*Terminate)(void *);
+    egl_boolean (*BindAPI)(unsigned int);
+    egl_boolean (*ChooseConfig)(void *, const egl_int *, void **, egl_int, egl_int *);
+    void *(*CreatePbufferSurface)(void *, void *, const egl_int *);
+    void *(*CreateContext)(void *, void *, void *, const egl_int *);
+    egl_boolean (*MakeCurrent)(void *, void *, void *, void *);
+    egl_boolean (*SwapBuffers)(void *, void *);
+} egl_t;
+
+typedef struct {
+    GLFWwindow *window;
+    egl_t egl;
+} context_t;
+
+static bool egl_create(egl_t *egl, int width, int height, int major, int minor) {
+    egl->lib = dlopen("libEGL.so.1", RTLD_LAZY | RTLD_LOCAL);
+    if (!egl->lib) {
+        fprintf(stderr, "libEGL.so.1 not found\n");
+        return false;
+    }
+
+    // POSIX blesses this cast for dlsym results
+    *(void **) &egl->GetProcAddress = dlsym(egl->lib, "eglGetProcAddress");
+    *(void **) &egl->GetDisplay = dlsym(egl->lib, "eglGetDisplay");
+    *(void **) &egl->Initialize = dlsym(egl->lib, "eglInitialize");
+    *(void **) &egl->Terminate = dlsym(egl->lib, "eglTerminate");
+    *(void **) &egl->BindAPI = dlsym(egl->lib, "eglBindAPI");
+    *(void **) &egl->ChooseConfig = dlsym(egl->lib, "eglChooseConfig");
+    *(void **) &egl->CreatePbufferSurface = dlsym(egl->lib, "eglCreatePbufferSurface");
+    *(void **) &egl->CreateContext = dlsym(egl->lib, "eglCreateContext");
+    *(void **) &egl->MakeCurrent = dlsym(egl->lib, "eglMakeCurrent");
+    *(void **) &egl->SwapBuffers = dlsym(egl->lib, "eglSwapBuffers");
+    if (!egl->GetProcAddress || !egl->GetDisplay || !egl->Initialize || !egl->Terminate || !egl->BindAPI ||
+        !egl->ChooseConfig || !egl->CreatePbufferSurface || !egl->CreateContext || !egl->MakeCurrent ||
+        !egl->SwapBuffers) {
+        fprintf(stderr, "libEGL.so.1 lacks EGL 1.4 entry points\n");
+        return false;
+    }
+    *(void **) &egl->GetPlatformDisplayEXT = egl->GetProcAddress("eglGetPlatformDisplayEXT");
+
+    // Mesa's surfaceless platform needs neither a display server nor a GPU device
+    if (egl->GetPlatformDisplayEXT) {
+        egl->display = egl->GetPlatformDisplayEXT(EGL_PLATFORM_SURFACELESS_MESA, NULL, NULL);
+    }
+    if (!egl->display || !egl->Initialize(egl->display, NULL, NULL)) {
+        egl->display = egl->GetDisplay(NULL);
+        if (!egl->display || !egl->Initialize(egl->display, NULL, NULL)) {
+            fprintf(stderr, "failed to initialize EGL\n");
+            egl->display = NULL;
+            return false;
+        }
+    }
+
+    const egl_int config_attribs[] = {
+        EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+        EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+        EGL_RED_SIZE, 8, EGL_GREEN_SIZE, 8, EGL_BLUE_SIZE, 8, EGL_ALPHA_SIZE, 8,
+        EGL_DEPTH_SIZE, 24, EGL_STENCIL_SIZE, 8,
+        EGL_NONE,
+    };
+    const egl_int surface_attribs[] = {EGL_WIDTH, width, EGL_HEIGHT, height, EGL_NONE};
+    const egl_int context_attribs[] = {
+        EGL_CONTEXT_MAJOR_VERSION, major,
+        EGL_CONTEXT_MINOR_VERSION, minor,
+        EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+        EGL_NONE,
+    };
+
+    void *config = NULL;
+    egl_int count = 0;
+    if (!egl->BindAPI(EGL_OPENGL_API) || !egl->ChooseConfig(egl->display, config_attribs, &config, 1, &count) || !count) {
+        fprintf(stderr, "no EGL config with a pbuffer and desktop GL\n");
+        return false;
+    }
+    egl->surface = egl->CreatePbufferSurface(egl->display, config, surface_attribs);
+    egl->context = egl->CreateContext(egl->display, config, NULL, context_attribs);
+    if (!egl->surface || !egl->context || !egl->MakeCurrent(egl->display, egl->surface, egl->surface, egl->context)) {
+        fprintf(stderr, "failed to create a GL %d.%d EGL context\n", major, minor);
+        return false;
+    }
+    return gladLoadGLLoader((GLADloadproc) egl->GetProcAddress) != 0;
+}
+
+static bool glfw_create(context_t *ctx, int width, int height, int major, int minor, bool osmesa) {
+    if (osmesa) {
+        glfwInitHint(GLFW_PLATFORM, GLFW_PLATFORM_NULL);
+    }
+    if (!glfwInit()) {
+        fprintf(stderr, "failed to initialize GLFW\n");
+        return false;
+    }
+
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, major);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, minor);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    if (osmesa) {
+        glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+        glfwWindowHint(GLFW_CONTEXT_CREATION_API, GLFW_OSMESA_CONTEXT_API);
+    }
+
+    ctx->window = glfwCreateWindow(width, height, "gwr_replay", NULL, NULL);
+    if (!ctx->window) {
+        fprintf(stderr, "failed to create a GL %d.%d context\n", major, minor);
+        return false;
+    }
+    glfwMakeContextCurrent(ctx->window);
+    glfwSwapInterval(0);
+    return gladLoadGLLoader((GLADloadproc) glfwGetProcAddress) != 0;
+}
+
+static bool context_create(context_t *ctx, const GWR_trace_header_t *header, bool window, bool osmesa) {
+    const int width = header->width > 0 ? header->width : 640;
+    const int height = header->height > 0 ? header->height : 480;
+    if (window || osmesa) {
+        return glfw_create(ctx, width, height, header->gl_major, header->gl_minor, osmesa);
+    }
+    return egl_create(&ctx->egl, width, height, header->gl_major, header->gl_minor);
+}
+
+static void context_swap(context_t *ctx) {
+    if (ctx->window) {
+        glfwSwapBuffers(ctx->window);
+        glfwPollEvents();
+    } else if (ctx->egl.context) {
+        ctx->egl.SwapBuffers(ctx->egl.display, ctx->egl.surface);
+    }
+}
+
+static void context_destroy(context_t *ctx) {
+    if (ctx->window) {
+        glfwDestroyWindow(ctx->window);
+    }
+    glfwTerminate();
+    if (ctx->egl.display) {
+        ctx->egl.MakeCurrent(ctx->egl.display, NULL, NULL, NULL);
+        ctx->egl.Terminate(ctx->egl.display);
+    }
+    if (ctx->egl.lib) {
+        dlclose(ctx->egl.lib);
+    }
+}
+
+int main(int argc, char **argv) {
+    bool window = false, osmesa = false, finish = false;
+    uint64_t first = 0, last = UINT64_MAX;
+    int top = 20;
+
+    int arg = 1;
+    for (; arg < argc && argv[arg][0] == '-'; ++arg) {
+        if (strcmp(argv[arg], "--window") == 0) {
+            window = true;
+        } else if (strcmp(argv[arg], "--osmesa") == 0) {
+            osmesa = true;
+        } else if (strcmp(argv[arg], "--finish") == 0) {
+            finish = true;
+        } else if (strcmp(argv[arg], "--frames") == 0 && arg + 1 < argc) {
+            char *end = NULL;
+            first = strtoull(argv[++arg], &end, 10);
+            last = *end == ':' ? (end[1] ? strtoull(end + 1, NULL, 10) : UINT64_MAX) : first;
+        } else if (strcmp(argv[arg], "--top") == 0 && arg + 1 < argc) {
+            top = atoi(argv[++arg]);
+        } else {
+            break;
+        }
+    }
+    if (argc - arg != 1) {
+        fprintf(
+            stderr, "usage: %s [--window | --osmesa] [--frames first[:last]] [--finish] [--top n] trace.gtrace\n", argv[0]
+        );
+        return 1;
+    }
+    const char *path = argv[arg];
+
+    const int fd = open(path, O_RDONLY);
+    struct stat st;
+    if (fd < 0 || fstat(fd, &st) != 0 || (size_t) st.st_size < sizeof(GWR_trace_header_t)) {
+        fprintf(stderr, "failed to open '%s'\n", path);
+        return 1;
+    }
+    const size_t file_size = (size_t) st.st_size;
+    const unsigned char *map = mmap(NULL, file_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        fprintf(stderr, "failed to map '%s'\n", path);
+        return 1;
+    }
+
+    GWR_trace_header_t header;
+    memcpy(&header, map, sizeof(header));
+    if (header.magic != GWR_TRACE_MAGIC || header.version != GWR_TRACE_VERSION) {
+        fprintf(stderr, "'%s' is not a version %u trace\n", path, GWR_TRACE_VERSION);
+        munmap((void *) map, file_size);
+        return 1;
+    }
+
+    context_t ctx = {0};
+    if (!context_create(&ctx, &header, window, osmesa)) {
+        context_destroy(&ctx);
+        munmap((void *) map, file_size);
+        return 1;
+    }
+    printf(
+        "%s: traced on GL %d.%d, %dx%d; replaying on %s\n",
+        path, header.gl_major, header.gl_minor, header.width, header.height, (const char *) glGetString(GL_RENDERER)
+    );
+    printf("\n%8s %10s %12s %12s\n", "frame", "calls", "traced ms", "replay ms");
+
+    uint64_t frame = 0, frame_calls = 0, frame_traced = 0, frame_replay = 0;
+    uint64_t reported = 0, total_traced = 0, total_replay = 0;
+    bool truncated = false;
+
+    const unsigned char *p = map + sizeof(header);
+    const unsigned char *end = map + file_size;
+    while (p < end && frame <= last) {
+        GWR_trace_record_t rec;
+        if ((size_t) (end - p) < sizeof(rec)) {
+            truncated = true;
+            break;
+        }
+        memcpy(&rec, p, sizeof(rec));
+        p += sizeof(rec);
+        if ((size_t) (end - p) < rec.size) {
+            truncated = true;
+            break;
+        }
+        reader_t r = {p, p + rec.size, false};
+        p += rec.size;
+
+        const bool in_range = frame >= first;
+        switch (rec.call) {
+            case GWR_TRACE_BLOB: {
+                const uint64_t hash = get_u64(&r);
+                blob_add(hash, r.p, (uint64_t) (r.end - r.p));
+                break;
+            }
+            case GWR_TRACE_FRAME: {
+                const uint64_t t0 = GWR_now_ns();
+                context_swap(&ctx);
+                if (finish) {
+                    glFinish();
+                }
+                frame_replay += GWR_now_ns() - t0;
+
+                if (in_range) {
+                    printf(
+                        "%8llu %10llu %12.3f %12.3f\n",
+                        (unsigned long long) frame, (unsigned long long) frame_calls,
+                        (double) frame_traced / 1e6, (double) frame_replay / 1e6
+                    );
+                    ++reported;
+                    total_traced += frame_traced;
+                    total_replay += frame_replay;
+                }
+                ++frame;
+                frame_calls = frame_traced = frame_replay = 0;
+                break;
+            }
+            case GWR_TRACE_BUFFER_WRITE: {
+                const GLuint buffer = name_get(NS_BUF, get_u32(&r));
+                const uint64_t offset = get_u64(&r);
+                uint64_t size = 0;
+                const void *data = get_blob(&r, &size, 0);
+                buffer_write(buffer, offset, data, size);
+                break;
+            }
+            case GWR_TRACE_MARKER: {
+                uint64_t size = 0;
+                const char *text = get_blob(&r, &size, 0);
+                if (in_range && text) {
+                    printf("%8s %.*s\n", "--", (int) size, text);
+                }
+                break;
+            }
+            default: {
+                s_call_ns = 0;
+                if (!play(rec.call, &r)) {
+                    fprintf(stderr, "warning: unknown call %u skipped\n", rec.call);
+                    break;
+                }
+                if (in_range) {
+                    ++frame_calls;
+                    frame_traced += rec.duration_ns;
+                    frame_replay += s_call_ns;
+                    s_calls[rec.call].count += 1;
+                    s_calls[rec.call].traced_ns += rec.duration_ns;
+                    s_calls[rec.call].replay_ns += s_call_ns;
+                }
+                break;
+            }
+        }
+        if (r.overrun) {
+            fprintf(stderr, "warning: record %u is shorter than its arguments\n", rec.call);
+        }
+    }
+
+    if (truncated) {
+        fprintf(stderr, "warning: trace ends mid-record\n");
+    }
+    if (frame_calls && frame >= first && frame <= last) {
+        printf(
+            "%8s %10llu %12.3f %12.3f\n", "partial", (unsigned long long) frame_calls,
+            (double) frame_traced / 1e6, (double) frame_replay / 1e6
+        );
+    }
+    if (reported) {
+        printf(
+            "%8s %10s %12.3f %12.3f\n", "mean", "",
+            (double) total_traced / 1e6 / (double) reported, (double) total_replay / 1e6 / (double) reported
+        );
+    }
+    print_calls(top);
+
+    context_destroy(&ctx);
+    munmap((void *) map, file_size);
+    return 0;
+}
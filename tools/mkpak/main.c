@@ -0,0 +1,300 @@
+// mkpak: packs a directory tree into the .gpak layout GWR_vfs_mount() maps
+//
+//     mkpak [-0] [-b block_kib] root_dir output.gpak
+//
+// Every regular file under root_dir becomes an entry named by its path
+// relative to root_dir. Entries are LZ-compressed in independent blocks
+// (64 KiB unless -b says otherwise) when that saves at least an eighth of
+// their size; already-compressed data such as PNG stays stored, which also
+// lets the VFS hand it out without a copy. -0 stores everything.
+
+#define _XOPEN_SOURCE 700
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <ftw.h>
+#include <sys/stat.h>
+
+#include "internal/gwr_pak_format.h"
+#include "internal/gwr_lz.h"
+
+typedef struct {
+    char *path;         // on disk
+    char *name;         // in the archive
+    uint64_t hash;
+} file_t;
+
+static file_t *s_files = NULL;
+static size_t s_file_count = 0;
+static size_t s_file_cap = 0;
+static size_t s_root_len = 0;
+
+static int collect(const char *path, const struct stat *st, int type, struct FTW *ftw) {
+    (void) st;
+    (void) ftw;
+
+    if (type != FTW_F) {
+        return 0;
+    }
+
+    if (s_file_count == s_file_cap) {
+        const size_t cap = s_file_cap ? s_file_cap * 2 : 256;
+        file_t *files = realloc(s_files, cap * sizeof(file_t));
+        if (!files) {
+            return 1;
+        }
+        s_files = files;
+        s_file_cap = cap;
+    }
+
+    const char *name = path + s_root_len;
+    while (*name == '/') {
+        ++name;
+    }
+
+    file_t *f = &s_files[s_file_count];
+    f->path = strdup(path);
+    f->name = strdup(name);
+    if (!f->path || !f->name) {
+        return 1;
+    }
+    f->hash = GWR_pak_hash(f->name, strlen(f->name));
+    ++s_file_count;
+    return 0;
+}
+
+static int cmp_files(const void *a, const void *b) {
+    const file_t *fa = a;
+    const file_t *fb = b;
+    if (fa->hash != fb->hash) {
+        return fa->hash < fb->hash ? -1 : 1;
+    }
+    return strcmp(fa->name, fb->name);
+}
+
+static unsigned char *read_all(const char *path, size_t *size) {
+    FILE *f = fopen(path, "rb");
+    if (!f) {
+        return NULL;
+    }
+
+    struct stat st;
+    unsigned char *buf = NULL;
+    if (fstat(fileno(f), &st) == 0) {
+        *size = (size_t) st.st_size;
+        // one spare byte so empty files still get a buffer
+        buf = malloc(*size + 1);
+    }
+    if (buf && fread(buf, 1, *size, f) != *size) {
+        free(buf);
+        buf = NULL;
+    }
+    fclose(f);
+    return buf;
+}
+
+static bool pad_to(FILE *out, uint64_t alignment) {
+    static const unsigned char zeros[GWR_PAK_ALIGNMENT] = {0};
+    const long pos = ftell(out);
+    if (pos < 0) {
+        return false;
+    }
+    const size_t pad = (size_t) ((alignment - (uint64_t) pos % alignment) % alignment);
+    return fwrite(zeros, 1, pad, out) == pad;
+}
+
+// compresses `data` block by block; false if it is not worth it
+static bool compress_entry(
+    const unsigned char *data, size_t size, uint32_t block_size,
+    unsigned char **packed, size_t *packed_size, uint64_t **offsets, uint32_t *block_count
+) {
+    const uint32_t blocks = (uint32_t) ((size + block_size - 1) / block_size);
+    if (blocks == 0) {
+        return false;
+    }
+
+    const size_t cap = GWR_lz_bound(block_size);
+    unsigned char *out = malloc((size_t) blocks * cap);
+    uint64_t *offs = malloc(((size_t) blocks + 1) * sizeof(uint64_t));
+    if (!out || !offs) {
+        free(out);
+        free(offs);
+        return false;
+    }
+
+    size_t pos = 0;
+    for (uint32_t b = 0; b < blocks; ++b) {
+        const size_t first = (size_t) b * block_size;
+        const size_t raw = size - first < block_size ? size - first : block_size;
+        offs[b] = pos;
+
+        size_t n = GWR_lz_compress(data + first, raw, out + pos, cap);
+        // blocks that do not shrink are stored raw; equal lengths mark them
+        if (n == 0 || n >= raw) {
+            memcpy(out + pos, data + first, raw);
+            n = raw;
+        }
+        pos += n;
+    }
+    offs[blocks] = pos;
+
+    if (pos + pos / 7 > size) {
+        free(out);
+        free(offs);
+        return false;
+    }
+
+    *packed = out;
+    *packed_size = pos;
+    *offsets = offs;
+    *block_count = blocks;
+    return true;
+}
+
+int main(int argc, char **argv) {
+    bool compress = true;
+    uint32_t block_size = GWR_PAK_DEFAULT_BLOCK_SIZE;
+
+    int arg = 1;
+    for (; arg < argc && argv[arg][0] == '-'; ++arg) {
+        if (strcmp(argv[arg], "-0") == 0) {
+            compress = false;
+        } else if (strcmp(argv[arg], "-b") == 0 && arg + 1 < argc) {
+            const long kib = strtol(argv[++arg], NULL, 10);
+            if (kib <= 0 || kib > 16 * 1024) {
+                fprintf(stderr, "bad block size: %s KiB\n", argv[arg]);
+                return 1;
+            }
+            block_size = (uint32_t) kib * 1024u;
+        } else {
+            break;
+        }
+    }
+    if (argc - arg != 2) {
+        fprintf(stderr, "usage: %s [-0] [-b block_kib] root_dir output.gpak\n", argv[0]);
+        return 1;
+    }
+    const char *root = argv[arg];
+    const char *out_path = argv[arg + 1];
+
+    s_root_len = strlen(root);
+    if (nftw(root, collect, 32, FTW_PHYS) != 0) {
+        fprintf(stderr, "failed to walk '%s'\n", root);
+        return 1;
+    }
+    qsort(s_files, s_file_count, sizeof(file_t), cmp_files);
+
+    FILE *out = fopen(out_path, "wb");
+    if (!out) {
+        fprintf(stderr, "failed to create '%s'\n", out_path);
+        return 1;
+    }
+
+    GWR_pak_header_t header = {
+        .magic = GWR_PAK_MAGIC,
+        .version = GWR_PAK_VERSION,
+        .entry_count = (uint32_t) s_file_count,
+        .block_size = block_size,
+    };
+    GWR_pak_entry_t *toc = calloc(s_file_count ? s_file_count : 1, sizeof(GWR_pak_entry_t));
+    int rc = 1;
+    if (!toc || fwrite(&header, sizeof(header), 1, out) != 1) {
+        goto cleanup;
+    }
+
+    uint64_t total_in = 0, total_out = 0;
+    uint32_t name_offset = 0;
+    for (size_t i = 0; i < s_file_count; ++i) {
+        const file_t *f = &s_files[i];
+        GWR_pak_entry_t *e = &toc[i];
+
+        size_t size = 0;
+        unsigned char *data = read_all(f->path, &size);
+        if (!data) {
+            fprintf(stderr, "failed to read '%s'\n", f->path);
+            goto cleanup;
+        }
+
+        unsigned char *packed = NULL;
+        size_t packed_size = 0;
+        uint64_t *offsets = NULL;
+        uint32_t blocks = 0;
+        const bool lz = compress && compress_entry(data, size, block_size, &packed, &packed_size, &offsets, &blocks);
+
+        bool ok = pad_to(out, GWR_PAK_ALIGNMENT);
+        e->hash = f->hash;
+        e->offset = (uint64_t) ftell(out);
+        e->size = size;
+        e->name_offset = name_offset;
+        e->name_length = (uint32_t) strlen(f->name);
+        name_offset += e->name_length;
+
+        if (lz) {
+            e->compression = GWR_PAK_LZ;
+            e->stored_size = packed_size;
+            e->block_count = blocks;
+            ok = ok && fwrite(packed, 1, packed_size, out) == packed_size && pad_to(out, sizeof(uint64_t));
+            e->blocks_offset = (uint64_t) ftell(out);
+            ok = ok && fwrite(offsets, sizeof(uint64_t), (size_t) blocks + 1, out) == (size_t) blocks + 1;
+        } else {
+            e->compression = GWR_PAK_STORED;
+            e->stored_size = size;
+            ok = ok && fwrite(data, 1, size, out) == size;
+        }
+
+        total_in += size;
+        total_out += e->stored_size;
+        free(packed);
+        free(offsets);
+        free(data);
+        if (!ok) {
+            fprintf(stderr, "failed to write '%s'\n", out_path);
+            goto cleanup;
+        }
+    }
+
+    header.names_offset = (uint64_t) ftell(out);
+    header.names_size = name_offset;
+    for (size_t i = 0; i < s_file_count; ++i) {
+        if (fwrite(s_files[i].name, 1, toc[i].name_length, out) != toc[i].name_length) {
+            goto cleanup;
+        }
+    }
+
+    if (!pad_to(out, sizeof(uint64_t))) {
+        goto cleanup;
+    }
+    header.toc_offset = (uint64_t) ftell(out);
+    if (fwrite(toc, sizeof(GWR_pak_entry_t), s_file_count, out) != s_file_count) {
+        goto cleanup;
+    }
+
+    if (fseek(out, 0, SEEK_SET) != 0 || fwrite(&header, sizeof(header), 1, out) != 1) {
+        goto cleanup;
+    }
+
+    printf(
+        "%s: %zu files, %llu -> %llu bytes\n",
+        out_path, s_file_count, (unsigned long long) total_in, (unsigned long long) total_out
+    );
+    rc = 0;
+
+cleanup:
+    if (fclose(out) != 0) {
+        rc = 1;
+    }
+    if (rc != 0) {
+        fprintf(stderr, "failed to write '%s'\n", out_path);
+        remove(out_path);
+    }
+    for (size_t i = 0; i < s_file_count; ++i) {
+        free(s_files[i].path);
+        free(s_files[i].name);
+    }
+    free(s_files);
+    free(toc);
+    return rc;
+}
@@ -0,0 +1,555 @@
+// obj2mesh: converts Wavefront OBJ into the .gmesh layout GWR_mesh_load() maps
+//
+//     obj2mesh input.obj output.gmesh
+//
+// Faces are fan-triangulated, identical v/vt/vn triples become one vertex.
+// The vertex layout is position (location 0), then normal (1) and texcoord
+// (2) when the file has them. Triangles then go through the GWR_mesh_opt
+// passes (weld, vertex cache, overdraw, fetch order) and meshlets are cut
+// greedily from the optimised order. Indices are 16-bit when they fit.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <math.h>
+#include <float.h>
+
+#include "internal/gwr_mesh_format.h"
+#include "internal/gwr_mesh_opt.h"
+
+#define MESHLET_MAX_VERTICES    64
+#define MESHLET_MAX_TRIANGLES   124
+
+typedef struct {
+    void *data;
+    size_t count;
+    size_t cap;
+    size_t elem;
+} vec_t;
+
+typedef struct {
+    int32_t v, t, n;
+} corner_t;
+
+typedef struct {
+    vec_t positions;    // float[3]
+    vec_t texcoords;    // float[2]
+    vec_t normals;      // float[3]
+    vec_t corners;      // corner_t, three per triangle
+} obj_t;
+
+typedef struct {
+    float *vertices;
+    uint32_t stride_floats;
+    uint32_t vertex_count;
+    uint32_t *indices;
+    uint32_t index_count;
+    bool has_normals;
+    bool has_texcoords;
+} mesh_t;
+
+static bool vec_push(vec_t *v, const void *item) {
+    if (v->count == v->cap) {
+        const size_t cap = v->cap ? v->cap * 2 : 1024;
+        void *data = realloc(v->data, cap * v->elem);
+        if (!data) {
+            return false;
+        }
+        v->data = data;
+        v->cap = cap;
+    }
+    memcpy((char *) v->data + v->count * v->elem, item, v->elem);
+    ++v->count;
+    return true;
+}
+
+static int32_t resolve_index(long idx, size_t count) {
+    // OBJ indices are 1-based, negative ones count back from the end
+    if (idx > 0 && (size_t) idx <= count) {
+        return (int32_t) idx - 1;
+    }
+    if (idx < 0 && (size_t) -idx <= count) {
+        return (int32_t) ((long) count + idx);
+    }
+    return -1;
+}
+
+static bool parse_corner(const char *tok, const obj_t *obj, corner_t *out) {
+    char *end = NULL;
+    out->v = resolve_index(strtol(tok, &end, 10), obj->positions.count);
+    out->t = -1;
+    out->n = -1;
+    if (out->v < 0) {
+        return false;
+    }
+    if (*end == '/') {
+        tok = end + 1;
+        if (*tok != '/') {
+            out->t = resolve_index(strtol(tok, &end, 10), obj->texcoords.count);
+            if (out->t < 0) {
+                return false;
+            }
+            tok = end;
+        }
+        if (*tok == '/') {
+            out->n = resolve_index(strtol(tok + 1, &end, 10), obj->normals.count);
+            if (out->n < 0) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+static bool parse_obj(FILE *f, obj_t *obj) {
+    char line[4096];
+    size_t line_no = 0;
+
+    while (fgets(line, sizeof(line), f)) {
+        ++line_no;
+        float x = 0.f, y = 0.f, z = 0.f;
+
+        if (line[0] == 'v' && line[1] == ' ') {
+            if (sscanf(line + 2, "%f %f %f", &x, &y, &z) != 3) {
+                fprintf(stderr, "line %zu: bad position\n", line_no);
+                return false;
+            }
+            const float p[3] = {x, y, z};
+            if (!vec_push(&obj->positions, p)) {
+                return false;
+            }
+        } else if (line[0] == 'v' && line[1] == 't') {
+            if (sscanf(line + 3, "%f %f", &x, &y) < 1) {
+                fprintf(stderr, "line %zu: bad texcoord\n", line_no);
+                return false;
+            }
+            const float t[2] = {x, y};
+            if (!vec_push(&obj->texcoords, t)) {
+                return false;
+            }
+        } else if (line[0] == 'v' && line[1] == 'n') {
+            if (sscanf(line + 3, "%f %f %f", &x, &y, &z) != 3) {
+                fprintf(stderr, "line %zu: bad normal\n", line_no);
+                return false;
+            }
+            const float n[3] = {x, y, z};
+            if (!vec_push(&obj->normals, n)) {
+                return false;
+            }
+        } else if (line[0] == 'f' && line[1] == ' ') {
+            corner_t first = {0}, prev = {0};
+            size_t n = 0;
+            for (char *tok = strtok(line + 2, " \t\r\n"); tok; tok = strtok(NULL, " \t\r\n")) {
+                corner_t c;
+                if (!parse_corner(tok, obj, &c)) {
+                    fprintf(stderr, "line %zu: bad face corner '%s'\n", line_no, tok);
+                    return false;
+                }
+                if (n == 0) {
+                    first = c;
+                } else if (n >= 2) {
+                    if (!vec_push(&obj->corners, &first) || !vec_push(&obj->corners, &prev) ||
+                        !vec_push(&obj->corners, &c)) {
+                        return false;
+                    }
+                }
+                prev = c;
+                ++n;
+            }
+        }
+    }
+    return true;
+}
+
+static uint64_t hash_corner(const corner_t *c) {
+    uint64_t h = ((uint64_t) (uint32_t) c->v << 32) ^ ((uint64_t) (uint32_t) c->t << 16) ^ (uint32_t) c->n;
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdull;
+    h ^= h >> 33;
+    return h;
+}
+
+static bool build_mesh(const obj_t *obj, mesh_t *mesh) {
+    const corner_t *corners = obj->corners.data;
+    const size_t corner_count = obj->corners.count;
+
+    mesh->has_normals = obj->normals.count > 0;
+    mesh->has_texcoords = obj->texcoords.count > 0;
+    mesh->stride_floats = 3 + (mesh->has_normals ? 3 : 0) + (mesh->has_texcoords ? 2 : 0);
+
+    size_t cap = 1;
+    while (cap < corner_count * 2) {
+        cap <<= 1;
+    }
+    int64_t *slots = malloc(cap * sizeof(int64_t));
+    corner_t *unique = malloc(corner_count * sizeof(corner_t));
+    mesh->indices = malloc(corner_count * sizeof(uint32_t));
+    mesh->vertices = malloc(corner_count * mesh->stride_floats * sizeof(float));
+    if (!slots || !unique || !mesh->indices || !mesh->vertices) {
+        free(slots);
+        free(unique);
+        return false;
+    }
+    memset(slots, 0xff, cap * sizeof(int64_t));
+
+    const float *positions = obj->positions.data;
+    const float *texcoords = obj->texcoords.data;
+    const float *normals = obj->normals.data;
+
+    for (size_t i = 0; i < corner_count; ++i) {
+        const corner_t *c = &corners[i];
+        size_t s = hash_corner(c) & (cap - 1);
+        while (slots[s] >= 0) {
+            const corner_t *u = &unique[slots[s]];
+            if (u->v == c->v && u->t == c->t && u->n == c->n) {
+                break;
+            }
+            s = (s + 1) & (cap - 1);
+        }
+
+        if (slots[s] < 0) {
+            const uint32_t idx = mesh->vertex_count++;
+            slots[s] = idx;
+            unique[idx] = *c;
+
+            float *dst = mesh->vertices + (size_t) idx * mesh->stride_floats;
+            memcpy(dst, positions + (size_t) c->v * 3, 3 * sizeof(float));
+            dst += 3;
+            if (mesh->has_normals) {
+                if (c->n >= 0) {
+                    memcpy(dst, normals + (size_t) c->n * 3, 3 * sizeof(float));
+                } else {
+                    memset(dst, 0, 3 * sizeof(float));
+                }
+                dst += 3;
+            }
+            if (mesh->has_texcoords) {
+                if (c->t >= 0) {
+                    memcpy(dst, texcoords + (size_t) c->t * 2, 2 * sizeof(float));
+                } else {
+                    memset(dst, 0, 2 * sizeof(float));
+                }
+            }
+        }
+        mesh->indices[i] = (uint32_t) slots[s];
+    }
+    mesh->index_count = (uint32_t) corner_count;
+
+    free(slots);
+    free(unique);
+    return true;
+}
+
+static bool optimize_mesh(mesh_t *mesh) {
+    const size_t stride = mesh->stride_floats * sizeof(float);
+    const float acmr_before = GWR_mesh_opt_acmr(mesh->indices, mesh->index_count, mesh->vertex_count);
+
+    mesh->vertex_count = (uint32_t) GWR_mesh_opt_weld(
+        mesh->vertices, mesh->vertex_count, stride, mesh->indices, mesh->index_count
+    );
+    if (!GWR_mesh_opt_vertex_cache(mesh->indices, mesh->indices, mesh->index_count, mesh->vertex_count)) {
+        return false;
+    }
+
+    // report what the overdraw pass changed, so a pass that silently keeps the
+    // cache order shows up in the converter output
+    uint32_t *cache_order = malloc(mesh->index_count * sizeof(uint32_t));
+    if (!cache_order) {
+        return false;
+    }
+    memcpy(cache_order, mesh->indices, mesh->index_count * sizeof(uint32_t));
+    const float acmr_cache = GWR_mesh_opt_acmr(mesh->indices, mesh->index_count, mesh->vertex_count);
+    if (!GWR_mesh_opt_overdraw(
+            mesh->indices, mesh->indices, mesh->index_count, mesh->vertices, mesh->vertex_count, stride
+        )) {
+        free(cache_order);
+        return false;
+    }
+    size_t moved = 0;
+    for (size_t i = 0; i < mesh->index_count; i += 3) {
+        moved += memcmp(&cache_order[i], &mesh->indices[i], 3 * sizeof(uint32_t)) != 0;
+    }
+    free(cache_order);
+    printf(
+        "overdraw: %zu of %zu triangles moved, acmr %.3f -> %.3f\n",
+        moved, (size_t) mesh->index_count / 3, acmr_cache, GWR_mesh_opt_acmr(mesh->indices, mesh->index_count, mesh->vertex_count)
+    );
+
+    float *fetched = malloc(mesh->vertex_count * stride);
+    if (!fetched) {
+        return false;
+    }
+    mesh->vertex_count = (uint32_t) GWR_mesh_opt_vertex_fetch(
+        fetched, mesh->vertices, mesh->vertex_count, stride, mesh->indices, mesh->index_count
+    );
+    free(mesh->vertices);
+    mesh->vertices = fetched;
+
+    printf(
+        "acmr %.3f -> %.3f\n",
+        acmr_before, GWR_mesh_opt_acmr(mesh->indices, mesh->index_count, mesh->vertex_count)
+    );
+    return true;
+}
+
+static const float *vertex_pos(const mesh_t *mesh, uint32_t idx) {
+    return mesh->vertices + (size_t) idx * mesh->stride_floats;
+}
+
+static void finish_meshlet(const mesh_t *mesh, GWR_mesh_meshlet_t *m, const uint32_t *verts, size_t vert_count) {
+    float lo[3] = {FLT_MAX, FLT_MAX, FLT_MAX};
+    float hi[3] = {-FLT_MAX, -FLT_MAX, -FLT_MAX};
+    for (size_t i = 0; i < vert_count; ++i) {
+        const float *p = vertex_pos(mesh, verts[i]);
+        for (int k = 0; k < 3; ++k) {
+            lo[k] = fminf(lo[k], p[k]);
+            hi[k] = fmaxf(hi[k], p[k]);
+        }
+    }
+    float radius2 = 0.f;
+    for (int k = 0; k < 3; ++k) {
+        m->center[k] = (lo[k] + hi[k]) * 0.5f;
+    }
+    for (size_t i = 0; i < vert_count; ++i) {
+        const float *p = vertex_pos(mesh, verts[i]);
+        const float dx = p[0] - m->center[0], dy = p[1] - m->center[1], dz = p[2] - m->center[2];
+        radius2 = fmaxf(radius2, dx * dx + dy * dy + dz * dz);
+    }
+    m->radius = sqrtf(radius2);
+
+    // normal cone from the face normals
+    const uint32_t *tri = mesh->indices + m->first_index;
+    const size_t tri_count = m->index_count / 3;
+    float (*face)[3] = malloc(tri_count * sizeof(*face));
+    float axis[3] = {0.f, 0.f, 0.f};
+    m->cone_cutoff = -1.f;
+    if (!face) {
+        memcpy(m->cone_axis, axis, sizeof(axis));
+        return;
+    }
+    for (size_t t = 0; t < tri_count; ++t) {
+        const float *a = vertex_pos(mesh, tri[t * 3]);
+        const float *b = vertex_pos(mesh, tri[t * 3 + 1]);
+        const float *c = vertex_pos(mesh, tri[t * 3 + 2]);
+        const float e0[3] = {b[0] - a[0], b[1] - a[1], b[2] - a[2]};
+        const float e1[3] = {c[0] - a[0], c[1] - a[1], c[2] - a[2]};
+        float n[3] = {e0[1] * e1[2] - e0[2] * e1[1], e0[2] * e1[0] - e0[0] * e1[2], e0[0] * e1[1] - e0[1] * e1[0]};
+        const float len = sqrtf(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+        if (len > 0.f) {
+            n[0] /= len, n[1] /= len, n[2] /= len;
+        }
+        memcpy(face[t], n, sizeof(n));
+        axis[0] += n[0], axis[1] += n[1], axis[2] += n[2];
+    }
+    const float axis_len = sqrtf(axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2]);
+    if (axis_len > 0.f) {
+        axis[0] /= axis_len, axis[1] /= axis_len, axis[2] /= axis_len;
+        float min_dot = 1.f;
+        for (size_t t = 0; t < tri_count; ++t) {
+            min_dot = fminf(min_dot, face[t][0] * axis[0] + face[t][1] * axis[1] + face[t][2] * axis[2]);
+        }
+        // a cone wider than a hemisphere never culls
+        m->cone_cutoff = min_dot > 0.f ? min_dot : -1.f;
+    }
+    memcpy(m->cone_axis, axis, sizeof(axis));
+    free(face);
+}
+
+static bool build_meshlets(const mesh_t *mesh, vec_t *out) {
+    uint32_t verts[MESHLET_MAX_VERTICES];
+    size_t vert_count = 0;
+    GWR_mesh_meshlet_t m = {0};
+
+    for (uint32_t t = 0; t < mesh->index_count; t += 3) {
+        // how many of this triangle's vertices the meshlet lacks
+        size_t missing = 0;
+        for (int k = 0; k < 3; ++k) {
+            bool found = false;
+            for (size_t i = 0; i < vert_count && !found; ++i) {
+                found = verts[i] == mesh->indices[t + k];
+            }
+            missing += !found;
+        }
+
+        if (vert_count + missing > MESHLET_MAX_VERTICES || m.index_count / 3 == MESHLET_MAX_TRIANGLES) {
+            finish_meshlet(mesh, &m, verts, vert_count);
+            if (!vec_push(out, &m)) {
+                return false;
+            }
+            memset(&m, 0, sizeof(m));
+            m.first_index = t;
+            vert_count = 0;
+        }
+
+        for (int k = 0; k < 3; ++k) {
+            bool found = false;
+            for (size_t i = 0; i < vert_count && !found; ++i) {
+                found = verts[i] == mesh->indices[t + k];
+            }
+            if (!found) {
+                verts[vert_count++] = mesh->indices[t + k];
+            }
+        }
+        m.index_count += 3;
+    }
+
+    if (m.index_count) {
+        finish_meshlet(mesh, &m, verts, vert_count);
+        if (!vec_push(out, &m)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static uint64_t align_up(uint64_t v) {
+    return (v + GWR_MESH_BLOB_ALIGNMENT - 1) & ~(uint64_t) (GWR_MESH_BLOB_ALIGNMENT - 1);
+}
+
+static bool write_blob(FILE *f, uint64_t offset, const void *data, size_t size) {
+    static const unsigned char zeros[GWR_MESH_BLOB_ALIGNMENT] = {0};
+
+    // pad up to the blob start
+    const long pos = ftell(f);
+    if (pos < 0 || (uint64_t) pos > offset) {
+        return false;
+    }
+    for (uint64_t pad = offset - (uint64_t) pos; pad > 0;) {
+        const size_t n = pad < sizeof(zeros) ? (size_t) pad : sizeof(zeros);
+        if (fwrite(zeros, 1, n, f) != n) {
+            return false;
+        }
+        pad -= n;
+    }
+    return size == 0 || fwrite(data, 1, size, f) == size;
+}
+
+static bool write_mesh(const char *path, const mesh_t *mesh, const vec_t *meshlets) {
+    GWR_mesh_header_t h = {0};
+    h.magic = GWR_MESH_MAGIC;
+    h.version = GWR_MESH_VERSION;
+    h.vertex_count = mesh->vertex_count;
+    h.vertex_stride = mesh->stride_floats * (uint32_t) sizeof(float);
+    h.index_count = mesh->index_count;
+    h.index_size = GWR_mesh_opt_index_type(mesh->vertex_count) == GL_UNSIGNED_SHORT ? 2 : 4;
+    h.lod_count = 1;
+    h.meshlet_count = (uint32_t) meshlets->count;
+
+    uint32_t offset = 0;
+    h.attribs[h.attrib_count++] = (GWR_mesh_attrib_t) {
+        .location = 0, .size = 3, .component = GWR_MESH_COMPONENT_F32, .mode = GWR_MESH_ATTRIB_FLOAT, .offset = offset,
+    };
+    offset += 3 * sizeof(float);
+    if (mesh->has_normals) {
+        h.attribs[h.attrib_count++] = (GWR_mesh_attrib_t) {
+            .location = 1, .size = 3, .component = GWR_MESH_COMPONENT_F32, .mode = GWR_MESH_ATTRIB_FLOAT, .offset = offset,
+        };
+        offset += 3 * sizeof(float);
+    }
+    if (mesh->has_texcoords) {
+        h.attribs[h.attrib_count++] = (GWR_mesh_attrib_t) {
+            .location = 2, .size = 2, .component = GWR_MESH_COMPONENT_F32, .mode = GWR_MESH_ATTRIB_FLOAT, .offset = offset,
+        };
+    }
+
+    for (int k = 0; k < 3; ++k) {
+        h.bounds_min[k] = FLT_MAX;
+        h.bounds_max[k] = -FLT_MAX;
+    }
+    for (uint32_t i = 0; i < mesh->vertex_count; ++i) {
+        const float *p = vertex_pos(mesh, i);
+        for (int k = 0; k < 3; ++k) {
+            h.bounds_min[k] = fminf(h.bounds_min[k], p[k]);
+            h.bounds_max[k] = fmaxf(h.bounds_max[k], p[k]);
+        }
+    }
+
+    const uint64_t vertex_size = (uint64_t) h.vertex_count * h.vertex_stride;
+    const uint64_t index_size = (uint64_t) h.index_count * h.index_size;
+    // meshlets were cut already, the 32-bit copy is not needed any more
+    GWR_mesh_opt_pack_indices(
+        mesh->indices, mesh->indices, mesh->index_count,
+        h.index_size == 2 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT
+    );
+    const GWR_mesh_lod_t lod = {.first_index = 0, .index_count = mesh->index_count, .error = 0.f};
+
+    h.vertex_offset = align_up(sizeof(h));
+    h.index_offset = align_up(h.vertex_offset + vertex_size);
+    h.lod_offset = align_up(h.index_offset + index_size);
+    h.meshlet_offset = align_up(h.lod_offset + sizeof(lod));
+
+    FILE *f = fopen(path, "wb");
+    if (!f) {
+        fprintf(stderr, "failed to open '%s' for writing\n", path);
+        return false;
+    }
+    const bool ok =
+        fwrite(&h, sizeof(h), 1, f) == 1 &&
+        write_blob(f, h.vertex_offset, mesh->vertices, vertex_size) &&
+        write_blob(f, h.index_offset, mesh->indices, index_size) &&
+        write_blob(f, h.lod_offset, &lod, sizeof(lod)) &&
+        write_blob(f, h.meshlet_offset, meshlets->data, meshlets->count * sizeof(GWR_mesh_meshlet_t));
+    if (fclose(f) != 0 || !ok) {
+        fprintf(stderr, "failed to write '%s'\n", path);
+        return false;
+    }
+    return true;
+}
+
+int main(int argc, char **argv) {
+    if (argc != 3) {
+        fprintf(stderr, "usage: %s input.obj output.gmesh\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    int exit_code = EXIT_FAILURE;
+    obj_t obj = {
+        .positions = {.elem = 3 * sizeof(float)},
+        .texcoords = {.elem = 2 * sizeof(float)},
+        .normals = {.elem = 3 * sizeof(float)},
+        .corners = {.elem = sizeof(corner_t)},
+    };
+    mesh_t mesh = {0};
+    vec_t meshlets = {.elem = sizeof(GWR_mesh_meshlet_t)};
+
+    FILE *f = fopen(argv[1], "r");
+    if (!f) {
+        fprintf(stderr, "failed to open '%s'\n", argv[1]);
+        goto cleanup;
+    }
+    const bool parsed = parse_obj(f, &obj);
+    fclose(f);
+    if (!parsed) {
+        goto cleanup;
+    }
+    if (!obj.corners.count) {
+        fprintf(stderr, "'%s' has no faces\n", argv[1]);
+        goto cleanup;
+    }
+
+    if (!build_mesh(&obj, &mesh) || !optimize_mesh(&mesh) || !build_meshlets(&mesh, &meshlets)) {
+        fprintf(stderr, "out of memory\n");
+        goto cleanup;
+    }
+    if (!write_mesh(argv[2], &mesh, &meshlets)) {
+        goto cleanup;
+    }
+
+    printf(
+        "%s: %u vertices, %u triangles, %zu meshlets\n",
+        argv[2], mesh.vertex_count, mesh.index_count / 3, meshlets.count
+    );
+    exit_code = EXIT_SUCCESS;
+
+cleanup:
+    free(obj.positions.data);
+    free(obj.texcoords.data);
+    free(obj.normals.data);
+    free(obj.corners.data);
+    free(mesh.vertices);
+    free(mesh.indices);
+    free(meshlets.data);
+    return exit_code;
+}
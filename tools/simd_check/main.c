@@ -0,0 +1,329 @@
+// simd_check: runs every gwr_simd backend the CPU supports against the scalar
+// reference on the same pseudo-random inputs, for the gwr_simd kernels and
+// the gwr_quant batch encoders that follow the same backend
+//
+//     simd_check [count]
+//
+// Transforms may differ from the reference by rounding (operation order, FMA
+// contracting two roundings into one), so they are compared normwise: the
+// largest difference over the largest reference magnitude. Results near zero
+// come out of cancelling large terms, so an elementwise relative error would
+// flag plain rounding. Cull results must match exactly. Exits non-zero on any
+// mismatch. Quantized output must be bit-identical across backends, so the
+// half inputs include zeros, subnormals, overflow, infinities and NaN.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <math.h>
+
+#include "internal/gwr_simd.h"
+#include "internal/gwr_quant.h"
+
+#define DEFAULT_COUNT   10007   // odd, so every kernel runs its remainder path
+#define REL_TOLERANCE   1e-6f
+
+typedef struct {
+    mat4 *mats;
+    vec3 *points;
+    float *xyz[3];
+    GWR_aabb_t *boxes;
+
+    // quantization
+    float *scalars;                 // halves and unorm8
+    vec3 *normals;                  // unit, some zero
+    float *handedness;
+    vec2 *uvs;
+    vec4 *colors;
+} inputs_t;
+
+typedef struct {
+    mat4 *mats;
+    vec3 *points;
+    float *xyz[3];
+    GWR_aabb_t *boxes;
+    uint8_t *visible;
+    size_t visible_count;
+
+    uint16_t *halves;
+    uint8_t *unorms;
+    int16_t (*pos_snorm)[4];
+    uint16_t (*pos_half)[4];
+    int16_t (*oct)[2];
+    uint32_t *packed;
+    GWR_quant_vert_t *verts;
+} outputs_t;
+
+static uint32_t s_rng = 0x12345678u;
+
+static float rnd(float lo, float hi) {
+    // xorshift32, fixed seed so runs are comparable
+    s_rng ^= s_rng << 13;
+    s_rng ^= s_rng >> 17;
+    s_rng ^= s_rng << 5;
+    return lo + (hi - lo) * (float) (s_rng >> 8) / (float) (1u << 24);
+}
+
+static void *alloc(size_t size) {
+    // mat4 is 32-byte aligned for AVX; sizes are rounded up for aligned_alloc
+    void *p = aligned_alloc(32, (size + 31) & ~(size_t) 31);
+    if (!p) {
+        fprintf(stderr, "out of memory\n");
+        exit(EXIT_FAILURE);
+    }
+    memset(p, 0, size);
+    return p;
+}
+
+static void outputs_alloc(outputs_t *o, size_t n) {
+    o->mats = alloc(n * sizeof(mat4));
+    o->points = alloc(n * sizeof(vec3));
+    for (int i = 0; i < 3; ++i) {
+        o->xyz[i] = alloc(n * sizeof(float));
+    }
+    o->boxes = alloc(n * sizeof(GWR_aabb_t));
+    o->visible = alloc(n);
+
+    o->halves = alloc(n * sizeof(uint16_t));
+    o->unorms = alloc(n);
+    o->pos_snorm = alloc(n * sizeof(*o->pos_snorm));
+    o->pos_half = alloc(n * sizeof(*o->pos_half));
+    o->oct = alloc(n * sizeof(*o->oct));
+    o->packed = alloc(n * sizeof(uint32_t));
+    o->verts = alloc(n * sizeof(GWR_quant_vert_t));
+}
+
+static void outputs_free(outputs_t *o) {
+    free(o->mats);
+    free(o->points);
+    for (int i = 0; i < 3; ++i) {
+        free(o->xyz[i]);
+    }
+    free(o->boxes);
+    free(o->visible);
+
+    free(o->halves);
+    free(o->unorms);
+    free(o->pos_snorm);
+    free(o->pos_half);
+    free(o->oct);
+    free(o->packed);
+    free(o->verts);
+}
+
+static void run(mat4 m, mat4 view_proj, const inputs_t *in, outputs_t *out, size_t n) {
+    GWR_simd_mat4_mul_n(m, in->mats, out->mats, n);
+    GWR_simd_transform_points_aos(m, in->points, out->points, n);
+    GWR_simd_transform_points_soa(m, in->xyz[0], in->xyz[1], in->xyz[2], out->xyz[0], out->xyz[1], out->xyz[2], n);
+    GWR_simd_aabb_transform(m, in->boxes, out->boxes, n);
+
+    vec4 planes[6];
+    GWR_simd_frustum_planes(view_proj, planes);
+    out->visible_count = GWR_simd_frustum_cull_aabbs(planes, in->boxes, n, out->visible);
+
+    // pointers to const arrays do not convert implicitly before C23
+    const vec3 *points = (const vec3 *) in->points;
+    const vec3 *normals = (const vec3 *) in->normals;
+    const GWR_quant_bounds_t bounds = GWR_quant_compute_bounds(points, n);
+    GWR_quant_encode_half_n(in->scalars, out->halves, n);
+    GWR_quant_encode_unorm8_n(in->scalars, out->unorms, n);
+    GWR_quant_encode_positions_snorm16(points, &bounds, out->pos_snorm, n);
+    GWR_quant_encode_positions_half(points, bounds.center, out->pos_half, n);
+    GWR_quant_encode_normals_oct(normals, out->oct, n);
+    GWR_quant_encode_normals_2_10_10_10(normals, in->handedness, out->packed, n);
+    GWR_quant_encode_verts(
+        points, normals, (const vec2 *) in->uvs, (const vec4 *) in->colors, &bounds, out->verts, n
+    );
+}
+
+// largest difference over the largest |ref|; prints and returns false past the tolerance
+static bool compare_floats(const char *backend, const char *kernel, const float *ref, const float *got, size_t n) {
+    float scale = 1.f;
+    for (size_t i = 0; i < n; ++i) {
+        scale = fmaxf(scale, fabsf(ref[i]));
+    }
+
+    float worst = 0.f;
+    size_t worst_at = 0;
+    for (size_t i = 0; i < n; ++i) {
+        const float err = fabsf(ref[i] - got[i]) / scale;
+        // NaN fails the comparison below and is reported as well
+        if (!(err <= worst)) {
+            worst = err;
+            worst_at = i;
+        }
+    }
+    const bool ok = worst <= REL_TOLERANCE;
+    printf("  %-6s %-24s %s (max err %.2e", backend, kernel, ok ? "ok  " : "FAIL", (double) worst);
+    if (!ok) {
+        printf(" at %zu: %.9g vs %.9g", worst_at, (double) ref[worst_at], (double) got[worst_at]);
+    }
+    printf(")\n");
+    return ok;
+}
+
+// counts differing elements of `elem` bytes; quantized output must match exactly
+static bool compare_bytes(const char *backend, const char *kernel, const void *ref, const void *got, size_t n, size_t elem) {
+    size_t diffs = 0;
+    size_t first = 0;
+    for (size_t i = 0; i < n; ++i) {
+        if (memcmp((const char *) ref + i * elem, (const char *) got + i * elem, elem) != 0) {
+            first = diffs ? first : i;
+            ++diffs;
+        }
+    }
+    printf("  %-6s %-24s %s (%zu of %zu differ", backend, kernel, diffs ? "FAIL" : "ok  ", diffs, n);
+    if (diffs) {
+        printf(", first at %zu", first);
+    }
+    printf(")\n");
+    return diffs == 0;
+}
+
+static bool compare_visible(const char *backend, const outputs_t *ref, const outputs_t *got, size_t n) {
+    size_t diffs = 0;
+    for (size_t i = 0; i < n; ++i) {
+        diffs += (ref->visible[i] != 0) != (got->visible[i] != 0);
+    }
+    const bool ok = diffs == 0 && ref->visible_count == got->visible_count;
+    printf(
+        "  %-6s %-24s %s (%zu of %zu visible, %zu differ)\n",
+        backend, "frustum_cull_aabbs", ok ? "ok  " : "FAIL", got->visible_count, n, diffs
+    );
+    return ok;
+}
+
+int main(int argc, char **argv) {
+    if (argc > 2) {
+        fprintf(stderr, "usage: %s [count]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    const size_t n = argc == 2 ? strtoul(argv[1], NULL, 10) : DEFAULT_COUNT;
+    if (!n) {
+        fprintf(stderr, "count must be positive\n");
+        return EXIT_FAILURE;
+    }
+
+    inputs_t in = {0};
+    in.mats = alloc(n * sizeof(mat4));
+    in.points = alloc(n * sizeof(vec3));
+    for (int i = 0; i < 3; ++i) {
+        in.xyz[i] = alloc(n * sizeof(float));
+    }
+    in.boxes = alloc(n * sizeof(GWR_aabb_t));
+    in.scalars = alloc(n * sizeof(float));
+    in.normals = alloc(n * sizeof(vec3));
+    in.handedness = alloc(n * sizeof(float));
+    in.uvs = alloc(n * sizeof(vec2));
+    in.colors = alloc(n * sizeof(vec4));
+
+    // the edges of the half range, each hit once per 64 inputs
+    const float specials[] = {
+        0.f, -0.f, 1.f, -1.f, 65504.f, 65520.f, -70000.f, 6.1035156e-5f, 5.9604645e-8f, 2.9802322e-8f, 1e-10f,
+        0.5f + 1.f / 4096.f, 1.f + 1.f / 2048.f, INFINITY, -INFINITY, NAN,
+    };
+    const size_t special_count = sizeof(specials) / sizeof(specials[0]);
+
+    for (size_t i = 0; i < n; ++i) {
+        for (int c = 0; c < 16; ++c) {
+            in.mats[i][c / 4][c % 4] = rnd(-2.f, 2.f);
+        }
+        for (int c = 0; c < 3; ++c) {
+            in.points[i][c] = rnd(-100.f, 100.f);
+            in.xyz[c][i] = in.points[i][c];
+            const float center = rnd(-60.f, 60.f);
+            const float extent = rnd(0.f, 5.f);
+            in.boxes[i].min[c] = center - extent;
+            in.boxes[i].max[c] = center + extent;
+        }
+
+        in.scalars[i] = i % 64 < special_count ? specials[i % 64] : rnd(-2.f, 2.f) * powf(2.f, rnd(-20.f, 20.f));
+        // unit normals, every 97th zero
+        vec3 nrm = {rnd(-1.f, 1.f), rnd(-1.f, 1.f), rnd(-1.f, 1.f)};
+        if (i % 97 == 0) {
+            glm_vec3_zero(nrm);
+        } else {
+            glm_vec3_normalize(nrm);
+        }
+        glm_vec3_copy(nrm, in.normals[i]);
+        in.handedness[i] = (float) ((int) (i % 3) - 1);
+        in.uvs[i][0] = rnd(-4.f, 4.f);
+        in.uvs[i][1] = rnd(-4.f, 4.f);
+        for (int c = 0; c < 4; ++c) {
+            in.colors[i][c] = rnd(-0.25f, 1.25f);
+        }
+    }
+
+    mat4 m CGLM_ALIGN_MAT;
+    mat4 view CGLM_ALIGN_MAT;
+    mat4 proj CGLM_ALIGN_MAT;
+    mat4 view_proj CGLM_ALIGN_MAT;
+    for (int c = 0; c < 16; ++c) {
+        m[c / 4][c % 4] = rnd(-2.f, 2.f);
+    }
+    glm_lookat((vec3) {0.f, 10.f, 40.f}, (vec3) {0.f, 0.f, 0.f}, (vec3) {0.f, 1.f, 0.f}, view);
+    glm_perspective(glm_rad(60.f), 16.f / 9.f, 0.1f, 80.f, proj);
+    glm_mat4_mul(proj, view, view_proj);
+
+    outputs_t ref = {0};
+    outputs_alloc(&ref, n);
+    GWR_simd_set_backend(GWR_SIMD_SCALAR);
+    run(m, view_proj, &in, &ref, n);
+
+    printf("simd_check: %zu elements against %s\n", n, GWR_simd_get_backend_name(GWR_SIMD_SCALAR));
+    bool ok = true;
+    int checked = 0;
+    for (int b = GWR_SIMD_SCALAR + 1; b < GWR_SIMD__COUNT; ++b) {
+        const char *name = GWR_simd_get_backend_name((GWR_simd_backend_e) b);
+        if (!GWR_simd_set_backend((GWR_simd_backend_e) b)) {
+            printf("  %-6s not supported here, skipped\n", name);
+            continue;
+        }
+        ++checked;
+
+        outputs_t got = {0};
+        outputs_alloc(&got, n);
+        run(m, view_proj, &in, &got, n);
+
+        ok &= compare_floats(name, "mat4_mul_n", (const float *) ref.mats, (const float *) got.mats, n * 16);
+        ok &= compare_floats(name, "transform_points_aos", (const float *) ref.points, (const float *) got.points, n * 3);
+        static const char *const soa_names[3] = {"transform_points_soa x", "transform_points_soa y", "transform_points_soa z"};
+        for (int c = 0; c < 3; ++c) {
+            ok &= compare_floats(name, soa_names[c], ref.xyz[c], got.xyz[c], n);
+        }
+        ok &= compare_floats(name, "aabb_transform", (const float *) ref.boxes, (const float *) got.boxes, n * 6);
+        ok &= compare_visible(name, &ref, &got, n);
+
+        ok &= compare_bytes(name, "quant_half_n", ref.halves, got.halves, n, sizeof(uint16_t));
+        ok &= compare_bytes(name, "quant_unorm8_n", ref.unorms, got.unorms, n, 1);
+        ok &= compare_bytes(name, "quant_positions_snorm16", ref.pos_snorm, got.pos_snorm, n, sizeof(*ref.pos_snorm));
+        ok &= compare_bytes(name, "quant_positions_half", ref.pos_half, got.pos_half, n, sizeof(*ref.pos_half));
+        ok &= compare_bytes(name, "quant_normals_oct", ref.oct, got.oct, n, sizeof(*ref.oct));
+        ok &= compare_bytes(name, "quant_normals_2_10_10_10", ref.packed, got.packed, n, sizeof(uint32_t));
+        ok &= compare_bytes(name, "quant_verts", ref.verts, got.verts, n, sizeof(GWR_quant_vert_t));
+
+        outputs_free(&got);
+    }
+
+    if (!checked) {
+        printf("  no vector backend is supported here\n");
+    }
+    printf("%s\n", ok ? "all backends match" : "MISMATCH");
+
+    outputs_free(&ref);
+    free(in.mats);
+    free(in.points);
+    for (int i = 0; i < 3; ++i) {
+        free(in.xyz[i]);
+    }
+    free(in.boxes);
+    free(in.scalars);
+    free(in.normals);
+    free(in.handedness);
+    free(in.uvs);
+    free(in.colors);
+
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}